@@ -31,6 +31,18 @@ scons --disable-warnings-as-errors --use-sasl-client --ssl
 scons install --disable-warnings-as-errors --prefix=/usr/local --use-sasl-client --ssl
 cd ${ROOT_FOLDER} && rm -Rf mongo-cxx-driver
 
+echo
+echo -e "\e[1;32m Builder: installing mongo c driver (static libmongoc/libbson, for the orionld_mongoc library) \e[0m"
+git clone https://github.com/mongodb/mongo-c-driver.git ${ROOT_FOLDER}/mongo-c-driver
+cd ${ROOT_FOLDER}/mongo-c-driver
+git checkout tags/1.17.5
+mkdir cmake-build
+cd cmake-build
+cmake -DCMAKE_INSTALL_PREFIX=/usr/local -DENABLE_STATIC=ON -DENABLE_AUTOMATIC_INIT_AND_CLEANUP=OFF -DENABLE_SNAPPY=OFF -DENABLE_ZSTD=OFF -DENABLE_TESTS=OFF -DENABLE_EXAMPLES=OFF ..
+make
+make install
+cd ${ROOT_FOLDER} && rm -Rf mongo-c-driver
+
 echo
 echo -e "\e[1;32m Debian Builder: check systemd \e[0m"
 apt-get -y install --reinstall systemd  # force reinstall systemd
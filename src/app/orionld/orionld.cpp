@@ -110,11 +110,22 @@ extern "C"
 
 #include "orionld/common/orionldState.h"                    // orionldStateRelease, kalloc, ...
 #include "orionld/common/branchName.h"                      // ORIONLD_BRANCH
+#include "orionld/common/orionldLatency.h"                  // orionldLatencyInit
 #include "orionld/context/orionldContextCacheRelease.h"     // orionldContextCacheRelease
+#include "orionld/context/orionldContextFromUrl.h"          // contextDownloadListInit, contextDownloadListRelease
 #include "orionld/rest/orionldServiceInit.h"                // orionldServiceInit
 #include "orionld/db/dbInit.h"                              // dbInit
+#include "orionld/db/dbTypeCatalogInit.h"                   // dbTypeCatalogInit
+#include "orionld/db/dbTypeCatalogFlush.h"                  // dbTypeCatalogFlush
+#include "orionld/db/dbTypeCatalogRelease.h"                // dbTypeCatalogRelease
+#include "orionld/mongoBackend/mongoLdSubCounters.h"       // mongoLdSubCountersInit, mongoLdSubCountersFlush
 #include "orionld/mqtt/mqttRelease.h"                       // mqttRelease
+#include "orionld/notifications/notificationConnectionPoolInit.h"     // notificationConnectionPoolInit
+#include "orionld/notifications/notificationConnectionPoolRelease.h"  // notificationConnectionPoolRelease
+#include "orionld/notifications/notificationSenderInit.h"     // notificationSenderInit
+#include "orionld/notifications/notificationOutcome.h"        // notificationOutcomeInit
 #include "orionld/troe/troeInit.h"                          // troeInit
+#include "orionld/troe/pgConnectionPoolRelease.h"           // pgConnectionPoolRelease
 
 #include "orionld/version.h"
 #include "orionld/orionRestServices.h"
@@ -125,9 +136,6 @@ extern "C"
 
 using namespace orion;
 
-extern void contextDownloadListInit(void);     // FIXME PR: include header ...
-extern void contextDownloadListRelease(void);  // FIXME PR: include header ...
-
 
 
 /* ****************************************************************************
@@ -212,6 +220,8 @@ bool            insecureNotif;
 bool            ngsiv1Autocast;
 int             contextDownloadAttempts;
 int             contextDownloadTimeout;
+char            contextDir[256];
+bool            contextRevalidate;
 bool            troe;
 bool            disableFileLog;
 bool            lmtmp;
@@ -220,10 +230,23 @@ unsigned short  troePort;
 char            troeUser[64];
 char            troePwd[64];
 int             troePoolSize;
+int             troeQueueSize;
+int             troeWorkers;
+char            troeSpillFile[256];
 bool            socketService;
 unsigned short  socketServicePort;
 bool            forwarding;
+int             forwardTimeout;
+int             mqttMaxInFlight;
+int             subCountersFlush;
 bool            idIndex;
+int             notifPoolSize;
+int             notifIdleTimeout;
+int             notifMaxConns;
+int             notifSenders;
+int             notifQueueSize;
+char            notifQueuePolicy[16];
+bool            entityIdUnique;
 
 
 
@@ -238,6 +261,8 @@ bool            idIndex;
 
 #define CTX_TMO_DESC           "Timeout in milliseconds for downloading of contexts"
 #define CTX_ATT_DESC           "Number of attempts for downloading of contexts"
+#define CTX_DIR_DESC           "directory where downloaded contexts are persisted, and loaded from at startup"
+#define CTX_REVALIDATE_DESC    "revalidate the persisted contexts (ETag/Last-Modified) in the background at startup"
 #define FG_DESC                "don't start as daemon"
 #define LOCALIP_DESC           "IP to receive new connections"
 #define PORT_DESC              "port to receive new connections"
@@ -293,10 +318,23 @@ bool            idIndex;
 #define TROE_HOST_USER         "username for troe database db server"
 #define TROE_HOST_PWD          "password for troe database db server"
 #define TROE_POOL_DESC         "size of the connection pool for TRoE Postgres database connections"
+#define TROE_QUEUE_DESC        "size of the TRoE write-behind queue (0: TRoE is written synchronously, in the request thread)"
+#define TROE_WORKERS_DESC      "number of threads writing the TRoE write-behind queue to Postgres"
+#define TROE_SPILL_DESC        "file where the TRoE write-behind queue is saved until written to Postgres"
 #define SOCKET_SERVICE_DESC    "enable the socket service - accept connections via a normal TCP socket"
 #define SOCKET_SERVICE_PORT_DESC  "port to receive new socket service connections"
 #define FORWARDING_DESC        "turn on forwarding"
+#define FORWARD_TMO_DESC       "timeout in milliseconds for all forwarded requests of one client request, to be answered by the context sources"
+#define MQTT_MAX_IN_FLIGHT_DESC  "max number of MQTT notifications published and not yet acknowledged, per MQTT broker connection"
+#define SUB_COUNTERS_FLUSH_DESC  "interval in milliseconds for writing subscription counters to the database, without subscription cache (0: one write per notification)"
 #define ID_INDEX_DESC          "automatic mongo index on _id.id"
+#define NOTIF_POOL_SIZE_DESC   "max number of idle keep-alive connections per notification endpoint (0: no keep-alive)"
+#define NOTIF_IDLE_TMO_DESC    "idle timeout in seconds for keep-alive connections to notification endpoints"
+#define NOTIF_MAX_CONNS_DESC   "max number of connections in use at the same time, per notification endpoint (0: no limit)"
+#define NOTIF_SENDERS_DESC     "number of NGSI-LD notification sender threads (0: notifications are sent by the request thread)"
+#define NOTIF_QUEUE_SIZE_DESC  "size of the NGSI-LD notification queue (only with -notifSenders)"
+#define NOTIF_QUEUE_POL_DESC   "policy when the NGSI-LD notification queue is full (dropNew|dropOld|block)"
+#define ENTITY_ID_UNIQUE_DESC  "unique mongo index on _id.id - entities are created without being looked up first (NGSI-LD only databases)"
 
 
 
@@ -360,6 +398,8 @@ PaArgument paArgs[] =
   { "-ngsiv1Autocast",        &ngsiv1Autocast,          "NGSIV1_AUTOCAST",           PaBool,    PaOpt,  false,           false,  true,             NGSIV1_AUTOCAST          },
   { "-ctxTimeout",            &contextDownloadTimeout,  "CONTEXT_DOWNLOAD_TIMEOUT",  PaInt,     PaOpt,  5000,            0,      20000,            CTX_TMO_DESC             },
   { "-ctxAttempts",           &contextDownloadAttempts, "CONTEXT_DOWNLOAD_ATTEMPTS", PaInt,     PaOpt,  3,               0,      100,              CTX_ATT_DESC             },
+  { "-ctxDir",                contextDir,               "CONTEXT_DIR",               PaString,  PaOpt,  _i "",           PaNL,   PaNL,             CTX_DIR_DESC             },
+  { "-ctxRevalidate",         &contextRevalidate,       "CONTEXT_REVALIDATE",        PaBool,    PaOpt,  false,           false,  true,             CTX_REVALIDATE_DESC      },
   { "-troe",                  &troe,                    "TROE",                      PaBool,    PaOpt,  false,           false,  true,             TROE_DESC                },
   { "-lmtmp",                 &lmtmp,                   "TMP_TRACES",                PaBool,    PaHid,  true,            false,  true,             TMPTRACES_DESC           },
   { "-socketService",         &socketService,           "SOCKET_SERVICE",            PaBool,    PaHid,  false,           false,  true,             SOCKET_SERVICE_DESC      },
@@ -368,8 +408,21 @@ PaArgument paArgs[] =
   { "-troeUser",              troeUser,                 "TROE_USER",                 PaString,  PaOpt,  _i "postgres",   PaNL,   PaNL,             TROE_HOST_USER           },
   { "-troePwd",               troePwd,                  "TROE_PWD",                  PaString,  PaOpt,  _i "password",   PaNL,   PaNL,             TROE_HOST_PWD            },
   { "-troePoolSize",          &troePoolSize,            "TROE_POOL_SIZE",            PaInt,     PaOpt,  10,              0,      1000,             TROE_POOL_DESC           },
+  { "-troeQueueSize",         &troeQueueSize,           "TROE_QUEUE_SIZE",           PaInt,     PaOpt,  0,               0,      10000000,         TROE_QUEUE_DESC          },
+  { "-troeWorkers",           &troeWorkers,             "TROE_WORKERS",              PaInt,     PaOpt,  2,               1,      64,               TROE_WORKERS_DESC        },
+  { "-troeSpillFile",         troeSpillFile,            "TROE_SPILL_FILE",           PaString,  PaOpt,  _i "",           PaNL,   PaNL,             TROE_SPILL_DESC          },
   { "-ssPort",                &socketServicePort,       "SOCKET_SERVICE_PORT",       PaUShort,  PaHid,  1027,            PaNL,   PaNL,             SOCKET_SERVICE_PORT_DESC },
   { "-forwarding",            &forwarding,              "FORWARDING",                PaBool,    PaOpt,  false,           false,  true,             FORWARDING_DESC          },
+  { "-forwardTimeout",        &forwardTimeout,          "FORWARD_TIMEOUT",           PaInt,     PaOpt,  5000,            1,      60000,            FORWARD_TMO_DESC         },
+  { "-mqttMaxInFlight",       &mqttMaxInFlight,         "MQTT_MAX_IN_FLIGHT",        PaInt,     PaOpt,  20,              1,      65535,            MQTT_MAX_IN_FLIGHT_DESC  },
+  { "-subCountersFlush",      &subCountersFlush,        "SUB_COUNTERS_FLUSH",        PaInt,     PaOpt,  500,             0,      60000,            SUB_COUNTERS_FLUSH_DESC  },
+  { "-notifPoolSize",         &notifPoolSize,           "NOTIF_POOL_SIZE",           PaInt,     PaOpt,  10,              0,      1000,             NOTIF_POOL_SIZE_DESC     },
+  { "-notifIdleTimeout",      &notifIdleTimeout,        "NOTIF_IDLE_TIMEOUT",        PaInt,     PaOpt,  30,              1,      3600,             NOTIF_IDLE_TMO_DESC      },
+  { "-notifMaxConns",         &notifMaxConns,           "NOTIF_MAX_CONNS",           PaInt,     PaOpt,  100,             0,      10000,            NOTIF_MAX_CONNS_DESC     },
+  { "-notifSenders",          &notifSenders,            "NOTIF_SENDERS",             PaInt,     PaOpt,  0,               0,      256,              NOTIF_SENDERS_DESC       },
+  { "-notifQueueSize",        &notifQueueSize,          "NOTIF_QUEUE_SIZE",          PaInt,     PaOpt,  10000,           1,      10000000,         NOTIF_QUEUE_SIZE_DESC    },
+  { "-notifQueuePolicy",      notifQueuePolicy,         "NOTIF_QUEUE_POLICY",        PaString,  PaOpt,  _i "dropNew",    PaNL,   PaNL,             NOTIF_QUEUE_POL_DESC     },
+  { "-entityIdUnique",        &entityIdUnique,          "MONGO_ENTITY_ID_UNIQUE",    PaBool,    PaOpt,  false,           false,  true,             ENTITY_ID_UNIQUE_DESC    },
 
   PA_END_OF_ARGS
 };
@@ -621,13 +674,33 @@ void exitFunc(void)
     LM_T(LmtSoftError, ("error removing PID file '%s': %s", pidPath, strerror(errno)));
   }
 #endif
-  // Free the tenant list
-  for (unsigned int ix = 0; ix < tenants; ix++)
-    free(tenantV[ix]);
+  // Save the subscription counters that are still buffered
+  mongoLdSubCountersFlush();
+
+  // Save what's left to save of the entity-type catalogs, before the tenants are freed
+  dbTypeCatalogFlush();
+  dbTypeCatalogRelease(&tenant0.typeCatalog);
+
+  // Free the tenant registry
+  OrionldTenant* tenantP = tenantList;
+  while (tenantP != NULL)
+  {
+    OrionldTenant* next = tenantP->listNext;
+
+    dbTypeCatalogRelease(&tenantP->typeCatalog);
+    free(tenantP);
+    tenantP = next;
+  }
 
   // Disconnect from all MQTT btokers and free the connections
   mqttRelease();
 
+  // Close all idle keep-alive connections to notification endpoints
+  notificationConnectionPoolRelease();
+
+  // Close all pooled connections to postgres
+  pgConnectionPoolRelease();
+
   // Free up the context download list, if needed
   contextDownloadListRelease();
 }
@@ -1088,6 +1161,7 @@ int main(int argC, char* argV[])
   mongoInit(dbHost, rplSet, dbName, dbUser, dbPwd, multitenancy, dbTimeout, writeConcern, dbPoolSize, statSemWait);
   alarmMgr.init(relogAlarms);
   metricsMgr.init(!disableMetrics, statSemWait);
+  orionldLatencyInit();
   logSummaryInit(&lsPeriod);
 
   // According to http://stackoverflow.com/questions/28048885/initializing-ssl-and-libcurl-and-getting-out-of-memory/37295100,
@@ -1126,6 +1200,7 @@ int main(int argC, char* argV[])
   else
   {
     LM_T(LmtSubCache, ("noCache == false"));
+    mongoLdSubCountersInit(subCountersFlush);
   }
 
   //
@@ -1144,7 +1219,12 @@ int main(int argC, char* argV[])
   // Initialize orionld
   //
   contextDownloadListInit();
+  notificationConnectionPoolInit();
+  notificationOutcomeInit();
+  if (notifSenders > 0)
+    notificationSenderInit(notifSenders, notifQueueSize, notifQueuePolicy);
   orionldServiceInit(restServiceVV, 9, getenv("ORIONLD_CACHED_CONTEXT_DIRECTORY"));
+
   dbInit(dbHost, dbName);
 
   //
@@ -1167,6 +1247,11 @@ int main(int argC, char* argV[])
   //
   contextBrokerInit(dbName, multitenancy);
 
+  //
+  // The entity-type catalogs (for GET /types) are kept in memory and saved in the database by a thread of their own
+  //
+  dbTypeCatalogInit(1);
+
   if (https)
   {
     char* httpsPrivateServerKey = (char*) malloc(2048);
@@ -52,6 +52,7 @@
 #include "orionld/serviceRoutines/orionldGetEntityTypes.h"
 #include "orionld/serviceRoutines/orionldGetTenants.h"
 #include "orionld/serviceRoutines/orionldGetDbIndexes.h"
+#include "orionld/serviceRoutines/orionldGetLatency.h"
 #include "orionld/serviceRoutines/orionldPostQuery.h"
 
 #include "orionld/rest/OrionLdRestService.h"       // OrionLdRestServiceSimplified
@@ -77,6 +78,7 @@ static OrionLdRestServiceSimplified getServiceV[] =
   { "/ngsi-ld/ex/v1/version",              orionldGetVersion         },
   { "/ngsi-ld/ex/v1/tenants",              orionldGetTenants         },
   { "/ngsi-ld/ex/v1/dbIndexes",            orionldGetDbIndexes       },
+  { "/ngsi-ld/ex/v1/latency",              orionldGetLatency         },
   { "/ngsi-ld/v1/temporal/entities",       orionldNotImplemented     },
   { "/ngsi-ld/v1/temporal/entities/*",     orionldNotImplemented     }
 };
@@ -40,6 +40,7 @@
 #include "ngsi10/SubscribeContextRequest.h"
 #include "alarmMgr/alarmMgr.h"
 #include "orionld/common/orionldState.h"        // orionldState
+#include "orionld/mongoBackend/mongoLdSubCounters.h"  // mongoLdSubCountersStatus
 #include "cache/subCache.h"
 
 using std::map;
@@ -1260,6 +1261,10 @@ void subCacheItemNotificationErrorStatus(const std::string& tenant, const std::s
 {
   if (noCache)
   {
+    // Buffered and flushed in bulk, unless the buffering is turned off
+    if (mongoLdSubCountersStatus(tenant, subscriptionId, errors == 0, orionldState.requestTime) == true)
+      return;
+
     // The field 'count' has already been taken care of. Set to 0 in the calls to mongoSubCountersUpdate()
     if (errors == 0)
       mongoSubCountersUpdate(tenant, subscriptionId, 0, orionldState.requestTime, -1, orionldState.requestTime);  // lastFailure == -1
@@ -23,10 +23,13 @@
 * Author: Ken Zangelin
 */
 #include <stdint.h>   // int64_t et al
+#include <stdlib.h>   // calloc, free
+#include <string.h>   // strdup, strcmp
 #include <sys/time.h>
 
 #include <utility>
 #include <string>
+#include <vector>
 #include <map>
 
 #include "logMsg/logMsg.h"
@@ -35,6 +38,7 @@
 #include "common/JsonHelper.h"
 #include "rest/rest.h"
 #include "rest/RestService.h"
+#include "orionld/common/fnvHash.h"
 #include "metricsMgr/MetricsManager.h"
 
 
@@ -48,12 +52,48 @@
 
 
 
+/* ****************************************************************************
+*
+* MetricInfo - name of a metric (JSON rendering) and its Prometheus counterpart
+*
+* The Prometheus value is the counter value divided by 'promDivisor' (microseconds to seconds)
+*/
+typedef struct MetricInfo
+{
+  const char*  name;
+  const char*  promName;
+  const char*  promHelp;
+  double       promDivisor;
+} MetricInfo;
+
+
+
+/* ****************************************************************************
+*
+* metricV - indexed by MetricId
+*/
+static const MetricInfo metricV[METRICS] =
+{
+  { "incomingTransactions",            "orionld_incoming_transactions_total",                    "Incoming requests",                                  1       },
+  { "incomingTransactionRequestSize",  "orionld_incoming_transaction_request_size_bytes_total",  "Accumulated size of incoming request payloads",      1       },
+  { "incomingTransactionResponseSize", "orionld_incoming_transaction_response_size_bytes_total", "Accumulated size of response payloads",              1       },
+  { "incomingTransactionErrors",       "orionld_incoming_transaction_errors_total",              "Incoming requests ending in error",                  1       },
+  { "_totalServiceTime",               "orionld_service_time_seconds_total",                     "Accumulated time serving incoming requests",         1000000 },
+  { "outgoingTransactions",            "orionld_outgoing_transactions_total",                    "Outgoing requests (notifications, forwarding)",      1       },
+  { "outgoingTransactionRequestSize",  "orionld_outgoing_transaction_request_size_bytes_total",  "Accumulated size of outgoing request payloads",      1       },
+  { "outgoingTransactionResponseSize", "orionld_outgoing_transaction_response_size_bytes_total", "Accumulated size of responses to outgoing requests", 1       },
+  { "outgoingTransactionErrors",       "orionld_outgoing_transaction_errors_total",              "Outgoing requests ending in error",                  1       }
+};
+
+
+
 /* ****************************************************************************
 *
 * MetricsManager::MetricsManager -
 */
 MetricsManager::MetricsManager(): on(false), semWaitStatistics(false), semWaitTime(0)
 {
+  memset(&registry, 0, sizeof(registry));
 }
 
 
@@ -94,6 +134,67 @@ bool MetricsManager::subServiceValid(const std::string& subsrv)
 
 
 
+/* ****************************************************************************
+*
+* MetricsKeyProbe - what a MetricsKey is looked up by (and created from)
+*/
+typedef struct MetricsKeyProbe
+{
+  const char*         srv;
+  const char*         subServ;
+  const std::string*  subServiceP;  // Only for metricsKeyCreate
+} MetricsKeyProbe;
+
+
+
+/* ****************************************************************************
+*
+* metricsKeyMatch - ShardRegistryMatch for MetricsKey
+*/
+static bool metricsKeyMatch(const void* dataP, const void* probeP)
+{
+  const MetricsKey*       keyP  = (const MetricsKey*) dataP;
+  const MetricsKeyProbe*  probe = (const MetricsKeyProbe*) probeP;
+
+  return (strcmp(keyP->tenant, probe->srv) == 0) && (strcmp(keyP->servicePath, probe->subServ) == 0);
+}
+
+
+
+/* ****************************************************************************
+*
+* metricsKeyCreate - ShardRegistryCreate for MetricsKey
+*/
+static void* metricsKeyCreate(const void* probeP)
+{
+  const MetricsKeyProbe*  probe = (const MetricsKeyProbe*) probeP;
+  MetricsKey*             keyP  = new MetricsKey();
+
+  keyP->tenant       = strdup(probe->srv);
+  keyP->servicePath  = strdup(probe->subServ);
+  keyP->service      = probe->srv;
+  keyP->subService   = *probe->subServiceP;
+
+  return keyP;
+}
+
+
+
+/* ****************************************************************************
+*
+* metricsKeyRelease - ShardRegistryRelease for MetricsKey
+*/
+static void metricsKeyRelease(void* dataP)
+{
+  MetricsKey* keyP = (MetricsKey*) dataP;
+
+  free(keyP->tenant);
+  free(keyP->servicePath);
+  delete keyP;
+}
+
+
+
 /* ****************************************************************************
 *
 * MetricsManager::init -
@@ -114,7 +215,15 @@ bool MetricsManager::init(bool _on, bool _semWaitStatistics)
     return false;
   }
 
-  return true;
+  return shardRegistryInit(&registry,
+                           "metrics (service/sub-service pairs)",
+                           METRICS_KEY_MAX,
+                           METRICS_KEY_BUCKETS,
+                           METRICS_KEY_CHUNK_SIZE,
+                           METRICS * sizeof(uint64_t),
+                           metricsKeyMatch,
+                           metricsKeyCreate,
+                           metricsKeyRelease);
 }
 
 
@@ -233,100 +342,145 @@ bool MetricsManager::servicePathForMetrics(const std::string& spathIn, std::stri
 
 /* ****************************************************************************
 *
-* MetricsManager::add -
+* keyHash - FNV-1a hash of service + sub-service
+*/
+static unsigned int keyHash(const char* srv, const char* subServ)
+{
+  unsigned int hash = fnvHash(FNV_HASH_INIT, srv, -1);
+
+  hash = fnvHash(hash, "\n", 1);  // Separator, so that "ab"+"c" != "a"+"bc"
+
+  return fnvHash(hash, subServ, -1);
+}
+
+
+
+/* ****************************************************************************
+*
+* MetricsManager::keyIntern - validate and add a new key
 *
-* FIXME P4: About the calls to serviceValid and subServiceValid:
-*   we check that 'srv' and 'subServ' are legal names, and if not, metrics are skipped.
-*   Doing this each time add() is called is not optimal for performance.
-*   The github issue #2781 is about better solutions for this.
-*   Note that the call to subServiceValid is inside servicePathForMetrics()
+* The tenant and service path are validated once, when the key is created. Invalid ones are
+* not interned (and validated again for the next request using them).
+*
+* Once the registry is full, new pairs are dropped right away, not even validated.
 */
-void MetricsManager::add(const std::string& srv, const std::string& subServ, const std::string& metric, uint64_t value)
+int MetricsManager::keyIntern(const char* srv, const char* subServ, unsigned int hash)
 {
-  std::string subService = "not-set";
+  std::string subService;
 
-  if (on == false)
+  if (shardRegistryFull(&registry) == true)
   {
-    return;
+    return -1;
   }
 
   if (serviceValid(srv) == false)
   {
-    return;
+    return -1;
   }
 
   if (servicePathForMetrics(subServ, &subService) == false)
   {
-    return;
+    return -1;
   }
 
-  semTake();
+  MetricsKeyProbe probe = { srv, subServ, &subService };
 
+  return shardRegistryKeyIntern(&registry, &probe, hash);
+}
 
-  // Do we have the service in the map?
-  if (metrics.find(srv) == metrics.end())
+
+
+/* ****************************************************************************
+*
+* MetricsManager::add -
+*
+* No lock is taken: the key (service + sub-service) is looked up in the table of interned keys
+* and the counter of the calling thread's shard is incremented.
+*
+* A counter is only written by the thread owning the shard, so the increment needs no
+* atomic read-modify-write, only atomic load and store, for the readers (snapshot) to see
+* whole values.
+*/
+void MetricsManager::add(const char* srv, const char* subServ, MetricId metric, uint64_t value)
+{
+  if (on == false)
   {
-    // not found: create it
-    metrics[srv] = new std::map<std::string, std::map<std::string, uint64_t>*>;
+    return;
   }
 
-  // Do we have the subservice in the map?
-  if (metrics[srv]->find(subService) == metrics[srv]->end())
+  MetricsKeyProbe  probe = { srv, subServ, NULL };
+  unsigned int     hash  = keyHash(srv, subServ);
+  int              keyIx = shardRegistryKeyLookup(&registry, &probe, hash);
+
+  if ((keyIx == -1) && ((keyIx = keyIntern(srv, subServ, hash)) == -1))
   {
-    //
-    // Not Found: create it
-    //
-    metrics[srv]->insert(std::pair<std::string, std::map<std::string, uint64_t>*>
-                         (subService,
-                          new std::map<std::string, uint64_t>));
+    return;
   }
 
-  // Do we have the metric in the map?
-  if (metrics[srv]->at(subService)->find(metric) == metrics[srv]->at(subService)->end())
+  uint64_t* countersP = (uint64_t*) shardRegistrySlot(&registry, keyIx);
+
+  if (countersP == NULL)
   {
-    //
-    // Not Found: create it
-    //
-    metrics[srv]->at(subService)->insert(std::pair<std::string, uint64_t>(metric, 0));
+    return;
   }
 
-  metrics[srv]->at(subService)->at(metric) += value;
+  uint64_t* counterP = &countersP[metric];
 
-  semGive();
+  __atomic_store_n(counterP, __atomic_load_n(counterP, __ATOMIC_RELAXED) + value, __ATOMIC_RELAXED);
 }
 
 
 
 /* ****************************************************************************
 *
-* MetricsManager::_reset -
+* metricsSum - ShardRegistrySlotTreat adding the counters of a slot to the sums of the key
 */
-void MetricsManager::_reset(void)
+static void metricsSum(const void* slotP, void* paramP)
 {
-  //
-  // Three iterators needed to iterate over the 'triple-map' metrics:
-  //   serviceIter      to iterate over all services
-  //   subServiceIter   to iterate over all sub-services of a service
-  //   metricIter       to iterate over all metrics of a sub-service
-  //
-  std::map<std::string, std::map<std::string, std::map<std::string, uint64_t>*>*>::iterator  serviceIter;
-  std::map<std::string, std::map<std::string, uint64_t>*>::iterator                          subServiceIter;
-  std::map<std::string, uint64_t>::iterator                                                  metricIter;
+  const uint64_t*  countersP = (const uint64_t*) slotP;
+  uint64_t*        sumP      = (uint64_t*) paramP;
 
-  for (serviceIter = metrics.begin(); serviceIter != metrics.end(); ++serviceIter)
+  for (int metric = 0; metric < METRICS; ++metric)
   {
-    std::map<std::string, std::map<std::string, uint64_t>*>* servMap  = serviceIter->second;
+    sumP[metric] += __atomic_load_n(&countersP[metric], __ATOMIC_RELAXED);
+  }
+}
 
-    for (subServiceIter = servMap->begin(); subServiceIter != servMap->end(); ++subServiceIter)
-    {
-      std::map<std::string, uint64_t>* metricMap  = subServiceIter->second;
 
-      for (metricIter = metricMap->begin(); metricIter != metricMap->end(); ++metricIter)
-      {
-        metricIter->second = 0;
-      }
-    }
+
+/* ****************************************************************************
+*
+* MetricsManager::snapshot - sum up the counters of all shards
+*
+* sumV is indexed by key index * METRICS + metric.
+* Returns the number of keys in sumV - keys created after the snapshot are not included.
+*/
+int MetricsManager::snapshot(std::vector<uint64_t>* sumV)
+{
+  int keys = shardRegistryKeys(&registry);
+
+  sumV->assign(keys * METRICS, 0);
+
+  for (int keyIx = 0; keyIx < keys; ++keyIx)
+  {
+    shardRegistrySlotForEach(&registry, keyIx, metricsSum, &(*sumV)[keyIx * METRICS]);
   }
+
+  return keys;
+}
+
+
+
+/* ****************************************************************************
+*
+* MetricsManager::_reset -
+*
+* The counters themselves are never zeroed (they belong to the threads that write them).
+* Instead, their current values are saved as the baseline, and subtracted when rendering.
+*/
+void MetricsManager::_reset(void)
+{
+  snapshot(&baseline);
 }
 
 
@@ -347,11 +501,11 @@ static std::string metricsRender(std::map<std::string, uint64_t>* metricsMap)
     std::string      metric = it->first;
     int64_t          value  = it->second;
 
-    if (metric == _METRIC_TOTAL_SERVICE_TIME)
+    if (metric == metricV[_METRIC_TOTAL_SERVICE_TIME].name)
     {
       totalServiceTime = value;
     }
-    else if (metric == METRIC_TRANS_IN)
+    else if (metric == metricV[METRIC_TRANS_IN].name)
     {
       incomingTransactions = value;
     }
@@ -365,7 +519,7 @@ static std::string metricsRender(std::map<std::string, uint64_t>* metricsMap)
       incomingTransactions = 0;
     }
 
-    if (metric != _METRIC_TOTAL_SERVICE_TIME)
+    if (metric != metricV[_METRIC_TOTAL_SERVICE_TIME].name)
     {
       if (value != 0)
       {
@@ -382,17 +536,41 @@ static std::string metricsRender(std::map<std::string, uint64_t>* metricsMap)
 /* ****************************************************************************
 *
 * MetricsManager::_toJson -
+*
+* The aggregated counters (minus the baseline of the last reset) are first put in a 'triple-map'
+* service/sub-service/metric. Different keys may end up in the same service/sub-service (e.g.
+* service paths "/a" and "/a/#"), so the values are added.
 */
 std::string MetricsManager::_toJson(void)
 {
+  std::map<std::string, std::map<std::string, std::map<std::string, uint64_t> > >  metrics;
+  std::vector<uint64_t>                                                           sumV;
+  int                                                                             keys = snapshot(&sumV);
+
+  for (int keyIx = 0; keyIx < keys; ++keyIx)
+  {
+    MetricsKey* keyP = (MetricsKey*) shardRegistryKeyData(&registry, keyIx);
+
+    for (int metric = 0; metric < METRICS; ++metric)
+    {
+      int       vIx   = keyIx * METRICS + metric;
+      uint64_t  value = sumV[vIx] - ((vIx < (int) baseline.size())? baseline[vIx] : 0);
+
+      if (value != 0)
+      {
+        metrics[keyP->service][keyP->subService][metricV[metric].name] += value;
+      }
+    }
+  }
+
   //
   // Three iterators needed to iterate over the 'triple-map' metrics:
   //   serviceIter      to iterate over all services
   //   subServiceIter   to iterate over all sub-services of a service
   //   metricIter       to iterate over all metrics of a sub-service
   //
-  std::map<std::string, std::map<std::string, std::map<std::string, uint64_t>*>*>::iterator  serviceIter;
-  std::map<std::string, std::map<std::string, uint64_t>*>::iterator                          subServiceIter;
+  std::map<std::string, std::map<std::string, std::map<std::string, uint64_t> > >::iterator  serviceIter;
+  std::map<std::string, std::map<std::string, uint64_t> >::iterator                          subServiceIter;
   std::map<std::string, uint64_t>::iterator                                                  metricIter;
   JsonHelper                                                                                 top;
   JsonHelper                                                                                 services;
@@ -404,14 +582,13 @@ std::string MetricsManager::_toJson(void)
     JsonHelper                                                subServiceTop;
     JsonHelper                                                jhSubService;
     std::string                                               service        = serviceIter->first;
-    std::map<std::string, std::map<std::string, uint64_t>*>*  servMap        = serviceIter->second;
+    std::map<std::string, std::map<std::string, uint64_t> >*  servMap        = &serviceIter->second;
     std::map<std::string, uint64_t>                           serviceSum;
 
     for (subServiceIter = servMap->begin(); subServiceIter != servMap->end(); ++subServiceIter)
     {
-      JsonHelper                        jhMetrics;
       std::string                       subService           = subServiceIter->first;
-      std::map<std::string, uint64_t>*  metricMap            = subServiceIter->second;
+      std::map<std::string, uint64_t>*  metricMap            = &subServiceIter->second;
 
       for (metricIter = metricMap->begin(); metricIter != metricMap->end(); ++metricIter)
       {
@@ -419,12 +596,9 @@ std::string MetricsManager::_toJson(void)
         int64_t      value  = metricIter->second;
 
         // Add to 'sum-maps'
-        if (value != 0)
-        {
-          serviceSum[metric] += value;
-          sum[metric]        += value;
-          subServCrossTenant[subService][metric] += value;
-        }
+        serviceSum[metric] += value;
+        sum[metric]        += value;
+        subServCrossTenant[subService][metric] += value;
       }
 
       std::string subServiceString = metricsRender(metricMap);
@@ -451,13 +625,6 @@ std::string MetricsManager::_toJson(void)
       //
       // Skipping empty tenant
       //
-      // Remember - when doing reset of the metrics, emptied tenants aren't removed.
-      // They are only emptied, to save the time of delete and then create again.
-      // [ Most likely they will be needed soon after the reset ]
-      //
-      // But, we don't want to show those 'emptied tenants' in the metrics output
-      // so, we skip those tenants, calling 'continue' right here
-      //
       continue;
     }
 
@@ -482,7 +649,6 @@ std::string MetricsManager::_toJson(void)
   std::map<std::string, std::map<std::string, uint64_t> >::iterator  it;
   for (it = subServCrossTenant.begin();  it != subServCrossTenant.end(); ++it)
   {
-    JsonHelper   jhSubServCross;
     std::string  subService = it->first;
     std::string  subServiceString;
 
@@ -511,6 +677,102 @@ std::string MetricsManager::_toJson(void)
 
 
 
+/* ****************************************************************************
+*
+* promLabelValue - escape a Prometheus label value (backslash, double-quote and newline)
+*/
+static std::string promLabelValue(const std::string& value)
+{
+  std::string out;
+
+  for (unsigned int ix = 0; ix < value.length(); ++ix)
+  {
+    char c = value[ix];
+
+    if      (c == '\\') out += "\\\\";
+    else if (c == '"')  out += "\\\"";
+    else if (c == '\n') out += "\\n";
+    else                out += c;
+  }
+
+  return out;
+}
+
+
+
+/* ****************************************************************************
+*
+* MetricsManager::toPrometheus - the metrics in Prometheus text exposition format (version 0.0.4)
+*
+* Prometheus counters are monotonic, so the baseline of the last reset (DELETE /admin/metrics or
+* GET /admin/metrics?reset=true) is not subtracted here.
+* The labels 'service' and 'subservice' have the same values as the keys in the JSON rendering.
+*/
+std::string MetricsManager::toPrometheus(void)
+{
+  if (on == false)
+  {
+    return "";
+  }
+
+  std::map<std::string, std::map<std::string, std::vector<uint64_t> > >  metrics;
+  std::vector<uint64_t>                                                 sumV;
+
+  semTake();
+
+  int keys = snapshot(&sumV);
+
+  for (int keyIx = 0; keyIx < keys; ++keyIx)
+  {
+    MetricsKey*             keyP       = (MetricsKey*) shardRegistryKeyData(&registry, keyIx);
+    const std::string&      service    = (keyP->service    != "")? keyP->service    : DEFAULT_SERVICE_KEY_FOR_METRICS;
+    const std::string&      subService = (keyP->subService != "")? keyP->subService : ROOT_SUB_SERVICE_KEY_FOR_METRICS;
+    std::vector<uint64_t>*  valueV     = &metrics[service][subService];
+
+    valueV->resize(METRICS, 0);
+
+    for (int metric = 0; metric < METRICS; ++metric)
+    {
+      (*valueV)[metric] += sumV[keyIx * METRICS + metric];
+    }
+  }
+
+  semGive();
+
+  std::string out;
+  char        line[128];
+
+  for (int metric = 0; metric < METRICS; ++metric)
+  {
+    out += std::string("# HELP ") + metricV[metric].promName + " " + metricV[metric].promHelp + "\n";
+    out += std::string("# TYPE ") + metricV[metric].promName + " counter\n";
+
+    std::map<std::string, std::map<std::string, std::vector<uint64_t> > >::iterator  serviceIter;
+    std::map<std::string, std::vector<uint64_t> >::iterator                          subServiceIter;
+
+    for (serviceIter = metrics.begin(); serviceIter != metrics.end(); ++serviceIter)
+    {
+      for (subServiceIter = serviceIter->second.begin(); subServiceIter != serviceIter->second.end(); ++subServiceIter)
+      {
+        uint64_t value = subServiceIter->second[metric];
+
+        if (metricV[metric].promDivisor != 1)
+          snprintf(line, sizeof(line), "%f", (double) value / metricV[metric].promDivisor);
+        else
+          snprintf(line, sizeof(line), "%llu", (unsigned long long) value);
+
+        out += std::string(metricV[metric].promName) +
+          "{service=\"" + promLabelValue(serviceIter->first) + "\",subservice=\"" + promLabelValue(subServiceIter->first) + "\"} " +
+          line + "\n";
+      }
+    }
+  }
+
+  return out;
+}
+
+
+
 /* ****************************************************************************
 *
 * isOn - 
@@ -548,6 +810,8 @@ const char* MetricsManager::semStateGet(void)
 /* ****************************************************************************
 *
 * MetricsManager::release -
+*
+* Called at exit. Metrics are turned off first, so that no new counters are added.
 */
 void MetricsManager::release(void)
 {
@@ -557,30 +821,10 @@ void MetricsManager::release(void)
   }
 
   semTake();
+  on = false;
 
-  //
-  // Two iterators needed to iterate over metrics, clearing all maps:
-  //   serviceIter      to iterate over all services
-  //   subServiceIter   to iterate over all sub-services of a service
-  //
-  std::map<std::string, std::map<std::string, std::map<std::string, uint64_t>*>*>::iterator  serviceIter;
-  std::map<std::string, std::map<std::string, uint64_t>*>::iterator                          subServiceIter;
-
-  for (serviceIter = metrics.begin(); serviceIter != metrics.end(); ++serviceIter)
-  {
-    std::map<std::string, std::map<std::string, uint64_t>*>* servMap  = serviceIter->second;
-
-    for (subServiceIter = servMap->begin(); subServiceIter != servMap->end(); ++subServiceIter)
-    {
-      std::map<std::string, uint64_t>*  metricMap  = subServiceIter->second;
-
-      metricMap->clear();
-      delete metricMap;
-    }
-    servMap->clear();
-    delete servMap;
-  }
-  metrics.clear();
+  shardRegistryRelease(&registry);
+  baseline.clear();
 
   semGive();
 }
@@ -28,37 +28,46 @@
 #include <stdint.h>   // int64_t et al
 #include <semaphore.h>
 
-#include <utility>
 #include <string>
-#include <map>
+#include <vector>
+
+#include "orionld/common/shardRegistry.h"  // ShardRegistry
 
 
 
 /* ****************************************************************************
 *
-* Metrics - 
+* MetricId - the metrics, as indexes in the counter arrays
 *
 * NOTE
-*   _METRIC_TOTAL_SERVICE_TIME is in the metrics map but excluded from
-*   the metric response, while METRIC_SERVICE_TIME is NOT in the metrics map, but
+*   _METRIC_TOTAL_SERVICE_TIME is in the metrics registry but excluded from
+*   the metric response, while METRIC_SERVICE_TIME is NOT in the metrics registry, but
 *   include in the metric response.
 *   METRIC_SERVICE_TIME == _METRIC_TOTAL_SERVICE_TIME / METRIC_TRANS_IN
 *
 *   All 'help-counters' in the set, like _METRIC_TOTAL_SERVICE_TIME will have the
 *   prefix '_', to help remember it's a help measure.
-*   A prefix'_' in both macro name and in its string translation
+*   A prefix'_' in both enum name and in its string translation
+*
+*   The metric names, as rendered, are in the table metricV (MetricsManager.cpp)
 */
-#define METRIC_TRANS_IN                            "incomingTransactions"
-#define METRIC_TRANS_IN_REQ_SIZE                   "incomingTransactionRequestSize"
-#define METRIC_TRANS_IN_RESP_SIZE                  "incomingTransactionResponseSize"
-#define METRIC_TRANS_IN_ERRORS                     "incomingTransactionErrors"
-#define METRIC_SERVICE_TIME                        "serviceTime"
-#define _METRIC_TOTAL_SERVICE_TIME                 "_totalServiceTime"
+typedef enum MetricId
+{
+  METRIC_TRANS_IN = 0,                  // "incomingTransactions"
+  METRIC_TRANS_IN_REQ_SIZE,             // "incomingTransactionRequestSize"
+  METRIC_TRANS_IN_RESP_SIZE,            // "incomingTransactionResponseSize"
+  METRIC_TRANS_IN_ERRORS,               // "incomingTransactionErrors"
+  _METRIC_TOTAL_SERVICE_TIME,           // "_totalServiceTime"
+
+  METRIC_TRANS_OUT,                     // "outgoingTransactions"
+  METRIC_TRANS_OUT_REQ_SIZE,            // "outgoingTransactionRequestSize"
+  METRIC_TRANS_OUT_RESP_SIZE,           // "outgoingTransactionResponseSize"
+  METRIC_TRANS_OUT_ERRORS,              // "outgoingTransactionErrors"
+
+  METRICS                               // Number of metrics - must be the last item
+} MetricId;
 
-#define METRIC_TRANS_OUT                           "outgoingTransactions"
-#define METRIC_TRANS_OUT_REQ_SIZE                  "outgoingTransactionRequestSize"
-#define METRIC_TRANS_OUT_RESP_SIZE                 "outgoingTransactionResponseSize"
-#define METRIC_TRANS_OUT_ERRORS                    "outgoingTransactionErrors"
+#define METRIC_SERVICE_TIME                        "serviceTime"
 
 #if 0
 //
@@ -101,6 +110,41 @@
 
 
 
+/* ****************************************************************************
+*
+* Sizes of the metrics registry
+*
+* METRICS_KEY_MAX         max number of service/sub-service pairs (keys) - metrics of pairs beyond that are dropped
+* METRICS_KEY_CHUNK_SIZE  the counters of a shard are allocated in chunks of this many keys
+* METRICS_KEY_BUCKETS     buckets of the hash table of keys
+*/
+#define METRICS_KEY_MAX          4096
+#define METRICS_KEY_CHUNK_SIZE   64
+#define METRICS_KEY_BUCKETS      256
+
+
+
+/* ****************************************************************************
+*
+* MetricsKey - an interned service/sub-service pair
+*
+* The pair is interned as received (tenant and service path), so that no string needs
+* to be built nor validated when adding to a counter. 'service' and 'subService' are the
+* names used when rendering (the service path without its initial '/' and its '/#').
+*
+* The keys, and the per-thread counters (a slot of METRICS counters per key and thread),
+* are kept in a ShardRegistry.
+*/
+typedef struct MetricsKey
+{
+  char*               tenant;
+  char*               servicePath;
+  std::string         service;
+  std::string         subService;
+} MetricsKey;
+
+
+
 /* ****************************************************************************
 *
 * MetricsManager -
@@ -117,15 +161,18 @@
 *     for metrics
 * 11. Try to come up with better solution for metrics for requests using invalid service-path / tenant?
 *
+* The semaphore protects the reading of the metrics (toJson, toPrometheus, reset).
+* 'add' takes no lock (the registry only locks to create keys and shards).
 */
 class MetricsManager
 {
  private:
-  std::map<std::string, std::map<std::string, std::map<std::string, uint64_t>*>*>  metrics;
-  bool            on;
-  sem_t           sem;
-  bool            semWaitStatistics;
-  int64_t         semWaitTime;        // measured in microseconds
+  ShardRegistry          registry;           // The service/sub-service pairs and the per-thread counters
+  std::vector<uint64_t>  baseline;           // Counter values at the last reset - what's rendered is the difference
+  bool                   on;
+  sem_t                  sem;
+  bool                   semWaitStatistics;
+  int64_t                semWaitTime;        // measured in microseconds
 
   void            semTake(void);
   void            semGive(void);
@@ -134,14 +181,21 @@ class MetricsManager
   bool            serviceValid(const std::string& srv);
   bool            subServiceValid(const std::string& subsrv);
   bool            servicePathForMetrics(const std::string& spath, std::string* subServiceP);
+  int             keyIntern(const char* srv, const char* subServ, unsigned int hash);
+  int             snapshot(std::vector<uint64_t>* sumV);
 
  public:
   MetricsManager();
 
   bool         init(bool _on, bool _semWaitStatistics);
-  void         add(const std::string& srv, const std::string& subServ, const std::string& metric, uint64_t value);
+  void         add(const char* srv, const char* subServ, MetricId metric, uint64_t value);
+  void         add(const std::string& srv, const std::string& subServ, MetricId metric, uint64_t value)
+  {
+    add(srv.c_str(), subServ.c_str(), metric, value);
+  }
   void         reset(void);
   std::string  toJson(bool doReset);
+  std::string  toPrometheus(void);
   bool         isOn(void);
   int64_t      semWaitTimeGet(void);
   const char*  semStateGet(void);
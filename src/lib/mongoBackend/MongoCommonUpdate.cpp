@@ -59,7 +59,11 @@ extern "C"
 
 #include "orionld/common/orionldState.h"                           // orionldState
 #include "orionld/common/geoJsonCreate.h"                          // geoJsonCreate
-#include "orionld/db/dbConfiguration.h"                            // dbDataFromKjTree
+#include "orionld/mongoCppLegacy/mongoCppLegacyKjTreeToBsonObj.h"    // mongoCppLegacyKjTreeToBsonObj
+#include "orionld/mongoBackend/mongoLdBatch.h"                     // mongoLdBatchLookup, mongoLdBatchInsert, mongoLdBatchUpdate, mongoLdBatchDefer
+#include "orionld/mongoBackend/mongoLdSubCounters.h"               // mongoLdSubCountersNotification
+#include "orionld/mongoBackend/mongoLdEntityInsert.h"              // mongoLdEntityInsert
+#include "orionld/db/dbTypeCatalogUpdate.h"                        // dbTypeCatalogUpdate
 #endif
 
 #include "mongoBackend/connectionOperations.h"
@@ -2171,8 +2175,13 @@ static bool processSubscriptions
     {
       //
       // If broker running without subscription cache, put lastNotificationTime and count in DB
+      // (buffered and flushed in bulk by the mongoLdSubCounters module, unless it is turned off)
       //
+#ifdef ORIONLD
+      if ((subCacheActive == false) && (mongoLdSubCountersNotification(tenant, mapSubId, orionldState.requestTime) == false))
+#else
       if (subCacheActive == false)
+#endif
       {
         BSONObj query  = BSON("_id" << OID(mapSubId));
         BSONObj update = BSON("$set" <<
@@ -2924,6 +2933,309 @@ static bool processContextAttributeVector
 
 
 
+#ifdef ORIONLD
+/* ****************************************************************************
+*
+* attrNameSetFromArray - add the strings of a BSON array of attribute names to a set
+*/
+static void attrNameSetFromArray(const BSONObj& attrNameArray, std::set<std::string>* attrNameSetP)
+{
+  mongo::BSONObjIterator iter(attrNameArray);
+
+  while (iter.more())
+  {
+    BSONElement attrName = iter.next();
+
+    if (attrName.type() == mongo::String)
+    {
+      attrNameSetP->insert(attrName.String());
+    }
+  }
+}
+
+
+
+/* ****************************************************************************
+*
+* typeCatalogUpdate - apply the change in the attribute set of an entity to the type catalog of the tenant
+*
+* Entities without type are not part of the type catalog (GET /types).
+*/
+static void typeCatalogUpdate
+(
+  const std::string&            entityType,
+  int                           entityDelta,
+  const std::set<std::string>&  attrNamesBefore,
+  const std::set<std::string>&  attrNamesAfter
+)
+{
+  std::vector<const char*> addedV;
+  std::vector<const char*> removedV;
+
+  if (entityType == "")
+  {
+    return;
+  }
+
+  for (std::set<std::string>::const_iterator i = attrNamesAfter.begin(); i != attrNamesAfter.end(); ++i)
+  {
+    if (attrNamesBefore.find(*i) == attrNamesBefore.end())
+    {
+      addedV.push_back(i->c_str());
+    }
+  }
+
+  for (std::set<std::string>::const_iterator i = attrNamesBefore.begin(); i != attrNamesBefore.end(); ++i)
+  {
+    if (attrNamesAfter.find(*i) == attrNamesAfter.end())
+    {
+      removedV.push_back(i->c_str());
+    }
+  }
+
+  if ((entityDelta == 0) && (addedV.size() == 0) && (removedV.size() == 0))
+  {
+    return;
+  }
+
+  dbTypeCatalogUpdate(entityType.c_str(),
+                      entityDelta,
+                      (addedV.size()   > 0)? &addedV[0]   : NULL, addedV.size(),
+                      (removedV.size() > 0)? &removedV[0] : NULL, removedV.size());
+}
+
+
+
+/* ****************************************************************************
+*
+* TypeCatalogChange - a type catalog update that waits for the bulk write of an NGSI-LD batch
+*/
+typedef struct TypeCatalogChange
+{
+  std::string            entityType;
+  int                    entityDelta;
+  std::set<std::string>  attrNamesBefore;
+  std::set<std::string>  attrNamesAfter;
+} TypeCatalogChange;
+
+
+
+/* ****************************************************************************
+*
+* typeCatalogChangeCommit - MongoLdBatchCallback, called once the bulk write has been executed
+*/
+static void typeCatalogChangeCommit(void* dataP, bool written)
+{
+  TypeCatalogChange* changeP = (TypeCatalogChange*) dataP;
+
+  if (written == true)
+  {
+    typeCatalogUpdate(changeP->entityType, changeP->entityDelta, changeP->attrNamesBefore, changeP->attrNamesAfter);
+  }
+
+  delete changeP;
+}
+
+
+
+/* ****************************************************************************
+*
+* typeCatalogChange - update the type catalog, now or after the bulk write
+*
+* 'queuedEntityId' is the entity ID if the write of the entity is part of the bulk of an NGSI-LD batch
+* (empty string otherwise). The catalog is then updated only if the bulk write of the entity succeeds.
+*/
+static void typeCatalogChange
+(
+  const std::string&            queuedEntityId,
+  const std::string&            entityType,
+  int                           entityDelta,
+  const std::set<std::string>&  attrNamesBefore,
+  const std::set<std::string>&  attrNamesAfter
+)
+{
+  if (queuedEntityId != "")
+  {
+    TypeCatalogChange* changeP = new TypeCatalogChange();
+
+    changeP->entityType      = entityType;
+    changeP->entityDelta     = entityDelta;
+    changeP->attrNamesBefore = attrNamesBefore;
+    changeP->attrNamesAfter  = attrNamesAfter;
+
+    if (mongoLdBatchDefer(queuedEntityId, typeCatalogChangeCommit, changeP) == true)
+    {
+      return;
+    }
+
+    delete changeP;
+  }
+
+  typeCatalogUpdate(entityType, entityDelta, attrNamesBefore, attrNamesAfter);
+}
+
+
+
+/* ****************************************************************************
+*
+* typeCatalogEntityCreated - see typeCatalogChange about 'queuedEntityId'
+*/
+static void typeCatalogEntityCreated(const std::string& entityType, const ContextAttributeVector& attrsV, const std::string& queuedEntityId)
+{
+  std::set<std::string> attrNamesBefore;
+  std::set<std::string> attrNamesAfter;
+
+  for (unsigned int ix = 0; ix < attrsV.size(); ++ix)
+  {
+    attrNamesAfter.insert(attrsV[ix]->name);
+  }
+
+  typeCatalogChange(queuedEntityId, entityType, 1, attrNamesBefore, attrNamesAfter);
+}
+
+
+
+/* ****************************************************************************
+*
+* typeCatalogEntityRemoved - 'r' is the entity as it was in the database
+*/
+static void typeCatalogEntityRemoved(const std::string& entityType, const BSONObj& r)
+{
+  std::set<std::string> attrNamesBefore;
+  std::set<std::string> attrNamesAfter;
+
+  if (r.hasField(ENT_ATTRNAMES) && (r.getField(ENT_ATTRNAMES).type() == mongo::Array))
+  {
+    attrNameSetFromArray(r.getObjectField(ENT_ATTRNAMES), &attrNamesBefore);
+  }
+
+  typeCatalogUpdate(entityType, -1, attrNamesBefore, attrNamesAfter);
+}
+
+
+
+/* ****************************************************************************
+*
+* typeCatalogEntityUpdated - 'r' is the entity as it was in the database, before the update
+*
+* For REPLACE, the attribute names of the entity are replaced with 'toPushArr'.
+* Otherwise, 'toPushArr' are added ($addToSet) and 'toPullArr' removed ($pullAll).
+* See typeCatalogChange about 'queuedEntityId'.
+*/
+static void typeCatalogEntityUpdated
+(
+  const std::string&  entityType,
+  const BSONObj&      r,
+  ActionType          action,
+  const BSONArray&    toPushArr,
+  const BSONArray&    toPullArr,
+  const std::string&  queuedEntityId
+)
+{
+  std::set<std::string> attrNamesBefore;
+  std::set<std::string> attrNamesAfter;
+
+  if (r.hasField(ENT_ATTRNAMES) && (r.getField(ENT_ATTRNAMES).type() == mongo::Array))
+  {
+    attrNameSetFromArray(r.getObjectField(ENT_ATTRNAMES), &attrNamesBefore);
+  }
+
+  if (action != ActionTypeReplace)
+  {
+    std::set<std::string> toPull;
+
+    attrNamesAfter = attrNamesBefore;
+    attrNameSetFromArray(toPushArr, &attrNamesAfter);
+    attrNameSetFromArray(toPullArr, &toPull);
+
+    for (std::set<std::string>::iterator i = toPull.begin(); i != toPull.end(); ++i)
+    {
+      attrNamesAfter.erase(*i);
+    }
+  }
+  else
+  {
+    attrNameSetFromArray(toPushArr, &attrNamesAfter);
+  }
+
+  typeCatalogChange(queuedEntityId, entityType, 0, attrNamesBefore, attrNamesAfter);
+}
+
+
+
+/* ****************************************************************************
+*
+* BatchNotifications - the notifications of an entity, waiting for the bulk write of an NGSI-LD batch
+*/
+typedef struct BatchNotifications
+{
+  std::map<std::string, TriggeredSubscription*>  subs;
+  ContextElementResponse*                        notifyCerP;
+  std::string                                    tenant;
+  std::string                                    xauthToken;
+  std::string                                    fiwareCorrelator;
+} BatchNotifications;
+
+
+
+/* ****************************************************************************
+*
+* batchNotificationsSend - MongoLdBatchCallback, called once the bulk write has been executed
+*
+* If the write of the entity failed, nothing has changed and nobody is notified.
+*/
+static void batchNotificationsSend(void* dataP, bool written)
+{
+  BatchNotifications* bnP = (BatchNotifications*) dataP;
+
+  if (written == true)
+  {
+    std::string err;
+
+    processSubscriptions(bnP->subs, bnP->notifyCerP, &err, bnP->tenant, bnP->xauthToken, bnP->fiwareCorrelator);
+  }
+
+  releaseTriggeredSubscriptions(&bnP->subs);
+  bnP->notifyCerP->release();
+  delete bnP->notifyCerP;
+  delete bnP;
+}
+
+
+
+/* ****************************************************************************
+*
+* batchNotificationsDefer - notify once the entity has been written by the bulk of the ongoing NGSI-LD batch
+*
+* The triggered subscriptions (the content of 'subs' is moved) and 'notifyCerP' are taken over.
+*/
+static void batchNotificationsDefer
+(
+  const std::string&                              entityId,
+  std::map<std::string, TriggeredSubscription*>&  subs,
+  ContextElementResponse*                         notifyCerP,
+  const std::string&                              tenant,
+  const std::string&                              xauthToken,
+  const std::string&                              fiwareCorrelator
+)
+{
+  BatchNotifications* bnP = new BatchNotifications();
+
+  bnP->subs.swap(subs);
+  bnP->notifyCerP       = notifyCerP;
+  bnP->tenant           = tenant;
+  bnP->xauthToken       = xauthToken;
+  bnP->fiwareCorrelator = fiwareCorrelator;
+
+  if (mongoLdBatchDefer(entityId, batchNotificationsSend, bnP) == false)
+  {
+    batchNotificationsSend(bnP, true);  // No batch ongoing - notify right away
+  }
+}
+#endif
+
+
+
 /* ****************************************************************************
 *
 * createEntity -
@@ -2950,10 +3262,14 @@ static bool createEntity
   if (orionldState.apiVersion != NGSI_LD_V1)
     ensureLocationIndex(tenant);
 
-  if (idIndex == true)
-    ensureIdIndex(tenant);
+  // With entityInsertFirst, the indexes have already been ensured, once for the tenant (mongoLdEntityIdIndexUnique)
+  if (orionldState.entityInsertFirst == false)
+  {
+    if (idIndex == true)
+      ensureIdIndex(tenant);
 
-  ensureDateExpirationIndex(tenant);
+    ensureDateExpirationIndex(tenant);
+  }
 
   if (!legalIdUsage(attrsV))
   {
@@ -3107,18 +3423,55 @@ static bool createEntity
   {
     mongo::BSONObj  datasetsObj;
 
-    dbDataFromKjTree(orionldState.datasets, &datasetsObj);
+    mongoCppLegacyKjTreeToBsonObj(orionldState.datasets, &datasetsObj);
     insertedDoc.append(orionldState.datasets->name, datasetsObj);
   }
 
 
-  if (!collectionInsert(getEntitiesCollectionName(tenant), insertedDoc.obj(), errDetail))
+  BSONObj insertedDocObj = insertedDoc.obj();
+
+#ifdef ORIONLD
+  // During an NGSI-LD batch operation, the insertion is part of the bulk write (executed by mongoUpdateContext)
+  if (mongoLdBatchInsert(eP->id, insertedDocObj) == true)
+  {
+    typeCatalogEntityCreated(eP->type, attrsV, eP->id);  // Once the bulk write has succeeded
+    return true;
+  }
+
+  // POST /entities: the entity has not been looked up - if it already exists, the unique index on _id.id makes the insert fail
+  if (orionldState.entityInsertFirst == true)
+  {
+    bool duplicate;
+
+    if (mongoLdEntityInsert(getEntitiesCollectionName(tenant), insertedDocObj, &duplicate, errDetail) == false)
+    {
+      if (duplicate == true)
+        oeP->fill(SccConflict, *errDetail, "AlreadyExists");
+      else
+      {
+        LM_E(("Internal Error (%s)", errDetail->c_str()));
+        oeP->fill(SccReceiverInternalError, *errDetail, "InternalError");
+      }
+
+      return false;
+    }
+
+    typeCatalogEntityCreated(eP->type, attrsV, "");
+    return true;
+  }
+#endif
+
+  if (!collectionInsert(getEntitiesCollectionName(tenant), insertedDocObj, errDetail))
   {
     LM_E(("Internal Error (%s)", errDetail->c_str()));
     oeP->fill(SccReceiverInternalError, *errDetail, "InternalError");
     return false;
   }
 
+#ifdef ORIONLD
+  typeCatalogEntityCreated(eP->type, attrsV, "");
+#endif
+
   return true;
 }
 
@@ -3317,7 +3670,14 @@ static void updateEntity
   if ((action == ActionTypeDelete) && (ceP->contextAttributeVector.size() == 0))
   {
     LM_T(LmtServicePath, ("Removing entity"));
+#ifdef ORIONLD
+    if (removeEntity(entityId, entityType, cerP, tenant, entitySPath, &(responseP->oe)) == true)
+    {
+      typeCatalogEntityRemoved(entityType, r);
+    }
+#else
     removeEntity(entityId, entityType, cerP, tenant, entitySPath, &(responseP->oe));
+#endif
     responseP->contextElementResponseVector.push_back(cerP);
     return;
   }
@@ -3595,8 +3955,16 @@ static void updateEntity
   // Service Path
   query.append(servicePathString, fillQueryServicePath(servicePathV));
 
-  std::string err;
-  if (!collectionUpdate(getEntitiesCollectionName(tenant), query.obj(), updatedEntityObj, false, &err))
+  std::string  err;
+  BSONObj      queryObj = query.obj();
+  bool         queued   = false;
+
+#ifdef ORIONLD
+  // During an NGSI-LD batch operation, the update is part of the bulk write (executed by mongoUpdateContext)
+  queued = mongoLdBatchUpdate(entityId, queryObj, updatedEntityObj);
+#endif
+
+  if ((queued == false) && (!collectionUpdate(getEntitiesCollectionName(tenant), queryObj, updatedEntityObj, false, &err)))
   {
     cerP->statusCode.fill(SccReceiverInternalError, err);
     responseP->oe.fill(SccReceiverInternalError, err, "InternalServerError");
@@ -3611,11 +3979,23 @@ static void updateEntity
     return;
   }
 
-  /* Send notifications for each one of the ONCHANGE subscriptions accumulated by
-   * previous addTriggeredSubscriptions() invocations */
-  processSubscriptions(subsToNotify, notifyCerP, &err, tenant, xauthToken, fiwareCorrelator);
-  notifyCerP->release();
-  delete notifyCerP;
+#ifdef ORIONLD
+  typeCatalogEntityUpdated(entityType, r, action, toPushArr, toPullArr, (queued == true)? entityId : "");
+
+  // Part of the bulk write of an NGSI-LD batch: notify once the bulk write of the entity has succeeded
+  if (queued == true)
+  {
+    batchNotificationsDefer(entityId, subsToNotify, notifyCerP, tenant, xauthToken, fiwareCorrelator);
+  }
+  else
+#endif
+  {
+    /* Send notifications for each one of the ONCHANGE subscriptions accumulated by
+     * previous addTriggeredSubscriptions() invocations */
+    processSubscriptions(subsToNotify, notifyCerP, &err, tenant, xauthToken, fiwareCorrelator);
+    notifyCerP->release();
+    delete notifyCerP;
+  }
 
   //
   // processSubscriptions cleans up the triggered subscriptions; this call here to
@@ -3736,6 +4116,85 @@ static void setActionType(ContextElementResponse* notifyCerP, const std::string&
 
 
 
+/* ****************************************************************************
+*
+* entitiesFind -
+*
+* Query the entities collection, the result (owned BSONObjs) is appended to resultsP
+*/
+static bool entitiesFind
+(
+  const BSONObj&         query,
+  const std::string&     tenant,
+  std::vector<BSONObj>*  resultsP,
+  std::string*           errP
+)
+{
+  std::auto_ptr<DBClientCursor> cursor;
+
+  TIME_STAT_MONGO_READ_WAIT_START();
+  DBClientBase* connection = getMongoConnection();
+
+  if (!collectionQuery(connection, getEntitiesCollectionName(tenant), query, &cursor, errP))
+  {
+    releaseMongoConnection(connection);
+    TIME_STAT_MONGO_READ_WAIT_STOP();
+    return false;
+  }
+  TIME_STAT_MONGO_READ_WAIT_STOP();
+
+  //
+  // Going through the list of found entities.
+  // As ServicePath cannot be modified, inside this loop nothing will be done
+  // about ServicePath (The ServicePath was present in the mongo query to obtain the list)
+  //
+  // FIXME P6: Once we allow for ServicePath to be modified, this loop must be looked at.
+  //
+
+  unsigned int docs = 0;
+
+  while (moreSafe(cursor))
+  {
+    BSONObj r;
+
+    if (!nextSafeOrErrorF(cursor, &r, errP))
+    {
+      LM_E(("Runtime Error (exception in nextSafe(): %s - query: %s)", errP->c_str(), query.toString().c_str()));
+      continue;
+    }
+
+    docs++;
+    LM_T(LmtMongo, ("retrieved document [%d]: '%s'", docs, r.toString().c_str()));
+
+    BSONElement idField = getFieldF(r, "_id");
+
+    //
+    // BSONElement::eoo returns true if 'not found', i.e. the field "_id" doesn't exist in 'sub'
+    //
+    // Now, if 'getFieldF(r, "_id")' is not found, if we continue, calling embeddedObject() on it, then we get
+    // an exception and the broker crashes.
+    //
+    if (idField.eoo() == true)
+    {
+      std::string details = std::string("error retrieving _id field in doc: '") + r.toString() + "'";
+      alarmMgr.dbError(details);
+      continue;
+    }
+
+    //
+    // We need to use getOwned() here, otherwise we have empirically found that bad things may happen with long BSONObjs
+    // (see http://stackoverflow.com/questions/36917731/context-broker-crashing-with-certain-update-queries)
+    //
+    resultsP->push_back(r.getOwned());
+  }
+
+  releaseMongoConnection(connection);
+
+  return true;
+}
+
+
+
 /* ****************************************************************************
 *
 * processContextElement -
@@ -3794,8 +4253,7 @@ void processContextElement
     bob.appendElements(b);
   }
 
-  BSONObj                        query = bob.obj();
-  std::auto_ptr<DBClientCursor>  cursor;
+  BSONObj query = bob.obj();
 
   // Several checks related to NGSIv2
   if (apiVersion == V2)
@@ -3837,69 +4295,26 @@ void processContextElement
     }
   }
 
-  std::string err;
+  std::string           err;
+  std::vector<BSONObj>  results;
+  bool                  prefetched = false;
 
-  TIME_STAT_MONGO_READ_WAIT_START();
-  DBClientBase* connection = getMongoConnection();
+#ifdef ORIONLD
+  // During an NGSI-LD batch operation, all entities of the batch have already been extracted from the database
+  prefetched = mongoLdBatchLookup(enP->id, enP->type, &results);
+
+  // POST /entities, with a unique index on _id.id: no lookup, the entity is inserted right away (createEntity)
+  if (orionldState.entityInsertFirst == true)
+    prefetched = true;
+#endif
 
-  if (!collectionQuery(connection, getEntitiesCollectionName(tenant), query, &cursor, &err))
+  if ((prefetched == false) && (entitiesFind(query, tenant, &results, &err) == false))
   {
-    releaseMongoConnection(connection);
-    TIME_STAT_MONGO_READ_WAIT_STOP();
     buildGeneralErrorResponse(ceP, NULL, responseP, SccReceiverInternalError, err);
     responseP->oe.fill(SccReceiverInternalError, err, "InternalServerError");
 
     return;
   }
-  TIME_STAT_MONGO_READ_WAIT_STOP();
-
-  //
-  // Going through the list of found entities.
-  // As ServicePath cannot be modified, inside this loop nothing will be done
-  // about ServicePath (The ServicePath was present in the mongo query to obtain the list)
-  //
-  // FIXME P6: Once we allow for ServicePath to be modified, this loop must be looked at.
-  //
-
-  std::vector<BSONObj> results;
-  unsigned int         docs = 0;
-
-  while (moreSafe(cursor))
-  {
-    BSONObj r;
-
-    if (!nextSafeOrErrorF(cursor, &r, &err))
-    {
-      LM_E(("Runtime Error (exception in nextSafe(): %s - query: %s)", err.c_str(), query.toString().c_str()));
-      continue;
-    }
-
-    docs++;
-    LM_T(LmtMongo, ("retrieved document [%d]: '%s'", docs, r.toString().c_str()));
-
-    BSONElement idField = getFieldF(r, "_id");
-
-    //
-    // BSONElement::eoo returns true if 'not found', i.e. the field "_id" doesn't exist in 'sub'
-    //
-    // Now, if 'getFieldF(r, "_id")' is not found, if we continue, calling embeddedObject() on it, then we get
-    // an exception and the broker crashes.
-    //
-    if (idField.eoo() == true)
-    {
-      std::string details = std::string("error retrieving _id field in doc: '") + r.toString() + "'";
-      alarmMgr.dbError(details);
-      continue;
-    }
-
-    //
-    // We need to use getOwned() here, otherwise we have empirically found that bad things may happen with long BSONObjs
-    // (see http://stackoverflow.com/questions/36917731/context-broker-crashing-with-certain-update-queries)
-    //
-    results.push_back(r.getOwned());
-  }
-
-  releaseMongoConnection(connection);
 
   LM_T(LmtServicePath, ("Docs found: %d", results.size()));
 
@@ -3996,7 +4411,8 @@ void processContextElement
 
       if (!createEntity(enP, ceP->contextAttributeVector, orionldState.requestTime, &errDetail, tenant, servicePathV, apiVersion, fiwareCorrelator, &(responseP->oe)))
       {
-        LM_E(("Internal Error (createEntity failed)"));
+        if (responseP->oe.code != SccConflict)  // Entity already exists (NGSI-LD insert-first) is no internal error
+          LM_E(("Internal Error (createEntity failed)"));
         cerP->statusCode.fill(SccInvalidParameter, errDetail);
         // In this case, responseP->oe is not filled, as createEntity() deals internally with that
       }
@@ -4050,10 +4466,21 @@ void processContextElement
         }
 
         notifyCerP->contextElement.entityId.servicePath = servicePathV.size() > 0? servicePathV[0] : "";
-        processSubscriptions(subsToNotify, notifyCerP, &errReason, tenant, xauthToken, fiwareCorrelator);
 
-        notifyCerP->release();
-        delete notifyCerP;
+#ifdef ORIONLD
+        // During an NGSI-LD batch operation, the entity is inserted by the bulk write - notify once that has succeeded
+        if (mongoLdBatchOngoing() == true)
+        {
+          batchNotificationsDefer(enP->id, subsToNotify, notifyCerP, tenant, xauthToken, fiwareCorrelator);
+        }
+        else
+#endif
+        {
+          processSubscriptions(subsToNotify, notifyCerP, &errReason, tenant, xauthToken, fiwareCorrelator);
+
+          notifyCerP->release();
+          delete notifyCerP;
+        }
         releaseTriggeredSubscriptions(&subsToNotify);
       }
 
@@ -67,6 +67,7 @@ extern "C"
 #include "orionld/common/orionldState.h"                       // orionldState
 #include "orionld/rest/OrionLdRestService.h"                   // OrionLdRestService
 #include "orionld/common/dotForEq.h"                           // dotForEq
+#include "orionld/common/orionldLatency.h"                     // orionldLatencyPhaseStart, orionldLatencyPhaseEnd
 #include "orionld/context/orionldContextItemExpand.h"          // orionldContextItemExpand
 #include "orionld/serviceRoutines/orionldPostSubscriptions.h"  // orionldPostSubscriptions
 #endif
@@ -406,12 +407,16 @@ DBClientBase* mongoInitialConnectionGetForUnitTest(void)
 *
 * I would prefer to have per-collection methods, to have a better encapsulation, but
 * the Mongo C++ API doesn't seem to work that way
+*
+* The time a connection is held (pool wait included) is the DB phase of the latency histograms
+* (see orionldLatency.h) - ended in releaseMongoConnection.
 */
 DBClientBase* getMongoConnection(void)
 {
 #ifdef UNIT_TEST
   return connection;
 #else
+  orionldLatencyPhaseStart(LP_DB);
   return mongoPoolConnectionGet();
 #endif
 }
@@ -432,7 +437,8 @@ void releaseMongoConnection(DBClientBase* connection)
 #ifdef UNIT_TEST
   return;
 #else
-  return mongoPoolConnectionRelease(connection);
+  mongoPoolConnectionRelease(connection);
+  orionldLatencyPhaseEnd(LP_DB);
 #endif  // UNIT_TEST
 }
 
@@ -38,6 +38,7 @@
 #include "cache/subCache.h"
 #include "apiTypesV2/Subscription.h"
 #include "orionld/common/orionldState.h"             // orionldState
+#include "orionld/mongoBackend/mongoLdSubCounters.h"  // mongoLdSubCountersMerge
 #include "mongoBackend/MongoGlobal.h"
 #include "mongoBackend/MongoCommonSubscription.h"
 #include "mongoBackend/connectionOperations.h"
@@ -224,6 +225,11 @@ static void setNotification(Subscription* subP, const BSONObj& r, const std::str
     }
   }
   cacheSemGive(__FUNCTION__, "get lastNotification and count");
+
+  //
+  // Without subscription cache, the counters may still be waiting to be flushed to the database
+  //
+  mongoLdSubCountersMerge(tenant, subP->id, &nP->timesSent, &nP->lastNotification, &nP->lastSuccess, &nP->lastFailure);
 }
 
 
@@ -42,6 +42,11 @@
 #include "mongoBackend/MongoCommonUpdate.h"
 #include "mongoBackend/mongoUpdateContext.h"
 
+#ifdef ORIONLD
+#include "orionld/common/orionldState.h"                 // orionldState
+#include "orionld/mongoBackend/mongoLdBatch.h"           // mongoLdBatchStart, mongoLdBatchExecute
+#endif
+
 
 
 /* ****************************************************************************
@@ -80,6 +85,25 @@ HttpStatusCode mongoUpdateContext
   }
   else
   {
+#ifdef ORIONLD
+    //
+    // NGSI-LD batch operations: the existing entities are extracted in one single query and
+    // all writes are sent to the database as one single (unordered) bulk write
+    //
+    MongoLdBatchMode batch = MongoLdBatchOff;
+
+    if ((orionldState.apiVersion == NGSI_LD_V1) && (requestP->contextElementVector.size() > 1))
+      batch = mongoLdBatchStart(requestP, tenant, servicePathV);
+
+    if (batch == MongoLdBatchAborted)
+    {
+      responseP->errorCode.fill(SccReceiverInternalError, "Database Error (batch entity lookup)");
+      responseP->oe.fill(SccReceiverInternalError, "Database Error (batch entity lookup)", "InternalError");
+      reqSemGive(__FUNCTION__, "ngsi10 update request", reqSemTaken);
+      return SccReceiverInternalError;
+    }
+#endif
+
     /* Process each ContextElement */
     for (unsigned int ix = 0; ix < requestP->contextElementVector.size(); ++ix)
     {
@@ -96,6 +120,11 @@ HttpStatusCode mongoUpdateContext
                             ngsiv2Flavour);
     }
 
+#ifdef ORIONLD
+    if (batch == MongoLdBatchOn)
+      mongoLdBatchExecute(responseP);
+#endif
+
     /* Note that although individual processContextElements() invocations return ConnectionError, this
        error gets "encapsulated" in the StatusCode of the corresponding ContextElementResponse and we
        consider the overall mongoUpdateContext() as OK.
@@ -148,6 +148,8 @@ static void* workerFunc(void* pSyncQ)
                              params->mqttPassword,
                              params->mqttVersion,
                              params->xauthToken.c_str(),
+                             params->tenant.c_str(),
+                             (params->registration == false)? params->subscriptionId.c_str() : NULL,
                              params->extraHeaders);
       }
       else // Send HTTP notification
@@ -195,7 +197,10 @@ static void* workerFunc(void* pSyncQ)
           QueueStatistics::incSentOK();
           alarmMgr.notificationErrorReset(url);
 
-          if (params->registration == false)
+          //
+          // For MQTT, the notification has only been queued - lastSuccess is set once the MQTT broker has acknowledged it
+          //
+          if ((params->registration == false) && (params->protocol != "mqtt"))
           {
             subCacheItemNotificationErrorStatus(params->tenant, params->subscriptionId, 0);
           }
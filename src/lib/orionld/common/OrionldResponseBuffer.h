@@ -32,6 +32,9 @@
 //
 // OrionldResponseBuffer -
 //
+// The response validators (ETag and Last-Modified) and the HTTP status code are filled in by orionldRequestSend.
+// They are used for conditional requests (If-None-Match/If-Modified-Since) - see orionldContextPersistRevalidate
+//
 typedef struct OrionldResponseBuffer
 {
   char*   buf;
@@ -39,6 +42,9 @@ typedef struct OrionldResponseBuffer
   size_t  used;
   size_t  size;
   bool    allocated;
+  long    httpStatus;
+  char    etag[128];
+  char    lastModified[64];
 } OrionldResponseBuffer;
 
 #endif  // SRC_LIB_ORIONLD_COMMON_ORIONLDRESPONSEBUFFER_H_
@@ -0,0 +1,56 @@
+/*
+*
+* Copyright 2021 FIWARE Foundation e.V.
+*
+* This file is part of Orion-LD Context Broker.
+*
+* Orion-LD Context Broker is free software: you can redistribute it and/or
+* modify it under the terms of the GNU Affero General Public License as
+* published by the Free Software Foundation, either version 3 of the
+* License, or (at your option) any later version.
+*
+* Orion-LD Context Broker is distributed in the hope that it will be useful,
+* but WITHOUT ANY WARRANTY; without even the implied warranty of
+* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU Affero
+* General Public License for more details.
+*
+* You should have received a copy of the GNU Affero General Public License
+* along with Orion-LD Context Broker. If not, see http://www.gnu.org/licenses/.
+*
+* For those usages not covered by this license please contact with
+* orionld at fiware dot org
+*
+* Author: Ken Zangelin
+*/
+#include "orionld/common/fnvHash.h"                              // Own interface
+
+
+
+// -----------------------------------------------------------------------------
+//
+// fnvHash -
+//
+unsigned int fnvHash(unsigned int hash, const void* data, int len)
+{
+  const unsigned char* bytes = (const unsigned char*) data;
+
+  if (len == -1)
+  {
+    while (*bytes != 0)
+    {
+      hash ^= *bytes;
+      hash *= 16777619u;
+      ++bytes;
+    }
+  }
+  else
+  {
+    for (int ix = 0; ix < len; ix++)
+    {
+      hash ^= bytes[ix];
+      hash *= 16777619u;
+    }
+  }
+
+  return hash;
+}
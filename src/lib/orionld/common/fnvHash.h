@@ -0,0 +1,48 @@
+#ifndef SRC_LIB_ORIONLD_COMMON_FNVHASH_H_
+#define SRC_LIB_ORIONLD_COMMON_FNVHASH_H_
+
+/*
+*
+* Copyright 2021 FIWARE Foundation e.V.
+*
+* This file is part of Orion-LD Context Broker.
+*
+* Orion-LD Context Broker is free software: you can redistribute it and/or
+* modify it under the terms of the GNU Affero General Public License as
+* published by the Free Software Foundation, either version 3 of the
+* License, or (at your option) any later version.
+*
+* Orion-LD Context Broker is distributed in the hope that it will be useful,
+* but WITHOUT ANY WARRANTY; without even the implied warranty of
+* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU Affero
+* General Public License for more details.
+*
+* You should have received a copy of the GNU Affero General Public License
+* along with Orion-LD Context Broker. If not, see http://www.gnu.org/licenses/.
+*
+* For those usages not covered by this license please contact with
+* orionld at fiware dot org
+*
+* Author: Ken Zangelin
+*/
+
+
+
+// -----------------------------------------------------------------------------
+//
+// FNV_HASH_INIT - initial value (offset basis) of a 32-bit FNV-1a hash
+//
+#define FNV_HASH_INIT  2166136261u
+
+
+
+// -----------------------------------------------------------------------------
+//
+// fnvHash - 32-bit FNV-1a hash of 'len' bytes of 'data', continuing from 'hash'
+//
+// If 'len' is -1, 'data' is a zero-terminated string.
+// Start with FNV_HASH_INIT and chain calls to hash more than one field into the same key.
+//
+extern unsigned int fnvHash(unsigned int hash, const void* data, int len);
+
+#endif  // SRC_LIB_ORIONLD_COMMON_FNVHASH_H_
@@ -0,0 +1,140 @@
+/*
+*
+* Copyright 2021 FIWARE Foundation e.V.
+*
+* This file is part of Orion-LD Context Broker.
+*
+* Orion-LD Context Broker is free software: you can redistribute it and/or
+* modify it under the terms of the GNU Affero General Public License as
+* published by the Free Software Foundation, either version 3 of the
+* License, or (at your option) any later version.
+*
+* Orion-LD Context Broker is distributed in the hope that it will be useful,
+* but WITHOUT ANY WARRANTY; without even the implied warranty of
+* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU Affero
+* General Public License for more details.
+*
+* You should have received a copy of the GNU Affero General Public License
+* along with Orion-LD Context Broker. If not, see http://www.gnu.org/licenses/.
+*
+* For those usages not covered by this license please contact with
+* orionld at fiware dot org
+*
+* Author: Ken Zangelin
+*/
+#include <stdint.h>                                              // uint64_t, uint32_t
+
+#include "orionld/common/latencyHistogram.h"                     // Own interface
+
+
+
+// -----------------------------------------------------------------------------
+//
+// bucketIndex - the bucket of a value
+//
+static inline int bucketIndex(uint64_t value)
+{
+  if (value > LATENCY_VALUE_MAX)
+    value = LATENCY_VALUE_MAX;
+
+  if (value < LATENCY_SUB_BUCKETS)
+    return (int) value;
+
+  int msb   = 63 - __builtin_clzll(value);
+  int shift = msb - (LATENCY_SUB_BUCKET_BITS - 1);
+
+  return shift * LATENCY_HALF + (int) (value >> shift);
+}
+
+
+
+// -----------------------------------------------------------------------------
+//
+// bucketHighValue - the highest value of a bucket
+//
+static uint64_t bucketHighValue(int ix)
+{
+  if (ix < LATENCY_SUB_BUCKETS)
+    return ix;
+
+  int       shift = ix / LATENCY_HALF - 1;
+  uint64_t  top   = ix - shift * LATENCY_HALF;
+
+  return ((top + 1) << shift) - 1;
+}
+
+
+
+// -----------------------------------------------------------------------------
+//
+// latencyHistogramRecord -
+//
+void latencyHistogramRecord(LatencyHistogram* histogramP, uint64_t value)
+{
+  uint32_t* bucketP = &histogramP->bucketV[bucketIndex(value)];
+
+  __atomic_store_n(bucketP, __atomic_load_n(bucketP, __ATOMIC_RELAXED) + 1, __ATOMIC_RELAXED);
+
+  if (value > __atomic_load_n(&histogramP->max, __ATOMIC_RELAXED))
+    __atomic_store_n(&histogramP->max, value, __ATOMIC_RELAXED);
+
+  __atomic_store_n(&histogramP->count, __atomic_load_n(&histogramP->count, __ATOMIC_RELAXED) + 1, __ATOMIC_RELEASE);
+}
+
+
+
+// -----------------------------------------------------------------------------
+//
+// latencyHistogramSum -
+//
+// The count of the sum is the sum of the buckets, not of the 'count' fields, so that the percentiles
+// are consistent with the buckets that were read.
+//
+void latencyHistogramSum(LatencyHistogramSum* sumP, const LatencyHistogram* histogramP)
+{
+  if (__atomic_load_n(&histogramP->count, __ATOMIC_ACQUIRE) == 0)
+    return;
+
+  uint64_t max = __atomic_load_n(&histogramP->max, __ATOMIC_RELAXED);
+
+  for (int ix = 0; ix < LATENCY_BUCKETS; ++ix)
+  {
+    uint64_t n = __atomic_load_n(&histogramP->bucketV[ix], __ATOMIC_RELAXED);
+
+    sumP->bucketV[ix] += n;
+    sumP->count       += n;
+  }
+
+  if (max > sumP->max)
+    sumP->max = max;
+}
+
+
+
+// -----------------------------------------------------------------------------
+//
+// latencyHistogramPercentile -
+//
+// The value is the highest value of the bucket of the percentile, but never above the max.
+//
+uint64_t latencyHistogramPercentile(LatencyHistogramSum* sumP, int perMille)
+{
+  uint64_t target = (sumP->count * perMille + 999) / 1000;
+  uint64_t sum    = 0;
+
+  if (target == 0)
+    target = 1;
+
+  for (int ix = 0; ix < LATENCY_BUCKETS; ++ix)
+  {
+    sum += sumP->bucketV[ix];
+
+    if (sum >= target)
+    {
+      uint64_t value = bucketHighValue(ix);
+      return (value < sumP->max)? value : sumP->max;
+    }
+  }
+
+  return sumP->max;
+}
@@ -0,0 +1,98 @@
+#ifndef SRC_LIB_ORIONLD_COMMON_LATENCYHISTOGRAM_H_
+#define SRC_LIB_ORIONLD_COMMON_LATENCYHISTOGRAM_H_
+
+/*
+*
+* Copyright 2021 FIWARE Foundation e.V.
+*
+* This file is part of Orion-LD Context Broker.
+*
+* Orion-LD Context Broker is free software: you can redistribute it and/or
+* modify it under the terms of the GNU Affero General Public License as
+* published by the Free Software Foundation, either version 3 of the
+* License, or (at your option) any later version.
+*
+* Orion-LD Context Broker is distributed in the hope that it will be useful,
+* but WITHOUT ANY WARRANTY; without even the implied warranty of
+* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU Affero
+* General Public License for more details.
+*
+* You should have received a copy of the GNU Affero General Public License
+* along with Orion-LD Context Broker. If not, see http://www.gnu.org/licenses/.
+*
+* For those usages not covered by this license please contact with
+* orionld at fiware dot org
+*
+* Author: Ken Zangelin
+*/
+#include <stdint.h>                                              // uint64_t, uint32_t
+
+
+
+// -----------------------------------------------------------------------------
+//
+// Histogram buckets - log-linear, as in HdrHistogram
+//
+// Values (microseconds) below LATENCY_SUB_BUCKETS have a bucket each.
+// Above that, each power of two is divided in LATENCY_HALF buckets, which keeps the relative error of a bucket under 1/16 (~6%).
+// Values are capped at 2^32 - 1 microseconds (more than an hour).
+//
+#define LATENCY_SUB_BUCKET_BITS  5
+#define LATENCY_SUB_BUCKETS      (1 << LATENCY_SUB_BUCKET_BITS)
+#define LATENCY_HALF             (LATENCY_SUB_BUCKETS / 2)
+#define LATENCY_BUCKETS          ((32 - LATENCY_SUB_BUCKET_BITS + 2) * LATENCY_HALF)
+#define LATENCY_VALUE_MAX        0xFFFFFFFFULL
+
+
+
+// -----------------------------------------------------------------------------
+//
+// LatencyHistogram - a latency histogram with a single writer
+//
+// The writer uses atomic loads and stores (no read-modify-write), so that readers in other threads see whole values.
+//
+typedef struct LatencyHistogram
+{
+  uint64_t  count;
+  uint64_t  max;
+  uint32_t  bucketV[LATENCY_BUCKETS];
+} LatencyHistogram;
+
+
+
+// -----------------------------------------------------------------------------
+//
+// LatencyHistogramSum - the sum of a number of histograms, for rendering
+//
+typedef struct LatencyHistogramSum
+{
+  uint64_t  count;
+  uint64_t  max;
+  uint64_t  bucketV[LATENCY_BUCKETS];
+} LatencyHistogramSum;
+
+
+
+// -----------------------------------------------------------------------------
+//
+// latencyHistogramRecord - record a value (microseconds) - only the writer of the histogram may call this function
+//
+extern void latencyHistogramRecord(LatencyHistogram* histogramP, uint64_t value);
+
+
+
+// -----------------------------------------------------------------------------
+//
+// latencyHistogramSum - add a histogram to a sum (the sum must be zeroed before the first histogram is added)
+//
+extern void latencyHistogramSum(LatencyHistogramSum* sumP, const LatencyHistogram* histogramP);
+
+
+
+// -----------------------------------------------------------------------------
+//
+// latencyHistogramPercentile - value at a percentile (in per mille) of a sum of histograms
+//
+extern uint64_t latencyHistogramPercentile(LatencyHistogramSum* sumP, int perMille);
+
+#endif  // SRC_LIB_ORIONLD_COMMON_LATENCYHISTOGRAM_H_
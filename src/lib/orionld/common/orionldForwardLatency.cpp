@@ -0,0 +1,224 @@
+/*
+*
+* Copyright 2021 FIWARE Foundation e.V.
+*
+* This file is part of Orion-LD Context Broker.
+*
+* Orion-LD Context Broker is free software: you can redistribute it and/or
+* modify it under the terms of the GNU Affero General Public License as
+* published by the Free Software Foundation, either version 3 of the
+* License, or (at your option) any later version.
+*
+* Orion-LD Context Broker is distributed in the hope that it will be useful,
+* but WITHOUT ANY WARRANTY; without even the implied warranty of
+* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU Affero
+* General Public License for more details.
+*
+* You should have received a copy of the GNU Affero General Public License
+* along with Orion-LD Context Broker. If not, see http://www.gnu.org/licenses/.
+*
+* For those usages not covered by this license please contact with
+* orionld at fiware dot org
+*
+* Author: Ken Zangelin
+*/
+#include <stdio.h>                                               // snprintf
+#include <stdlib.h>                                              // calloc
+#include <string.h>                                              // strcmp, strncpy, bzero
+#include <pthread.h>                                             // pthread_mutex_t, pthread_mutex_lock, pthread_mutex_unlock
+#include <string>                                                // std::string
+
+#include "logMsg/logMsg.h"                                       // LM_*
+#include "logMsg/traceLevels.h"                                  // Lmt*
+
+#include "common/JsonHelper.h"                                   // JsonHelper
+#include "orionld/common/fnvHash.h"                              // fnvHash, FNV_HASH_INIT
+#include "orionld/common/latencyHistogram.h"                     // LatencyHistogram, latencyHistogramRecord, ...
+#include "orionld/common/orionldForwardLatency.h"                // Own interface
+
+
+
+// -----------------------------------------------------------------------------
+//
+// FORWARD_PROVIDER_MAX - max number of Context Providers with a histogram of their own
+// FORWARD_PROVIDER_BUCKETS - size of the hash table of Context Providers
+//
+// Providers beyond FORWARD_PROVIDER_MAX share the histogram "other".
+//
+#define FORWARD_PROVIDER_MAX      256
+#define FORWARD_PROVIDER_BUCKETS  64
+
+
+
+// -----------------------------------------------------------------------------
+//
+// ForwardProvider - the latency histogram of a Context Provider (protocol://host:port)
+//
+typedef struct ForwardProvider
+{
+  char                     name[128];
+  unsigned long long       errors;
+  LatencyHistogram         histogram;
+  struct ForwardProvider*  next;
+} ForwardProvider;
+
+
+
+// -----------------------------------------------------------------------------
+//
+// Module variables
+//
+// All access is under forwardLatencyMutex, which also makes the mutex holder the single writer of a histogram.
+// Forwarded requests take milliseconds, so a lock per recorded request is no issue.
+//
+static ForwardProvider*  providerTable[FORWARD_PROVIDER_BUCKETS];
+static ForwardProvider*  providerV[FORWARD_PROVIDER_MAX];
+static int               providers           = 0;
+static ForwardProvider   otherProvider       = { "other", 0, { 0, 0, { 0 } }, NULL };
+static bool              providerFullWarned  = false;
+static pthread_mutex_t   forwardLatencyMutex = PTHREAD_MUTEX_INITIALIZER;
+
+
+
+// -----------------------------------------------------------------------------
+//
+// providerGet - lookup a provider, add it if not found - called with forwardLatencyMutex taken
+//
+static ForwardProvider* providerGet(const char* name)
+{
+  unsigned int bucket = fnvHash(FNV_HASH_INIT, name, -1) % FORWARD_PROVIDER_BUCKETS;
+
+  for (ForwardProvider* providerP = providerTable[bucket]; providerP != NULL; providerP = providerP->next)
+  {
+    if (strcmp(providerP->name, name) == 0)
+      return providerP;
+  }
+
+  if (providers >= FORWARD_PROVIDER_MAX)
+  {
+    if (providerFullWarned == false)
+    {
+      LM_W(("Too many Context Providers for forwarding latency histograms (max %d) - the rest are measured as 'other'", FORWARD_PROVIDER_MAX));
+      providerFullWarned = true;
+    }
+
+    return &otherProvider;
+  }
+
+  ForwardProvider* providerP = (ForwardProvider*) calloc(1, sizeof(ForwardProvider));
+
+  if (providerP == NULL)
+    return &otherProvider;
+
+  strncpy(providerP->name, name, sizeof(providerP->name) - 1);
+  providerP->next       = providerTable[bucket];
+  providerTable[bucket] = providerP;
+  providerV[providers]  = providerP;
+  ++providers;
+
+  return providerP;
+}
+
+
+
+// -----------------------------------------------------------------------------
+//
+// orionldForwardLatencyRecord -
+//
+// Failed requests are recorded as well (with the time until they failed), and counted as errors.
+//
+void orionldForwardLatencyRecord(const char* protocol, const char* host, unsigned short port, uint64_t microseconds, bool ok)
+{
+  char name[128];
+
+  snprintf(name, sizeof(name), "%s://%s:%d", protocol, host, port);
+
+  pthread_mutex_lock(&forwardLatencyMutex);
+
+  ForwardProvider* providerP = providerGet(name);
+
+  latencyHistogramRecord(&providerP->histogram, microseconds);
+
+  if (ok == false)
+    ++providerP->errors;
+
+  pthread_mutex_unlock(&forwardLatencyMutex);
+}
+
+
+
+// -----------------------------------------------------------------------------
+//
+// providerStats - render the histogram of one provider (nothing if no request has been recorded)
+//
+static void providerStats(JsonHelper* jhP, ForwardProvider* providerP)
+{
+  LatencyHistogramSum sum;
+
+  bzero(&sum, sizeof(sum));
+  latencyHistogramSum(&sum, &providerP->histogram);
+
+  if (sum.count == 0)
+    return;
+
+  JsonHelper ph;
+
+  ph.addNumber("count",  (long long) sum.count);
+  ph.addNumber("errors", (long long) providerP->errors);
+  ph.addNumber("p50",    (long long) latencyHistogramPercentile(&sum, 500));
+  ph.addNumber("p99",    (long long) latencyHistogramPercentile(&sum, 990));
+  ph.addNumber("max",    (long long) sum.max);
+
+  jhP->addRaw(providerP->name, ph.str());
+}
+
+
+
+// -----------------------------------------------------------------------------
+//
+// orionldForwardLatencyStats -
+//
+// {
+//   "http://cp1:1026": { "count": 120, "errors": 2, "p50": 3100, "p99": 15871, "max": 20012 },
+//   ...
+// }
+//
+// Latencies are in microseconds.
+//
+std::string orionldForwardLatencyStats(void)
+{
+  JsonHelper jh;
+
+  pthread_mutex_lock(&forwardLatencyMutex);
+
+  for (int ix = 0; ix < providers; ++ix)
+    providerStats(&jh, providerV[ix]);
+
+  providerStats(&jh, &otherProvider);
+
+  pthread_mutex_unlock(&forwardLatencyMutex);
+
+  return jh.str();
+}
+
+
+
+// -----------------------------------------------------------------------------
+//
+// orionldForwardLatencyStatsReset -
+//
+void orionldForwardLatencyStatsReset(void)
+{
+  pthread_mutex_lock(&forwardLatencyMutex);
+
+  for (int ix = 0; ix < providers; ++ix)
+  {
+    bzero(&providerV[ix]->histogram, sizeof(LatencyHistogram));
+    providerV[ix]->errors = 0;
+  }
+
+  bzero(&otherProvider.histogram, sizeof(LatencyHistogram));
+  otherProvider.errors = 0;
+
+  pthread_mutex_unlock(&forwardLatencyMutex);
+}
@@ -0,0 +1,55 @@
+#ifndef SRC_LIB_ORIONLD_COMMON_ORIONLDFORWARDLATENCY_H_
+#define SRC_LIB_ORIONLD_COMMON_ORIONLDFORWARDLATENCY_H_
+
+/*
+*
+* Copyright 2021 FIWARE Foundation e.V.
+*
+* This file is part of Orion-LD Context Broker.
+*
+* Orion-LD Context Broker is free software: you can redistribute it and/or
+* modify it under the terms of the GNU Affero General Public License as
+* published by the Free Software Foundation, either version 3 of the
+* License, or (at your option) any later version.
+*
+* Orion-LD Context Broker is distributed in the hope that it will be useful,
+* but WITHOUT ANY WARRANTY; without even the implied warranty of
+* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU Affero
+* General Public License for more details.
+*
+* You should have received a copy of the GNU Affero General Public License
+* along with Orion-LD Context Broker. If not, see http://www.gnu.org/licenses/.
+*
+* For those usages not covered by this license please contact with
+* orionld at fiware dot org
+*
+* Author: Ken Zangelin
+*/
+#include <stdint.h>                                              // uint64_t
+#include <string>                                                // std::string
+
+
+
+// -----------------------------------------------------------------------------
+//
+// orionldForwardLatencyRecord - record the latency (microseconds) of a request forwarded to a Context Provider
+//
+extern void orionldForwardLatencyRecord(const char* protocol, const char* host, unsigned short port, uint64_t microseconds, bool ok);
+
+
+
+// -----------------------------------------------------------------------------
+//
+// orionldForwardLatencyStats - render the latency histograms per Context Provider, as a JSON object, for GET /statistics
+//
+extern std::string orionldForwardLatencyStats(void);
+
+
+
+// -----------------------------------------------------------------------------
+//
+// orionldForwardLatencyStatsReset - reset the latency histograms (DELETE /statistics)
+//
+extern void orionldForwardLatencyStatsReset(void);
+
+#endif  // SRC_LIB_ORIONLD_COMMON_ORIONLDFORWARDLATENCY_H_
@@ -0,0 +1,444 @@
+/*
+*
+* Copyright 2021 FIWARE Foundation e.V.
+*
+* This file is part of Orion-LD Context Broker.
+*
+* Orion-LD Context Broker is free software: you can redistribute it and/or
+* modify it under the terms of the GNU Affero General Public License as
+* published by the Free Software Foundation, either version 3 of the
+* License, or (at your option) any later version.
+*
+* Orion-LD Context Broker is distributed in the hope that it will be useful,
+* but WITHOUT ANY WARRANTY; without even the implied warranty of
+* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU Affero
+* General Public License for more details.
+*
+* You should have received a copy of the GNU Affero General Public License
+* along with Orion-LD Context Broker. If not, see http://www.gnu.org/licenses/.
+*
+* For those usages not covered by this license please contact with
+* orionld at fiware dot org
+*
+* Author: Ken Zangelin
+*/
+#include <stdint.h>                                              // uint64_t, uintptr_t
+#include <stdio.h>                                               // snprintf
+#include <stdlib.h>                                              // calloc, free
+#include <string.h>                                              // strlen, bzero
+#include <time.h>                                                // clock_gettime
+
+extern "C"
+{
+#include "kalloc/kaAlloc.h"                                      // kaAlloc
+#include "kjson/KjNode.h"                                        // KjNode
+#include "kjson/kjBuilder.h"                                     // kjObject, kjInteger, kjChildAdd
+#include "kjson/kjLookup.h"                                      // kjLookup
+}
+
+#include "logMsg/logMsg.h"                                       // LM_*
+#include "logMsg/traceLevels.h"                                  // Lmt*
+
+#include "rest/Verb.h"                                           // Verb, verbName
+#include "orionld/rest/OrionLdRestService.h"                     // OrionLdRestService
+#include "orionld/types/OrionldTenant.h"                         // OrionldTenant
+#include "orionld/common/orionldState.h"                         // orionldState, tenant0
+#include "orionld/common/orionldTenantLookup.h"                  // orionldTenantLookup
+#include "orionld/common/fnvHash.h"                              // fnvHash
+#include "orionld/common/shardRegistry.h"                        // ShardRegistry, shardRegistry*
+#include "orionld/common/latencyHistogram.h"                     // LatencyHistogram, latencyHistogramRecord, ...
+#include "orionld/common/orionldLatency.h"                       // Own interface
+
+
+
+// -----------------------------------------------------------------------------
+//
+// LATENCY_KEY_MAX - max number of route/tenant pairs
+// LATENCY_KEY_BUCKETS - size of the hash table for the route/tenant pairs
+// LATENCY_KEY_CHUNK_SIZE - the histograms of a thread are allocated for one route/tenant at a time (they're big)
+//
+#define LATENCY_KEY_MAX          256
+#define LATENCY_KEY_BUCKETS      64
+#define LATENCY_KEY_CHUNK_SIZE   1
+
+
+
+// -----------------------------------------------------------------------------
+//
+// LatencyHistograms - histograms of all phases, for one route/tenant pair
+//
+typedef struct LatencyHistograms
+{
+  LatencyHistogram  phaseV[LP_PHASES];
+} LatencyHistograms;
+
+
+
+// -----------------------------------------------------------------------------
+//
+// LatencyKey - a route (verb + service) and a tenant
+//
+// Only tenants of the tenant registry are keys (tenants are never freed, so the pointer identifies the tenant).
+// Requests for tenants that don't exist have NULL as tenantP - they all share the "other" tenant of their route.
+//
+// Key 0 is the overflow key (serviceP == NULL): once the registry is full, requests of new route/tenant pairs are
+// recorded there (rendered as route "other").
+//
+typedef struct LatencyKey
+{
+  OrionLdRestService*  serviceP;
+  Verb                 verb;
+  OrionldTenant*       tenantP;
+} LatencyKey;
+
+
+
+// -----------------------------------------------------------------------------
+//
+// LatencyRequest - the timestamps of the ongoing request of a thread (nanoseconds)
+//
+typedef struct LatencyRequest
+{
+  bool          active;
+  uint64_t      start;
+  uint64_t      phaseStart[LP_PHASES];
+  uint64_t      phaseTime[LP_PHASES];
+  int           phaseDepth[LP_PHASES];
+  unsigned int  phaseMask;
+} LatencyRequest;
+
+
+
+// -----------------------------------------------------------------------------
+//
+// Module variables
+//
+static const char*              phaseName[LP_PHASES] = { "request", "parse", "serviceRoutine", "db", "forward", "render", "reply", "troe", "notify" };
+static ShardRegistry            registry;
+static int                      overflowKeyIx = -1;
+static bool                     latencyOn     = false;
+static __thread LatencyRequest  latencyRequest;
+
+
+
+// -----------------------------------------------------------------------------
+//
+// nowNs -
+//
+static inline uint64_t nowNs(void)
+{
+  struct timespec ts;
+
+  clock_gettime(CLOCK_MONOTONIC, &ts);
+
+  return (uint64_t) ts.tv_sec * 1000000000ULL + ts.tv_nsec;
+}
+
+
+
+// -----------------------------------------------------------------------------
+//
+// keyHash - FNV-1a of service pointer, verb and tenant pointer
+//
+static unsigned int keyHash(const LatencyKey* keyP)
+{
+  unsigned int hash = fnvHash(FNV_HASH_INIT, &keyP->serviceP, sizeof(keyP->serviceP));
+
+  hash = fnvHash(hash, &keyP->verb, sizeof(keyP->verb));
+
+  return fnvHash(hash, &keyP->tenantP, sizeof(keyP->tenantP));
+}
+
+
+
+// -----------------------------------------------------------------------------
+//
+// keyMatch - ShardRegistryMatch for LatencyKey
+//
+static bool keyMatch(const void* dataP, const void* probeP)
+{
+  const LatencyKey*  keyP  = (const LatencyKey*) dataP;
+  const LatencyKey*  probe = (const LatencyKey*) probeP;
+
+  return (keyP->serviceP == probe->serviceP) && (keyP->verb == probe->verb) && (keyP->tenantP == probe->tenantP);
+}
+
+
+
+// -----------------------------------------------------------------------------
+//
+// keyCreate - ShardRegistryCreate for LatencyKey
+//
+static void* keyCreate(const void* probeP)
+{
+  LatencyKey* keyP = (LatencyKey*) calloc(1, sizeof(LatencyKey));
+
+  if (keyP != NULL)
+    *keyP = *((const LatencyKey*) probeP);
+
+  return keyP;
+}
+
+
+
+// -----------------------------------------------------------------------------
+//
+// orionldLatencyInit -
+//
+void orionldLatencyInit(void)
+{
+  if (shardRegistryInit(&registry,
+                        "latency histograms (route/tenant pairs)",
+                        LATENCY_KEY_MAX,
+                        LATENCY_KEY_BUCKETS,
+                        LATENCY_KEY_CHUNK_SIZE,
+                        sizeof(LatencyHistograms),
+                        keyMatch,
+                        keyCreate,
+                        free) == false)
+    return;
+
+  LatencyKey overflowKey = { NULL, NOVERB, NULL };
+
+  if ((overflowKeyIx = shardRegistryKeyIntern(&registry, &overflowKey, keyHash(&overflowKey))) == -1)
+    return;
+
+  latencyOn = true;
+}
+
+
+
+// -----------------------------------------------------------------------------
+//
+// orionldLatencyRequestStart -
+//
+void orionldLatencyRequestStart(void)
+{
+  bzero(&latencyRequest, sizeof(latencyRequest));
+
+  latencyRequest.active = latencyOn;
+  latencyRequest.start  = nowNs();
+}
+
+
+
+// -----------------------------------------------------------------------------
+//
+// orionldLatencyPhaseStart -
+//
+// Phases may nest (e.g. DB operations inside a DB phase) - only the outermost start/end pair counts.
+//
+void orionldLatencyPhaseStart(OrionldLatencyPhase phase)
+{
+  if (latencyRequest.active == false)
+    return;
+
+  if (latencyRequest.phaseDepth[phase]++ == 0)
+    latencyRequest.phaseStart[phase] = nowNs();
+}
+
+
+
+// -----------------------------------------------------------------------------
+//
+// orionldLatencyPhaseEnd -
+//
+void orionldLatencyPhaseEnd(OrionldLatencyPhase phase)
+{
+  if ((latencyRequest.active == false) || (latencyRequest.phaseDepth[phase] == 0))
+    return;
+
+  if (--latencyRequest.phaseDepth[phase] != 0)
+    return;
+
+  latencyRequest.phaseTime[phase]  += nowNs() - latencyRequest.phaseStart[phase];
+  latencyRequest.phaseStart[phase]  = 0;
+  latencyRequest.phaseMask         |= (1 << phase);
+}
+
+
+
+// -----------------------------------------------------------------------------
+//
+// orionldLatencyRequestEnd -
+//
+// Requests that weren't routed to a service (e.g. 404 or bad verb) aren't recorded.
+// Requests of new route/tenant pairs, once LATENCY_KEY_MAX pairs exist, are recorded in the overflow key.
+//
+void orionldLatencyRequestEnd(void)
+{
+  if (latencyRequest.active == false)
+    return;
+
+  latencyRequest.active = false;
+
+  if (orionldState.serviceP == NULL)
+    return;
+
+  latencyRequest.phaseTime[LP_REQUEST]  = nowNs() - latencyRequest.start;
+  latencyRequest.phaseMask             |= (1 << LP_REQUEST);
+
+  LatencyKey key = { orionldState.serviceP, orionldState.verb, orionldState.tenantP };
+
+  if (key.tenantP == NULL)
+  {
+    if ((orionldState.tenant == NULL) || (orionldState.tenant[0] == 0))
+      key.tenantP = &tenant0;
+    else
+      key.tenantP = orionldTenantLookup(orionldState.tenant);  // NULL if the tenant doesn't exist - the "other" tenant
+  }
+
+  unsigned int  hash  = keyHash(&key);
+  int           keyIx = shardRegistryKeyLookup(&registry, &key, hash);
+
+  if ((keyIx == -1) && ((keyIx = shardRegistryKeyIntern(&registry, &key, hash)) == -1))
+    keyIx = overflowKeyIx;
+
+  LatencyHistograms* histogramsP = (LatencyHistograms*) shardRegistrySlot(&registry, keyIx);
+
+  if (histogramsP == NULL)
+    return;
+
+  for (int phase = 0; phase < LP_PHASES; ++phase)
+  {
+    if ((latencyRequest.phaseMask & (1 << phase)) != 0)
+      latencyHistogramRecord(&histogramsP->phaseV[phase], latencyRequest.phaseTime[phase] / 1000);
+  }
+}
+
+
+
+// -----------------------------------------------------------------------------
+//
+// PhaseSum - the merged histogram of one phase of a route/tenant
+//
+typedef struct PhaseSum
+{
+  int                  phase;
+  LatencyHistogramSum  sum;
+} PhaseSum;
+
+
+
+// -----------------------------------------------------------------------------
+//
+// phaseSum - ShardRegistrySlotTreat adding the histogram of one phase of a shard to the merged histogram
+//
+static void phaseSum(const void* slotP, void* paramP)
+{
+  const LatencyHistograms*  histogramsP = (const LatencyHistograms*) slotP;
+  PhaseSum*                 phaseSumP   = (PhaseSum*) paramP;
+
+  latencyHistogramSum(&phaseSumP->sum, &histogramsP->phaseV[phaseSumP->phase]);
+}
+
+
+
+// -----------------------------------------------------------------------------
+//
+// phaseKjTree - merge the histograms of one phase of a route/tenant from all shards
+//
+static KjNode* phaseKjTree(int keyIx, int phase)
+{
+  PhaseSum phaseSumData;
+
+  bzero(&phaseSumData, sizeof(phaseSumData));
+  phaseSumData.phase = phase;
+
+  shardRegistrySlotForEach(&registry, keyIx, phaseSum, &phaseSumData);
+
+  LatencyHistogramSum* sumP = &phaseSumData.sum;
+
+  if (sumP->count == 0)
+    return NULL;
+
+  KjNode* phaseP = kjObject(orionldState.kjsonP, phaseName[phase]);
+
+  kjChildAdd(phaseP, kjInteger(orionldState.kjsonP, "count", sumP->count));
+  kjChildAdd(phaseP, kjInteger(orionldState.kjsonP, "p50",   latencyHistogramPercentile(sumP, 500)));
+  kjChildAdd(phaseP, kjInteger(orionldState.kjsonP, "p99",   latencyHistogramPercentile(sumP, 990)));
+  kjChildAdd(phaseP, kjInteger(orionldState.kjsonP, "p999",  latencyHistogramPercentile(sumP, 999)));
+  kjChildAdd(phaseP, kjInteger(orionldState.kjsonP, "max",   sumP->max));
+
+  return phaseP;
+}
+
+
+
+// -----------------------------------------------------------------------------
+//
+// orionldLatencyKjTree -
+//
+// {
+//   "GET /ngsi-ld/v1/entities/*": {
+//     "<tenant>": {
+//       "request": { "count": 1234, "p50": 310, "p99": 1855, "p999": 4095, "max": 5012 },
+//       "db":      { ... },
+//       ...
+//     }
+//   }
+// }
+//
+// All values but 'count' are in microseconds. The default tenant is called "default", the tenants that don't exist
+// are all "other", and so is the route of the overflow key.
+//
+KjNode* orionldLatencyKjTree(void)
+{
+  KjNode* treeP = kjObject(orionldState.kjsonP, NULL);
+
+  if (latencyOn == false)
+    return treeP;
+
+  int keys = shardRegistryKeys(&registry);
+
+  for (int keyIx = 0; keyIx < keys; ++keyIx)
+  {
+    LatencyKey*  keyP    = (LatencyKey*) shardRegistryKeyData(&registry, keyIx);
+    const char*  route   = "other";
+    const char*  tenant  = "other";
+    KjNode*      tenantP = NULL;
+
+    if (keyP->serviceP != NULL)
+    {
+      const char*  verb      = verbName(keyP->verb);
+      int          routeSize = strlen(verb) + strlen(keyP->serviceP->url) + 2;
+      char*        routeBuf  = (char*) kaAlloc(&orionldState.kalloc, routeSize);
+
+      snprintf(routeBuf, routeSize, "%s %s", verb, keyP->serviceP->url);
+      route = routeBuf;
+    }
+
+    if (keyP->tenantP == &tenant0)
+      tenant = "default";
+    else if (keyP->tenantP != NULL)
+      tenant = keyP->tenantP->tenant;
+
+    for (int phase = 0; phase < LP_PHASES; ++phase)
+    {
+      KjNode* phaseP = phaseKjTree(keyIx, phase);
+
+      if (phaseP == NULL)
+        continue;
+
+      if (tenantP == NULL)
+        tenantP = kjObject(orionldState.kjsonP, tenant);
+
+      kjChildAdd(tenantP, phaseP);
+    }
+
+    if (tenantP == NULL)
+      continue;
+
+    KjNode* routeP = kjLookup(treeP, route);
+
+    if (routeP == NULL)
+    {
+      routeP = kjObject(orionldState.kjsonP, route);
+      kjChildAdd(treeP, routeP);
+    }
+
+    kjChildAdd(routeP, tenantP);
+  }
+
+  return treeP;
+}
@@ -0,0 +1,108 @@
+#ifndef SRC_LIB_ORIONLD_COMMON_ORIONLDLATENCY_H_
+#define SRC_LIB_ORIONLD_COMMON_ORIONLDLATENCY_H_
+
+/*
+*
+* Copyright 2021 FIWARE Foundation e.V.
+*
+* This file is part of Orion-LD Context Broker.
+*
+* Orion-LD Context Broker is free software: you can redistribute it and/or
+* modify it under the terms of the GNU Affero General Public License as
+* published by the Free Software Foundation, either version 3 of the
+* License, or (at your option) any later version.
+*
+* Orion-LD Context Broker is distributed in the hope that it will be useful,
+* but WITHOUT ANY WARRANTY; without even the implied warranty of
+* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU Affero
+* General Public License for more details.
+*
+* You should have received a copy of the GNU Affero General Public License
+* along with Orion-LD Context Broker. If not, see http://www.gnu.org/licenses/.
+*
+* For those usages not covered by this license please contact with
+* orionld at fiware dot org
+*
+* Author: Ken Zangelin
+*/
+extern "C"
+{
+#include "kjson/KjNode.h"                                        // KjNode
+}
+
+
+
+// -----------------------------------------------------------------------------
+//
+// OrionldLatencyPhase - the phases of an NGSI-LD request that are measured
+//
+// LP_REQUEST is the entire request, from the first MHD callback until the request is completed (notifications included).
+// The other phases are added up per request (e.g. more than one DB operation), and a phase that didn't take place is not recorded.
+//
+// LP_DB is the time a connection of the mongo legacy driver is held (getMongoConnection until releaseMongoConnection, pool wait
+// included) - all DB operations of that driver. With the mongoc driver, only the entity queries (GET /entities) and entity retrievals
+// are measured, as the mongoc client is kept for the entire request.
+//
+typedef enum OrionldLatencyPhase
+{
+  LP_REQUEST = 0,
+  LP_PARSE,
+  LP_SERVICE_ROUTINE,
+  LP_DB,
+  LP_FORWARD,
+  LP_RENDER,
+  LP_REPLY,
+  LP_TROE,
+  LP_NOTIFY,
+  LP_PHASES
+} OrionldLatencyPhase;
+
+
+
+// -----------------------------------------------------------------------------
+//
+// orionldLatencyInit - prepare the latency histograms (to be called before the REST interface is started)
+//
+extern void orionldLatencyInit(void);
+
+
+
+// -----------------------------------------------------------------------------
+//
+// orionldLatencyRequestStart - a new NGSI-LD request starts in the calling thread
+//
+extern void orionldLatencyRequestStart(void);
+
+
+
+// -----------------------------------------------------------------------------
+//
+// orionldLatencyPhaseStart - a phase of the current request starts
+//
+extern void orionldLatencyPhaseStart(OrionldLatencyPhase phase);
+
+
+
+// -----------------------------------------------------------------------------
+//
+// orionldLatencyPhaseEnd - a phase of the current request ends
+//
+extern void orionldLatencyPhaseEnd(OrionldLatencyPhase phase);
+
+
+
+// -----------------------------------------------------------------------------
+//
+// orionldLatencyRequestEnd - the current request is completed - record its phases in the histograms of its service route and tenant
+//
+extern void orionldLatencyRequestEnd(void);
+
+
+
+// -----------------------------------------------------------------------------
+//
+// orionldLatencyKjTree - merge the histograms of all threads and render count, p50, p99, p999 and max, per route/tenant/phase
+//
+extern KjNode* orionldLatencyKjTree(void);
+
+#endif  // SRC_LIB_ORIONLD_COMMON_ORIONLDLATENCY_H_
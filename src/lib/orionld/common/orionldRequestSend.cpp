@@ -88,20 +88,65 @@ static size_t writeCallback(void* contents, size_t size, size_t members, void* u
 
 // -----------------------------------------------------------------------------
 //
-// headerName -
+// orionldHttpHeaderName -
 //
-static const char* headerName[7] = {
+const char* orionldHttpHeaderName[9] = {
   "None",
   "Content-Type",
   "Accept",
   "Link",
   "NGSILD-Tenant",
   "NGSILD-Path",
-  "X-Auth-Token"
+  "X-Auth-Token",
+  "If-None-Match",
+  "If-Modified-Since"
 };
 
 
 
+// -----------------------------------------------------------------------------
+//
+// validatorCopy - copy the value of a response header, without the trailing CRLF
+//
+static void validatorCopy(char* to, size_t toSize, const char* value, size_t valueLen)
+{
+  while ((valueLen > 0) && ((*value == ' ') || (*value == '\t')))
+  {
+    ++value;
+    --valueLen;
+  }
+
+  while ((valueLen > 0) && ((value[valueLen - 1] == '\r') || (value[valueLen - 1] == '\n') || (value[valueLen - 1] == ' ')))
+    --valueLen;
+
+  if (valueLen >= toSize)  // Too long - better not to use it at all
+    valueLen = 0;
+
+  memcpy(to, value, valueLen);
+  to[valueLen] = 0;
+}
+
+
+
+// -----------------------------------------------------------------------------
+//
+// headerCallback - pick up the validators (ETag and Last-Modified) of the response
+//
+static size_t headerCallback(char* header, size_t size, size_t members, void* userP)
+{
+  size_t                  headerLen = size * members;
+  OrionldResponseBuffer*  rBufP     = (OrionldResponseBuffer*) userP;
+
+  if ((headerLen > 5) && (strncasecmp(header, "ETag:", 5) == 0))
+    validatorCopy(rBufP->etag, sizeof(rBufP->etag), &header[5], headerLen - 5);
+  else if ((headerLen > 14) && (strncasecmp(header, "Last-Modified:", 14) == 0))
+    validatorCopy(rBufP->lastModified, sizeof(rBufP->lastModified), &header[14], headerLen - 14);
+
+  return headerLen;
+}
+
+
+
 // -----------------------------------------------------------------------------
 //
 // orionldRequestSend - send a request and await its response
@@ -157,6 +202,10 @@ bool orionldRequestSend
 
   *tryAgainP = false;
 
+  rBufP->httpStatus      = 0;
+  rBufP->etag[0]         = 0;
+  rBufP->lastModified[0] = 0;
+
   if (rBufP->buf == NULL)
   {
     rBufP->size       = 2048;
@@ -214,6 +263,8 @@ bool orionldRequestSend
   curl_easy_setopt(cc.curl, CURLOPT_FOLLOWLOCATION, 1L);                   // Allow redirection
   curl_easy_setopt(cc.curl, CURLOPT_WRITEFUNCTION, writeCallback);         // Callback function for writes
   curl_easy_setopt(cc.curl, CURLOPT_WRITEDATA, rBufP);                     // Custom data for response handling
+  curl_easy_setopt(cc.curl, CURLOPT_HEADERFUNCTION, headerCallback);       // Callback function for response headers
+  curl_easy_setopt(cc.curl, CURLOPT_HEADERDATA, rBufP);                    // Custom data for response headers
   curl_easy_setopt(cc.curl, CURLOPT_TIMEOUT_MS, tmoInMilliSeconds);        // Timeout
   curl_easy_setopt(cc.curl, CURLOPT_FAILONERROR, true);                    // Fail On Error - to detect 404 etc.
   curl_easy_setopt(cc.curl, CURLOPT_FOLLOWLOCATION, 1L);                   // Follow redirections
@@ -264,9 +315,9 @@ bool orionldRequestSend
     OrionldHttpHeader* headerP = &headerV[ix];
     char               headerString[256];
 
-    snprintf(headerString, sizeof(headerString), "%s:%s", headerName[headerP->type], headerP->value);
+    snprintf(headerString, sizeof(headerString), "%s:%s", orionldHttpHeaderName[headerP->type], headerP->value);
     headers = curl_slist_append(headers, headerString);
-    LM_T(LmtRequestSend, ("  %s: %s", headerName[headerP->type], headerP->value));
+    LM_T(LmtRequestSend, ("  %s: %s", orionldHttpHeaderName[headerP->type], headerP->value));
     ++ix;
   }
 
@@ -290,6 +341,7 @@ bool orionldRequestSend
   }
 
   // The downloaded buffer is in rBufP->buf
+  curl_easy_getinfo(cc.curl, CURLINFO_RESPONSE_CODE, &rBufP->httpStatus);
 
   release_curl_context(&cc);
 
@@ -41,7 +41,9 @@ typedef enum OrionldHttpHeaderType
   HttpHeaderLink,
   HttpHeaderTenant,
   HttpHeaderPath,
-  HttpHeaderXauth
+  HttpHeaderXauth,
+  HttpHeaderIfNoneMatch,
+  HttpHeaderIfModifiedSince
 } OrionldHttpHeaderType;
 
 
@@ -58,6 +60,14 @@ typedef struct OrionldHttpHeader
 
 
 
+// -----------------------------------------------------------------------------
+//
+// orionldHttpHeaderName - the names of the HTTP headers, indexed by OrionldHttpHeaderType
+//
+extern const char* orionldHttpHeaderName[9];
+
+
+
 // -----------------------------------------------------------------------------
 //
 // orionldRequestSend - send a request and await its response
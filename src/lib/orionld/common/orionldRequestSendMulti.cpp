@@ -0,0 +1,383 @@
+/*
+*
+* Copyright 2021 FIWARE Foundation e.V.
+*
+* This file is part of Orion-LD Context Broker.
+*
+* Orion-LD Context Broker is free software: you can redistribute it and/or
+* modify it under the terms of the GNU Affero General Public License as
+* published by the Free Software Foundation, either version 3 of the
+* License, or (at your option) any later version.
+*
+* Orion-LD Context Broker is distributed in the hope that it will be useful,
+* but WITHOUT ANY WARRANTY; without even the implied warranty of
+* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU Affero
+* General Public License for more details.
+*
+* You should have received a copy of the GNU Affero General Public License
+* along with Orion-LD Context Broker. If not, see http://www.gnu.org/licenses/.
+*
+* For those usages not covered by this license please contact with
+* orionld at fiware dot org
+*
+* Author: Ken Zangelin
+*/
+#include <string.h>                                              // memcpy, strlen
+#include <stdlib.h>                                              // malloc, realloc
+#include <time.h>                                                // clock_gettime
+#include <pthread.h>                                             // pthread_once, pthread_mutex_*
+#include <curl/curl.h>                                           // curl
+
+#include "logMsg/logMsg.h"                                       // LM_*
+#include "logMsg/traceLevels.h"                                  // Lmt*
+
+#include "orionld/common/orionldState.h"                         // orionldState, orionldStateDelayedFreeEnqueue
+#include "orionld/common/orionldRequestSend.h"                   // orionldHttpHeaderName
+#include "orionld/common/orionldForwardLatency.h"                // orionldForwardLatencyRecord
+#include "orionld/common/orionldRequestSendMulti.h"              // Own interface
+
+
+
+// -----------------------------------------------------------------------------
+//
+// Connection sharing
+//
+// All easy handles use the same share handle. This way the connections (and DNS lookups and SSL sessions) are
+// kept alive after the request and reused by the next request to the same destination, no matter from what thread.
+// The share handle is protected by one mutex per type of shared data.
+//
+static CURLSH*          shareP = NULL;
+static pthread_once_t   shareOnce = PTHREAD_ONCE_INIT;
+static pthread_mutex_t  shareMutexV[CURL_LOCK_DATA_LAST];
+
+
+
+// -----------------------------------------------------------------------------
+//
+// shareLock -
+//
+static void shareLock(CURL* curlP, curl_lock_data data, curl_lock_access access, void* userP)
+{
+  pthread_mutex_lock(&shareMutexV[data]);
+}
+
+
+
+// -----------------------------------------------------------------------------
+//
+// shareUnlock -
+//
+static void shareUnlock(CURL* curlP, curl_lock_data data, void* userP)
+{
+  pthread_mutex_unlock(&shareMutexV[data]);
+}
+
+
+
+// -----------------------------------------------------------------------------
+//
+// shareInit -
+//
+static void shareInit(void)
+{
+  for (int ix = 0; ix < CURL_LOCK_DATA_LAST; ix++)
+    pthread_mutex_init(&shareMutexV[ix], NULL);
+
+  shareP = curl_share_init();
+  if (shareP == NULL)
+  {
+    LM_E(("Internal Error (unable to create a CURL share handle - connections to context sources will not be reused)"));
+    return;
+  }
+
+  curl_share_setopt(shareP, CURLSHOPT_LOCKFUNC,   shareLock);
+  curl_share_setopt(shareP, CURLSHOPT_UNLOCKFUNC, shareUnlock);
+  curl_share_setopt(shareP, CURLSHOPT_SHARE,      CURL_LOCK_DATA_CONNECT);
+  curl_share_setopt(shareP, CURLSHOPT_SHARE,      CURL_LOCK_DATA_DNS);
+  curl_share_setopt(shareP, CURLSHOPT_SHARE,      CURL_LOCK_DATA_SSL_SESSION);
+}
+
+
+
+// -----------------------------------------------------------------------------
+//
+// msNow - monotonic time in milliseconds
+//
+static long long msNow(void)
+{
+  struct timespec now;
+
+  clock_gettime(CLOCK_MONOTONIC, &now);
+  return (long long) now.tv_sec * 1000 + now.tv_nsec / 1000000;
+}
+
+
+
+// -----------------------------------------------------------------------------
+//
+// writeCallback -
+//
+// The response starts in the internal buffer of the OrionldResponseBuffer and is moved to allocated memory if it doesn't fit.
+// The allocated buffer is freed when the request thread ends (see requestDone).
+//
+static size_t writeCallback(void* contents, size_t size, size_t members, void* userP)
+{
+  size_t                  bytesToCopy  = size * members;
+  OrionldResponseBuffer*  rBufP        = (OrionldResponseBuffer*) userP;
+  int                     xtraBytes    = 512;
+
+  if (bytesToCopy + rBufP->used >= rBufP->size)
+  {
+    if (rBufP->buf == rBufP->internalBuffer)
+    {
+      rBufP->buf = (char*) malloc(rBufP->size + bytesToCopy + xtraBytes);
+
+      if (rBufP->buf != NULL)
+        memcpy(rBufP->buf, rBufP->internalBuffer, rBufP->used);
+    }
+    else
+      rBufP->buf = (char*) realloc(rBufP->buf, rBufP->size + bytesToCopy + xtraBytes);
+
+    if (rBufP->buf == NULL)
+      LM_X(1, ("Runtime Error (out of memory)"));
+
+    rBufP->size      = rBufP->size + bytesToCopy + xtraBytes;
+    rBufP->allocated = true;
+  }
+
+  memcpy(&rBufP->buf[rBufP->used], contents, bytesToCopy);
+
+  rBufP->used += bytesToCopy;
+  rBufP->buf[rBufP->used] = 0;
+
+  return bytesToCopy;
+}
+
+
+
+// -----------------------------------------------------------------------------
+//
+// requestPrepare - create and set up the easy handle of a request
+//
+static bool requestPrepare(OrionldMultiRequest* reqP, int tmoInMilliSeconds)
+{
+  reqP->ok                   = false;
+  reqP->detail               = NULL;
+  reqP->latency              = 0;
+  reqP->headers              = NULL;
+  reqP->rBuf.buf             = reqP->rBuf.internalBuffer;
+  reqP->rBuf.buf[0]          = 0;
+  reqP->rBuf.size            = sizeof(reqP->rBuf.internalBuffer);
+  reqP->rBuf.used            = 0;
+  reqP->rBuf.allocated       = false;
+  reqP->rBuf.httpStatus      = 0;
+  reqP->rBuf.etag[0]         = 0;
+  reqP->rBuf.lastModified[0] = 0;
+
+  if (reqP->port != 0)
+    snprintf(reqP->url, sizeof(reqP->url), "%s://%s:%d%s", reqP->protocol, reqP->ip, reqP->port, (reqP->urlPath != NULL)? reqP->urlPath : "");
+  else
+    snprintf(reqP->url, sizeof(reqP->url), "%s://%s%s", reqP->protocol, reqP->ip, (reqP->urlPath != NULL)? reqP->urlPath : "");
+
+  reqP->curl = curl_easy_init();
+  if (reqP->curl == NULL)
+  {
+    LM_E(("Internal Error (Unable to create CURL handle)"));
+    reqP->detail = "Unable to create CURL handle";
+    return false;
+  }
+
+  LM_T(LmtRequestSend, ("%s %s", reqP->verb, reqP->url));
+
+  curl_easy_setopt(reqP->curl, CURLOPT_URL, reqP->url);                          // Set the URL
+  curl_easy_setopt(reqP->curl, CURLOPT_CUSTOMREQUEST, reqP->verb);               // Set the HTTP verb
+  curl_easy_setopt(reqP->curl, CURLOPT_FOLLOWLOCATION, 1L);                      // Follow redirections
+  curl_easy_setopt(reqP->curl, CURLOPT_WRITEFUNCTION, writeCallback);            // Callback function for writes
+  curl_easy_setopt(reqP->curl, CURLOPT_WRITEDATA, &reqP->rBuf);                  // Custom data for response handling
+  curl_easy_setopt(reqP->curl, CURLOPT_TIMEOUT_MS, (long) tmoInMilliSeconds);    // Timeout - the deadline of the entire fan-out
+  curl_easy_setopt(reqP->curl, CURLOPT_FAILONERROR, 1L);                         // Fail On Error - to detect 404 etc.
+  curl_easy_setopt(reqP->curl, CURLOPT_NOSIGNAL, 1L);                            // No signals - we're multi-threaded
+  curl_easy_setopt(reqP->curl, CURLOPT_PRIVATE, reqP);                           // To find the request from the easy handle
+
+  if (shareP != NULL)
+    curl_easy_setopt(reqP->curl, CURLOPT_SHARE, shareP);                         // Connection reuse
+
+  if (reqP->contentType != NULL)
+  {
+    char contentTypeHeader[128];
+
+    snprintf(contentTypeHeader, sizeof(contentTypeHeader), "Content-Type:%s", reqP->contentType);
+    reqP->headers = curl_slist_append(reqP->headers, contentTypeHeader);
+
+    curl_easy_setopt(reqP->curl, CURLOPT_POSTFIELDS, reqP->payload);
+    curl_easy_setopt(reqP->curl, CURLOPT_POSTFIELDSIZE, (long) reqP->payloadLen);
+  }
+
+  if (reqP->linkHeader != NULL)
+  {
+    char linkHeaderString[512];
+
+    snprintf(linkHeaderString, sizeof(linkHeaderString), "Link: %s", reqP->linkHeader);
+    reqP->headers = curl_slist_append(reqP->headers, linkHeaderString);
+  }
+
+  if (reqP->acceptHeader != NULL)
+    reqP->headers = curl_slist_append(reqP->headers, reqP->acceptHeader);
+
+  for (int ix = 0; (reqP->headerV != NULL) && (reqP->headerV[ix].type != HttpHeaderNone); ix++)
+  {
+    OrionldHttpHeader* headerP = &reqP->headerV[ix];
+    char               headerString[256];
+
+    snprintf(headerString, sizeof(headerString), "%s:%s", orionldHttpHeaderName[headerP->type], headerP->value);
+    reqP->headers = curl_slist_append(reqP->headers, headerString);
+  }
+
+  if (reqP->headers != NULL)
+    curl_easy_setopt(reqP->curl, CURLOPT_HTTPHEADER, reqP->headers);
+
+  return true;
+}
+
+
+
+// -----------------------------------------------------------------------------
+//
+// requestDone - release the easy handle of a finished (or aborted) request and hand the result over to the caller
+//
+static void requestDone(CURLM* multiP, OrionldMultiRequest* reqP, const char* detail, OrionldMultiResponseFunction responseFunction)
+{
+  double totalTime = 0;
+
+  curl_easy_getinfo(reqP->curl, CURLINFO_TOTAL_TIME, &totalTime);
+  reqP->latency = (int) (totalTime * 1000);
+
+  if (detail == NULL)
+  {
+    curl_easy_getinfo(reqP->curl, CURLINFO_RESPONSE_CODE, &reqP->rBuf.httpStatus);
+    reqP->ok = true;
+    LM_T(LmtRequestSend, ("%s %s: %d in %d ms", reqP->verb, reqP->url, (int) reqP->rBuf.httpStatus, reqP->latency));
+  }
+  else
+  {
+    reqP->detail = detail;
+    LM_W(("%s %s failed after %d ms: %s", reqP->verb, reqP->url, reqP->latency, detail));
+  }
+
+  orionldForwardLatencyRecord(reqP->protocol, reqP->ip, reqP->port, (uint64_t) (totalTime * 1000000), reqP->ok);
+
+  curl_multi_remove_handle(multiP, reqP->curl);
+  curl_easy_cleanup(reqP->curl);
+  reqP->curl = NULL;
+
+  if (reqP->headers != NULL)
+  {
+    curl_slist_free_all(reqP->headers);
+    reqP->headers = NULL;
+  }
+
+  // The response may be parsed in place by the caller, so the buffer must live until the request thread ends
+  if (reqP->rBuf.buf != reqP->rBuf.internalBuffer)
+    orionldStateDelayedFreeEnqueue(reqP->rBuf.buf);
+
+  if (responseFunction != NULL)
+    responseFunction(reqP);
+}
+
+
+
+// -----------------------------------------------------------------------------
+//
+// orionldRequestSendMulti - send a number of requests in parallel and await their responses
+//
+int orionldRequestSendMulti
+(
+  OrionldMultiRequest*          reqV,
+  int                           reqs,
+  int                           tmoInMilliSeconds,
+  OrionldMultiResponseFunction  responseFunction
+)
+{
+  long long  deadline = msNow() + tmoInMilliSeconds;
+  int        okCount  = 0;
+  int        running  = 0;
+  CURLM*     multiP;
+
+  pthread_once(&shareOnce, shareInit);
+
+  multiP = curl_multi_init();
+  if (multiP == NULL)
+  {
+    LM_E(("Internal Error (Unable to create CURL multi handle)"));
+    return 0;
+  }
+
+  for (int ix = 0; ix < reqs; ix++)
+  {
+    OrionldMultiRequest* reqP = &reqV[ix];
+
+    if (requestPrepare(reqP, tmoInMilliSeconds) == false)
+    {
+      if (reqP->curl != NULL)
+        requestDone(multiP, reqP, reqP->detail, responseFunction);
+      else if (responseFunction != NULL)
+        responseFunction(reqP);
+      continue;
+    }
+
+    curl_multi_add_handle(multiP, reqP->curl);
+  }
+
+  //
+  // Drive all transfers until they're all done or the deadline expires.
+  // Each response is handed over to the caller as soon as it has arrived, not waiting for the others.
+  //
+  do
+  {
+    CURLMsg*  msgP;
+    int       msgsLeft;
+
+    curl_multi_perform(multiP, &running);
+
+    while ((msgP = curl_multi_info_read(multiP, &msgsLeft)) != NULL)
+    {
+      OrionldMultiRequest* reqP = NULL;
+
+      if (msgP->msg != CURLMSG_DONE)
+        continue;
+
+      curl_easy_getinfo(msgP->easy_handle, CURLINFO_PRIVATE, (char**) &reqP);
+
+      if (msgP->data.result == CURLE_OK)
+      {
+        requestDone(multiP, reqP, NULL, responseFunction);
+        ++okCount;
+      }
+      else
+        requestDone(multiP, reqP, curl_easy_strerror(msgP->data.result), responseFunction);
+    }
+
+    if (running > 0)
+    {
+      long long msLeft = deadline - msNow();
+
+      if (msLeft <= 0)
+        break;
+
+      curl_multi_wait(multiP, NULL, 0, (msLeft < 100)? (int) msLeft : 100, NULL);
+    }
+  } while (running > 0);
+
+  //
+  // Abort the requests that didn't make it before the deadline
+  //
+  for (int ix = 0; ix < reqs; ix++)
+  {
+    if (reqV[ix].curl != NULL)
+      requestDone(multiP, &reqV[ix], "Deadline expired", responseFunction);
+  }
+
+  curl_multi_cleanup(multiP);
+
+  return okCount;
+}
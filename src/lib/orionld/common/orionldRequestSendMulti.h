@@ -0,0 +1,99 @@
+#ifndef SRC_LIB_ORIONLD_COMMON_ORIONLDREQUESTSENDMULTI_H_
+#define SRC_LIB_ORIONLD_COMMON_ORIONLDREQUESTSENDMULTI_H_
+
+/*
+*
+* Copyright 2021 FIWARE Foundation e.V.
+*
+* This file is part of Orion-LD Context Broker.
+*
+* Orion-LD Context Broker is free software: you can redistribute it and/or
+* modify it under the terms of the GNU Affero General Public License as
+* published by the Free Software Foundation, either version 3 of the
+* License, or (at your option) any later version.
+*
+* Orion-LD Context Broker is distributed in the hope that it will be useful,
+* but WITHOUT ANY WARRANTY; without even the implied warranty of
+* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU Affero
+* General Public License for more details.
+*
+* You should have received a copy of the GNU Affero General Public License
+* along with Orion-LD Context Broker. If not, see http://www.gnu.org/licenses/.
+*
+* For those usages not covered by this license please contact with
+* orionld at fiware dot org
+*
+* Author: Ken Zangelin
+*/
+#include <stdint.h>                                              // uint16_t
+#include <curl/curl.h>                                           // CURL, curl_slist
+
+#include "orionld/common/OrionldResponseBuffer.h"                // OrionldResponseBuffer
+#include "orionld/common/orionldRequestSend.h"                   // OrionldHttpHeader
+
+
+
+// -----------------------------------------------------------------------------
+//
+// OrionldMultiRequest - one of the requests sent in parallel by orionldRequestSendMulti
+//
+// The caller fills in the input fields (all pointers must stay valid until orionldRequestSendMulti returns).
+// orionldRequestSendMulti fills in the output fields, before the response function is called.
+//
+typedef struct OrionldMultiRequest
+{
+  // Input
+  const char*             protocol;
+  const char*             ip;
+  uint16_t                port;
+  const char*             verb;
+  const char*             urlPath;
+  const char*             linkHeader;
+  const char*             acceptHeader;
+  const char*             contentType;
+  const char*             payload;
+  int                     payloadLen;
+  OrionldHttpHeader*      headerV;
+  void*                   userP;        // For the caller, e.g. the registration that gave rise to the request
+
+  // Output
+  OrionldResponseBuffer   rBuf;
+  bool                    ok;
+  const char*             detail;
+  int                     latency;      // Time from the request being sent until its response was received, in milliseconds
+
+  // Internal
+  CURL*                   curl;
+  struct curl_slist*      headers;
+  char                    url[256];
+} OrionldMultiRequest;
+
+
+
+// -----------------------------------------------------------------------------
+//
+// OrionldMultiResponseFunction - called for each request, as soon as its response (or its error) is in
+//
+typedef void (*OrionldMultiResponseFunction)(OrionldMultiRequest* reqP);
+
+
+
+// -----------------------------------------------------------------------------
+//
+// orionldRequestSendMulti - send a number of requests in parallel and await their responses
+//
+// All requests share one deadline, 'tmoInMilliSeconds'. Requests still pending when the deadline expires are
+// aborted and reported as failed.
+// Connections to the destinations are kept alive and reused by later calls, from any thread.
+//
+// Returns the number of requests that succeeded.
+//
+extern int orionldRequestSendMulti
+(
+  OrionldMultiRequest*          reqV,
+  int                           reqs,
+  int                           tmoInMilliSeconds,
+  OrionldMultiResponseFunction  responseFunction
+);
+
+#endif  // SRC_LIB_ORIONLD_COMMON_ORIONLDREQUESTSENDMULTI_H_
@@ -36,11 +36,14 @@ extern "C"
 #include "logMsg/logMsg.h"                                       // LM_*
 #include "logMsg/traceLevels.h"                                  // Lmt*
 
-#include "orionld/types/OrionldGeoIndex.h"                       // OrionldGeoIndex
+#include "orionld/types/OrionldTenant.h"                         // OrionldTenant, ORIONLD_TENANT_TABLE_BUCKETS
 #include "orionld/db/dbConfiguration.h"                          // DB_DRIVER_MONGOC
 #include "orionld/context/orionldCoreContext.h"                  // orionldCoreContext
 #include "orionld/common/QNode.h"                                // QNode
 #include "orionld/common/performance.h"                          // REQUEST_PERFORMANCE
+#ifdef DB_DRIVER_MONGOC
+#include "orionld/mongoc/mongocConnectionRelease.h"              // mongocConnectionRelease
+#endif
 #include "orionld/common/orionldState.h"                         // Own interface
 
 
@@ -90,9 +93,10 @@ uint16_t          portNo                   = 0;
 int               dbNameLen;
 char              orionldHostName[128];
 int               orionldHostNameLen       = -1;
-char*             tenantV[100];
+OrionldTenant*    tenantTable[ORIONLD_TENANT_TABLE_BUCKETS];
+OrionldTenant*    tenantList               = NULL;
 unsigned int      tenants                  = 0;
-OrionldGeoIndex*  geoIndexList             = NULL;
+OrionldTenant     tenant0;
 OrionldPhase      orionldPhase             = OrionldPhaseStartup;
 bool              orionldStartup           = true;
 sem_t             tenantSem;
@@ -102,8 +106,8 @@ sem_t             tenantSem;
 // Variables for Mongo C Driver
 //
 #ifdef DB_DRIVER_MONGOC
-mongoc_collection_t*  mongoEntitiesCollectionP      = NULL;
-mongoc_collection_t*  mongoRegistrationsCollectionP = NULL;
+mongoc_uri_t*          mongocUri  = NULL;
+mongoc_client_pool_t*  mongocPool = NULL;
 #endif
 
 
@@ -198,6 +202,10 @@ void orionldStateRelease(void)
 
   if (orionldState.qMongoFilterP != NULL)
     delete orionldState.qMongoFilterP;
+
+#ifdef DB_DRIVER_MONGOC
+  mongocConnectionRelease();
+#endif
 }
 
 
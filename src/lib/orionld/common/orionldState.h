@@ -45,9 +45,8 @@ extern "C"
 #include "orionld/common/performance.h"                          // REQUEST_PERFORMANCE
 #include "orionld/common/QNode.h"                                // QNode
 #include "orionld/common/OrionldResponseBuffer.h"                // OrionldResponseBuffer
-#include "orionld/types/OrionldGeoIndex.h"                       // OrionldGeoIndex
+#include "orionld/types/OrionldTenant.h"                         // OrionldTenant, ORIONLD_TENANT_TABLE_BUCKETS
 #include "orionld/types/OrionldGeoJsonType.h"                    // OrionldGeoJsonType
-#include "orionld/types/OrionldPrefixCache.h"                    // OrionldPrefixCache
 #include "orionld/context/OrionldContext.h"                      // OrionldContext
 
 
@@ -188,6 +187,7 @@ typedef struct OrionldConnectionState
   char*                   responsePayload;
   bool                    responsePayloadAllocated;
   char*                   tenant;
+  OrionldTenant*          tenantP;         // The tenant, once looked up in the tenant registry (NULL for the default tenant)
   char*                   servicePath;
   bool                    linkHttpHeaderPresent;
   char*                   link;
@@ -203,6 +203,7 @@ typedef struct OrionldConnectionState
   char*                   geoType;
   KjNode*                 geoCoordsP;
   bool                    entityCreated;                // If an entity is created, if complex context, it must be stored
+  bool                    entityInsertFirst;            // POST /entities: no lookup before the insert - a duplicate key error means 409
   char*                   entityId;
   OrionldUriParamOptions  uriParamOptions;
   OrionldUriParams        uriParams;
@@ -227,7 +228,6 @@ typedef struct OrionldConnectionState
   int                     qNodeIx;
   char                    qDebugBuffer[24 * 1024];
   mongo::BSONObj*         qMongoFilterP;
-  char*                   jsonBuf;    // Used by kjTreeFromBsonObj
 
 #if 0
   //
@@ -253,16 +253,13 @@ typedef struct OrionldConnectionState
   int                     notificationRecords;
   OrionldNotificationInfo notificationInfo[100];
   bool                    notify;
-  OrionldPrefixCache      prefixCache;
   OrionldResponseBuffer   httpResponse;
 
 #ifdef DB_DRIVER_MONGOC
   //
-  // MongoDB stuff
+  // MongoDB stuff - the client of the thread, checked out from mongocPool (see mongocConnectionGet)
   //
-  mongoc_uri_t*           mongoUri;
-  mongoc_client_t*        mongoClient;
-  mongoc_database_t*      mongoDatabase;
+  mongoc_client_t*        mongocClientP;
 #endif
 
   //
@@ -365,24 +362,39 @@ extern char              dbName[];                 // From orionld.cpp
 extern int               dbNameLen;
 extern char              dbUser[];                 // From orionld.cpp
 extern char              dbPwd[];                  // From orionld.cpp
+extern char              rplSet[];                 // From orionld.cpp
+extern int               dbPoolSize;               // From orionld.cpp
 extern bool              multitenancy;             // From orionld.cpp
 extern char*             tenant;                   // From orionld.cpp
 extern int               contextDownloadAttempts;  // From orionld.cpp
 extern int               contextDownloadTimeout;   // From orionld.cpp
+extern char              contextDir[256];          // From orionld.cpp
+extern bool              contextRevalidate;        // From orionld.cpp
 extern bool              troe;                     // From orionld.cpp
 extern char              troeHost[64];             // From orionld.cpp
 extern unsigned short    troePort;                 // From orionld.cpp
 extern char              troeUser[64];             // From orionld.cpp
 extern char              troePwd[64];              // From orionld.cpp
 extern int               troePoolSize;             // From orionld.cpp
+extern int               troeQueueSize;            // From orionld.cpp
+extern int               troeWorkers;              // From orionld.cpp
+extern char              troeSpillFile[256];       // From orionld.cpp
 extern bool              forwarding;               // From orionld.cpp
+extern int               forwardTimeout;           // From orionld.cpp
+extern int               mqttMaxInFlight;          // From orionld.cpp
 extern const char*       orionldVersion;
-extern char*             tenantV[100];
+extern OrionldTenant*    tenantTable[ORIONLD_TENANT_TABLE_BUCKETS];  // The tenant registry - see orionldTenantCreate
+extern OrionldTenant*    tenantList;               // All tenants, the newest first
 extern unsigned int      tenants;
-extern OrionldGeoIndex*  geoIndexList;
+extern OrionldTenant     tenant0;                  // The default tenant
 extern OrionldPhase      orionldPhase;
 extern bool              orionldStartup;           // For now, only used inside sub-cache routines
 extern bool              idIndex;                  // From orionld.cpp
+extern bool              entityIdUnique;           // From orionld.cpp
+extern int               notifPoolSize;            // From orionld.cpp
+extern int               notifIdleTimeout;         // From orionld.cpp
+extern int               notifMaxConns;            // From orionld.cpp
+extern int               notifSenders;             // From orionld.cpp
 extern sem_t             tenantSem;
 
 
@@ -392,8 +404,8 @@ extern sem_t             tenantSem;
 // Global variables for Mongo C Driver
 //
 #ifdef DB_DRIVER_MONGOC
-extern mongoc_collection_t*  mongoEntitiesCollectionP;
-extern mongoc_collection_t*  mongoRegistrationsCollectionP;
+extern mongoc_uri_t*          mongocUri;
+extern mongoc_client_pool_t*  mongocPool;
 #endif
 
 
@@ -22,17 +22,18 @@
 *
 * Author: Ken Zangelin
 */
-#include <string.h>                                            // strcpy
-
-extern "C"
-{
-#include "kbase/kMacros.h"                                     // K_VEC_SIZE
-}
+#include <stdio.h>                                             // snprintf
+#include <stdlib.h>                                            // calloc
+#include <string.h>                                            // strncpy, strerror
+#include <errno.h>                                             // errno
+#include <semaphore.h>                                         // sem_init
 
 #include "logMsg/logMsg.h"                                     // LM_*
 #include "logMsg/traceLevels.h"                                // Lmt*
 
-#include "orionld/common/orionldState.h"                       // tenantV, tenants
+#include "orionld/types/OrionldTenant.h"                       // OrionldTenant, ORIONLD_TENANT_TABLE_BUCKETS
+#include "orionld/common/orionldState.h"                       // tenantTable, tenantList, tenants, dbName
+#include "orionld/common/orionldTenantHash.h"                  // orionldTenantHash
 #include "orionld/troe/pgDatabasePrepare.h"                    // pgDatabasePrepare
 #include "orionld/common/orionldTenantCreate.h"                // Own interface
 
@@ -42,18 +43,41 @@ extern "C"
 //
 // orionldTenantCreate
 //
-void orionldTenantCreate(char* tenant)
+// The caller must hold tenantSem - creation of tenants is serialized.
+//
+// The tenant is completely filled in before it is published (with release stores), so that
+// orionldTenantLookup (and the iterations over tenantList) can read the registry without taking any lock.
+//
+OrionldTenant* orionldTenantCreate(const char* tenant)
 {
+  OrionldTenant* tenantP = (OrionldTenant*) calloc(1, sizeof(OrionldTenant));
+
+  if (tenantP == NULL)
+    LM_X(1, ("Out of memory (allocating a tenant)"));
+
   LM_TMP(("TROE: New tenant: '%s'", tenant));
 
-  if (tenants >= K_VEC_SIZE(tenantV))
-    LM_X(1, ("Too many tenants in the system - increase the size of tenantV and recompile!"));
+  strncpy(tenantP->tenant, tenant, sizeof(tenantP->tenant) - 1);
+  snprintf(tenantP->mongoDbName, sizeof(tenantP->mongoDbName), "%s-%s", dbName, tenant);
+  snprintf(tenantP->troeDbName,  sizeof(tenantP->troeDbName),  "%s_%s", dbName, tenant);
+
+  if (sem_init(&tenantP->typeCatalog.sem, 0, 1) == -1)
+    LM_X(1, ("Runtime Error (error initializing the type catalog semaphore of tenant '%s': %s)", tenant, strerror(errno)));
+
+  unsigned int bucket = orionldTenantHash(tenantP->tenant) % ORIONLD_TENANT_TABLE_BUCKETS;
 
-  tenantV[tenants++] = strdup(tenant);
+  tenantP->next     = tenantTable[bucket];
+  tenantP->listNext = tenantList;
+
+  __atomic_store_n(&tenantTable[bucket], tenantP, __ATOMIC_RELEASE);
+  __atomic_store_n(&tenantList, tenantP, __ATOMIC_RELEASE);
+  __atomic_add_fetch(&tenants, 1, __ATOMIC_RELAXED);
 
   if (troe)
   {
-    if (pgDatabasePrepare(orionldState.troeDbName) != true)
-      LM_E(("Database Error (unable to prepare a new TRoE database for tenant '%s')", orionldState.troeDbName));
+    if (pgDatabasePrepare(tenantP->troeDbName) != true)
+      LM_E(("Database Error (unable to prepare a new TRoE database for tenant '%s')", tenantP->troeDbName));
   }
+
+  return tenantP;
 }
@@ -25,7 +25,7 @@
 *
 * Author: Ken Zangelin
 */
-#include <time.h>                                              // time, gmtime_r
+#include "orionld/types/OrionldTenant.h"                       // OrionldTenant
 
 
 
@@ -33,6 +33,6 @@
 //
 // orionldTenantCreate
 //
-extern void orionldTenantCreate(char* tenant);
+extern OrionldTenant* orionldTenantCreate(const char* tenant);
 
 #endif  // SRC_LIB_ORIONLD_COMMON_ORIONLDTENANTCREATE_H_
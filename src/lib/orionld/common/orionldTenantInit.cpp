@@ -23,11 +23,12 @@
 * Author: Ken Zangelin
 */
 #include <semaphore.h>                                           // sem_init
+#include <string.h>                                              // strncpy, bzero
 
 #include "logMsg/logMsg.h"                                       // LM_*
 #include "logMsg/traceLevels.h"                                  // Lmt*
 
-#include "orionld/common/orionldState.h"                         // tenantSem
+#include "orionld/common/orionldState.h"                         // tenantSem, tenant0, dbName
 
 
 
@@ -35,8 +36,18 @@
 //
 // orionldTenantInit
 //
+// The default tenant (tenant0) isn't part of the tenant registry, but it's an OrionldTenant all the same,
+// so that per-tenant data (like the geo-index hash set) is kept the same way for all tenants.
+//
 void orionldTenantInit(void)
 {
   if (sem_init(&tenantSem, 0, 1) == -1)
     LM_X(1, ("Runtime Error (error initializing semaphore for orionld tenants: %s)", strerror(errno)));
+
+  bzero(&tenant0, sizeof(tenant0));
+  strncpy(tenant0.mongoDbName, dbName, sizeof(tenant0.mongoDbName) - 1);
+  strncpy(tenant0.troeDbName,  dbName, sizeof(tenant0.troeDbName) - 1);
+
+  if (sem_init(&tenant0.typeCatalog.sem, 0, 1) == -1)
+    LM_X(1, ("Runtime Error (error initializing the type catalog semaphore of the default tenant: %s)", strerror(errno)));
 }
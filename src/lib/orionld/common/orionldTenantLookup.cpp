@@ -22,12 +22,14 @@
 *
 * Author: Ken Zangelin
 */
-#include <string.h>                                            // strcpy
+#include <string.h>                                            // strcmp
 
 #include "logMsg/logMsg.h"                                     // LM_*
 #include "logMsg/traceLevels.h"                                // Lmt*
 
-#include "orionld/common/orionldState.h"                       // tenantV, tenants
+#include "orionld/types/OrionldTenant.h"                       // OrionldTenant, ORIONLD_TENANT_TABLE_BUCKETS
+#include "orionld/common/orionldState.h"                       // tenantTable
+#include "orionld/common/orionldTenantHash.h"                  // orionldTenantHash
 #include "orionld/common/orionldTenantLookup.h"                // Own interface
 
 
@@ -36,14 +38,19 @@
 //
 // orionldTenantLookup
 //
-char* orionldTenantLookup(const char* tenant)
+// No lock is taken - see orionldTenantCreate
+//
+OrionldTenant* orionldTenantLookup(const char* tenant)
 {
-  for (unsigned int ix = 0; ix < tenants; ix++)
+  unsigned int   bucket   = orionldTenantHash(tenant) % ORIONLD_TENANT_TABLE_BUCKETS;
+  OrionldTenant* tenantP  = __atomic_load_n(&tenantTable[bucket], __ATOMIC_ACQUIRE);
+
+  while (tenantP != NULL)
   {
-    char* withoutPrefix = &tenantV[ix][dbNameLen + 1];
+    if (strcmp(tenant, tenantP->tenant) == 0)
+      return tenantP;
 
-    if (strcmp(tenant, withoutPrefix) == 0)
-      return tenantV[ix];
+    tenantP = tenantP->next;
   }
 
   return NULL;
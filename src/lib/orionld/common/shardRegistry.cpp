@@ -0,0 +1,371 @@
+/*
+*
+* Copyright 2021 FIWARE Foundation e.V.
+*
+* This file is part of Orion-LD Context Broker.
+*
+* Orion-LD Context Broker is free software: you can redistribute it and/or
+* modify it under the terms of the GNU Affero General Public License as
+* published by the Free Software Foundation, either version 3 of the
+* License, or (at your option) any later version.
+*
+* Orion-LD Context Broker is distributed in the hope that it will be useful,
+* but WITHOUT ANY WARRANTY; without even the implied warranty of
+* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU Affero
+* General Public License for more details.
+*
+* You should have received a copy of the GNU Affero General Public License
+* along with Orion-LD Context Broker. If not, see http://www.gnu.org/licenses/.
+*
+* For those usages not covered by this license please contact with
+* orionld at fiware dot org
+*
+* Author: Ken Zangelin
+*/
+#include <errno.h>                                               // errno
+#include <stdlib.h>                                              // calloc, free
+#include <string.h>                                              // strerror, memset
+#include <pthread.h>                                             // pthread_key_create, pthread_getspecific, pthread_setspecific
+#include <semaphore.h>                                           // sem_init, sem_wait, sem_post
+
+#include "logMsg/logMsg.h"                                       // LM_*
+#include "logMsg/traceLevels.h"                                  // Lmt*
+
+#include "orionld/common/shardRegistry.h"                        // Own interface
+
+
+
+// -----------------------------------------------------------------------------
+//
+// shardRelease - destructor of the thread-specific shard pointer - the thread is exiting, its shard is free for the next new thread
+//
+static void shardRelease(void* vP)
+{
+  ShardRegistryShard* shardP = (ShardRegistryShard*) vP;
+
+  __atomic_store_n(&shardP->inUse, false, __ATOMIC_RELEASE);
+}
+
+
+
+// -----------------------------------------------------------------------------
+//
+// shardRegistryInit -
+//
+bool shardRegistryInit
+(
+  ShardRegistry*        regP,
+  const char*           name,
+  int                   keyMax,
+  int                   buckets,
+  int                   chunkSize,
+  int                   slotSize,
+  ShardRegistryMatch    match,
+  ShardRegistryCreate   create,
+  ShardRegistryRelease  release
+)
+{
+  memset(regP, 0, sizeof(ShardRegistry));
+
+  regP->name      = name;
+  regP->keyMax    = keyMax;
+  regP->buckets   = buckets;
+  regP->chunkSize = chunkSize;
+  regP->slotSize  = slotSize;
+  regP->match     = match;
+  regP->create    = create;
+  regP->release   = release;
+  regP->keyTable  = (ShardRegistryKey**) calloc(buckets, sizeof(ShardRegistryKey*));
+  regP->keyV      = (ShardRegistryKey**) calloc(keyMax,  sizeof(ShardRegistryKey*));
+
+  if ((regP->keyTable == NULL) || (regP->keyV == NULL))
+  {
+    LM_E(("Runtime Error (out of memory allocating the key tables of '%s')", name));
+    return false;
+  }
+
+  if (sem_init(&regP->sem, 0, 1) == -1)
+  {
+    LM_E(("Runtime Error (error initializing the semaphore of '%s': %s)", name, strerror(errno)));
+    return false;
+  }
+
+  int ret = pthread_key_create(&regP->shardKey, shardRelease);
+  if (ret != 0)
+  {
+    LM_E(("Runtime Error (error creating the thread key for the shards of '%s': %s)", name, strerror(ret)));
+    return false;
+  }
+
+  return true;
+}
+
+
+
+// -----------------------------------------------------------------------------
+//
+// shardRegistryKeyLookup -
+//
+int shardRegistryKeyLookup(ShardRegistry* regP, const void* probeP, unsigned int hash)
+{
+  for (ShardRegistryKey* keyP = __atomic_load_n(&regP->keyTable[hash % regP->buckets], __ATOMIC_ACQUIRE); keyP != NULL; keyP = keyP->next)
+  {
+    if (regP->match(keyP->dataP, probeP) == true)
+      return keyP->ix;
+  }
+
+  return -1;
+}
+
+
+
+// -----------------------------------------------------------------------------
+//
+// shardRegistryKeyIntern -
+//
+// The key is fully initialized before it's published (atomic store in the bucket), so shardRegistryKeyLookup
+// needs no lock.
+//
+// Once the registry is full, new keys are dropped right away, without semaphore - a flood of new keys must not
+// serialize all requests. The warning is logged once, by the thread that finds the registry full.
+//
+int shardRegistryKeyIntern(ShardRegistry* regP, const void* probeP, unsigned int hash)
+{
+  if (__atomic_load_n(&regP->full, __ATOMIC_ACQUIRE) == true)
+    return -1;
+
+  sem_wait(&regP->sem);
+
+  int ix = shardRegistryKeyLookup(regP, probeP, hash);  // Created by another thread while waiting for the semaphore?
+
+  if (ix != -1)
+  {
+    sem_post(&regP->sem);
+    return ix;
+  }
+
+  if (regP->keys >= regP->keyMax)
+  {
+    bool warn = (regP->full == false);
+
+    __atomic_store_n(&regP->full, true, __ATOMIC_RELEASE);
+    sem_post(&regP->sem);
+
+    if (warn)
+      LM_W(("Too many keys for %s (max %d) - new keys are not kept", regP->name, regP->keyMax));
+
+    return -1;
+  }
+
+  void* dataP = regP->create(probeP);
+
+  if (dataP == NULL)
+  {
+    sem_post(&regP->sem);
+    return -1;
+  }
+
+  ShardRegistryKey*  keyP   = (ShardRegistryKey*) calloc(1, sizeof(ShardRegistryKey));
+  int                bucket = hash % regP->buckets;
+
+  if (keyP == NULL)
+  {
+    sem_post(&regP->sem);
+    regP->release(dataP);
+    LM_E(("Runtime Error (out of memory allocating a key for '%s')", regP->name));
+    return -1;
+  }
+
+  keyP->dataP = dataP;
+  keyP->ix    = regP->keys;
+  keyP->next  = regP->keyTable[bucket];
+
+  regP->keyV[keyP->ix] = keyP;
+
+  __atomic_store_n(&regP->keyTable[bucket], keyP, __ATOMIC_RELEASE);
+  __atomic_store_n(&regP->keys, keyP->ix + 1, __ATOMIC_RELEASE);
+
+  sem_post(&regP->sem);
+
+  return keyP->ix;
+}
+
+
+
+// -----------------------------------------------------------------------------
+//
+// shardRegistryFull -
+//
+bool shardRegistryFull(ShardRegistry* regP)
+{
+  return __atomic_load_n(&regP->full, __ATOMIC_ACQUIRE);
+}
+
+
+
+// -----------------------------------------------------------------------------
+//
+// shardRegistryKeys -
+//
+int shardRegistryKeys(ShardRegistry* regP)
+{
+  return __atomic_load_n(&regP->keys, __ATOMIC_ACQUIRE);
+}
+
+
+
+// -----------------------------------------------------------------------------
+//
+// shardRegistryKeyData -
+//
+void* shardRegistryKeyData(ShardRegistry* regP, int keyIx)
+{
+  return regP->keyV[keyIx]->dataP;
+}
+
+
+
+// -----------------------------------------------------------------------------
+//
+// shardGet - a shard for the calling thread - one of an exited thread, or a new one
+//
+static ShardRegistryShard* shardGet(ShardRegistry* regP)
+{
+  ShardRegistryShard* shardP;
+
+  sem_wait(&regP->sem);
+
+  for (shardP = regP->shardList; shardP != NULL; shardP = shardP->next)
+  {
+    if (__atomic_load_n(&shardP->inUse, __ATOMIC_ACQUIRE) == false)
+      break;
+  }
+
+  if (shardP == NULL)
+  {
+    shardP = (ShardRegistryShard*) calloc(1, sizeof(ShardRegistryShard));
+
+    if (shardP != NULL)
+    {
+      shardP->chunkV = (char**) calloc(regP->keyMax / regP->chunkSize, sizeof(char*));
+
+      if (shardP->chunkV == NULL)
+      {
+        free(shardP);
+        shardP = NULL;
+      }
+    }
+
+    if (shardP == NULL)
+    {
+      sem_post(&regP->sem);
+      LM_E(("Runtime Error (out of memory allocating a shard for '%s')", regP->name));
+      return NULL;
+    }
+
+    shardP->next = regP->shardList;
+    __atomic_store_n(&regP->shardList, shardP, __ATOMIC_RELEASE);
+  }
+
+  shardP->inUse = true;
+  sem_post(&regP->sem);
+
+  pthread_setspecific(regP->shardKey, shardP);
+
+  return shardP;
+}
+
+
+
+// -----------------------------------------------------------------------------
+//
+// shardRegistrySlot -
+//
+// Only the thread owning the shard allocates its chunks - no lock needed.
+//
+void* shardRegistrySlot(ShardRegistry* regP, int keyIx)
+{
+  ShardRegistryShard* shardP = (ShardRegistryShard*) pthread_getspecific(regP->shardKey);
+
+  if ((shardP == NULL) && ((shardP = shardGet(regP)) == NULL))
+    return NULL;
+
+  int    chunkIx = keyIx / regP->chunkSize;
+  char*  chunkP  = shardP->chunkV[chunkIx];
+
+  if (chunkP == NULL)
+  {
+    chunkP = (char*) calloc(regP->chunkSize, regP->slotSize);
+
+    if (chunkP == NULL)
+    {
+      LM_E(("Runtime Error (out of memory allocating counters for '%s')", regP->name));
+      return NULL;
+    }
+
+    __atomic_store_n(&shardP->chunkV[chunkIx], chunkP, __ATOMIC_RELEASE);
+  }
+
+  return &chunkP[(keyIx % regP->chunkSize) * regP->slotSize];
+}
+
+
+
+// -----------------------------------------------------------------------------
+//
+// shardRegistrySlotForEach -
+//
+void shardRegistrySlotForEach(ShardRegistry* regP, int keyIx, ShardRegistrySlotTreat treat, void* paramP)
+{
+  int chunkIx = keyIx / regP->chunkSize;
+
+  for (ShardRegistryShard* shardP = __atomic_load_n(&regP->shardList, __ATOMIC_ACQUIRE); shardP != NULL; shardP = shardP->next)
+  {
+    char* chunkP = __atomic_load_n(&shardP->chunkV[chunkIx], __ATOMIC_ACQUIRE);
+
+    if (chunkP != NULL)
+      treat(&chunkP[(keyIx % regP->chunkSize) * regP->slotSize], paramP);
+  }
+}
+
+
+
+// -----------------------------------------------------------------------------
+//
+// shardRegistryRelease -
+//
+void shardRegistryRelease(ShardRegistry* regP)
+{
+  sem_wait(&regP->sem);
+
+  for (int keyIx = 0; keyIx < regP->keys; ++keyIx)
+  {
+    regP->release(regP->keyV[keyIx]->dataP);
+    free(regP->keyV[keyIx]);
+    regP->keyV[keyIx] = NULL;
+  }
+
+  memset(regP->keyTable, 0, regP->buckets * sizeof(ShardRegistryKey*));
+  regP->keys = 0;
+  regP->full = false;
+
+  ShardRegistryShard* shardP = regP->shardList;
+
+  while (shardP != NULL)
+  {
+    ShardRegistryShard* next = shardP->next;
+
+    for (int chunkIx = 0; chunkIx < regP->keyMax / regP->chunkSize; ++chunkIx)
+    {
+      free(shardP->chunkV[chunkIx]);
+    }
+
+    free(shardP->chunkV);
+    free(shardP);
+    shardP = next;
+  }
+
+  regP->shardList = NULL;
+
+  sem_post(&regP->sem);
+}
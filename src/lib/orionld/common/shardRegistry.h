@@ -0,0 +1,199 @@
+#ifndef SRC_LIB_ORIONLD_COMMON_SHARDREGISTRY_H_
+#define SRC_LIB_ORIONLD_COMMON_SHARDREGISTRY_H_
+
+/*
+*
+* Copyright 2021 FIWARE Foundation e.V.
+*
+* This file is part of Orion-LD Context Broker.
+*
+* Orion-LD Context Broker is free software: you can redistribute it and/or
+* modify it under the terms of the GNU Affero General Public License as
+* published by the Free Software Foundation, either version 3 of the
+* License, or (at your option) any later version.
+*
+* Orion-LD Context Broker is distributed in the hope that it will be useful,
+* but WITHOUT ANY WARRANTY; without even the implied warranty of
+* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU Affero
+* General Public License for more details.
+*
+* You should have received a copy of the GNU Affero General Public License
+* along with Orion-LD Context Broker. If not, see http://www.gnu.org/licenses/.
+*
+* For those usages not covered by this license please contact with
+* orionld at fiware dot org
+*
+* Author: Ken Zangelin
+*/
+#include <pthread.h>                                             // pthread_key_t
+#include <semaphore.h>                                           // sem_t
+
+
+
+// -----------------------------------------------------------------------------
+//
+// ShardRegistry - interned keys with per-thread counters (shards), for statistics on the hot path
+//
+// Keys (e.g. tenant + service path) are interned once, in a hash table, and get an index.
+// Each thread has a shard of its own, with one slot (slotSize bytes) per key, where it adds up its counters.
+// The slots of a shard are allocated in chunks of chunkSize keys, the first time the thread uses a key of the chunk.
+//
+// Looking up a key and writing the slot of the calling thread need no lock.
+// The semaphore only protects the creation of keys and shards.
+// Keys are never removed and never modified once published (not until shardRegistryRelease).
+//
+// The registry has no idea of what a key is - the user supplies three callbacks:
+//   match:    does the key data 'dataP' correspond to the probe 'probeP'?
+//   create:   create the key data for a probe (called under the semaphore, only for new keys) - NULL: the key is not interned
+//   release:  free the key data (shardRegistryRelease)
+//
+// Once keyMax keys exist, the registry is full - new keys are rejected right away, without taking the semaphore,
+// and a warning is logged once.
+//
+typedef bool  (*ShardRegistryMatch)(const void* dataP, const void* probeP);
+typedef void* (*ShardRegistryCreate)(const void* probeP);
+typedef void  (*ShardRegistryRelease)(void* dataP);
+
+
+
+// -----------------------------------------------------------------------------
+//
+// ShardRegistryKey -
+//
+typedef struct ShardRegistryKey
+{
+  void*                     dataP;     // Created by the 'create' callback
+  int                       ix;        // Index of the key in the slot arrays of the shards
+  struct ShardRegistryKey*  next;      // Next key in the same bucket
+} ShardRegistryKey;
+
+
+
+// -----------------------------------------------------------------------------
+//
+// ShardRegistryShard - the slots of one thread
+//
+// When a thread exits, its shard is freed for the next new thread to use, slots included
+// (they hold sums, it doesn't matter which thread continues adding to them).
+//
+typedef struct ShardRegistryShard
+{
+  char**                      chunkV;  // keyMax / chunkSize chunks, each of chunkSize * slotSize bytes
+  bool                        inUse;
+  struct ShardRegistryShard*  next;
+} ShardRegistryShard;
+
+
+
+// -----------------------------------------------------------------------------
+//
+// ShardRegistry -
+//
+typedef struct ShardRegistry
+{
+  const char*            name;         // For log messages
+  int                    keyMax;
+  int                    buckets;
+  int                    chunkSize;
+  int                    slotSize;
+  ShardRegistryMatch     match;
+  ShardRegistryCreate    create;
+  ShardRegistryRelease   release;
+
+  ShardRegistryKey**     keyTable;     // Hash table, 'buckets' buckets
+  ShardRegistryKey**     keyV;         // The keys, by index
+  int                    keys;
+  bool                   full;         // keyMax reached - set once, read without lock
+  ShardRegistryShard*    shardList;
+  pthread_key_t          shardKey;
+  sem_t                  sem;
+} ShardRegistry;
+
+
+
+// -----------------------------------------------------------------------------
+//
+// shardRegistryInit - to be called before any other function of the registry (keyMax must be a multiple of chunkSize)
+//
+extern bool shardRegistryInit
+(
+  ShardRegistry*        regP,
+  const char*           name,
+  int                   keyMax,
+  int                   buckets,
+  int                   chunkSize,
+  int                   slotSize,
+  ShardRegistryMatch    match,
+  ShardRegistryCreate   create,
+  ShardRegistryRelease  release
+);
+
+
+
+// -----------------------------------------------------------------------------
+//
+// shardRegistryKeyLookup - lock-free lookup of a key - returns its index, or -1 if not found
+//
+extern int shardRegistryKeyLookup(ShardRegistry* regP, const void* probeP, unsigned int hash);
+
+
+
+// -----------------------------------------------------------------------------
+//
+// shardRegistryKeyIntern - add a new key - returns its index, or -1 if the registry is full or 'create' returned NULL
+//
+extern int shardRegistryKeyIntern(ShardRegistry* regP, const void* probeP, unsigned int hash);
+
+
+
+// -----------------------------------------------------------------------------
+//
+// shardRegistryFull - lock-free check for a full registry (new keys would be rejected)
+//
+extern bool shardRegistryFull(ShardRegistry* regP);
+
+
+
+// -----------------------------------------------------------------------------
+//
+// shardRegistryKeys - number of keys (keys are published before the number is incremented)
+//
+extern int shardRegistryKeys(ShardRegistry* regP);
+
+
+
+// -----------------------------------------------------------------------------
+//
+// shardRegistryKeyData - the data of the key with index 'keyIx' (keyIx < shardRegistryKeys)
+//
+extern void* shardRegistryKeyData(ShardRegistry* regP, int keyIx);
+
+
+
+// -----------------------------------------------------------------------------
+//
+// shardRegistrySlot - the slot of the calling thread for a key (zeroed the first time) - NULL if out of memory
+//
+extern void* shardRegistrySlot(ShardRegistry* regP, int keyIx);
+
+
+
+// -----------------------------------------------------------------------------
+//
+// shardRegistrySlotForEach - call 'treat' for the slot of a key in each and every shard that has it
+//
+// The slots are being written by their threads - 'treat' must read them with atomic loads.
+//
+typedef void (*ShardRegistrySlotTreat)(const void* slotP, void* paramP);
+
+extern void shardRegistrySlotForEach(ShardRegistry* regP, int keyIx, ShardRegistrySlotTreat treat, void* paramP);
+
+
+
+// -----------------------------------------------------------------------------
+//
+// shardRegistryRelease - free all keys and shards (at exit - no thread may use the registry any longer)
+//
+extern void shardRegistryRelease(ShardRegistry* regP);
+
+#endif  // SRC_LIB_ORIONLD_COMMON_SHARDREGISTRY_H_
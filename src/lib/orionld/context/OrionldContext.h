@@ -72,13 +72,18 @@ typedef union OrionldContextInfo
 // The context is either an array of contexts or "the real thing" - a list of key-values in
 // a hash-list
 //
+// 'merged' is the core context and this context flattened into one name table and one value table,
+// with the precedence already resolved. It's built when the context is inserted in the context cache
+// (see orionldContextMergedTablesBuild) and stays NULL for contexts that aren't cached.
+//
 typedef struct OrionldContext
 {
-  char*               url;
-  char*               id;         // For contexts that were created by the broker itself
-  KjNode*             tree;
-  bool                keyValues;
-  OrionldContextInfo  context;
+  char*                     url;
+  char*                     id;         // For contexts that were created by the broker itself
+  KjNode*                   tree;
+  bool                      keyValues;
+  OrionldContextInfo        context;
+  OrionldContextHashTables  merged;
 } OrionldContext;
 
 #endif  // SRC_LIB_ORIONLD_CONTEXT_ORIONLDCONTEXT_H_
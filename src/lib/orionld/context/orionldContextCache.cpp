@@ -34,8 +34,11 @@
 //
 // Context Cache Internals
 //
-sem_t             orionldContextCacheSem;
-OrionldContext*   orionldContextCacheArray[100];  // When 100 is not enough, a realloc is done (automatically)
-OrionldContext**  orionldContextCache         = orionldContextCacheArray;
-int               orionldContextCacheSlots    = 100;
-int               orionldContextCacheSlotIx   = 0;
+sem_t                      orionldContextCacheSem;
+OrionldContext*            orionldContextCacheArray[100];
+OrionldContext**           orionldContextCache         = orionldContextCacheArray;
+int                        orionldContextCacheSlots    = 100;
+int                        orionldContextCacheSlotIx   = 0;
+OrionldContextCacheTable*  orionldContextCacheTable    = NULL;
+long long                  orionldContextCacheHits     = 0;
+long long                  orionldContextCacheMisses   = 0;
@@ -39,14 +39,65 @@
 
 
 
+// -----------------------------------------------------------------------------
+//
+// ORIONLD_CONTEXT_CACHE_TABLE_BUCKETS - initial number of buckets of the hash table of the context cache
+//
+// The number of buckets is doubled as soon as there are more keys than buckets in the table.
+//
+#define ORIONLD_CONTEXT_CACHE_TABLE_BUCKETS   256
+
+
+
+// -----------------------------------------------------------------------------
+//
+// OrionldContextCacheItem - one key (URL or broker generated id) of a context in the hash table of the context cache
+//
+typedef struct OrionldContextCacheItem
+{
+  const char*                      key;
+  OrionldContext*                  contextP;
+  struct OrionldContextCacheItem*  next;
+} OrionldContextCacheItem;
+
+
+
+// -----------------------------------------------------------------------------
+//
+// OrionldContextCacheTable - hash table of the context cache
+//
+typedef struct OrionldContextCacheTable
+{
+  unsigned int               buckets;    // Always a power of two
+  unsigned int               keys;       // Number of keys (URLs and ids) in the table
+  OrionldContextCacheItem**  bucketV;
+} OrionldContextCacheTable;
+
+
+
 // -----------------------------------------------------------------------------
 //
 // orionldContextCache
 //
-extern sem_t             orionldContextCacheSem;
-extern OrionldContext*   orionldContextCacheArray[100];  // When 100 is not enough, a realloc is done (automatically)
-extern OrionldContext**  orionldContextCache;
-extern int               orionldContextCacheSlots;
-extern int               orionldContextCacheSlotIx;
+// The contexts are kept in two structures:
+// - orionldContextCache:      all contexts, in insertion order (GET /ngsi-ld/ex/v1/contexts, release, ...)
+// - orionldContextCacheTable: hash table, keyed by both URL and broker generated id (orionldContextCacheLookup)
+//
+// Readers take no lock. Writers (orionldContextCacheInsert) are serialized by orionldContextCacheSem and
+// publish with atomic stores (release), that the readers pair with atomic loads (acquire):
+// - an item is fully initialized before it is linked in, as the first item of its bucket
+// - a grown hash table (or list) is built completely before it replaces the old one, and the old one is
+//   never freed, as readers may still be using it (nothing is ever removed from the context cache, so,
+//   retired tables and lists are the only memory that readers could be referencing)
+// - the context is stored in the list before the number of contexts (orionldContextCacheSlotIx) is incremented
+//
+extern sem_t                      orionldContextCacheSem;
+extern OrionldContext*            orionldContextCacheArray[100];  // Initial list - when 100 is not enough, a bigger list is allocated
+extern OrionldContext**           orionldContextCache;
+extern int                        orionldContextCacheSlots;
+extern int                        orionldContextCacheSlotIx;
+extern OrionldContextCacheTable*  orionldContextCacheTable;
+extern long long                  orionldContextCacheHits;
+extern long long                  orionldContextCacheMisses;
 
 #endif  // SRC_LIB_ORIONLD_CONTEXT_ORIONLDCONTEXTCACHE_H_
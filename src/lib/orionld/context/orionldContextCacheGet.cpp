@@ -46,9 +46,12 @@ extern "C"
 //
 KjNode* orionldContextCacheGet(KjNode* arrayP)
 {
-  for (int ix = 0; ix < orionldContextCacheSlotIx; ix++)
+  int               contexts = __atomic_load_n(&orionldContextCacheSlotIx, __ATOMIC_ACQUIRE);
+  OrionldContext**  cacheV   = __atomic_load_n(&orionldContextCache, __ATOMIC_ACQUIRE);
+
+  for (int ix = 0; ix < contexts; ix++)
   {
-    OrionldContext*  contextP         = orionldContextCacheArray[ix];
+    OrionldContext*  contextP         = cacheV[ix];
     KjNode*          contextObjP      = kjObject(orionldState.kjsonP, NULL);
     KjNode*          urlStringP       = kjString(orionldState.kjsonP, "url",  contextP->url);
     KjNode*          idStringP        = kjString(orionldState.kjsonP, "id",  (contextP->id == NULL)? "None" : contextP->id);
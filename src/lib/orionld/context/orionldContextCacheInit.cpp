@@ -40,6 +40,11 @@ void orionldContextCacheInit(void)
 {
   bzero(&orionldContextCacheArray, sizeof(orionldContextCacheArray));
 
+  orionldContextCache       = orionldContextCacheArray;
+  orionldContextCacheSlots  = sizeof(orionldContextCacheArray) / sizeof(orionldContextCacheArray[0]);
+  orionldContextCacheSlotIx = 0;
+  orionldContextCacheTable  = NULL;  // Created by the first call to orionldContextCacheInsert
+
   if (sem_init(&orionldContextCacheSem, 0, 1) == -1)
     LM_X(1, ("Runtime Error (error initializing semaphore for orionld context list; %s)", strerror(errno)));
 }
@@ -22,20 +22,119 @@
 *
 * Author: Ken Zangelin
 */
-#include <strings.h>                                             // bzero
-#include <string.h>                                              // memcpy
+#include <stdlib.h>                                              // calloc
+#include <string.h>                                              // memcpy, strcmp
 #include <semaphore.h>                                           // sem_wait, sem_post
 
 #include "logMsg/logMsg.h"                                       // LM_*
 #include "logMsg/traceLevels.h"                                  // Lmt*
 
-#include "orionld/common/orionldState.h"                         // kalloc, orionldState
 #include "orionld/context/OrionldContext.h"                      // OrionldContext
 #include "orionld/context/orionldContextCache.h"                 // Context Cache Internals
+#include "orionld/context/orionldContextCacheHash.h"             // orionldContextCacheHash
+#include "orionld/context/orionldContextMergedTablesBuild.h"     // orionldContextMergedTablesBuild
 #include "orionld/context/orionldContextCacheInsert.h"           // Own interface
 
 
 
+// -----------------------------------------------------------------------------
+//
+// tableCreate -
+//
+static OrionldContextCacheTable* tableCreate(unsigned int buckets)
+{
+  OrionldContextCacheTable* tableP = (OrionldContextCacheTable*) calloc(1, sizeof(OrionldContextCacheTable));
+
+  if (tableP != NULL)
+  {
+    tableP->buckets = buckets;
+    tableP->bucketV = (OrionldContextCacheItem**) calloc(buckets, sizeof(OrionldContextCacheItem*));
+
+    if (tableP->bucketV == NULL)
+    {
+      free(tableP);
+      tableP = NULL;
+    }
+  }
+
+  if (tableP == NULL)
+    LM_X(1, ("Out of memory (allocating a context cache hash table of %d buckets)", buckets));
+
+  return tableP;
+}
+
+
+
+// -----------------------------------------------------------------------------
+//
+// tableItemAdd - link a new item in, as the first item of its bucket (published with release semantics)
+//
+static void tableItemAdd(OrionldContextCacheTable* tableP, const char* key, OrionldContext* contextP)
+{
+  OrionldContextCacheItem*  itemP  = (OrionldContextCacheItem*) calloc(1, sizeof(OrionldContextCacheItem));
+  unsigned int              bucket = orionldContextCacheHash(key) & (tableP->buckets - 1);
+
+  if (itemP == NULL)
+    LM_X(1, ("Out of memory (allocating a context cache hash table item)"));
+
+  itemP->key      = key;
+  itemP->contextP = contextP;
+  itemP->next     = tableP->bucketV[bucket];
+
+  __atomic_store_n(&tableP->bucketV[bucket], itemP, __ATOMIC_RELEASE);
+  __atomic_add_fetch(&tableP->keys, 1, __ATOMIC_RELAXED);  // Read by orionldContextCacheStats
+}
+
+
+
+// -----------------------------------------------------------------------------
+//
+// tableGrow - create a table with twice as many buckets, with the same items, and publish it
+//
+// The old table is not freed - readers may still be using it
+//
+static OrionldContextCacheTable* tableGrow(OrionldContextCacheTable* oldTableP)
+{
+  OrionldContextCacheTable* tableP = tableCreate(oldTableP->buckets * 2);
+
+  for (unsigned int bucket = 0; bucket < oldTableP->buckets; bucket++)
+  {
+    for (OrionldContextCacheItem* itemP = oldTableP->bucketV[bucket]; itemP != NULL; itemP = itemP->next)
+    {
+      tableItemAdd(tableP, itemP->key, itemP->contextP);
+    }
+  }
+
+  __atomic_store_n(&orionldContextCacheTable, tableP, __ATOMIC_RELEASE);
+
+  return tableP;
+}
+
+
+
+// -----------------------------------------------------------------------------
+//
+// tableKeyAdd - add a key of a context to the hash table, unless the key is already there (the first context wins)
+//
+static void tableKeyAdd(const char* key, OrionldContext* contextP)
+{
+  OrionldContextCacheTable*  tableP = orionldContextCacheTable;  // Writers only modify the table under orionldContextCacheSem
+  unsigned int               bucket = orionldContextCacheHash(key) & (tableP->buckets - 1);
+
+  for (OrionldContextCacheItem* itemP = tableP->bucketV[bucket]; itemP != NULL; itemP = itemP->next)
+  {
+    if (strcmp(itemP->key, key) == 0)
+      return;
+  }
+
+  if (tableP->keys >= tableP->buckets)
+    tableP = tableGrow(tableP);
+
+  tableItemAdd(tableP, key, contextP);
+}
+
+
+
 // -----------------------------------------------------------------------------
 //
 // orionldContextCacheInsert -
@@ -48,28 +147,41 @@ void orionldContextCacheInsert(OrionldContext* contextP)
     return;
   }
 
+  orionldContextMergedTablesBuild(contextP);  // Before the context is published in the cache
+
   sem_wait(&orionldContextCacheSem);
 
   //
-  // Reallocation necessary?
+  // Reallocation of the list necessary?
   //
-
   if (orionldContextCacheSlotIx >= orionldContextCacheSlots)
   {
-    int   slotsToAdd   = 50;
-    int   addedSize    = slotsToAdd * sizeof(OrionldContext*);
-    int   newNoOfSlots = orionldContextCacheSlots + slotsToAdd;
-    char* newArray     = (char*) kaAlloc(&kalloc, sizeof(OrionldContext*) * newNoOfSlots);
+    int               newNoOfSlots = orionldContextCacheSlots * 2;
+    OrionldContext**  newList      = (OrionldContext**) calloc(newNoOfSlots, sizeof(OrionldContext*));
+
+    if (newList == NULL)
+      LM_X(1, ("Out of memory (allocating a context cache list of %d slots)", newNoOfSlots));
 
-    memcpy(newArray, (char*) orionldContextCache, sizeof(OrionldContext*) * orionldContextCacheSlots);
-    bzero(&newArray[sizeof(OrionldContext*) * orionldContextCacheSlots], addedSize);
+    memcpy(newList, orionldContextCache, sizeof(OrionldContext*) * orionldContextCacheSlots);
 
-    orionldContextCacheSlots += 50;
-    orionldContextCache = (OrionldContext**) newArray;
+    __atomic_store_n(&orionldContextCache, newList, __ATOMIC_RELEASE);  // The old list is not freed - readers may still be using it
+    orionldContextCacheSlots = newNoOfSlots;
   }
 
   orionldContextCache[orionldContextCacheSlotIx] = contextP;
-  ++orionldContextCacheSlotIx;
+  __atomic_store_n(&orionldContextCacheSlotIx, orionldContextCacheSlotIx + 1, __ATOMIC_RELEASE);
+
+  //
+  // The hash table - both the URL and the id of the context are keys
+  //
+  if (orionldContextCacheTable == NULL)
+    __atomic_store_n(&orionldContextCacheTable, tableCreate(ORIONLD_CONTEXT_CACHE_TABLE_BUCKETS), __ATOMIC_RELEASE);
+
+  if (contextP->url != NULL)
+    tableKeyAdd(contextP->url, contextP);
+
+  if (contextP->id != NULL)
+    tableKeyAdd(contextP->id, contextP);
 
   sem_post(&orionldContextCacheSem);
 }
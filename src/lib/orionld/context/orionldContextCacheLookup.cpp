@@ -29,6 +29,7 @@
 
 #include "orionld/context/OrionldContext.h"                      // OrionldContext
 #include "orionld/context/orionldContextCache.h"                 // Context Cache Internals
+#include "orionld/context/orionldContextCacheHash.h"             // orionldContextCacheHash
 #include "orionld/context/orionldContextCacheLookup.h"           // Own interface
 
 
@@ -37,16 +38,31 @@
 //
 // orionldContextCacheLookup -
 //
+// 'url' is either the URL of the context or the id that the broker has given it.
+//
+// Lock-free - see orionldContextCache.h for the rules the writers follow.
+//
 OrionldContext* orionldContextCacheLookup(const char* url)
 {
-  for (int ix = 0; ix < orionldContextCacheSlotIx; ix++)
+  OrionldContextCacheTable* tableP = __atomic_load_n(&orionldContextCacheTable, __ATOMIC_ACQUIRE);
+
+  if (tableP != NULL)
   {
-    if (strcmp(url, orionldContextCache[ix]->url) == 0)
-      return orionldContextCache[ix];
+    unsigned int              bucket = orionldContextCacheHash(url) & (tableP->buckets - 1);
+    OrionldContextCacheItem*  itemP  = __atomic_load_n(&tableP->bucketV[bucket], __ATOMIC_ACQUIRE);
+
+    while (itemP != NULL)
+    {
+      if (strcmp(url, itemP->key) == 0)
+      {
+        __atomic_add_fetch(&orionldContextCacheHits, 1, __ATOMIC_RELAXED);
+        return itemP->contextP;
+      }
 
-    if ((orionldContextCache[ix]->id != NULL) && (strcmp(url, orionldContextCache[ix]->id) == 0))
-      return orionldContextCache[ix];
+      itemP = itemP->next;
+    }
   }
 
+  __atomic_add_fetch(&orionldContextCacheMisses, 1, __ATOMIC_RELAXED);
   return NULL;
 }
@@ -0,0 +1,67 @@
+/*
+*
+* Copyright 2021 FIWARE Foundation e.V.
+*
+* This file is part of Orion-LD Context Broker.
+*
+* Orion-LD Context Broker is free software: you can redistribute it and/or
+* modify it under the terms of the GNU Affero General Public License as
+* published by the Free Software Foundation, either version 3 of the
+* License, or (at your option) any later version.
+*
+* Orion-LD Context Broker is distributed in the hope that it will be useful,
+* but WITHOUT ANY WARRANTY; without even the implied warranty of
+* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU Affero
+* General Public License for more details.
+*
+* You should have received a copy of the GNU Affero General Public License
+* along with Orion-LD Context Broker. If not, see http://www.gnu.org/licenses/.
+*
+* For those usages not covered by this license please contact with
+* orionld at fiware dot org
+*
+* Author: Ken Zangelin
+*/
+extern "C"
+{
+#include "kjson/KjNode.h"                                        // KjNode
+#include "kjson/kjBuilder.h"                                     // kjObject, kjInteger, kjChildAdd
+}
+
+#include "orionld/common/orionldState.h"                         // orionldState
+#include "orionld/context/orionldContextCache.h"                 // Context Cache Internals
+#include "orionld/context/orionldContextCacheStats.h"            // Own interface
+
+
+
+// -----------------------------------------------------------------------------
+//
+// orionldContextCacheStats -
+//
+// 'keys' is the number of keys in the hash table (URLs plus broker generated ids).
+// 'hits' and 'misses' count the calls to orionldContextCacheLookup.
+//
+KjNode* orionldContextCacheStats(void)
+{
+  KjNode*                    statsP   = kjObject(orionldState.kjsonP, "cache");
+  OrionldContextCacheTable*  tableP   = __atomic_load_n(&orionldContextCacheTable, __ATOMIC_ACQUIRE);
+  int                        contexts = __atomic_load_n(&orionldContextCacheSlotIx, __ATOMIC_ACQUIRE);
+  KjNode*                    nodeP;
+
+  nodeP = kjInteger(orionldState.kjsonP, "contexts", contexts);
+  kjChildAdd(statsP, nodeP);
+
+  nodeP = kjInteger(orionldState.kjsonP, "keys", (tableP != NULL)? tableP->keys : 0);
+  kjChildAdd(statsP, nodeP);
+
+  nodeP = kjInteger(orionldState.kjsonP, "buckets", (tableP != NULL)? tableP->buckets : 0);
+  kjChildAdd(statsP, nodeP);
+
+  nodeP = kjInteger(orionldState.kjsonP, "hits", __atomic_load_n(&orionldContextCacheHits, __ATOMIC_RELAXED));
+  kjChildAdd(statsP, nodeP);
+
+  nodeP = kjInteger(orionldState.kjsonP, "misses", __atomic_load_n(&orionldContextCacheMisses, __ATOMIC_RELAXED));
+  kjChildAdd(statsP, nodeP);
+
+  return statsP;
+}
@@ -53,5 +53,8 @@ OrionldContext* orionldContextCreate(const char* url, const char* id, KjNode* tr
   contextP->tree      = (toBeCloned == true)? kjClone(NULL, tree) : NULL;
   contextP->keyValues = keyValues;
 
+  contextP->merged.nameHashTable  = NULL;
+  contextP->merged.valueHashTable = NULL;
+
   return contextP;
 }
@@ -22,120 +22,193 @@
 *
 * Author: Ken Zangelin
 */
-#include <unistd.h>                                              // usleep
-#include <semaphore.h>                                           // sem_init, sem_wait, sem_post
+#include <string.h>                                              // strlen, strcmp, strncpy, strdup
+#include <strings.h>                                             // bzero
+#include <stdlib.h>                                              // calloc, free
+#include <time.h>                                                // clock_gettime, struct timespec
+#include <pthread.h>                                             // pthread_mutex_*, pthread_cond_*
+
+extern "C"
+{
+#include "kalloc/kaStrdup.h"                                     // kaStrdup
+}
 
 #include "logMsg/logMsg.h"                                       // LM_*
 #include "logMsg/traceLevels.h"                                  // Lmt*
 
-#include "orionld/common/orionldState.h"                         // orionldState
+#include "orionld/common/orionldState.h"                         // orionldState, contextDownloadAttempts, contextDownloadTimeout, contextDir
 #include "orionld/types/OrionldProblemDetails.h"                 // OrionldProblemDetails, orionldProblemDetailsFill
 #include "orionld/context/OrionldContext.h"                      // OrionldContext
 #include "orionld/context/orionldContextFromBuffer.h"            // orionldContextFromBuffer
 #include "orionld/context/orionldContextCacheLookup.h"           // orionldContextCacheLookup
+#include "orionld/context/orionldContextCacheHash.h"             // orionldContextCacheHash
 #include "orionld/context/orionldContextDownload.h"              // orionldContextDownload
-#include "orionld/context/orionldContextCacheInsert.h"           // orionldContextCacheInsert
+#include "orionld/context/orionldContextPersist.h"               // orionldContextPersist
 #include "orionld/context/orionldContextFromUrl.h"               // Own interface
 
 
-typedef struct StringListItem
+
+// -----------------------------------------------------------------------------
+//
+// CONTEXT_DOWNLOAD_BUCKETS - number of buckets in the hash table of ongoing downloads
+//
+// Only contexts that are being downloaded right now are in the table, so, it's never big.
+//
+#define CONTEXT_DOWNLOAD_BUCKETS 64
+
+
+
+// -----------------------------------------------------------------------------
+//
+// ContextDownload - a download in flight
+//
+// The thread that downloads the context (the "leader") creates the item and all other
+// threads that need the same context (the "waiters") wait on 'doneCond' for the leader to
+// finish. The outcome of the download, success or failure, is kept in the item, for the
+// waiters to pick up.
+//
+// The item is removed from the hash table as soon as the download is done (so that a failed
+// download can be retried by the next request) but it isn't freed until the last waiter has
+// picked up the outcome - that's what 'refs' is for.
+//
+// All fields are protected by contextDownloadMutex.
+//
+typedef struct ContextDownload
 {
-  char                    name[256];
-  struct StringListItem*  next;
-} StringListItem;
+  char*                    url;
+  bool                     done;
+  int                      refs;
+  pthread_cond_t           doneCond;
+  OrionldContext*          contextP;
+  OrionldResponseErrorType errorType;
+  int                      errorStatus;
+  char                     errorTitle[128];
+  char                     errorDetail[512];
+  struct ContextDownload*  next;
+} ContextDownload;
 
-static sem_t            contextDownloadListSem;
-static StringListItem*  contextDownloadList = NULL;
+static pthread_mutex_t   contextDownloadMutex;
+static ContextDownload*  contextDownloadTable[CONTEXT_DOWNLOAD_BUCKETS];
 
 
 
 // -----------------------------------------------------------------------------
 //
-// contextDownloadListInit - initiaize the 'context download list'
+// contextDownloadListInit - initialize the table of ongoing context downloads
 //
 void contextDownloadListInit(void)
 {
-  sem_init(&contextDownloadListSem, 0, 1);  // 0: shared between threads of the same process. 1: free to be taken
-  contextDownloadList = NULL;
+  pthread_mutex_init(&contextDownloadMutex, NULL);
+  bzero(contextDownloadTable, sizeof(contextDownloadTable));
 }
 
 
 
 // -----------------------------------------------------------------------------
 //
-// contextDownloadListLookup - lookup a URL in the list and report if found or not
+// contextDownloadFree -
 //
-bool contextDownloadListLookup(const char* url)
+static void contextDownloadFree(ContextDownload* dlP)
 {
-  StringListItem* itemP = contextDownloadList;
+  pthread_cond_destroy(&dlP->doneCond);
+  free(dlP->url);
+  free(dlP);
+}
+
+
 
-  while (itemP != NULL)
+// -----------------------------------------------------------------------------
+//
+// contextDownloadListRelease - release all items in the table of ongoing context downloads
+//
+// The list is self-cleaning and this function isn't really necessary - except perhaps
+// if the broker is killed while serving requests, e.g. while running tests.
+//
+// This function is ONLY called from the main exit-function, to avoid leaks for valgrind tests.
+//
+void contextDownloadListRelease(void)
+{
+  for (int ix = 0; ix < CONTEXT_DOWNLOAD_BUCKETS; ix++)
   {
-    if (strcmp(itemP->name, url) == 0)
-      return true;
+    ContextDownload* dlP = contextDownloadTable[ix];
+
+    while (dlP != NULL)
+    {
+      ContextDownload* next = dlP->next;
+
+      contextDownloadFree(dlP);
+      dlP = next;
+    }
 
-    itemP = itemP->next;
+    contextDownloadTable[ix] = NULL;
   }
+}
+
+
 
-  return false;
+// -----------------------------------------------------------------------------
+//
+// contextDownloadLookup - lookup a URL in the table of ongoing downloads
+//
+// contextDownloadMutex must be taken by the caller
+//
+static ContextDownload* contextDownloadLookup(const char* url, unsigned int bucket)
+{
+  for (ContextDownload* dlP = contextDownloadTable[bucket]; dlP != NULL; dlP = dlP->next)
+  {
+    if (strcmp(dlP->url, url) == 0)
+      return dlP;
+  }
+
+  return NULL;
 }
 
 
 
 // -----------------------------------------------------------------------------
 //
-// contextDownloadListAdd - add a URL to the list
+// contextDownloadAdd - add a URL to the table of ongoing downloads
 //
-void contextDownloadListAdd(const char* url)
+// contextDownloadMutex must be taken by the caller
+//
+static ContextDownload* contextDownloadAdd(const char* url, unsigned int bucket)
 {
-  StringListItem* itemP = (StringListItem*) malloc(sizeof(StringListItem));
+  ContextDownload* dlP = (ContextDownload*) calloc(1, sizeof(ContextDownload));
+
+  dlP->url  = strdup(url);
+  dlP->refs = 1;  // The leader
+  pthread_cond_init(&dlP->doneCond, NULL);
+
+  dlP->next = contextDownloadTable[bucket];
+  contextDownloadTable[bucket] = dlP;
 
-  strncpy(itemP->name, url, sizeof(itemP->name));
-  itemP->next = contextDownloadList;
-  contextDownloadList = itemP;
+  return dlP;
 }
 
 
 
 // -----------------------------------------------------------------------------
 //
-// contextDownloadListRemove - remove a URL from the list
+// contextDownloadRemove - remove a download from the table of ongoing downloads
 //
-void contextDownloadListRemove(const char* url)
+// contextDownloadMutex must be taken by the caller
+//
+static void contextDownloadRemove(ContextDownload* dlP, unsigned int bucket)
 {
-  StringListItem* iterP = contextDownloadList;
-  StringListItem* prevP = NULL;
-  StringListItem* itemP = NULL;
+  ContextDownload* prevP = NULL;
 
-  while (iterP != NULL)
+  for (ContextDownload* iterP = contextDownloadTable[bucket]; iterP != NULL; iterP = iterP->next)
   {
-    if (strcmp(iterP->name, url) == 0)
+    if (iterP == dlP)
     {
-      itemP = iterP;
-      break;
+      if (prevP == NULL)
+        contextDownloadTable[bucket] = dlP->next;
+      else
+        prevP->next = dlP->next;
+      return;
     }
 
     prevP = iterP;
-    iterP = iterP->next;
-  }
-
-  if (itemP == NULL)  // Not found!
-    return;
-
-  if (prevP == NULL)  // Found as the first item of the list
-  {
-    contextDownloadList = itemP->next;
-    free(itemP);
-  }
-  else if (itemP->next == NULL)  // Found as the last item of the list
-  {
-    prevP->next = NULL;
-    free(itemP);
-  }
-  else  // Found in the middle of the list
-  {
-    prevP->next = itemP->next;
-    free(itemP);
   }
 }
 
@@ -143,57 +216,88 @@ void contextDownloadListRemove(const char* url)
 
 // -----------------------------------------------------------------------------
 //
-// contextDownloadListRelease - release all items in the 'context download cache'
+// contextDownloadWait - wait for the leader to finish the download and pick up its outcome
 //
-// The cache is self-cleaning and this function isn't really necessary - except perhaps
-// if the broker is killed while serving requests, e.g. while running tests.
+// contextDownloadMutex must be taken by the caller - it is released by this function.
 //
-// This function is ONLY called from the main exit-function, to avoid leaks for valgrind tests.
+// The leader has its own timeouts (contextDownloadTimeout times contextDownloadAttempts) and the
+// wait should never time out - the deadline is just a safety net.
 //
-void contextDownloadListRelease(void)
+static OrionldContext* contextDownloadWait(ContextDownload* dlP, OrionldProblemDetails* pdP)
 {
-  StringListItem* iterP = contextDownloadList;
+  struct timespec deadline;
+  long long       waitMs = (long long) contextDownloadTimeout * ((contextDownloadAttempts > 0)? contextDownloadAttempts : 1) + 1000;
+  int             rc     = 0;
+
+  clock_gettime(CLOCK_REALTIME, &deadline);
+  deadline.tv_sec  += waitMs / 1000;
+  deadline.tv_nsec += (waitMs % 1000) * 1000000;
+  if (deadline.tv_nsec >= 1000000000)
+  {
+    deadline.tv_sec  += 1;
+    deadline.tv_nsec -= 1000000000;
+  }
+
+  ++dlP->refs;
+  while ((dlP->done == false) && (rc == 0))
+    rc = pthread_cond_timedwait(&dlP->doneCond, &contextDownloadMutex, &deadline);
+
+  OrionldContext* contextP = NULL;
 
-  while (iterP != NULL)
+  if (dlP->done == false)
   {
-    StringListItem* current = iterP;
-    iterP = iterP->next;
-    free(current);
+    pdP->type   = OrionldLdContextNotAvailable;
+    pdP->title  = (char*) "Unable to download context";
+    pdP->detail = kaStrdup(&orionldState.kalloc, dlP->url);
+    pdP->status = 503;
   }
+  else if (dlP->contextP == NULL)
+  {
+    // The download failed - same error for all waiters
+    pdP->type   = dlP->errorType;
+    pdP->title  = kaStrdup(&orionldState.kalloc, dlP->errorTitle);
+    pdP->detail = kaStrdup(&orionldState.kalloc, dlP->errorDetail);
+    pdP->status = dlP->errorStatus;
+  }
+  else
+    contextP = dlP->contextP;
+
+  if (--dlP->refs == 0)
+    contextDownloadFree(dlP);
+
+  pthread_mutex_unlock(&contextDownloadMutex);
+
+  return contextP;
 }
 
 
 
 // -----------------------------------------------------------------------------
 //
-// contextCacheWait -
+// contextDownloadDone - the leader publishes the outcome of the download and wakes up the waiters
 //
-static OrionldContext* contextCacheWait(char* url, OrionldProblemDetails* pdP)
+static void contextDownloadDone(ContextDownload* dlP, unsigned int bucket, OrionldContext* contextP, OrionldProblemDetails* pdP)
 {
-  int             sleepTime = 0;
-  OrionldContext* contextP;
+  pthread_mutex_lock(&contextDownloadMutex);
+
+  dlP->done     = true;
+  dlP->contextP = contextP;
 
-  // LM_TMP(("CLIST: Request %d: Waiting for context '%s'", orionldState.requestNo, url));
-  while (sleepTime < 3000000)  // 3 secs - 3 million microsecs ... CLI param?
+  if (contextP == NULL)
   {
-    usleep(20000);  // sleep 20 millisecs ... CLI param?
-    contextP = orionldContextCacheLookup(url);
-    if (contextP != NULL)
-    {
-      // LM_TMP(("CLIST: Request %d: Got context '%s'", orionldState.requestNo, url));
-      return contextP;
-    }
-    sleepTime += 20000;
-    // LM_TMP(("CLIST: Request %d: Still waiting for context '%s'", orionldState.requestNo, url));
+    dlP->errorType   = pdP->type;
+    dlP->errorStatus = pdP->status;
+    strncpy(dlP->errorTitle,  (pdP->title  != NULL)? pdP->title  : "", sizeof(dlP->errorTitle) - 1);
+    strncpy(dlP->errorDetail, (pdP->detail != NULL)? pdP->detail : "", sizeof(dlP->errorDetail) - 1);
   }
 
-  // The wait timed out
-  pdP->status     = 400;  // Assuming the URL is invalid, this a "400 Bad Request"
-  pdP->title      = (char*) "Assumed Bad Request";
-  pdP->detail     = (char*) "Unable to download context";
+  contextDownloadRemove(dlP, bucket);
+  pthread_cond_broadcast(&dlP->doneCond);
 
-  // LM_TMP(("CLIST: Request %d: Failure for context '%s'", orionldState.requestNo, url));
-  return NULL;
+  if (--dlP->refs == 0)
+    contextDownloadFree(dlP);
+
+  pthread_mutex_unlock(&contextDownloadMutex);
 }
 
 
@@ -202,6 +306,12 @@ static OrionldContext* contextCacheWait(char* url, OrionldProblemDetails* pdP)
 //
 // orionldContextFromUrl -
 //
+// Single-flight download of contexts:
+//   Only one thread (the leader) downloads any given URL.
+//   All other threads that need the same context while it is being downloaded wait on a condition
+//   variable and are woken up the moment the download is done, getting the same result - the context,
+//   or, the same error if the download failed.
+//
 OrionldContext* orionldContextFromUrl(char* url, OrionldProblemDetails* pdP)
 {
   OrionldContext* contextP = orionldContextCacheLookup(url);
@@ -209,68 +319,28 @@ OrionldContext* orionldContextFromUrl(char* url, OrionldProblemDetails* pdP)
   if (contextP != NULL)
     return contextP;
 
-  //
-  // Make sure the context isn't already being downloaded
-  //
-  // Three possibilities:
-  // CASE 1. No one is trying to download the context, so:
-  //         - mark the URL to be downloading - for the next to know
-  //         - download it and add it to the context cache
-  //         - remove the mark from step 1
-  // CASE 2. No one was trying to download the context, so I tried to take the semaphore.
-  //         However, another thread got the semaphore before me and started the download
-  //         In this case, I will NOT try to download (somebody else is already doing that).
-  //         Instead, I will wait for that download to finish and then lookup the context from the cache
-  //
-  // CASE 3. Someone was actually downloading the context when I wanted to do the same.
-  //         Just like step 2 - I wait for the download to complete and then lookup the context from the cache.
-  //
-  bool urlDownloading = contextDownloadListLookup(url);
-  if (urlDownloading == false)
-  {
-    // LM_TMP(("CLIST: Request %d: context '%s' is not downloading (before taking list semaphore)", orionldState.requestNo, url));
-
-    //
-    // Not there, so, we'll download it
-    // First take the 'download semaphore'
-    //
-    sem_wait(&contextDownloadListSem);
-
-    //
-    // OK - got the semaphore - but, did I have to wait?
-    // I must look the context up again, to be sure (in the 'contextDownloadList')
-    //
-    // If the URL is in 'contextDownloadList' then somebody else took the semaphore before me
-    // and started downloading.
-    //
-    urlDownloading = contextDownloadListLookup(url);
-    if (urlDownloading == false)
-    {
-      // LM_TMP(("CLIST: Request %d: context '%s' is not downloading (after taking list semaphore)", orionldState.requestNo, url));
-      contextDownloadListAdd(url);  // CASE 1: Mark the URL as being downloading
-    }
-    // else
-    //   LM_TMP(("CLIST: Request %d: context '%s' IS DOWNLOADING (after taking list semaphore)", orionldState.requestNo, url));
+  unsigned int bucket = orionldContextCacheHash(url) % CONTEXT_DOWNLOAD_BUCKETS;
 
-    sem_post(&contextDownloadListSem);
+  pthread_mutex_lock(&contextDownloadMutex);
 
-    if (urlDownloading == true)  // Somebody took the semaphore before me and is downloading the context - I'll wait
-    {
-      // LM_TMP(("CLIST: Request %d: context '%s' IS DOWNLOADING (after taking list semaphore) - let's wait for it", orionldState.requestNo, url));
-      return contextCacheWait(url, pdP);  // CASE 2 - another thread has downloaded the context
-    }
+  ContextDownload* dlP = contextDownloadLookup(url, bucket);
 
-    // LM_TMP(("CLIST: Request %d: context '%s' is NOT downloading (after taking list semaphore) - let's download it !", orionldState.requestNo, url));
-    // CASE 1 - the context will be downloaded
-  }
-  else
-  {
-    // LM_TMP(("CLIST: Request %d: context '%s' is downloading (before taking list semaphore) - let's wait for it II", orionldState.requestNo, url));
+  if (dlP != NULL)
+    return contextDownloadWait(dlP, pdP);  // Unlocks the mutex
 
-    return contextCacheWait(url, pdP);  // CASE 3 - another thread has downloaded the context
+  //
+  // Not being downloaded right now - but, the download might have finished between the cache lookup and
+  // taking the mutex (the leader inserts in the context cache before removing the download from the table)
+  //
+  contextP = orionldContextCacheLookup(url);
+  if (contextP != NULL)
+  {
+    pthread_mutex_unlock(&contextDownloadMutex);
+    return contextP;
   }
 
-  // LM_TMP(("CLIST: Request %d: context '%s': starting download", orionldState.requestNo, url));
+  dlP = contextDownloadAdd(url, bucket);
+  pthread_mutex_unlock(&contextDownloadMutex);
 
   char* buffer = orionldContextDownload(url, pdP);
 
@@ -278,18 +348,25 @@ OrionldContext* orionldContextFromUrl(char* url, OrionldProblemDetails* pdP)
   {
     // orionldContextDownload fills in pdP
     LM_W(("Bad Input? (%s: %s)", pdP->title, pdP->detail));
+    contextDownloadDone(dlP, bucket, NULL, pdP);
     return NULL;
   }
 
+  //
+  // The buffer is destroyed by the parse - if the context is to be persisted, a copy is needed
+  //
+  char* json = (contextDir[0] != 0)? strdup(buffer) : NULL;
+
   contextP = orionldContextFromBuffer(url, buffer, pdP);
 
-  // Remove the 'url' from the contextDownloadList
+  if (json != NULL)
+  {
+    if (contextP != NULL)
+      orionldContextPersist(url, json, orionldState.httpResponse.etag, orionldState.httpResponse.lastModified);
+    free(json);
+  }
 
-  // LM_TMP(("CLIST: Request %d: context '%s': finished download - removing the item from the download list", orionldState.requestNo, url));
-  sem_wait(&contextDownloadListSem);
-  contextDownloadListRemove(url);
-  sem_post(&contextDownloadListSem);
-  // LM_TMP(("CLIST: Request %d: context '%s': finished download - removed the item from the download list", orionldState.requestNo, url));
+  contextDownloadDone(dlP, bucket, contextP, pdP);
 
   return contextP;
 }
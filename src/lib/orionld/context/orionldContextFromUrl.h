@@ -30,6 +30,22 @@
 
 
 
+// -----------------------------------------------------------------------------
+//
+// contextDownloadListInit - initialize the table of ongoing context downloads
+//
+extern void contextDownloadListInit(void);
+
+
+
+// -----------------------------------------------------------------------------
+//
+// contextDownloadListRelease - release all items in the table of ongoing context downloads
+//
+extern void contextDownloadListRelease(void);
+
+
+
 // -----------------------------------------------------------------------------
 //
 // orionldContextFromUrl -
@@ -33,15 +33,20 @@
 #include "logMsg/logMsg.h"                                       // LM_*
 #include "logMsg/traceLevels.h"                                  // Lmt*
 
+#include "orionld/common/orionldState.h"                         // contextDir, contextRevalidate
 #include "orionld/types/OrionldProblemDetails.h"                 // OrionldProblemDetails, orionldProblemDetailsFill
 #include "orionld/context/OrionldContext.h"                      // OrionldContext
 #include "orionld/context/OrionldContextItem.h"                  // OrionldContextItem
 #include "orionld/context/orionldCoreContext.h"                  // ORIONLD_CORE_CONTEXT_URL
 #include "orionld/context/orionldContextCacheInit.h"             // orionldContextCacheInit
+#include "orionld/context/orionldContextCache.h"                 // orionldContextCache, orionldContextCacheSlotIx
 #include "orionld/context/orionldContextCacheInsert.h"           // orionldContextCacheInsert
 #include "orionld/context/orionldContextFromBuffer.h"            // orionldContextFromBuffer
 #include "orionld/context/orionldContextFromUrl.h"               // orionldContextFromUrl
 #include "orionld/context/orionldContextItemLookup.h"            // orionldContextItemLookup
+#include "orionld/context/orionldContextMergedTablesBuild.h"     // orionldContextMergedTablesBuild
+#include "orionld/context/orionldContextPersistLoad.h"           // orionldContextPersistLoad
+#include "orionld/context/orionldContextPersistRevalidate.h"     // orionldContextPersistRevalidate
 #include "orionld/context/orionldContextInit.h"                  // Own interface
 
 
@@ -258,6 +263,17 @@ bool orionldContextInit(OrionldProblemDetails* pdP)
   LM_TMP(("ORIONLD_CACHED_CONTEXT_DIRECTORY == '%s'", cacheContextDir));  // #if DEBUG
 #endif
 
+  //
+  // Warm startup - the contexts that were downloaded before the restart are loaded from the context directory (-ctxDir)
+  //
+  if (contextDir[0] != 0)
+  {
+    orionldContextPersistLoad(contextDir);
+
+    if (orionldCoreContextP != NULL)
+      gotCoreContext = true;
+  }
+
   if (gotCoreContext == false)
   {
     orionldCoreContextP = orionldContextFromUrl(ORIONLD_CORE_CONTEXT_URL, pdP);
@@ -278,5 +294,15 @@ bool orionldContextInit(OrionldProblemDetails* pdP)
 
   orionldDefaultUrlLen = strlen(orionldDefaultUrl);
 
+  //
+  // Contexts that were inserted in the cache before the core context was known (preloaded/persisted contexts)
+  // don't have their merged tables yet
+  //
+  for (int ix = 0; ix < orionldContextCacheSlotIx; ix++)
+    orionldContextMergedTablesBuild(orionldContextCache[ix]);
+
+  if (contextRevalidate == true)
+    orionldContextPersistRevalidate();
+
   return true;
 }
@@ -24,6 +24,11 @@
 */
 #include <unistd.h>                                              // NULL
 
+extern "C"
+{
+#include "khash/khash.h"                                         // KHashTable, khashItemLookup
+}
+
 #include "logMsg/logMsg.h"                                       // LM_*
 #include "logMsg/traceLevels.h"                                  // Lmt*
 
@@ -61,12 +66,25 @@ char* orionldContextItemAliasLookup
   if (strncmp(longName, orionldDefaultUrl, orionldDefaultUrlLen) == 0)
     return (char*) &longName[orionldDefaultUrlLen];
 
-  // 2. Found in Core Context?
-  contextItemP = orionldContextItemValueLookup(orionldCoreContextP, longName);
+  KHashTable* mergedP = NULL;
 
-  // 3. If not, look in the provided context, unless it's the Core Context
-  if ((contextItemP == NULL) && (contextP != orionldCoreContextP))
-    contextItemP = orionldContextItemValueLookup(contextP, longName);
+  if ((contextP != NULL) && (contextP != orionldCoreContextP))
+    mergedP = __atomic_load_n(&contextP->merged.nameHashTable, __ATOMIC_ACQUIRE);
+
+  if (mergedP != NULL)
+  {
+    // 2+3. Cached context - one single lookup in the merged value table (core context + provided context)
+    contextItemP = (OrionldContextItem*) khashItemLookup(contextP->merged.valueHashTable, longName);
+  }
+  else
+  {
+    // 2. Found in Core Context?
+    contextItemP = orionldContextItemValueLookup(orionldCoreContextP, longName);
+
+    // 3. If not, look in the provided context, unless it's the Core Context
+    if ((contextItemP == NULL) && (contextP != orionldCoreContextP))
+      contextItemP = orionldContextItemValueLookup(contextP, longName);
+  }
 
   // 4. If not found anywhere - return the long name
   if (contextItemP == NULL)
@@ -24,6 +24,12 @@
 */
 #include <string.h>                                              // strchr
 
+extern "C"
+{
+#include "kalloc/kaAlloc.h"                                      // kaAlloc
+#include "khash/khash.h"                                         // KHashTable, khashItemLookup
+}
+
 #include "logMsg/logMsg.h"                                       // LM_*
 #include "logMsg/traceLevels.h"                                  // Lmt*
 
@@ -74,12 +80,25 @@ char* orionldContextItemExpand
   if ((colonP = strchr((char*) shortName, ':')) != NULL)
     return orionldContextPrefixExpand(contextP, shortName, colonP);
 
-  // 1. Lookup in Core Context
-  contextItemP = orionldContextItemLookup(orionldCoreContextP, shortName, NULL);
+  KHashTable* mergedP = NULL;
 
-  // 2. Lookup in given context (unless it's the Core Context)
-  if ((contextItemP == NULL) && (contextP != orionldCoreContextP))
-    contextItemP = orionldContextItemLookup(contextP, shortName, NULL);
+  if (contextP != orionldCoreContextP)
+    mergedP = __atomic_load_n(&contextP->merged.nameHashTable, __ATOMIC_ACQUIRE);
+
+  if (mergedP != NULL)
+  {
+    // 1+2. Cached context - one single lookup in the merged table (core context + given context)
+    contextItemP = (OrionldContextItem*) khashItemLookup(mergedP, shortName);
+  }
+  else
+  {
+    // 1. Lookup in Core Context
+    contextItemP = orionldContextItemLookup(orionldCoreContextP, shortName, NULL);
+
+    // 2. Lookup in given context (unless it's the Core Context)
+    if ((contextItemP == NULL) && (contextP != orionldCoreContextP))
+      contextItemP = orionldContextItemLookup(contextP, shortName, NULL);
+  }
 
   // 3. Use the Default URL (or not!)
   if (contextItemP == NULL)
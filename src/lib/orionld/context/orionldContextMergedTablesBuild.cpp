@@ -0,0 +1,147 @@
+/*
+*
+* Copyright 2021 FIWARE Foundation e.V.
+*
+* This file is part of Orion-LD Context Broker.
+*
+* Orion-LD Context Broker is free software: you can redistribute it and/or
+* modify it under the terms of the GNU Affero General Public License as
+* published by the Free Software Foundation, either version 3 of the
+* License, or (at your option) any later version.
+*
+* Orion-LD Context Broker is distributed in the hope that it will be useful,
+* but WITHOUT ANY WARRANTY; without even the implied warranty of
+* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU Affero
+* General Public License for more details.
+*
+* You should have received a copy of the GNU Affero General Public License
+* along with Orion-LD Context Broker. If not, see http://www.gnu.org/licenses/.
+*
+* For those usages not covered by this license please contact with
+* orionld at fiware dot org
+*
+* Author: Ken Zangelin
+*/
+#include <string.h>                                              // strcmp
+
+extern "C"
+{
+#include "khash/khash.h"                                         // KHashTable, KHashListItem, khashTableCreate, khashItemAdd, khashItemLookup
+}
+
+#include "logMsg/logMsg.h"                                       // LM_*
+#include "logMsg/traceLevels.h"                                  // Lmt*
+
+#include "orionld/common/orionldState.h"                         // kalloc
+#include "orionld/context/OrionldContext.h"                      // OrionldContext
+#include "orionld/context/OrionldContextItem.h"                  // OrionldContextItem
+#include "orionld/context/orionldCoreContext.h"                  // orionldCoreContextP
+#include "orionld/context/orionldContextCache.h"                 // ORIONLD_CONTEXT_CACHE_HASH_ARRAY_SIZE
+#include "orionld/context/orionldContextCacheHash.h"             // orionldContextCacheHash
+#include "orionld/context/orionldContextMergedTablesBuild.h"     // Own interface
+
+
+
+// -----------------------------------------------------------------------------
+//
+// nameCompare -
+//
+static int nameCompare(const char* name, void* itemP)
+{
+  return strcmp(name, ((OrionldContextItem*) itemP)->name);
+}
+
+
+
+// -----------------------------------------------------------------------------
+//
+// valueCompare -
+//
+static int valueCompare(const char* longName, void* itemP)
+{
+  return strcmp(longName, ((OrionldContextItem*) itemP)->id);
+}
+
+
+
+// -----------------------------------------------------------------------------
+//
+// tableMerge - add the items of 'fromP' that aren't already in 'toP'
+//
+// For duplicated keys inside 'fromP', the item that a lookup in 'fromP' finds is the one that is added,
+// so the result is exactly what a lookup in 'fromP' would give.
+//
+static void tableMerge(KHashTable* toP, KHashTable* fromP, bool names)
+{
+  for (unsigned int slot = 0; slot < ORIONLD_CONTEXT_CACHE_HASH_ARRAY_SIZE; ++slot)
+  {
+    for (KHashListItem* listItemP = fromP->array[slot]; listItemP != NULL; listItemP = listItemP->next)
+    {
+      OrionldContextItem* itemP = (OrionldContextItem*) listItemP->data;
+      const char*         key   = (names == true)? itemP->name : itemP->id;
+
+      if (khashItemLookup(toP, key) != NULL)
+        continue;
+
+      khashItemAdd(toP, key, khashItemLookup(fromP, key));
+    }
+  }
+}
+
+
+
+// -----------------------------------------------------------------------------
+//
+// contextMerge - merge a context (recursively, for arrays) into 'mergedP'
+//
+static void contextMerge(OrionldContextHashTables* mergedP, OrionldContext* contextP)
+{
+  if (contextP == NULL)
+    return;
+
+  if (contextP->keyValues == true)
+  {
+    tableMerge(mergedP->nameHashTable,  contextP->context.hash.nameHashTable,  true);
+    tableMerge(mergedP->valueHashTable, contextP->context.hash.valueHashTable, false);
+  }
+  else
+  {
+    for (int ix = 0; ix < contextP->context.array.items; ++ix)
+      contextMerge(mergedP, contextP->context.array.vector[ix]);
+  }
+}
+
+
+
+// -----------------------------------------------------------------------------
+//
+// orionldContextMergedTablesBuild -
+//
+void orionldContextMergedTablesBuild(OrionldContext* contextP)
+{
+  if ((contextP == NULL) || (contextP->merged.nameHashTable != NULL))  // Already done
+    return;
+
+  if ((orionldCoreContextP == NULL) || (contextP == orionldCoreContextP))  // The core context is looked up directly
+    return;
+
+  OrionldContextHashTables merged;
+
+  merged.nameHashTable  = khashTableCreate(&kalloc, orionldContextCacheHash, nameCompare,  ORIONLD_CONTEXT_CACHE_HASH_ARRAY_SIZE);
+  merged.valueHashTable = khashTableCreate(&kalloc, orionldContextCacheHash, valueCompare, ORIONLD_CONTEXT_CACHE_HASH_ARRAY_SIZE);
+
+  if ((merged.nameHashTable == NULL) || (merged.valueHashTable == NULL))
+  {
+    LM_E(("khashTableCreate failed - the context '%s' will be looked up member by member", contextP->url));
+    return;
+  }
+
+  contextMerge(&merged, orionldCoreContextP);
+  contextMerge(&merged, contextP);
+
+  //
+  // The value table first - readers check the name table to know whether the merged tables are there
+  //
+  contextP->merged.valueHashTable = merged.valueHashTable;
+  __atomic_store_n(&contextP->merged.nameHashTable, merged.nameHashTable, __ATOMIC_RELEASE);
+}
@@ -0,0 +1,49 @@
+#ifndef SRC_LIB_ORIONLD_CONTEXT_ORIONLDCONTEXTMERGEDTABLESBUILD_H_
+#define SRC_LIB_ORIONLD_CONTEXT_ORIONLDCONTEXTMERGEDTABLESBUILD_H_
+
+/*
+*
+* Copyright 2021 FIWARE Foundation e.V.
+*
+* This file is part of Orion-LD Context Broker.
+*
+* Orion-LD Context Broker is free software: you can redistribute it and/or
+* modify it under the terms of the GNU Affero General Public License as
+* published by the Free Software Foundation, either version 3 of the
+* License, or (at your option) any later version.
+*
+* Orion-LD Context Broker is distributed in the hope that it will be useful,
+* but WITHOUT ANY WARRANTY; without even the implied warranty of
+* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU Affero
+* General Public License for more details.
+*
+* You should have received a copy of the GNU Affero General Public License
+* along with Orion-LD Context Broker. If not, see http://www.gnu.org/licenses/.
+*
+* For those usages not covered by this license please contact with
+* orionld at fiware dot org
+*
+* Author: Ken Zangelin
+*/
+#include "orionld/context/OrionldContext.h"                      // OrionldContext
+
+
+
+// -----------------------------------------------------------------------------
+//
+// orionldContextMergedTablesBuild - flatten a context and the core context into one name table and one value table
+//
+// The term definitions of the core context and of all the member contexts of an array context are merged
+// into contextP->merged, with the precedence already resolved:
+//   1. the core context
+//   2. the member contexts, in the order of the array (depth first for nested arrays)
+//
+// The first definition found wins, just like the lookups in orionldContextItemExpand and
+// orionldContextItemAliasLookup always did - expansion and compaction become a single hash lookup.
+//
+// Done once, when the context is inserted in the context cache (contexts that are created
+// before the core context is known get their merged tables at the end of orionldContextInit).
+//
+extern void orionldContextMergedTablesBuild(OrionldContext* contextP);
+
+#endif  // SRC_LIB_ORIONLD_CONTEXT_ORIONLDCONTEXTMERGEDTABLESBUILD_H_
@@ -0,0 +1,107 @@
+/*
+*
+* Copyright 2021 FIWARE Foundation e.V.
+*
+* This file is part of Orion-LD Context Broker.
+*
+* Orion-LD Context Broker is free software: you can redistribute it and/or
+* modify it under the terms of the GNU Affero General Public License as
+* published by the Free Software Foundation, either version 3 of the
+* License, or (at your option) any later version.
+*
+* Orion-LD Context Broker is distributed in the hope that it will be useful,
+* but WITHOUT ANY WARRANTY; without even the implied warranty of
+* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU Affero
+* General Public License for more details.
+*
+* You should have received a copy of the GNU Affero General Public License
+* along with Orion-LD Context Broker. If not, see http://www.gnu.org/licenses/.
+*
+* For those usages not covered by this license please contact with
+* orionld at fiware dot org
+*
+* Author: Ken Zangelin
+*/
+#include <stdio.h>                                               // snprintf, rename
+#include <stdlib.h>                                              // mkstemp
+#include <string.h>                                              // strlen, strerror
+#include <errno.h>                                               // errno
+#include <unistd.h>                                              // write, close, unlink
+#include <sys/stat.h>                                            // fchmod
+
+#include "logMsg/logMsg.h"                                       // LM_*
+#include "logMsg/traceLevels.h"                                  // Lmt*
+
+#include "orionld/common/orionldState.h"                         // contextDir
+#include "orionld/context/orionldContextCacheHash.h"             // orionldContextCacheHash
+#include "orionld/context/orionldContextPersist.h"               // Own interface
+
+
+
+// -----------------------------------------------------------------------------
+//
+// fullWrite -
+//
+static bool fullWrite(int fd, const char* buf, size_t bufLen)
+{
+  while (bufLen > 0)
+  {
+    ssize_t nb = write(fd, buf, bufLen);
+
+    if (nb == -1)
+    {
+      if (errno == EINTR)
+        continue;
+      return false;
+    }
+
+    buf    += nb;
+    bufLen -= nb;
+  }
+
+  return true;
+}
+
+
+
+// -----------------------------------------------------------------------------
+//
+// orionldContextPersist -
+//
+void orionldContextPersist(const char* url, const char* json, const char* etag, const char* lastModified)
+{
+  if (contextDir[0] == 0)
+    return;
+
+  char tmpPath[512];
+  char path[512];
+
+  snprintf(tmpPath, sizeof(tmpPath), "%s/.ctx.XXXXXX", contextDir);
+  snprintf(path, sizeof(path), "%s/%08x.jsonld", contextDir, orionldContextCacheHash(url));
+
+  int fd = mkstemp(tmpPath);
+  if (fd == -1)
+  {
+    LM_E(("Unable to persist the context '%s' (mkstemp(%s): %s)", url, tmpPath, strerror(errno)));
+    return;
+  }
+  fchmod(fd, 0644);
+
+  const char* validator1 = (etag         != NULL)? etag         : "";
+  const char* validator2 = (lastModified != NULL)? lastModified : "";
+  bool        ok         = fullWrite(fd, url,        strlen(url))        && fullWrite(fd, "\n", 1) &&
+                           fullWrite(fd, validator1, strlen(validator1)) && fullWrite(fd, "\n", 1) &&
+                           fullWrite(fd, validator2, strlen(validator2)) && fullWrite(fd, "\n", 1) &&
+                           fullWrite(fd, json,       strlen(json));
+
+  close(fd);
+
+  if ((ok == false) || (rename(tmpPath, path) != 0))
+  {
+    LM_E(("Unable to persist the context '%s' in '%s': %s", url, path, strerror(errno)));
+    unlink(tmpPath);
+    return;
+  }
+
+  LM_T(LmtPreloadedContexts, ("Persisted the context '%s' in '%s'", url, path));
+}
@@ -0,0 +1,47 @@
+#ifndef SRC_LIB_ORIONLD_CONTEXT_ORIONLDCONTEXTPERSIST_H_
+#define SRC_LIB_ORIONLD_CONTEXT_ORIONLDCONTEXTPERSIST_H_
+
+/*
+*
+* Copyright 2021 FIWARE Foundation e.V.
+*
+* This file is part of Orion-LD Context Broker.
+*
+* Orion-LD Context Broker is free software: you can redistribute it and/or
+* modify it under the terms of the GNU Affero General Public License as
+* published by the Free Software Foundation, either version 3 of the
+* License, or (at your option) any later version.
+*
+* Orion-LD Context Broker is distributed in the hope that it will be useful,
+* but WITHOUT ANY WARRANTY; without even the implied warranty of
+* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU Affero
+* General Public License for more details.
+*
+* You should have received a copy of the GNU Affero General Public License
+* along with Orion-LD Context Broker. If not, see http://www.gnu.org/licenses/.
+*
+* For those usages not covered by this license please contact with
+* orionld at fiware dot org
+*
+* Author: Ken Zangelin
+*/
+
+
+
+// -----------------------------------------------------------------------------
+//
+// orionldContextPersist - save a downloaded context in the context directory (-ctxDir)
+//
+// Each context is kept in a file of its own, "<ctxDir>/<hash of the URL>.jsonld":
+//
+//   Line 1:  the URL of the context
+//   Line 2:  the ETag of the download (empty line if none)
+//   Line 3:  the Last-Modified of the download (empty line if none)
+//   Rest:    the context, exactly as it was downloaded
+//
+// The file is written to a temporary (hidden) file that is then renamed, so a reader never sees a
+// half-written file.
+//
+extern void orionldContextPersist(const char* url, const char* json, const char* etag, const char* lastModified);
+
+#endif  // SRC_LIB_ORIONLD_CONTEXT_ORIONLDCONTEXTPERSIST_H_
@@ -0,0 +1,131 @@
+/*
+*
+* Copyright 2021 FIWARE Foundation e.V.
+*
+* This file is part of Orion-LD Context Broker.
+*
+* Orion-LD Context Broker is free software: you can redistribute it and/or
+* modify it under the terms of the GNU Affero General Public License as
+* published by the Free Software Foundation, either version 3 of the
+* License, or (at your option) any later version.
+*
+* Orion-LD Context Broker is distributed in the hope that it will be useful,
+* but WITHOUT ANY WARRANTY; without even the implied warranty of
+* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU Affero
+* General Public License for more details.
+*
+* You should have received a copy of the GNU Affero General Public License
+* along with Orion-LD Context Broker. If not, see http://www.gnu.org/licenses/.
+*
+* For those usages not covered by this license please contact with
+* orionld at fiware dot org
+*
+* Author: Ken Zangelin
+*/
+#include <stdio.h>                                               // snprintf
+#include <stdlib.h>                                              // free
+#include <string.h>                                              // strlen, strcmp, strerror
+#include <errno.h>                                               // errno
+#include <dirent.h>                                              // opendir, readdir, closedir
+#include <sys/stat.h>                                            // mkdir
+
+#include "logMsg/logMsg.h"                                       // LM_*
+#include "logMsg/traceLevels.h"                                  // Lmt*
+
+#include "orionld/common/orionldState.h"                         // contextDir
+#include "orionld/types/OrionldProblemDetails.h"                 // OrionldProblemDetails
+#include "orionld/context/OrionldContext.h"                      // OrionldContext
+#include "orionld/context/orionldCoreContext.h"                  // ORIONLD_CORE_CONTEXT_URL, orionldCoreContextP
+#include "orionld/context/orionldContextCacheLookup.h"           // orionldContextCacheLookup
+#include "orionld/context/orionldContextFromBuffer.h"            // orionldContextFromBuffer
+#include "orionld/context/orionldContextPersistRead.h"           // orionldContextPersistRead
+#include "orionld/context/orionldContextPersistLoad.h"           // Own interface
+
+
+
+// -----------------------------------------------------------------------------
+//
+// contextFileLoad -
+//
+static bool contextFileLoad(const char* path)
+{
+  char*                  url;
+  char*                  etag;
+  char*                  lastModified;
+  char*                  json;
+  char*                  buf = orionldContextPersistRead(path, &url, &etag, &lastModified, &json);
+  OrionldProblemDetails  pd;
+
+  if (buf == NULL)
+    return false;
+
+  //
+  // A context that is referenced from an array context may already have been loaded
+  //
+  OrionldContext* contextP = orionldContextCacheLookup(url);
+
+  if (contextP == NULL)
+    contextP = orionldContextFromBuffer(url, json, &pd);
+
+  if (contextP == NULL)
+  {
+    LM_W(("Unable to load the persisted context '%s' from '%s' (%s: %s)", url, path, pd.title, pd.detail));
+    free(buf);
+    return false;
+  }
+
+  if (strcmp(url, ORIONLD_CORE_CONTEXT_URL) == 0)
+    orionldCoreContextP = contextP;
+
+  LM_T(LmtPreloadedContexts, ("Loaded the persisted context '%s' from '%s'", url, path));
+  free(buf);
+
+  return true;
+}
+
+
+
+// -----------------------------------------------------------------------------
+//
+// orionldContextPersistLoad -
+//
+int orionldContextPersistLoad(const char* dir)
+{
+  DIR* dirP = opendir(dir);
+
+  if (dirP == NULL)
+  {
+    if ((errno == ENOENT) && (mkdir(dir, 0755) == 0))
+      return 0;
+
+    LM_E(("The context directory '%s' can't be used (%s) - contexts will not be persisted", dir, strerror(errno)));
+    contextDir[0] = 0;
+    return 0;
+  }
+
+  struct dirent* dirItemP;
+  int            contexts = 0;
+
+  while ((dirItemP = readdir(dirP)) != NULL)
+  {
+    const char* name    = dirItemP->d_name;
+    int         nameLen = strlen(name);
+
+    if (name[0] == '.')  // skip hidden files (temporary files from orionldContextPersist) and '.'/'..'
+      continue;
+
+    if ((nameLen <= 7) || (strcmp(&name[nameLen - 7], ".jsonld") != 0))
+      continue;
+
+    char path[512];
+    snprintf(path, sizeof(path), "%s/%s", dir, name);
+
+    if (contextFileLoad(path) == true)
+      ++contexts;
+  }
+
+  closedir(dirP);
+
+  LM_I(("Loaded %d persisted contexts from '%s'", contexts, dir));
+  return contexts;
+}
@@ -0,0 +1,109 @@
+/*
+*
+* Copyright 2021 FIWARE Foundation e.V.
+*
+* This file is part of Orion-LD Context Broker.
+*
+* Orion-LD Context Broker is free software: you can redistribute it and/or
+* modify it under the terms of the GNU Affero General Public License as
+* published by the Free Software Foundation, either version 3 of the
+* License, or (at your option) any later version.
+*
+* Orion-LD Context Broker is distributed in the hope that it will be useful,
+* but WITHOUT ANY WARRANTY; without even the implied warranty of
+* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU Affero
+* General Public License for more details.
+*
+* You should have received a copy of the GNU Affero General Public License
+* along with Orion-LD Context Broker. If not, see http://www.gnu.org/licenses/.
+*
+* For those usages not covered by this license please contact with
+* orionld at fiware dot org
+*
+* Author: Ken Zangelin
+*/
+#include <stdio.h>                                               // FILE, fopen, fread, fclose
+#include <stdlib.h>                                              // malloc, free
+#include <string.h>                                              // strchr, strerror
+#include <errno.h>                                               // errno
+#include <sys/stat.h>                                            // stat
+
+#include "logMsg/logMsg.h"                                       // LM_*
+#include "logMsg/traceLevels.h"                                  // Lmt*
+
+#include "orionld/context/orionldContextPersistRead.h"           // Own interface
+
+
+
+// -----------------------------------------------------------------------------
+//
+// lineEnd - zero-terminate the line that starts at 'line' and return the start of the next line
+//
+static char* lineEnd(char* line)
+{
+  char* nl = strchr(line, '\n');
+
+  if (nl == NULL)
+    return NULL;
+
+  if ((nl > line) && (nl[-1] == '\r'))
+    nl[-1] = 0;
+
+  *nl = 0;
+  return &nl[1];
+}
+
+
+
+// -----------------------------------------------------------------------------
+//
+// orionldContextPersistRead -
+//
+char* orionldContextPersistRead(const char* path, char** urlP, char** etagP, char** lastModifiedP, char** jsonP)
+{
+  struct stat statBuf;
+
+  if (stat(path, &statBuf) != 0)
+  {
+    LM_E(("stat(%s): %s", path, strerror(errno)));
+    return NULL;
+  }
+
+  FILE* fP = fopen(path, "r");
+  if (fP == NULL)
+  {
+    LM_E(("fopen(%s): %s", path, strerror(errno)));
+    return NULL;
+  }
+
+  char*  buf = (char*) malloc(statBuf.st_size + 1);
+  size_t nb;
+
+  if (buf == NULL)
+    LM_X(1, ("Out of memory"));
+
+  nb = fread(buf, 1, statBuf.st_size, fP);
+  fclose(fP);
+
+  if (nb != (size_t) statBuf.st_size)
+  {
+    LM_E(("error reading the persisted context file '%s'", path));
+    free(buf);
+    return NULL;
+  }
+  buf[nb] = 0;
+
+  *urlP          = buf;
+  *etagP         = (*urlP  != NULL)?         lineEnd(*urlP)         : NULL;
+  *lastModifiedP = (*etagP != NULL)?         lineEnd(*etagP)        : NULL;
+  *jsonP         = (*lastModifiedP != NULL)? lineEnd(*lastModifiedP) : NULL;
+
+  if ((*jsonP == NULL) || (**urlP == 0))
+  {
+    LM_E(("invalid persisted context file '%s'", path));
+    free(buf);
+    return NULL;
+  }
+
+  return buf;
+}
@@ -0,0 +1,191 @@
+/*
+*
+* Copyright 2021 FIWARE Foundation e.V.
+*
+* This file is part of Orion-LD Context Broker.
+*
+* Orion-LD Context Broker is free software: you can redistribute it and/or
+* modify it under the terms of the GNU Affero General Public License as
+* published by the Free Software Foundation, either version 3 of the
+* License, or (at your option) any later version.
+*
+* Orion-LD Context Broker is distributed in the hope that it will be useful,
+* but WITHOUT ANY WARRANTY; without even the implied warranty of
+* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU Affero
+* General Public License for more details.
+*
+* You should have received a copy of the GNU Affero General Public License
+* along with Orion-LD Context Broker. If not, see http://www.gnu.org/licenses/.
+*
+* For those usages not covered by this license please contact with
+* orionld at fiware dot org
+*
+* Author: Ken Zangelin
+*/
+#include <stdio.h>                                               // snprintf
+#include <stdlib.h>                                              // free
+#include <string.h>                                              // strlen, strcmp, strerror
+#include <errno.h>                                               // errno
+#include <dirent.h>                                              // opendir, readdir, closedir
+#include <pthread.h>                                             // pthread_create, pthread_detach
+
+#include "logMsg/logMsg.h"                                       // LM_*
+#include "logMsg/traceLevels.h"                                  // Lmt*
+
+#include "orionld/common/orionldState.h"                         // orionldState, contextDir, contextDownloadTimeout
+#include "orionld/common/urlParse.h"                             // urlParse
+#include "orionld/common/orionldRequestSend.h"                   // orionldRequestSend, OrionldHttpHeader
+#include "orionld/context/orionldContextPersist.h"               // orionldContextPersist
+#include "orionld/context/orionldContextPersistRead.h"           // orionldContextPersistRead
+#include "orionld/context/orionldContextPersistRevalidate.h"     // Own interface
+
+
+
+// -----------------------------------------------------------------------------
+//
+// contextFileRevalidate -
+//
+static void contextFileRevalidate(const char* path)
+{
+  char*  url;
+  char*  etag;
+  char*  lastModified;
+  char*  json;
+  char*  buf = orionldContextPersistRead(path, &url, &etag, &lastModified, &json);
+
+  if (buf == NULL)
+    return;
+
+  char      protocol[16];
+  char      ip[256];
+  uint16_t  port    = 0;
+  char*     urlPath = NULL;
+  char*     detail  = NULL;
+
+  if (urlParse(url, protocol, sizeof(protocol), ip, sizeof(ip), &port, &urlPath, &detail) == false)
+  {
+    LM_W(("Unable to revalidate the persisted context '%s' (%s)", url, detail));
+    free(buf);
+    return;
+  }
+
+  OrionldHttpHeader headerV[3];
+  int               headers = 0;
+
+  if (*etag != 0)
+  {
+    headerV[headers].type  = HttpHeaderIfNoneMatch;
+    headerV[headers].value = etag;
+    ++headers;
+  }
+
+  if (*lastModified != 0)
+  {
+    headerV[headers].type  = HttpHeaderIfModifiedSince;
+    headerV[headers].value = lastModified;
+    ++headers;
+  }
+  headerV[headers].type = HttpHeaderNone;
+
+  OrionldResponseBuffer*  rBufP          = &orionldState.httpResponse;
+  bool                    tryAgain       = false;
+  bool                    downloadFailed = false;
+
+  rBufP->buf       = NULL;  // orionldRequestSend allocates
+  rBufP->size      = 0;
+  rBufP->used      = 0;
+  rBufP->allocated = false;
+
+  bool reqOk = orionldRequestSend(rBufP, protocol, ip, port, "GET", urlPath, contextDownloadTimeout, NULL, &detail, &tryAgain, &downloadFailed,
+                                  "Accept: application/ld+json", NULL, NULL, 0, headerV);
+
+  if (reqOk == false)
+    LM_W(("Unable to revalidate the persisted context '%s' (%s) - keeping the persisted copy", url, detail));
+  else if (rBufP->httpStatus == 304)
+    LM_T(LmtPreloadedContexts, ("Persisted context '%s' is up to date", url));
+  else if ((rBufP->buf != NULL) && (rBufP->buf[0] != 0))
+  {
+    bool changed = (strcmp(rBufP->buf, json) != 0);
+
+    if ((changed == true) || (strcmp(rBufP->etag, etag) != 0) || (strcmp(rBufP->lastModified, lastModified) != 0))
+      orionldContextPersist(url, rBufP->buf, rBufP->etag, rBufP->lastModified);
+
+    if (changed == true)
+      LM_W(("The context '%s' has changed at its origin - the new version will be used after a restart", url));
+  }
+
+  //
+  // This thread has no request to end, so the response buffer is freed here and not by the delayed-free mechanism
+  //
+  if (orionldState.delayedFreePointer != NULL)
+  {
+    free(orionldState.delayedFreePointer);
+    orionldState.delayedFreePointer = NULL;
+  }
+  rBufP->buf = NULL;
+
+  free(buf);
+}
+
+
+
+// -----------------------------------------------------------------------------
+//
+// revalidateThread -
+//
+static void* revalidateThread(void* dir)
+{
+  DIR* dirP = opendir((const char*) dir);
+
+  if (dirP == NULL)
+  {
+    LM_E(("opendir(%s): %s", (const char*) dir, strerror(errno)));
+    return NULL;
+  }
+
+  struct dirent* dirItemP;
+
+  while ((dirItemP = readdir(dirP)) != NULL)
+  {
+    const char* name    = dirItemP->d_name;
+    int         nameLen = strlen(name);
+
+    if (name[0] == '.')
+      continue;
+
+    if ((nameLen <= 7) || (strcmp(&name[nameLen - 7], ".jsonld") != 0))
+      continue;
+
+    char path[512];
+    snprintf(path, sizeof(path), "%s/%s", (const char*) dir, name);
+
+    contextFileRevalidate(path);
+  }
+
+  closedir(dirP);
+  LM_T(LmtPreloadedContexts, ("Revalidation of the persisted contexts is done"));
+
+  return NULL;
+}
+
+
+
+// -----------------------------------------------------------------------------
+//
+// orionldContextPersistRevalidate -
+//
+void orionldContextPersistRevalidate(void)
+{
+  pthread_t tid;
+
+  if (contextDir[0] == 0)
+    return;
+
+  if (pthread_create(&tid, NULL, revalidateThread, contextDir) != 0)
+  {
+    LM_E(("Unable to start the context revalidation thread: %s", strerror(errno)));
+    return;
+  }
+
+  pthread_detach(tid);
+}
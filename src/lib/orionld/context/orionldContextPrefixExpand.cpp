@@ -38,45 +38,6 @@ extern "C"
 
 
 
-// -----------------------------------------------------------------------------
-//
-// prefixCacheLookup -
-//
-static const char* prefixCacheLookup(const char* str)
-{
-  for (int ix = 0; ix < orionldState.prefixCache.items; ix++)
-  {
-    if (strcmp(orionldState.prefixCache.cache[ix].prefix, str) == 0)
-      return orionldState.prefixCache.cache[ix].expanded;
-  }
-
-  return NULL;
-}
-
-
-
-// -----------------------------------------------------------------------------
-//
-// prefixCacheInsert -
-//
-// If the cache is full, then we reuse the oldest
-//
-static void prefixCacheInsert(const char* prefix, const char* expansion)
-{
-  int                     index = orionldState.prefixCache.index % ORIONLD_PREFIX_CACHE_SIZE;
-  OrionldPrefixCacheItem* itemP = &orionldState.prefixCache.cache[index];
-
-  itemP->prefix   = (char*) prefix;
-  itemP->expanded = (char*) expansion;
-
-  ++orionldState.prefixCache.index;
-
-  if (orionldState.prefixCache.items < ORIONLD_PREFIX_CACHE_SIZE)
-    ++orionldState.prefixCache.items;
-}
-
-
-
 // -----------------------------------------------------------------------------
 //
 // orionldContextPrefixExpand -
@@ -89,8 +50,8 @@ static void prefixCacheInsert(const char* prefix, const char* expansion)
 //   * URIs contain ':' but we don't want to expand 'urn', not' http', etc.
 //     So, if 'name' starts with 'urn:', or if "://" is found in 'name, then no prefix expansion is performed.
 //
-//   * Normally, just a few prefixes are used, so a "prefix cache" of 10 values is maintained.
-//     This cache is local to the thread, so no semaphores are needed
+//   * For contexts in the context cache, the prefix is found with a single lookup in the merged
+//     name table of the context (see orionldContextMergedTablesBuild), so no "prefix cache" is needed
 //
 char* orionldContextPrefixExpand(OrionldContext* contextP, const char* str, char* colonP)
 {
@@ -119,24 +80,15 @@ char* orionldContextPrefixExpand(OrionldContext* contextP, const char* str, char
   prefix  = (char*) str;
   rest    = &colonP[1];
 
-  // Is the prefix in the cache?
-  prefixExpansion = (char*) prefixCacheLookup(str);
-
-  // If not, look it up in the context and add it to the cache
+  prefixExpansion = orionldContextItemExpand(contextP, prefix, false, NULL);
   if (prefixExpansion == NULL)
   {
-    prefixExpansion = (char*) orionldContextItemExpand(contextP, prefix, false, NULL);
-    if (prefixExpansion != NULL)
-      prefixCacheInsert(prefix, prefixExpansion);
-    else
-    {
-      //
-      // Prefix not found anywhere
-      // Fix the broken 'str' (the colon has been nulled out) and return it
-      //
-      *colonP = ':';
-      return (char*) str;
-    }
+    //
+    // Prefix not found anywhere
+    // Fix the broken 'str' (the colon has been nulled out) and return it
+    //
+    *colonP = ':';
+    return (char*) str;
   }
 
   // Compose the new string
@@ -63,3 +63,6 @@ DbEntitiesGet                             dbEntitiesGet;
 DbGeoIndexCreate                          dbGeoIndexCreate;
 DbIdIndexCreate                           dbIdIndexCreate;
 DbEntitiesQuery                           dbEntitiesQuery;
+DbTypeCatalogGet                          dbTypeCatalogGet;
+DbTypeCatalogItemSave                     dbTypeCatalogItemSave;
+DbEntityTypesAndAttrNamesIterate          dbEntityTypesAndAttrNamesIterate;
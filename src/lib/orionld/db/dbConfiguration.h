@@ -32,6 +32,7 @@ extern "C"
 
 #include "orionld/common/QNode.h"                                // QNode
 #include "orionld/types/OrionldProblemDetails.h"                 // OrionldProblemDetails
+#include "orionld/types/OrionldTenant.h"                         // OrionldTenant
 
 
 
@@ -47,7 +48,10 @@ extern "C"
 //
 // DB_DRIVER_MONGOC - Use the "newest" mongo C driver
 //
-// #define DB_DRIVER_MONGOC 1
+// Not defined here, but by the build (cmake -DORIONLD_MONGOC=ON), as the orionld_mongoc library and the
+// mongo C driver libraries are only built and linked then.
+// dbInit uses the mongoc driver only if DB_DRIVER_MONGO_CPP_LEGACY is not defined.
+//
 
 
 
@@ -56,6 +60,7 @@ extern "C"
 // Callback types for the DB interface
 //
 typedef bool    (*DbSubscriptionMatchCallback)(const char* entityId, KjNode* subscriptionTree, KjNode* currentEntityTree, KjNode* incomingRequestTree);
+typedef void    (*DbEntityTypeAndAttrNamesCallback)(void* userP, const char* entityType, const char** attrNameV, int attrs);
 
 
 
@@ -87,9 +92,12 @@ typedef KjNode* (*DbRegistrationGet)(const char* registrationId);
 typedef bool    (*DbRegistrationReplace)(const char* registrationId, KjNode* dbRegistrationP);
 typedef KjNode* (*DbEntitiesGet)(char** fieldV, int fields);
 typedef KjNode* (*DbEntityTypesFromRegistrationsGet)(void);
-typedef bool    (*DbGeoIndexCreate)(const char* tenant, const char* attrName);
+typedef bool    (*DbGeoIndexCreate)(OrionldTenant* tenantP, const char* attrName);
 typedef bool    (*DbIdIndexCreate)(const char* tenant);
 typedef KjNode* (*DbEntitiesQuery)(KjNode* entityInfoArrayP, KjNode* attrsP, QNode* qP, KjNode* geoqP, int limit, int offset, int* countP);
+typedef KjNode* (*DbTypeCatalogGet)(OrionldTenant* tenantP);
+typedef bool    (*DbTypeCatalogItemSave)(OrionldTenant* tenantP, const char* entityType, int entities, const char** attrNameV, int* attrCountV, int attrs);
+typedef bool    (*DbEntityTypesAndAttrNamesIterate)(OrionldTenant* tenantP, DbEntityTypeAndAttrNamesCallback callback, void* userP);
 
 
 
@@ -124,5 +132,8 @@ extern DbEntitiesGet                             dbEntitiesGet;
 extern DbGeoIndexCreate                          dbGeoIndexCreate;
 extern DbIdIndexCreate                           dbIdIndexCreate;
 extern DbEntitiesQuery                           dbEntitiesQuery;
+extern DbTypeCatalogGet                          dbTypeCatalogGet;
+extern DbTypeCatalogItemSave                     dbTypeCatalogItemSave;
+extern DbEntityTypesAndAttrNamesIterate          dbEntityTypesAndAttrNamesIterate;
 
 #endif  // SRC_LIB_ORIONLD_DB_DBCONFIGURATION_H_
@@ -39,7 +39,8 @@ extern "C"
 #include "orionld/common/orionldState.h"                          // orionldState
 #include "orionld/common/uuidGenerate.h"                          // uuidGenerate
 #include "orionld/context/orionldContextItemAliasLookup.h"        // orionldContextItemAliasLookup
-#include "orionld/db/dbConfiguration.h"                           // dbEntityTypesFromRegistrationsGet, dbEntitiesGet
+#include "orionld/db/dbConfiguration.h"                           // dbEntityTypesFromRegistrationsGet
+#include "orionld/db/dbTypeCatalogTypesGet.h"                     // dbTypeCatalogTypesGet
 #include "orionld/db/dbEntityTypesGet.h"                          // Own interface
 
 
@@ -110,23 +111,12 @@ static void kjStringArraySortedInsert(KjNode* array, KjNode* newItemP)
 
 // -----------------------------------------------------------------------------
 //
-// typesExtract -
+// typesAlias - replace the expanded type names of the type catalog with their aliases
 //
-static KjNode* typesExtract(KjNode* array)
+static KjNode* typesAlias(KjNode* typeArray)
 {
-  KjNode* typeArray = kjArray(orionldState.kjsonP, NULL);
-
-  for (KjNode* entityP = array->value.firstChildP; entityP != NULL; entityP = entityP->next)
-  {
-    KjNode* idP   = entityP->value.firstChildP;  // The entities has a single child '_id'
-    KjNode* typeP = kjLookup(idP, "type");
-
-    if (typeP != NULL)
-    {
-      kjChildAdd(typeArray, typeP);  // OK to break tree, as idP is one level up and its next pointer is still intact
-      typeP->value.s = orionldContextItemAliasLookup(orionldState.contextP, typeP->value.s, NULL, NULL);
-    }
-  }
+  for (KjNode* typeP = typeArray->value.firstChildP; typeP != NULL; typeP = typeP->next)
+    typeP->value.s = orionldContextItemAliasLookup(orionldState.contextP, typeP->value.s, NULL, NULL);
 
   return typeArray;
 }
@@ -135,50 +125,42 @@ static KjNode* typesExtract(KjNode* array)
 
 // -----------------------------------------------------------------------------
 //
-// typesAndAttributesExtractFromEntities -
+// typesAndAttributesAlias - add 'typeName' and sort + alias 'attributeNames' of the type objects of the type catalog
 //
-static KjNode* typesAndAttributesExtractFromEntities(KjNode* array)
+static KjNode* typesAndAttributesAlias(KjNode* typeArray)
 {
-  KjNode* typeArray = kjArray(orionldState.kjsonP, NULL);
-
-  for (KjNode* entityP = array->value.firstChildP; entityP != NULL; entityP = entityP->next)
+  for (KjNode* typeObjectP = typeArray->value.firstChildP; typeObjectP != NULL; typeObjectP = typeObjectP->next)
   {
-    KjNode* nodeResponseP = kjObject(orionldState.kjsonP, NULL);
-    KjNode* _idP          = kjLookup(entityP, "_id");
-    KjNode* typeP         = kjLookup(_idP, "type");
-    KjNode* attributesP   = kjLookup(entityP, "attrNames");
+    KjNode* idP         = kjLookup(typeObjectP, "id");
+    KjNode* attributesP = kjLookup(typeObjectP, "attributeNames");
 
-    if (typeP != NULL)
+    if (idP != NULL)
     {
-      char*   typeName       = orionldContextItemAliasLookup(orionldState.contextP, typeP->value.s, NULL, NULL);
-      KjNode* typeIdNodeP    = kjString(orionldState.kjsonP, "id", typeP->value.s);
+      char*   typeName       = orionldContextItemAliasLookup(orionldState.contextP, idP->value.s, NULL, NULL);
       KjNode* typeNameNodeP  = kjString(orionldState.kjsonP, "typeName", typeName);
 
-      kjChildAdd(nodeResponseP, typeIdNodeP);
-      kjChildAdd(nodeResponseP, typeNameNodeP);
+      // 'typeName' goes right after 'id'
+      typeNameNodeP->next = idP->next;
+      idP->next           = typeNameNodeP;
     }
 
     if (attributesP != NULL)
     {
-      KjNode* attributeNamesNodeListP = kjArray(orionldState.kjsonP,  "attributeNames");
-      KjNode* nodeP                   = attributesP->value.firstChildP;
+      KjNode* nodeP = attributesP->value.firstChildP;
       KjNode* next;
 
+      attributesP->value.firstChildP = NULL;
+      attributesP->lastChild         = NULL;
+
       while (nodeP != NULL)
       {
         next = nodeP->next;
 
-        KjNode* cloneP = kjClone(orionldState.kjsonP, nodeP);
-
-        cloneP->value.s = orionldContextItemAliasLookup(orionldState.contextP, cloneP->value.s, NULL, NULL);
-        kjStringArraySortedInsert(attributeNamesNodeListP, cloneP);
+        nodeP->value.s = orionldContextItemAliasLookup(orionldState.contextP, nodeP->value.s, NULL, NULL);
+        kjStringArraySortedInsert(attributesP, nodeP);
         nodeP = next;
       }
-
-      kjChildAdd(nodeResponseP, attributeNamesNodeListP);
     }
-
-    kjChildAdd(typeArray, nodeResponseP);  // OK to break tree
   }
 
   return typeArray;
@@ -369,28 +351,19 @@ KjNode* dbEntityTypesGet(OrionldProblemDetails* pdP)
 {
   KjNode*  local;
   KjNode*  remote;
-  char*    fields[2];
   KjNode*  arrayP = NULL;
 
-  fields[0] = (char*) "_id";
-
   //
-  // GET local types - i.e. from the "entities" collection
+  // GET local types - i.e. from the type catalog of the tenant, not from the "entities" collection
   //
-  if (orionldState.uriParams.details == false)
-    local  = dbEntitiesGet(fields, 1);
-  else
-  {
-    fields[1] = (char*) "attrNames";
-    local  = dbEntitiesGet(fields, 2);
-  }
+  local = dbTypeCatalogTypesGet(orionldState.uriParams.details);
 
   if (local != NULL)
   {
     if (orionldState.uriParams.details == false)
-      local = typesExtract(local);
+      local = typesAlias(local);
     else
-      local = typesAndAttributesExtractFromEntities(local);
+      local = typesAndAttributesAlias(local);
   }
 
   //
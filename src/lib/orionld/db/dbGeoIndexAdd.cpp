@@ -22,17 +22,16 @@
 *
 * Author: Ken Zangelin
 */
-extern "C"
-{
-#include "kalloc/kaAlloc.h"                                      // kaAlloc
-#include "kalloc/kaStrdup.h"                                     // kaStrdup
-}
+#include <stdlib.h>                                              // malloc, free
+#include <string.h>                                              // strdup
 
 #include "logMsg/logMsg.h"                                       // LM_*
 #include "logMsg/traceLevels.h"                                  // Lmt*
 
 #include "orionld/types/OrionldGeoIndex.h"                       // OrionldGeoIndex
-#include "orionld/common/orionldState.h"                         // kalloc, geoIndexList
+#include "orionld/types/OrionldTenant.h"                         // OrionldTenant, ORIONLD_TENANT_GEO_INDEX_BUCKETS
+#include "orionld/db/dbGeoIndexHash.h"                           // dbGeoIndexHash
+#include "orionld/db/dbGeoIndexLookup.h"                         // dbGeoIndexLookup
 #include "orionld/db/dbGeoIndexAdd.h"                            // Own interface
 
 
@@ -41,21 +40,43 @@ extern "C"
 //
 // dbGeoIndexAdd -
 //
-void dbGeoIndexAdd(const char* tenant, const char* attrName)
+// Items are never removed from the hash set, so readers (dbGeoIndexLookup) need no lock.
+// A new item is prepended to its bucket with a CAS on the bucket head. If another thread added the
+// same attribute meanwhile (two requests creating the same index), the new item is thrown away.
+//
+// The items are allocated with malloc, as they live as long as the broker and this function is called
+// from request threads (the global kalloc isn't thread-safe).
+//
+void dbGeoIndexAdd(OrionldTenant* tenantP, const char* attrName)
 {
-  OrionldGeoIndex* geoNodeP = (OrionldGeoIndex*) kaAlloc(&kalloc, sizeof(OrionldGeoIndex));
-
-  geoNodeP->tenant   = kaStrdup(&kalloc, tenant);
-  geoNodeP->attrName = kaStrdup(&kalloc, attrName);
+  unsigned int      bucket   = dbGeoIndexHash(attrName) % ORIONLD_TENANT_GEO_INDEX_BUCKETS;
+  OrionldGeoIndex*  geoNodeP = (OrionldGeoIndex*) malloc(sizeof(OrionldGeoIndex));
 
-  if (geoIndexList == NULL)
+  if (geoNodeP == NULL)
   {
-    geoNodeP->next = NULL;
-    geoIndexList   = geoNodeP;
+    LM_E(("Out of memory (allocating a geo-index item for attribute '%s')", attrName));
+    return;
   }
-  else
+
+  geoNodeP->attrName = strdup(attrName);
+  if (geoNodeP->attrName == NULL)
   {
-    geoNodeP->next = geoIndexList;
-    geoIndexList   = geoNodeP;
+    LM_E(("Out of memory (allocating a geo-index item for attribute '%s')", attrName));
+    free(geoNodeP);
+    return;
   }
+
+  OrionldGeoIndex* head = __atomic_load_n(&tenantP->geoIndexV[bucket], __ATOMIC_ACQUIRE);
+
+  do
+  {
+    if (dbGeoIndexLookup(tenantP, attrName) != NULL)
+    {
+      free(geoNodeP->attrName);
+      free(geoNodeP);
+      return;
+    }
+
+    geoNodeP->next = head;
+  } while (__atomic_compare_exchange_n(&tenantP->geoIndexV[bucket], &head, geoNodeP, false, __ATOMIC_RELEASE, __ATOMIC_ACQUIRE) == false);
 }
@@ -25,13 +25,14 @@
 *
 * Author: Ken Zangelin
 */
+#include "orionld/types/OrionldTenant.h"                         // OrionldTenant
 
 
 
 // ----------------------------------------------------------------------------
 //
-// dbGeoIndexAdd -
+// dbGeoIndexAdd - add an attribute to the geo-index hash set of a tenant
 //
-extern void dbGeoIndexAdd(const char* tenant, const char* attrName);
+extern void dbGeoIndexAdd(OrionldTenant* tenantP, const char* attrName);
 
 #endif  // SRC_LIB_ORIONLD_DB_DBGEOINDEXADD_H_
@@ -22,25 +22,53 @@
 *
 * Author: Ken Zangelin
 */
-#include <string.h>                                              // strcmp
+#include <stddef.h>                                              // NULL
 
 #include "orionld/types/OrionldGeoIndex.h"                       // OrionldGeoIndex
-#include "orionld/common/orionldState.h"                         // geoIndexList
+#include "orionld/types/OrionldTenant.h"                         // OrionldTenant, ORIONLD_TENANT_GEO_INDEX_BUCKETS
+#include "orionld/db/dbGeoIndexHash.h"                           // dbGeoIndexHash
 #include "orionld/db/dbGeoIndexLookup.h"                         // Own interface
 
 
 
+// ----------------------------------------------------------------------------
+//
+// attrNameCompare - like strcmp()==0, but with '.' and '=' considered the same character
+//
+static bool attrNameCompare(const char* name1, const char* name2)
+{
+  while ((*name1 != 0) && (*name2 != 0))
+  {
+    char c1 = (*name1 == '.')? '=' : *name1;
+    char c2 = (*name2 == '.')? '=' : *name2;
+
+    if (c1 != c2)
+      return false;
+
+    ++name1;
+    ++name2;
+  }
+
+  return *name1 == *name2;
+}
+
+
+
 // ----------------------------------------------------------------------------
 //
 // dbGeoIndexLookup -
 //
-OrionldGeoIndex* dbGeoIndexLookup(const char* tenant, const char* attrName)
+// The attribute name may come with '.' (expanded name) or with '=' (as stored in the database).
+// Both are accepted.
+//
+OrionldGeoIndex* dbGeoIndexLookup(OrionldTenant* tenantP, const char* attrName)
 {
-  OrionldGeoIndex* giP = geoIndexList;
+  unsigned int      bucket = dbGeoIndexHash(attrName) % ORIONLD_TENANT_GEO_INDEX_BUCKETS;
+  OrionldGeoIndex*  giP    = __atomic_load_n(&tenantP->geoIndexV[bucket], __ATOMIC_ACQUIRE);
 
   while (giP != NULL)
   {
-    if ((strcmp(giP->tenant, tenant) == 0) && (strcmp(giP->attrName, attrName) == 0))
+    if (attrNameCompare(giP->attrName, attrName) == true)
       return giP;
 
     giP = giP->next;
@@ -26,13 +26,16 @@
 * Author: Ken Zangelin
 */
 #include "orionld/types/OrionldGeoIndex.h"                       // OrionldGeoIndex
+#include "orionld/types/OrionldTenant.h"                         // OrionldTenant
 
 
 
 // ----------------------------------------------------------------------------
 //
-// dbGeoIndexLookup -
+// dbGeoIndexLookup - lookup an attribute in the geo-index hash set of a tenant
 //
-extern OrionldGeoIndex* dbGeoIndexLookup(const char* tenant, const char* attrName);
+// No lock needed - see dbGeoIndexAdd
+//
+extern OrionldGeoIndex* dbGeoIndexLookup(OrionldTenant* tenantP, const char* attrName);
 
 #endif  // SRC_LIB_ORIONLD_DB_DBGEOINDEXLOOKUP_H_
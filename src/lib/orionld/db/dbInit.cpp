@@ -53,12 +53,41 @@
 #include "orionld/mongoCppLegacy/mongoCppLegacyIdIndexCreate.h"            // mongoCppLegacyIdIndexCreate
 #include "orionld/mongoCppLegacy/mongoCppLegacyEntityRetrieve.h"           // mongoCppLegacyEntityRetrieve
 #include "orionld/mongoCppLegacy/mongoCppLegacyEntitiesQuery.h"            // mongoCppLegacyEntitiesQuery
+#include "orionld/mongoCppLegacy/mongoCppLegacyTypeCatalogGet.h"           // mongoCppLegacyTypeCatalogGet
+#include "orionld/mongoCppLegacy/mongoCppLegacyTypeCatalogItemSave.h"      // mongoCppLegacyTypeCatalogItemSave
+#include "orionld/mongoCppLegacy/mongoCppLegacyEntityTypesAndAttrNamesIterate.h"  // mongoCppLegacyEntityTypesAndAttrNamesIterate
 
 #elif DB_DRIVER_MONGOC
 #include "orionld/mongoc/mongocInit.h"                                     // mongocInit
 #include "orionld/mongoc/mongocEntityUpdate.h"                             // mongocEntityUpdate
 #include "orionld/mongoc/mongocEntityLookup.h"                             // mongocEntityLookup
+#include "orionld/mongoc/mongocEntityRetrieve.h"                           // mongocEntityRetrieve
+#include "orionld/mongoc/mongocEntityAttributeLookup.h"                    // mongocEntityAttributeLookup
+#include "orionld/mongoc/mongocEntitiesAttributeLookup.h"                  // mongocEntitiesAttributeLookup
+#include "orionld/mongoc/mongocEntityAttributesDelete.h"                   // mongocEntityAttributesDelete
+#include "orionld/mongoc/mongocEntityFieldReplace.h"                       // mongocEntityFieldReplace
 #include "orionld/mongoc/mongocKjTreeFromBson.h"                           // mongocKjTreeFromBson
+#include "orionld/mongoc/mongocKjTreeToBson.h"                             // mongocKjTreeToBson
+#include "orionld/mongoc/mongocEntityDelete.h"                             // mongocEntityDelete
+#include "orionld/mongoc/mongocEntitiesDelete.h"                           // mongocEntitiesDelete
+#include "orionld/mongoc/mongocSubscriptionMatchEntityIdAndAttributes.h"   // mongocSubscriptionMatchEntityIdAndAttributes
+#include "orionld/mongoc/mongocEntityListLookupWithIdTypeCreDate.h"        // mongocEntityListLookupWithIdTypeCreDate
+#include "orionld/mongoc/mongocRegistrationLookup.h"                       // mongocRegistrationLookup
+#include "orionld/mongoc/mongocRegistrationExists.h"                       // mongocRegistrationExists
+#include "orionld/mongoc/mongocRegistrationDelete.h"                       // mongocRegistrationDelete
+#include "orionld/mongoc/mongocSubscriptionGet.h"                          // mongocSubscriptionGet
+#include "orionld/mongoc/mongocSubscriptionReplace.h"                      // mongocSubscriptionReplace
+#include "orionld/mongoc/mongocSubscriptionDelete.h"                       // mongocSubscriptionDelete
+#include "orionld/mongoc/mongocRegistrationGet.h"                          // mongocRegistrationGet
+#include "orionld/mongoc/mongocRegistrationReplace.h"                      // mongocRegistrationReplace
+#include "orionld/mongoc/mongocEntitiesGet.h"                              // mongocEntitiesGet
+#include "orionld/mongoc/mongocEntityTypesFromRegistrationsGet.h"          // mongocEntityTypesFromRegistrationsGet
+#include "orionld/mongoc/mongocGeoIndexCreate.h"                           // mongocGeoIndexCreate
+#include "orionld/mongoc/mongocIdIndexCreate.h"                            // mongocIdIndexCreate
+#include "orionld/mongoc/mongocEntitiesQuery.h"                            // mongocEntitiesQuery
+#include "orionld/mongoc/mongocTypeCatalogGet.h"                           // mongocTypeCatalogGet
+#include "orionld/mongoc/mongocTypeCatalogItemSave.h"                      // mongocTypeCatalogItemSave
+#include "orionld/mongoc/mongocEntityTypesAndAttrNamesIterate.h"           // mongocEntityTypesAndAttrNamesIterate
 #endif
 #include "orionld/db/dbInit.h"                                             // Own interface
 
@@ -101,32 +130,43 @@ void dbInit(const char* dbHost, const char* dbName)
   dbGeoIndexCreate                         = mongoCppLegacyGeoIndexCreate;
   dbIdIndexCreate                          = mongoCppLegacyIdIndexCreate;
   dbEntitiesQuery                          = mongoCppLegacyEntitiesQuery;
+  dbTypeCatalogGet                         = mongoCppLegacyTypeCatalogGet;
+  dbTypeCatalogItemSave                    = mongoCppLegacyTypeCatalogItemSave;
+  dbEntityTypesAndAttrNamesIterate         = mongoCppLegacyEntityTypesAndAttrNamesIterate;
 
   mongoCppLegacyInit(dbHost, dbName);
 
 #elif DB_DRIVER_MONGOC
 
   dbEntityLookup                           = mongocEntityLookup;
+  dbEntityRetrieve                         = mongocEntityRetrieve;
+  dbEntityAttributeLookup                  = mongocEntityAttributeLookup;
+  dbEntitiesAttributeLookup                = mongocEntitiesAttributeLookup;
+  dbEntityAttributesDelete                 = mongocEntityAttributesDelete;
   dbEntityUpdate                           = mongocEntityUpdate;
-  dbDataToKjTree                           = mongocKjTreeFromBsonObj;
-  dbDataFromKjTree                         = NULL;  // FIXME: Implement mongocKjTreeToBson
-  dbEntityDelete                           = NULL;  // FIXME: Implement mongocEntityDelete
-  dbEntitiesDelete                         = NULL;  // FIXME: Implement mongocEntitiesDelete
-  dbSubscriptionMatchEntityIdAndAttributes = NULL;  // FIXME: Implement mongocSubscriptionMatchEntityIdAndAttributes
-  dbEntityListLookupWithIdTypeCreDate      = NULL;  // FIXME: Implement mongocEntityListLookupWithIdTypeCreDate
-  dbRegistrationLookup                     = NULL;  // FIXME: Implement mongocRegistrationLookup
-  dbRegistrationExists                     = NULL;  // FIXME: Implement mongocRegistrationExists
-  dbRegistrationDelete                     = NULL;  // FIXME: Implement mongocRegistrationDelete
-  dbSubscriptionGet                        = NULL;  // FIXME: Implement mongocSubscriptionGet
-  dbSubscriptionReplace                    = NULL;  // FIXME: Implement mongocSubscriptionReplace
-  dbRegistrationGet                        = NULL;  // FIXME: Implement mongocRegistrationGet
-  dbRegistrationReplace                    = NULL;  // FIXME: Implement mongocRegistrationReplace
-  dbEntitiesGet                            = NULL;  // FIXME: Implement mongocEntitiesGet
-  dbEntityTypesFromRegistrationsGet        = NULL;  // FIXME: Implement mongocEntityTypesFromRegistrationsGet
-  dbGeoIndexCreate                         = NULL;  // FIXME: Implement mongocGeoIndexCreate
-  dbIdIndexCreate                          = NULL;  // FIXME: Implement mongocIdIndexCreate
-  dbEntitiesQuery                          = NULL;  // FIXME: Implement mongocEntitiesQuery
-  dbEntityFieldReplace                     = NULL;  // FIXME: Implement mongocEntityFieldReplace
+  dbEntityFieldReplace                     = mongocEntityFieldReplace;
+  dbDataToKjTree                           = mongocKjTreeFromBson;
+  dbDataFromKjTree                         = mongocKjTreeToBson;
+  dbEntityDelete                           = mongocEntityDelete;
+  dbEntitiesDelete                         = mongocEntitiesDelete;
+  dbSubscriptionMatchEntityIdAndAttributes = mongocSubscriptionMatchEntityIdAndAttributes;
+  dbEntityListLookupWithIdTypeCreDate      = mongocEntityListLookupWithIdTypeCreDate;
+  dbRegistrationLookup                     = mongocRegistrationLookup;
+  dbRegistrationExists                     = mongocRegistrationExists;
+  dbRegistrationDelete                     = mongocRegistrationDelete;
+  dbSubscriptionGet                        = mongocSubscriptionGet;
+  dbSubscriptionReplace                    = mongocSubscriptionReplace;
+  dbSubscriptionDelete                     = mongocSubscriptionDelete;
+  dbRegistrationGet                        = mongocRegistrationGet;
+  dbRegistrationReplace                    = mongocRegistrationReplace;
+  dbEntitiesGet                            = mongocEntitiesGet;
+  dbEntityTypesFromRegistrationsGet        = mongocEntityTypesFromRegistrationsGet;
+  dbGeoIndexCreate                         = mongocGeoIndexCreate;
+  dbIdIndexCreate                          = mongocIdIndexCreate;
+  dbEntitiesQuery                          = mongocEntitiesQuery;
+  dbTypeCatalogGet                         = mongocTypeCatalogGet;
+  dbTypeCatalogItemSave                    = mongocTypeCatalogItemSave;
+  dbEntityTypesAndAttrNamesIterate         = mongocEntityTypesAndAttrNamesIterate;
 
   mongocInit(dbHost, dbName);
 
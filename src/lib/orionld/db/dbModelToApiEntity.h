@@ -0,0 +1,53 @@
+#ifndef SRC_LIB_ORIONLD_DB_DBMODELTOAPIENTITY_H_
+#define SRC_LIB_ORIONLD_DB_DBMODELTOAPIENTITY_H_
+
+/*
+*
+* Copyright 2021 FIWARE Foundation e.V.
+*
+* This file is part of Orion-LD Context Broker.
+*
+* Orion-LD Context Broker is free software: you can redistribute it and/or
+* modify it under the terms of the GNU Affero General Public License as
+* published by the Free Software Foundation, either version 3 of the
+* License, or (at your option) any later version.
+*
+* Orion-LD Context Broker is distributed in the hope that it will be useful,
+* but WITHOUT ANY WARRANTY; without even the implied warranty of
+* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU Affero
+* General Public License for more details.
+*
+* You should have received a copy of the GNU Affero General Public License
+* along with Orion-LD Context Broker. If not, see http://www.gnu.org/licenses/.
+*
+* For those usages not covered by this license please contact with
+* orionld at fiware dot org
+*
+* Author: Ken Zangelin
+*/
+extern "C"
+{
+#include "kjson/KjNode.h"                                        // KjNode
+}
+
+
+
+// ----------------------------------------------------------------------------
+//
+// dbModelToApiEntity - transform an entity from the database model into an NGSI-LD API entity
+//
+// Used by both Retrieve Entity and Query Entities - see the .cpp file for the parameters.
+//
+extern KjNode* dbModelToApiEntity
+(
+  KjNode*      dbTree,
+  char**       attrs,
+  bool         attrMandatory,
+  bool         sysAttrs,
+  bool         keyValues,
+  const char*  geoPropertyName,
+  KjNode**     geoPropertyP,
+  bool*        geoPropertyMissingP
+);
+
+#endif  // SRC_LIB_ORIONLD_DB_DBMODELTOAPIENTITY_H_
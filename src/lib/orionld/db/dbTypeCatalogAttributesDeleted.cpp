@@ -0,0 +1,100 @@
+/*
+*
+* Copyright 2021 FIWARE Foundation e.V.
+*
+* This file is part of Orion-LD Context Broker.
+*
+* Orion-LD Context Broker is free software: you can redistribute it and/or
+* modify it under the terms of the GNU Affero General Public License as
+* published by the Free Software Foundation, either version 3 of the
+* License, or (at your option) any later version.
+*
+* Orion-LD Context Broker is distributed in the hope that it will be useful,
+* but WITHOUT ANY WARRANTY; without even the implied warranty of
+* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU Affero
+* General Public License for more details.
+*
+* You should have received a copy of the GNU Affero General Public License
+* along with Orion-LD Context Broker. If not, see http://www.gnu.org/licenses/.
+*
+* For those usages not covered by this license please contact with
+* orionld at fiware dot org
+*
+* Author: Ken Zangelin
+*/
+extern "C"
+{
+#include "kalloc/kaAlloc.h"                                      // kaAlloc
+#include "kjson/KjNode.h"                                        // KjNode
+#include "kjson/kjLookup.h"                                      // kjLookup
+}
+
+#include "logMsg/logMsg.h"                                       // LM_*
+#include "logMsg/traceLevels.h"                                  // Lmt*
+
+#include "orionld/common/orionldState.h"                         // orionldState
+#include "orionld/db/dbTypeCatalogUpdate.h"                      // dbTypeCatalogUpdate
+#include "orionld/db/dbTypeCatalogAttributesDeleted.h"           // Own interface
+
+
+
+// ----------------------------------------------------------------------------
+//
+// attrNameEqual - compare two attribute names, taking '.' and '=' as the same character
+//
+static bool attrNameEqual(const char* name1, const char* name2)
+{
+  while ((*name1 != 0) && (*name2 != 0))
+  {
+    char c1 = (*name1 == '=')? '.' : *name1;
+    char c2 = (*name2 == '=')? '.' : *name2;
+
+    if (c1 != c2)
+      return false;
+
+    ++name1;
+    ++name2;
+  }
+
+  return *name1 == *name2;
+}
+
+
+
+// ----------------------------------------------------------------------------
+//
+// dbTypeCatalogAttributesDeleted -
+//
+void dbTypeCatalogAttributesDeleted(KjNode* dbEntityP, char** attrNameV, int attrs)
+{
+  KjNode* _idP       = kjLookup(dbEntityP, "_id");
+  KjNode* typeP      = (_idP != NULL)? kjLookup(_idP, "type") : kjLookup(dbEntityP, "type");
+  KjNode* attrNamesP = kjLookup(dbEntityP, "attrNames");
+
+  if ((typeP == NULL) || (typeP->type != KjString) || (attrNamesP == NULL) || (attrNamesP->type != KjArray) || (attrs <= 0))
+    return;
+
+  const char** removedV = (const char**) kaAlloc(&orionldState.kalloc, attrs * sizeof(char*));
+  int          removed  = 0;
+
+  for (KjNode* nameP = attrNamesP->value.firstChildP; nameP != NULL; nameP = nameP->next)
+  {
+    if (nameP->type != KjString)
+      continue;
+
+    for (int ix = 0; ix < attrs; ix++)
+    {
+      if (attrNameEqual(nameP->value.s, attrNameV[ix]) == true)
+      {
+        removedV[removed++] = nameP->value.s;
+        break;
+      }
+    }
+
+    if (removed == attrs)
+      break;
+  }
+
+  if (removed > 0)
+    dbTypeCatalogUpdate(typeP->value.s, 0, NULL, 0, removedV, removed);
+}
@@ -0,0 +1,105 @@
+/*
+*
+* Copyright 2021 FIWARE Foundation e.V.
+*
+* This file is part of Orion-LD Context Broker.
+*
+* Orion-LD Context Broker is free software: you can redistribute it and/or
+* modify it under the terms of the GNU Affero General Public License as
+* published by the Free Software Foundation, either version 3 of the
+* License, or (at your option) any later version.
+*
+* Orion-LD Context Broker is distributed in the hope that it will be useful,
+* but WITHOUT ANY WARRANTY; without even the implied warranty of
+* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU Affero
+* General Public License for more details.
+*
+* You should have received a copy of the GNU Affero General Public License
+* along with Orion-LD Context Broker. If not, see http://www.gnu.org/licenses/.
+*
+* For those usages not covered by this license please contact with
+* orionld at fiware dot org
+*
+* Author: Ken Zangelin
+*/
+#include <stdlib.h>                                              // calloc, free
+#include <string.h>                                              // strcmp, strdup
+
+#include "logMsg/logMsg.h"                                       // LM_*
+#include "logMsg/traceLevels.h"                                  // Lmt*
+
+#include "orionld/types/OrionldTypeCatalog.h"                    // OrionldTypeCatalog, OrionldTypeCatalogItem, OrionldTypeCatalogAttribute
+#include "orionld/db/dbTypeCatalogItemGet.h"                     // dbTypeCatalogItemGet
+#include "orionld/db/dbTypeCatalogCount.h"                       // Own interface
+
+
+
+// ----------------------------------------------------------------------------
+//
+// attributeGet -
+//
+static OrionldTypeCatalogAttribute* attributeGet(OrionldTypeCatalogItem* itemP, const char* attrName)
+{
+  for (OrionldTypeCatalogAttribute* attrP = itemP->attrList; attrP != NULL; attrP = attrP->next)
+  {
+    if (strcmp(attrP->name, attrName) == 0)
+      return attrP;
+  }
+
+  OrionldTypeCatalogAttribute* attrP = (OrionldTypeCatalogAttribute*) calloc(1, sizeof(OrionldTypeCatalogAttribute));
+
+  if (attrP == NULL)
+  {
+    LM_E(("Out of memory (allocating a type catalog attribute '%s' for entity type '%s')", attrName, itemP->type));
+    return NULL;
+  }
+
+  attrP->name = strdup(attrName);
+  if (attrP->name == NULL)
+  {
+    LM_E(("Out of memory (allocating a type catalog attribute '%s' for entity type '%s')", attrName, itemP->type));
+    free(attrP);
+    return NULL;
+  }
+
+  attrP->next     = itemP->attrList;
+  itemP->attrList = attrP;
+
+  return attrP;
+}
+
+
+
+// ----------------------------------------------------------------------------
+//
+// dbTypeCatalogCount -
+//
+// Counts never go below zero - a negative count can only be the consequence of an entity that was
+// created by another broker sharing the same database, and the catalog of this broker never saw it.
+//
+void dbTypeCatalogCount(OrionldTypeCatalog* catalogP, const char* entityType, int entityDelta, const char** attrNameV, int attrs, int attrDelta)
+{
+  OrionldTypeCatalogItem* itemP = dbTypeCatalogItemGet(catalogP, entityType, true);
+
+  if (itemP == NULL)
+    return;
+
+  itemP->entities += entityDelta;
+  if (itemP->entities < 0)
+    itemP->entities = 0;
+
+  for (int ix = 0; ix < attrs; ix++)
+  {
+    OrionldTypeCatalogAttribute* attrP = attributeGet(itemP, attrNameV[ix]);
+
+    if (attrP == NULL)
+      continue;
+
+    attrP->entities += attrDelta;
+    if (attrP->entities < 0)
+      attrP->entities = 0;
+  }
+
+  itemP->dirty     = true;
+  catalogP->dirty  = true;
+}
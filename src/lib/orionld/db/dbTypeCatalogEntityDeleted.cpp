@@ -0,0 +1,79 @@
+/*
+*
+* Copyright 2021 FIWARE Foundation e.V.
+*
+* This file is part of Orion-LD Context Broker.
+*
+* Orion-LD Context Broker is free software: you can redistribute it and/or
+* modify it under the terms of the GNU Affero General Public License as
+* published by the Free Software Foundation, either version 3 of the
+* License, or (at your option) any later version.
+*
+* Orion-LD Context Broker is distributed in the hope that it will be useful,
+* but WITHOUT ANY WARRANTY; without even the implied warranty of
+* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU Affero
+* General Public License for more details.
+*
+* You should have received a copy of the GNU Affero General Public License
+* along with Orion-LD Context Broker. If not, see http://www.gnu.org/licenses/.
+*
+* For those usages not covered by this license please contact with
+* orionld at fiware dot org
+*
+* Author: Ken Zangelin
+*/
+extern "C"
+{
+#include "kalloc/kaAlloc.h"                                      // kaAlloc
+#include "kjson/KjNode.h"                                        // KjNode
+#include "kjson/kjLookup.h"                                      // kjLookup
+}
+
+#include "logMsg/logMsg.h"                                       // LM_*
+#include "logMsg/traceLevels.h"                                  // Lmt*
+
+#include "orionld/common/orionldState.h"                         // orionldState
+#include "orionld/db/dbTypeCatalogUpdate.h"                      // dbTypeCatalogUpdate
+#include "orionld/db/dbTypeCatalogEntityDeleted.h"               // Own interface
+
+
+
+// ----------------------------------------------------------------------------
+//
+// dbTypeCatalogEntityDeleted -
+//
+void dbTypeCatalogEntityDeleted(KjNode* dbEntityP)
+{
+  KjNode* _idP       = kjLookup(dbEntityP, "_id");
+  KjNode* typeP      = (_idP != NULL)? kjLookup(_idP, "type") : kjLookup(dbEntityP, "type");
+  KjNode* attrNamesP = kjLookup(dbEntityP, "attrNames");
+
+  if ((typeP == NULL) || (typeP->type != KjString))
+  {
+    LM_W(("Entity without type - not in the type catalog"));
+    return;
+  }
+
+  int          attrs     = 0;
+  const char** attrNameV = NULL;
+
+  if ((attrNamesP != NULL) && (attrNamesP->type == KjArray))
+  {
+    for (KjNode* nameP = attrNamesP->value.firstChildP; nameP != NULL; nameP = nameP->next)
+      ++attrs;
+
+    if (attrs > 0)
+    {
+      attrNameV = (const char**) kaAlloc(&orionldState.kalloc, attrs * sizeof(char*));
+      attrs     = 0;
+
+      for (KjNode* nameP = attrNamesP->value.firstChildP; nameP != NULL; nameP = nameP->next)
+      {
+        if (nameP->type == KjString)
+          attrNameV[attrs++] = nameP->value.s;
+      }
+    }
+  }
+
+  dbTypeCatalogUpdate(typeP->value.s, -1, NULL, 0, attrNameV, attrs);
+}
@@ -0,0 +1,179 @@
+/*
+*
+* Copyright 2021 FIWARE Foundation e.V.
+*
+* This file is part of Orion-LD Context Broker.
+*
+* Orion-LD Context Broker is free software: you can redistribute it and/or
+* modify it under the terms of the GNU Affero General Public License as
+* published by the Free Software Foundation, either version 3 of the
+* License, or (at your option) any later version.
+*
+* Orion-LD Context Broker is distributed in the hope that it will be useful,
+* but WITHOUT ANY WARRANTY; without even the implied warranty of
+* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU Affero
+* General Public License for more details.
+*
+* You should have received a copy of the GNU Affero General Public License
+* along with Orion-LD Context Broker. If not, see http://www.gnu.org/licenses/.
+*
+* For those usages not covered by this license please contact with
+* orionld at fiware dot org
+*
+* Author: Ken Zangelin
+*/
+#include <semaphore.h>                                           // sem_wait, sem_post
+
+extern "C"
+{
+#include "kalloc/kaAlloc.h"                                      // kaAlloc
+#include "kalloc/kaStrdup.h"                                     // kaStrdup
+#include "kalloc/kaBufferReset.h"                                // kaBufferReset
+}
+
+#include "logMsg/logMsg.h"                                       // LM_*
+#include "logMsg/traceLevels.h"                                  // Lmt*
+
+#include "orionld/types/OrionldTenant.h"                         // OrionldTenant
+#include "orionld/types/OrionldTypeCatalog.h"                    // OrionldTypeCatalog, ORIONLD_TYPE_CATALOG_BUCKETS
+#include "orionld/common/orionldState.h"                         // orionldState, orionldStateInit, tenant0, tenantList
+#include "orionld/db/dbConfiguration.h"                          // dbTypeCatalogItemSave
+#include "orionld/db/dbTypeCatalogItemGet.h"                     // dbTypeCatalogItemGet
+#include "orionld/db/dbTypeCatalogFlush.h"                       // Own interface
+
+
+
+// ----------------------------------------------------------------------------
+//
+// TypeCatalogItemCopy - copy of a dirty catalog item, to be saved without holding the catalog semaphore
+//
+typedef struct TypeCatalogItemCopy
+{
+  char*                        type;
+  int                          entities;
+  int                          attrs;
+  const char**                 attrNameV;
+  int*                         attrCountV;
+  struct TypeCatalogItemCopy*  next;
+} TypeCatalogItemCopy;
+
+
+
+// ----------------------------------------------------------------------------
+//
+// itemCopy -
+//
+// Attributes no entity has anymore are left out of the copy, so they disappear from the database.
+//
+static TypeCatalogItemCopy* itemCopy(OrionldTypeCatalogItem* itemP)
+{
+  TypeCatalogItemCopy* copyP = (TypeCatalogItemCopy*) kaAlloc(&orionldState.kalloc, sizeof(TypeCatalogItemCopy));
+  int                  attrs = 0;
+
+  for (OrionldTypeCatalogAttribute* attrP = itemP->attrList; attrP != NULL; attrP = attrP->next)
+    ++attrs;
+
+  copyP->type       = kaStrdup(&orionldState.kalloc, itemP->type);
+  copyP->entities   = itemP->entities;
+  copyP->attrs      = 0;
+  copyP->attrNameV  = (const char**) kaAlloc(&orionldState.kalloc, (attrs + 1) * sizeof(char*));
+  copyP->attrCountV = (int*) kaAlloc(&orionldState.kalloc, (attrs + 1) * sizeof(int));
+
+  for (OrionldTypeCatalogAttribute* attrP = itemP->attrList; attrP != NULL; attrP = attrP->next)
+  {
+    if (attrP->entities <= 0)
+      continue;
+
+    copyP->attrNameV[copyP->attrs]  = kaStrdup(&orionldState.kalloc, attrP->name);
+    copyP->attrCountV[copyP->attrs] = attrP->entities;
+    ++copyP->attrs;
+  }
+
+  return copyP;
+}
+
+
+
+// ----------------------------------------------------------------------------
+//
+// tenantFlush -
+//
+// The dirty items are copied (and marked as clean) under the semaphore of the catalog, and saved after
+// releasing it, so that entity updates aren't held up by the database.
+// Items that fail to be saved are marked as dirty again, to be retried in the next flush.
+//
+static void tenantFlush(OrionldTenant* tenantP)
+{
+  OrionldTypeCatalog*  catalogP = &tenantP->typeCatalog;
+  TypeCatalogItemCopy* copyList = NULL;
+
+  sem_wait(&catalogP->sem);
+
+  if ((catalogP->loaded == false) || (catalogP->dirty == false))
+  {
+    sem_post(&catalogP->sem);
+    return;
+  }
+
+  for (int bucket = 0; bucket < ORIONLD_TYPE_CATALOG_BUCKETS; bucket++)
+  {
+    for (OrionldTypeCatalogItem* itemP = catalogP->itemV[bucket]; itemP != NULL; itemP = itemP->next)
+    {
+      if (itemP->dirty == false)
+        continue;
+
+      TypeCatalogItemCopy* copyP = itemCopy(itemP);
+
+      copyP->next  = copyList;
+      copyList     = copyP;
+      itemP->dirty = false;
+    }
+  }
+
+  catalogP->dirty = false;
+  sem_post(&catalogP->sem);
+
+  for (TypeCatalogItemCopy* copyP = copyList; copyP != NULL; copyP = copyP->next)
+  {
+    if (dbTypeCatalogItemSave(tenantP, copyP->type, copyP->entities, copyP->attrNameV, copyP->attrCountV, copyP->attrs) == true)
+      continue;
+
+    LM_E(("Database Error (unable to save the type catalog item '%s' of tenant '%s')", copyP->type, tenantP->tenant));
+
+    sem_wait(&catalogP->sem);
+
+    OrionldTypeCatalogItem* itemP = dbTypeCatalogItemGet(catalogP, copyP->type, false);
+
+    if (itemP != NULL)
+    {
+      itemP->dirty    = true;
+      catalogP->dirty = true;
+    }
+
+    sem_post(&catalogP->sem);
+  }
+}
+
+
+
+// ----------------------------------------------------------------------------
+//
+// dbTypeCatalogFlush -
+//
+// Called by the type catalog flush thread (see dbTypeCatalogInit) and at broker exit.
+//
+// As the database layer uses the thread-local orionldState (KjNode allocation), orionldState is
+// initialized here and its allocation buffer is reset when done.
+//
+void dbTypeCatalogFlush(void)
+{
+  orionldStateInit();
+
+  tenantFlush(&tenant0);
+
+  for (OrionldTenant* tenantP = __atomic_load_n(&tenantList, __ATOMIC_ACQUIRE); tenantP != NULL; tenantP = tenantP->listNext)
+    tenantFlush(tenantP);
+
+  orionldStateRelease();
+  kaBufferReset(&orionldState.kalloc, false);
+}
@@ -0,0 +1,81 @@
+/*
+*
+* Copyright 2021 FIWARE Foundation e.V.
+*
+* This file is part of Orion-LD Context Broker.
+*
+* Orion-LD Context Broker is free software: you can redistribute it and/or
+* modify it under the terms of the GNU Affero General Public License as
+* published by the Free Software Foundation, either version 3 of the
+* License, or (at your option) any later version.
+*
+* Orion-LD Context Broker is distributed in the hope that it will be useful,
+* but WITHOUT ANY WARRANTY; without even the implied warranty of
+* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU Affero
+* General Public License for more details.
+*
+* You should have received a copy of the GNU Affero General Public License
+* along with Orion-LD Context Broker. If not, see http://www.gnu.org/licenses/.
+*
+* For those usages not covered by this license please contact with
+* orionld at fiware dot org
+*
+* Author: Ken Zangelin
+*/
+#include <unistd.h>                                              // sleep
+#include <pthread.h>                                             // pthread_create
+
+#include "logMsg/logMsg.h"                                       // LM_*
+#include "logMsg/traceLevels.h"                                  // Lmt*
+
+#include "orionld/db/dbTypeCatalogFlush.h"                       // dbTypeCatalogFlush
+#include "orionld/db/dbTypeCatalogInit.h"                        // Own interface
+
+
+
+// -----------------------------------------------------------------------------
+//
+// dbTypeCatalogFlushInterval -
+//
+static int dbTypeCatalogFlushInterval = 1;
+
+
+
+// -----------------------------------------------------------------------------
+//
+// dbTypeCatalogFlushThread -
+//
+static void* dbTypeCatalogFlushThread(void* vP)
+{
+  while (1)
+  {
+    sleep(dbTypeCatalogFlushInterval);
+    dbTypeCatalogFlush();
+  }
+
+  return NULL;
+}
+
+
+
+// -----------------------------------------------------------------------------
+//
+// dbTypeCatalogInit -
+//
+// The type catalog of each tenant (OrionldTenant::typeCatalog) is loaded on first use and modified in memory
+// by the entity operations. This thread saves the modified items in the "entityTypes" collection of the
+// tenant every 'flushInterval' seconds (write-behind), so that a restarted broker needn't rebuild the catalogs
+// from the entities collections.
+//
+void dbTypeCatalogInit(int flushInterval)
+{
+  pthread_t  tid;
+
+  if (flushInterval > 0)
+    dbTypeCatalogFlushInterval = flushInterval;
+
+  if (pthread_create(&tid, NULL, dbTypeCatalogFlushThread, NULL) != 0)
+    LM_X(1, ("Fatal Error (error creating the thread for the type catalog flush)"));
+
+  pthread_detach(tid);
+}
@@ -0,0 +1,77 @@
+/*
+*
+* Copyright 2021 FIWARE Foundation e.V.
+*
+* This file is part of Orion-LD Context Broker.
+*
+* Orion-LD Context Broker is free software: you can redistribute it and/or
+* modify it under the terms of the GNU Affero General Public License as
+* published by the Free Software Foundation, either version 3 of the
+* License, or (at your option) any later version.
+*
+* Orion-LD Context Broker is distributed in the hope that it will be useful,
+* but WITHOUT ANY WARRANTY; without even the implied warranty of
+* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU Affero
+* General Public License for more details.
+*
+* You should have received a copy of the GNU Affero General Public License
+* along with Orion-LD Context Broker. If not, see http://www.gnu.org/licenses/.
+*
+* For those usages not covered by this license please contact with
+* orionld at fiware dot org
+*
+* Author: Ken Zangelin
+*/
+#include <stdlib.h>                                              // calloc, free
+#include <string.h>                                              // strcmp, strdup
+
+#include "logMsg/logMsg.h"                                       // LM_*
+#include "logMsg/traceLevels.h"                                  // Lmt*
+
+#include "orionld/types/OrionldTypeCatalog.h"                    // OrionldTypeCatalog, OrionldTypeCatalogItem
+#include "orionld/common/orionldTenantHash.h"                    // orionldTenantHash
+#include "orionld/db/dbTypeCatalogItemGet.h"                     // Own interface
+
+
+
+// ----------------------------------------------------------------------------
+//
+// dbTypeCatalogItemGet -
+//
+// The items are allocated with malloc, as they live as long as the broker.
+// Items are never removed, not even when their entity count drops to zero - the same types tend to come back.
+//
+OrionldTypeCatalogItem* dbTypeCatalogItemGet(OrionldTypeCatalog* catalogP, const char* entityType, bool create)
+{
+  unsigned int bucket = orionldTenantHash(entityType) % ORIONLD_TYPE_CATALOG_BUCKETS;
+
+  for (OrionldTypeCatalogItem* itemP = catalogP->itemV[bucket]; itemP != NULL; itemP = itemP->next)
+  {
+    if (strcmp(itemP->type, entityType) == 0)
+      return itemP;
+  }
+
+  if (create == false)
+    return NULL;
+
+  OrionldTypeCatalogItem* itemP = (OrionldTypeCatalogItem*) calloc(1, sizeof(OrionldTypeCatalogItem));
+
+  if (itemP == NULL)
+  {
+    LM_E(("Out of memory (allocating a type catalog item for entity type '%s')", entityType));
+    return NULL;
+  }
+
+  itemP->type = strdup(entityType);
+  if (itemP->type == NULL)
+  {
+    LM_E(("Out of memory (allocating a type catalog item for entity type '%s')", entityType));
+    free(itemP);
+    return NULL;
+  }
+
+  itemP->next              = catalogP->itemV[bucket];
+  catalogP->itemV[bucket]  = itemP;
+
+  return itemP;
+}
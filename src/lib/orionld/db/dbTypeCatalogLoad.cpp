@@ -0,0 +1,143 @@
+/*
+*
+* Copyright 2021 FIWARE Foundation e.V.
+*
+* This file is part of Orion-LD Context Broker.
+*
+* Orion-LD Context Broker is free software: you can redistribute it and/or
+* modify it under the terms of the GNU Affero General Public License as
+* published by the Free Software Foundation, either version 3 of the
+* License, or (at your option) any later version.
+*
+* Orion-LD Context Broker is distributed in the hope that it will be useful,
+* but WITHOUT ANY WARRANTY; without even the implied warranty of
+* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU Affero
+* General Public License for more details.
+*
+* You should have received a copy of the GNU Affero General Public License
+* along with Orion-LD Context Broker. If not, see http://www.gnu.org/licenses/.
+*
+* For those usages not covered by this license please contact with
+* orionld at fiware dot org
+*
+* Author: Ken Zangelin
+*/
+extern "C"
+{
+#include "kjson/KjNode.h"                                        // KjNode
+#include "kjson/kjLookup.h"                                      // kjLookup
+}
+
+#include "logMsg/logMsg.h"                                       // LM_*
+#include "logMsg/traceLevels.h"                                  // Lmt*
+
+#include "orionld/types/OrionldTenant.h"                         // OrionldTenant
+#include "orionld/types/OrionldTypeCatalog.h"                    // OrionldTypeCatalog, ORIONLD_TYPE_CATALOG_BUCKETS
+#include "orionld/db/dbConfiguration.h"                          // dbTypeCatalogGet, dbEntityTypesAndAttrNamesIterate
+#include "orionld/db/dbTypeCatalogCount.h"                       // dbTypeCatalogCount
+#include "orionld/db/dbTypeCatalogRelease.h"                     // dbTypeCatalogRelease
+#include "orionld/db/dbTypeCatalogLoad.h"                        // Own interface
+
+
+
+// ----------------------------------------------------------------------------
+//
+// entityCount - callback for dbEntityTypesAndAttrNamesIterate
+//
+static void entityCount(void* userP, const char* entityType, const char** attrNameV, int attrs)
+{
+  dbTypeCatalogCount((OrionldTypeCatalog*) userP, entityType, 1, attrNameV, attrs, 1);
+}
+
+
+
+// ----------------------------------------------------------------------------
+//
+// catalogFromDocs - fill a type catalog from the documents of the "entityTypes" collection
+//
+// Format of the documents:
+//   { "_id": <entity type>, "entities": <count>, "attrs": [ { "name": <attribute name>, "entities": <count> }, ... ] }
+//
+static void catalogFromDocs(OrionldTypeCatalog* catalogP, KjNode* docArray)
+{
+  for (KjNode* docP = docArray->value.firstChildP; docP != NULL; docP = docP->next)
+  {
+    KjNode* typeP     = kjLookup(docP, "_id");
+    KjNode* entitiesP = kjLookup(docP, "entities");
+    KjNode* attrsP    = kjLookup(docP, "attrs");
+
+    if ((typeP == NULL) || (typeP->type != KjString) || (entitiesP == NULL) || (entitiesP->type != KjInt))
+    {
+      LM_W(("Invalid document in the entityTypes collection - skipped"));
+      continue;
+    }
+
+    dbTypeCatalogCount(catalogP, typeP->value.s, entitiesP->value.i, NULL, 0, 0);
+
+    if ((attrsP == NULL) || (attrsP->type != KjArray))
+      continue;
+
+    for (KjNode* attrP = attrsP->value.firstChildP; attrP != NULL; attrP = attrP->next)
+    {
+      KjNode* nameP  = kjLookup(attrP, "name");
+      KjNode* countP = kjLookup(attrP, "entities");
+
+      if ((nameP == NULL) || (nameP->type != KjString) || (countP == NULL) || (countP->type != KjInt))
+        continue;
+
+      const char* attrName = nameP->value.s;
+
+      dbTypeCatalogCount(catalogP, typeP->value.s, 0, &attrName, 1, countP->value.i);
+    }
+  }
+
+  //
+  // What was just read from the database is not dirty
+  //
+  for (int bucket = 0; bucket < ORIONLD_TYPE_CATALOG_BUCKETS; bucket++)
+  {
+    for (OrionldTypeCatalogItem* itemP = catalogP->itemV[bucket]; itemP != NULL; itemP = itemP->next)
+      itemP->dirty = false;
+  }
+
+  catalogP->dirty = false;
+}
+
+
+
+// ----------------------------------------------------------------------------
+//
+// dbTypeCatalogLoad -
+//
+// The catalog is read from the "entityTypes" collection of the tenant.
+// If that collection is empty (first start of a broker with a type catalog, or a tenant without entities),
+// the catalog is built, once, from the "entities" collection, and it is saved by the next flush.
+//
+// Entities created/modified by other requests while the catalog is being built from the entities collection
+// may be counted twice (or not at all). The catalog is a cache for GET /types, so that is acceptable.
+//
+bool dbTypeCatalogLoad(OrionldTenant* tenantP)
+{
+  OrionldTypeCatalog* catalogP = &tenantP->typeCatalog;
+  KjNode*             docArray = dbTypeCatalogGet(tenantP);
+
+  if ((docArray != NULL) && (docArray->value.firstChildP != NULL))
+  {
+    catalogFromDocs(catalogP, docArray);
+    LM_T(LmtMongo, ("Type catalog of tenant '%s' loaded from the entityTypes collection", tenantP->tenant));
+  }
+  else
+  {
+    if (dbEntityTypesAndAttrNamesIterate(tenantP, entityCount, catalogP) == false)
+    {
+      LM_E(("Database Error (unable to build the type catalog of tenant '%s')", tenantP->tenant));
+      dbTypeCatalogRelease(catalogP);
+      return false;
+    }
+
+    LM_T(LmtMongo, ("Type catalog of tenant '%s' built from the entities collection", tenantP->tenant));
+  }
+
+  catalogP->loaded = true;
+  return true;
+}
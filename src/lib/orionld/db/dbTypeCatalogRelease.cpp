@@ -0,0 +1,69 @@
+/*
+*
+* Copyright 2021 FIWARE Foundation e.V.
+*
+* This file is part of Orion-LD Context Broker.
+*
+* Orion-LD Context Broker is free software: you can redistribute it and/or
+* modify it under the terms of the GNU Affero General Public License as
+* published by the Free Software Foundation, either version 3 of the
+* License, or (at your option) any later version.
+*
+* Orion-LD Context Broker is distributed in the hope that it will be useful,
+* but WITHOUT ANY WARRANTY; without even the implied warranty of
+* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU Affero
+* General Public License for more details.
+*
+* You should have received a copy of the GNU Affero General Public License
+* along with Orion-LD Context Broker. If not, see http://www.gnu.org/licenses/.
+*
+* For those usages not covered by this license please contact with
+* orionld at fiware dot org
+*
+* Author: Ken Zangelin
+*/
+#include <stdlib.h>                                              // free
+
+#include "orionld/types/OrionldTypeCatalog.h"                    // OrionldTypeCatalog, ORIONLD_TYPE_CATALOG_BUCKETS
+#include "orionld/db/dbTypeCatalogRelease.h"                     // Own interface
+
+
+
+// ----------------------------------------------------------------------------
+//
+// dbTypeCatalogRelease -
+//
+// Used to throw away whatever a failed build left in a catalog, and at broker exit.
+// The catalog is left empty and not loaded.
+//
+void dbTypeCatalogRelease(OrionldTypeCatalog* catalogP)
+{
+  for (int bucket = 0; bucket < ORIONLD_TYPE_CATALOG_BUCKETS; bucket++)
+  {
+    OrionldTypeCatalogItem* itemP = catalogP->itemV[bucket];
+
+    while (itemP != NULL)
+    {
+      OrionldTypeCatalogItem*      nextItemP = itemP->next;
+      OrionldTypeCatalogAttribute* attrP     = itemP->attrList;
+
+      while (attrP != NULL)
+      {
+        OrionldTypeCatalogAttribute* nextAttrP = attrP->next;
+
+        free(attrP->name);
+        free(attrP);
+        attrP = nextAttrP;
+      }
+
+      free(itemP->type);
+      free(itemP);
+      itemP = nextItemP;
+    }
+
+    catalogP->itemV[bucket] = NULL;
+  }
+
+  catalogP->dirty  = false;
+  catalogP->loaded = false;
+}
@@ -0,0 +1,109 @@
+/*
+*
+* Copyright 2021 FIWARE Foundation e.V.
+*
+* This file is part of Orion-LD Context Broker.
+*
+* Orion-LD Context Broker is free software: you can redistribute it and/or
+* modify it under the terms of the GNU Affero General Public License as
+* published by the Free Software Foundation, either version 3 of the
+* License, or (at your option) any later version.
+*
+* Orion-LD Context Broker is distributed in the hope that it will be useful,
+* but WITHOUT ANY WARRANTY; without even the implied warranty of
+* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU Affero
+* General Public License for more details.
+*
+* You should have received a copy of the GNU Affero General Public License
+* along with Orion-LD Context Broker. If not, see http://www.gnu.org/licenses/.
+*
+* For those usages not covered by this license please contact with
+* orionld at fiware dot org
+*
+* Author: Ken Zangelin
+*/
+#include <semaphore.h>                                           // sem_wait, sem_post
+
+extern "C"
+{
+#include "kjson/KjNode.h"                                        // KjNode
+#include "kjson/kjBuilder.h"                                     // kjArray, kjObject, kjString, kjChildAdd
+}
+
+#include "logMsg/logMsg.h"                                       // LM_*
+#include "logMsg/traceLevels.h"                                  // Lmt*
+
+#include "orionld/types/OrionldTenant.h"                         // OrionldTenant
+#include "orionld/types/OrionldTypeCatalog.h"                    // OrionldTypeCatalog, ORIONLD_TYPE_CATALOG_BUCKETS
+#include "orionld/common/orionldState.h"                         // orionldState, tenant0
+#include "orionld/common/orionldTenantLookup.h"                  // orionldTenantLookup
+#include "orionld/db/dbTypeCatalogLoad.h"                        // dbTypeCatalogLoad
+#include "orionld/db/dbTypeCatalogTypesGet.h"                    // Own interface
+
+
+
+// ----------------------------------------------------------------------------
+//
+// dbTypeCatalogTypesGet -
+//
+// The names in the result point to the catalog items - they are never freed, so no copies are needed.
+// Types and attributes with an entity count of zero are skipped.
+//
+KjNode* dbTypeCatalogTypesGet(bool details)
+{
+  OrionldTenant* tenantP = orionldState.tenantP;
+
+  if (tenantP == NULL)
+  {
+    if ((orionldState.tenant == NULL) || (orionldState.tenant[0] == 0))
+      tenantP = &tenant0;
+    else if ((tenantP = orionldTenantLookup(orionldState.tenant)) == NULL)
+      return NULL;  // A tenant that doesn't exist has no entities
+  }
+
+  OrionldTypeCatalog* catalogP  = &tenantP->typeCatalog;
+  KjNode*             typeArray = NULL;
+
+  sem_wait(&catalogP->sem);
+
+  if ((catalogP->loaded == false) && (dbTypeCatalogLoad(tenantP) == false))
+  {
+    sem_post(&catalogP->sem);
+    return NULL;
+  }
+
+  for (int bucket = 0; bucket < ORIONLD_TYPE_CATALOG_BUCKETS; bucket++)
+  {
+    for (OrionldTypeCatalogItem* itemP = catalogP->itemV[bucket]; itemP != NULL; itemP = itemP->next)
+    {
+      if (itemP->entities <= 0)
+        continue;
+
+      if (typeArray == NULL)
+        typeArray = kjArray(orionldState.kjsonP, NULL);
+
+      if (details == false)
+      {
+        kjChildAdd(typeArray, kjString(orionldState.kjsonP, NULL, itemP->type));
+        continue;
+      }
+
+      KjNode* typeP      = kjObject(orionldState.kjsonP, NULL);
+      KjNode* attrArrayP = kjArray(orionldState.kjsonP, "attributeNames");
+
+      for (OrionldTypeCatalogAttribute* attrP = itemP->attrList; attrP != NULL; attrP = attrP->next)
+      {
+        if (attrP->entities > 0)
+          kjChildAdd(attrArrayP, kjString(orionldState.kjsonP, NULL, attrP->name));
+      }
+
+      kjChildAdd(typeP, kjString(orionldState.kjsonP, "id", itemP->type));
+      kjChildAdd(typeP, attrArrayP);
+      kjChildAdd(typeArray, typeP);
+    }
+  }
+
+  sem_post(&catalogP->sem);
+
+  return typeArray;
+}
@@ -0,0 +1,76 @@
+/*
+*
+* Copyright 2021 FIWARE Foundation e.V.
+*
+* This file is part of Orion-LD Context Broker.
+*
+* Orion-LD Context Broker is free software: you can redistribute it and/or
+* modify it under the terms of the GNU Affero General Public License as
+* published by the Free Software Foundation, either version 3 of the
+* License, or (at your option) any later version.
+*
+* Orion-LD Context Broker is distributed in the hope that it will be useful,
+* but WITHOUT ANY WARRANTY; without even the implied warranty of
+* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU Affero
+* General Public License for more details.
+*
+* You should have received a copy of the GNU Affero General Public License
+* along with Orion-LD Context Broker. If not, see http://www.gnu.org/licenses/.
+*
+* For those usages not covered by this license please contact with
+* orionld at fiware dot org
+*
+* Author: Ken Zangelin
+*/
+#include <semaphore.h>                                           // sem_wait, sem_post
+
+#include "logMsg/logMsg.h"                                       // LM_*
+#include "logMsg/traceLevels.h"                                  // Lmt*
+
+#include "orionld/types/OrionldTenant.h"                         // OrionldTenant
+#include "orionld/common/orionldState.h"                         // orionldState, tenant0
+#include "orionld/common/orionldTenantLookup.h"                  // orionldTenantLookup
+#include "orionld/db/dbTypeCatalogLoad.h"                        // dbTypeCatalogLoad
+#include "orionld/db/dbTypeCatalogCount.h"                       // dbTypeCatalogCount
+#include "orionld/db/dbTypeCatalogUpdate.h"                      // Own interface
+
+
+
+// ----------------------------------------------------------------------------
+//
+// dbTypeCatalogUpdate -
+//
+// If the catalog of the tenant isn't loaded yet, it is loaded here, and as the entity is already
+// in the database, the load includes this very modification - the deltas are not applied.
+//
+void dbTypeCatalogUpdate(const char* entityType, int entityDelta, const char** addedV, int added, const char** removedV, int removed)
+{
+  OrionldTenant* tenantP = orionldState.tenantP;
+
+  if (entityType == NULL)
+    return;
+
+  if (tenantP == NULL)
+  {
+    if ((orionldState.tenant == NULL) || (orionldState.tenant[0] == 0))
+      tenantP = &tenant0;
+    else if ((tenantP = orionldTenantLookup(orionldState.tenant)) == NULL)
+      return;
+  }
+
+  OrionldTypeCatalog* catalogP = &tenantP->typeCatalog;
+
+  sem_wait(&catalogP->sem);
+
+  if (catalogP->loaded == false)
+    dbTypeCatalogLoad(tenantP);
+  else
+  {
+    dbTypeCatalogCount(catalogP, entityType, entityDelta, addedV, added, 1);
+
+    if (removed > 0)
+      dbTypeCatalogCount(catalogP, entityType, 0, removedV, removed, -1);
+  }
+
+  sem_post(&catalogP->sem);
+}
@@ -0,0 +1,40 @@
+#ifndef SRC_LIB_ORIONLD_DB_DBTYPECATALOGUPDATE_H_
+#define SRC_LIB_ORIONLD_DB_DBTYPECATALOGUPDATE_H_
+
+/*
+*
+* Copyright 2021 FIWARE Foundation e.V.
+*
+* This file is part of Orion-LD Context Broker.
+*
+* Orion-LD Context Broker is free software: you can redistribute it and/or
+* modify it under the terms of the GNU Affero General Public License as
+* published by the Free Software Foundation, either version 3 of the
+* License, or (at your option) any later version.
+*
+* Orion-LD Context Broker is distributed in the hope that it will be useful,
+* but WITHOUT ANY WARRANTY; without even the implied warranty of
+* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU Affero
+* General Public License for more details.
+*
+* You should have received a copy of the GNU Affero General Public License
+* along with Orion-LD Context Broker. If not, see http://www.gnu.org/licenses/.
+*
+* For those usages not covered by this license please contact with
+* orionld at fiware dot org
+*
+* Author: Ken Zangelin
+*/
+// ----------------------------------------------------------------------------
+//
+// dbTypeCatalogUpdate - apply the effect of an entity create/update/delete to the type catalog of the current tenant
+//
+// entityDelta:  +1 for a new entity, -1 for a deleted entity, 0 for a modified entity
+// addedV:       attributes that the entity now has and didn't have before
+// removedV:     attributes that the entity had and doesn't have anymore
+//
+// Must be called AFTER the entity has been written to the database.
+//
+extern void dbTypeCatalogUpdate(const char* entityType, int entityDelta, const char** addedV, int added, const char** removedV, int removed);
+
+#endif  // SRC_LIB_ORIONLD_DB_DBTYPECATALOGUPDATE_H_
@@ -0,0 +1,128 @@
+/*
+*
+* Copyright 2021 FIWARE Foundation e.V.
+*
+* This file is part of Orion-LD Context Broker.
+*
+* Orion-LD Context Broker is free software: you can redistribute it and/or
+* modify it under the terms of the GNU Affero General Public License as
+* published by the Free Software Foundation, either version 3 of the
+* License, or (at your option) any later version.
+*
+* Orion-LD Context Broker is distributed in the hope that it will be useful,
+* but WITHOUT ANY WARRANTY; without even the implied warranty of
+* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU Affero
+* General Public License for more details.
+*
+* You should have received a copy of the GNU Affero General Public License
+* along with Orion-LD Context Broker. If not, see http://www.gnu.org/licenses/.
+*
+* For those usages not covered by this license please contact with
+* orionld at fiware dot org
+*
+* Author: Ken Zangelin
+*/
+#include <string.h>                                                        // strlen
+#include <math.h>                                                          // fabs, log10
+
+extern "C"
+{
+#include "kjson/kjson.h"                                                   // Kjson
+#include "kjson/KjNode.h"                                                  // KjNode
+}
+
+#include "orionld/kjTree/kjTreeRenderSize.h"                               // Own interface
+
+
+
+// ----------------------------------------------------------------------------
+//
+// stringRenderSize - size of a string, quotes included, with all characters that may need escaping counted as escaped
+//
+static long unsigned int stringRenderSize(const char* s)
+{
+  long unsigned int size = 2;  // The quotes
+
+  while (*s != 0)
+  {
+    unsigned char c = (unsigned char) *s;
+
+    if ((c == '"') || (c == '\\'))
+      size += 2;
+    else if (c < 0x20)
+      size += 6;  // \u00XX
+    else
+      size += 1;
+
+    ++s;
+  }
+
+  return size;
+}
+
+
+
+// ----------------------------------------------------------------------------
+//
+// nodeRenderSize -
+//
+static long unsigned int nodeRenderSize(KjNode* nodeP, int level, int indent, int nlLen, int colonLen)
+{
+  //
+  // Indentation and newline for the node itself plus a comma, the name, and the colon with its surrounding strings
+  //
+  long unsigned int size = level * indent + nlLen + 1;
+
+  if (nodeP->name != NULL)
+    size += stringRenderSize(nodeP->name) + colonLen;
+
+  switch (nodeP->type)
+  {
+  case KjString:   size += stringRenderSize(nodeP->value.s); break;
+  case KjInt:      size += 21;                                break;  // -9223372036854775808
+  case KjBoolean:  size += 5;                                 break;
+  case KjNull:     size += 4;                                 break;
+  case KjNone:     size += 4;                                 break;
+
+  case KjFloat:
+    size += 32;
+    if (fabs(nodeP->value.f) >= 1e15)  // %f of a really big number - one char per digit
+      size += (long unsigned int) log10(fabs(nodeP->value.f));
+    break;
+
+  case KjObject:
+  case KjArray:
+    size += 2 + nlLen + level * indent;  // Brackets + newline and indentation before the closing bracket
+    for (KjNode* childP = nodeP->value.firstChildP; childP != NULL; childP = childP->next)
+    {
+      size += nodeRenderSize(childP, level + 1, indent, nlLen, colonLen);
+    }
+    break;
+  }
+
+  return size;
+}
+
+
+
+// ----------------------------------------------------------------------------
+//
+// kjTreeRenderSize -
+//
+// The tree is traversed once, without rendering anything, and the result is never smaller than what
+// kjRender/kjFastRender produce for the same tree. Numbers are counted at their maximum length.
+//
+long unsigned int kjTreeRenderSize(Kjson* kjP, KjNode* nodeP)
+{
+  if (nodeP == NULL)
+    return 1;
+
+  int indent   = kjP->spacesPerIndent;
+  int nlLen    = (kjP->nlString          != NULL)? strlen(kjP->nlString)          : 0;
+  int colonLen = 1;
+
+  if (kjP->stringBeforeColon != NULL) colonLen += strlen(kjP->stringBeforeColon);
+  if (kjP->stringAfterColon  != NULL) colonLen += strlen(kjP->stringAfterColon);
+
+  return nodeRenderSize(nodeP, 0, indent, nlLen, colonLen) + 1;  // + 1: the zero-termination
+}
@@ -0,0 +1,459 @@
+/*
+*
+* Copyright 2021 FIWARE Foundation e.V.
+*
+* This file is part of Orion-LD Context Broker.
+*
+* Orion-LD Context Broker is free software: you can redistribute it and/or
+* modify it under the terms of the GNU Affero General Public License as
+* published by the Free Software Foundation, either version 3 of the
+* License, or (at your option) any later version.
+*
+* Orion-LD Context Broker is distributed in the hope that it will be useful,
+* but WITHOUT ANY WARRANTY; without even the implied warranty of
+* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU Affero
+* General Public License for more details.
+*
+* You should have received a copy of the GNU Affero General Public License
+* along with Orion-LD Context Broker. If not, see http://www.gnu.org/licenses/.
+*
+* For those usages not covered by this license please contact with
+* orionld at fiware dot org
+*
+* Author: Ken Zangelin
+*/
+#include <string>
+#include <vector>
+#include <map>
+#include <set>
+
+#include "mongo/client/dbclient.h"                               // MongoDB C++ Client Legacy Driver
+
+#include "logMsg/logMsg.h"                                       // LM_*
+#include "logMsg/traceLevels.h"                                  // Lmt*
+
+#include "common/statistics.h"                                   // TIME_STAT_MONGO_*
+#include "alarmMgr/alarmMgr.h"                                   // alarmMgr
+#include "ngsi10/UpdateContextRequest.h"                         // UpdateContextRequest
+#include "ngsi10/UpdateContextResponse.h"                        // UpdateContextResponse
+#include "mongoBackend/safeMongo.h"                              // getObjectFieldF, getStringFieldF, ...
+#include "mongoBackend/dbConstants.h"                            // ENT_ENTITY_ID, ...
+#include "mongoBackend/MongoGlobal.h"                            // getMongoConnection, releaseMongoConnection, ...
+#include "mongoBackend/connectionOperations.h"                   // collectionQuery
+
+#include "orionld/mongoBackend/mongoLdBatch.h"                   // Own Interface
+
+
+
+// -----------------------------------------------------------------------------
+//
+// MongoLdBatchOp - one write operation of the bulk
+//
+typedef struct MongoLdBatchOp
+{
+  std::string     entityId;
+  bool            insert;    // insert of 'doc' if true, else update of the entity matching 'query', with 'doc'
+  mongo::BSONObj  query;
+  mongo::BSONObj  doc;
+} MongoLdBatchOp;
+
+
+
+// -----------------------------------------------------------------------------
+//
+// MongoLdBatchDeferred - work on an entity that is deferred until the bulk write has been executed
+//
+typedef struct MongoLdBatchDeferred
+{
+  std::string           entityId;
+  MongoLdBatchCallback  callback;
+  void*                 dataP;
+} MongoLdBatchDeferred;
+
+
+
+// -----------------------------------------------------------------------------
+//
+// MongoLdBatch - the state of an ongoing batch operation
+//
+typedef struct MongoLdBatch
+{
+  std::string                                           collection;
+  std::map<std::string, std::vector<mongo::BSONObj> >   entities;   // Entity ID => entities in DB with that ID, before the batch
+  std::vector<MongoLdBatchOp>                           ops;
+  std::vector<MongoLdBatchDeferred>                     deferred;   // Notifications and type catalog updates, in order
+} MongoLdBatch;
+
+
+
+// -----------------------------------------------------------------------------
+//
+// batchP - the batch of the current request (thread)
+//
+static __thread MongoLdBatch* batchP = NULL;
+
+
+
+// -----------------------------------------------------------------------------
+//
+// mongoLdBatchStart -
+//
+// Called by mongoUpdateContext before processing the context elements of an NGSI-LD batch request.
+// All entities of the batch that already exist are extracted from the database in ONE query (_id.id $in [...]).
+//
+// Batch mode is not entered (MongoLdBatchOff is returned) if the same entity ID appears more than once in the batch,
+// as the writes of an unordered bulk may be executed in any order, or if the initial query fails.
+// In both cases the context elements are processed one by one, just like any non-batch request.
+//
+// If instead the query breaks while its results are read, it is unknown which entities already exist,
+// and the batch is aborted (MongoLdBatchAborted) - the entities must not be inserted blindly.
+//
+MongoLdBatchMode mongoLdBatchStart(UpdateContextRequest* requestP, const std::string& tenant, const std::vector<std::string>& servicePathV)
+{
+  MongoLdBatch*            bP = new MongoLdBatch();
+  mongo::BSONArrayBuilder  idList;
+
+  for (unsigned int ix = 0; ix < requestP->contextElementVector.size(); ++ix)
+  {
+    const std::string& entityId = requestP->contextElementVector[ix]->entityId.id;
+
+    if (bP->entities.find(entityId) != bP->entities.end())
+    {
+      LM_T(LmtMongo, ("Entity '%s' more than once in the batch - no bulk write", entityId.c_str()));
+      delete bP;
+      return MongoLdBatchOff;
+    }
+
+    bP->entities[entityId] = std::vector<mongo::BSONObj>();
+    idList.append(entityId);
+  }
+
+  mongo::BSONObjBuilder  bob;
+
+  bob.append("_id." ENT_ENTITY_ID, BSON("$in" << idList.arr()));
+  bob.append("_id." ENT_SERVICE_PATH, fillQueryServicePath(servicePathV));
+
+  mongo::BSONObj                        query = bob.obj();
+  std::auto_ptr<mongo::DBClientCursor>  cursor;
+  std::string                           err;
+
+  bP->collection = getEntitiesCollectionName(tenant);
+
+  TIME_STAT_MONGO_READ_WAIT_START();
+  mongo::DBClientBase* connection = getMongoConnection();
+
+  if (!collectionQuery(connection, bP->collection, query, &cursor, &err))
+  {
+    releaseMongoConnection(connection);
+    TIME_STAT_MONGO_READ_WAIT_STOP();
+    LM_E(("Database Error (batch entity lookup: %s)", err.c_str()));
+    delete bP;
+    return MongoLdBatchOff;
+  }
+  TIME_STAT_MONGO_READ_WAIT_STOP();
+
+  while (moreSafe(cursor))
+  {
+    mongo::BSONObj r;
+
+    if (!nextSafeOrErrorF(cursor, &r, &err))
+    {
+      LM_E(("Runtime Error (exception in nextSafe(): %s - query: %s)", err.c_str(), query.toString().c_str()));
+      releaseMongoConnection(connection);
+      delete bP;
+      return MongoLdBatchAborted;
+    }
+
+    mongo::BSONObj  idObj    = getObjectFieldF(r, "_id");
+    std::string     entityId = getStringFieldF(idObj, ENT_ENTITY_ID);
+
+    // getOwned(), as the BSONObj must survive the cursor
+    bP->entities[entityId].push_back(r.getOwned());
+  }
+
+  releaseMongoConnection(connection);
+
+  batchP = bP;
+  return MongoLdBatchOn;
+}
+
+
+
+// -----------------------------------------------------------------------------
+//
+// mongoLdBatchLookup -
+//
+// Replaces the per-entity query of processContextElement while a batch is ongoing.
+// Returns false if no batch is ongoing - the caller must then query the database itself.
+//
+bool mongoLdBatchLookup(const std::string& entityId, const std::string& entityType, std::vector<mongo::BSONObj>* resultsP)
+{
+  if (batchP == NULL)
+    return false;
+
+  std::map<std::string, std::vector<mongo::BSONObj> >::iterator it = batchP->entities.find(entityId);
+
+  if (it == batchP->entities.end())
+    return false;  // Not part of the initial query - should not happen
+
+  for (unsigned int ix = 0; ix < it->second.size(); ++ix)
+  {
+    if (entityType != "")
+    {
+      mongo::BSONObj idObj = getObjectFieldF(it->second[ix], "_id");
+
+      if (getStringFieldF(idObj, ENT_ENTITY_TYPE) != entityType)
+        continue;
+    }
+
+    resultsP->push_back(it->second[ix]);
+  }
+
+  return true;
+}
+
+
+
+// -----------------------------------------------------------------------------
+//
+// mongoLdBatchInsert -
+//
+// Queues the insertion of an entity into the bulk.
+// Returns false if no batch is ongoing - the caller must then insert the entity itself.
+//
+bool mongoLdBatchInsert(const std::string& entityId, const mongo::BSONObj& doc)
+{
+  if (batchP == NULL)
+    return false;
+
+  MongoLdBatchOp op;
+
+  op.entityId = entityId;
+  op.insert   = true;
+  op.doc      = doc.getOwned();
+
+  batchP->ops.push_back(op);
+  return true;
+}
+
+
+
+// -----------------------------------------------------------------------------
+//
+// mongoLdBatchUpdate -
+//
+// Queues the update of an entity into the bulk.
+// Returns false if no batch is ongoing - the caller must then update the entity itself.
+//
+bool mongoLdBatchUpdate(const std::string& entityId, const mongo::BSONObj& query, const mongo::BSONObj& update)
+{
+  if (batchP == NULL)
+    return false;
+
+  MongoLdBatchOp op;
+
+  op.entityId = entityId;
+  op.insert   = false;
+  op.query    = query.getOwned();
+  op.doc      = update.getOwned();
+
+  batchP->ops.push_back(op);
+  return true;
+}
+
+
+
+// -----------------------------------------------------------------------------
+//
+// mongoLdBatchOngoing -
+//
+bool mongoLdBatchOngoing(void)
+{
+  return (batchP != NULL);
+}
+
+
+
+// -----------------------------------------------------------------------------
+//
+// mongoLdBatchDefer -
+//
+// Queues work on an entity (notifications, type catalog update) that must wait for the outcome of the bulk write.
+// mongoLdBatchExecute calls 'callback' once the bulk has been executed - with 'written' false if the write of
+// the entity failed.
+// Returns false if no batch is ongoing - the caller must then do the work itself, right away.
+//
+bool mongoLdBatchDefer(const std::string& entityId, MongoLdBatchCallback callback, void* dataP)
+{
+  if (batchP == NULL)
+    return false;
+
+  MongoLdBatchDeferred deferred;
+
+  deferred.entityId = entityId;
+  deferred.callback = callback;
+  deferred.dataP    = dataP;
+
+  batchP->deferred.push_back(deferred);
+  return true;
+}
+
+
+
+// -----------------------------------------------------------------------------
+//
+// deferredRun - run the deferred work of the batch, now that the outcome of the bulk write is known
+//
+static void deferredRun(MongoLdBatch* bP, const std::set<std::string>& failedEntities)
+{
+  for (unsigned int ix = 0; ix < bP->deferred.size(); ++ix)
+  {
+    MongoLdBatchDeferred* dP      = &bP->deferred[ix];
+    bool                  written = (failedEntities.find(dP->entityId) == failedEntities.end());
+
+    dP->callback(dP->dataP, written);
+  }
+}
+
+
+
+// -----------------------------------------------------------------------------
+//
+// entityErrorSet - mark the ContextElementResponse of an entity as erroneous
+//
+static void entityErrorSet(UpdateContextResponse* responseP, const std::string& entityId, HttpStatusCode code, const std::string& details)
+{
+  for (unsigned int ix = 0; ix < responseP->contextElementResponseVector.vec.size(); ++ix)
+  {
+    ContextElementResponse* cerP = responseP->contextElementResponseVector.vec[ix];
+
+    if (cerP->contextElement.entityId.id == entityId)
+      cerP->statusCode.fill(code, details);
+  }
+}
+
+
+
+// -----------------------------------------------------------------------------
+//
+// mongoLdBatchExecute -
+//
+// Sends all queued writes to the database as ONE unordered bulk write and ends the batch.
+// The write errors of the bulk refer to the failing operation by its index, which is mapped back to
+// the entity, whose ContextElementResponse is then marked as erroneous.
+//
+// The notifications and type catalog updates of the entities were deferred (mongoLdBatchDefer) - they are
+// done once the bulk has been executed, and only for the entities whose write succeeded.
+//
+void mongoLdBatchExecute(UpdateContextResponse* responseP)
+{
+  if (batchP == NULL)
+    return;
+
+  MongoLdBatch*          bP = batchP;
+  std::set<std::string>  failedEntities;
+
+  batchP = NULL;
+
+  if (bP->ops.size() == 0)
+  {
+    deferredRun(bP, failedEntities);
+    delete bP;
+    return;
+  }
+
+  TIME_STAT_MONGO_WRITE_WAIT_START();
+  mongo::DBClientBase* connection = getMongoConnection();
+
+  if (connection == NULL)
+  {
+    TIME_STAT_MONGO_WRITE_WAIT_STOP();
+    LM_E(("Fatal Error (null DB connection)"));
+
+    for (unsigned int ix = 0; ix < bP->ops.size(); ++ix)
+    {
+      entityErrorSet(responseP, bP->ops[ix].entityId, SccReceiverInternalError, "null DB connection");
+      failedEntities.insert(bP->ops[ix].entityId);
+    }
+
+    deferredRun(bP, failedEntities);
+    delete bP;
+    return;
+  }
+
+  mongo::BulkOperationBuilder  bulk = connection->initializeUnorderedBulkOp(bP->collection);
+  mongo::WriteResult           writeResult;
+  std::string                  exceptionText;
+
+  for (unsigned int ix = 0; ix < bP->ops.size(); ++ix)
+  {
+    if (bP->ops[ix].insert == true)
+      bulk.insert(bP->ops[ix].doc);
+    else
+      bulk.find(bP->ops[ix].query).updateOne(bP->ops[ix].doc);
+  }
+
+  LM_T(LmtMongo, ("bulk write in '%s' collection: %d operations", bP->collection.c_str(), (int) bP->ops.size()));
+
+  try
+  {
+    bulk.execute(&mongo::WriteConcern::acknowledged, &writeResult);
+  }
+  catch (const std::exception& e)
+  {
+    // Write errors are thrown as an exception - the details are in writeResult
+    exceptionText = e.what();
+  }
+  catch (...)
+  {
+    exceptionText = "generic";
+  }
+
+  releaseMongoConnection(connection);
+  TIME_STAT_MONGO_WRITE_WAIT_STOP();
+
+  const std::vector<mongo::BSONObj>& writeErrors = writeResult.writeErrors();
+
+  if (writeErrors.size() > 0)
+  {
+    for (unsigned int ix = 0; ix < writeErrors.size(); ++ix)
+    {
+      int          opIx   = getIntFieldF(writeErrors[ix], "index");
+      int          code   = getIntFieldF(writeErrors[ix], "code");
+      std::string  errmsg = getStringFieldF(writeErrors[ix], "errmsg");
+
+      if ((opIx < 0) || (opIx >= (int) bP->ops.size()))
+      {
+        LM_E(("Database Error (bulk write error for unknown operation %d: %s)", opIx, errmsg.c_str()));
+        continue;
+      }
+
+      LM_E(("Database Error (bulk write of entity '%s': %s)", bP->ops[opIx].entityId.c_str(), errmsg.c_str()));
+      failedEntities.insert(bP->ops[opIx].entityId);
+
+      if (code == 11000)  // Duplicate key
+        entityErrorSet(responseP, bP->ops[opIx].entityId, SccConflict, "Already Exists");
+      else
+        entityErrorSet(responseP, bP->ops[opIx].entityId, SccReceiverInternalError, "Database Error (" + errmsg + ")");
+    }
+  }
+  else if (exceptionText != "")
+  {
+    //
+    // Not a write error of a single operation - the entire bulk failed
+    //
+    std::string details = "Database Error (collection: " + bP->collection + " - bulk write - exception: " + exceptionText + ")";
+
+    alarmMgr.dbError(details);
+    for (unsigned int ix = 0; ix < bP->ops.size(); ++ix)
+    {
+      entityErrorSet(responseP, bP->ops[ix].entityId, SccReceiverInternalError, details);
+      failedEntities.insert(bP->ops[ix].entityId);
+    }
+  }
+  else
+    LM_I(("Database Operation Successful (bulk write: %d operations)", (int) bP->ops.size()));
+
+  deferredRun(bP, failedEntities);
+  delete bP;
+}
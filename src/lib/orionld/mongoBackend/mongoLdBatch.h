@@ -0,0 +1,115 @@
+#ifndef SRC_LIB_ORIONLD_MONGOBACKEND_MONGOLDBATCH_H_
+#define SRC_LIB_ORIONLD_MONGOBACKEND_MONGOLDBATCH_H_
+
+/*
+*
+* Copyright 2021 FIWARE Foundation e.V.
+*
+* This file is part of Orion-LD Context Broker.
+*
+* Orion-LD Context Broker is free software: you can redistribute it and/or
+* modify it under the terms of the GNU Affero General Public License as
+* published by the Free Software Foundation, either version 3 of the
+* License, or (at your option) any later version.
+*
+* Orion-LD Context Broker is distributed in the hope that it will be useful,
+* but WITHOUT ANY WARRANTY; without even the implied warranty of
+* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU Affero
+* General Public License for more details.
+*
+* You should have received a copy of the GNU Affero General Public License
+* along with Orion-LD Context Broker. If not, see http://www.gnu.org/licenses/.
+*
+* For those usages not covered by this license please contact with
+* orionld at fiware dot org
+*
+* Author: Ken Zangelin
+*/
+#include <string>
+#include <vector>
+
+#include "mongo/client/dbclient.h"                               // MongoDB C++ Client Legacy Driver
+
+#include "ngsi10/UpdateContextRequest.h"                         // UpdateContextRequest
+#include "ngsi10/UpdateContextResponse.h"                        // UpdateContextResponse
+
+
+
+// -----------------------------------------------------------------------------
+//
+// MongoLdBatchMode - outcome of mongoLdBatchStart
+//
+typedef enum MongoLdBatchMode
+{
+  MongoLdBatchOff,      // No batch mode - the entities are processed one by one
+  MongoLdBatchOn,       // Batch mode entered - mongoLdBatchExecute must be called
+  MongoLdBatchAborted   // The initial query failed while its results were read - the request must fail
+} MongoLdBatchMode;
+
+
+
+// -----------------------------------------------------------------------------
+//
+// MongoLdBatchCallback - work deferred until the bulk write has been executed
+//
+// 'written' is false if the write of the entity failed - the callback must then only free 'dataP'.
+//
+typedef void (*MongoLdBatchCallback)(void* dataP, bool written);
+
+
+
+// -----------------------------------------------------------------------------
+//
+// mongoLdBatchStart - extract all existing entities of a batch in one query and enter batch mode
+//
+extern MongoLdBatchMode mongoLdBatchStart(UpdateContextRequest* requestP, const std::string& tenant, const std::vector<std::string>& servicePathV);
+
+
+
+// -----------------------------------------------------------------------------
+//
+// mongoLdBatchLookup - lookup an entity in the result of the initial query of the batch
+//
+extern bool mongoLdBatchLookup(const std::string& entityId, const std::string& entityType, std::vector<mongo::BSONObj>* resultsP);
+
+
+
+// -----------------------------------------------------------------------------
+//
+// mongoLdBatchInsert - queue an entity insertion in the bulk
+//
+extern bool mongoLdBatchInsert(const std::string& entityId, const mongo::BSONObj& doc);
+
+
+
+// -----------------------------------------------------------------------------
+//
+// mongoLdBatchUpdate - queue an entity update in the bulk
+//
+extern bool mongoLdBatchUpdate(const std::string& entityId, const mongo::BSONObj& query, const mongo::BSONObj& update);
+
+
+
+// -----------------------------------------------------------------------------
+//
+// mongoLdBatchOngoing - is a batch ongoing (in the current thread)?
+//
+extern bool mongoLdBatchOngoing(void);
+
+
+
+// -----------------------------------------------------------------------------
+//
+// mongoLdBatchDefer - defer work on an entity until its write in the bulk has been executed
+//
+extern bool mongoLdBatchDefer(const std::string& entityId, MongoLdBatchCallback callback, void* dataP);
+
+
+
+// -----------------------------------------------------------------------------
+//
+// mongoLdBatchExecute - execute the bulk and end batch mode
+//
+extern void mongoLdBatchExecute(UpdateContextResponse* responseP);
+
+#endif  // SRC_LIB_ORIONLD_MONGOBACKEND_MONGOLDBATCH_H_
@@ -0,0 +1,108 @@
+/*
+*
+* Copyright 2021 FIWARE Foundation e.V.
+*
+* This file is part of Orion-LD Context Broker.
+*
+* Orion-LD Context Broker is free software: you can redistribute it and/or
+* modify it under the terms of the GNU Affero General Public License as
+* published by the Free Software Foundation, either version 3 of the
+* License, or (at your option) any later version.
+*
+* Orion-LD Context Broker is distributed in the hope that it will be useful,
+* but WITHOUT ANY WARRANTY; without even the implied warranty of
+* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU Affero
+* General Public License for more details.
+*
+* You should have received a copy of the GNU Affero General Public License
+* along with Orion-LD Context Broker. If not, see http://www.gnu.org/licenses/.
+*
+* For those usages not covered by this license please contact with
+* orionld at fiware dot org
+*
+* Author: Ken Zangelin
+*/
+#include <string>
+
+#include "mongo/client/dbclient.h"                               // MongoDB C++ Client Legacy Driver
+#include "mongo/client/index_spec.h"                             // IndexSpec
+
+#include "logMsg/logMsg.h"                                       // LM_*
+#include "logMsg/traceLevels.h"                                  // Lmt*
+
+#include "common/statistics.h"                                   // TIME_STAT_MONGO_*
+#include "mongoBackend/MongoGlobal.h"                            // getMongoConnection, releaseMongoConnection, ensureDateExpirationIndex
+
+#include "orionld/types/OrionldTenant.h"                         // OrionldTenant
+#include "orionld/common/orionldState.h"                         // entityIdUnique
+#include "orionld/mongoBackend/mongoLdEntityIdIndexUnique.h"     // Own Interface
+
+
+
+// -----------------------------------------------------------------------------
+//
+// mongoLdEntityIdIndexUnique -
+//
+// NGSI-LD entity ids are unique, whatever the entity type. With a unique index on _id.id in place, an entity
+// can be inserted without being looked up first - if it already exists, the insert fails with a duplicate key error.
+//
+// The index is created the first time an entity is created for the tenant, together with the expiration index that
+// createEntity otherwise ensures for each and every entity, and the outcome is kept in the tenant (entityIdIndex).
+// If the index can't be created (entities with the same id already in the database, or the non-unique index of -idIndex),
+// false is returned, from then on, and the entity must be looked up before it is inserted.
+//
+// Two threads may create the index at the same time - index creation is idempotent.
+//
+// The index is opt-in (-entityIdUnique), as it would break NGSIv2 data: in NGSIv2, two entities may have the same id
+// if their types differ, and with the index in place, the second of them can no longer be created.
+// Without -entityIdUnique, no index is created and false is returned - entities are looked up before being created.
+//
+bool mongoLdEntityIdIndexUnique(OrionldTenant* tenantP)
+{
+  if (entityIdUnique == false)
+    return false;
+
+  int state = __atomic_load_n(&tenantP->entityIdIndex, __ATOMIC_ACQUIRE);
+
+  if (state != 0)
+    return (state == 1);
+
+  std::string collection = getEntitiesCollectionName(tenantP->tenant);
+
+  TIME_STAT_MONGO_COMMAND_WAIT_START();
+  mongo::DBClientBase* connection = getMongoConnection();
+
+  if (connection == NULL)
+  {
+    TIME_STAT_MONGO_COMMAND_WAIT_STOP();
+    LM_E(("Database Error (null DB connection)"));
+    return false;  // Not remembered - next time it is tried again
+  }
+
+  try
+  {
+    connection->createIndex(collection.c_str(), mongo::IndexSpec().addKey("_id.id").unique());
+    state = 1;
+    LM_I(("Database Operation Successful (unique index on _id.id for collection '%s')", collection.c_str()));
+  }
+  catch (const std::exception& e)
+  {
+    LM_W(("Unable to create a unique index on _id.id for '%s' (%s) - entities are looked up before being created", collection.c_str(), e.what()));
+    state = -1;
+  }
+  catch (...)
+  {
+    LM_W(("Unable to create a unique index on _id.id for '%s' - entities are looked up before being created", collection.c_str()));
+    state = -1;
+  }
+
+  releaseMongoConnection(connection);
+  TIME_STAT_MONGO_COMMAND_WAIT_STOP();
+
+  if (state == 1)
+    ensureDateExpirationIndex(tenantP->tenant);
+
+  __atomic_store_n(&tenantP->entityIdIndex, state, __ATOMIC_RELEASE);
+
+  return (state == 1);
+}
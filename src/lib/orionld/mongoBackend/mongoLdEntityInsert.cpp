@@ -0,0 +1,104 @@
+/*
+*
+* Copyright 2021 FIWARE Foundation e.V.
+*
+* This file is part of Orion-LD Context Broker.
+*
+* Orion-LD Context Broker is free software: you can redistribute it and/or
+* modify it under the terms of the GNU Affero General Public License as
+* published by the Free Software Foundation, either version 3 of the
+* License, or (at your option) any later version.
+*
+* Orion-LD Context Broker is distributed in the hope that it will be useful,
+* but WITHOUT ANY WARRANTY; without even the implied warranty of
+* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU Affero
+* General Public License for more details.
+*
+* You should have received a copy of the GNU Affero General Public License
+* along with Orion-LD Context Broker. If not, see http://www.gnu.org/licenses/.
+*
+* For those usages not covered by this license please contact with
+* orionld at fiware dot org
+*
+* Author: Ken Zangelin
+*/
+#include <string>
+
+#include "mongo/client/dbclient.h"                               // MongoDB C++ Client Legacy Driver
+
+#include "logMsg/logMsg.h"                                       // LM_*
+#include "logMsg/traceLevels.h"                                  // Lmt*
+
+#include "common/statistics.h"                                   // TIME_STAT_MONGO_*
+#include "alarmMgr/alarmMgr.h"                                   // alarmMgr
+#include "mongoBackend/MongoGlobal.h"                            // getMongoConnection, releaseMongoConnection
+
+#include "orionld/mongoBackend/mongoLdEntityInsert.h"            // Own Interface
+
+
+
+// -----------------------------------------------------------------------------
+//
+// mongoLdEntityInsert -
+//
+// Same as collectionInsert, except that a duplicate key error (11000) is flagged in *duplicateP and is not a database alarm.
+// With the unique index on _id.id (see mongoLdEntityIdIndexUnique) that is how an already existing entity is detected.
+//
+bool mongoLdEntityInsert(const std::string& collection, const mongo::BSONObj& doc, bool* duplicateP, std::string* errP)
+{
+  *duplicateP = false;
+
+  TIME_STAT_MONGO_WRITE_WAIT_START();
+  mongo::DBClientBase* connection = getMongoConnection();
+
+  if (connection == NULL)
+  {
+    TIME_STAT_MONGO_WRITE_WAIT_STOP();
+    LM_E(("Fatal Error (null DB connection)"));
+    *errP = "null DB connection";
+    return false;
+  }
+
+  LM_T(LmtMongo, ("insert() in collection '%s'", collection.c_str()));
+
+  std::string msg;
+
+  try
+  {
+    connection->insert(collection.c_str(), doc);
+  }
+  catch (const mongo::DBException& e)
+  {
+    if (e.getCode() == 11000)
+      *duplicateP = true;
+    else
+      msg = std::string("collection: ") + collection + " - insert(): " + doc.toString() + " - exception: " + e.what();
+  }
+  catch (const std::exception& e)
+  {
+    msg = std::string("collection: ") + collection + " - insert(): " + doc.toString() + " - exception: " + e.what();
+  }
+  catch (...)
+  {
+    msg = std::string("collection: ") + collection + " - insert(): " + doc.toString() + " - exception: generic";
+  }
+
+  releaseMongoConnection(connection);
+  TIME_STAT_MONGO_WRITE_WAIT_STOP();
+
+  if (*duplicateP == true)
+  {
+    *errP = "Entity already exists";
+    return false;
+  }
+
+  if (msg != "")
+  {
+    *errP = "Database Error (" + msg + ")";
+    alarmMgr.dbError(msg);
+    return false;
+  }
+
+  alarmMgr.dbErrorReset();
+  return true;
+}
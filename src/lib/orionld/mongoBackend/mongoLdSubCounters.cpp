@@ -0,0 +1,426 @@
+/*
+*
+* Copyright 2021 FIWARE Foundation e.V.
+*
+* This file is part of Orion-LD Context Broker.
+*
+* Orion-LD Context Broker is free software: you can redistribute it and/or
+* modify it under the terms of the GNU Affero General Public License as
+* published by the Free Software Foundation, either version 3 of the
+* License, or (at your option) any later version.
+*
+* Orion-LD Context Broker is distributed in the hope that it will be useful,
+* but WITHOUT ANY WARRANTY; without even the implied warranty of
+* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU Affero
+* General Public License for more details.
+*
+* You should have received a copy of the GNU Affero General Public License
+* along with Orion-LD Context Broker. If not, see http://www.gnu.org/licenses/.
+*
+* For those usages not covered by this license please contact with
+* orionld at fiware dot org
+*
+* Author: Ken Zangelin
+*/
+#include <unistd.h>                                              // usleep
+#include <pthread.h>                                             // pthread_create, pthread_detach
+#include <semaphore.h>                                           // sem_t, sem_init, sem_wait, sem_post
+#include <errno.h>                                               // errno
+#include <string.h>                                              // strspn, strerror
+#include <string>
+#include <vector>
+#include <map>
+#include <utility>                                               // std::pair
+
+#include "mongo/client/dbclient.h"                               // MongoDB C++ Client Legacy Driver
+
+#include "logMsg/logMsg.h"                                       // LM_*
+#include "logMsg/traceLevels.h"                                  // Lmt*
+
+#include "common/statistics.h"                                   // TIME_STAT_MONGO_*
+#include "mongoBackend/dbConstants.h"                            // CSUB_COUNT, CSUB_LASTNOTIFICATION, ...
+#include "mongoBackend/MongoGlobal.h"                            // getMongoConnection, releaseMongoConnection, ...
+
+#include "orionld/mongoBackend/mongoLdSubCounters.h"             // Own Interface
+
+
+
+// -----------------------------------------------------------------------------
+//
+// SubCounters - the counters of a subscription that have not yet made it to the database
+//
+// timesSent is a delta ($inc), the timestamps are absolute ($max), 0 meaning 'not set'
+//
+typedef struct SubCounters
+{
+  long long  timesSent;
+  double     lastNotification;
+  double     lastSuccess;
+  double     lastFailure;
+} SubCounters;
+
+
+
+// -----------------------------------------------------------------------------
+//
+// SubCountersMap - tenant + subscription id => buffered counters
+//
+// A std::map, ordered by tenant first, so that all subscriptions of a tenant are contiguous when flushing
+//
+typedef std::map<std::pair<std::string, std::string>, SubCounters> SubCountersMap;
+
+
+
+// -----------------------------------------------------------------------------
+//
+// Module state
+//
+// 'pending' is where the notifications add their counters.
+// 'inFlight' holds the counters that are being written to the database, so that GET /subscriptions still
+// sees them during the bulk write.
+// Both maps are protected by 'countersSem'. 'flushSem' makes sure only one flush is ongoing (flush thread + exit)
+//
+static int             flushInterval = 0;
+static sem_t           countersSem;
+static sem_t           flushSem;
+static SubCountersMap  pending;
+static SubCountersMap  inFlight;
+
+
+
+// -----------------------------------------------------------------------------
+//
+// countersAdd -
+//
+static void countersAdd(SubCounters* toP, const SubCounters* fromP)
+{
+  toP->timesSent += fromP->timesSent;
+
+  if (fromP->lastNotification > toP->lastNotification)  toP->lastNotification = fromP->lastNotification;
+  if (fromP->lastSuccess      > toP->lastSuccess)       toP->lastSuccess      = fromP->lastSuccess;
+  if (fromP->lastFailure      > toP->lastFailure)       toP->lastFailure      = fromP->lastFailure;
+}
+
+
+
+// -----------------------------------------------------------------------------
+//
+// countersPending - add counters to the pending map
+//
+static bool countersPending(const std::string& tenant, const std::string& subscriptionId, const SubCounters* countersP)
+{
+  if (flushInterval == 0)
+    return false;
+
+  if (subscriptionId == "")
+  {
+    LM_E(("Runtime Error (empty subscription id)"));
+    return true;
+  }
+
+  std::pair<std::string, std::string> key(tenant, subscriptionId);
+
+  sem_wait(&countersSem);
+
+  SubCountersMap::iterator it = pending.find(key);
+
+  if (it == pending.end())
+    pending[key] = *countersP;
+  else
+    countersAdd(&it->second, countersP);
+
+  sem_post(&countersSem);
+
+  return true;
+}
+
+
+
+// -----------------------------------------------------------------------------
+//
+// subIdFilter - filter on _id of a subscription
+//
+// Subscriptions created by NGSIv2 requests have an OID as _id, NGSI-LD subscriptions have a string (the URI)
+//
+static mongo::BSONObj subIdFilter(const std::string& subscriptionId)
+{
+  const char* hexDigits = "0123456789abcdefABCDEF";
+
+  if ((subscriptionId.length() == 24) && (strspn(subscriptionId.c_str(), hexDigits) == 24))
+    return BSON("_id" << mongo::OID(subscriptionId));
+
+  return BSON("_id" << subscriptionId);
+}
+
+
+
+// -----------------------------------------------------------------------------
+//
+// countersUpdate - the update of one item of the bulk
+//
+// $max only modifies the timestamp if the new value is greater than the one in the database (or if it's not there)
+//
+static mongo::BSONObj countersUpdate(const SubCounters* countersP)
+{
+  mongo::BSONObjBuilder  update;
+  mongo::BSONObjBuilder  max;
+
+  if (countersP->timesSent > 0)
+    update.append("$inc", BSON(CSUB_COUNT << countersP->timesSent));
+
+  if (countersP->lastNotification > 0)  max.append(CSUB_LASTNOTIFICATION, countersP->lastNotification);
+  if (countersP->lastSuccess      > 0)  max.append(CSUB_LASTSUCCESS,      countersP->lastSuccess);
+  if (countersP->lastFailure      > 0)  max.append(CSUB_LASTFAILURE,      countersP->lastFailure);
+
+  mongo::BSONObj maxObj = max.obj();
+
+  if (maxObj.nFields() > 0)
+    update.append("$max", maxObj);
+
+  return update.obj();
+}
+
+
+
+// -----------------------------------------------------------------------------
+//
+// tenantFlush - one bulk write for the subscriptions of a tenant, in the range [first, end)
+//
+static bool tenantFlush(const std::string& tenant, SubCountersMap::iterator first, SubCountersMap::iterator end)
+{
+  std::string  collection = getSubscribeContextCollectionName(tenant);
+  int          ops        = 0;
+
+  TIME_STAT_MONGO_WRITE_WAIT_START();
+  mongo::DBClientBase* connection = getMongoConnection();
+
+  if (connection == NULL)
+  {
+    TIME_STAT_MONGO_WRITE_WAIT_STOP();
+    LM_E(("Database Error (null DB connection)"));
+    return false;
+  }
+
+  mongo::BulkOperationBuilder  bulk = connection->initializeUnorderedBulkOp(collection);
+  mongo::WriteResult           writeResult;
+  bool                         ok   = true;
+
+  for (SubCountersMap::iterator it = first; it != end; ++it)
+  {
+    mongo::BSONObj update = countersUpdate(&it->second);
+
+    if (update.nFields() == 0)
+      continue;
+
+    bulk.find(subIdFilter(it->first.second)).updateOne(update);
+    ++ops;
+  }
+
+  if (ops > 0)
+  {
+    LM_T(LmtMongo, ("bulk write in '%s' collection: %d subscription counter updates", collection.c_str(), ops));
+
+    try
+    {
+      bulk.execute(&mongo::WriteConcern::acknowledged, &writeResult);
+    }
+    catch (const std::exception& e)
+    {
+      LM_E(("Database Error (flushing subscription counters for tenant '%s': %s)", tenant.c_str(), e.what()));
+      ok = false;
+    }
+    catch (...)
+    {
+      LM_E(("Database Error (flushing subscription counters for tenant '%s': generic exception)", tenant.c_str()));
+      ok = false;
+    }
+  }
+
+  releaseMongoConnection(connection);
+  TIME_STAT_MONGO_WRITE_WAIT_STOP();
+
+  return ok;
+}
+
+
+
+// -----------------------------------------------------------------------------
+//
+// mongoLdSubCountersFlush -
+//
+// The pending counters are moved to 'inFlight' and written to the database, outside the counters semaphore.
+// If the bulk write of a tenant fails, its counters are given back to 'pending', for the next flush to retry.
+// Subscriptions that no longer exist simply don't match any document.
+//
+// A GET /subscriptions that sneaks in between the bulk write and the clearing of 'inFlight' may see timesSent
+// counted twice - the next GET is correct.
+//
+void mongoLdSubCountersFlush(void)
+{
+  if (flushInterval == 0)
+    return;
+
+  sem_wait(&flushSem);
+
+  sem_wait(&countersSem);
+  inFlight.swap(pending);
+  sem_post(&countersSem);
+
+  SubCountersMap::iterator  first = inFlight.begin();
+  SubCountersMap            failed;
+
+  while (first != inFlight.end())
+  {
+    const std::string&        tenant = first->first.first;
+    SubCountersMap::iterator  end    = first;
+
+    while ((end != inFlight.end()) && (end->first.first == tenant))
+      ++end;
+
+    if (tenantFlush(tenant, first, end) == false)
+      failed.insert(first, end);
+
+    first = end;
+  }
+
+  sem_wait(&countersSem);
+
+  for (SubCountersMap::iterator it = failed.begin(); it != failed.end(); ++it)
+  {
+    SubCountersMap::iterator pIt = pending.find(it->first);
+
+    if (pIt == pending.end())
+      pending[it->first] = it->second;
+    else
+      countersAdd(&pIt->second, &it->second);
+  }
+
+  inFlight.clear();
+  sem_post(&countersSem);
+
+  sem_post(&flushSem);
+}
+
+
+
+// -----------------------------------------------------------------------------
+//
+// subCountersFlushThread -
+//
+static void* subCountersFlushThread(void* vP)
+{
+  while (1)
+  {
+    usleep(flushInterval * 1000);
+    mongoLdSubCountersFlush();
+  }
+
+  return NULL;
+}
+
+
+
+// -----------------------------------------------------------------------------
+//
+// mongoLdSubCountersInit -
+//
+void mongoLdSubCountersInit(int _flushInterval)
+{
+  pthread_t  tid;
+  int        ret;
+
+  if (_flushInterval <= 0)
+    return;
+
+  if ((sem_init(&countersSem, 0, 1) == -1) || (sem_init(&flushSem, 0, 1) == -1))
+    LM_X(1, ("Runtime Error (error initializing semaphores for subscription counters: %s)", strerror(errno)));
+
+  flushInterval = _flushInterval;
+
+  ret = pthread_create(&tid, NULL, subCountersFlushThread, NULL);
+  if (ret != 0)
+  {
+    LM_E(("Runtime Error (error creating thread for subscription counters: %d) - counters are written for each notification", ret));
+    flushInterval = 0;
+    return;
+  }
+
+  pthread_detach(tid);
+}
+
+
+
+// -----------------------------------------------------------------------------
+//
+// mongoLdSubCountersNotification -
+//
+bool mongoLdSubCountersNotification(const std::string& tenant, const std::string& subscriptionId, double notificationTime)
+{
+  SubCounters counters = { 1, notificationTime, 0, 0 };
+
+  return countersPending(tenant, subscriptionId, &counters);
+}
+
+
+
+// -----------------------------------------------------------------------------
+//
+// mongoLdSubCountersStatus -
+//
+bool mongoLdSubCountersStatus(const std::string& tenant, const std::string& subscriptionId, bool ok, double notificationTime)
+{
+  SubCounters counters = { 0, 0, 0, 0 };
+
+  if (ok)
+    counters.lastSuccess = notificationTime;
+  else
+    counters.lastFailure = notificationTime;
+
+  return countersPending(tenant, subscriptionId, &counters);
+}
+
+
+
+// -----------------------------------------------------------------------------
+//
+// mongoLdSubCountersMerge -
+//
+void mongoLdSubCountersMerge
+(
+  const std::string&  tenant,
+  const std::string&  subscriptionId,
+  long long*          timesSentP,
+  double*             lastNotificationP,
+  double*             lastSuccessP,
+  double*             lastFailureP
+)
+{
+  if (flushInterval == 0)
+    return;
+
+  std::pair<std::string, std::string>  key(tenant, subscriptionId);
+  SubCounters                          counters = { 0, 0, 0, 0 };
+  SubCountersMap::iterator             it;
+
+  sem_wait(&countersSem);
+
+  if ((it = inFlight.find(key)) != inFlight.end())
+    countersAdd(&counters, &it->second);
+
+  if ((it = pending.find(key)) != pending.end())
+    countersAdd(&counters, &it->second);
+
+  sem_post(&countersSem);
+
+  if (counters.timesSent > 0)
+  {
+    if (*timesSentP == -1)
+      *timesSentP = 0;
+
+    *timesSentP += counters.timesSent;
+  }
+
+  if (counters.lastNotification > *lastNotificationP)  *lastNotificationP = counters.lastNotification;
+  if (counters.lastSuccess      > *lastSuccessP)       *lastSuccessP      = counters.lastSuccess;
+  if (counters.lastFailure      > *lastFailureP)       *lastFailureP      = counters.lastFailure;
+}
@@ -0,0 +1,83 @@
+#ifndef SRC_LIB_ORIONLD_MONGOBACKEND_MONGOLDSUBCOUNTERS_H_
+#define SRC_LIB_ORIONLD_MONGOBACKEND_MONGOLDSUBCOUNTERS_H_
+
+/*
+*
+* Copyright 2021 FIWARE Foundation e.V.
+*
+* This file is part of Orion-LD Context Broker.
+*
+* Orion-LD Context Broker is free software: you can redistribute it and/or
+* modify it under the terms of the GNU Affero General Public License as
+* published by the Free Software Foundation, either version 3 of the
+* License, or (at your option) any later version.
+*
+* Orion-LD Context Broker is distributed in the hope that it will be useful,
+* but WITHOUT ANY WARRANTY; without even the implied warranty of
+* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU Affero
+* General Public License for more details.
+*
+* You should have received a copy of the GNU Affero General Public License
+* along with Orion-LD Context Broker. If not, see http://www.gnu.org/licenses/.
+*
+* For those usages not covered by this license please contact with
+* orionld at fiware dot org
+*
+* Author: Ken Zangelin
+*/
+#include <string>
+
+
+
+// -----------------------------------------------------------------------------
+//
+// mongoLdSubCountersInit - start the thread that flushes the subscription counters to the database
+//
+// If 'flushInterval' (milliseconds) is zero, the counters are not buffered and all functions of this module return false,
+// so the callers go on updating the subscription in the database for each notification.
+//
+extern void mongoLdSubCountersInit(int flushInterval);
+
+
+
+// -----------------------------------------------------------------------------
+//
+// mongoLdSubCountersNotification - one more notification sent for a subscription (timesSent + lastNotification)
+//
+extern bool mongoLdSubCountersNotification(const std::string& tenant, const std::string& subscriptionId, double notificationTime);
+
+
+
+// -----------------------------------------------------------------------------
+//
+// mongoLdSubCountersStatus - outcome of a notification (lastSuccess or lastFailure)
+//
+extern bool mongoLdSubCountersStatus(const std::string& tenant, const std::string& subscriptionId, bool ok, double notificationTime);
+
+
+
+// -----------------------------------------------------------------------------
+//
+// mongoLdSubCountersMerge - add the buffered counters of a subscription to the values read from the database
+//
+// The values not present in the database are -1 (as set by the caller), timesSent included.
+//
+extern void mongoLdSubCountersMerge
+(
+  const std::string&  tenant,
+  const std::string&  subscriptionId,
+  long long*          timesSentP,
+  double*             lastNotificationP,
+  double*             lastSuccessP,
+  double*             lastFailureP
+);
+
+
+
+// -----------------------------------------------------------------------------
+//
+// mongoLdSubCountersFlush - write all buffered counters to the database, one bulk write per tenant
+//
+extern void mongoLdSubCountersFlush(void);
+
+#endif  // SRC_LIB_ORIONLD_MONGOBACKEND_MONGOLDSUBCOUNTERS_H_
@@ -28,105 +28,87 @@ extern "C"
 {
 #include "kalloc/kaStrdup.h"                                         // kaStrdup
 #include "kjson/KjNode.h"                                            // KjNode
-#include "kjson/kjParse.h"                                           // kjParse
-#include "kjson/kjBuilder.h"                                         // kjBuilder
+#include "kjson/kjBuilder.h"                                         // kjObject, kjArray, kjString, ...
 }
 
 #include "logMsg/logMsg.h"                                           // LM_*
 #include "logMsg/traceLevels.h"                                      // Lmt*
 
-#include "orionld/common/orionldState.h"                             // orionldState, orionldStateDelayedFreeEnqueue
+#include "orionld/common/orionldState.h"                             // orionldState
 #include "orionld/mongoBackend/mongoTypeName.h"                      // mongoTypeName
 #include "orionld/mongoCppLegacy/mongoCppLegacyDataToKjTree.h"       // Own interface
 
 
 
-static void arrayToKjTree(KjNode* containerP, mongo::BSONArray* bsonArrayP, char** titleP, char** detailsP);
 // -----------------------------------------------------------------------------
 //
-// objectToKjTree -
+// bsonToKjTree - add the fields of a BSON object/array as children of a KjNode container
 //
-static void objectToKjTree(KjNode* containerP, mongo::BSONObj* bsonObjP, char** titleP, char** detailsP)
-{
-  for (mongo::BSONObj::iterator iter = bsonObjP->begin(); iter.more();)
-  {
-    mongo::BSONElement be       = iter.next();
-    mongo::BSONType    type     = be.type();
-    KjNode*            nodeP    = NULL;
-    const char*        nodeName = be.fieldName();
-
-    if (type == mongo::String)
-      nodeP = kjString(orionldState.kjsonP, nodeName, be.String().c_str());
-    else if (type == mongo::Bool)
-      nodeP = kjBoolean(orionldState.kjsonP, nodeName, be.Bool());
-    else if (type == mongo::NumberDouble)
-      nodeP = kjFloat(orionldState.kjsonP, nodeName, be.Number());
-    else if (type == mongo::NumberInt)
-      nodeP = kjInteger(orionldState.kjsonP, nodeName, be.Number());
-    else if (type == mongo::jstNULL)
-      nodeP = kjNull(orionldState.kjsonP, nodeName);
-    else if (type == mongo::Object)
-    {
-      mongo::BSONObj bo = be.embeddedObject();
-      nodeP = kjObject(orionldState.kjsonP, nodeName);
-      objectToKjTree(nodeP, &bo, titleP, detailsP);
-    }
-    else if (type == mongo::Array)
-    {
-      mongo::BSONArray ba = (mongo::BSONArray) be.embeddedObject();
-      nodeP = kjArray(orionldState.kjsonP, nodeName);
-      arrayToKjTree(nodeP, &ba, titleP, detailsP);
-    }
-    else
-    {
-      LM_E(("Unsupported mongo type %d (%s) for field '%s'", type, mongoTypeName(type), nodeName));
-      continue;
-    }
-
-    kjChildAdd(containerP, nodeP);
-  }
-}
-
-
-
-// -----------------------------------------------------------------------------
+// The BSON buffer is walked once and the KjNode tree is built directly in the kalloc arena of orionldState.kjsonP -
+// no intermediate JSON text.
+// The name of a field is copied, as kjson doesn't copy names, and the BSON object is gone after the cursor has moved.
+// Array items have no name.
 //
-// arrayToKjTree -
+// The mongo types that have no JSON counterpart are given the same shape as in the "Strict" JSON of the mongo driver,
+// except NumberLong that is a plain integer (KjInt):
+//   Date:      { "$date": <milliseconds> }
+//   ObjectId:  { "$oid": "<hex string>" }
+//   Timestamp: { "$timestamp": { "t": <seconds>, "i": <increment> } }
 //
-static void arrayToKjTree(KjNode* containerP, mongo::BSONArray* bsonArrayP, char** titleP, char** detailsP)
+static void bsonToKjTree(KjNode* containerP, const mongo::BSONObj* bsonObjP, bool isArray)
 {
-  for (mongo::BSONObj::iterator iter = bsonArrayP->begin(); iter.more();)
+  Kjson* kjP = orionldState.kjsonP;
+
+  for (mongo::BSONObj::iterator iter = bsonObjP->begin(); iter.more();)
   {
-    mongo::BSONElement be       = iter.next();
-    mongo::BSONType    type     = be.type();
-    KjNode*            nodeP    = NULL;
-    char*              nodeName = NULL;
-
-    if (type == mongo::String)
-      nodeP = kjString(orionldState.kjsonP, nodeName, be.String().c_str());
-    else if (type == mongo::Bool)
-      nodeP = kjBoolean(orionldState.kjsonP, nodeName, be.Bool());
-    else if (type == mongo::NumberDouble)
-      nodeP = kjFloat(orionldState.kjsonP, nodeName, be.Number());
-    else if (type == mongo::NumberInt)
-      nodeP = kjInteger(orionldState.kjsonP, nodeName, be.Number());
-    else if (type == mongo::jstNULL)
-      nodeP = kjNull(orionldState.kjsonP, nodeName);
-    else if (type == mongo::Object)
-    {
-      mongo::BSONObj bo = be.embeddedObject();
-      nodeP = kjObject(orionldState.kjsonP, nodeName);
-      objectToKjTree(nodeP, &bo, titleP, detailsP);
-    }
-    else if (type == mongo::Array)
-    {
-      mongo::BSONArray ba = (mongo::BSONArray) be.embeddedObject();
-      nodeP = kjArray(orionldState.kjsonP, nodeName);
-      arrayToKjTree(nodeP, &ba, titleP, detailsP);
-    }
-    else
+    mongo::BSONElement  be       = iter.next();
+    mongo::BSONType     type     = be.type();
+    KjNode*             nodeP    = NULL;
+    const char*         nodeName = (isArray == true)? NULL : kaStrdup(kjP->kallocP, be.fieldName());
+
+    switch (type)
     {
-      LM_E(("Unsupported mongo type %d (%s) for field '%s'", type, mongoTypeName(type), nodeName));
+    case mongo::String:        nodeP = kjString(kjP, nodeName, be.valuestr());        break;
+    case mongo::Bool:          nodeP = kjBoolean(kjP, nodeName, be.boolean());        break;
+    case mongo::NumberDouble:  nodeP = kjFloat(kjP, nodeName, be._numberDouble());    break;
+    case mongo::NumberInt:     nodeP = kjInteger(kjP, nodeName, be._numberInt());     break;
+    case mongo::NumberLong:    nodeP = kjInteger(kjP, nodeName, be._numberLong());    break;
+    case mongo::jstNULL:       nodeP = kjNull(kjP, nodeName);                         break;
+
+    case mongo::Object:
+    case mongo::Array:
+      {
+        mongo::BSONObj bo = be.embeddedObject();
+
+        nodeP = (type == mongo::Object)? kjObject(kjP, nodeName) : kjArray(kjP, nodeName);
+        bsonToKjTree(nodeP, &bo, type == mongo::Array);
+      }
+      break;
+
+    case mongo::Date:
+      nodeP = kjObject(kjP, nodeName);
+      kjChildAdd(nodeP, kjInteger(kjP, "$date", be.date().millis));
+      break;
+
+    case mongo::jstOID:
+      nodeP = kjObject(kjP, nodeName);
+      kjChildAdd(nodeP, kjString(kjP, "$oid", be.__oid().toString().c_str()));
+      break;
+
+    case mongo::Timestamp:
+      {
+        KjNode* tsP = kjObject(kjP, "$timestamp");
+
+        kjChildAdd(tsP, kjInteger(kjP, "t", be.timestampTime().toTimeT()));
+        kjChildAdd(tsP, kjInteger(kjP, "i", be.timestampInc()));
+
+        nodeP = kjObject(kjP, nodeName);
+        kjChildAdd(nodeP, tsP);
+      }
+      break;
+
+    default:
+      LM_W(("Unsupported mongo type %d (%s) for field '%s' - skipped", type, mongoTypeName(type), be.fieldName()));
       continue;
     }
 
@@ -142,18 +124,16 @@ static void arrayToKjTree(KjNode* containerP, mongo::BSONArray* bsonArrayP, char
 //
 KjNode* mongoCppLegacyDataToKjTree(const void* dataP, bool isArray, char** titleP, char** detailsP)
 {
-  KjNode* rootP;
+  KjNode* rootP = (isArray == false)? kjObject(orionldState.kjsonP, NULL) : kjArray(orionldState.kjsonP, NULL);
 
-  if (isArray == false)
+  if (rootP == NULL)
   {
-    rootP = kjObject(orionldState.kjsonP, NULL);
-    objectToKjTree(rootP, (mongo::BSONObj*) dataP, titleP, detailsP);
-  }
-  else
-  {
-    rootP = kjArray(orionldState.kjsonP, NULL);
-    arrayToKjTree(rootP, (mongo::BSONArray*) dataP, titleP, detailsP);
+    *titleP   = (char*) "Internal Error";
+    *detailsP = (char*) "Out of memory creating a KjNode tree from BSON";
+    return NULL;
   }
 
+  bsonToKjTree(rootP, (const mongo::BSONObj*) dataP, isArray);
+
   return rootP;
 }
@@ -72,30 +72,34 @@ static void entityInfoArrayFilter(mongo::BSONObjBuilder* queryBuilderP, KjNode*
         typeP = nodeP;
     }
 
-    mongo::BSONObjBuilder eFilter;
     mongo::BSONObjBuilder ePart;
+    bool                  eTouched = false;
 
     if (idP != NULL)
     {
       ePart.append("_id.id", idP->value.s);
-      touched = true;
+      eTouched = true;
     }
-    if (typeP != NULL)
-    {
-      ePart.append("_id.type", typeP->value.s);
-      touched = true;
-    }
-    if ((idPatternP != NULL) && (strcmp(idPatternP->value.s, ".*") != 0))
+    else if ((idPatternP != NULL) && (strcmp(idPatternP->value.s, ".*") != 0))
     {
-      // Add REGEX to ePart
-      touched = true;
+      ePart.appendRegex("_id.id", idPatternP->value.s);
+      eTouched = true;
     }
 
-    if (touched == true)
+    if (typeP != NULL)
     {
-      eFilter.appendElements(ePart.obj());
-      eArray.append(eFilter.obj());
+      ePart.append("_id.type", typeP->value.s);
+      eTouched = true;
     }
+
+    //
+    // An entity info item without restrictions matches all entities - no filter at all is needed then
+    //
+    if (eTouched == false)
+      return;
+
+    eArray.append(ePart.obj());
+    touched = true;
   }
 
   if (touched == true)
@@ -466,7 +470,7 @@ static void geoqFilter(mongo::BSONObjBuilder* queryBuilderP, KjNode* geoqP)
 
   char* georel      = georelP->value.s;
   char* geometry    = geometryP->value.s;
-  char* geoproperty = geopropertyP->value.s;
+  char* geoproperty = (geopropertyP != NULL)? geopropertyP->value.s : (char*) "location";
 
   if (SCOMPARE5(georel, 'n', 'e', 'a', 'r', ';'))
     geoqNearFilter(queryBuilderP, geometry, &georel[5], coordinatesP, geoproperty);
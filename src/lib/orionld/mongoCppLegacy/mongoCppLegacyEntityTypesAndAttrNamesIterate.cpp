@@ -0,0 +1,107 @@
+/*
+*
+* Copyright 2021 FIWARE Foundation e.V.
+*
+* This file is part of Orion-LD Context Broker.
+*
+* Orion-LD Context Broker is free software: you can redistribute it and/or
+* modify it under the terms of the GNU Affero General Public License as
+* published by the Free Software Foundation, either version 3 of the
+* License, or (at your option) any later version.
+*
+* Orion-LD Context Broker is distributed in the hope that it will be useful,
+* but WITHOUT ANY WARRANTY; without even the implied warranty of
+* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU Affero
+* General Public License for more details.
+*
+* You should have received a copy of the GNU Affero General Public License
+* along with Orion-LD Context Broker. If not, see http://www.gnu.org/licenses/.
+*
+* For those usages not covered by this license please contact with
+* orionld at fiware dot org
+*
+* Author: Ken Zangelin
+*/
+#include <vector>                                                // std::vector
+
+#include "mongo/client/dbclient.h"                               // MongoDB C++ Client Legacy Driver
+
+#include "logMsg/logMsg.h"                                       // LM_*
+#include "logMsg/traceLevels.h"                                  // Lmt*
+
+#include "mongoBackend/MongoGlobal.h"                            // getMongoConnection, releaseMongoConnection, ...
+#include "orionld/types/OrionldTenant.h"                         // OrionldTenant
+#include "orionld/db/dbCollectionPathGet.h"                      // dbCollectionPathGetWithTenant
+#include "orionld/db/dbConfiguration.h"                          // DbEntityTypeAndAttrNamesCallback
+#include "orionld/mongoCppLegacy/mongoCppLegacyEntityTypesAndAttrNamesIterate.h"  // Own interface
+
+
+
+// -----------------------------------------------------------------------------
+//
+// mongoCppLegacyEntityTypesAndAttrNamesIterate -
+//
+// The entities are streamed, one at a time, no KjNode tree is built - this is used to build the type catalog
+// of a tenant, and the tenant may have millions of entities.
+// The strings passed to the callback point inside the BSON of the entity - only valid during the call.
+//
+bool mongoCppLegacyEntityTypesAndAttrNamesIterate(OrionldTenant* tenantP, DbEntityTypeAndAttrNamesCallback callback, void* userP)
+{
+  char collectionPath[256];
+  bool ok = true;
+
+  if (dbCollectionPathGetWithTenant(collectionPath, sizeof(collectionPath), tenantP->mongoDbName, "entities") == -1)
+    return false;
+
+  mongo::BSONObjBuilder                 filter;
+  mongo::BSONObjBuilder                 dbFields;
+  std::vector<const char*>              attrNameV;
+
+  dbFields.append("_id.type", 1);
+  dbFields.append("attrNames", 1);
+
+  mongo::Query                          query(filter.obj());
+  mongo::BSONObj                        fieldsToReturn = dbFields.obj();
+  mongo::DBClientBase*                  connectionP    = getMongoConnection();
+
+  try
+  {
+    std::auto_ptr<mongo::DBClientCursor>  cursorP = connectionP->query(collectionPath, query, 0, 0, &fieldsToReturn);
+
+    while (cursorP->more())
+    {
+      mongo::BSONObj  bsonObj = cursorP->nextSafe();
+      mongo::BSONObj  idObj   = bsonObj.getObjectField("_id");
+      const char*     type    = idObj.getStringField("type");
+
+      if ((type == NULL) || (type[0] == 0))
+        continue;
+
+      attrNameV.clear();
+
+      if (bsonObj.hasField("attrNames") && (bsonObj.getField("attrNames").type() == mongo::Array))
+      {
+        mongo::BSONObjIterator iter(bsonObj.getObjectField("attrNames"));
+
+        while (iter.more())
+        {
+          mongo::BSONElement attrName = iter.next();
+
+          if (attrName.type() == mongo::String)
+            attrNameV.push_back(attrName.valuestr());
+        }
+      }
+
+      callback(userP, type, (attrNameV.size() > 0)? &attrNameV[0] : NULL, attrNameV.size());
+    }
+  }
+  catch (const std::exception &e)
+  {
+    LM_E(("Mongo Exception: %s", e.what()));
+    ok = false;
+  }
+
+  releaseMongoConnection(connectionP);
+
+  return ok;
+}
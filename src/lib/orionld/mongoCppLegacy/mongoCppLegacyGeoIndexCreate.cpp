@@ -35,7 +35,8 @@ extern "C"
 
 #include "mongoBackend/connectionOperations.h"                    // collectionCreateIndex
 
-#include "orionld/db/dbCollectionPathGet.h"                       // dbCollectionPathGet
+#include "orionld/types/OrionldTenant.h"                          // OrionldTenant
+#include "orionld/db/dbCollectionPathGet.h"                       // dbCollectionPathGetWithTenant
 #include "orionld/db/dbGeoIndexAdd.h"                             // dbGeoIndexAdd
 #include "orionld/common/dotForEq.h"                              // dotForEq
 #include "orionld/mongoCppLegacy/mongoCppLegacyGeoIndexCreate.h"  // Own interface
@@ -46,7 +47,7 @@ extern "C"
 //
 // mongoCppLegacyGeoIndexCreate -
 //
-bool mongoCppLegacyGeoIndexCreate(const char* tenant, const char* attrLongName)
+bool mongoCppLegacyGeoIndexCreate(OrionldTenant* tenantP, const char* attrLongName)
 {
   int         len          = 6 + strlen(attrLongName) + 6 + 1;              // "attrs." == 6, ".value" == 6, 1 for string-termination
   char*       index        = kaAlloc(&orionldState.kalloc, len);
@@ -57,15 +58,15 @@ bool mongoCppLegacyGeoIndexCreate(const char* tenant, const char* attrLongName)
   snprintf(index, len, "attrs.%s.value", attrNameCopy);
 
   char collectionPath[256];
-  dbCollectionPathGet(collectionPath, sizeof(collectionPath), "entities");
+  dbCollectionPathGetWithTenant(collectionPath, sizeof(collectionPath), tenantP->mongoDbName, "entities");
 
   if (collectionCreateIndex(collectionPath, BSON(index << "2dsphere"), false, &err) == false)
   {
-    LM_E(("Database Error (error creating 2dsphere index for attribute '%s' for tenant '%s')", attrNameCopy, tenant));
+    LM_E(("Database Error (error creating 2dsphere index for attribute '%s' for tenant '%s')", attrNameCopy, tenantP->mongoDbName));
     return false;
   }
 
-  dbGeoIndexAdd(tenant, attrNameCopy);
+  dbGeoIndexAdd(tenantP, attrNameCopy);
 
   return true;
 }
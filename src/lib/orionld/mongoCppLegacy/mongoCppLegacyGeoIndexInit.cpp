@@ -35,7 +35,7 @@ extern "C"
 
 #include "mongoBackend/MongoGlobal.h"                                // getMongoConnection, releaseMongoConnection, ...
 
-#include "orionld/common/orionldState.h"                             // tenants, tenantV
+#include "orionld/common/orionldState.h"                             // tenant0, tenantList
 #include "orionld/db/dbCollectionPathGet.h"                          // dbCollectionPathGetWithTenant
 #include "orionld/db/dbGeoIndexLookup.h"                             // dbGeoIndexLookup
 #include "orionld/mongoCppLegacy/mongoCppLegacyDataToKjTree.h"       // mongoCppLegacyDataToKjTree
@@ -51,15 +51,16 @@ extern "C"
 void mongoCppLegacyGeoIndexInit(void)
 {
   //
-  // Loop over all tenants
-  // Index -1 is used for the default tenant
+  // Loop over all tenants, populating the geo-index hash set of each tenant
+  // The default tenant (tenant0) comes first
   //
-  for (int ix = -1; ix < (int) tenants; ix++)
+  OrionldTenant* tenantP = &tenant0;
+
+  do
   {
     char  collectionPath[256];
-    char* tenant = (ix == -1)? dbName : tenantV[ix];
 
-    dbCollectionPathGetWithTenant(collectionPath, sizeof(collectionPath), tenant, "entities");
+    dbCollectionPathGetWithTenant(collectionPath, sizeof(collectionPath), tenantP->mongoDbName, "entities");
 
     // Foreach ENTITY (only attrs)
     mongo::BSONObjBuilder  dbFields;
@@ -73,16 +74,8 @@ void mongoCppLegacyGeoIndexInit(void)
     mongo::DBClientBase*                  connectionP    = getMongoConnection();
     std::auto_ptr<mongo::DBClientCursor>  cursorP        = connectionP->query(collectionPath, query, 0, 0, &fieldsToReturn);
 
-    orionldState.jsonBuf = NULL;
     while (cursorP->more())
     {
-      if (orionldState.jsonBuf != NULL)
-      {
-        // mongoCppLegacyDataToKjTree uses orionldState.jsonBuf for its output tree
-        free(orionldState.jsonBuf);
-        orionldState.jsonBuf = NULL;
-      }
-
       mongo::BSONObj  bsonObj = cursorP->nextSafe();
 
       char*           title;
@@ -112,10 +105,12 @@ void mongoCppLegacyGeoIndexInit(void)
 
         if (strcmp(typeP->value.s, "GeoProperty") == 0)
         {
-          if (dbGeoIndexLookup(tenant, attrP->name) == NULL)
-            mongoCppLegacyGeoIndexCreate(tenant, attrP->name);
+          if (dbGeoIndexLookup(tenantP, attrP->name) == NULL)
+            mongoCppLegacyGeoIndexCreate(tenantP, attrP->name);
         }
       }
     }
-  }
+
+    tenantP = (tenantP == &tenant0)? __atomic_load_n(&tenantList, __ATOMIC_ACQUIRE) : tenantP->listNext;
+  } while (tenantP != NULL);
 }
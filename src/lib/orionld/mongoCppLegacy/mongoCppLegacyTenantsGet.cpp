@@ -22,7 +22,7 @@
 *
 * Author: Ken Zangelin
 */
-#include <string.h>                                            // strdup
+#include <string.h>                                            // strdup, strlen
 #include <string>                                              // std::string
 #include <vector>                                              // std::vector
 
@@ -31,6 +31,7 @@
 #include "logMsg/logMsg.h"                                     // LM_*
 #include "logMsg/traceLevels.h"                                // Lmt*
 
+#include "common/limits.h"                                     // SERVICE_NAME_MAX_LEN
 #include "mongoBackend/MongoGlobal.h"                          // getMongoConnection
 
 #include "orionld/common/orionldState.h"                       // orionldState, dbName, dbNameLen
@@ -77,8 +78,16 @@ bool mongoCppLegacyTenantsGet(void)
       if (strcmp(name, dbName) == 0)
         continue;
 
-      if (strncmp(name, dbName, dbNameLen) == 0)
-        orionldTenantCreate(name);
+      if ((strncmp(name, dbName, dbNameLen) != 0) || (name[dbNameLen] != '-'))
+        continue;
+
+      if (strlen(&name[dbNameLen + 1]) > SERVICE_NAME_MAX_LEN)
+      {
+        LM_W(("Bad Input (database '%s': tenant name too long - not a tenant)", name));
+        continue;
+      }
+
+      orionldTenantCreate(&name[dbNameLen + 1]);  // The registry keeps the tenant without the dbName prefix
     }
   }
   catch (const std::exception &e)
@@ -0,0 +1,92 @@
+/*
+*
+* Copyright 2021 FIWARE Foundation e.V.
+*
+* This file is part of Orion-LD Context Broker.
+*
+* Orion-LD Context Broker is free software: you can redistribute it and/or
+* modify it under the terms of the GNU Affero General Public License as
+* published by the Free Software Foundation, either version 3 of the
+* License, or (at your option) any later version.
+*
+* Orion-LD Context Broker is distributed in the hope that it will be useful,
+* but WITHOUT ANY WARRANTY; without even the implied warranty of
+* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU Affero
+* General Public License for more details.
+*
+* You should have received a copy of the GNU Affero General Public License
+* along with Orion-LD Context Broker. If not, see http://www.gnu.org/licenses/.
+*
+* For those usages not covered by this license please contact with
+* orionld at fiware dot org
+*
+* Author: Ken Zangelin
+*/
+#include "mongo/client/dbclient.h"                               // MongoDB C++ Client Legacy Driver
+
+extern "C"
+{
+#include "kjson/KjNode.h"                                        // KjNode
+#include "kjson/kjBuilder.h"                                     // kjArray, kjChildAdd
+}
+
+#include "logMsg/logMsg.h"                                       // LM_*
+#include "logMsg/traceLevels.h"                                  // Lmt*
+
+#include "mongoBackend/MongoGlobal.h"                            // getMongoConnection, releaseMongoConnection, ...
+#include "orionld/common/orionldState.h"                         // orionldState
+#include "orionld/types/OrionldTenant.h"                         // OrionldTenant
+#include "orionld/db/dbCollectionPathGet.h"                      // dbCollectionPathGetWithTenant
+#include "orionld/db/dbConfiguration.h"                          // dbDataToKjTree
+#include "orionld/mongoCppLegacy/mongoCppLegacyTypeCatalogGet.h"  // Own interface
+
+
+
+// -----------------------------------------------------------------------------
+//
+// mongoCppLegacyTypeCatalogGet -
+//
+KjNode* mongoCppLegacyTypeCatalogGet(OrionldTenant* tenantP)
+{
+  char collectionPath[256];
+
+  if (dbCollectionPathGetWithTenant(collectionPath, sizeof(collectionPath), tenantP->mongoDbName, "entityTypes") == -1)
+    return NULL;
+
+  mongo::BSONObjBuilder                 filter;
+  mongo::Query                          query(filter.obj());
+  mongo::DBClientBase*                  connectionP = getMongoConnection();
+  std::auto_ptr<mongo::DBClientCursor>  cursorP;
+  KjNode*                               docArray    = NULL;
+
+  try
+  {
+    cursorP = connectionP->query(collectionPath, query);
+  }
+  catch (const std::exception &e)
+  {
+    LM_E(("Mongo Exception: %s", e.what()));
+    releaseMongoConnection(connectionP);
+    return NULL;
+  }
+
+  while (cursorP->more())
+  {
+    mongo::BSONObj  bsonObj = cursorP->nextSafe();
+    char*           title;
+    char*           details;
+    KjNode*         kjTree = dbDataToKjTree(&bsonObj, false, &title, &details);
+
+    if (kjTree == NULL)
+      LM_E(("%s: %s", title, details));
+    else
+    {
+      if (docArray == NULL)
+        docArray = kjArray(orionldState.kjsonP, NULL);
+      kjChildAdd(docArray, kjTree);
+    }
+  }
+
+  releaseMongoConnection(connectionP);
+  return docArray;
+}
@@ -0,0 +1,89 @@
+/*
+*
+* Copyright 2021 FIWARE Foundation e.V.
+*
+* This file is part of Orion-LD Context Broker.
+*
+* Orion-LD Context Broker is free software: you can redistribute it and/or
+* modify it under the terms of the GNU Affero General Public License as
+* published by the Free Software Foundation, either version 3 of the
+* License, or (at your option) any later version.
+*
+* Orion-LD Context Broker is distributed in the hope that it will be useful,
+* but WITHOUT ANY WARRANTY; without even the implied warranty of
+* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU Affero
+* General Public License for more details.
+*
+* You should have received a copy of the GNU Affero General Public License
+* along with Orion-LD Context Broker. If not, see http://www.gnu.org/licenses/.
+*
+* For those usages not covered by this license please contact with
+* orionld at fiware dot org
+*
+* Author: Ken Zangelin
+*/
+#include "mongo/client/dbclient.h"                               // MongoDB C++ Client Legacy Driver
+
+#include "logMsg/logMsg.h"                                       // LM_*
+#include "logMsg/traceLevels.h"                                  // Lmt*
+
+#include "mongoBackend/MongoGlobal.h"                            // getMongoConnection, releaseMongoConnection, ...
+#include "orionld/types/OrionldTenant.h"                         // OrionldTenant
+#include "orionld/db/dbCollectionPathGet.h"                      // dbCollectionPathGetWithTenant
+#include "orionld/mongoCppLegacy/mongoCppLegacyTypeCatalogItemSave.h"  // Own interface
+
+
+
+// -----------------------------------------------------------------------------
+//
+// mongoCppLegacyTypeCatalogItemSave -
+//
+// An entity type without entities is removed from the collection, otherwise its document is upserted:
+//   { "_id": <entity type>, "entities": <count>, "attrs": [ { "name": <attribute name>, "entities": <count> }, ... ] }
+//
+bool mongoCppLegacyTypeCatalogItemSave(OrionldTenant* tenantP, const char* entityType, int entities, const char** attrNameV, int* attrCountV, int attrs)
+{
+  char collectionPath[256];
+  bool ok = true;
+
+  if (dbCollectionPathGetWithTenant(collectionPath, sizeof(collectionPath), tenantP->mongoDbName, "entityTypes") == -1)
+    return false;
+
+  mongo::BSONObjBuilder  filter;
+  filter.append("_id", entityType);
+
+  mongo::DBClientBase*  connectionP = getMongoConnection();
+  mongo::Query          query(filter.obj());
+
+  try
+  {
+    if (entities <= 0)
+      connectionP->remove(collectionPath, query, true);
+    else
+    {
+      mongo::BSONArrayBuilder  attrArray;
+      mongo::BSONObjBuilder    setObj;
+      mongo::BSONObjBuilder    update;
+
+      for (int ix = 0; ix < attrs; ix++)
+        attrArray.append(BSON("name" << attrNameV[ix] << "entities" << attrCountV[ix]));
+
+      setObj.append("entities", entities);
+      setObj.append("attrs", attrArray.arr());
+      update.append("$set", setObj.obj());
+
+      connectionP->update(collectionPath, query, update.obj(), true, false);
+    }
+
+    ok = (connectionP->isFailed() == true)? false : true;
+  }
+  catch (const std::exception &e)
+  {
+    LM_E(("Mongo Exception: %s", e.what()));
+    ok = false;
+  }
+
+  releaseMongoConnection(connectionP);
+
+  return ok;
+}
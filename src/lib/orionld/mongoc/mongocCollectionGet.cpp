@@ -0,0 +1,80 @@
+/*
+*
+* Copyright 2021 FIWARE Foundation e.V.
+*
+* This file is part of Orion-LD Context Broker.
+*
+* Orion-LD Context Broker is free software: you can redistribute it and/or
+* modify it under the terms of the GNU Affero General Public License as
+* published by the Free Software Foundation, either version 3 of the
+* License, or (at your option) any later version.
+*
+* Orion-LD Context Broker is distributed in the hope that it will be useful,
+* but WITHOUT ANY WARRANTY; without even the implied warranty of
+* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU Affero
+* General Public License for more details.
+*
+* You should have received a copy of the GNU Affero General Public License
+* along with Orion-LD Context Broker. If not, see http://www.gnu.org/licenses/.
+*
+* For those usages not covered by this license please contact with
+* orionld at fiware dot org
+*
+* Author: Ken Zangelin
+*/
+#include <stdio.h>                                               // snprintf
+
+#include <mongoc/mongoc.h>                                       // MongoDB C Client Driver
+
+#include "logMsg/logMsg.h"                                       // LM_*
+#include "logMsg/traceLevels.h"                                  // Lmt*
+
+#include "orionld/common/orionldState.h"                         // orionldState, dbName, multitenancy
+#include "orionld/mongoc/mongocConnectionGet.h"                  // mongocConnectionGet
+#include "orionld/mongoc/mongocCollectionGet.h"                  // Own interface
+
+
+
+// -----------------------------------------------------------------------------
+//
+// mongocCollectionGet - get a handle to a collection of the database of the current tenant
+//
+// The handle belongs to the client of the current thread and must be destroyed (mongoc_collection_destroy)
+// by the caller. A collection handle is just a small struct, no round trip to the server is involved.
+//
+mongoc_collection_t* mongocCollectionGet(const char* collectionName)
+{
+  if (orionldState.tenantP != NULL)
+    return mongocCollectionGetWithDb(orionldState.tenantP->mongoDbName, collectionName);
+
+  if ((multitenancy == true) && (orionldState.tenant != NULL) && (orionldState.tenant[0] != 0))
+  {
+    char tenantDbName[128];
+
+    snprintf(tenantDbName, sizeof(tenantDbName), "%s-%s", dbName, orionldState.tenant);
+    return mongocCollectionGetWithDb(tenantDbName, collectionName);
+  }
+
+  return mongocCollectionGetWithDb(dbName, collectionName);
+}
+
+
+
+// -----------------------------------------------------------------------------
+//
+// mongocCollectionGetWithDb - get a handle to a collection of a given database
+//
+mongoc_collection_t* mongocCollectionGetWithDb(const char* dbName, const char* collectionName)
+{
+  mongoc_client_t*      clientP = mongocConnectionGet();
+  mongoc_collection_t*  collectionP;
+
+  if (clientP == NULL)
+    return NULL;
+
+  collectionP = mongoc_client_get_collection(clientP, dbName, collectionName);
+  if (collectionP == NULL)
+    LM_E(("Database Error (mongoc_client_get_collection(%s, %s) failed)", dbName, collectionName));
+
+  return collectionP;
+}
@@ -0,0 +1,57 @@
+/*
+*
+* Copyright 2021 FIWARE Foundation e.V.
+*
+* This file is part of Orion-LD Context Broker.
+*
+* Orion-LD Context Broker is free software: you can redistribute it and/or
+* modify it under the terms of the GNU Affero General Public License as
+* published by the Free Software Foundation, either version 3 of the
+* License, or (at your option) any later version.
+*
+* Orion-LD Context Broker is distributed in the hope that it will be useful,
+* but WITHOUT ANY WARRANTY; without even the implied warranty of
+* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU Affero
+* General Public License for more details.
+*
+* You should have received a copy of the GNU Affero General Public License
+* along with Orion-LD Context Broker. If not, see http://www.gnu.org/licenses/.
+*
+* For those usages not covered by this license please contact with
+* orionld at fiware dot org
+*
+* Author: Ken Zangelin
+*/
+#include <mongoc/mongoc.h>                                       // MongoDB C Client Driver
+
+#include "logMsg/logMsg.h"                                       // LM_*
+#include "logMsg/traceLevels.h"                                  // Lmt*
+
+#include "orionld/common/orionldState.h"                         // orionldState, mongocPool
+#include "orionld/mongoc/mongocConnectionGet.h"                  // Own interface
+
+
+
+// -----------------------------------------------------------------------------
+//
+// mongocConnectionGet - get the mongoc client of the current thread
+//
+// mongoc_client_t isn't thread-safe, so, each thread checks out its own client from the pool (mongocPool).
+// The client is checked out at the first DB operation of a request and kept in orionldState until the
+// request ends, when orionldStateRelease() returns it to the pool (mongocConnectionRelease).
+// One request thus needs one single pop/push pair, however many DB operations it performs.
+//
+// If all clients of the pool are in use, mongoc_client_pool_pop blocks until one is returned.
+//
+mongoc_client_t* mongocConnectionGet(void)
+{
+  if (orionldState.mongocClientP == NULL)
+  {
+    orionldState.mongocClientP = mongoc_client_pool_pop(mongocPool);
+
+    if (orionldState.mongocClientP == NULL)
+      LM_E(("Database Error (unable to get a client from the mongoc client pool)"));
+  }
+
+  return orionldState.mongocClientP;
+}
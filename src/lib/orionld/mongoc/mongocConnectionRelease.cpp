@@ -0,0 +1,49 @@
+/*
+*
+* Copyright 2021 FIWARE Foundation e.V.
+*
+* This file is part of Orion-LD Context Broker.
+*
+* Orion-LD Context Broker is free software: you can redistribute it and/or
+* modify it under the terms of the GNU Affero General Public License as
+* published by the Free Software Foundation, either version 3 of the
+* License, or (at your option) any later version.
+*
+* Orion-LD Context Broker is distributed in the hope that it will be useful,
+* but WITHOUT ANY WARRANTY; without even the implied warranty of
+* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU Affero
+* General Public License for more details.
+*
+* You should have received a copy of the GNU Affero General Public License
+* along with Orion-LD Context Broker. If not, see http://www.gnu.org/licenses/.
+*
+* For those usages not covered by this license please contact with
+* orionld at fiware dot org
+*
+* Author: Ken Zangelin
+*/
+#include <mongoc/mongoc.h>                                       // MongoDB C Client Driver
+
+#include "logMsg/logMsg.h"                                       // LM_*
+#include "logMsg/traceLevels.h"                                  // Lmt*
+
+#include "orionld/common/orionldState.h"                         // orionldState, mongocPool
+#include "orionld/mongoc/mongocConnectionRelease.h"              // Own interface
+
+
+
+// -----------------------------------------------------------------------------
+//
+// mongocConnectionRelease - return the mongoc client of the current thread to the pool
+//
+// Called by orionldStateRelease() at the end of each request.
+// Threads that use the database outside the request flow must call it themselves when done.
+//
+void mongocConnectionRelease(void)
+{
+  if (orionldState.mongocClientP != NULL)
+  {
+    mongoc_client_pool_push(mongocPool, orionldState.mongocClientP);
+    orionldState.mongocClientP = NULL;
+  }
+}
@@ -0,0 +1,133 @@
+/*
+*
+* Copyright 2021 FIWARE Foundation e.V.
+*
+* This file is part of Orion-LD Context Broker.
+*
+* Orion-LD Context Broker is free software: you can redistribute it and/or
+* modify it under the terms of the GNU Affero General Public License as
+* published by the Free Software Foundation, either version 3 of the
+* License, or (at your option) any later version.
+*
+* Orion-LD Context Broker is distributed in the hope that it will be useful,
+* but WITHOUT ANY WARRANTY; without even the implied warranty of
+* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU Affero
+* General Public License for more details.
+*
+* You should have received a copy of the GNU Affero General Public License
+* along with Orion-LD Context Broker. If not, see http://www.gnu.org/licenses/.
+*
+* For those usages not covered by this license please contact with
+* orionld at fiware dot org
+*
+* Author: Ken Zangelin
+*/
+#include <stdio.h>                                               // snprintf
+
+#include <mongoc/mongoc.h>                                       // MongoDB C Client Driver
+
+extern "C"
+{
+#include "kjson/KjNode.h"                                        // KjNode
+#include "kjson/kjBuilder.h"                                     // kjArray, kjChildAdd
+}
+
+#include "logMsg/logMsg.h"                                       // LM_*
+#include "logMsg/traceLevels.h"                                  // Lmt*
+
+#include "orionld/common/orionldState.h"                         // orionldState
+#include "orionld/mongoc/mongocCollectionGet.h"                  // mongocCollectionGet
+#include "orionld/mongoc/mongocKjTreeFromBson.h"                 // mongocKjTreeFromBson
+#include "orionld/mongoc/mongocEntitiesAttributeLookup.h"        // Own interface
+
+
+
+// ----------------------------------------------------------------------------
+//
+// mongocEntitiesAttributeLookup -
+//
+// Returns an array with the entities of 'entityArray' that have the attribute 'attributeName'.
+// Only the entity id and the attribute are returned, not the entire entities.
+//
+// mongo shell:
+//   db.entities.find({ "_id.id": { "$in": [ ... ] }, "attrs.A1": { "$exists": true } }, { "_id.id": 1, "attrs.A1": 1 })
+//
+KjNode* mongocEntitiesAttributeLookup(char** entityArray, int entitiesInArray, const char* attributeName)
+{
+  mongoc_collection_t*  collectionP = mongocCollectionGet("entities");
+  KjNode*               kjTree      = kjArray(orionldState.kjsonP, NULL);
+  bson_t                mongoFilter;
+  bson_t                in;
+  bson_t                idArray;
+  bson_t                exists;
+  bson_t                opts;
+  bson_t                projection;
+  const bson_t*         mongoDocP;
+  mongoc_cursor_t*      mongoCursorP;
+  bson_error_t          mongoError;
+  char                  attrPath[512];
+
+  if (collectionP == NULL)
+    return NULL;
+
+  snprintf(attrPath, sizeof(attrPath), "attrs.%s", attributeName);
+
+  //
+  // Filter - Entity ID in the array, and attrs.attributeName: { $exists: true }
+  //
+  bson_init(&mongoFilter);
+  BSON_APPEND_DOCUMENT_BEGIN(&mongoFilter, "_id.id", &in);
+  BSON_APPEND_ARRAY_BEGIN(&in, "$in", &idArray);
+
+  for (int ix = 0; ix < entitiesInArray; ix++)
+  {
+    char         indexBuf[16];
+    const char*  indexKey;
+
+    bson_uint32_to_string(ix, &indexKey, indexBuf, sizeof(indexBuf));
+    BSON_APPEND_UTF8(&idArray, indexKey, entityArray[ix]);
+  }
+
+  bson_append_array_end(&in, &idArray);
+  bson_append_document_end(&mongoFilter, &in);
+
+  BSON_APPEND_DOCUMENT_BEGIN(&mongoFilter, attrPath, &exists);
+  BSON_APPEND_BOOL(&exists, "$exists", true);
+  bson_append_document_end(&mongoFilter, &exists);
+
+  //
+  // We don't want the entire entities - only _id.id and the attribute in question
+  //
+  bson_init(&opts);
+  BSON_APPEND_DOCUMENT_BEGIN(&opts, "projection", &projection);
+  BSON_APPEND_INT32(&projection, "_id.id", 1);
+  BSON_APPEND_INT32(&projection, attrPath, 1);
+  bson_append_document_end(&opts, &projection);
+
+  mongoCursorP = mongoc_collection_find_with_opts(collectionP, &mongoFilter, &opts, NULL);
+
+  //
+  // Iterating over results
+  //
+  while (mongoc_cursor_next(mongoCursorP, &mongoDocP))
+  {
+    char*    title;
+    char*    details;
+    KjNode*  entityP = mongocKjTreeFromBson(mongoDocP, false, &title, &details);
+
+    if (entityP == NULL)
+      LM_E(("%s: %s", title, details));
+    else
+      kjChildAdd(kjTree, entityP);
+  }
+
+  if (mongoc_cursor_error(mongoCursorP, &mongoError))
+    LM_E(("Database Error (looking up attribute '%s' of %d entities: %s)", attributeName, entitiesInArray, mongoError.message));
+
+  mongoc_cursor_destroy(mongoCursorP);
+  bson_destroy(&opts);
+  bson_destroy(&mongoFilter);
+  mongoc_collection_destroy(collectionP);
+
+  return kjTree;
+}
@@ -0,0 +1,86 @@
+/*
+*
+* Copyright 2021 FIWARE Foundation e.V.
+*
+* This file is part of Orion-LD Context Broker.
+*
+* Orion-LD Context Broker is free software: you can redistribute it and/or
+* modify it under the terms of the GNU Affero General Public License as
+* published by the Free Software Foundation, either version 3 of the
+* License, or (at your option) any later version.
+*
+* Orion-LD Context Broker is distributed in the hope that it will be useful,
+* but WITHOUT ANY WARRANTY; without even the implied warranty of
+* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU Affero
+* General Public License for more details.
+*
+* You should have received a copy of the GNU Affero General Public License
+* along with Orion-LD Context Broker. If not, see http://www.gnu.org/licenses/.
+*
+* For those usages not covered by this license please contact with
+* orionld at fiware dot org
+*
+* Author: Ken Zangelin
+*/
+#include <mongoc/mongoc.h>                                       // MongoDB C Client Driver
+
+extern "C"
+{
+#include "kjson/KjNode.h"                                        // KjNode
+}
+
+#include "logMsg/logMsg.h"                                       // LM_*
+#include "logMsg/traceLevels.h"                                  // Lmt*
+
+#include "orionld/mongoc/mongocCollectionGet.h"                  // mongocCollectionGet
+#include "orionld/mongoc/mongocEntitiesDelete.h"                 // Own interface
+
+
+
+// -----------------------------------------------------------------------------
+//
+// mongocEntitiesDelete - delete a number of entities, in one unordered bulk operation
+//
+bool mongocEntitiesDelete(KjNode* entityIdsArray)
+{
+  mongoc_collection_t*      collectionP = mongocCollectionGet("entities");
+  mongoc_bulk_operation_t*  bulkP;
+  bson_t                    opts;
+  bson_error_t              mongoError;
+  bool                      ok = true;
+
+  if (collectionP == NULL)
+    return false;
+
+  bson_init(&opts);
+  BSON_APPEND_BOOL(&opts, "ordered", false);
+  bulkP = mongoc_collection_create_bulk_operation_with_opts(collectionP, &opts);
+
+  for (KjNode* idNodeP = entityIdsArray->value.firstChildP; idNodeP != NULL; idNodeP = idNodeP->next)
+  {
+    bson_t mongoFilter;
+
+    bson_init(&mongoFilter);
+    BSON_APPEND_UTF8(&mongoFilter, "_id.id", idNodeP->value.s);
+
+    if (mongoc_bulk_operation_remove_one_with_opts(bulkP, &mongoFilter, NULL, &mongoError) == false)
+    {
+      LM_E(("Database Error (adding the deletion of entity '%s' to a bulk operation: %s)", idNodeP->value.s, mongoError.message));
+      ok = false;
+    }
+
+    bson_destroy(&mongoFilter);
+  }
+
+  if ((ok == true) && (mongoc_bulk_operation_execute(bulkP, NULL, &mongoError) == 0))
+  {
+    LM_E(("Database Error (deleting entities: %s)", mongoError.message));
+    ok = false;
+  }
+
+  mongoc_bulk_operation_destroy(bulkP);
+  bson_destroy(&opts);
+  mongoc_collection_destroy(collectionP);
+
+  return ok;
+}
@@ -0,0 +1,471 @@
+/*
+*
+* Copyright 2021 FIWARE Foundation e.V.
+*
+* This file is part of Orion-LD Context Broker.
+*
+* Orion-LD Context Broker is free software: you can redistribute it and/or
+* modify it under the terms of the GNU Affero General Public License as
+* published by the Free Software Foundation, either version 3 of the
+* License, or (at your option) any later version.
+*
+* Orion-LD Context Broker is distributed in the hope that it will be useful,
+* but WITHOUT ANY WARRANTY; without even the implied warranty of
+* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU Affero
+* General Public License for more details.
+*
+* You should have received a copy of the GNU Affero General Public License
+* along with Orion-LD Context Broker. If not, see http://www.gnu.org/licenses/.
+*
+* For those usages not covered by this license please contact with
+* orionld at fiware dot org
+*
+* Author: Ken Zangelin
+*/
+#include <string.h>                                              // strcmp, strncmp
+#include <stdlib.h>                                              // atoi
+#include <stdio.h>                                               // snprintf
+#include <mongoc/mongoc.h>                                       // MongoDB C Client Driver
+
+extern "C"
+{
+#include "kjson/KjNode.h"                                        // KjNode
+#include "kjson/kjBuilder.h"                                     // kjArray, kjObject, kjChildAdd
+}
+
+#include "logMsg/logMsg.h"                                       // LM_*
+#include "logMsg/traceLevels.h"                                  // Lmt*
+
+#include "orionld/common/QNode.h"                                // QNode
+#include "orionld/common/orionldState.h"                         // orionldState
+#include "orionld/common/orionldErrorResponse.h"                 // orionldErrorResponseCreate
+#include "orionld/common/SCOMPARE.h"                             // SCOMPARE
+#include "orionld/mongoc/mongocCollectionGet.h"                  // mongocCollectionGet
+#include "orionld/mongoc/mongocKjTreeToBson.h"                   // mongocKjTreeToBson
+#include "orionld/mongoc/mongocKjTreeFromBson.h"                 // mongocKjTreeFromBson
+#include "orionld/mongoc/mongocQtreeToBson.h"                    // mongocQtreeToBson
+#include "orionld/mongoc/mongocEntitiesQuery.h"                  // Own interface
+
+
+
+// -----------------------------------------------------------------------------
+//
+// entityInfoArrayFilter -
+//
+static void entityInfoArrayFilter(bson_t* mongoFilterP, KjNode* entityInfoArrayP)
+{
+  bson_t    orArray;
+  uint32_t  ix = 0;
+
+  //
+  // First a check: an entity info item without restrictions matches all entities - no filter at all is needed then
+  //
+  for (KjNode* entityP = entityInfoArrayP->value.firstChildP; entityP != NULL; entityP = entityP->next)
+  {
+    bool eTouched = false;
+
+    for (KjNode* nodeP = entityP->value.firstChildP; nodeP != NULL; nodeP = nodeP->next)
+    {
+      if ((strcmp(nodeP->name, "id") == 0) || (strcmp(nodeP->name, "@id") == 0))
+        eTouched = true;
+      else if ((strcmp(nodeP->name, "idPattern") == 0) && (strcmp(nodeP->value.s, ".*") != 0))
+        eTouched = true;
+      else if ((strcmp(nodeP->name, "type") == 0) || (strcmp(nodeP->name, "@type") == 0))
+        eTouched = true;
+    }
+
+    if (eTouched == false)
+      return;
+  }
+
+  BSON_APPEND_ARRAY_BEGIN(mongoFilterP, "$or", &orArray);
+
+  for (KjNode* entityP = entityInfoArrayP->value.firstChildP; entityP != NULL; entityP = entityP->next)
+  {
+    KjNode*      idP        = NULL;
+    KjNode*      idPatternP = NULL;
+    KjNode*      typeP      = NULL;
+    char         indexBuf[16];
+    const char*  indexKey;
+    bson_t       ePart;
+
+    for (KjNode* nodeP = entityP->value.firstChildP; nodeP != NULL; nodeP = nodeP->next)
+    {
+      if ((strcmp(nodeP->name, "id") == 0) || (strcmp(nodeP->name, "@id") == 0))
+        idP = nodeP;
+      else if (strcmp(nodeP->name, "idPattern") == 0)
+        idPatternP = nodeP;
+      else if ((strcmp(nodeP->name, "type") == 0) || (strcmp(nodeP->name, "@type") == 0))
+        typeP = nodeP;
+    }
+
+    bson_uint32_to_string(ix++, &indexKey, indexBuf, sizeof(indexBuf));
+    BSON_APPEND_DOCUMENT_BEGIN(&orArray, indexKey, &ePart);
+
+    if (idP != NULL)
+      BSON_APPEND_UTF8(&ePart, "_id.id", idP->value.s);
+    else if ((idPatternP != NULL) && (strcmp(idPatternP->value.s, ".*") != 0))
+      BSON_APPEND_REGEX(&ePart, "_id.id", idPatternP->value.s, NULL);
+
+    if (typeP != NULL)
+      BSON_APPEND_UTF8(&ePart, "_id.type", typeP->value.s);
+
+    bson_append_document_end(&orArray, &ePart);
+  }
+
+  bson_append_array_end(mongoFilterP, &orArray);
+}
+
+
+
+// -----------------------------------------------------------------------------
+//
+// attrsFilter -
+//
+// mongo shell: { "attrNames": { "$in": [ "A1", "A2" ] } }
+//
+static void attrsFilter(bson_t* mongoFilterP, KjNode* attrsP)
+{
+  bson_t    in;
+  bson_t    attrArray;
+  uint32_t  ix = 0;
+
+  BSON_APPEND_DOCUMENT_BEGIN(mongoFilterP, "attrNames", &in);
+  BSON_APPEND_ARRAY_BEGIN(&in, "$in", &attrArray);
+
+  for (KjNode* attrP = attrsP->value.firstChildP; attrP != NULL; attrP = attrP->next)
+  {
+    char         indexBuf[16];
+    const char*  indexKey;
+
+    bson_uint32_to_string(ix++, &indexKey, indexBuf, sizeof(indexBuf));
+    BSON_APPEND_UTF8(&attrArray, indexKey, attrP->value.s);
+  }
+
+  bson_append_array_end(&in, &attrArray);
+  bson_append_document_end(mongoFilterP, &in);
+}
+
+
+
+// -----------------------------------------------------------------------------
+//
+// geoqNearFilter -
+//
+// {
+//   "attrs.location.value": {
+//     $nearSphere: {
+//       $geometry: {
+//         type: "Point",
+//         coordinates: [ -73.9667, 40.78 ]
+//       },
+//       $minDistance: 1000,
+//       $maxDistance: 5000
+//     }
+//   }
+// }
+//
+static bool geoqNearFilter(bson_t* mongoFilterP, const char* geoPropertyPath, char* geometry, char* georel, KjNode* coordinatesP)
+{
+  char* maxDistance = NULL;
+  char* minDistance = NULL;
+
+  if (strncmp(georel, "maxDistance==", 13) == 0)
+    maxDistance = &georel[13];
+  if (strncmp(georel, "minDistance==", 13) == 0)
+    minDistance = &georel[13];
+
+  if ((maxDistance == NULL) && (minDistance == NULL))
+  {
+    LM_W(("Bad Input (no distance for 'near' georel)"));
+    return false;
+  }
+
+  //
+  // Getting the coordinates
+  //
+  double    coords[3] = { 0, 0, 0 };
+  int       coordIx   = 0;
+  KjNode*   coordsP   = coordinatesP->value.firstChildP;
+
+  for (KjNode* coordP = coordsP->value.firstChildP; (coordP != NULL) && (coordIx < 3); coordP = coordP->next)
+  {
+    coords[coordIx++] = (coordP->type == KjFloat)? coordP->value.f : coordP->value.i;
+  }
+
+  //
+  // Creating the mongo query
+  //
+  bson_t geoObj;
+  bson_t nearObj;
+  bson_t geometryObj;
+  bson_t coordsArray;
+
+  BSON_APPEND_DOCUMENT_BEGIN(mongoFilterP, geoPropertyPath, &geoObj);
+  BSON_APPEND_DOCUMENT_BEGIN(&geoObj, "$nearSphere", &nearObj);
+  BSON_APPEND_DOCUMENT_BEGIN(&nearObj, "$geometry", &geometryObj);
+
+  BSON_APPEND_UTF8(&geometryObj, "type", geometry);
+  BSON_APPEND_ARRAY_BEGIN(&geometryObj, "coordinates", &coordsArray);
+  BSON_APPEND_DOUBLE(&coordsArray, "0", coords[0]);
+  BSON_APPEND_DOUBLE(&coordsArray, "1", coords[1]);
+  bson_append_array_end(&geometryObj, &coordsArray);
+
+  bson_append_document_end(&nearObj, &geometryObj);
+
+  if (minDistance != NULL)
+    BSON_APPEND_INT32(&nearObj, "$minDistance", atoi(minDistance));
+  if (maxDistance != NULL)
+    BSON_APPEND_INT32(&nearObj, "$maxDistance", atoi(maxDistance));
+
+  bson_append_document_end(&geoObj, &nearObj);
+  bson_append_document_end(mongoFilterP, &geoObj);
+
+  return true;
+}
+
+
+
+// -----------------------------------------------------------------------------
+//
+// geoqOperatorFilter - within, intersects, disjoint and overlaps
+//
+// {
+//   <location field>: {
+//     [$not: {]
+//       <operator>: {
+//         $geometry: {
+//           type: "<GeoJSON object type>" ,
+//           coordinates: [ <coordinates> ]
+//         }
+//       }
+//     [}]
+//   }
+// }
+//
+static bool geoqOperatorFilter(bson_t* mongoFilterP, const char* geoPropertyPath, const char* op, bool negated, char* geometry, KjNode* coordinatesP)
+{
+  bson_t  geoObj;
+  bson_t  notObj;
+  bson_t  opObj;
+  bson_t  geometryObj;
+  bson_t* opParentP = &geoObj;
+
+  BSON_APPEND_DOCUMENT_BEGIN(mongoFilterP, geoPropertyPath, &geoObj);
+
+  if (negated)
+  {
+    BSON_APPEND_DOCUMENT_BEGIN(&geoObj, "$not", &notObj);
+    opParentP = &notObj;
+  }
+
+  BSON_APPEND_DOCUMENT_BEGIN(opParentP, op, &opObj);
+  BSON_APPEND_DOCUMENT_BEGIN(&opObj, "$geometry", &geometryObj);
+  BSON_APPEND_UTF8(&geometryObj, "type", geometry);
+  mongocKjTreeToBson(coordinatesP, &geometryObj);  // coordinates: [ [], [] ]
+  bson_append_document_end(&opObj, &geometryObj);
+  bson_append_document_end(opParentP, &opObj);
+
+  if (negated)
+    bson_append_document_end(&geoObj, &notObj);
+
+  bson_append_document_end(mongoFilterP, &geoObj);
+
+  return true;
+}
+
+
+
+// -----------------------------------------------------------------------------
+//
+// geoqEqualsFilter -
+//
+// This is not really a GEo-Query - just an EQ comparison over objects
+//
+static bool geoqEqualsFilter(bson_t* mongoFilterP, const char* geoPropertyPath, KjNode* geometryP, KjNode* coordsP)
+{
+  KjNode* nodeP = kjObject(orionldState.kjsonP, NULL);
+  bson_t  valueObj;
+
+  geometryP->name = (char*) "type";
+  kjChildAdd(nodeP, geometryP);
+  kjChildAdd(nodeP, coordsP);
+
+  BSON_APPEND_DOCUMENT_BEGIN(mongoFilterP, geoPropertyPath, &valueObj);
+  mongocKjTreeToBson(nodeP, &valueObj);
+  bson_append_document_end(mongoFilterP, &valueObj);
+
+  return true;
+}
+
+
+
+// -----------------------------------------------------------------------------
+//
+// geoqFilter -
+//
+static void geoqFilter(bson_t* mongoFilterP, KjNode* geoqP)
+{
+  KjNode* geometryP      = NULL;
+  KjNode* georelP        = NULL;
+  KjNode* coordsP        = NULL;
+  KjNode* geopropertyP   = NULL;
+
+  for (KjNode* nodeP = geoqP->value.firstChildP; nodeP != NULL; nodeP = nodeP->next)
+  {
+    if (strcmp(nodeP->name, "geometry") == 0)
+      geometryP = nodeP;
+    else if (strcmp(nodeP->name, "georel") == 0)
+      georelP = nodeP;
+    else if (strcmp(nodeP->name, "coordinates") == 0)
+      coordsP = nodeP;
+    else if (strcmp(nodeP->name, "geoproperty") == 0)
+      geopropertyP = nodeP;
+  }
+
+  char* georel      = georelP->value.s;
+  char* geometry    = geometryP->value.s;
+  char* geoproperty = (geopropertyP != NULL)? geopropertyP->value.s : (char*) "location";
+  char  geoPropertyPath[512];
+  int   size;
+
+  size = snprintf(geoPropertyPath, sizeof(geoPropertyPath), "attrs.%s.value", geoproperty);
+
+  //
+  // geo-equality uses the coordinates as is, all other geo-relations need an object for "coordinates": []
+  //
+  if (SCOMPARE7(georel, 'e', 'q', 'u', 'a', 'l', 's', 0))
+  {
+    geoqEqualsFilter(mongoFilterP, geoPropertyPath, geometryP, coordsP);
+    return;
+  }
+
+  KjNode* coordinatesP = kjObject(orionldState.kjsonP, NULL);
+  kjChildAdd(coordinatesP, coordsP);
+
+  if (SCOMPARE5(georel, 'n', 'e', 'a', 'r', ';'))
+    geoqNearFilter(mongoFilterP, geoPropertyPath, geometry, &georel[5], coordinatesP);
+  else if (SCOMPARE7(georel, 'w', 'i', 't', 'h', 'i', 'n', 0))
+    geoqOperatorFilter(mongoFilterP, geoPropertyPath, "$geoWithin", false, geometry, coordinatesP);
+  else if (SCOMPARE11(georel, 'i', 'n', 't', 'e', 'r', 's', 'e', 'c', 't', 's', 0))
+    geoqOperatorFilter(mongoFilterP, geoPropertyPath, "$geoIntersects", false, geometry, coordinatesP);
+  else if (SCOMPARE9(georel, 'd', 'i', 's', 'j', 'o', 'i', 'n', 't', 0))
+    geoqOperatorFilter(mongoFilterP, geoPropertyPath, "$geoIntersects", true, geometry, coordinatesP);
+  else if (SCOMPARE9(georel, 'o', 'v', 'e', 'r', 'l', 'a', 'p', 's', 0))
+  {
+    // overlaps: intersects AND is of the same GEO-Type
+    geoqOperatorFilter(mongoFilterP, geoPropertyPath, "$geoIntersects", false, geometry, coordinatesP);
+
+    if (size + 5 < (int) sizeof(geoPropertyPath))
+    {
+      strcat(geoPropertyPath, ".type");
+      BSON_APPEND_UTF8(mongoFilterP, geoPropertyPath, geometry);
+    }
+  }
+}
+
+
+
+// -----------------------------------------------------------------------------
+//
+// mongocEntitiesQuery -
+//
+KjNode* mongocEntitiesQuery(KjNode* entityInfoArrayP, KjNode* attrsP, QNode* qP, KjNode* geoqP, int limit, int offset, int* countP)
+{
+  bson_t  mongoFilter;
+  char*   title;
+  char*   detail;
+
+  bson_init(&mongoFilter);
+
+  if ((entityInfoArrayP != NULL) && (entityInfoArrayP->value.firstChildP != NULL))
+    entityInfoArrayFilter(&mongoFilter, entityInfoArrayP);
+
+  if (attrsP != NULL)
+    attrsFilter(&mongoFilter, attrsP);
+
+  if ((qP != NULL) && (mongocQtreeToBson(qP, &mongoFilter, &title, &detail) == false))
+  {
+    LM_W(("Bad Input (mongocQtreeToBson: %s: %s)", title, detail));
+    orionldErrorResponseCreate(OrionldBadRequestData, title, detail);
+    bson_destroy(&mongoFilter);
+    return NULL;
+  }
+
+  if (geoqP != NULL)
+    geoqFilter(&mongoFilter, geoqP);
+
+  mongoc_collection_t* collectionP = mongocCollectionGet("entities");
+  if (collectionP == NULL)
+  {
+    bson_destroy(&mongoFilter);
+    return NULL;
+  }
+
+  KjNode*       arrayP = kjArray(orionldState.kjsonP, NULL);
+  bson_error_t  mongoError;
+
+  //
+  // Count asked for ?
+  //
+  if (countP != NULL)
+  {
+    int64_t count = mongoc_collection_count_documents(collectionP, &mongoFilter, NULL, NULL, NULL, &mongoError);
+
+    if (count < 0)
+    {
+      LM_E(("Database Error (asking for the number of hits: %s)", mongoError.message));
+      arrayP = NULL;
+      limit  = 0;  // Just to avoid performing the query
+    }
+    else
+      *countP = (int) count;
+  }
+
+  //
+  // Performing the Query to the database
+  //
+  if (limit != 0)
+  {
+    bson_t            opts;
+    bson_t            sortDoc;
+    mongoc_cursor_t*  mongoCursorP;
+    const bson_t*     mongoDocP;
+
+    // Sort according to creDate
+    bson_init(&opts);
+    BSON_APPEND_DOCUMENT_BEGIN(&opts, "sort", &sortDoc);
+    BSON_APPEND_INT32(&sortDoc, "creDate", 1);
+    bson_append_document_end(&opts, &sortDoc);
+    BSON_APPEND_INT64(&opts, "limit", limit);
+    BSON_APPEND_INT64(&opts, "skip",  offset);
+
+    mongoCursorP = mongoc_collection_find_with_opts(collectionP, &mongoFilter, &opts, NULL);
+
+    while (mongoc_cursor_next(mongoCursorP, &mongoDocP))
+    {
+      char*    title;
+      char*    details;
+      KjNode*  entityP = mongocKjTreeFromBson(mongoDocP, false, &title, &details);
+
+      if (entityP == NULL)
+      {
+        LM_E(("mongocKjTreeFromBson: %s: %s", title, details));
+        continue;
+      }
+
+      kjChildAdd(arrayP, entityP);
+    }
+
+    if (mongoc_cursor_error(mongoCursorP, &mongoError))
+      LM_E(("Database Error (%s)", mongoError.message));
+
+    mongoc_cursor_destroy(mongoCursorP);
+    bson_destroy(&opts);
+  }
+
+  bson_destroy(&mongoFilter);
+  mongoc_collection_destroy(collectionP);
+
+  return arrayP;
+}
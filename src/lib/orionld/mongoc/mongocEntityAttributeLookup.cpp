@@ -0,0 +1,96 @@
+/*
+*
+* Copyright 2021 FIWARE Foundation e.V.
+*
+* This file is part of Orion-LD Context Broker.
+*
+* Orion-LD Context Broker is free software: you can redistribute it and/or
+* modify it under the terms of the GNU Affero General Public License as
+* published by the Free Software Foundation, either version 3 of the
+* License, or (at your option) any later version.
+*
+* Orion-LD Context Broker is distributed in the hope that it will be useful,
+* but WITHOUT ANY WARRANTY; without even the implied warranty of
+* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU Affero
+* General Public License for more details.
+*
+* You should have received a copy of the GNU Affero General Public License
+* along with Orion-LD Context Broker. If not, see http://www.gnu.org/licenses/.
+*
+* For those usages not covered by this license please contact with
+* orionld at fiware dot org
+*
+* Author: Ken Zangelin
+*/
+#include <mongoc/mongoc.h>                                       // MongoDB C Client Driver
+
+extern "C"
+{
+#include "kjson/KjNode.h"                                        // KjNode
+}
+
+#include "logMsg/logMsg.h"                                       // LM_*
+#include "logMsg/traceLevels.h"                                  // Lmt*
+
+#include "orionld/mongoc/mongocCollectionGet.h"                  // mongocCollectionGet
+#include "orionld/mongoc/mongocKjTreeFromBson.h"                 // mongocKjTreeFromBson
+#include "orionld/mongoc/mongocRelationshipsFix.h"               // mongocRelationshipsFix
+#include "orionld/mongoc/mongocEntityAttributeLookup.h"          // Own interface
+
+
+
+// ----------------------------------------------------------------------------
+//
+// mongocEntityAttributeLookup - lookup an entity, only if it has the attribute 'attributeName'
+//
+KjNode* mongocEntityAttributeLookup(const char* entityId, const char* attributeName)
+{
+  mongoc_collection_t*  collectionP = mongocCollectionGet("entities");
+  bson_t                mongoFilter;
+  bson_t                opts;
+  const bson_t*         mongoDocP;
+  mongoc_cursor_t*      mongoCursorP;
+  bson_error_t          mongoError;
+  KjNode*               kjTree      = NULL;
+
+  if (collectionP == NULL)
+    return NULL;
+
+  //
+  // Filter - Entity ID and attrNames::attributeName
+  //
+  bson_init(&mongoFilter);
+  BSON_APPEND_UTF8(&mongoFilter, "_id.id", entityId);
+  BSON_APPEND_UTF8(&mongoFilter, "attrNames", attributeName);
+
+  bson_init(&opts);
+  BSON_APPEND_INT64(&opts, "limit", 1);
+
+  mongoCursorP = mongoc_collection_find_with_opts(collectionP, &mongoFilter, &opts, NULL);
+
+  if (mongoc_cursor_next(mongoCursorP, &mongoDocP))
+  {
+    char* title;
+    char* details;
+
+    kjTree = mongocKjTreeFromBson(mongoDocP, false, &title, &details);
+    if (kjTree == NULL)
+      LM_E(("%s: %s", title, details));
+  }
+
+  if (mongoc_cursor_error(mongoCursorP, &mongoError))
+  {
+    LM_E(("Database Error (looking up attribute '%s' of entity '%s': %s)", attributeName, entityId, mongoError.message));
+    kjTree = NULL;
+  }
+
+  mongoc_cursor_destroy(mongoCursorP);
+  bson_destroy(&opts);
+  bson_destroy(&mongoFilter);
+  mongoc_collection_destroy(collectionP);
+
+  if (kjTree != NULL)
+    mongocRelationshipsFix(kjTree);
+
+  return kjTree;
+}
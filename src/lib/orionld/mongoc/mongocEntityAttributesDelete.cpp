@@ -0,0 +1,123 @@
+/*
+*
+* Copyright 2021 FIWARE Foundation e.V.
+*
+* This file is part of Orion-LD Context Broker.
+*
+* Orion-LD Context Broker is free software: you can redistribute it and/or
+* modify it under the terms of the GNU Affero General Public License as
+* published by the Free Software Foundation, either version 3 of the
+* License, or (at your option) any later version.
+*
+* Orion-LD Context Broker is distributed in the hope that it will be useful,
+* but WITHOUT ANY WARRANTY; without even the implied warranty of
+* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU Affero
+* General Public License for more details.
+*
+* You should have received a copy of the GNU Affero General Public License
+* along with Orion-LD Context Broker. If not, see http://www.gnu.org/licenses/.
+*
+* For those usages not covered by this license please contact with
+* orionld at fiware dot org
+*
+* Author: Ken Zangelin
+*/
+#include <stdio.h>                                               // snprintf
+#include <string.h>                                              // strlen
+
+#include <mongoc/mongoc.h>                                       // MongoDB C Client Driver
+
+extern "C"
+{
+#include "kalloc/kaAlloc.h"                                      // kaAlloc
+}
+
+#include "logMsg/logMsg.h"                                       // LM_*
+#include "logMsg/traceLevels.h"                                  // Lmt*
+
+#include "orionld/common/orionldState.h"                         // orionldState
+#include "orionld/common/eqForDot.h"                             // eqForDot
+#include "orionld/mongoc/mongocCollectionGet.h"                  // mongocCollectionGet
+#include "orionld/mongoc/mongocEntityAttributesDelete.h"         // Own interface
+
+
+
+// -----------------------------------------------------------------------------
+//
+// mongocEntityAttributesDelete -
+//
+// Mongo Shell Example:
+//   db.entities.update({"_id.id": "urn:ngsi-ld:entities:E1"},
+//                      {"$unset": { "attrs.https://uri=etsi=org/ngsi-ld/default-context/P1": 1, "attrs.https://uri=etsi=org/ngsi-ld/default-context/P2": 1 }})
+//                      {"$pull":  { "attrNames": { "$in": [ "attrs.https://uri=etsi=org/ngsi-ld/default-context/P1", "attrs.https://uri=etsi=org/ngsi-ld/default-context/P2" ] }}}
+//
+bool mongocEntityAttributesDelete(const char* entityId, char** attrNameV, int vecSize)
+{
+  mongoc_collection_t*  collectionP = mongocCollectionGet("entities");
+  bson_t                mongoFilter;
+  bson_t                update;
+  bson_t                unset;
+  bson_t                pull;
+  bson_t                pullIn;
+  bson_t                pullInVec;
+  bson_error_t          mongoError;
+  bool                  ok;
+
+  if (collectionP == NULL)
+    return false;
+
+  //
+  // Entity ID
+  //
+  bson_init(&mongoFilter);
+  BSON_APPEND_UTF8(&mongoFilter, "_id.id", entityId);
+
+  //
+  // Attributes to remove from 'attrs', using $unset
+  // Due to the database model, we also need to remove the attributes from 'attrNames', using $pull
+  //
+  bson_init(&update);
+  BSON_APPEND_DOCUMENT_BEGIN(&update, "$unset", &unset);
+
+  for (int ix = 0; ix < vecSize; ix++)
+  {
+    int   attrNameLen   = strlen(attrNameV[ix]);
+    int   mongoPathLen  = 6  + attrNameLen + 1;  // 6  == strlen("attrs."),     1 == zero-termination
+    char* mongoPath     = (char*) kaAlloc(&orionldState.kalloc, mongoPathLen);
+
+    snprintf(mongoPath, mongoPathLen, "attrs.%s", attrNameV[ix]);
+    BSON_APPEND_INT32(&unset, mongoPath, 1);
+  }
+  bson_append_document_end(&update, &unset);
+
+  BSON_APPEND_DOCUMENT_BEGIN(&update, "$pull", &pull);
+  BSON_APPEND_DOCUMENT_BEGIN(&pull, "attrNames", &pullIn);
+  BSON_APPEND_ARRAY_BEGIN(&pullIn, "$in", &pullInVec);
+
+  for (int ix = 0; ix < vecSize; ix++)
+  {
+    char         indexBuf[16];
+    const char*  indexKey;
+
+    eqForDot(attrNameV[ix]);
+    bson_uint32_to_string(ix, &indexKey, indexBuf, sizeof(indexBuf));
+    BSON_APPEND_UTF8(&pullInVec, indexKey, attrNameV[ix]);
+  }
+
+  bson_append_array_end(&pullIn, &pullInVec);
+  bson_append_document_end(&pull, &pullIn);
+  bson_append_document_end(&update, &pull);
+
+  //
+  // Updating database
+  //
+  ok = mongoc_collection_update_one(collectionP, &mongoFilter, &update, NULL, NULL, &mongoError);
+  if (ok == false)
+    LM_E(("Database Error (deleting attributes of entity '%s': %s)", entityId, mongoError.message));
+
+  bson_destroy(&update);
+  bson_destroy(&mongoFilter);
+  mongoc_collection_destroy(collectionP);
+
+  return ok;
+}
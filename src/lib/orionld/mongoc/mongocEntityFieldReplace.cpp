@@ -0,0 +1,110 @@
+/*
+*
+* Copyright 2021 FIWARE Foundation e.V.
+*
+* This file is part of Orion-LD Context Broker.
+*
+* Orion-LD Context Broker is free software: you can redistribute it and/or
+* modify it under the terms of the GNU Affero General Public License as
+* published by the Free Software Foundation, either version 3 of the
+* License, or (at your option) any later version.
+*
+* Orion-LD Context Broker is distributed in the hope that it will be useful,
+* but WITHOUT ANY WARRANTY; without even the implied warranty of
+* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU Affero
+* General Public License for more details.
+*
+* You should have received a copy of the GNU Affero General Public License
+* along with Orion-LD Context Broker. If not, see http://www.gnu.org/licenses/.
+*
+* For those usages not covered by this license please contact with
+* orionld at fiware dot org
+*
+* Author: Ken Zangelin
+*/
+#include <mongoc/mongoc.h>                                       // MongoDB C Client Driver
+
+extern "C"
+{
+#include "kjson/KjNode.h"                                        // KjNode
+}
+
+#include "logMsg/logMsg.h"                                       // LM_*
+#include "logMsg/traceLevels.h"                                  // Lmt*
+
+#include "orionld/common/orionldState.h"                         // orionldState
+#include "orionld/mongoc/mongocCollectionGet.h"                  // mongocCollectionGet
+#include "orionld/mongoc/mongocKjTreeToBson.h"                   // mongocKjTreeToBson
+#include "orionld/mongoc/mongocEntityFieldReplace.h"             // Own interface
+
+
+
+// -----------------------------------------------------------------------------
+//
+// mongocEntityFieldReplace - replace a top-level field of an entity (and its modDate)
+//
+// mongo shell:
+//   db.entities.update({ "_id.id": entityId }, { "$set": { fieldName: fieldValue, "modDate": requestTime } })
+//
+bool mongocEntityFieldReplace(const char* entityId, const char* fieldName, KjNode* fieldValeNodeP)
+{
+  mongoc_collection_t*  collectionP = mongocCollectionGet("entities");
+  bson_t                mongoFilter;
+  bson_t                update;
+  bson_t                set;
+  bson_error_t          mongoError;
+  bool                  ok;
+
+  if (collectionP == NULL)
+    return false;
+
+  //
+  // Filter
+  //
+  bson_init(&mongoFilter);
+  BSON_APPEND_UTF8(&mongoFilter, "_id.id", entityId);
+
+  //
+  // Update
+  //
+  bson_init(&update);
+  BSON_APPEND_DOCUMENT_BEGIN(&update, "$set", &set);
+
+  if ((fieldValeNodeP->type == KjObject) || (fieldValeNodeP->type == KjArray))
+  {
+    bson_t fieldValue;
+
+    if (fieldValeNodeP->type == KjObject)
+      BSON_APPEND_DOCUMENT_BEGIN(&set, fieldName, &fieldValue);
+    else
+      BSON_APPEND_ARRAY_BEGIN(&set, fieldName, &fieldValue);
+
+    mongocKjTreeToBson(fieldValeNodeP, &fieldValue);
+
+    if (fieldValeNodeP->type == KjObject)
+      bson_append_document_end(&set, &fieldValue);
+    else
+      bson_append_array_end(&set, &fieldValue);
+  }
+  else
+  {
+    char* nodeName = fieldValeNodeP->name;
+
+    fieldValeNodeP->name = (char*) fieldName;
+    mongocKjTreeToBson(fieldValeNodeP, &set);
+    fieldValeNodeP->name = nodeName;
+  }
+
+  BSON_APPEND_DOUBLE(&set, "modDate", orionldState.requestTime);
+  bson_append_document_end(&update, &set);
+
+  ok = mongoc_collection_update_one(collectionP, &mongoFilter, &update, NULL, NULL, &mongoError);
+  if (ok == false)
+    LM_E(("Database Error (replacing field '%s' of entity '%s': %s)", fieldName, entityId, mongoError.message));
+
+  bson_destroy(&update);
+  bson_destroy(&mongoFilter);
+  mongoc_collection_destroy(collectionP);
+
+  return ok;
+}
@@ -0,0 +1,193 @@
+/*
+*
+* Copyright 2021 FIWARE Foundation e.V.
+*
+* This file is part of Orion-LD Context Broker.
+*
+* Orion-LD Context Broker is free software: you can redistribute it and/or
+* modify it under the terms of the GNU Affero General Public License as
+* published by the Free Software Foundation, either version 3 of the
+* License, or (at your option) any later version.
+*
+* Orion-LD Context Broker is distributed in the hope that it will be useful,
+* but WITHOUT ANY WARRANTY; without even the implied warranty of
+* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU Affero
+* General Public License for more details.
+*
+* You should have received a copy of the GNU Affero General Public License
+* along with Orion-LD Context Broker. If not, see http://www.gnu.org/licenses/.
+*
+* For those usages not covered by this license please contact with
+* orionld at fiware dot org
+*
+* Author: Ken Zangelin
+*/
+#include <mongoc/mongoc.h>                                       // MongoDB C Client Driver
+
+extern "C"
+{
+#include "kjson/KjNode.h"                                        // KjNode
+#include "kjson/kjBuilder.h"                                     // kjArray, kjObject, kjString, kjFloat, kjChildAdd
+#include "kjson/kjLookup.h"                                      // kjLookup
+}
+
+#include "logMsg/logMsg.h"                                       // LM_*
+#include "logMsg/traceLevels.h"                                  // Lmt*
+
+#include "orionld/common/orionldState.h"                         // orionldState
+#include "orionld/mongoc/mongocCollectionGet.h"                  // mongocCollectionGet
+#include "orionld/mongoc/mongocKjTreeFromBson.h"                 // mongocKjTreeFromBson
+#include "orionld/mongoc/mongocEntityListLookupWithIdTypeCreDate.h"  // Own interface
+
+
+
+// -----------------------------------------------------------------------------
+//
+// mongocEntityListLookupWithIdTypeCreDate -
+//
+// This function extracts (from mongo) the entities whose ID are in the vector 'entityIdsArray'.
+// Instead of returning the complete information of the entities, only three fields are returned per entity, namely:
+//   * Entity ID
+//   * Entity Type
+//   * Entity Creation Date
+// (plus the array of attribute names, if 'attrNames' is set)
+//
+KjNode* mongocEntityListLookupWithIdTypeCreDate(KjNode* entityIdsArray, bool attrNames)
+{
+  mongoc_collection_t*  collectionP = mongocCollectionGet("entities");
+  bson_t                mongoFilter;
+  bson_t                inObj;
+  bson_t                idList;
+  bson_t                opts;
+  bson_t                projection;
+  const bson_t*         mongoDocP;
+  mongoc_cursor_t*      mongoCursorP;
+  bson_error_t          mongoError;
+  KjNode*               entitiesArray = NULL;
+  int                   entities      = 0;
+  int                   ix            = 0;
+
+  if (collectionP == NULL)
+    return NULL;
+
+  //
+  // Filter: { "_id.id": { "$in": [ id1, id2, ... ] } }
+  //
+  bson_init(&mongoFilter);
+  BSON_APPEND_DOCUMENT_BEGIN(&mongoFilter, "_id.id", &inObj);
+  BSON_APPEND_ARRAY_BEGIN(&inObj, "$in", &idList);
+
+  for (KjNode* idNodeP = entityIdsArray->value.firstChildP; idNodeP != NULL; idNodeP = idNodeP->next)
+  {
+    char         indexBuf[16];
+    const char*  indexKey;
+
+    bson_uint32_to_string(ix, &indexKey, indexBuf, sizeof(indexBuf));
+    BSON_APPEND_UTF8(&idList, indexKey, idNodeP->value.s);
+    ++ix;
+  }
+
+  bson_append_array_end(&inObj, &idList);
+  bson_append_document_end(&mongoFilter, &inObj);
+
+  //
+  // Specify the fields to return
+  //
+  bson_init(&opts);
+  BSON_APPEND_DOCUMENT_BEGIN(&opts, "projection", &projection);
+  BSON_APPEND_INT32(&projection, "_id",     1);  // "id" and "type" are inside "_id"
+  BSON_APPEND_INT32(&projection, "creDate", 1);
+
+  if (attrNames)
+    BSON_APPEND_INT32(&projection, "attrNames", 1);
+
+  bson_append_document_end(&opts, &projection);
+
+  mongoCursorP = mongoc_collection_find_with_opts(collectionP, &mongoFilter, &opts, NULL);
+
+  while (mongoc_cursor_next(mongoCursorP, &mongoDocP))
+  {
+    char*    title;
+    char*    details;
+    KjNode*  dbEntityP = mongocKjTreeFromBson(mongoDocP, false, &title, &details);
+
+    if (dbEntityP == NULL)
+    {
+      LM_E(("Internal Error (unable to extract entity from database: %s: %s)", title, details));
+      continue;
+    }
+
+    KjNode* idField = kjLookup(dbEntityP, "_id");
+    if ((idField == NULL) || (idField->type != KjObject))
+    {
+      LM_E(("Internal Error (unable to extract the field '_id' from an entity"));
+      continue;
+    }
+
+    KjNode* idNodeP = kjLookup(idField, "id");
+    if ((idNodeP == NULL) || (idNodeP->type != KjString))
+    {
+      LM_E(("Internal Error (unable to extract the field '_id.id' from an entity"));
+      continue;
+    }
+
+    KjNode* typeNodeP = kjLookup(idField, "type");
+    if ((typeNodeP == NULL) || (typeNodeP->type != KjString))
+    {
+      LM_E(("Internal Error (unable to extract the field '_id.type' from the entity '%s'", idNodeP->value.s));
+      continue;
+    }
+
+    KjNode* creDateNodeP = kjLookup(dbEntityP, "creDate");
+    double  creDate;
+
+    if      ((creDateNodeP != NULL) && (creDateNodeP->type == KjFloat))  creDate = creDateNodeP->value.f;
+    else if ((creDateNodeP != NULL) && (creDateNodeP->type == KjInt))    creDate = creDateNodeP->value.i;
+    else
+    {
+      LM_E(("Internal Error (unable to extract the field 'creDate' from the entity '%s'", idNodeP->value.s));
+      continue;
+    }
+
+    KjNode* entityTree = kjObject(orionldState.kjsonP, NULL);
+
+    kjChildAdd(entityTree, kjString(orionldState.kjsonP, "id",      idNodeP->value.s));
+    kjChildAdd(entityTree, kjString(orionldState.kjsonP, "type",    typeNodeP->value.s));
+    kjChildAdd(entityTree, kjFloat(orionldState.kjsonP,  "creDate", creDate));
+
+    if (attrNames)
+    {
+      KjNode* attrNamesV = kjLookup(dbEntityP, "attrNames");
+
+      if ((attrNamesV == NULL) || (attrNamesV->type != KjArray))
+        attrNamesV = kjArray(orionldState.kjsonP, "attrNames");
+
+      kjChildAdd(entityTree, attrNamesV);
+    }
+
+    // Create the entity array if it doesn't already exist
+    if (entitiesArray == NULL)
+      entitiesArray = kjArray(orionldState.kjsonP, NULL);
+
+    // Add the Entity to the entity array
+    kjChildAdd(entitiesArray, entityTree);
+
+    // A limit of 200 entities has been established.
+    ++entities;
+    if (entities >= 200)
+    {
+      LM_W(("Too many entities - breaking loop at 200"));
+      break;
+    }
+  }
+
+  if (mongoc_cursor_error(mongoCursorP, &mongoError))
+    LM_E(("Database Error (looking up entities: %s)", mongoError.message));
+
+  mongoc_cursor_destroy(mongoCursorP);
+  bson_destroy(&opts);
+  bson_destroy(&mongoFilter);
+  mongoc_collection_destroy(collectionP);
+
+  return entitiesArray;
+}
@@ -32,10 +32,9 @@ extern "C"
 #include "logMsg/logMsg.h"                                       // LM_*
 #include "logMsg/traceLevels.h"                                  // Lmt*
 
-#include "orionld/common/orionldState.h"                         // orionldState, dbName, mongoEntitiesCollectionP
-#include "orionld/db/dbConfiguration.h"                          // dbDataToKjTree
-#include "orionld/db/dbNameGet.h"                                // dbNameGet
-#include "orionld/mongoc/mongocKjTreeFromBsonObj.h"              // mongocKjTreeFromBsonObj
+#include "orionld/mongoc/mongocCollectionGet.h"                  // mongocCollectionGet
+#include "orionld/mongoc/mongocKjTreeFromBson.h"                 // mongocKjTreeFromBson
+#include "orionld/mongoc/mongocRelationshipsFix.h"               // mongocRelationshipsFix
 #include "orionld/mongoc/mongocEntityLookup.h"                   // Own interface
 
 
@@ -46,48 +45,54 @@ extern "C"
 //
 KjNode* mongocEntityLookup(const char* entityId)
 {
-  char              dbName[512];
-  bson_t            mongoFilter;
-  const bson_t*     mongoDocP;
-  mongoc_cursor_t*  mongoCursorP;
-  bson_error_t      mongoError;
-  char*             title;
-  char*             details;
-  KjNode*           entityNodeP = NULL;
-
-  if (dbNameGet(dbName, sizeof(dbName)) == -1)
+  mongoc_collection_t*  collectionP = mongocCollectionGet("entities");
+  bson_t                mongoFilter;
+  bson_t                opts;
+  const bson_t*         mongoDocP;
+  mongoc_cursor_t*      mongoCursorP;
+  bson_error_t          mongoError;
+  KjNode*               entityNodeP = NULL;
+
+  if (collectionP == NULL)
     return NULL;
 
   //
-  // Create the filter for the query
+  // Create the filter for the query - only Entity ID for this operation
   //
-  bson_append_utf8(&mongoFilter, "_id.id", 6, entityId, -1);
+  bson_init(&mongoFilter);
+  BSON_APPEND_UTF8(&mongoFilter, "_id.id", entityId);
+
+  bson_init(&opts);
+  BSON_APPEND_INT64(&opts, "limit", 1);
 
   //
   // Run the query
   //
-  // semTake(&mongoEntitiesSem);
-  if ((mongoCursorP = mongoc_collection_find_with_opts(mongoEntitiesCollectionP, &mongoFilter, NULL, NULL)) == NULL)
-  {
-    LM_E(("Internal Error (mongoc_collection_find_with_opts ERROR)"));
-    return NULL;
-  }
+  mongoCursorP = mongoc_collection_find_with_opts(collectionP, &mongoFilter, &opts, NULL);
 
-  while (mongoc_cursor_next(mongoCursorP, &mongoDocP))
+  if (mongoc_cursor_next(mongoCursorP, &mongoDocP))
   {
-    entityNodeP = mongocKjTreeFromBsonObj(mongoDocP, &title, &details);
-    break;  // Just using the first one - should be no more than one!
+    char* title;
+    char* details;
+
+    entityNodeP = mongocKjTreeFromBson(mongoDocP, false, &title, &details);
+    if (entityNodeP == NULL)
+      LM_E(("%s: %s", title, details));
   }
 
   if (mongoc_cursor_error(mongoCursorP, &mongoError))
   {
-    LM_E(("Internal Error (DB Error '%s')", mongoError.message));
-    return NULL;
+    LM_E(("Database Error (looking up entity '%s': %s)", entityId, mongoError.message));
+    entityNodeP = NULL;
   }
 
   mongoc_cursor_destroy(mongoCursorP);
-  // semGive(&mongoEntitiesSem);
+  bson_destroy(&opts);
   bson_destroy(&mongoFilter);
+  mongoc_collection_destroy(collectionP);
+
+  if (entityNodeP != NULL)
+    mongocRelationshipsFix(entityNodeP);
 
   return entityNodeP;
 }
@@ -0,0 +1,143 @@
+/*
+*
+* Copyright 2021 FIWARE Foundation e.V.
+*
+* This file is part of Orion-LD Context Broker.
+*
+* Orion-LD Context Broker is free software: you can redistribute it and/or
+* modify it under the terms of the GNU Affero General Public License as
+* published by the Free Software Foundation, either version 3 of the
+* License, or (at your option) any later version.
+*
+* Orion-LD Context Broker is distributed in the hope that it will be useful,
+* but WITHOUT ANY WARRANTY; without even the implied warranty of
+* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU Affero
+* General Public License for more details.
+*
+* You should have received a copy of the GNU Affero General Public License
+* along with Orion-LD Context Broker. If not, see http://www.gnu.org/licenses/.
+*
+* For those usages not covered by this license please contact with
+* orionld at fiware dot org
+*
+* Author: Ken Zangelin
+*/
+#include <mongoc/mongoc.h>                                       // MongoDB C Client Driver
+
+extern "C"
+{
+#include "kbase/kTime.h"                                         // kTimeGet
+#include "kjson/KjNode.h"                                        // KjNode
+}
+
+#include "logMsg/logMsg.h"                                       // LM_*
+#include "logMsg/traceLevels.h"                                  // Lmt*
+
+#include "orionld/common/orionldState.h"                         // orionldState
+#include "orionld/common/performance.h"                          // REQUEST_PERFORMANCE
+#include "orionld/common/orionldLatency.h"                       // orionldLatencyPhaseStart, orionldLatencyPhaseEnd
+#include "orionld/db/dbModelToApiEntity.h"                       // dbModelToApiEntity
+#include "orionld/mongoc/mongocCollectionGet.h"                  // mongocCollectionGet
+#include "orionld/mongoc/mongocKjTreeFromBson.h"                 // mongocKjTreeFromBson
+#include "orionld/mongoc/mongocEntityRetrieve.h"                 // Own interface
+
+
+
+// ----------------------------------------------------------------------------
+//
+// mongocEntityRetrieve -
+//
+// PARAMETERS
+//   entityId        ID of the entity to be retrieved
+//   attrs           array of attribute names, terminated by a NULL pointer
+//   attrMandatory   If true - the entity is found only if any of the attributes in 'attrs'
+//                   is present in the entity
+//   sysAttrs        include 'createdAt' and 'modifiedAt'
+//   keyValues       short representation of the attributes
+//   geoProperty     long name of geopoperty - only if geo-json represenatation (else NULL)
+//
+KjNode* mongocEntityRetrieve
+(
+  const char*  entityId,
+  char**       attrs,
+  bool         attrMandatory,
+  bool         sysAttrs,
+  bool         keyValues,
+  const char*  datasetId,
+  const char*  geoPropertyName,
+  KjNode**     geoPropertyP
+)
+{
+  mongoc_collection_t*  collectionP = mongocCollectionGet("entities");
+  bson_t                mongoFilter;
+  bson_t                opts;
+  bson_t                projection;
+  const bson_t*         mongoDocP;
+  mongoc_cursor_t*      mongoCursorP;
+  bson_error_t          mongoError;
+  KjNode*               dbTree      = NULL;
+
+  if (collectionP == NULL)
+    return NULL;
+
+  //
+  // Filter - only Entity ID for this operation
+  //
+  bson_init(&mongoFilter);
+  BSON_APPEND_UTF8(&mongoFilter, "_id.id", entityId);
+
+  //
+  // Fields to return - _id is there by default
+  //
+  bson_init(&opts);
+  BSON_APPEND_DOCUMENT_BEGIN(&opts, "projection", &projection);
+  BSON_APPEND_INT32(&projection, "attrs", 1);
+  BSON_APPEND_INT32(&projection, "@datasets", 1);
+
+  if (sysAttrs == true)
+  {
+    BSON_APPEND_INT32(&projection, "creDate", 1);
+    BSON_APPEND_INT32(&projection, "modDate", 1);
+  }
+  bson_append_document_end(&opts, &projection);
+  BSON_APPEND_INT64(&opts, "limit", 1);
+
+  //
+  // Querying mongo and retrieving the results
+  //
+#ifdef REQUEST_PERFORMANCE
+  kTimeGet(&timestamps.dbStart);
+#endif
+  orionldLatencyPhaseStart(LP_DB);
+  mongoCursorP = mongoc_collection_find_with_opts(collectionP, &mongoFilter, &opts, NULL);
+
+  if (mongoc_cursor_next(mongoCursorP, &mongoDocP))
+  {
+    char* title;
+    char* details;
+
+    dbTree = mongocKjTreeFromBson(mongoDocP, false, &title, &details);
+    if (dbTree == NULL)
+      LM_E(("%s: %s", title, details));
+  }
+#ifdef REQUEST_PERFORMANCE
+  kTimeGet(&timestamps.dbEnd);
+#endif
+  orionldLatencyPhaseEnd(LP_DB);
+
+  if (mongoc_cursor_error(mongoCursorP, &mongoError))
+  {
+    LM_E(("Database Error (retrieving entity '%s': %s)", entityId, mongoError.message));
+    dbTree = NULL;
+  }
+
+  mongoc_cursor_destroy(mongoCursorP);
+  bson_destroy(&opts);
+  bson_destroy(&mongoFilter);
+  mongoc_collection_destroy(collectionP);
+
+  if (dbTree == NULL)  // Entity not found
+    return NULL;
+
+  return dbModelToApiEntity(dbTree, attrs, attrMandatory, sysAttrs, keyValues, geoPropertyName, geoPropertyP, &orionldState.geoPropertyMissing);
+}
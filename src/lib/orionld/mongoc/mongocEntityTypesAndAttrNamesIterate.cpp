@@ -0,0 +1,107 @@
+/*
+*
+* Copyright 2021 FIWARE Foundation e.V.
+*
+* This file is part of Orion-LD Context Broker.
+*
+* Orion-LD Context Broker is free software: you can redistribute it and/or
+* modify it under the terms of the GNU Affero General Public License as
+* published by the Free Software Foundation, either version 3 of the
+* License, or (at your option) any later version.
+*
+* Orion-LD Context Broker is distributed in the hope that it will be useful,
+* but WITHOUT ANY WARRANTY; without even the implied warranty of
+* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU Affero
+* General Public License for more details.
+*
+* You should have received a copy of the GNU Affero General Public License
+* along with Orion-LD Context Broker. If not, see http://www.gnu.org/licenses/.
+*
+* For those usages not covered by this license please contact with
+* orionld at fiware dot org
+*
+* Author: Ken Zangelin
+*/
+#include <vector>                                                // std::vector
+
+#include <mongoc/mongoc.h>                                       // MongoDB C Client Driver
+
+#include "logMsg/logMsg.h"                                       // LM_*
+#include "logMsg/traceLevels.h"                                  // Lmt*
+
+#include "orionld/types/OrionldTenant.h"                         // OrionldTenant
+#include "orionld/db/dbConfiguration.h"                          // DbEntityTypeAndAttrNamesCallback
+#include "orionld/mongoc/mongocCollectionGet.h"                  // mongocCollectionGetWithDb
+#include "orionld/mongoc/mongocEntityTypesAndAttrNamesIterate.h"  // Own interface
+
+
+
+// -----------------------------------------------------------------------------
+//
+// mongocEntityTypesAndAttrNamesIterate -
+//
+// The entities are streamed, one at a time, no KjNode tree is built - this is used to build the type catalog
+// of a tenant, and the tenant may have millions of entities.
+// The strings passed to the callback point inside the BSON of the entity - only valid during the call.
+//
+bool mongocEntityTypesAndAttrNamesIterate(OrionldTenant* tenantP, DbEntityTypeAndAttrNamesCallback callback, void* userP)
+{
+  mongoc_collection_t*      collectionP = mongocCollectionGetWithDb(tenantP->mongoDbName, "entities");
+  bson_t                    mongoFilter;
+  bson_t                    opts;
+  bson_t                    projection;
+  const bson_t*             mongoDocP;
+  mongoc_cursor_t*          mongoCursorP;
+  bson_error_t              mongoError;
+  std::vector<const char*>  attrNameV;
+  bool                      ok = true;
+
+  if (collectionP == NULL)
+    return false;
+
+  bson_init(&mongoFilter);
+  bson_init(&opts);
+
+  BSON_APPEND_DOCUMENT_BEGIN(&opts, "projection", &projection);
+  BSON_APPEND_INT32(&projection, "_id.type", 1);
+  BSON_APPEND_INT32(&projection, "attrNames", 1);
+  bson_append_document_end(&opts, &projection);
+
+  mongoCursorP = mongoc_collection_find_with_opts(collectionP, &mongoFilter, &opts, NULL);
+
+  while (mongoc_cursor_next(mongoCursorP, &mongoDocP))
+  {
+    bson_iter_t  iter;
+    bson_iter_t  typeIter;
+    bson_iter_t  attrIter;
+
+    if ((bson_iter_init(&iter, mongoDocP) == false) || (bson_iter_find_descendant(&iter, "_id.type", &typeIter) == false) || (BSON_ITER_HOLDS_UTF8(&typeIter) == false))
+      continue;
+
+    attrNameV.clear();
+
+    if ((bson_iter_init_find(&iter, mongoDocP, "attrNames") == true) && (BSON_ITER_HOLDS_ARRAY(&iter) == true) && (bson_iter_recurse(&iter, &attrIter) == true))
+    {
+      while (bson_iter_next(&attrIter))
+      {
+        if (BSON_ITER_HOLDS_UTF8(&attrIter))
+          attrNameV.push_back(bson_iter_utf8(&attrIter, NULL));
+      }
+    }
+
+    callback(userP, bson_iter_utf8(&typeIter, NULL), (attrNameV.size() > 0)? &attrNameV[0] : NULL, attrNameV.size());
+  }
+
+  if (mongoc_cursor_error(mongoCursorP, &mongoError))
+  {
+    LM_E(("Database Error (streaming the entities for the type catalog: %s)", mongoError.message));
+    ok = false;
+  }
+
+  mongoc_cursor_destroy(mongoCursorP);
+  bson_destroy(&opts);
+  bson_destroy(&mongoFilter);
+  mongoc_collection_destroy(collectionP);
+
+  return ok;
+}
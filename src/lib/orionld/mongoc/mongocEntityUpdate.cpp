@@ -32,17 +32,43 @@ extern "C"
 #include "logMsg/logMsg.h"                                       // LM_*
 #include "logMsg/traceLevels.h"                                  // Lmt*
 
-#include "orionld/db/dbNameGet.h"                                // dbNameGet
+#include "orionld/mongoc/mongocCollectionGet.h"                  // mongocCollectionGet
+#include "orionld/mongoc/mongocKjTreeToBson.h"                   // mongocKjTreeToBson
 #include "orionld/mongoc/mongocEntityUpdate.h"                   // Own interface
 
 
 
 // -----------------------------------------------------------------------------
 //
-// mongocEntityUpdate -
+// mongocEntityUpdate - replace an entity in the database with 'requestTree' (an entity in DB format)
 //
 bool mongocEntityUpdate(const char* entityId, KjNode* requestTree)
 {
-  LM_E(("mongocEntityUpdate is not implemented"));
-  return false;
+  mongoc_collection_t*  collectionP = mongocCollectionGet("entities");
+  bson_t                mongoFilter;
+  bson_t                replacement;
+  bson_error_t          mongoError;
+  bool                  ok;
+
+  if (collectionP == NULL)
+    return false;
+
+  //
+  // Filter - only Entity ID for this operation
+  //
+  bson_init(&mongoFilter);
+  BSON_APPEND_UTF8(&mongoFilter, "_id.id", entityId);
+
+  bson_init(&replacement);
+  mongocKjTreeToBson(requestTree, &replacement);
+
+  ok = mongoc_collection_replace_one(collectionP, &mongoFilter, &replacement, NULL, NULL, &mongoError);
+  if (ok == false)
+    LM_E(("Database Error (updating entity '%s': %s)", entityId, mongoError.message));
+
+  bson_destroy(&replacement);
+  bson_destroy(&mongoFilter);
+  mongoc_collection_destroy(collectionP);
+
+  return ok;
 }
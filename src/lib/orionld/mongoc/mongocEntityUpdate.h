@@ -35,7 +35,7 @@ extern "C"
 
 // -----------------------------------------------------------------------------
 //
-// mongocEntityUpdate -
+// mongocEntityUpdate - replace an entity in the database with 'requestTree' (an entity in DB format)
 //
 extern bool mongocEntityUpdate(const char* entityId, KjNode* requestTree);
 
@@ -0,0 +1,68 @@
+/*
+*
+* Copyright 2021 FIWARE Foundation e.V.
+*
+* This file is part of Orion-LD Context Broker.
+*
+* Orion-LD Context Broker is free software: you can redistribute it and/or
+* modify it under the terms of the GNU Affero General Public License as
+* published by the Free Software Foundation, either version 3 of the
+* License, or (at your option) any later version.
+*
+* Orion-LD Context Broker is distributed in the hope that it will be useful,
+* but WITHOUT ANY WARRANTY; without even the implied warranty of
+* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU Affero
+* General Public License for more details.
+*
+* You should have received a copy of the GNU Affero General Public License
+* along with Orion-LD Context Broker. If not, see http://www.gnu.org/licenses/.
+*
+* For those usages not covered by this license please contact with
+* orionld at fiware dot org
+*
+* Author: Ken Zangelin
+*/
+#include <stdio.h>                                               // snprintf
+#include <string.h>                                              // strlen
+
+extern "C"
+{
+#include "kalloc/kaAlloc.h"                                      // kaAlloc
+#include "kalloc/kaStrdup.h"                                     // kaStrdup
+}
+
+#include "logMsg/logMsg.h"                                       // LM_*
+#include "logMsg/traceLevels.h"                                  // Lmt*
+
+#include "orionld/common/orionldState.h"                         // orionldState
+#include "orionld/common/dotForEq.h"                             // dotForEq
+#include "orionld/types/OrionldTenant.h"                         // OrionldTenant
+#include "orionld/db/dbGeoIndexAdd.h"                            // dbGeoIndexAdd
+#include "orionld/mongoc/mongocIndexCreate.h"                    // mongocIndexCreate
+#include "orionld/mongoc/mongocGeoIndexCreate.h"                 // Own interface
+
+
+
+// -----------------------------------------------------------------------------
+//
+// mongocGeoIndexCreate -
+//
+bool mongocGeoIndexCreate(OrionldTenant* tenantP, const char* attrLongName)
+{
+  int    len          = 6 + strlen(attrLongName) + 6 + 1;              // "attrs." == 6, ".value" == 6, 1 for string-termination
+  char*  index        = kaAlloc(&orionldState.kalloc, len);
+  char*  attrNameCopy = kaStrdup(&orionldState.kalloc, attrLongName);  // To not destroy the original attrName
+
+  dotForEq(attrNameCopy);
+  snprintf(index, len, "attrs.%s.value", attrNameCopy);
+
+  if (mongocIndexCreate(tenantP->mongoDbName, "entities", index, "2dsphere") == false)
+  {
+    LM_E(("Database Error (error creating 2dsphere index for attribute '%s' for tenant '%s')", attrNameCopy, tenantP->mongoDbName));
+    return false;
+  }
+
+  dbGeoIndexAdd(tenantP, attrNameCopy);
+
+  return true;
+}
@@ -0,0 +1,136 @@
+/*
+*
+* Copyright 2021 FIWARE Foundation e.V.
+*
+* This file is part of Orion-LD Context Broker.
+*
+* Orion-LD Context Broker is free software: you can redistribute it and/or
+* modify it under the terms of the GNU Affero General Public License as
+* published by the Free Software Foundation, either version 3 of the
+* License, or (at your option) any later version.
+*
+* Orion-LD Context Broker is distributed in the hope that it will be useful,
+* but WITHOUT ANY WARRANTY; without even the implied warranty of
+* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU Affero
+* General Public License for more details.
+*
+* You should have received a copy of the GNU Affero General Public License
+* along with Orion-LD Context Broker. If not, see http://www.gnu.org/licenses/.
+*
+* For those usages not covered by this license please contact with
+* orionld at fiware dot org
+*
+* Author: Ken Zangelin
+*/
+#include <string.h>                                              // strcmp
+
+#include <mongoc/mongoc.h>                                       // MongoDB C Client Driver
+
+#include "logMsg/logMsg.h"                                       // LM_*
+#include "logMsg/traceLevels.h"                                  // Lmt*
+
+#include "orionld/common/orionldState.h"                         // tenant0, tenantList
+#include "orionld/db/dbGeoIndexLookup.h"                         // dbGeoIndexLookup
+#include "orionld/mongoc/mongocCollectionGet.h"                  // mongocCollectionGetWithDb
+#include "orionld/mongoc/mongocGeoIndexCreate.h"                 // mongocGeoIndexCreate
+#include "orionld/mongoc/mongocGeoIndexInit.h"                   // Own interface
+
+
+
+// -----------------------------------------------------------------------------
+//
+// geoPropertiesIndex - make sure all GeoProperties of an entity are indexed
+//
+// The attributes are inspected straight from the BSON document - no KjNode tree is needed.
+//
+static void geoPropertiesIndex(OrionldTenant* tenantP, const bson_t* entityP)
+{
+  bson_iter_t  iter;
+  bson_iter_t  attrsIter;
+
+  if ((bson_iter_init_find(&iter, entityP, "attrs") == false) || (BSON_ITER_HOLDS_DOCUMENT(&iter) == false))
+    return;  //  Entity without attributes ?
+
+  if (bson_iter_recurse(&iter, &attrsIter) == false)
+    return;
+
+  // Foreach PROPERTY
+  while (bson_iter_next(&attrsIter))
+  {
+    bson_iter_t  typeIter;
+    const char*  attrName = bson_iter_key(&attrsIter);
+
+    if ((bson_iter_recurse(&attrsIter, &typeIter) == false) || (bson_iter_find(&typeIter, "type") == false))
+    {
+      LM_E(("Database Error (attribute without 'type' field)"));
+      continue;
+    }
+
+    if (BSON_ITER_HOLDS_UTF8(&typeIter) == false)
+    {
+      LM_E(("Database Error (attribute with a 'type' field that is not a string)"));
+      continue;
+    }
+
+    if (strcmp(bson_iter_utf8(&typeIter, NULL), "GeoProperty") == 0)
+    {
+      if (dbGeoIndexLookup(tenantP, attrName) == NULL)
+        mongocGeoIndexCreate(tenantP, attrName);
+    }
+  }
+}
+
+
+
+// -----------------------------------------------------------------------------
+//
+// mongocGeoIndexInit -
+//
+void mongocGeoIndexInit(void)
+{
+  bson_t  filter;
+  bson_t  opts;
+  bson_t  projection;
+
+  bson_init(&filter);
+  bson_init(&opts);
+  BSON_APPEND_DOCUMENT_BEGIN(&opts, "projection", &projection);
+  BSON_APPEND_INT32(&projection, "attrs", 1);
+  BSON_APPEND_INT32(&projection, "_id", 0);
+  bson_append_document_end(&opts, &projection);
+
+  //
+  // Loop over all tenants, populating the geo-index hash set of each tenant
+  // The default tenant (tenant0) comes first
+  //
+  OrionldTenant* tenantP = &tenant0;
+
+  do
+  {
+    mongoc_collection_t*  collectionP = mongocCollectionGetWithDb(tenantP->mongoDbName, "entities");
+
+    if (collectionP != NULL)
+    {
+      mongoc_cursor_t*  cursorP = mongoc_collection_find_with_opts(collectionP, &filter, &opts, NULL);
+      const bson_t*     entityP;
+      bson_error_t      mongoError;
+
+      // Foreach ENTITY (only attrs)
+      while (mongoc_cursor_next(cursorP, &entityP))
+      {
+        geoPropertiesIndex(tenantP, entityP);
+      }
+
+      if (mongoc_cursor_error(cursorP, &mongoError))
+        LM_E(("Database Error (%s.entities: %s)", tenantP->mongoDbName, mongoError.message));
+
+      mongoc_cursor_destroy(cursorP);
+      mongoc_collection_destroy(collectionP);
+    }
+
+    tenantP = (tenantP == &tenant0)? __atomic_load_n(&tenantList, __ATOMIC_ACQUIRE) : tenantP->listNext;
+  } while (tenantP != NULL);
+
+  bson_destroy(&opts);
+  bson_destroy(&filter);
+}
@@ -0,0 +1,92 @@
+/*
+*
+* Copyright 2021 FIWARE Foundation e.V.
+*
+* This file is part of Orion-LD Context Broker.
+*
+* Orion-LD Context Broker is free software: you can redistribute it and/or
+* modify it under the terms of the GNU Affero General Public License as
+* published by the Free Software Foundation, either version 3 of the
+* License, or (at your option) any later version.
+*
+* Orion-LD Context Broker is distributed in the hope that it will be useful,
+* but WITHOUT ANY WARRANTY; without even the implied warranty of
+* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU Affero
+* General Public License for more details.
+*
+* You should have received a copy of the GNU Affero General Public License
+* along with Orion-LD Context Broker. If not, see http://www.gnu.org/licenses/.
+*
+* For those usages not covered by this license please contact with
+* orionld at fiware dot org
+*
+* Author: Ken Zangelin
+*/
+#include <stdio.h>                                               // snprintf
+
+#include <mongoc/mongoc.h>                                       // MongoDB C Client Driver
+
+#include "logMsg/logMsg.h"                                       // LM_*
+#include "logMsg/traceLevels.h"                                  // Lmt*
+
+#include "orionld/mongoc/mongocCollectionGet.h"                  // mongocCollectionGetWithDb
+#include "orionld/mongoc/mongocIndexCreate.h"                    // Own interface
+
+
+
+// -----------------------------------------------------------------------------
+//
+// mongocIndexCreate - create an index on one field of a collection
+//
+// PARAMETERS
+//   dbName          the database (the tenant)
+//   collectionName  the collection ("entities", ...)
+//   field           the path of the field to be indexed, e.g. "_id.id"
+//   indexType       the type of the index, e.g. "2dsphere". NULL for a normal ascending index
+//
+// mongo shell:
+//   db.runCommand({ createIndexes: "entities", indexes: [ { key: { "_id.id": 1 }, name: "_id.id_1" } ] })
+//
+// Creating an index that already exists is not an error - nothing is done by the server.
+//
+bool mongocIndexCreate(const char* dbName, const char* collectionName, const char* field, const char* indexType)
+{
+  mongoc_collection_t*  collectionP = mongocCollectionGetWithDb(dbName, collectionName);
+  bson_t                command;
+  bson_t                indexes;
+  bson_t                index;
+  bson_t                key;
+  bson_error_t          mongoError;
+  char                  indexName[512];
+  bool                  ok;
+
+  if (collectionP == NULL)
+    return false;
+
+  snprintf(indexName, sizeof(indexName), "%s_%s", field, (indexType != NULL)? indexType : "1");
+
+  bson_init(&command);
+  BSON_APPEND_UTF8(&command, "createIndexes", collectionName);
+  BSON_APPEND_ARRAY_BEGIN(&command, "indexes", &indexes);
+  BSON_APPEND_DOCUMENT_BEGIN(&indexes, "0", &index);
+  BSON_APPEND_DOCUMENT_BEGIN(&index, "key", &key);
+
+  if (indexType != NULL)
+    BSON_APPEND_UTF8(&key, field, indexType);
+  else
+    BSON_APPEND_INT32(&key, field, 1);
+
+  bson_append_document_end(&index, &key);
+  BSON_APPEND_UTF8(&index, "name", indexName);
+  bson_append_document_end(&indexes, &index);
+  bson_append_array_end(&command, &indexes);
+
+  ok = mongoc_collection_write_command_with_opts(collectionP, &command, NULL, NULL, &mongoError);
+  if (ok == false)
+    LM_E(("Database Error (creating index '%s' in %s.%s: %s)", indexName, dbName, collectionName, mongoError.message));
+
+  bson_destroy(&command);
+  mongoc_collection_destroy(collectionP);
+
+  return ok;
+}
@@ -27,7 +27,11 @@
 #include "logMsg/logMsg.h"                                       // LM_*
 #include "logMsg/traceLevels.h"                                  // Lmt*
 
-#include "orionld/common/orionldState.h"                         // orionldState
+#include "orionld/common/orionldState.h"                         // mongocUri, mongocPool, dbUser, dbPwd, rplSet, dbPoolSize
+#include "orionld/mongoc/mongocConnectionRelease.h"              // mongocConnectionRelease
+#include "orionld/mongoc/mongocTenantsGet.h"                     // mongocTenantsGet
+#include "orionld/mongoc/mongocGeoIndexInit.h"                   // mongocGeoIndexInit
+#include "orionld/mongoc/mongocInit.h"                           // Own interface
 
 
 
@@ -35,6 +39,10 @@
 //
 // mongocInit -
 //
+// All DB operations go through a mongoc client pool (mongocPool), of size -dbPoolSize.
+// Each thread checks out a client at its first DB operation and returns it when the request ends
+// (see mongocConnectionGet), so there is no contention between threads, apart from the pool itself.
+//
 void mongocInit(const char* dbHost, const char* dbName)
 {
   bson_error_t mongoError;
@@ -50,37 +58,42 @@ void mongocInit(const char* dbHost, const char* dbName)
   //
   // Safely create a MongoDB URI object from the given string
   //
-  orionldState.mongoUri = mongoc_uri_new_with_error(mongoUri, &mongoError);
-  if (orionldState.mongoUri == NULL)
-    LM_X(1, ("mongoc_uri_new_with_error(%s): %s", orionldState.mongoUri, mongoError.message));
+  mongocUri = mongoc_uri_new_with_error(mongoUri, &mongoError);
+  if (mongocUri == NULL)
+    LM_X(1, ("mongoc_uri_new_with_error(%s): %s", mongoUri, mongoError.message));
 
-  //
-  // Create a new client instance
-  //
-  orionldState.mongoClient = mongoc_client_new_from_uri(orionldState.mongoUri);
-  if (orionldState.mongoClient == NULL)
-    LM_X(1, ("mongoc_client_new_from_uri failed"));
+  if (dbUser[0] != 0)
+  {
+    mongoc_uri_set_username(mongocUri, dbUser);
+    mongoc_uri_set_password(mongocUri, dbPwd);
+  }
+
+  if (rplSet[0] != 0)
+    mongoc_uri_set_option_as_utf8(mongocUri, MONGOC_URI_REPLICASET, rplSet);
 
   //
   // Register the application name (to get tracking possibilities in the profile logs on the server)
   //
-  mongoc_client_set_appname(orionldState.mongoClient, "orionld");
+  mongoc_uri_set_option_as_utf8(mongocUri, MONGOC_URI_APPNAME, "orionld");
 
   //
-  // Get a handle on the database
+  // Create the client pool
   //
-  orionldState.mongoDatabase = mongoc_client_get_database(orionldState.mongoClient, dbName);
-  if (orionldState.mongoDatabase == NULL)
-    LM_X(1, ("DB: mongoc_client_get_database FAILED"));
+  mongocPool = mongoc_client_pool_new(mongocUri);
+  if (mongocPool == NULL)
+    LM_X(1, ("mongoc_client_pool_new failed"));
+
+  mongoc_client_pool_set_error_api(mongocPool, MONGOC_ERROR_API_VERSION_2);
+  mongoc_client_pool_max_size(mongocPool, dbPoolSize);
 
   //
-  // Get a handle on the collections
+  // Tenants and geo-indexes already in the database
   //
-  mongoEntitiesCollectionP = mongoc_client_get_collection(orionldState.mongoClient, dbName, "entities");
-  if (mongoEntitiesCollectionP == NULL)
-    LM_X(1, ("mongoc_client_get_collection(%s, 'entities') failed", dbName));
+  if (mongocTenantsGet() == false)
+    LM_X(1, ("Unable to extract tenants from the database - fatal error"));
+
+  mongocGeoIndexInit();
 
-  mongoRegistrationsCollectionP = mongoc_client_get_collection(orionldState.mongoClient, dbName, "registrations");
-  if (mongoRegistrationsCollectionP == NULL)
-    LM_X(1, ("mongoc_client_get_collection(%s, 'regiatrations') failed", dbName));
+  // The main thread is done with the database - its client goes back to the pool
+  mongocConnectionRelease();
 }
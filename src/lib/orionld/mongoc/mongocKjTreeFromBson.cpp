@@ -26,10 +26,14 @@
 
 extern "C"
 {
+#include "kalloc/kaStrdup.h"                                   // kaStrdup
 #include "kjson/KjNode.h"                                      // KjNode
-#include "kjson/kjParse.h"                                     // kjParse
+#include "kjson/kjBuilder.h"                                   // kjObject, kjArray, kjString, ...
 }
 
+#include "logMsg/logMsg.h"                                     // LM_*
+#include "logMsg/traceLevels.h"                                // Lmt*
+
 #include "orionld/common/orionldState.h"                       // orionldState
 #include "orionld/mongoc/mongocKjTreeFromBson.h"               // Own interface
 
@@ -37,30 +41,105 @@ extern "C"
 
 // -----------------------------------------------------------------------------
 //
-// mongocKjTreeFromBson -
+// bsonIterToKjTree - add the fields of a BSON document/array as children of a KjNode container
 //
-KjNode* mongocKjTreeFromBson(const void* dataP, char** titleP, char** detailsP)
+// Same output as mongoCppLegacyDataToKjTree, for the mongoc driver.
+//
+static bool bsonIterToKjTree(KjNode* containerP, bson_iter_t* iterP, bool isArray)
 {
-  const bson_t*  bsonP  = (const bson_t*) dataP;
-  char*          json;
-  KjNode*        treeP = NULL;
+  Kjson* kjP = orionldState.kjsonP;
 
-  if ((json = bson_as_json(bsonP, NULL)) == NULL)
-  {
-    *titleP   = (char*) "Internal Error";
-    *detailsP = (char*) "Error creating JSON from BSON";
-  }
-  else
+  while (bson_iter_next(iterP))
   {
-    treeP = kjParse(orionldState.kjsonP, json);
-    if (treeP == NULL)
+    bson_type_t  type     = bson_iter_type(iterP);
+    KjNode*      nodeP    = NULL;
+    const char*  nodeName = (isArray == true)? NULL : kaStrdup(kjP->kallocP, bson_iter_key(iterP));
+
+    switch (type)
     {
-      *titleP   = (char*) "Internal Error";
-      *detailsP = (char*) "Error parsing JSON output from bson_as_json";
+    case BSON_TYPE_UTF8:    nodeP = kjString(kjP, nodeName, bson_iter_utf8(iterP, NULL));  break;
+    case BSON_TYPE_BOOL:    nodeP = kjBoolean(kjP, nodeName, bson_iter_bool(iterP));       break;
+    case BSON_TYPE_DOUBLE:  nodeP = kjFloat(kjP, nodeName, bson_iter_double(iterP));       break;
+    case BSON_TYPE_INT32:   nodeP = kjInteger(kjP, nodeName, bson_iter_int32(iterP));      break;
+    case BSON_TYPE_INT64:   nodeP = kjInteger(kjP, nodeName, bson_iter_int64(iterP));      break;
+    case BSON_TYPE_NULL:    nodeP = kjNull(kjP, nodeName);                                 break;
+
+    case BSON_TYPE_DOCUMENT:
+    case BSON_TYPE_ARRAY:
+      {
+        bson_iter_t childIter;
+
+        if (bson_iter_recurse(iterP, &childIter) == false)
+          return false;
+
+        nodeP = (type == BSON_TYPE_DOCUMENT)? kjObject(kjP, nodeName) : kjArray(kjP, nodeName);
+        if (bsonIterToKjTree(nodeP, &childIter, type == BSON_TYPE_ARRAY) == false)
+          return false;
+      }
+      break;
+
+    case BSON_TYPE_DATE_TIME:
+      nodeP = kjObject(kjP, nodeName);
+      kjChildAdd(nodeP, kjInteger(kjP, "$date", bson_iter_date_time(iterP)));
+      break;
+
+    case BSON_TYPE_OID:
+      {
+        char oid[25];
+
+        bson_oid_to_string(bson_iter_oid(iterP), oid);
+        nodeP = kjObject(kjP, nodeName);
+        kjChildAdd(nodeP, kjString(kjP, "$oid", oid));
+      }
+      break;
+
+    case BSON_TYPE_TIMESTAMP:
+      {
+        uint32_t  t;
+        uint32_t  i;
+        KjNode*   tsP = kjObject(kjP, "$timestamp");
+
+        bson_iter_timestamp(iterP, &t, &i);
+        kjChildAdd(tsP, kjInteger(kjP, "t", t));
+        kjChildAdd(tsP, kjInteger(kjP, "i", i));
+
+        nodeP = kjObject(kjP, nodeName);
+        kjChildAdd(nodeP, tsP);
+      }
+      break;
+
+    default:
+      LM_W(("Unsupported BSON type %d for field '%s' - skipped", type, bson_iter_key(iterP)));
+      continue;
     }
+
+    kjChildAdd(containerP, nodeP);
   }
 
-  bson_free(json);
+  return true;
+}
+
+
+
+// -----------------------------------------------------------------------------
+//
+// mongocKjTreeFromBson -
+//
+// The BSON document is decoded straight into a KjNode tree - no bson_as_json + kjParse round trip.
+// This is the dbDataToKjTree of the mongoc driver - dataP is a bson_t*.
+//
+KjNode* mongocKjTreeFromBson(const void* dataP, bool isArray, char** titleP, char** detailsP)
+{
+  const bson_t*  bsonP = (const bson_t*) dataP;
+  bson_iter_t    iter;
+  KjNode*        treeP = (isArray == true)? kjArray(orionldState.kjsonP, NULL) : kjObject(orionldState.kjsonP, NULL);
+
+  if ((treeP == NULL) || (bson_iter_init(&iter, bsonP) == false) || (bsonIterToKjTree(treeP, &iter, isArray) == false))
+  {
+    *titleP   = (char*) "Internal Error";
+    *detailsP = (char*) "Error decoding BSON";
+    return NULL;
+  }
 
   return treeP;
 }
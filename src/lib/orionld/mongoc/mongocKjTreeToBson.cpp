@@ -0,0 +1,131 @@
+/*
+*
+* Copyright 2021 FIWARE Foundation e.V.
+*
+* This file is part of Orion-LD Context Broker.
+*
+* Orion-LD Context Broker is free software: you can redistribute it and/or
+* modify it under the terms of the GNU Affero General Public License as
+* published by the Free Software Foundation, either version 3 of the
+* License, or (at your option) any later version.
+*
+* Orion-LD Context Broker is distributed in the hope that it will be useful,
+* but WITHOUT ANY WARRANTY; without even the implied warranty of
+* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU Affero
+* General Public License for more details.
+*
+* You should have received a copy of the GNU Affero General Public License
+* along with Orion-LD Context Broker. If not, see http://www.gnu.org/licenses/.
+*
+* For those usages not covered by this license please contact with
+* orionld at fiware dot org
+*
+* Author: Ken Zangelin
+*/
+#include <bson/bson.h>                                           // BSON
+
+extern "C"
+{
+#include "kjson/KjNode.h"                                        // KjNode
+}
+
+#include "logMsg/logMsg.h"                                       // LM_*
+#include "logMsg/traceLevels.h"                                  // Lmt*
+
+#include "orionld/mongoc/mongocKjTreeToBson.h"                   // Own interface
+
+
+
+// -----------------------------------------------------------------------------
+//
+// kjNodeToBson - append a KjNode to a BSON document/array, under the key 'key'
+//
+// Same output as mongoCppLegacyKjTreeToBsonObj, for the mongoc driver:
+//   - integers that fit in 32 bits are stored as int32 (not NumberLong)
+//   - null values are skipped
+//
+static void kjNodeToBson(KjNode* nodeP, bson_t* bsonP, const char* key)
+{
+  if ((nodeP->type == KjObject) || (nodeP->type == KjArray))
+  {
+    bson_t  child;
+    int     ix = 0;
+
+    if (nodeP->type == KjObject)
+      bson_append_document_begin(bsonP, key, -1, &child);
+    else
+      bson_append_array_begin(bsonP, key, -1, &child);
+
+    for (KjNode* itemP = nodeP->value.firstChildP; itemP != NULL; itemP = itemP->next)
+    {
+      if (nodeP->type == KjObject)
+        kjNodeToBson(itemP, &child, itemP->name);
+      else
+      {
+        char         indexBuf[16];
+        const char*  indexKey;
+
+        bson_uint32_to_string(ix, &indexKey, indexBuf, sizeof(indexBuf));
+        kjNodeToBson(itemP, &child, indexKey);
+        ++ix;
+      }
+    }
+
+    if (nodeP->type == KjObject)
+      bson_append_document_end(bsonP, &child);
+    else
+      bson_append_array_end(bsonP, &child);
+  }
+  else if (nodeP->type == KjString)
+    bson_append_utf8(bsonP, key, -1, nodeP->value.s, -1);
+  else if (nodeP->type == KjFloat)
+    bson_append_double(bsonP, key, -1, nodeP->value.f);
+  else if (nodeP->type == KjInt)
+  {
+    if ((nodeP->value.i >= INT32_MIN) && (nodeP->value.i <= INT32_MAX))
+      bson_append_int32(bsonP, key, -1, (int32_t) nodeP->value.i);
+    else
+      bson_append_int64(bsonP, key, -1, nodeP->value.i);
+  }
+  else if (nodeP->type == KjBoolean)
+    bson_append_bool(bsonP, key, -1, nodeP->value.b);
+}
+
+
+
+// -----------------------------------------------------------------------------
+//
+// mongocKjTreeToBson -
+//
+// This is the dbDataFromKjTree of the mongoc driver - dbDataP is a bson_t*, initialized by the caller.
+//
+// If the tree is an object or an array, its members are appended to the BSON document
+// (array items under the keys "0", "1", ...).
+// Any other node is appended as a field of its own, under its name.
+//
+void mongocKjTreeToBson(KjNode* nodeP, void* dbDataP)
+{
+  bson_t* bsonP = (bson_t*) dbDataP;
+
+  if ((nodeP->type == KjObject) || (nodeP->type == KjArray))
+  {
+    int ix = 0;
+
+    for (KjNode* itemP = nodeP->value.firstChildP; itemP != NULL; itemP = itemP->next)
+    {
+      if (nodeP->type == KjObject)
+        kjNodeToBson(itemP, bsonP, itemP->name);
+      else
+      {
+        char         indexBuf[16];
+        const char*  indexKey;
+
+        bson_uint32_to_string(ix, &indexKey, indexBuf, sizeof(indexBuf));
+        kjNodeToBson(itemP, bsonP, indexKey);
+        ++ix;
+      }
+    }
+  }
+  else
+    kjNodeToBson(nodeP, bsonP, nodeP->name);
+}
@@ -0,0 +1,271 @@
+/*
+*
+* Copyright 2021 FIWARE Foundation e.V.
+*
+* This file is part of Orion-LD Context Broker.
+*
+* Orion-LD Context Broker is free software: you can redistribute it and/or
+* modify it under the terms of the GNU Affero General Public License as
+* published by the Free Software Foundation, either version 3 of the
+* License, or (at your option) any later version.
+*
+* Orion-LD Context Broker is distributed in the hope that it will be useful,
+* but WITHOUT ANY WARRANTY; without even the implied warranty of
+* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU Affero
+* General Public License for more details.
+*
+* You should have received a copy of the GNU Affero General Public License
+* along with Orion-LD Context Broker. If not, see http://www.gnu.org/licenses/.
+*
+* For those usages not covered by this license please contact with
+* orionld at fiware dot org
+*
+* Author: Ken Zangelin
+*/
+#include <mongoc/mongoc.h>                                       // MongoDB C Client Driver
+
+#include "logMsg/logMsg.h"                                       // LM_*
+#include "logMsg/traceLevels.h"                                  // Lmt*
+
+#include "orionld/common/QNode.h"                                // QNode
+#include "orionld/mongoc/mongocQtreeToBson.h"                    // Own interface
+
+
+
+// ----------------------------------------------------------------------------
+//
+// qValueAppend - append a constant of the Q-Tree to a BSON document/array
+//
+static bool qValueAppend(bson_t* bsonP, const char* key, QNode* valueNodeP)
+{
+  switch (valueNodeP->type)
+  {
+  case QNodeIntegerValue:  BSON_APPEND_INT64(bsonP, key, valueNodeP->value.i);  break;
+  case QNodeFloatValue:    BSON_APPEND_DOUBLE(bsonP, key, valueNodeP->value.f); break;
+  case QNodeStringValue:   BSON_APPEND_UTF8(bsonP, key, valueNodeP->value.s);   break;
+  case QNodeTrueValue:     BSON_APPEND_BOOL(bsonP, key, true);                  break;
+  case QNodeFalseValue:    BSON_APPEND_BOOL(bsonP, key, false);                 break;
+  default:
+    return false;
+  }
+
+  return true;
+}
+
+
+
+// ----------------------------------------------------------------------------
+//
+// qListAppend - append the items of a comma-list as an array, e.g. { "$in": [ 1, 2, 3 ] }
+//
+static void qListAppend(bson_t* bsonP, const char* op, QNode* listP)
+{
+  bson_t    arrayBson;
+  uint32_t  ix = 0;
+
+  BSON_APPEND_ARRAY_BEGIN(bsonP, op, &arrayBson);
+
+  for (QNode* listItemP = listP->value.children; listItemP != NULL; listItemP = listItemP->next)
+  {
+    char         indexBuf[16];
+    const char*  indexKey;
+
+    bson_uint32_to_string(ix, &indexKey, indexBuf, sizeof(indexBuf));
+    if (qValueAppend(&arrayBson, indexKey, listItemP) == true)
+      ++ix;
+  }
+
+  bson_append_array_end(bsonP, &arrayBson);
+}
+
+
+
+// ----------------------------------------------------------------------------
+//
+// mongocQtreeToBson -
+//
+// Same translation as qTreeToBsonObj (mongo C++ Legacy driver), only producing a bson_t for the mongoc driver.
+// The resulting filter is appended to 'topBsonP', that must be initialized by the caller.
+//
+bool mongocQtreeToBson(QNode* treeP, bson_t* topBsonP, char** titleP, char** detailsP)
+{
+  if (treeP->type == QNodeOr)
+  {
+    // { "$or": [ { }, { }, ... { } ] }
+    bson_t    orArray;
+    uint32_t  ix = 0;
+
+    BSON_APPEND_ARRAY_BEGIN(topBsonP, "$or", &orArray);
+
+    for (QNode* qNodeP = treeP->value.children; qNodeP != NULL; qNodeP = qNodeP->next)
+    {
+      char         indexBuf[16];
+      const char*  indexKey;
+      bson_t       arrItemObject;
+      bool         ok;
+
+      bson_uint32_to_string(ix++, &indexKey, indexBuf, sizeof(indexBuf));
+      BSON_APPEND_DOCUMENT_BEGIN(&orArray, indexKey, &arrItemObject);
+      ok = mongocQtreeToBson(qNodeP, &arrItemObject, titleP, detailsP);
+      bson_append_document_end(&orArray, &arrItemObject);
+
+      if (ok == false)
+      {
+        bson_append_array_end(topBsonP, &orArray);
+        return false;
+      }
+    }
+
+    bson_append_array_end(topBsonP, &orArray);
+  }
+  else if (treeP->type == QNodeAnd)
+  {
+    for (QNode* qNodeP = treeP->value.children; qNodeP != NULL; qNodeP = qNodeP->next)
+    {
+      if (mongocQtreeToBson(qNodeP, topBsonP, titleP, detailsP) == false)
+        return false;
+    }
+  }
+  else if ((treeP->type == QNodeNotExists) || (treeP->type == QNodeExists))
+  {
+    QNode*  rightP = treeP->value.children;
+    bson_t  nexObj;
+
+    BSON_APPEND_DOCUMENT_BEGIN(topBsonP, rightP->value.v, &nexObj);
+    BSON_APPEND_BOOL(&nexObj, "$exists", (treeP->type == QNodeNotExists)? false : true);
+    bson_append_document_end(topBsonP, &nexObj);
+  }
+  else if ((treeP->type == QNodeMatch) || (treeP->type == QNodeNoMatch))
+  {
+    QNode*  leftP  = treeP->value.children;
+    QNode*  rightP = leftP->next;
+    bson_t  matchObj;
+
+    BSON_APPEND_DOCUMENT_BEGIN(topBsonP, leftP->value.v, &matchObj);
+    if (treeP->type == QNodeNoMatch)
+    {
+      bson_t notObj;
+
+      BSON_APPEND_DOCUMENT_BEGIN(&matchObj, "$not", &notObj);
+      BSON_APPEND_UTF8(&notObj, "$regex", rightP->value.re);
+      bson_append_document_end(&matchObj, &notObj);
+    }
+    else
+      BSON_APPEND_UTF8(&matchObj, "$regex", rightP->value.re);
+    bson_append_document_end(topBsonP, &matchObj);
+  }
+  else if (treeP->type == QNodeEQ)
+  {
+    QNode* leftP  = treeP->value.children;
+    QNode* rightP = leftP->next;
+
+    if (rightP->type == QNodeRange)
+    {
+      QNode*  lowerLimitNodeP = rightP->value.children;
+      QNode*  upperLimitNodeP = lowerLimitNodeP->next;
+      bson_t  limitObj;
+
+      BSON_APPEND_DOCUMENT_BEGIN(topBsonP, leftP->value.v, &limitObj);
+      qValueAppend(&limitObj, "$gte", lowerLimitNodeP);
+      qValueAppend(&limitObj, "$lte", upperLimitNodeP);
+      bson_append_document_end(topBsonP, &limitObj);
+    }
+    else if (rightP->type == QNodeComma)
+    {
+      bson_t inObj;
+
+      BSON_APPEND_DOCUMENT_BEGIN(topBsonP, leftP->value.v, &inObj);
+      qListAppend(&inObj, "$in", rightP);
+      bson_append_document_end(topBsonP, &inObj);
+    }
+    else if (qValueAppend(topBsonP, leftP->value.v, rightP) == false)
+    {
+      *titleP   = (char*) "ngsi-ld query language: invalid token after EQ";
+      *detailsP = (char*) qNodeType(rightP->type);
+      return false;
+    }
+  }
+  else if (treeP->type == QNodeNE)
+  {
+    //
+    // $ne selects the documents where the value of the field is not equal to the specified value.
+    // This includes documents that do not contain the field, so, an $exists is needed as well:
+    //   varName: { $exists: true, $ne: VALUE }
+    //
+    QNode*  leftP  = treeP->value.children;
+    QNode*  rightP = leftP->next;
+    bson_t  neObj;
+
+    BSON_APPEND_DOCUMENT_BEGIN(topBsonP, leftP->value.v, &neObj);
+    BSON_APPEND_BOOL(&neObj, "$exists", true);
+
+    if (rightP->type == QNodeComma)
+      qListAppend(&neObj, "$nin", rightP);
+    else if (rightP->type != QNodeRange)
+      qValueAppend(&neObj, "$ne", rightP);
+
+    bson_append_document_end(topBsonP, &neObj);
+
+    if (rightP->type == QNodeRange)
+    {
+      //
+      // A1!=12..24:
+      // { "A1": { "$exists": true } }, { "$or": [ { "A1": { "$lt" 12 } }, { "A1": { "$gt", 24 } } ] }
+      //
+      QNode*  lowerLimitNodeP = rightP->value.children;
+      QNode*  upperLimitNodeP = lowerLimitNodeP->next;
+      bson_t  orVec;
+      bson_t  a1LowerLimitObj;
+      bson_t  lowerLimitObj;
+      bson_t  a1UpperLimitObj;
+      bson_t  upperLimitObj;
+
+      BSON_APPEND_ARRAY_BEGIN(topBsonP, "$or", &orVec);
+
+      BSON_APPEND_DOCUMENT_BEGIN(&orVec, "0", &a1LowerLimitObj);
+      BSON_APPEND_DOCUMENT_BEGIN(&a1LowerLimitObj, leftP->value.v, &lowerLimitObj);
+      qValueAppend(&lowerLimitObj, "$lt", lowerLimitNodeP);
+      bson_append_document_end(&a1LowerLimitObj, &lowerLimitObj);
+      bson_append_document_end(&orVec, &a1LowerLimitObj);
+
+      BSON_APPEND_DOCUMENT_BEGIN(&orVec, "1", &a1UpperLimitObj);
+      BSON_APPEND_DOCUMENT_BEGIN(&a1UpperLimitObj, leftP->value.v, &upperLimitObj);
+      qValueAppend(&upperLimitObj, "$gt", upperLimitNodeP);
+      bson_append_document_end(&a1UpperLimitObj, &upperLimitObj);
+      bson_append_document_end(&orVec, &a1UpperLimitObj);
+
+      bson_append_array_end(topBsonP, &orVec);
+    }
+  }
+  else if ((treeP->type == QNodeGT) || (treeP->type == QNodeGE) || (treeP->type == QNodeLT) || (treeP->type == QNodeLE))
+  {
+    QNode*       leftP  = treeP->value.children;
+    QNode*       rightP = leftP->next;
+    const char*  op;
+    bson_t       gtObj;
+
+    if      (treeP->type == QNodeGT)  op = "$gt";
+    else if (treeP->type == QNodeGE)  op = "$gte";
+    else if (treeP->type == QNodeLT)  op = "$lt";
+    else                              op = "$lte";
+
+    BSON_APPEND_DOCUMENT_BEGIN(topBsonP, leftP->value.v, &gtObj);
+    bool ok = qValueAppend(&gtObj, op, rightP);
+    bson_append_document_end(topBsonP, &gtObj);
+
+    if (ok == false)
+    {
+      *titleP   = (char*) "ngsi-ld query language: invalid token after comparison operator";
+      *detailsP = (char*) qNodeType(rightP->type);
+      return false;
+    }
+  }
+  else
+  {
+    *titleP   = (char*) "ngsi-ld query language: not implemented";
+    *detailsP = (char*) qNodeType(treeP->type);
+    return false;
+  }
+
+  return true;
+}
@@ -0,0 +1,60 @@
+/*
+*
+* Copyright 2021 FIWARE Foundation e.V.
+*
+* This file is part of Orion-LD Context Broker.
+*
+* Orion-LD Context Broker is free software: you can redistribute it and/or
+* modify it under the terms of the GNU Affero General Public License as
+* published by the Free Software Foundation, either version 3 of the
+* License, or (at your option) any later version.
+*
+* Orion-LD Context Broker is distributed in the hope that it will be useful,
+* but WITHOUT ANY WARRANTY; without even the implied warranty of
+* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU Affero
+* General Public License for more details.
+*
+* You should have received a copy of the GNU Affero General Public License
+* along with Orion-LD Context Broker. If not, see http://www.gnu.org/licenses/.
+*
+* For those usages not covered by this license please contact with
+* orionld at fiware dot org
+*
+* Author: Ken Zangelin
+*/
+#include <mongoc/mongoc.h>                                       // MongoDB C Client Driver
+
+#include "logMsg/logMsg.h"                                       // LM_*
+#include "logMsg/traceLevels.h"                                  // Lmt*
+
+#include "orionld/mongoc/mongocCollectionGet.h"                  // mongocCollectionGet
+#include "orionld/mongoc/mongocRegistrationDelete.h"             // Own interface
+
+
+
+// -----------------------------------------------------------------------------
+//
+// mongocRegistrationDelete -
+//
+bool mongocRegistrationDelete(const char* registrationId)
+{
+  mongoc_collection_t*  collectionP = mongocCollectionGet("registrations");
+  bson_t                mongoFilter;
+  bson_error_t          mongoError;
+  bool                  ok;
+
+  if (collectionP == NULL)
+    return false;
+
+  bson_init(&mongoFilter);
+  BSON_APPEND_UTF8(&mongoFilter, "_id", registrationId);
+
+  ok = mongoc_collection_delete_one(collectionP, &mongoFilter, NULL, NULL, &mongoError);
+  if (ok == false)
+    LM_E(("Database Error (deleting registration '%s': %s)", registrationId, mongoError.message));
+
+  bson_destroy(&mongoFilter);
+  mongoc_collection_destroy(collectionP);
+
+  return ok;
+}
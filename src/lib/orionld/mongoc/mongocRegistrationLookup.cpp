@@ -0,0 +1,136 @@
+/*
+*
+* Copyright 2021 FIWARE Foundation e.V.
+*
+* This file is part of Orion-LD Context Broker.
+*
+* Orion-LD Context Broker is free software: you can redistribute it and/or
+* modify it under the terms of the GNU Affero General Public License as
+* published by the Free Software Foundation, either version 3 of the
+* License, or (at your option) any later version.
+*
+* Orion-LD Context Broker is distributed in the hope that it will be useful,
+* but WITHOUT ANY WARRANTY; without even the implied warranty of
+* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU Affero
+* General Public License for more details.
+*
+* You should have received a copy of the GNU Affero General Public License
+* along with Orion-LD Context Broker. If not, see http://www.gnu.org/licenses/.
+*
+* For those usages not covered by this license please contact with
+* orionld at fiware dot org
+*
+* Author: Ken Zangelin
+*/
+#include <mongoc/mongoc.h>                                       // MongoDB C Client Driver
+
+extern "C"
+{
+#include "kjson/KjNode.h"                                        // KjNode
+#include "kjson/kjBuilder.h"                                     // kjArray, kjChildAdd
+}
+
+#include "logMsg/logMsg.h"                                       // LM_*
+#include "logMsg/traceLevels.h"                                  // Lmt*
+
+#include "orionld/common/orionldState.h"                         // orionldState
+#include "orionld/mongoc/mongocCollectionGet.h"                  // mongocCollectionGet
+#include "orionld/mongoc/mongocKjTreeFromBson.h"                 // mongocKjTreeFromBson
+#include "orionld/mongoc/mongocRegistrationLookup.h"             // Own interface
+
+
+
+// -----------------------------------------------------------------------------
+//
+// mongocRegistrationLookup -
+//
+// If attribute is NULL: query registrations collection for:
+//   db.registrations.find({ "contextRegistration.entities.id": "urn:ngsi-ld:entities:E1" })
+//
+// If attribute is non-NULL:
+//   db.registrations.find(
+//     {
+//       "contextRegistration.entities.id": "urn:ngsi-ld:entities:E1",
+//       $or: [
+//         { "contextRegistration.attrs": { "$size": 0 } },
+//         { "contextRegistration.attrs.name": "https://uri.etsi.org/ngsi-ld/default-context/A1" }
+//       ]
+//     }
+//   )
+//
+// ToDo
+//   o Include idPattern in the query
+//
+KjNode* mongocRegistrationLookup(const char* entityId, const char* attribute, int* noOfRegsP)
+{
+  mongoc_collection_t*  collectionP = mongocCollectionGet("registrations");
+  bson_t                mongoFilter;
+  const bson_t*         mongoDocP;
+  mongoc_cursor_t*      mongoCursorP;
+  bson_error_t          mongoError;
+  KjNode*               kjRegArray  = NULL;
+
+  if (noOfRegsP != NULL)
+    *noOfRegsP = 0;
+
+  if (collectionP == NULL)
+    return NULL;
+
+  //
+  // Filter - on Entity ID and Attribute Name
+  //
+  bson_init(&mongoFilter);
+  BSON_APPEND_UTF8(&mongoFilter, "contextRegistration.entities.id", entityId);
+
+  if (attribute != NULL)
+  {
+    bson_t orArray;
+    bson_t zeroSizeArrayItem;
+    bson_t zeroSizeObject;
+    bson_t attrNameMatchArrayItem;
+
+    BSON_APPEND_ARRAY_BEGIN(&mongoFilter, "$or", &orArray);
+
+    BSON_APPEND_DOCUMENT_BEGIN(&orArray, "0", &zeroSizeArrayItem);
+    BSON_APPEND_DOCUMENT_BEGIN(&zeroSizeArrayItem, "contextRegistration.attrs", &zeroSizeObject);
+    BSON_APPEND_INT32(&zeroSizeObject, "$size", 0);
+    bson_append_document_end(&zeroSizeArrayItem, &zeroSizeObject);
+    bson_append_document_end(&orArray, &zeroSizeArrayItem);
+
+    BSON_APPEND_DOCUMENT_BEGIN(&orArray, "1", &attrNameMatchArrayItem);
+    BSON_APPEND_UTF8(&attrNameMatchArrayItem, "contextRegistration.attrs.name", attribute);
+    bson_append_document_end(&orArray, &attrNameMatchArrayItem);
+
+    bson_append_array_end(&mongoFilter, &orArray);
+
+    if (noOfRegsP != NULL)
+      *noOfRegsP += 1;
+  }
+
+  mongoCursorP = mongoc_collection_find_with_opts(collectionP, &mongoFilter, NULL, NULL);
+
+  while (mongoc_cursor_next(mongoCursorP, &mongoDocP))
+  {
+    char*    title;
+    char*    details;
+    KjNode*  kjTree = mongocKjTreeFromBson(mongoDocP, false, &title, &details);
+
+    if (kjTree == NULL)
+      LM_E(("%s: %s", title, details));
+    else
+    {
+      if (kjRegArray == NULL)
+        kjRegArray = kjArray(orionldState.kjsonP, NULL);
+      kjChildAdd(kjRegArray, kjTree);
+    }
+  }
+
+  if (mongoc_cursor_error(mongoCursorP, &mongoError))
+    LM_E(("Database Error (looking up registrations for entity '%s': %s)", entityId, mongoError.message));
+
+  mongoc_cursor_destroy(mongoCursorP);
+  bson_destroy(&mongoFilter);
+  mongoc_collection_destroy(collectionP);
+
+  return kjRegArray;
+}
@@ -0,0 +1,85 @@
+/*
+*
+* Copyright 2021 FIWARE Foundation e.V.
+*
+* This file is part of Orion-LD Context Broker.
+*
+* Orion-LD Context Broker is free software: you can redistribute it and/or
+* modify it under the terms of the GNU Affero General Public License as
+* published by the Free Software Foundation, either version 3 of the
+* License, or (at your option) any later version.
+*
+* Orion-LD Context Broker is distributed in the hope that it will be useful,
+* but WITHOUT ANY WARRANTY; without even the implied warranty of
+* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU Affero
+* General Public License for more details.
+*
+* You should have received a copy of the GNU Affero General Public License
+* along with Orion-LD Context Broker. If not, see http://www.gnu.org/licenses/.
+*
+* For those usages not covered by this license please contact with
+* orionld at fiware dot org
+*
+* Author: Ken Zangelin
+*/
+#include <string.h>                                              // strcmp
+
+extern "C"
+{
+#include "kjson/KjNode.h"                                        // KjNode
+#include "kjson/kjLookup.h"                                      // kjLookup
+}
+
+#include "logMsg/logMsg.h"                                       // LM_*
+#include "logMsg/traceLevels.h"                                  // Lmt*
+
+#include "orionld/mongoc/mongocRelationshipsFix.h"               // Own interface
+
+
+
+// -----------------------------------------------------------------------------
+//
+// mongocRelationshipsFix -
+//
+// Change "value" to "object" for all attributes (and sub-attributes) that are "Relationship".
+// Note that the "object" field of a Relationship is stored in the database under the field "value".
+// That fact is fixed here, by renaming the "value" to "object" for attr with type == Relationship.
+// This depends on the database model and thus should be fixed in the database layer.
+//
+void mongocRelationshipsFix(KjNode* dbEntityP)
+{
+  KjNode* attrArrayP = kjLookup(dbEntityP, "attrs");
+
+  if (attrArrayP == NULL)
+    return;
+
+  for (KjNode* attrP = attrArrayP->value.firstChildP; attrP != NULL; attrP = attrP->next)
+  {
+    KjNode* typeP = kjLookup(attrP, "type");
+    KjNode* mdsP  = kjLookup(attrP, "md");
+
+    if ((typeP != NULL) && (typeP->type == KjString) && (strcmp(typeP->value.s, "Relationship") == 0))
+    {
+      KjNode* valueP = kjLookup(attrP, "value");
+
+      if (valueP != NULL)
+        valueP->name = (char*) "object";
+    }
+
+    if (mdsP != NULL)
+    {
+      for (KjNode* mdP = mdsP->value.firstChildP; mdP != NULL; mdP = mdP->next)
+      {
+        KjNode* typeP = kjLookup(mdP, "type");
+
+        if ((typeP != NULL) && (typeP->type == KjString) && (strcmp(typeP->value.s, "Relationship") == 0))
+        {
+          KjNode* valueP = kjLookup(mdP, "value");
+
+          if (valueP != NULL)
+            valueP->name = (char*) "object";
+        }
+      }
+    }
+  }
+}
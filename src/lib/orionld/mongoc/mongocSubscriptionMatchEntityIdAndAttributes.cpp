@@ -0,0 +1,144 @@
+/*
+*
+* Copyright 2021 FIWARE Foundation e.V.
+*
+* This file is part of Orion-LD Context Broker.
+*
+* Orion-LD Context Broker is free software: you can redistribute it and/or
+* modify it under the terms of the GNU Affero General Public License as
+* published by the Free Software Foundation, either version 3 of the
+* License, or (at your option) any later version.
+*
+* Orion-LD Context Broker is distributed in the hope that it will be useful,
+* but WITHOUT ANY WARRANTY; without even the implied warranty of
+* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU Affero
+* General Public License for more details.
+*
+* You should have received a copy of the GNU Affero General Public License
+* along with Orion-LD Context Broker. If not, see http://www.gnu.org/licenses/.
+*
+* For those usages not covered by this license please contact with
+* orionld at fiware dot org
+*
+* Author: Ken Zangelin
+*/
+#include <mongoc/mongoc.h>                                       // MongoDB C Client Driver
+
+extern "C"
+{
+#include "kjson/KjNode.h"                                        // KjNode
+}
+
+#include "logMsg/logMsg.h"                                       // LM_*
+#include "logMsg/traceLevels.h"                                  // Lmt*
+
+#include "orionld/db/dbConfiguration.h"                          // DbSubscriptionMatchCallback
+#include "orionld/mongoc/mongocCollectionGet.h"                  // mongocCollectionGet
+#include "orionld/mongoc/mongocKjTreeFromBson.h"                 // mongocKjTreeFromBson
+#include "orionld/mongoc/mongocSubscriptionMatchEntityIdAndAttributes.h"  // Own interface
+
+
+
+// -----------------------------------------------------------------------------
+//
+// mongocSubscriptionMatchEntityIdAndAttributes -
+//
+// PARAMETERS
+//   * entityId             The ID of the entity as a string
+//   * currentEntityTree    The entire Entity as it is in the database before being updated
+//   * incomingRequestTree  The incoming request, supposed to modify the current Entity
+//   * subMatchCallback     The callback function to be called for each matching subscription
+//
+void mongocSubscriptionMatchEntityIdAndAttributes
+(
+  const char*                 entityId,
+  KjNode*                     currentEntityTree,
+  KjNode*                     incomingRequestTree,
+  DbSubscriptionMatchCallback subMatchCallback
+)
+{
+  mongoc_collection_t*  collectionP = mongocCollectionGet("csubs");
+  bson_t                mongoFilter;
+  bson_t                inForAttrNames;
+  bson_t                attrArray;
+  bson_t                opts;
+  const bson_t*         mongoDocP;
+  mongoc_cursor_t*      mongoCursorP;
+  bson_error_t          mongoError;
+  int                   ix = 0;
+
+  if (collectionP == NULL)
+    return;
+
+  bson_init(&mongoFilter);
+
+  //
+  // 1. Entity ID, which in this case is FIXED
+  //
+  BSON_APPEND_UTF8(&mongoFilter, "entities.id", entityId);
+
+  //
+  // 2. Attributes
+  //
+  BSON_APPEND_DOCUMENT_BEGIN(&mongoFilter, "conditions", &inForAttrNames);
+  BSON_APPEND_ARRAY_BEGIN(&inForAttrNames, "$in", &attrArray);
+
+  for (KjNode* attrNodeP = incomingRequestTree->value.firstChildP; attrNodeP != NULL; attrNodeP = attrNodeP->next)
+  {
+    char         indexBuf[16];
+    const char*  indexKey;
+
+    bson_uint32_to_string(ix, &indexKey, indexBuf, sizeof(indexBuf));
+    BSON_APPEND_UTF8(&attrArray, indexKey, attrNodeP->name);
+    ++ix;
+  }
+
+  bson_append_array_end(&inForAttrNames, &attrArray);
+  bson_append_document_end(&mongoFilter, &inForAttrNames);
+
+  //
+  // status - must be "active"
+  //
+  BSON_APPEND_UTF8(&mongoFilter, "status", "active");
+
+  // "expiration" - later
+  // "q" - later
+  // "geometry" - later
+
+  //
+  // A maximum of 100 notifications has been agreed (agreed in solitary by KZ :-D)
+  //
+  bson_init(&opts);
+  BSON_APPEND_INT64(&opts, "limit", 100);
+
+  //
+  // Perform query
+  //
+  mongoCursorP = mongoc_collection_find_with_opts(collectionP, &mongoFilter, &opts, NULL);
+
+  while (mongoc_cursor_next(mongoCursorP, &mongoDocP))
+  {
+    char*    title;
+    char*    detail;
+    KjNode*  subscriptionTree = mongocKjTreeFromBson(mongoDocP, false, &title, &detail);
+
+    if (subscriptionTree == NULL)
+    {
+      LM_E(("Internal Error (unable to create KjNode tree from BSON: %s: %s)", title, detail));
+      continue;
+    }
+
+    //
+    // Found a matching subscription - now the caller of this function can do whatever it needs to do with it
+    //
+    subMatchCallback(entityId, subscriptionTree, currentEntityTree, incomingRequestTree);
+  }
+
+  if (mongoc_cursor_error(mongoCursorP, &mongoError))
+    LM_E(("Database Error (matching subscriptions for entity '%s': %s)", entityId, mongoError.message));
+
+  mongoc_cursor_destroy(mongoCursorP);
+  bson_destroy(&opts);
+  bson_destroy(&mongoFilter);
+  mongoc_collection_destroy(collectionP);
+}
@@ -0,0 +1,74 @@
+/*
+*
+* Copyright 2021 FIWARE Foundation e.V.
+*
+* This file is part of Orion-LD Context Broker.
+*
+* Orion-LD Context Broker is free software: you can redistribute it and/or
+* modify it under the terms of the GNU Affero General Public License as
+* published by the Free Software Foundation, either version 3 of the
+* License, or (at your option) any later version.
+*
+* Orion-LD Context Broker is distributed in the hope that it will be useful,
+* but WITHOUT ANY WARRANTY; without even the implied warranty of
+* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU Affero
+* General Public License for more details.
+*
+* You should have received a copy of the GNU Affero General Public License
+* along with Orion-LD Context Broker. If not, see http://www.gnu.org/licenses/.
+*
+* For those usages not covered by this license please contact with
+* orionld at fiware dot org
+*
+* Author: Ken Zangelin
+*/
+#include <mongoc/mongoc.h>                                       // MongoDB C Client Driver
+
+extern "C"
+{
+#include "kjson/KjNode.h"                                        // KjNode
+}
+
+#include "logMsg/logMsg.h"                                       // LM_*
+#include "logMsg/traceLevels.h"                                  // Lmt*
+
+#include "orionld/mongoc/mongocCollectionGet.h"                  // mongocCollectionGet
+#include "orionld/mongoc/mongocKjTreeToBson.h"                   // mongocKjTreeToBson
+#include "orionld/mongoc/mongocSubscriptionReplace.h"            // Own interface
+
+
+
+// -----------------------------------------------------------------------------
+//
+// mongocSubscriptionReplace - replace a subscription in the database with 'dbSubscriptionP' (a subscription in DB format)
+//
+bool mongocSubscriptionReplace(const char* subscriptionId, KjNode* dbSubscriptionP)
+{
+  mongoc_collection_t*  collectionP = mongocCollectionGet("csubs");
+  bson_t                mongoFilter;
+  bson_t                replacement;
+  bson_error_t          mongoError;
+  bool                  ok;
+
+  if (collectionP == NULL)
+    return false;
+
+  //
+  // Filter - only Subscription ID for this operation
+  //
+  bson_init(&mongoFilter);
+  BSON_APPEND_UTF8(&mongoFilter, "_id", subscriptionId);
+
+  bson_init(&replacement);
+  mongocKjTreeToBson(dbSubscriptionP, &replacement);
+
+  ok = mongoc_collection_replace_one(collectionP, &mongoFilter, &replacement, NULL, NULL, &mongoError);
+  if (ok == false)
+    LM_E(("Database Error (replacing subscription '%s': %s)", subscriptionId, mongoError.message));
+
+  bson_destroy(&replacement);
+  bson_destroy(&mongoFilter);
+  mongoc_collection_destroy(collectionP);
+
+  return ok;
+}
@@ -0,0 +1,85 @@
+/*
+*
+* Copyright 2021 FIWARE Foundation e.V.
+*
+* This file is part of Orion-LD Context Broker.
+*
+* Orion-LD Context Broker is free software: you can redistribute it and/or
+* modify it under the terms of the GNU Affero General Public License as
+* published by the Free Software Foundation, either version 3 of the
+* License, or (at your option) any later version.
+*
+* Orion-LD Context Broker is distributed in the hope that it will be useful,
+* but WITHOUT ANY WARRANTY; without even the implied warranty of
+* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU Affero
+* General Public License for more details.
+*
+* You should have received a copy of the GNU Affero General Public License
+* along with Orion-LD Context Broker. If not, see http://www.gnu.org/licenses/.
+*
+* For those usages not covered by this license please contact with
+* orionld at fiware dot org
+*
+* Author: Ken Zangelin
+*/
+#include <string.h>                                              // strcmp, strncmp, strlen
+
+#include <mongoc/mongoc.h>                                       // MongoDB C Client Driver
+
+#include "logMsg/logMsg.h"                                       // LM_*
+#include "logMsg/traceLevels.h"                                  // Lmt*
+
+#include "common/limits.h"                                       // SERVICE_NAME_MAX_LEN
+#include "orionld/common/orionldState.h"                         // dbName, dbNameLen
+#include "orionld/common/orionldTenantCreate.h"                  // orionldTenantCreate
+#include "orionld/mongoc/mongocConnectionGet.h"                  // mongocConnectionGet
+#include "orionld/mongoc/mongocTenantsGet.h"                     // Own interface
+
+
+
+// -----------------------------------------------------------------------------
+//
+// mongocTenantsGet -
+//
+// Get all databases whose names start with 'dbName-' and create a tenant for each of them
+//
+bool mongocTenantsGet(void)
+{
+  mongoc_client_t*  clientP = mongocConnectionGet();
+  bson_error_t      mongoError;
+  char**            dbNameV;
+
+  if (clientP == NULL)
+    return false;
+
+  dbNameV = mongoc_client_get_database_names_with_opts(clientP, NULL, &mongoError);
+  if (dbNameV == NULL)
+  {
+    LM_E(("Database Error (listDatabases: %s)", mongoError.message));
+    return false;
+  }
+
+  for (int ix = 0; dbNameV[ix] != NULL; ix++)
+  {
+    char* name = dbNameV[ix];
+
+    // Don't include the base as a tenant
+    if (strcmp(name, dbName) == 0)
+      continue;
+
+    if ((strncmp(name, dbName, dbNameLen) != 0) || (name[dbNameLen] != '-'))
+      continue;
+
+    if (strlen(&name[dbNameLen + 1]) > SERVICE_NAME_MAX_LEN)
+    {
+      LM_W(("Bad Input (database '%s': tenant name too long - not a tenant)", name));
+      continue;
+    }
+
+    orionldTenantCreate(&name[dbNameLen + 1]);  // The registry keeps the tenant without the dbName prefix
+  }
+
+  bson_strfreev(dbNameV);
+
+  return true;
+}
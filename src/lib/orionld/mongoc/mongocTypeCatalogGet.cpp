@@ -0,0 +1,91 @@
+/*
+*
+* Copyright 2021 FIWARE Foundation e.V.
+*
+* This file is part of Orion-LD Context Broker.
+*
+* Orion-LD Context Broker is free software: you can redistribute it and/or
+* modify it under the terms of the GNU Affero General Public License as
+* published by the Free Software Foundation, either version 3 of the
+* License, or (at your option) any later version.
+*
+* Orion-LD Context Broker is distributed in the hope that it will be useful,
+* but WITHOUT ANY WARRANTY; without even the implied warranty of
+* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU Affero
+* General Public License for more details.
+*
+* You should have received a copy of the GNU Affero General Public License
+* along with Orion-LD Context Broker. If not, see http://www.gnu.org/licenses/.
+*
+* For those usages not covered by this license please contact with
+* orionld at fiware dot org
+*
+* Author: Ken Zangelin
+*/
+#include <mongoc/mongoc.h>                                       // MongoDB C Client Driver
+
+extern "C"
+{
+#include "kjson/KjNode.h"                                        // KjNode
+#include "kjson/kjBuilder.h"                                     // kjArray, kjChildAdd
+}
+
+#include "logMsg/logMsg.h"                                       // LM_*
+#include "logMsg/traceLevels.h"                                  // Lmt*
+
+#include "orionld/common/orionldState.h"                         // orionldState
+#include "orionld/types/OrionldTenant.h"                         // OrionldTenant
+#include "orionld/mongoc/mongocCollectionGet.h"                  // mongocCollectionGetWithDb
+#include "orionld/mongoc/mongocKjTreeFromBson.h"                 // mongocKjTreeFromBson
+#include "orionld/mongoc/mongocTypeCatalogGet.h"                 // Own interface
+
+
+
+// -----------------------------------------------------------------------------
+//
+// mongocTypeCatalogGet -
+//
+KjNode* mongocTypeCatalogGet(OrionldTenant* tenantP)
+{
+  mongoc_collection_t*  collectionP = mongocCollectionGetWithDb(tenantP->mongoDbName, "entityTypes");
+  bson_t                mongoFilter;
+  const bson_t*         mongoDocP;
+  mongoc_cursor_t*      mongoCursorP;
+  bson_error_t          mongoError;
+  KjNode*               docArray = NULL;
+
+  if (collectionP == NULL)
+    return NULL;
+
+  bson_init(&mongoFilter);
+
+  mongoCursorP = mongoc_collection_find_with_opts(collectionP, &mongoFilter, NULL, NULL);
+
+  while (mongoc_cursor_next(mongoCursorP, &mongoDocP))
+  {
+    char*    title;
+    char*    details;
+    KjNode*  kjTree = mongocKjTreeFromBson(mongoDocP, false, &title, &details);
+
+    if (kjTree == NULL)
+      LM_E(("%s: %s", title, details));
+    else
+    {
+      if (docArray == NULL)
+        docArray = kjArray(orionldState.kjsonP, NULL);
+      kjChildAdd(docArray, kjTree);
+    }
+  }
+
+  if (mongoc_cursor_error(mongoCursorP, &mongoError))
+  {
+    LM_E(("Database Error (querying the entityTypes collection: %s)", mongoError.message));
+    docArray = NULL;
+  }
+
+  mongoc_cursor_destroy(mongoCursorP);
+  bson_destroy(&mongoFilter);
+  mongoc_collection_destroy(collectionP);
+
+  return docArray;
+}
@@ -0,0 +1,102 @@
+/*
+*
+* Copyright 2021 FIWARE Foundation e.V.
+*
+* This file is part of Orion-LD Context Broker.
+*
+* Orion-LD Context Broker is free software: you can redistribute it and/or
+* modify it under the terms of the GNU Affero General Public License as
+* published by the Free Software Foundation, either version 3 of the
+* License, or (at your option) any later version.
+*
+* Orion-LD Context Broker is distributed in the hope that it will be useful,
+* but WITHOUT ANY WARRANTY; without even the implied warranty of
+* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU Affero
+* General Public License for more details.
+*
+* You should have received a copy of the GNU Affero General Public License
+* along with Orion-LD Context Broker. If not, see http://www.gnu.org/licenses/.
+*
+* For those usages not covered by this license please contact with
+* orionld at fiware dot org
+*
+* Author: Ken Zangelin
+*/
+#include <mongoc/mongoc.h>                                       // MongoDB C Client Driver
+
+#include "logMsg/logMsg.h"                                       // LM_*
+#include "logMsg/traceLevels.h"                                  // Lmt*
+
+#include "orionld/types/OrionldTenant.h"                         // OrionldTenant
+#include "orionld/mongoc/mongocCollectionGet.h"                  // mongocCollectionGetWithDb
+#include "orionld/mongoc/mongocTypeCatalogItemSave.h"            // Own interface
+
+
+
+// -----------------------------------------------------------------------------
+//
+// mongocTypeCatalogItemSave -
+//
+// An entity type without entities is removed from the collection, otherwise its document is upserted:
+//   { "_id": <entity type>, "entities": <count>, "attrs": [ { "name": <attribute name>, "entities": <count> }, ... ] }
+//
+bool mongocTypeCatalogItemSave(OrionldTenant* tenantP, const char* entityType, int entities, const char** attrNameV, int* attrCountV, int attrs)
+{
+  mongoc_collection_t*  collectionP = mongocCollectionGetWithDb(tenantP->mongoDbName, "entityTypes");
+  bson_t                mongoFilter;
+  bson_error_t          mongoError;
+  bool                  ok;
+
+  if (collectionP == NULL)
+    return false;
+
+  bson_init(&mongoFilter);
+  BSON_APPEND_UTF8(&mongoFilter, "_id", entityType);
+
+  if (entities <= 0)
+    ok = mongoc_collection_delete_one(collectionP, &mongoFilter, NULL, NULL, &mongoError);
+  else
+  {
+    bson_t  update;
+    bson_t  set;
+    bson_t  attrArray;
+    bson_t  opts;
+
+    bson_init(&update);
+    BSON_APPEND_DOCUMENT_BEGIN(&update, "$set", &set);
+    BSON_APPEND_INT32(&set, "entities", entities);
+    BSON_APPEND_ARRAY_BEGIN(&set, "attrs", &attrArray);
+
+    for (int ix = 0; ix < attrs; ix++)
+    {
+      char         indexBuf[16];
+      const char*  indexKey;
+      bson_t       attr;
+
+      bson_uint32_to_string(ix, &indexKey, indexBuf, sizeof(indexBuf));
+      BSON_APPEND_DOCUMENT_BEGIN(&attrArray, indexKey, &attr);
+      BSON_APPEND_UTF8(&attr, "name", attrNameV[ix]);
+      BSON_APPEND_INT32(&attr, "entities", attrCountV[ix]);
+      bson_append_document_end(&attrArray, &attr);
+    }
+
+    bson_append_array_end(&set, &attrArray);
+    bson_append_document_end(&update, &set);
+
+    bson_init(&opts);
+    BSON_APPEND_BOOL(&opts, "upsert", true);
+
+    ok = mongoc_collection_update_one(collectionP, &mongoFilter, &update, &opts, NULL, &mongoError);
+
+    bson_destroy(&opts);
+    bson_destroy(&update);
+  }
+
+  if (ok == false)
+    LM_E(("Database Error (saving entity type '%s' in the type catalog: %s)", entityType, mongoError.message));
+
+  bson_destroy(&mongoFilter);
+  mongoc_collection_destroy(collectionP);
+
+  return ok;
+}
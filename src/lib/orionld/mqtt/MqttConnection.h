@@ -25,7 +25,10 @@
 *
 * Author: Ken Zangelin
 */
-#include <MQTTClient.h>                                        // MQTT Client header
+#include <pthread.h>                                             // pthread_mutex_t, pthread_cond_t
+#include <semaphore.h>                                           // sem_t
+
+#include <MQTTAsync.h>                                           // MQTT Async Client header
 
 
 
@@ -33,14 +36,29 @@
 //
 // MqttConnection -
 //
+// Connections are allocated one by one (never moved), as the MQTT client library keeps pointers to them
+// in its callbacks. They are linked in the buckets of the connection table (mqttConnectionList).
+//
+// inFlight is the number of published messages not yet acknowledged by the MQTT broker.
+// It is kept under mqttMaxInFlight, and publishers wait on 'inFlightCond' for a free slot.
+//
 typedef struct MqttConnection
 {
-  char*           host;
-  unsigned short  port;
-  char*           username;
-  char*           password;
-  char*           version;
-  MQTTClient      client;
+  char*                   host;
+  unsigned short          port;
+  char*                   username;
+  char*                   password;
+  char*                   version;
+  MQTTAsync               client;
+  unsigned int            hash;
+  struct MqttConnection*  next;
+
+  sem_t                   connectSem;      // Posted by the connect callbacks
+  bool                    connectOk;
+
+  pthread_mutex_t         inFlightMutex;
+  pthread_cond_t          inFlightCond;
+  int                     inFlight;
 } MqttConnection;
 
 #endif  // SRC_LIB_ORIONLD_MQTT_MQTTCONNECTION_H_
@@ -22,14 +22,81 @@
 *
 * Author: Ken Zangelin
 */
-#include <MQTTClient.h>                                        // MQTT Client header
+#include <string.h>                                              // strcmp
+#include <time.h>                                                // clock_gettime
+#include <semaphore.h>                                           // sem_timedwait
+#include <MQTTAsync.h>                                           // MQTT Async Client header
 
-#include "logMsg/logMsg.h"                                     // LM_*
-#include "logMsg/traceLevels.h"                                // Lmt*
+#include "logMsg/logMsg.h"                                       // LM_*
+#include "logMsg/traceLevels.h"                                  // Lmt*
 
-#include "orionld/mqtt/MqttConnection.h"                       // MqttConnection
-#include "orionld/mqtt/mqttConnectionList.h"                   // Mqtt Connection List
-#include "orionld/mqtt/mqttConnect.h"                          // Own interface
+#include "orionld/common/orionldState.h"                         // mqttMaxInFlight
+#include "orionld/mqtt/MqttConnection.h"                         // MqttConnection
+#include "orionld/mqtt/mqttConnectionList.h"                     // Mqtt Connection List
+#include "orionld/mqtt/mqttNotification.h"                       // mqttTimeout
+#include "orionld/mqtt/mqttConnect.h"                            // Own interface
+
+
+
+// -----------------------------------------------------------------------------
+//
+// connectSuccess - callback from the MQTT client library
+//
+static void connectSuccess(void* context, MQTTAsync_successData* response)
+{
+  MqttConnection* mqP = (MqttConnection*) context;
+
+  mqP->connectOk = true;
+  sem_post(&mqP->connectSem);
+}
+
+
+
+// -----------------------------------------------------------------------------
+//
+// connectFailure - callback from the MQTT client library
+//
+static void connectFailure(void* context, MQTTAsync_failureData* response)
+{
+  MqttConnection* mqP = (MqttConnection*) context;
+
+  LM_E(("Internal Error (unable to connect to MQTT server (%s:%d): error %d)", mqP->host, mqP->port, (response != NULL)? response->code : 0));
+
+  mqP->connectOk = false;
+  sem_post(&mqP->connectSem);
+}
+
+
+
+// -----------------------------------------------------------------------------
+//
+// connectionLost - callback from the MQTT client library
+//
+// The client reconnects automatically (connectOptions.automaticReconnect).
+//
+static void connectionLost(void* context, char* cause)
+{
+  MqttConnection* mqP = (MqttConnection*) context;
+
+  LM_W(("Lost the connection to the MQTT server %s:%d (%s) - reconnecting", mqP->host, mqP->port, (cause != NULL)? cause : "unknown cause"));
+}
+
+
+
+// -----------------------------------------------------------------------------
+//
+// messageArrived - callback from the MQTT client library
+//
+// Orion-LD only publishes - nothing is subscribed to, so no messages are expected.
+// The client library requires this callback though.
+//
+static int messageArrived(void* context, char* topicName, int topicLen, MQTTAsync_message* message)
+{
+  MQTTAsync_freeMessage(&message);
+  MQTTAsync_free(topicName);
+
+  return 1;
+}
 
 
 
@@ -37,19 +104,34 @@
 //
 // mqttConnect -
 //
+// The MQTT client is asynchronous, but the connection is awaited (for mqttTimeout milliseconds), so that
+// errors in the subscription (bad broker address, bad credentials) are detected as soon as possible.
+//
 bool mqttConnect(MqttConnection* mqP, bool mqtts, const char* username, const char* password, const char* host, unsigned short port, const char* version)
 {
-  MQTTClient_connectOptions  connectOptions = MQTTClient_connectOptions_initializer;
-  char                       address[64];
-  int                        status;
+  MQTTAsync_connectOptions  connectOptions = MQTTAsync_connectOptions_initializer;
+  char                      address[64];
+  int                       status;
 
   snprintf(address, sizeof(address), "%s:%d", host, port);
-  MQTTClient_create(&mqP->client, address, "Orion-LD", MQTTCLIENT_PERSISTENCE_NONE, NULL);
+  if ((status = MQTTAsync_create(&mqP->client, address, "Orion-LD", MQTTCLIENT_PERSISTENCE_NONE, NULL)) != MQTTASYNC_SUCCESS)
+  {
+    LM_E(("Internal Error (unable to create MQTT client for %s:%d): MQTTAsync_create error %d", host, port, status));
+    mqP->client = NULL;
+    return false;
+  }
 
-  connectOptions.keepAliveInterval = 20;
-  connectOptions.cleansession      = 1;
-  connectOptions.username          = username;
-  connectOptions.password          = password;
+  MQTTAsync_setCallbacks(mqP->client, mqP, connectionLost, messageArrived, NULL);
+
+  connectOptions.keepAliveInterval  = 20;
+  connectOptions.cleansession       = 1;
+  connectOptions.username           = username;
+  connectOptions.password           = password;
+  connectOptions.maxInflight        = mqttMaxInFlight;
+  connectOptions.automaticReconnect = 1;
+  connectOptions.onSuccess          = connectSuccess;
+  connectOptions.onFailure          = connectFailure;
+  connectOptions.context            = mqP;
 
   //
   // connectOptions.MQTTVersion: Sets the version of MQTT to be used on the connect.
@@ -70,11 +152,28 @@ bool mqttConnect(MqttConnection* mqP, bool mqtts, const char* username, const ch
   //
   // Connecting the to MQTT Broker
   //
-  if ((status = MQTTClient_connect(mqP->client, &connectOptions)) != MQTTCLIENT_SUCCESS)
+  if ((status = MQTTAsync_connect(mqP->client, &connectOptions)) != MQTTASYNC_SUCCESS)
+  {
+    LM_E(("Internal Error (unable to connect to MQTT server (%s:%d): MQTTAsync_connect error %d", host, port, status));
+    return false;
+  }
+
+  struct timespec deadline;
+
+  clock_gettime(CLOCK_REALTIME, &deadline);
+  deadline.tv_sec  += mqttTimeout / 1000;
+  deadline.tv_nsec += (mqttTimeout % 1000) * 1000000;
+  if (deadline.tv_nsec >= 1000000000)
+  {
+    deadline.tv_sec  += 1;
+    deadline.tv_nsec -= 1000000000;
+  }
+
+  if (sem_timedwait(&mqP->connectSem, &deadline) != 0)
   {
-    LM_E(("Internal Error (unable to connect to MQTT server (%s:%d): MQTTClient_connect error %d", host, port, status));
+    LM_E(("Internal Error (timeout connecting to MQTT server (%s:%d))", host, port));
     return false;
   }
 
-  return true;
+  return mqP->connectOk;
 }
@@ -22,13 +22,42 @@
 *
 * Author: Ken Zangelin
 */
-#include "logMsg/logMsg.h"                                     // LM_*
-#include "logMsg/traceLevels.h"                                // Lmt*
+#include <stdlib.h>                                              // calloc, free
+#include <string.h>                                              // strdup
+#include <pthread.h>                                             // pthread_mutex_init, pthread_cond_init
+#include <semaphore.h>                                           // sem_wait, sem_post
 
-#include "orionld/mqtt/MqttConnection.h"                       // MqttConnection
-#include "orionld/mqtt/mqttConnect.h"                          // mqttConnect
-#include "orionld/mqtt/mqttConnectionList.h"                   // Mqtt Connection List
-#include "orionld/mqtt/mqttConnectionAdd.h"                    // Own interface
+#include "logMsg/logMsg.h"                                       // LM_*
+#include "logMsg/traceLevels.h"                                  // Lmt*
+
+#include "orionld/mqtt/MqttConnection.h"                         // MqttConnection
+#include "orionld/mqtt/mqttConnect.h"                            // mqttConnect
+#include "orionld/mqtt/mqttConnectionList.h"                     // Mqtt Connection List
+#include "orionld/mqtt/mqttConnectionHash.h"                     // mqttConnectionHash
+#include "orionld/mqtt/mqttConnectionLookup.h"                   // mqttConnectionLookup
+#include "orionld/mqtt/mqttConnectionAdd.h"                      // Own interface
+
+
+
+// -----------------------------------------------------------------------------
+//
+// connectionFree -
+//
+static void connectionFree(MqttConnection* mqP)
+{
+  if (mqP->client != NULL)
+    MQTTAsync_destroy(&mqP->client);
+
+  pthread_cond_destroy(&mqP->inFlightCond);
+  pthread_mutex_destroy(&mqP->inFlightMutex);
+  sem_destroy(&mqP->connectSem);
+
+  free(mqP->host);
+  free(mqP->username);
+  free(mqP->password);
+  free(mqP->version);
+  free(mqP);
+}
 
 
 
@@ -36,29 +65,58 @@
 //
 // mqttConnectionAdd -
 //
+// Two threads may try to add the same connection at the same time, so, once inside the semaphore,
+// the connection is looked up once more before a new one is created.
+//
 MqttConnection* mqttConnectionAdd(bool mqtts, const char* username, const char* password, const char* host, unsigned short port, const char* version)
 {
-  if (mqttConnectionListIx >= mqttConnectionListSize)
+  sem_wait(&mqttConnectionListSem);
+
+  MqttConnection* mqP = mqttConnectionLookup(host, port, username, password, version);
+
+  if (mqP != NULL)
   {
-    mqttConnectionListSize += 20;
-    mqttConnectionList      = (MqttConnection*) realloc(mqttConnectionList, sizeof(MqttConnection) * mqttConnectionListSize);
+    sem_post(&mqttConnectionListSem);
+    return mqP;
   }
 
-  MqttConnection* mqP = &mqttConnectionList[mqttConnectionListIx];
+  mqP = (MqttConnection*) calloc(1, sizeof(MqttConnection));
+  if (mqP == NULL)
+  {
+    sem_post(&mqttConnectionListSem);
+    LM_E(("Internal Error (out of memory allocating an MQTT connection)"));
+    return NULL;
+  }
 
   mqP->host     = strdup(host);
   mqP->port     = port;
   mqP->username = (username != NULL)? strdup(username) : NULL;
   mqP->password = (password != NULL)? strdup(password) : NULL;
   mqP->version  = (version  != NULL)? strdup(version)  : NULL;
+  mqP->hash     = mqttConnectionHash(host, port);
+  mqP->inFlight = 0;
+
+  sem_init(&mqP->connectSem, 0, 0);
+  pthread_mutex_init(&mqP->inFlightMutex, NULL);
+  pthread_cond_init(&mqP->inFlightCond, NULL);
 
   if (mqttConnect(mqP, mqtts, username, password, host, port, version) == false)
   {
+    sem_post(&mqttConnectionListSem);
     LM_E(("Internal Error (mqttConnect failed)"));
+    connectionFree(mqP);
     return NULL;
   }
 
-  ++mqttConnectionListIx;
+  //
+  // Publish the new connection - at the head of its bucket
+  //
+  int bucket = mqP->hash & (MQTT_CONNECTION_BUCKETS - 1);
+
+  mqP->next = mqttConnectionList[bucket];
+  __atomic_store_n(&mqttConnectionList[bucket], mqP, __ATOMIC_RELEASE);
+
+  sem_post(&mqttConnectionListSem);
 
   return mqP;
 }
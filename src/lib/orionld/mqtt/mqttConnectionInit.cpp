@@ -22,13 +22,11 @@
 *
 * Author: Ken Zangelin
 */
-#include <stdlib.h>                                            // calloc
+#include <semaphore.h>                                           // sem_init
 
-#include <MQTTClient.h>                                        // MQTT Client header
-
-#include "orionld/mqtt/MqttConnection.h"                       // MqttConnection
-#include "orionld/mqtt/mqttConnectionList.h"                   // Mqtt Connection List
-#include "orionld/mqtt/mqttConnectionInit.h"                   // Own interface
+#include "orionld/mqtt/MqttConnection.h"                         // MqttConnection
+#include "orionld/mqtt/mqttConnectionList.h"                     // Mqtt Connection List
+#include "orionld/mqtt/mqttConnectionInit.h"                     // Own interface
 
 
 
@@ -41,8 +39,9 @@ void mqttConnectionInit(void)
   if (mqttConnectionListInitialized == true)
     return;
 
-  mqttConnectionList            = (MqttConnection*) calloc(sizeof(MqttConnection), 100);
-  mqttConnectionListSize        = 100;
-  mqttConnectionListIx          = 0;
+  for (int ix = 0; ix < MQTT_CONNECTION_BUCKETS; ix++)
+    mqttConnectionList[ix] = NULL;
+
+  sem_init(&mqttConnectionListSem, 0, 1);
   mqttConnectionListInitialized = true;
 }
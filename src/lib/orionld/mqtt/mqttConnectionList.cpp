@@ -22,9 +22,10 @@
 *
 * Author: Ken Zangelin
 */
-#include <semaphore.h>                                         // sem_t
+#include <semaphore.h>                                           // sem_t
 
-#include "orionld/mqtt/MqttConnection.h"                       // MqttConnection
+#include "orionld/mqtt/MqttConnection.h"                         // MqttConnection
+#include "orionld/mqtt/mqttConnectionList.h"                     // MQTT_CONNECTION_BUCKETS
 
 
 
@@ -32,8 +33,6 @@
 //
 // MQTT Connection List Variable
 //
-MqttConnection* mqttConnectionList            = NULL;
-int             mqttConnectionListSize        = 0;
-int             mqttConnectionListIx          = 0;
+MqttConnection* mqttConnectionList[MQTT_CONNECTION_BUCKETS];
 bool            mqttConnectionListInitialized = false;
 sem_t           mqttConnectionListSem;
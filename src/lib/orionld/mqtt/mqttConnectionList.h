@@ -25,9 +25,17 @@
 *
 * Author: Ken Zangelin
 */
-#include <semaphore.h>                                         // sem_t
+#include <semaphore.h>                                           // sem_t
 
-#include "orionld/mqtt/MqttConnection.h"                       // MqttConnection
+#include "orionld/mqtt/MqttConnection.h"                         // MqttConnection
+
+
+
+// -----------------------------------------------------------------------------
+//
+// MQTT_CONNECTION_BUCKETS - number of buckets of the MQTT connection table (a power of two)
+//
+#define MQTT_CONNECTION_BUCKETS  64
 
 
 
@@ -35,9 +43,11 @@
 //
 // MQTT Connection List Variable
 //
-extern MqttConnection* mqttConnectionList;
-extern int             mqttConnectionListSize;
-extern int             mqttConnectionListIx;
+// Hash table of connections, chained per bucket.
+// Connections are added (under mqttConnectionListSem) but never removed until mqttRelease, so lookups
+// need no semaphore - the bucket heads are read and written atomically.
+//
+extern MqttConnection* mqttConnectionList[MQTT_CONNECTION_BUCKETS];
 extern bool            mqttConnectionListInitialized;
 extern sem_t           mqttConnectionListSem;
 
@@ -22,14 +22,32 @@
 *
 * Author: Ken Zangelin
 */
-#include <MQTTClient.h>                                        // MQTT Client header
+#include <string.h>                                              // strcmp
 
-#include "logMsg/logMsg.h"                                     // LM_*
-#include "logMsg/traceLevels.h"                                // Lmt*
+#include "logMsg/logMsg.h"                                       // LM_*
+#include "logMsg/traceLevels.h"                                  // Lmt*
 
-#include "orionld/mqtt/MqttConnection.h"                       // MqttConnection
-#include "orionld/mqtt/mqttConnectionList.h"                   // Mqtt Connection List
-#include "orionld/mqtt/mqttConnectionLookup.h"                 // Own interface
+#include "orionld/mqtt/MqttConnection.h"                         // MqttConnection
+#include "orionld/mqtt/mqttConnectionList.h"                     // Mqtt Connection List
+#include "orionld/mqtt/mqttConnectionHash.h"                     // mqttConnectionHash
+#include "orionld/mqtt/mqttConnectionLookup.h"                   // Own interface
+
+
+
+// -----------------------------------------------------------------------------
+//
+// credentialMatch - a connection without the credential (username/password/version) matches any
+//
+static bool credentialMatch(const char* wanted, const char* connectionValue)
+{
+  if (connectionValue == NULL)
+    return true;
+
+  if (wanted == NULL)
+    return false;
+
+  return strcmp(wanted, connectionValue) == 0;
+}
 
 
 
@@ -39,23 +57,22 @@
 //
 MqttConnection* mqttConnectionLookup(const char* host, unsigned short port, const char* username, const char* password, const char* version)
 {
-  for (int ix = 0; ix < mqttConnectionListIx; ix++)
-  {
-    MqttConnection* mqP = &mqttConnectionList[ix];
-
-    if (mqP->port != port)
-      continue;
+  unsigned int     hash = mqttConnectionHash(host, port);
+  MqttConnection*  mqP  = __atomic_load_n(&mqttConnectionList[hash & (MQTT_CONNECTION_BUCKETS - 1)], __ATOMIC_ACQUIRE);
 
-    if (strcmp(host, mqP->host) != 0)
-      continue;
-    if ((mqP->username != NULL) && (strcmp(username, mqP->username) != 0))
-      continue;
-    if ((mqP->password != NULL) && (strcmp(password, mqP->password) != 0))
-      continue;
-    if ((mqP->version != NULL) && (strcmp(version, mqP->version)    != 0))
-      continue;
+  while (mqP != NULL)
+  {
+    if ((mqP->hash == hash)                                 &&
+        (mqP->port == port)                                 &&
+        (strcmp(host, mqP->host) == 0)                      &&
+        (credentialMatch(username, mqP->username) == true)  &&
+        (credentialMatch(password, mqP->password) == true)  &&
+        (credentialMatch(version,  mqP->version)  == true))
+    {
+      return mqP;
+    }
 
-    return mqP;
+    mqP = mqP->next;
   }
 
   return NULL;
@@ -25,8 +25,6 @@
 *
 * Author: Ken Zangelin
 */
-#include <MQTTClient.h>                                        // MQTT Client header
-
 #include "orionld/mqtt/MqttConnection.h"                       // MqttConnection
 
 
@@ -22,8 +22,12 @@
 *
 * Author: Ken Zangelin
 */
-#include <string.h>                                            // strlen
-#include <MQTTClient.h>                                        // MQTT Client header
+#include <string.h>                                            // strlen, memcpy
+#include <stdlib.h>                                            // malloc, free
+#include <time.h>                                              // clock_gettime
+#include <errno.h>                                             // ETIMEDOUT
+#include <pthread.h>                                           // pthread_mutex_*, pthread_cond_*
+#include <MQTTAsync.h>                                         // MQTT Async Client header
 #include <string>                                              // std::string
 #include <map>                                                 // std::map
 
@@ -37,7 +41,8 @@ extern "C"
 #include "logMsg/logMsg.h"                                     // LM_*
 #include "logMsg/traceLevels.h"                                // Lmt*
 
-#include "orionld/common/orionldState.h"                       // orionldState
+#include "orionld/common/orionldState.h"                       // orionldState, mqttMaxInFlight
+#include "orionld/notifications/notificationOutcome.h"         // notificationOutcomePush
 #include "orionld/mqtt/MqttConnection.h"                       // MqttConnection
 #include "orionld/mqtt/mqttConnectionLookup.h"                 // mqttConnectionLookup
 #include "orionld/mqtt/mqttConnectionAdd.h"                    // mqttConnectionAdd
@@ -47,12 +52,158 @@ extern "C"
 
 // -----------------------------------------------------------------------------
 //
-// mqttTimeout
+// mqttTimeout - max time in milliseconds to wait for a connection to the MQTT broker, or for room in its in-flight window
 //
 int  mqttTimeout = 10000;  // FIXME: This variable should be a CLI for Orion-LD
 
 
 
+// -----------------------------------------------------------------------------
+//
+// MqttPublication - what's needed to handle the outcome of a published notification
+//
+// The strings 'tenant' and 'subscriptionId' are allocated together with the struct.
+// subscriptionId is NULL if the outcome is not to be recorded in the subscription (lastSuccess/lastFailure).
+//
+typedef struct MqttPublication
+{
+  MqttConnection*  mqP;
+  char*            tenant;
+  char*            subscriptionId;
+} MqttPublication;
+
+
+
+// -----------------------------------------------------------------------------
+//
+// inFlightSlotGet - wait (max mqttTimeout milliseconds) for the in-flight window of the connection to have room
+//
+static bool inFlightSlotGet(MqttConnection* mqP)
+{
+  struct timespec  deadline;
+  bool             ok = true;
+
+  clock_gettime(CLOCK_REALTIME, &deadline);
+  deadline.tv_sec  += mqttTimeout / 1000;
+  deadline.tv_nsec += (mqttTimeout % 1000) * 1000000;
+  if (deadline.tv_nsec >= 1000000000)
+  {
+    deadline.tv_sec  += 1;
+    deadline.tv_nsec -= 1000000000;
+  }
+
+  pthread_mutex_lock(&mqP->inFlightMutex);
+
+  while (mqP->inFlight >= mqttMaxInFlight)
+  {
+    if (pthread_cond_timedwait(&mqP->inFlightCond, &mqP->inFlightMutex, &deadline) == ETIMEDOUT)
+    {
+      ok = false;
+      break;
+    }
+  }
+
+  if (ok == true)
+    ++mqP->inFlight;
+
+  pthread_mutex_unlock(&mqP->inFlightMutex);
+
+  return ok;
+}
+
+
+
+// -----------------------------------------------------------------------------
+//
+// inFlightSlotRelease -
+//
+static void inFlightSlotRelease(MqttConnection* mqP)
+{
+  pthread_mutex_lock(&mqP->inFlightMutex);
+  --mqP->inFlight;
+  pthread_cond_signal(&mqP->inFlightCond);
+  pthread_mutex_unlock(&mqP->inFlightMutex);
+}
+
+
+
+// -----------------------------------------------------------------------------
+//
+// publicationDone -
+//
+// Called from a thread of the MQTT client library, that must not block on the subscription cache nor on the database.
+// The outcome (lastSuccess/lastFailure of the subscription) is handed over to the notification outcome thread.
+//
+static void publicationDone(MqttPublication* pubP, int errors)
+{
+  inFlightSlotRelease(pubP->mqP);
+
+  if (pubP->subscriptionId != NULL)
+    notificationOutcomePush(pubP->tenant, pubP->subscriptionId, errors == 0);
+
+  free(pubP);
+}
+
+
+
+// -----------------------------------------------------------------------------
+//
+// publishSuccess - callback from the MQTT client library
+//
+static void publishSuccess(void* context, MQTTAsync_successData* response)
+{
+  publicationDone((MqttPublication*) context, 0);
+}
+
+
+
+// -----------------------------------------------------------------------------
+//
+// publishFailure - callback from the MQTT client library
+//
+static void publishFailure(void* context, MQTTAsync_failureData* response)
+{
+  MqttPublication* pubP = (MqttPublication*) context;
+
+  LM_E(("Internal Error (MQTT publish to %s:%d failed: error %d)", pubP->mqP->host, pubP->mqP->port, (response != NULL)? response->code : 0));
+  publicationDone(pubP, 1);
+}
+
+
+
+// -----------------------------------------------------------------------------
+//
+// publicationCreate -
+//
+static MqttPublication* publicationCreate(MqttConnection* mqP, const char* tenant, const char* subscriptionId)
+{
+  int               tenantLen = (tenant         != NULL)? strlen(tenant)         : 0;
+  int               subIdLen  = (subscriptionId != NULL)? strlen(subscriptionId) : 0;
+  MqttPublication*  pubP      = (MqttPublication*) malloc(sizeof(MqttPublication) + tenantLen + subIdLen + 2);
+
+  if (pubP == NULL)
+    return NULL;
+
+  pubP->mqP    = mqP;
+  pubP->tenant = (char*) &pubP[1];
+
+  if (tenantLen > 0)
+    memcpy(pubP->tenant, tenant, tenantLen);
+  pubP->tenant[tenantLen] = 0;
+
+  if (subscriptionId != NULL)
+  {
+    pubP->subscriptionId = &pubP->tenant[tenantLen + 1];
+    memcpy(pubP->subscriptionId, subscriptionId, subIdLen + 1);
+  }
+  else
+    pubP->subscriptionId = NULL;
+
+  return pubP;
+}
+
+
+
 // -----------------------------------------------------------------------------
 //
 // mqttNotification -
@@ -69,6 +220,8 @@ int mqttNotification
   const char*                         password,
   const char*                         mqttVersion,
   const char*                         xauthToken,
+  const char*                         tenant,
+  const char*                         subscriptionId,
   std::map<std::string, std::string>& extraHeaders
 )
 {
@@ -136,31 +289,53 @@ int mqttNotification
 
   snprintf(totalBuf, totalLen, "{\"metadata\": %s,\"body\": %s}", metadataBuf, body);
 
-  MqttConnection*           mqttP   = mqttConnectionLookup(host, port, username, password, mqttVersion);
-  MQTTClient_message        mqttMsg = MQTTClient_message_initializer;
-  MQTTClient_deliveryToken  mqttToken;
+  MqttConnection*            mqttP   = mqttConnectionLookup(host, port, username, password, mqttVersion);
+  MQTTAsync_message          mqttMsg = MQTTAsync_message_initializer;
+  MQTTAsync_responseOptions  options = MQTTAsync_responseOptions_initializer;
+  MqttPublication*           pubP;
 
   if (mqttP == NULL)
   {
     mqttP = mqttConnectionAdd(false, username, password, host, port, mqttVersion);
     if (mqttP == NULL)
     {
-      LM_E(("Internal Error (unable to connec t to MQTT broker at %s:%d)", host, port));
+      LM_E(("Internal Error (unable to connect to MQTT broker at %s:%d)", host, port));
       return -1;
     }
   }
 
+  if (inFlightSlotGet(mqttP) == false)
+  {
+    LM_E(("Internal Error (timeout waiting for room in the MQTT in-flight window of %s:%d)", host, port));
+    return -1;
+  }
+
+  if ((pubP = publicationCreate(mqttP, tenant, subscriptionId)) == NULL)
+  {
+    inFlightSlotRelease(mqttP);
+    LM_E(("Internal Error (unable to allocate)"));
+    return -1;
+  }
+
   mqttMsg.payload    = (void*) totalBuf;
   mqttMsg.payloadlen = strlen(totalBuf);
   mqttMsg.qos        = QoS;
   mqttMsg.retained   = 0;
 
-  MQTTClient_publishMessage(mqttP->client, topic, &mqttMsg, &mqttToken);
+  options.onSuccess  = publishSuccess;
+  options.onFailure  = publishFailure;
+  options.context    = pubP;
 
-  int rc = MQTTClient_waitForCompletion(mqttP->client, mqttToken, mqttTimeout);
-  if (rc != 0)
+  //
+  // The message is copied by the MQTT client library and the outcome is reported to publishSuccess/publishFailure.
+  // No waiting for the MQTT broker here.
+  //
+  int rc = MQTTAsync_sendMessage(mqttP->client, topic, &mqttMsg, &options);
+  if (rc != MQTTASYNC_SUCCESS)
   {
-    LM_E(("Internal Error (MQTT waitForCompletion error %d)", rc));
+    LM_E(("Internal Error (MQTT sendMessage error %d)", rc));
+    inFlightSlotRelease(mqttP);
+    free(pubP);
     return -1;
   }
 
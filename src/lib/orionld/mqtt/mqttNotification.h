@@ -32,7 +32,19 @@
 
 // -----------------------------------------------------------------------------
 //
-// mqttNotification -
+// mqttTimeout -
+//
+extern int mqttTimeout;
+
+
+
+// -----------------------------------------------------------------------------
+//
+// mqttNotification - publish a notification on an MQTT broker
+//
+// The notification is published asynchronously - the return value only tells whether it could be queued.
+// The outcome is recorded in the subscription (lastSuccess/lastFailure) once the broker has acknowledged it,
+// unless 'subscriptionId' is NULL.
 //
 extern int mqttNotification
 (
@@ -46,6 +58,8 @@ extern int mqttNotification
   const char*                         password,
   const char*                         mqttVersion,
   const char*                         xauthToken,
+  const char*                         tenant,
+  const char*                         subscriptionId,
   std::map<std::string, std::string>& extraHeaders
 );
 
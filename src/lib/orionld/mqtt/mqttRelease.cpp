@@ -22,11 +22,12 @@
 *
 * Author: Ken Zangelin
 */
-#include <stdlib.h>                                            // free
+#include <stdlib.h>                                              // free
+#include <MQTTAsync.h>                                           // MQTT Async Client header
 
-#include "orionld/mqtt/MqttConnection.h"                       // MqttConnection
-#include "orionld/mqtt/mqttConnectionList.h"                   // mqttConnectionList
-#include "orionld/mqtt/mqttRelease.h"                          // Own Interface
+#include "orionld/mqtt/MqttConnection.h"                         // MqttConnection
+#include "orionld/mqtt/mqttConnectionList.h"                     // mqttConnectionList
+#include "orionld/mqtt/mqttRelease.h"                            // Own Interface
 
 
 
@@ -36,20 +37,33 @@
 //
 void mqttRelease(void)
 {
-  if (mqttConnectionList == NULL)
+  if (mqttConnectionListInitialized == false)
     return;
 
-  for (int ix = 0; ix < mqttConnectionListIx; ix++)
+  for (int bucket = 0; bucket < MQTT_CONNECTION_BUCKETS; bucket++)
   {
-    MqttConnection* mcP = &mqttConnectionList[ix];
+    MqttConnection* mcP = mqttConnectionList[bucket];
+
+    while (mcP != NULL)
+    {
+      MqttConnection*              next              = mcP->next;
+      MQTTAsync_disconnectOptions  disconnectOptions = MQTTAsync_disconnectOptions_initializer;
+
+      disconnectOptions.timeout = 10000;
+      MQTTAsync_disconnect(mcP->client, &disconnectOptions);
+      MQTTAsync_destroy(&mcP->client);
 
-    if (mcP->host != NULL)
       free(mcP->host);
+      free(mcP->username);
+      free(mcP->password);
+      free(mcP->version);
+      free(mcP);
+
+      mcP = next;
+    }
 
-    MQTTClient_disconnect(&mcP->client, 10000);
-    MQTTClient_destroy(&mcP->client);
+    mqttConnectionList[bucket] = NULL;
   }
 
-  free(mqttConnectionList);
-  mqttConnectionList = NULL;
+  mqttConnectionListInitialized = false;
 }
@@ -0,0 +1,72 @@
+#ifndef SRC_LIB_ORIONLD_NOTIFICATIONS_NOTIFICATIONENDPOINT_H_
+#define SRC_LIB_ORIONLD_NOTIFICATIONS_NOTIFICATIONENDPOINT_H_
+
+/*
+*
+* Copyright 2021 FIWARE Foundation e.V.
+*
+* This file is part of Orion-LD Context Broker.
+*
+* Orion-LD Context Broker is free software: you can redistribute it and/or
+* modify it under the terms of the GNU Affero General Public License as
+* published by the Free Software Foundation, either version 3 of the
+* License, or (at your option) any later version.
+*
+* Orion-LD Context Broker is distributed in the hope that it will be useful,
+* but WITHOUT ANY WARRANTY; without even the implied warranty of
+* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU Affero
+* General Public License for more details.
+*
+* You should have received a copy of the GNU Affero General Public License
+* along with Orion-LD Context Broker. If not, see http://www.gnu.org/licenses/.
+*
+* For those usages not covered by this license please contact with
+* orionld at fiware dot org
+*
+* Author: Ken Zangelin
+*/
+#include <time.h>                                              // time_t
+#include <semaphore.h>                                         // sem_t
+#include <netinet/in.h>                                        // struct sockaddr_in
+
+
+
+// -----------------------------------------------------------------------------
+//
+// NotificationIdleConnection - a keep-alive connection, not in use, ready to be reused
+//
+typedef struct NotificationIdleConnection
+{
+  int     fd;
+  time_t  lastUsed;
+} NotificationIdleConnection;
+
+
+
+// -----------------------------------------------------------------------------
+//
+// NotificationEndpoint - all pooled connections to one host:port
+//
+// idleV has room for 'notifPoolSize' connections.
+// Connections in use are not in idleV, only counted in 'activeConnections'.
+// 'slots' limits the connections in use to 'notifMaxConns' (if not zero) - a slot is taken by notificationConnectionGet
+// and given back by notificationConnectionRelease.
+// 'addr' is the address of the endpoint, resolved by a resolver thread (see notificationConnectionTryGet),
+// so that no sender thread ever blocks in a DNS lookup.
+//
+typedef struct NotificationEndpoint
+{
+  char*                         host;
+  unsigned short                port;
+  NotificationIdleConnection*   idleV;
+  int                           idleConnections;
+  int                           activeConnections;
+  sem_t                         slots;
+  struct sockaddr_in            addr;
+  bool                          resolved;         // 'addr' is valid
+  bool                          resolving;        // a resolver thread is running for the endpoint
+  time_t                        resolvedAt;       // time of the last resolution (successful or not)
+  struct NotificationEndpoint*  next;
+} NotificationEndpoint;
+
+#endif  // SRC_LIB_ORIONLD_NOTIFICATIONS_NOTIFICATIONENDPOINT_H_
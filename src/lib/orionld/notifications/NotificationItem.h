@@ -0,0 +1,60 @@
+#ifndef SRC_LIB_ORIONLD_NOTIFICATIONS_NOTIFICATIONITEM_H_
+#define SRC_LIB_ORIONLD_NOTIFICATIONS_NOTIFICATIONITEM_H_
+
+/*
+*
+* Copyright 2021 FIWARE Foundation e.V.
+*
+* This file is part of Orion-LD Context Broker.
+*
+* Orion-LD Context Broker is free software: you can redistribute it and/or
+* modify it under the terms of the GNU Affero General Public License as
+* published by the Free Software Foundation, either version 3 of the
+* License, or (at your option) any later version.
+*
+* Orion-LD Context Broker is distributed in the hope that it will be useful,
+* but WITHOUT ANY WARRANTY; without even the implied warranty of
+* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU Affero
+* General Public License for more details.
+*
+* You should have received a copy of the GNU Affero General Public License
+* along with Orion-LD Context Broker. If not, see http://www.gnu.org/licenses/.
+*
+* For those usages not covered by this license please contact with
+* orionld at fiware dot org
+*
+* Author: Ken Zangelin
+*/
+#include <stdint.h>                                            // uint16_t
+#include <time.h>                                              // struct timespec
+
+
+
+// -----------------------------------------------------------------------------
+//
+// NOTIFICATION_RESPONSE_TIMEOUT - max number of seconds to wait for the response of a notification
+//
+#define NOTIFICATION_RESPONSE_TIMEOUT 10
+
+
+
+// -----------------------------------------------------------------------------
+//
+// NotificationItem - a fully rendered notification, ready to be sent by a notification sender thread
+//
+// All fields are allocated in ONE malloc - the item is freed with a single call to free().
+// The request thread that renders the notification is long gone when the notification is sent,
+// so nothing can point to the kalloc buffer of the request.
+//
+typedef struct NotificationItem
+{
+  char*            host;
+  uint16_t         port;
+  char*            tenant;          // For the lastSuccess/lastFailure of the subscription
+  char*            subscriptionId;
+  char*            request;         // HTTP headers and payload body
+  int              requestLen;
+  struct timespec  enqueueTime;
+} NotificationItem;
+
+#endif  // SRC_LIB_ORIONLD_NOTIFICATIONS_NOTIFICATIONITEM_H_
@@ -0,0 +1,409 @@
+/*
+*
+* Copyright 2021 FIWARE Foundation e.V.
+*
+* This file is part of Orion-LD Context Broker.
+*
+* Orion-LD Context Broker is free software: you can redistribute it and/or
+* modify it under the terms of the GNU Affero General Public License as
+* published by the Free Software Foundation, either version 3 of the
+* License, or (at your option) any later version.
+*
+* Orion-LD Context Broker is distributed in the hope that it will be useful,
+* but WITHOUT ANY WARRANTY; without even the implied warranty of
+* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU Affero
+* General Public License for more details.
+*
+* You should have received a copy of the GNU Affero General Public License
+* along with Orion-LD Context Broker. If not, see http://www.gnu.org/licenses/.
+*
+* For those usages not covered by this license please contact with
+* orionld at fiware dot org
+*
+* Author: Ken Zangelin
+*/
+#include <string.h>                                            // strcmp, strdup, strerror, bzero
+#include <unistd.h>                                            // close
+#include <errno.h>                                             // errno
+#include <time.h>                                              // time, clock_gettime
+#include <semaphore.h>                                         // sem_wait, sem_post, sem_timedwait
+#include <pthread.h>                                           // pthread_create
+#include <netdb.h>                                             // getaddrinfo, freeaddrinfo, gai_strerror
+#include <sys/socket.h>                                        // recv, socket
+
+#include "logMsg/logMsg.h"                                     // LM_*
+#include "logMsg/traceLevels.h"                                // Lmt*
+
+#include "orionld/common/orionldState.h"                       // notifPoolSize, notifIdleTimeout, notifMaxConns
+#include "orionld/common/orionldServerConnect.h"               // orionldServerConnect
+#include "orionld/notifications/NotificationItem.h"            // NOTIFICATION_RESPONSE_TIMEOUT
+#include "orionld/notifications/NotificationEndpoint.h"        // NotificationEndpoint
+#include "orionld/notifications/notificationConnectionPool.h"  // notificationEndpointTable, ...
+#include "orionld/notifications/notificationConnectionGet.h"   // Own interface
+
+
+
+// -----------------------------------------------------------------------------
+//
+// connectionAlive - is the idle connection still usable?
+//
+// A keep-alive connection that has been closed by the peer is readable with zero bytes.
+// A connection with unread data is not in a known state - not reused either.
+//
+static bool connectionAlive(int fd)
+{
+  char c;
+  int  nb = recv(fd, &c, 1, MSG_PEEK | MSG_DONTWAIT);
+
+  if (nb == -1)
+    return ((errno == EAGAIN) || (errno == EWOULDBLOCK));
+
+  return false;
+}
+
+
+
+// -----------------------------------------------------------------------------
+//
+// notificationEndpointLookup - find (or create) the pool item for host:port
+//
+// The caller must hold notificationConnectionPoolSem
+//
+static NotificationEndpoint* notificationEndpointLookup(const char* host, unsigned short port)
+{
+  unsigned int           bucket = notificationEndpointHash(host, port);
+  NotificationEndpoint*  epP    = notificationEndpointTable[bucket];
+
+  while (epP != NULL)
+  {
+    if ((epP->port == port) && (strcmp(epP->host, host) == 0))
+      return epP;
+
+    epP = epP->next;
+  }
+
+  epP = (NotificationEndpoint*) calloc(1, sizeof(NotificationEndpoint));
+  if (epP == NULL)
+    LM_X(1, ("Out of memory allocating a notification endpoint"));
+
+  epP->host  = strdup(host);
+  epP->port  = port;
+  epP->idleV = (notifPoolSize > 0)? (NotificationIdleConnection*) calloc(notifPoolSize, sizeof(NotificationIdleConnection)) : NULL;
+  epP->next  = notificationEndpointTable[bucket];
+
+  if ((epP->host == NULL) || ((notifPoolSize > 0) && (epP->idleV == NULL)))
+    LM_X(1, ("Out of memory allocating a notification endpoint"));
+
+  if (sem_init(&epP->slots, 0, notifMaxConns) == -1)
+    LM_X(1, ("Runtime Error (error initializing semaphore for notification endpoint %s:%d: %s)", host, port, strerror(errno)));
+
+  notificationEndpointTable[bucket] = epP;
+
+  return epP;
+}
+
+
+
+// -----------------------------------------------------------------------------
+//
+// idleConnectionPop - pop a reusable idle connection of the endpoint, -1 if there is none
+//
+// Idle connections are popped LIFO - the most recently used connection is the one least likely
+// to have been closed by the peer.
+// Connections that have been idle for more than 'notifIdleTimeout' seconds, and connections that
+// have been closed by the peer are closed and removed from the pool.
+//
+// The caller must hold notificationConnectionPoolSem
+//
+static int idleConnectionPop(NotificationEndpoint* epP, time_t now)
+{
+  while (epP->idleConnections > 0)
+  {
+    NotificationIdleConnection* icP = &epP->idleV[epP->idleConnections - 1];
+
+    epP->idleConnections -= 1;
+
+    if (now - icP->lastUsed > notifIdleTimeout)
+    {
+      close(icP->fd);
+      ++notificationConnectionPoolEvictions;
+      continue;
+    }
+
+    if (connectionAlive(icP->fd) == false)
+    {
+      close(icP->fd);
+      ++notificationConnectionPoolStale;
+      continue;
+    }
+
+    return icP->fd;
+  }
+
+  return -1;
+}
+
+
+
+// -----------------------------------------------------------------------------
+//
+// slotWait - wait for a free connection slot of the endpoint, at most NOTIFICATION_RESPONSE_TIMEOUT seconds
+//
+static bool slotWait(NotificationEndpoint* epP)
+{
+  struct timespec deadline;
+
+  clock_gettime(CLOCK_REALTIME, &deadline);
+  deadline.tv_sec += NOTIFICATION_RESPONSE_TIMEOUT;
+
+  while (sem_timedwait(&epP->slots, &deadline) == -1)
+  {
+    if (errno != EINTR)
+      return false;
+  }
+
+  return true;
+}
+
+
+
+// -----------------------------------------------------------------------------
+//
+// notificationConnectionGet - get a connection to host:port, from the pool if possible
+//
+// No more than 'notifMaxConns' connections to the same endpoint are in use at the same time.
+// If that limit is reached, the caller waits for a connection to be released - for at most
+// NOTIFICATION_RESPONSE_TIMEOUT seconds. After that, the connection is refused (-1 is returned).
+//
+// If no reusable connection is found, a new connection is opened, outside the semaphore.
+//
+int notificationConnectionGet(const char* host, unsigned short port, bool* reusedP)
+{
+  *reusedP = false;
+
+  if (notificationConnectionPoolInitialized == false)
+    return orionldServerConnect((char*) host, port);
+
+  int                    fd  = -1;
+  NotificationEndpoint*  epP;
+
+  sem_wait(&notificationConnectionPoolSem);
+  epP = notificationEndpointLookup(host, port);  // Endpoints are never removed while serving
+  sem_post(&notificationConnectionPoolSem);
+
+  if ((notifMaxConns > 0) && (slotWait(epP) == false))
+  {
+    sem_wait(&notificationConnectionPoolSem);
+    ++notificationConnectionPoolRefused;
+    sem_post(&notificationConnectionPoolSem);
+
+    LM_W(("Notification endpoint %s:%d has %d connections in use - connection refused", host, port, notifMaxConns));
+    return -1;
+  }
+
+  time_t now = time(NULL);
+
+  sem_wait(&notificationConnectionPoolSem);
+
+  fd = idleConnectionPop(epP, now);
+  epP->activeConnections += 1;
+
+  if (fd != -1)
+    ++notificationConnectionPoolHits;
+  else
+    ++notificationConnectionPoolMisses;
+
+  sem_post(&notificationConnectionPoolSem);
+
+  if (fd != -1)
+  {
+    LM_T(LmtNotifier, ("Reusing keep-alive connection %d to %s:%d", fd, host, port));
+    *reusedP = true;
+    return fd;
+  }
+
+  fd = orionldServerConnect((char*) host, port);
+
+  if (fd == -1)
+  {
+    sem_wait(&notificationConnectionPoolSem);
+    epP->activeConnections -= 1;
+    sem_post(&notificationConnectionPoolSem);
+
+    if (notifMaxConns > 0)
+      sem_post(&epP->slots);
+  }
+
+  return fd;
+}
+
+
+
+// -----------------------------------------------------------------------------
+//
+// endpointResolver - thread resolving the address of a notification endpoint
+//
+// Endpoints are never removed while serving, so the thread can keep a pointer to the endpoint.
+//
+static void* endpointResolver(void* vP)
+{
+  NotificationEndpoint*  epP    = (NotificationEndpoint*) vP;
+  struct addrinfo*       result = NULL;
+  struct addrinfo        hints;
+
+  bzero(&hints, sizeof(hints));
+  hints.ai_family   = AF_INET;
+  hints.ai_socktype = SOCK_STREAM;
+
+  int rc = getaddrinfo(epP->host, NULL, &hints, &result);
+
+  if (rc != 0)
+    LM_W(("Unable to resolve the notification endpoint '%s': %s", epP->host, gai_strerror(rc)));
+
+  sem_wait(&notificationConnectionPoolSem);
+
+  if (rc == 0)
+  {
+    epP->addr          = *((struct sockaddr_in*) result->ai_addr);
+    epP->addr.sin_port = htons(epP->port);
+  }
+
+  epP->resolved   = (rc == 0);
+  epP->resolving  = false;
+  epP->resolvedAt = time(NULL);
+
+  sem_post(&notificationConnectionPoolSem);
+
+  if (result != NULL)
+    freeaddrinfo(result);
+
+  return NULL;
+}
+
+
+
+// -----------------------------------------------------------------------------
+//
+// endpointResolve - start a resolver thread for the endpoint, unless one is running already
+//
+// The caller must hold notificationConnectionPoolSem
+//
+static void endpointResolve(NotificationEndpoint* epP, time_t now)
+{
+  if (epP->resolving == true)
+    return;
+
+  time_t ttl = (epP->resolved == true)? NOTIFICATION_RESOLVE_TTL : NOTIFICATION_RESPONSE_TIMEOUT;
+
+  if ((epP->resolvedAt != 0) && (now - epP->resolvedAt <= ttl))
+    return;
+
+  pthread_t  tid;
+  int        rc = pthread_create(&tid, NULL, endpointResolver, epP);
+
+  if (rc != 0)
+  {
+    LM_E(("Runtime Error (pthread_create: %s)", strerror(rc)));
+    epP->resolvedAt = now;  // Not to try again in every loop of the sender
+    return;
+  }
+
+  pthread_detach(tid);
+  epP->resolving = true;
+}
+
+
+
+// -----------------------------------------------------------------------------
+//
+// notificationConnectionTryGet - get a connection to host:port without ever blocking
+//
+// Used by the notification sender threads, that serve many notifications at the same time in an epoll loop.
+// Returns:
+//   - a reused keep-alive connection (*reusedP == true), or
+//   - a new non-blocking socket (*connectP == true) that the caller must connect to *addrP, or
+//   - NOTIFICATION_CONNECTION_WAIT if all connection slots of the endpoint are in use, or if the address of
+//     the endpoint is being resolved - the caller simply tries again a little later, or
+//   - NOTIFICATION_CONNECTION_ERROR if the endpoint cannot be resolved
+//
+// A resolved address is used for NOTIFICATION_RESOLVE_TTL seconds. After that it is resolved again, in the background,
+// while the old address is still used.
+//
+// In all cases but WAIT and ERROR, the connection must be given back with notificationConnectionRelease.
+//
+int notificationConnectionTryGet(const char* host, unsigned short port, bool* reusedP, bool* connectP, struct sockaddr_in* addrP)
+{
+  *reusedP  = false;
+  *connectP = false;
+
+  if (notificationConnectionPoolInitialized == false)
+  {
+    LM_E(("Internal Error (the notification connection pool is not initialized)"));
+    return NOTIFICATION_CONNECTION_ERROR;
+  }
+
+  time_t                 now = time(NULL);
+  NotificationEndpoint*  epP;
+  int                    fd;
+
+  sem_wait(&notificationConnectionPoolSem);
+
+  epP = notificationEndpointLookup(host, port);
+
+  if ((notifMaxConns > 0) && (sem_trywait(&epP->slots) == -1))
+  {
+    sem_post(&notificationConnectionPoolSem);
+    return NOTIFICATION_CONNECTION_WAIT;
+  }
+
+  fd = idleConnectionPop(epP, now);
+
+  if (fd != -1)
+  {
+    epP->activeConnections += 1;
+    ++notificationConnectionPoolHits;
+    sem_post(&notificationConnectionPoolSem);
+
+    LM_T(LmtNotifier, ("Reusing keep-alive connection %d to %s:%d", fd, host, port));
+    *reusedP = true;
+    return fd;
+  }
+
+  //
+  // A new connection is needed - for that, the address of the endpoint must be known
+  //
+  endpointResolve(epP, now);
+
+  if (epP->resolved == false)
+  {
+    int rc = (epP->resolving == true)? NOTIFICATION_CONNECTION_WAIT : NOTIFICATION_CONNECTION_ERROR;
+
+    sem_post(&notificationConnectionPoolSem);
+
+    if (notifMaxConns > 0)
+      sem_post(&epP->slots);
+
+    return rc;
+  }
+
+  *addrP = epP->addr;
+
+  fd = socket(AF_INET, SOCK_STREAM | SOCK_NONBLOCK, 0);
+  if (fd == -1)
+  {
+    sem_post(&notificationConnectionPoolSem);
+    LM_E(("Runtime Error (socket: %s)", strerror(errno)));
+
+    if (notifMaxConns > 0)
+      sem_post(&epP->slots);
+
+    return NOTIFICATION_CONNECTION_ERROR;
+  }
+
+  epP->activeConnections += 1;
+  ++notificationConnectionPoolMisses;
+  sem_post(&notificationConnectionPoolSem);
+
+  *connectP = true;
+  return fd;
+}
@@ -0,0 +1,67 @@
+#ifndef SRC_LIB_ORIONLD_NOTIFICATIONS_NOTIFICATIONCONNECTIONGET_H_
+#define SRC_LIB_ORIONLD_NOTIFICATIONS_NOTIFICATIONCONNECTIONGET_H_
+
+/*
+*
+* Copyright 2021 FIWARE Foundation e.V.
+*
+* This file is part of Orion-LD Context Broker.
+*
+* Orion-LD Context Broker is free software: you can redistribute it and/or
+* modify it under the terms of the GNU Affero General Public License as
+* published by the Free Software Foundation, either version 3 of the
+* License, or (at your option) any later version.
+*
+* Orion-LD Context Broker is distributed in the hope that it will be useful,
+* but WITHOUT ANY WARRANTY; without even the implied warranty of
+* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU Affero
+* General Public License for more details.
+*
+* You should have received a copy of the GNU Affero General Public License
+* along with Orion-LD Context Broker. If not, see http://www.gnu.org/licenses/.
+*
+* For those usages not covered by this license please contact with
+* orionld at fiware dot org
+*
+* Author: Ken Zangelin
+*/
+#include <netinet/in.h>                                        // struct sockaddr_in
+
+
+
+// -----------------------------------------------------------------------------
+//
+// Return values of notificationConnectionTryGet, besides a file descriptor
+//
+#define NOTIFICATION_CONNECTION_ERROR  -1
+#define NOTIFICATION_CONNECTION_WAIT   -2
+
+
+
+// -----------------------------------------------------------------------------
+//
+// NOTIFICATION_RESOLVE_TTL - number of seconds a resolved address of a notification endpoint is used
+//
+#define NOTIFICATION_RESOLVE_TTL  60
+
+
+
+// -----------------------------------------------------------------------------
+//
+// notificationConnectionGet - get a connection to host:port, from the pool if possible
+//
+// *reusedP is set to true if the connection was taken from the pool of idle keep-alive connections.
+//
+extern int notificationConnectionGet(const char* host, unsigned short port, bool* reusedP);
+
+
+
+// -----------------------------------------------------------------------------
+//
+// notificationConnectionTryGet - get a connection to host:port without blocking - for the notification sender threads
+//
+// If *connectP is set to true, the returned socket is new and non-blocking, and still needs to be connected to *addrP.
+//
+extern int notificationConnectionTryGet(const char* host, unsigned short port, bool* reusedP, bool* connectP, struct sockaddr_in* addrP);
+
+#endif  // SRC_LIB_ORIONLD_NOTIFICATIONS_NOTIFICATIONCONNECTIONGET_H_
@@ -0,0 +1,71 @@
+/*
+*
+* Copyright 2021 FIWARE Foundation e.V.
+*
+* This file is part of Orion-LD Context Broker.
+*
+* Orion-LD Context Broker is free software: you can redistribute it and/or
+* modify it under the terms of the GNU Affero General Public License as
+* published by the Free Software Foundation, either version 3 of the
+* License, or (at your option) any later version.
+*
+* Orion-LD Context Broker is distributed in the hope that it will be useful,
+* but WITHOUT ANY WARRANTY; without even the implied warranty of
+* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU Affero
+* General Public License for more details.
+*
+* You should have received a copy of the GNU Affero General Public License
+* along with Orion-LD Context Broker. If not, see http://www.gnu.org/licenses/.
+*
+* For those usages not covered by this license please contact with
+* orionld at fiware dot org
+*
+* Author: Ken Zangelin
+*/
+#include <semaphore.h>                                         // sem_t
+
+#include "orionld/notifications/NotificationEndpoint.h"        // NotificationEndpoint
+#include "orionld/notifications/notificationConnectionPool.h"  // Own interface
+
+
+
+// -----------------------------------------------------------------------------
+//
+// Notification Connection Pool Variables
+//
+NotificationEndpoint*  notificationEndpointTable[NOTIFICATION_ENDPOINT_BUCKETS];
+sem_t                  notificationConnectionPoolSem;
+bool                   notificationConnectionPoolInitialized = false;
+
+
+
+// -----------------------------------------------------------------------------
+//
+// Notification Connection Pool Counters
+//
+unsigned long long     notificationConnectionPoolHits        = 0;
+unsigned long long     notificationConnectionPoolMisses      = 0;
+unsigned long long     notificationConnectionPoolEvictions   = 0;
+unsigned long long     notificationConnectionPoolStale       = 0;
+unsigned long long     notificationConnectionPoolRefused     = 0;
+
+
+
+// -----------------------------------------------------------------------------
+//
+// notificationEndpointHash -
+//
+unsigned int notificationEndpointHash(const char* host, unsigned short port)
+{
+  unsigned int hash = 5381;
+
+  while (*host != 0)
+  {
+    hash = ((hash << 5) + hash) + (unsigned char) *host;
+    ++host;
+  }
+
+  hash = ((hash << 5) + hash) + port;
+
+  return hash % NOTIFICATION_ENDPOINT_BUCKETS;
+}
@@ -0,0 +1,70 @@
+#ifndef SRC_LIB_ORIONLD_NOTIFICATIONS_NOTIFICATIONCONNECTIONPOOL_H_
+#define SRC_LIB_ORIONLD_NOTIFICATIONS_NOTIFICATIONCONNECTIONPOOL_H_
+
+/*
+*
+* Copyright 2021 FIWARE Foundation e.V.
+*
+* This file is part of Orion-LD Context Broker.
+*
+* Orion-LD Context Broker is free software: you can redistribute it and/or
+* modify it under the terms of the GNU Affero General Public License as
+* published by the Free Software Foundation, either version 3 of the
+* License, or (at your option) any later version.
+*
+* Orion-LD Context Broker is distributed in the hope that it will be useful,
+* but WITHOUT ANY WARRANTY; without even the implied warranty of
+* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU Affero
+* General Public License for more details.
+*
+* You should have received a copy of the GNU Affero General Public License
+* along with Orion-LD Context Broker. If not, see http://www.gnu.org/licenses/.
+*
+* For those usages not covered by this license please contact with
+* orionld at fiware dot org
+*
+* Author: Ken Zangelin
+*/
+#include <semaphore.h>                                         // sem_t
+
+#include "orionld/notifications/NotificationEndpoint.h"        // NotificationEndpoint
+
+
+
+// -----------------------------------------------------------------------------
+//
+// NOTIFICATION_ENDPOINT_BUCKETS - size of the hash table of notification endpoints
+//
+#define NOTIFICATION_ENDPOINT_BUCKETS  256
+
+
+
+// -----------------------------------------------------------------------------
+//
+// Notification Connection Pool Variables
+//
+extern NotificationEndpoint*  notificationEndpointTable[NOTIFICATION_ENDPOINT_BUCKETS];
+extern sem_t                  notificationConnectionPoolSem;
+extern bool                   notificationConnectionPoolInitialized;
+
+
+
+// -----------------------------------------------------------------------------
+//
+// Notification Connection Pool Counters - protected by notificationConnectionPoolSem
+//
+extern unsigned long long     notificationConnectionPoolHits;
+extern unsigned long long     notificationConnectionPoolMisses;
+extern unsigned long long     notificationConnectionPoolEvictions;
+extern unsigned long long     notificationConnectionPoolStale;
+extern unsigned long long     notificationConnectionPoolRefused;
+
+
+
+// -----------------------------------------------------------------------------
+//
+// notificationEndpointHash -
+//
+extern unsigned int notificationEndpointHash(const char* host, unsigned short port);
+
+#endif  // SRC_LIB_ORIONLD_NOTIFICATIONS_NOTIFICATIONCONNECTIONPOOL_H_
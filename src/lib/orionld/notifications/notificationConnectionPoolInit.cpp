@@ -0,0 +1,48 @@
+/*
+*
+* Copyright 2021 FIWARE Foundation e.V.
+*
+* This file is part of Orion-LD Context Broker.
+*
+* Orion-LD Context Broker is free software: you can redistribute it and/or
+* modify it under the terms of the GNU Affero General Public License as
+* published by the Free Software Foundation, either version 3 of the
+* License, or (at your option) any later version.
+*
+* Orion-LD Context Broker is distributed in the hope that it will be useful,
+* but WITHOUT ANY WARRANTY; without even the implied warranty of
+* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU Affero
+* General Public License for more details.
+*
+* You should have received a copy of the GNU Affero General Public License
+* along with Orion-LD Context Broker. If not, see http://www.gnu.org/licenses/.
+*
+* For those usages not covered by this license please contact with
+* orionld at fiware dot org
+*
+* Author: Ken Zangelin
+*/
+#include <string.h>                                            // bzero
+#include <semaphore.h>                                         // sem_init
+
+#include "logMsg/logMsg.h"                                     // LM_*
+#include "logMsg/traceLevels.h"                                // Lmt*
+
+#include "orionld/notifications/notificationConnectionPool.h"  // notificationEndpointTable, notificationConnectionPoolSem
+#include "orionld/notifications/notificationConnectionPoolInit.h"  // Own interface
+
+
+
+// -----------------------------------------------------------------------------
+//
+// notificationConnectionPoolInit -
+//
+void notificationConnectionPoolInit(void)
+{
+  bzero(notificationEndpointTable, sizeof(notificationEndpointTable));
+
+  if (sem_init(&notificationConnectionPoolSem, 0, 1) == -1)
+    LM_X(1, ("Runtime Error (error initializing semaphore for the notification connection pool: %s)", strerror(errno)));
+
+  notificationConnectionPoolInitialized = true;
+}
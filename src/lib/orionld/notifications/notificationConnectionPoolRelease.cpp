@@ -0,0 +1,69 @@
+/*
+*
+* Copyright 2021 FIWARE Foundation e.V.
+*
+* This file is part of Orion-LD Context Broker.
+*
+* Orion-LD Context Broker is free software: you can redistribute it and/or
+* modify it under the terms of the GNU Affero General Public License as
+* published by the Free Software Foundation, either version 3 of the
+* License, or (at your option) any later version.
+*
+* Orion-LD Context Broker is distributed in the hope that it will be useful,
+* but WITHOUT ANY WARRANTY; without even the implied warranty of
+* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU Affero
+* General Public License for more details.
+*
+* You should have received a copy of the GNU Affero General Public License
+* along with Orion-LD Context Broker. If not, see http://www.gnu.org/licenses/.
+*
+* For those usages not covered by this license please contact with
+* orionld at fiware dot org
+*
+* Author: Ken Zangelin
+*/
+#include <stdlib.h>                                            // free
+#include <unistd.h>                                            // close
+#include <semaphore.h>                                         // sem_destroy
+
+#include "orionld/notifications/NotificationEndpoint.h"        // NotificationEndpoint
+#include "orionld/notifications/notificationConnectionPool.h"  // notificationEndpointTable
+#include "orionld/notifications/notificationConnectionPoolRelease.h"  // Own interface
+
+
+
+// -----------------------------------------------------------------------------
+//
+// notificationConnectionPoolRelease - close all idle connections and free the pool
+//
+// Only called at exit - no semaphore taken
+//
+void notificationConnectionPoolRelease(void)
+{
+  if (notificationConnectionPoolInitialized == false)
+    return;
+
+  for (int bucket = 0; bucket < NOTIFICATION_ENDPOINT_BUCKETS; bucket++)
+  {
+    NotificationEndpoint* epP = notificationEndpointTable[bucket];
+
+    while (epP != NULL)
+    {
+      NotificationEndpoint* next = epP->next;
+
+      for (int ix = 0; ix < epP->idleConnections; ix++)
+        close(epP->idleV[ix].fd);
+
+      sem_destroy(&epP->slots);
+      free(epP->idleV);
+      free(epP->host);
+      free(epP);
+
+      epP = next;
+    }
+
+    notificationEndpointTable[bucket] = NULL;
+  }
+
+  notificationConnectionPoolInitialized = false;
+}
@@ -0,0 +1,105 @@
+/*
+*
+* Copyright 2021 FIWARE Foundation e.V.
+*
+* This file is part of Orion-LD Context Broker.
+*
+* Orion-LD Context Broker is free software: you can redistribute it and/or
+* modify it under the terms of the GNU Affero General Public License as
+* published by the Free Software Foundation, either version 3 of the
+* License, or (at your option) any later version.
+*
+* Orion-LD Context Broker is distributed in the hope that it will be useful,
+* but WITHOUT ANY WARRANTY; without even the implied warranty of
+* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU Affero
+* General Public License for more details.
+*
+* You should have received a copy of the GNU Affero General Public License
+* along with Orion-LD Context Broker. If not, see http://www.gnu.org/licenses/.
+*
+* For those usages not covered by this license please contact with
+* orionld at fiware dot org
+*
+* Author: Ken Zangelin
+*/
+#include <string>                                              // std::string
+#include <semaphore.h>                                         // sem_wait, sem_post
+
+#include "common/JsonHelper.h"                                 // JsonHelper
+
+#include "orionld/notifications/NotificationEndpoint.h"        // NotificationEndpoint
+#include "orionld/notifications/notificationConnectionPool.h"  // notificationEndpointTable, counters
+#include "orionld/notifications/notificationConnectionPoolStats.h"  // Own interface
+
+
+
+// -----------------------------------------------------------------------------
+//
+// notificationConnectionPoolStats - render the pool counters, as a JSON object, for GET /statistics
+//
+std::string notificationConnectionPoolStats(void)
+{
+  JsonHelper          jh;
+  long long           endpoints = 0;
+  long long           idle      = 0;
+  long long           active    = 0;
+  unsigned long long  hits;
+  unsigned long long  misses;
+  unsigned long long  evictions;
+  unsigned long long  stale;
+  unsigned long long  refused;
+
+  if (notificationConnectionPoolInitialized == false)
+    return jh.str();
+
+  sem_wait(&notificationConnectionPoolSem);
+
+  for (int bucket = 0; bucket < NOTIFICATION_ENDPOINT_BUCKETS; bucket++)
+  {
+    for (NotificationEndpoint* epP = notificationEndpointTable[bucket]; epP != NULL; epP = epP->next)
+    {
+      ++endpoints;
+      idle   += epP->idleConnections;
+      active += epP->activeConnections;
+    }
+  }
+
+  hits      = notificationConnectionPoolHits;
+  misses    = notificationConnectionPoolMisses;
+  evictions = notificationConnectionPoolEvictions;
+  stale     = notificationConnectionPoolStale;
+  refused   = notificationConnectionPoolRefused;
+
+  sem_post(&notificationConnectionPoolSem);
+
+  jh.addNumber("endpoints",   endpoints);
+  jh.addNumber("idle",        idle);
+  jh.addNumber("active",      active);
+  jh.addNumber("hits",        (long long) hits);
+  jh.addNumber("misses",      (long long) misses);
+  jh.addNumber("evictions",   (long long) evictions);
+  jh.addNumber("stale",       (long long) stale);
+  jh.addNumber("refused",     (long long) refused);
+
+  return jh.str();
+}
+
+
+
+// -----------------------------------------------------------------------------
+//
+// notificationConnectionPoolStatsReset - reset the pool counters (DELETE /statistics)
+//
+void notificationConnectionPoolStatsReset(void)
+{
+  if (notificationConnectionPoolInitialized == false)
+    return;
+
+  sem_wait(&notificationConnectionPoolSem);
+  notificationConnectionPoolHits      = 0;
+  notificationConnectionPoolMisses    = 0;
+  notificationConnectionPoolEvictions = 0;
+  notificationConnectionPoolStale     = 0;
+  notificationConnectionPoolRefused   = 0;
+  sem_post(&notificationConnectionPoolSem);
+}
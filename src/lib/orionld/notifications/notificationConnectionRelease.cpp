@@ -0,0 +1,96 @@
+/*
+*
+* Copyright 2021 FIWARE Foundation e.V.
+*
+* This file is part of Orion-LD Context Broker.
+*
+* Orion-LD Context Broker is free software: you can redistribute it and/or
+* modify it under the terms of the GNU Affero General Public License as
+* published by the Free Software Foundation, either version 3 of the
+* License, or (at your option) any later version.
+*
+* Orion-LD Context Broker is distributed in the hope that it will be useful,
+* but WITHOUT ANY WARRANTY; without even the implied warranty of
+* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU Affero
+* General Public License for more details.
+*
+* You should have received a copy of the GNU Affero General Public License
+* along with Orion-LD Context Broker. If not, see http://www.gnu.org/licenses/.
+*
+* For those usages not covered by this license please contact with
+* orionld at fiware dot org
+*
+* Author: Ken Zangelin
+*/
+#include <string.h>                                            // strcmp
+#include <unistd.h>                                            // close
+#include <time.h>                                              // time
+#include <semaphore.h>                                         // sem_wait, sem_post
+
+#include "logMsg/logMsg.h"                                     // LM_*
+#include "logMsg/traceLevels.h"                                // Lmt*
+
+#include "orionld/common/orionldState.h"                       // notifPoolSize, notifMaxConns
+#include "orionld/notifications/NotificationEndpoint.h"        // NotificationEndpoint
+#include "orionld/notifications/notificationConnectionPool.h"  // notificationEndpointTable, ...
+#include "orionld/notifications/notificationConnectionRelease.h"  // Own interface
+
+
+
+// -----------------------------------------------------------------------------
+//
+// notificationConnectionRelease - give back a connection obtained by notificationConnectionGet or notificationConnectionTryGet
+//
+// The number of idle connections per endpoint is limited to 'notifPoolSize'.
+// Connections beyond that limit are simply closed.
+// The connection slot of the endpoint (see notifMaxConns) is given back in both cases.
+//
+void notificationConnectionRelease(const char* host, unsigned short port, int fd, bool reusable)
+{
+  if (fd == -1)
+    return;
+
+  if (notificationConnectionPoolInitialized == false)
+  {
+    close(fd);
+    return;
+  }
+
+  unsigned int           bucket = notificationEndpointHash(host, port);
+  NotificationEndpoint*  epP;
+
+  sem_wait(&notificationConnectionPoolSem);
+
+  for (epP = notificationEndpointTable[bucket]; epP != NULL; epP = epP->next)
+  {
+    if ((epP->port == port) && (strcmp(epP->host, host) == 0))
+      break;
+  }
+
+  if (epP == NULL)
+  {
+    // Can't happen - the endpoint is created in notificationConnectionGet/TryGet and never removed while serving
+    sem_post(&notificationConnectionPoolSem);
+    LM_E(("Internal Error (notification endpoint %s:%d not found in connection pool)", host, port));
+    close(fd);
+    return;
+  }
+
+  epP->activeConnections -= 1;
+
+  if ((reusable == true) && (epP->idleConnections < notifPoolSize))
+  {
+    epP->idleV[epP->idleConnections].fd       = fd;
+    epP->idleV[epP->idleConnections].lastUsed = time(NULL);
+    epP->idleConnections += 1;
+    fd = -1;
+  }
+
+  sem_post(&notificationConnectionPoolSem);
+
+  if (notifMaxConns > 0)
+    sem_post(&epP->slots);
+
+  if (fd != -1)
+    close(fd);
+}
@@ -0,0 +1,87 @@
+/*
+*
+* Copyright 2021 FIWARE Foundation e.V.
+*
+* This file is part of Orion-LD Context Broker.
+*
+* Orion-LD Context Broker is free software: you can redistribute it and/or
+* modify it under the terms of the GNU Affero General Public License as
+* published by the Free Software Foundation, either version 3 of the
+* License, or (at your option) any later version.
+*
+* Orion-LD Context Broker is distributed in the hope that it will be useful,
+* but WITHOUT ANY WARRANTY; without even the implied warranty of
+* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU Affero
+* General Public License for more details.
+*
+* You should have received a copy of the GNU Affero General Public License
+* along with Orion-LD Context Broker. If not, see http://www.gnu.org/licenses/.
+*
+* For those usages not covered by this license please contact with
+* orionld at fiware dot org
+*
+* Author: Ken Zangelin
+*/
+#include <string.h>                                            // strlen, memcpy
+#include <stdlib.h>                                            // malloc
+
+#include "logMsg/logMsg.h"                                     // LM_*
+#include "logMsg/traceLevels.h"                                // Lmt*
+
+#include "orionld/notifications/NotificationItem.h"            // NotificationItem
+#include "orionld/notifications/notificationQueue.h"           // notificationQueuePush
+#include "orionld/notifications/notificationEnqueue.h"         // Own interface
+
+
+
+// -----------------------------------------------------------------------------
+//
+// notificationEnqueue - copy a rendered notification into a NotificationItem and push it onto the notification queue
+//
+// The item, the host, the tenant, the subscription id and the request (HTTP headers + payload) are all allocated in one single buffer:
+//
+//   | NotificationItem | host\0 | tenant\0 | subscriptionId\0 | request |
+//
+bool notificationEnqueue(const char* host, uint16_t port, const char* tenant, const char* subscriptionId, struct iovec* ioVec, int ioVecLen)
+{
+  if (tenant == NULL)
+    tenant = "";
+
+  int   hostLen           = strlen(host) + 1;
+  int   tenantLen         = strlen(tenant) + 1;
+  int   subscriptionIdLen = strlen(subscriptionId) + 1;
+  int   requestLen        = 0;
+
+  for (int ix = 0; ix < ioVecLen; ix++)
+    requestLen += ioVec[ix].iov_len;
+
+  char* buf = (char*) malloc(sizeof(NotificationItem) + hostLen + tenantLen + subscriptionIdLen + requestLen);
+
+  if (buf == NULL)
+  {
+    LM_E(("Out of memory allocating a notification of %d bytes", requestLen));
+    return false;
+  }
+
+  NotificationItem* itemP = (NotificationItem*) buf;
+
+  itemP->host           = &buf[sizeof(NotificationItem)];
+  itemP->tenant         = &itemP->host[hostLen];
+  itemP->subscriptionId = &itemP->tenant[tenantLen];
+  itemP->request        = &itemP->subscriptionId[subscriptionIdLen];
+  itemP->requestLen     = requestLen;
+  itemP->port           = port;
+
+  memcpy(itemP->host,           host,           hostLen);
+  memcpy(itemP->tenant,         tenant,         tenantLen);
+  memcpy(itemP->subscriptionId, subscriptionId, subscriptionIdLen);
+
+  char* reqP = itemP->request;
+  for (int ix = 0; ix < ioVecLen; ix++)
+  {
+    memcpy(reqP, ioVec[ix].iov_base, ioVec[ix].iov_len);
+    reqP += ioVec[ix].iov_len;
+  }
+
+  return notificationQueuePush(itemP);
+}
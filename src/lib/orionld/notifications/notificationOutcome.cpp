@@ -0,0 +1,173 @@
+/*
+*
+* Copyright 2021 FIWARE Foundation e.V.
+*
+* This file is part of Orion-LD Context Broker.
+*
+* Orion-LD Context Broker is free software: you can redistribute it and/or
+* modify it under the terms of the GNU Affero General Public License as
+* published by the Free Software Foundation, either version 3 of the
+* License, or (at your option) any later version.
+*
+* Orion-LD Context Broker is distributed in the hope that it will be useful,
+* but WITHOUT ANY WARRANTY; without even the implied warranty of
+* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU Affero
+* General Public License for more details.
+*
+* You should have received a copy of the GNU Affero General Public License
+* along with Orion-LD Context Broker. If not, see http://www.gnu.org/licenses/.
+*
+* For those usages not covered by this license please contact with
+* orionld at fiware dot org
+*
+* Author: Ken Zangelin
+*/
+#include <string.h>                                            // strerror
+#include <pthread.h>                                           // pthread_create, pthread_mutex_*, pthread_cond_*
+#include <string>                                              // std::string
+#include <map>                                                 // std::map
+#include <utility>                                             // std::pair
+
+extern "C"
+{
+#include "kbase/kTime.h"                                       // kTimeGet
+}
+
+#include "logMsg/logMsg.h"                                     // LM_*
+#include "logMsg/traceLevels.h"                                // Lmt*
+
+#include "cache/subCache.h"                                    // subCacheItemNotificationErrorStatus
+
+#include "orionld/common/orionldState.h"                       // orionldState
+#include "orionld/notifications/notificationOutcome.h"         // Own interface
+
+
+
+// -----------------------------------------------------------------------------
+//
+// Outcome - the latest success and failure of the notifications of a subscription, not yet recorded (0: none)
+//
+typedef struct Outcome
+{
+  double  lastSuccess;
+  double  lastFailure;
+} Outcome;
+
+
+
+// -----------------------------------------------------------------------------
+//
+// OutcomeMap - tenant + subscription id => outcome
+//
+// Only the latest success/failure of a subscription is kept, so the map never has more items than there are
+// subscriptions with notifications, however slow the recording is.
+//
+typedef std::map<std::pair<std::string, std::string>, Outcome> OutcomeMap;
+
+
+
+// -----------------------------------------------------------------------------
+//
+// Module state - 'pending' is protected by 'outcomeMutex'
+//
+static pthread_mutex_t  outcomeMutex = PTHREAD_MUTEX_INITIALIZER;
+static pthread_cond_t   outcomeCond  = PTHREAD_COND_INITIALIZER;
+static OutcomeMap       pending;
+
+
+
+// -----------------------------------------------------------------------------
+//
+// outcomeRecord - record one outcome, as the request thread does for the notifications it sends itself
+//
+// subCacheItemNotificationErrorStatus takes the timestamp from orionldState - the thread-local state of this thread.
+//
+static void outcomeRecord(const std::string& tenant, const std::string& subscriptionId, double timestamp, int errors)
+{
+  orionldState.requestTime = timestamp;
+  subCacheItemNotificationErrorStatus(tenant, subscriptionId, errors);
+}
+
+
+
+// -----------------------------------------------------------------------------
+//
+// notificationOutcomeThread -
+//
+// The pending outcomes are taken as a whole, and recorded outside the mutex - the pushing threads never wait
+// for the subscription cache semaphore nor for the database.
+//
+static void* notificationOutcomeThread(void* vP)
+{
+  OutcomeMap outcomes;
+
+  while (1)
+  {
+    pthread_mutex_lock(&outcomeMutex);
+
+    while (pending.empty())
+      pthread_cond_wait(&outcomeCond, &outcomeMutex);
+
+    outcomes.swap(pending);
+    pthread_mutex_unlock(&outcomeMutex);
+
+    for (OutcomeMap::iterator it = outcomes.begin(); it != outcomes.end(); ++it)
+    {
+      if (it->second.lastSuccess > 0)
+        outcomeRecord(it->first.first, it->first.second, it->second.lastSuccess, 0);
+
+      if (it->second.lastFailure > 0)
+        outcomeRecord(it->first.first, it->first.second, it->second.lastFailure, 1);
+    }
+
+    outcomes.clear();
+  }
+
+  return NULL;
+}
+
+
+
+// -----------------------------------------------------------------------------
+//
+// notificationOutcomeInit -
+//
+void notificationOutcomeInit(void)
+{
+  pthread_t  tid;
+  int        ret = pthread_create(&tid, NULL, notificationOutcomeThread, NULL);
+
+  if (ret != 0)
+    LM_X(1, ("Runtime Error (error creating the thread for the outcome of notifications: %s)", strerror(ret)));
+
+  pthread_detach(tid);
+}
+
+
+
+// -----------------------------------------------------------------------------
+//
+// notificationOutcomePush -
+//
+void notificationOutcomePush(const char* tenant, const char* subscriptionId, bool ok)
+{
+  struct timespec  now;
+  double           timestamp;
+
+  kTimeGet(&now);
+  timestamp = now.tv_sec + ((double) now.tv_nsec) / 1000000000;
+
+  std::pair<std::string, std::string> key((tenant != NULL)? tenant : "", subscriptionId);
+
+  pthread_mutex_lock(&outcomeMutex);
+
+  Outcome* outcomeP = &pending[key];  // Zeroed if new
+
+  if (ok)
+    outcomeP->lastSuccess = timestamp;
+  else
+    outcomeP->lastFailure = timestamp;
+
+  pthread_cond_signal(&outcomeCond);
+  pthread_mutex_unlock(&outcomeMutex);
+}
@@ -0,0 +1,367 @@
+/*
+*
+* Copyright 2021 FIWARE Foundation e.V.
+*
+* This file is part of Orion-LD Context Broker.
+*
+* Orion-LD Context Broker is free software: you can redistribute it and/or
+* modify it under the terms of the GNU Affero General Public License as
+* published by the Free Software Foundation, either version 3 of the
+* License, or (at your option) any later version.
+*
+* Orion-LD Context Broker is distributed in the hope that it will be useful,
+* but WITHOUT ANY WARRANTY; without even the implied warranty of
+* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU Affero
+* General Public License for more details.
+*
+* You should have received a copy of the GNU Affero General Public License
+* along with Orion-LD Context Broker. If not, see http://www.gnu.org/licenses/.
+*
+* For those usages not covered by this license please contact with
+* orionld at fiware dot org
+*
+* Author: Ken Zangelin
+*/
+#include <string.h>                                            // strcmp
+#include <stdlib.h>                                            // calloc, free
+#include <errno.h>                                             // errno
+#include <time.h>                                              // clock_gettime
+#include <semaphore.h>                                         // sem_t, sem_post, sem_trywait, sem_timedwait
+#include <pthread.h>                                           // pthread_mutex_*, pthread_cond_*
+
+#include "logMsg/logMsg.h"                                     // LM_*
+#include "logMsg/traceLevels.h"                                // Lmt*
+
+#include "orionld/notifications/NotificationItem.h"            // NotificationItem
+#include "orionld/notifications/notificationQueue.h"           // Own interface
+
+
+
+// -----------------------------------------------------------------------------
+//
+// NotificationQueueCell -
+//
+// A bounded multi-producer/multi-consumer ring buffer, with a sequence number per cell.
+// Producers and consumers claim a position with a compare-and-swap on enqueuePos/dequeuePos,
+// and the sequence number of the cell tells whether the cell is free, full, or being worked on.
+// No locks are taken - the semaphore is used only to put idle sender threads to sleep, and the
+// condition variable (policy 'block' only) to put request threads to sleep while the ring is full.
+//
+typedef struct NotificationQueueCell
+{
+  unsigned long      sequence;
+  NotificationItem*  itemP;
+} NotificationQueueCell;
+
+
+
+// -----------------------------------------------------------------------------
+//
+// Notification Queue Variables
+//
+static NotificationQueueCell*   cellV        = NULL;
+static unsigned long            cellMask     = 0;
+static unsigned long            enqueuePos   = 0;
+static unsigned long            dequeuePos   = 0;
+static sem_t                    itemsSem;
+static NotificationQueuePolicy  queuePolicy  = NqpDropNew;
+static pthread_mutex_t          roomMutex    = PTHREAD_MUTEX_INITIALIZER;
+static pthread_cond_t           roomCond     = PTHREAD_COND_INITIALIZER;
+static int                      roomWaiters  = 0;
+
+
+
+// -----------------------------------------------------------------------------
+//
+// Notification Queue Counters
+//
+unsigned long long  notificationQueueIn          = 0;
+unsigned long long  notificationQueueOut         = 0;
+unsigned long long  notificationQueueDropped     = 0;
+unsigned long long  notificationQueueSentOk      = 0;
+unsigned long long  notificationQueueSentError   = 0;
+bool                notificationQueueInitialized = false;
+
+
+
+// -----------------------------------------------------------------------------
+//
+// notificationQueuePolicyParse -
+//
+bool notificationQueuePolicyParse(const char* policyString, NotificationQueuePolicy* policyP)
+{
+  if      (strcmp(policyString, "dropNew") == 0)  *policyP = NqpDropNew;
+  else if (strcmp(policyString, "dropOld") == 0)  *policyP = NqpDropOld;
+  else if (strcmp(policyString, "block")   == 0)  *policyP = NqpBlock;
+  else
+    return false;
+
+  return true;
+}
+
+
+
+// -----------------------------------------------------------------------------
+//
+// notificationQueueInit - create the queue, with room for (at least) 'size' notifications
+//
+// The size is rounded up to a power of two, so that a mask can be used instead of a modulo.
+//
+void notificationQueueInit(int size, NotificationQueuePolicy policy)
+{
+  unsigned long cells = 2;
+
+  while (cells < (unsigned long) size)
+    cells <<= 1;
+
+  cellV = (NotificationQueueCell*) calloc(cells, sizeof(NotificationQueueCell));
+  if (cellV == NULL)
+    LM_X(1, ("Out of memory allocating the notification queue (%lu cells)", cells));
+
+  for (unsigned long ix = 0; ix < cells; ix++)
+    cellV[ix].sequence = ix;
+
+  cellMask    = cells - 1;
+  queuePolicy = policy;
+
+  if (sem_init(&itemsSem, 0, 0) == -1)
+    LM_X(1, ("Runtime Error (error initializing semaphore for the notification queue: %s)", strerror(errno)));
+
+  notificationQueueInitialized = true;
+}
+
+
+
+// -----------------------------------------------------------------------------
+//
+// enqueue - lock-free insertion in the ring - false if the ring is full
+//
+static bool enqueue(NotificationItem* itemP)
+{
+  unsigned long pos = __atomic_load_n(&enqueuePos, __ATOMIC_RELAXED);
+
+  while (1)
+  {
+    NotificationQueueCell*  cellP = &cellV[pos & cellMask];
+    unsigned long           seq   = __atomic_load_n(&cellP->sequence, __ATOMIC_ACQUIRE);
+    long                    diff  = (long) seq - (long) pos;
+
+    if (diff == 0)
+    {
+      if (__atomic_compare_exchange_n(&enqueuePos, &pos, pos + 1, true, __ATOMIC_RELAXED, __ATOMIC_RELAXED))
+      {
+        cellP->itemP = itemP;
+        __atomic_store_n(&cellP->sequence, pos + 1, __ATOMIC_RELEASE);
+        return true;
+      }
+      // pos was updated by the failed compare-exchange - try again
+    }
+    else if (diff < 0)
+      return false;  // Full
+    else
+      pos = __atomic_load_n(&enqueuePos, __ATOMIC_RELAXED);
+  }
+}
+
+
+
+// -----------------------------------------------------------------------------
+//
+// dequeue - lock-free extraction from the ring - NULL if the ring is empty
+//
+static NotificationItem* dequeue(void)
+{
+  unsigned long pos = __atomic_load_n(&dequeuePos, __ATOMIC_RELAXED);
+
+  while (1)
+  {
+    NotificationQueueCell*  cellP = &cellV[pos & cellMask];
+    unsigned long           seq   = __atomic_load_n(&cellP->sequence, __ATOMIC_ACQUIRE);
+    long                    diff  = (long) seq - (long) (pos + 1);
+
+    if (diff == 0)
+    {
+      if (__atomic_compare_exchange_n(&dequeuePos, &pos, pos + 1, true, __ATOMIC_RELAXED, __ATOMIC_RELAXED))
+      {
+        NotificationItem* itemP = cellP->itemP;
+
+        __atomic_store_n(&cellP->sequence, pos + cellMask + 1, __ATOMIC_RELEASE);
+        return itemP;
+      }
+    }
+    else if (diff < 0)
+      return NULL;  // Empty
+    else
+      pos = __atomic_load_n(&dequeuePos, __ATOMIC_RELAXED);
+  }
+}
+
+
+
+// -----------------------------------------------------------------------------
+//
+// deadlineGet - absolute CLOCK_REALTIME time 'ms' milliseconds from now
+//
+static void deadlineGet(int ms, struct timespec* deadlineP)
+{
+  clock_gettime(CLOCK_REALTIME, deadlineP);
+
+  deadlineP->tv_sec  += ms / 1000;
+  deadlineP->tv_nsec += (ms % 1000) * 1000000;
+
+  if (deadlineP->tv_nsec >= 1000000000)
+  {
+    deadlineP->tv_sec  += 1;
+    deadlineP->tv_nsec -= 1000000000;
+  }
+}
+
+
+
+// -----------------------------------------------------------------------------
+//
+// enqueueWait - policy 'block': wait (at most NOTIFICATION_QUEUE_BLOCK_TIMEOUT ms) for a sender to make room
+//
+// The waiter registers itself in roomWaiters before its last attempt, and notificationQueuePop checks
+// roomWaiters after freeing a cell, so a slot freed in between is either seen by that attempt or signalled.
+//
+static bool enqueueWait(NotificationItem* itemP)
+{
+  struct timespec  deadline;
+  bool             enqueued;
+
+  deadlineGet(NOTIFICATION_QUEUE_BLOCK_TIMEOUT, &deadline);
+
+  pthread_mutex_lock(&roomMutex);
+  __atomic_add_fetch(&roomWaiters, 1, __ATOMIC_SEQ_CST);
+  __atomic_thread_fence(__ATOMIC_SEQ_CST);
+
+  while ((enqueued = enqueue(itemP)) == false)
+  {
+    if (pthread_cond_timedwait(&roomCond, &roomMutex, &deadline) == ETIMEDOUT)
+    {
+      enqueued = enqueue(itemP);
+      break;
+    }
+  }
+
+  __atomic_sub_fetch(&roomWaiters, 1, __ATOMIC_SEQ_CST);
+  pthread_mutex_unlock(&roomMutex);
+
+  return enqueued;
+}
+
+
+
+// -----------------------------------------------------------------------------
+//
+// notificationQueuePush - add a notification to the queue, applying the policy if the queue is full
+//
+bool notificationQueuePush(NotificationItem* itemP)
+{
+  clock_gettime(CLOCK_REALTIME, &itemP->enqueueTime);
+
+  while (enqueue(itemP) == false)
+  {
+    if (queuePolicy == NqpDropNew)
+    {
+      LM_W(("Notification queue full - dropping notification for subscription '%s'", itemP->subscriptionId));
+      __atomic_add_fetch(&notificationQueueDropped, 1, __ATOMIC_RELAXED);
+      free(itemP);
+      return false;
+    }
+    else if (queuePolicy == NqpDropOld)
+    {
+      //
+      // Make room by removing the oldest notification.
+      // The semaphore must be decremented first, to keep it in sync with the number of items in the ring.
+      //
+      if (sem_trywait(&itemsSem) == 0)
+      {
+        NotificationItem* oldP;
+
+        while ((oldP = dequeue()) == NULL)
+          ;  // The item has been counted, so it is there - the producer just hasn't finished the insertion
+
+        LM_W(("Notification queue full - dropping notification for subscription '%s'", oldP->subscriptionId));
+        __atomic_add_fetch(&notificationQueueDropped, 1, __ATOMIC_RELAXED);
+        free(oldP);
+      }
+    }
+    else  // NqpBlock - back-pressure: wait for the senders to make room, but not forever
+    {
+      if (enqueueWait(itemP) == true)
+        break;
+
+      LM_W(("Notification queue full for %d ms - dropping notification for subscription '%s'",
+            NOTIFICATION_QUEUE_BLOCK_TIMEOUT, itemP->subscriptionId));
+      __atomic_add_fetch(&notificationQueueDropped, 1, __ATOMIC_RELAXED);
+      free(itemP);
+      return false;
+    }
+  }
+
+  __atomic_add_fetch(&notificationQueueIn, 1, __ATOMIC_RELAXED);
+  sem_post(&itemsSem);
+
+  return true;
+}
+
+
+
+// -----------------------------------------------------------------------------
+//
+// notificationQueuePop - get the oldest notification from the queue
+//
+NotificationItem* notificationQueuePop(int waitMs)
+{
+  if (waitMs == 0)
+  {
+    if (sem_trywait(&itemsSem) != 0)
+      return NULL;
+  }
+  else
+  {
+    struct timespec timeout;
+
+    deadlineGet(waitMs, &timeout);
+
+    if (sem_timedwait(&itemsSem, &timeout) != 0)
+      return NULL;
+  }
+
+  NotificationItem* itemP;
+
+  while ((itemP = dequeue()) == NULL)
+    ;  // The item has been counted, so it is there - the producer just hasn't finished the insertion
+
+  __atomic_add_fetch(&notificationQueueOut, 1, __ATOMIC_RELAXED);
+
+  //
+  // A cell has been freed - wake up a request thread waiting for room (policy 'block')
+  //
+  __atomic_thread_fence(__ATOMIC_SEQ_CST);
+  if (__atomic_load_n(&roomWaiters, __ATOMIC_RELAXED) > 0)
+  {
+    pthread_mutex_lock(&roomMutex);
+    pthread_cond_signal(&roomCond);
+    pthread_mutex_unlock(&roomMutex);
+  }
+
+  return itemP;
+}
+
+
+
+// -----------------------------------------------------------------------------
+//
+// notificationQueueSize - approximate number of notifications in the queue
+//
+int notificationQueueSize(void)
+{
+  int items = 0;
+
+  sem_getvalue(&itemsSem, &items);
+
+  return items;
+}
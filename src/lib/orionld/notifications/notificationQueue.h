@@ -0,0 +1,109 @@
+#ifndef SRC_LIB_ORIONLD_NOTIFICATIONS_NOTIFICATIONQUEUE_H_
+#define SRC_LIB_ORIONLD_NOTIFICATIONS_NOTIFICATIONQUEUE_H_
+
+/*
+*
+* Copyright 2021 FIWARE Foundation e.V.
+*
+* This file is part of Orion-LD Context Broker.
+*
+* Orion-LD Context Broker is free software: you can redistribute it and/or
+* modify it under the terms of the GNU Affero General Public License as
+* published by the Free Software Foundation, either version 3 of the
+* License, or (at your option) any later version.
+*
+* Orion-LD Context Broker is distributed in the hope that it will be useful,
+* but WITHOUT ANY WARRANTY; without even the implied warranty of
+* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU Affero
+* General Public License for more details.
+*
+* You should have received a copy of the GNU Affero General Public License
+* along with Orion-LD Context Broker. If not, see http://www.gnu.org/licenses/.
+*
+* For those usages not covered by this license please contact with
+* orionld at fiware dot org
+*
+* Author: Ken Zangelin
+*/
+#include "orionld/notifications/NotificationItem.h"            // NotificationItem
+
+
+
+// -----------------------------------------------------------------------------
+//
+// NotificationQueuePolicy - what to do when the notification queue is full
+//
+typedef enum NotificationQueuePolicy
+{
+  NqpDropNew,    // The new notification is discarded
+  NqpDropOld,    // The oldest notification in the queue is discarded to make room for the new one
+  NqpBlock       // The request thread waits until there is room in the queue (back-pressure), then drops as NqpDropNew
+} NotificationQueuePolicy;
+
+
+
+// -----------------------------------------------------------------------------
+//
+// NOTIFICATION_QUEUE_BLOCK_TIMEOUT - max milliseconds a request thread waits for room in the queue (policy 'block')
+//
+#define NOTIFICATION_QUEUE_BLOCK_TIMEOUT  1000
+
+
+
+// -----------------------------------------------------------------------------
+//
+// Notification Queue Counters
+//
+extern unsigned long long  notificationQueueIn;
+extern unsigned long long  notificationQueueOut;
+extern unsigned long long  notificationQueueDropped;
+extern unsigned long long  notificationQueueSentOk;
+extern unsigned long long  notificationQueueSentError;
+extern bool                notificationQueueInitialized;
+
+
+
+// -----------------------------------------------------------------------------
+//
+// notificationQueuePolicyParse -
+//
+extern bool notificationQueuePolicyParse(const char* policyString, NotificationQueuePolicy* policyP);
+
+
+
+// -----------------------------------------------------------------------------
+//
+// notificationQueueInit - create the queue, with room for (at least) 'size' notifications
+//
+extern void notificationQueueInit(int size, NotificationQueuePolicy policy);
+
+
+
+// -----------------------------------------------------------------------------
+//
+// notificationQueuePush - add a notification to the queue, applying the policy if the queue is full
+//
+// Returns false if the notification was dropped (and freed)
+//
+extern bool notificationQueuePush(NotificationItem* itemP);
+
+
+
+// -----------------------------------------------------------------------------
+//
+// notificationQueuePop - get the oldest notification from the queue
+//
+// If 'waitMs' is zero, the function returns NULL immediately if the queue is empty.
+// Otherwise it waits for at most 'waitMs' milliseconds for a notification to arrive.
+//
+extern NotificationItem* notificationQueuePop(int waitMs);
+
+
+
+// -----------------------------------------------------------------------------
+//
+// notificationQueueSize - approximate number of notifications in the queue
+//
+extern int notificationQueueSize(void);
+
+#endif  // SRC_LIB_ORIONLD_NOTIFICATIONS_NOTIFICATIONQUEUE_H_
@@ -0,0 +1,68 @@
+/*
+*
+* Copyright 2021 FIWARE Foundation e.V.
+*
+* This file is part of Orion-LD Context Broker.
+*
+* Orion-LD Context Broker is free software: you can redistribute it and/or
+* modify it under the terms of the GNU Affero General Public License as
+* published by the Free Software Foundation, either version 3 of the
+* License, or (at your option) any later version.
+*
+* Orion-LD Context Broker is distributed in the hope that it will be useful,
+* but WITHOUT ANY WARRANTY; without even the implied warranty of
+* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU Affero
+* General Public License for more details.
+*
+* You should have received a copy of the GNU Affero General Public License
+* along with Orion-LD Context Broker. If not, see http://www.gnu.org/licenses/.
+*
+* For those usages not covered by this license please contact with
+* orionld at fiware dot org
+*
+* Author: Ken Zangelin
+*/
+#include <string>                                              // std::string
+
+#include "common/JsonHelper.h"                                 // JsonHelper
+
+#include "orionld/notifications/notificationQueue.h"           // notificationQueue counters, notificationQueueSize
+#include "orionld/notifications/notificationQueueStats.h"      // Own interface
+
+
+
+// -----------------------------------------------------------------------------
+//
+// notificationQueueStats - render the counters of the NGSI-LD notification queue, as a JSON object, for GET /statistics
+//
+std::string notificationQueueStats(void)
+{
+  JsonHelper jh;
+
+  if (notificationQueueInitialized == false)
+    return jh.str();
+
+  jh.addNumber("in",        (long long) __atomic_load_n(&notificationQueueIn,        __ATOMIC_RELAXED));
+  jh.addNumber("out",       (long long) __atomic_load_n(&notificationQueueOut,       __ATOMIC_RELAXED));
+  jh.addNumber("dropped",   (long long) __atomic_load_n(&notificationQueueDropped,   __ATOMIC_RELAXED));
+  jh.addNumber("sentOk",    (long long) __atomic_load_n(&notificationQueueSentOk,    __ATOMIC_RELAXED));
+  jh.addNumber("sentError", (long long) __atomic_load_n(&notificationQueueSentError, __ATOMIC_RELAXED));
+  jh.addNumber("size",      (long long) notificationQueueSize());
+
+  return jh.str();
+}
+
+
+
+// -----------------------------------------------------------------------------
+//
+// notificationQueueStatsReset - reset the counters of the NGSI-LD notification queue (DELETE /statistics)
+//
+void notificationQueueStatsReset(void)
+{
+  __atomic_store_n(&notificationQueueIn,        0, __ATOMIC_RELAXED);
+  __atomic_store_n(&notificationQueueOut,       0, __ATOMIC_RELAXED);
+  __atomic_store_n(&notificationQueueDropped,   0, __ATOMIC_RELAXED);
+  __atomic_store_n(&notificationQueueSentOk,    0, __ATOMIC_RELAXED);
+  __atomic_store_n(&notificationQueueSentError, 0, __ATOMIC_RELAXED);
+}
@@ -0,0 +1,106 @@
+/*
+*
+* Copyright 2021 FIWARE Foundation e.V.
+*
+* This file is part of Orion-LD Context Broker.
+*
+* Orion-LD Context Broker is free software: you can redistribute it and/or
+* modify it under the terms of the GNU Affero General Public License as
+* published by the Free Software Foundation, either version 3 of the
+* License, or (at your option) any later version.
+*
+* Orion-LD Context Broker is distributed in the hope that it will be useful,
+* but WITHOUT ANY WARRANTY; without even the implied warranty of
+* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU Affero
+* General Public License for more details.
+*
+* You should have received a copy of the GNU Affero General Public License
+* along with Orion-LD Context Broker. If not, see http://www.gnu.org/licenses/.
+*
+* For those usages not covered by this license please contact with
+* orionld at fiware dot org
+*
+* Author: Ken Zangelin
+*/
+#include <string.h>                                            // strstr, strncmp
+#include <strings.h>                                           // strncasecmp
+#include <stdlib.h>                                            // atoi
+
+#include "orionld/notifications/notificationResponseHeadersParse.h"  // Own interface
+
+
+
+// -----------------------------------------------------------------------------
+//
+// httpHeaderValue - get the value of an HTTP header, inside a buffer of HTTP headers
+//
+// Only the headers in [buf, end) are searched.
+//
+static char* httpHeaderValue(char* buf, char* end, const char* name)
+{
+  int   nameLen = strlen(name);
+  char* lineP   = strstr(buf, "\r\n");
+
+  while ((lineP != NULL) && (lineP < end))
+  {
+    lineP += 2;
+
+    if ((strncasecmp(lineP, name, nameLen) == 0) && (lineP[nameLen] == ':'))
+    {
+      char* valueP = &lineP[nameLen + 1];
+
+      while ((*valueP == ' ') || (*valueP == '\t'))
+        ++valueP;
+
+      return valueP;
+    }
+
+    lineP = strstr(lineP, "\r\n");
+  }
+
+  return NULL;
+}
+
+
+
+// -----------------------------------------------------------------------------
+//
+// notificationResponseHeadersParse - parse the HTTP headers of the response to a notification
+//
+// The buffer must be zero-terminated.
+//
+int notificationResponseHeadersParse(char* buf, int len, int* statusCodeP, int* contentLengthP, bool* keepAliveP)
+{
+  char* endOfHeaders = strstr(buf, "\r\n\r\n");
+
+  if (endOfHeaders == NULL)
+    return (strncmp(buf, "HTTP/1.", (len < 7)? len : 7) == 0)? 0 : -1;
+
+  if (strncmp(buf, "HTTP/1.", 7) != 0)
+    return -1;
+
+  char* connectionHeader    = httpHeaderValue(buf, endOfHeaders, "Connection");
+  char* contentLengthHeader = httpHeaderValue(buf, endOfHeaders, "Content-Length");
+
+  *statusCodeP    = atoi(&buf[9]);
+  *contentLengthP = 0;
+
+  //
+  // HTTP/1.1 connections are persistent unless the response says "Connection: close".
+  // HTTP/1.0 connections are closed after the response unless it says "Connection: keep-alive".
+  //
+  if (buf[7] == '0')
+    *keepAliveP = ((connectionHeader != NULL) && (strncasecmp(connectionHeader, "keep-alive", 10) == 0));
+  else
+    *keepAliveP = ((connectionHeader == NULL) || (strncasecmp(connectionHeader, "close", 5) != 0));
+
+  if (contentLengthHeader != NULL)
+    *contentLengthP = atoi(contentLengthHeader);
+  else if ((*statusCodeP != 204) && (*statusCodeP != 304))
+  {
+    *contentLengthP = -1;
+    *keepAliveP     = false;
+  }
+
+  return (endOfHeaders - buf) + 4;
+}
@@ -0,0 +1,45 @@
+#ifndef SRC_LIB_ORIONLD_NOTIFICATIONS_NOTIFICATIONRESPONSEHEADERSPARSE_H_
+#define SRC_LIB_ORIONLD_NOTIFICATIONS_NOTIFICATIONRESPONSEHEADERSPARSE_H_
+
+/*
+*
+* Copyright 2021 FIWARE Foundation e.V.
+*
+* This file is part of Orion-LD Context Broker.
+*
+* Orion-LD Context Broker is free software: you can redistribute it and/or
+* modify it under the terms of the GNU Affero General Public License as
+* published by the Free Software Foundation, either version 3 of the
+* License, or (at your option) any later version.
+*
+* Orion-LD Context Broker is distributed in the hope that it will be useful,
+* but WITHOUT ANY WARRANTY; without even the implied warranty of
+* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU Affero
+* General Public License for more details.
+*
+* You should have received a copy of the GNU Affero General Public License
+* along with Orion-LD Context Broker. If not, see http://www.gnu.org/licenses/.
+*
+* For those usages not covered by this license please contact with
+* orionld at fiware dot org
+*
+* Author: Ken Zangelin
+*/
+
+
+
+// -----------------------------------------------------------------------------
+//
+// notificationResponseHeadersParse - parse the HTTP headers of the response to a notification
+//
+// Returns:
+//   >0: the length of the HTTP headers, including the empty line that ends them
+//    0: the headers are not complete - more data needed
+//   -1: invalid response
+//
+// *contentLengthP is set to -1 if the response has no Content-Length (and is not a 204/304) - such a
+// response ends when the connection is closed, and the connection can't be reused.
+//
+extern int notificationResponseHeadersParse(char* buf, int len, int* statusCodeP, int* contentLengthP, bool* keepAliveP);
+
+#endif  // SRC_LIB_ORIONLD_NOTIFICATIONS_NOTIFICATIONRESPONSEHEADERSPARSE_H_
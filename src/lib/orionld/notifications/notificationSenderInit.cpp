@@ -0,0 +1,531 @@
+/*
+*
+* Copyright 2021 FIWARE Foundation e.V.
+*
+* This file is part of Orion-LD Context Broker.
+*
+* Orion-LD Context Broker is free software: you can redistribute it and/or
+* modify it under the terms of the GNU Affero General Public License as
+* published by the Free Software Foundation, either version 3 of the
+* License, or (at your option) any later version.
+*
+* Orion-LD Context Broker is distributed in the hope that it will be useful,
+* but WITHOUT ANY WARRANTY; without even the implied warranty of
+* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU Affero
+* General Public License for more details.
+*
+* You should have received a copy of the GNU Affero General Public License
+* along with Orion-LD Context Broker. If not, see http://www.gnu.org/licenses/.
+*
+* For those usages not covered by this license please contact with
+* orionld at fiware dot org
+*
+* Author: Ken Zangelin
+*/
+#include <string.h>                                            // strerror, bzero
+#include <stdlib.h>                                            // malloc, free
+#include <errno.h>                                             // errno
+#include <unistd.h>                                            // read, write
+#include <fcntl.h>                                             // fcntl, O_NONBLOCK
+#include <time.h>                                              // time
+#include <pthread.h>                                           // pthread_create
+#include <sys/epoll.h>                                         // epoll_create1, epoll_ctl, epoll_wait
+#include <sys/socket.h>                                        // send, connect, getsockopt, MSG_NOSIGNAL
+#include <netinet/in.h>                                        // struct sockaddr_in
+
+#include "logMsg/logMsg.h"                                     // LM_*
+#include "logMsg/traceLevels.h"                                // Lmt*
+
+#include "orionld/notifications/NotificationItem.h"            // NotificationItem, NOTIFICATION_RESPONSE_TIMEOUT
+#include "orionld/notifications/notificationQueue.h"           // notificationQueueInit, notificationQueuePop, ...
+#include "orionld/notifications/notificationConnectionGet.h"   // notificationConnectionTryGet
+#include "orionld/notifications/notificationConnectionRelease.h"  // notificationConnectionRelease
+#include "orionld/notifications/notificationResponseHeadersParse.h"  // notificationResponseHeadersParse
+#include "orionld/notifications/notificationOutcome.h"        // notificationOutcomePush
+#include "orionld/notifications/notificationSenderInit.h"      // Own interface
+
+
+
+// -----------------------------------------------------------------------------
+//
+// NOTIFICATION_SENDER_MAX_IN_FLIGHT - max number of notifications being sent at the same time, per sender thread
+//
+#define NOTIFICATION_SENDER_MAX_IN_FLIGHT  64
+
+
+
+// -----------------------------------------------------------------------------
+//
+// NOTIFICATION_RESPONSE_BUFFER_SIZE - only the HTTP headers of the response are kept - the body is discarded
+//
+#define NOTIFICATION_RESPONSE_BUFFER_SIZE  4096
+
+
+
+// -----------------------------------------------------------------------------
+//
+// NOTIFICATION_CONNECT_TIMEOUT - max number of seconds for a connection to a notification endpoint to be established
+//
+#define NOTIFICATION_CONNECT_TIMEOUT  5
+
+
+
+// -----------------------------------------------------------------------------
+//
+// InFlightState -
+//
+typedef enum InFlightState
+{
+  IfsWaiting,       // No connection yet - no connection slot free or the address of the endpoint is being resolved
+  IfsConnecting,    // Non-blocking connect in progress - awaiting EPOLLOUT
+  IfsWriting,       // Writing the request
+  IfsReading        // Reading the response
+} InFlightState;
+
+
+
+// -----------------------------------------------------------------------------
+//
+// InFlight - the state of a notification being sent by a sender thread
+//
+typedef struct InFlight
+{
+  NotificationItem*  itemP;
+  int                fd;
+  bool               reused;
+  InFlightState      state;
+  int                written;
+  char               headers[NOTIFICATION_RESPONSE_BUFFER_SIZE];
+  int                headersRead;
+  int                headersLen;     // 0 until all headers have been read
+  int                statusCode;
+  int                contentLength;
+  int                bodyRead;
+  bool               keepAlive;
+  time_t             deadline;
+  time_t             connectDeadline;
+} InFlight;
+
+
+
+// -----------------------------------------------------------------------------
+//
+// SenderState - one per sender thread
+//
+typedef struct SenderState
+{
+  int        epollFd;
+  InFlight   inFlightV[NOTIFICATION_SENDER_MAX_IN_FLIGHT];
+  InFlight*  freeV[NOTIFICATION_SENDER_MAX_IN_FLIGHT];
+  int        freeSlots;
+} SenderState;
+
+
+
+// -----------------------------------------------------------------------------
+//
+// inFlightEnd - the notification has been sent (successfully or not) - release all its resources
+//
+// The outcome (lastSuccess/lastFailure of the subscription) is handed over to the outcome thread - recording it may take the
+// subscription cache semaphore or go to the database, and that would stall all the notifications in flight of this sender.
+//
+static void inFlightEnd(SenderState* ssP, InFlight* ifP, bool ok, bool reusable)
+{
+  if (ifP->fd != -1)
+  {
+    epoll_ctl(ssP->epollFd, EPOLL_CTL_DEL, ifP->fd, NULL);
+
+    // Back to blocking mode before the connection is returned to the pool
+    fcntl(ifP->fd, F_SETFL, fcntl(ifP->fd, F_GETFL) & ~O_NONBLOCK);
+    notificationConnectionRelease(ifP->itemP->host, ifP->itemP->port, ifP->fd, reusable);
+  }
+
+  if (ok)
+    __atomic_add_fetch(&notificationQueueSentOk, 1, __ATOMIC_RELAXED);
+  else
+  {
+    LM_W(("Notification for subscription '%s' to %s:%d failed", ifP->itemP->subscriptionId, ifP->itemP->host, ifP->itemP->port));
+    __atomic_add_fetch(&notificationQueueSentError, 1, __ATOMIC_RELAXED);
+  }
+
+  notificationOutcomePush(ifP->itemP->tenant, ifP->itemP->subscriptionId, ok);
+
+  free(ifP->itemP);
+  ifP->itemP = NULL;
+  ifP->fd    = -1;
+
+  ssP->freeV[ssP->freeSlots] = ifP;
+  ssP->freeSlots += 1;
+}
+
+
+
+// -----------------------------------------------------------------------------
+//
+// inFlightConnect - get a connection for the notification, without blocking
+//
+// If no connection can be had right now (no connection slot free, the address of the endpoint is being resolved),
+// the notification stays in IfsWaiting and this function is called again in the next loop of the sender thread.
+// A new connection is established with a non-blocking connect - its completion is signaled by EPOLLOUT.
+//
+static void inFlightConnect(SenderState* ssP, InFlight* ifP)
+{
+  NotificationItem*   itemP         = ifP->itemP;
+  bool                connectNeeded = false;
+  struct sockaddr_in  addr;
+  int                 fd            = notificationConnectionTryGet(itemP->host, itemP->port, &ifP->reused, &connectNeeded, &addr);
+
+  if (fd == NOTIFICATION_CONNECTION_WAIT)
+    return;
+
+  if (fd == NOTIFICATION_CONNECTION_ERROR)
+  {
+    inFlightEnd(ssP, ifP, false, false);
+    return;
+  }
+
+  ifP->fd = fd;
+
+  if (connectNeeded == true)
+  {
+    ifP->connectDeadline = time(NULL) + NOTIFICATION_CONNECT_TIMEOUT;
+
+    if (connect(fd, (struct sockaddr*) &addr, sizeof(addr)) == 0)
+      ifP->state = IfsWriting;
+    else if (errno == EINPROGRESS)
+      ifP->state = IfsConnecting;
+    else
+    {
+      LM_W(("Unable to connect to notification endpoint %s:%d: %s", itemP->host, itemP->port, strerror(errno)));
+      inFlightEnd(ssP, ifP, false, false);
+      return;
+    }
+  }
+  else
+  {
+    fcntl(fd, F_SETFL, fcntl(fd, F_GETFL) | O_NONBLOCK);
+    ifP->state = IfsWriting;
+  }
+
+  struct epoll_event ev;
+
+  ev.events   = EPOLLOUT;
+  ev.data.ptr = ifP;
+
+  if (epoll_ctl(ssP->epollFd, EPOLL_CTL_ADD, fd, &ev) == -1)
+  {
+    LM_E(("Internal Error (epoll_ctl: %s)", strerror(errno)));
+    inFlightEnd(ssP, ifP, false, false);
+  }
+}
+
+
+
+// -----------------------------------------------------------------------------
+//
+// inFlightStart - start sending a notification
+//
+static void inFlightStart(SenderState* ssP, NotificationItem* itemP)
+{
+  InFlight* ifP = ssP->freeV[ssP->freeSlots - 1];
+
+  ssP->freeSlots -= 1;
+
+  bzero(ifP, sizeof(InFlight));
+  ifP->itemP    = itemP;
+  ifP->fd       = -1;
+  ifP->state    = IfsWaiting;
+  ifP->deadline = time(NULL) + NOTIFICATION_RESPONSE_TIMEOUT;
+
+  inFlightConnect(ssP, ifP);
+}
+
+
+
+// -----------------------------------------------------------------------------
+//
+// inFlightWrite - send (the rest of) the request
+//
+static void inFlightWrite(SenderState* ssP, InFlight* ifP)
+{
+  NotificationItem* itemP = ifP->itemP;
+
+  while (ifP->written < itemP->requestLen)
+  {
+    int nb = send(ifP->fd, &itemP->request[ifP->written], itemP->requestLen - ifP->written, MSG_NOSIGNAL);
+
+    if (nb == -1)
+    {
+      if ((errno == EAGAIN) || (errno == EWOULDBLOCK))
+        return;  // Socket buffer full - wait for the next EPOLLOUT
+
+      if ((ifP->reused == true) && (ifP->written == 0))
+      {
+        //
+        // The keep-alive connection was closed by the endpoint - try again with a new connection
+        //
+        epoll_ctl(ssP->epollFd, EPOLL_CTL_DEL, ifP->fd, NULL);
+        notificationConnectionRelease(itemP->host, itemP->port, ifP->fd, false);
+
+        ssP->freeV[ssP->freeSlots] = ifP;
+        ssP->freeSlots += 1;
+        inFlightStart(ssP, itemP);
+        return;
+      }
+
+      inFlightEnd(ssP, ifP, false, false);
+      return;
+    }
+
+    ifP->written += nb;
+  }
+
+  //
+  // All sent - now wait for the response
+  //
+  struct epoll_event ev;
+
+  ev.events   = EPOLLIN;
+  ev.data.ptr = ifP;
+
+  ifP->state = IfsReading;
+  epoll_ctl(ssP->epollFd, EPOLL_CTL_MOD, ifP->fd, &ev);
+}
+
+
+
+// -----------------------------------------------------------------------------
+//
+// inFlightConnected - EPOLLOUT on a connection being established - connected or failed
+//
+static void inFlightConnected(SenderState* ssP, InFlight* ifP)
+{
+  int        err    = 0;
+  socklen_t  errLen = sizeof(err);
+
+  if ((getsockopt(ifP->fd, SOL_SOCKET, SO_ERROR, &err, &errLen) == -1) || (err != 0))
+  {
+    LM_W(("Unable to connect to notification endpoint %s:%d: %s", ifP->itemP->host, ifP->itemP->port, strerror(err)));
+    inFlightEnd(ssP, ifP, false, false);
+    return;
+  }
+
+  ifP->state = IfsWriting;
+  inFlightWrite(ssP, ifP);
+}
+
+
+
+// -----------------------------------------------------------------------------
+//
+// inFlightRead - read (more of) the response
+//
+static void inFlightRead(SenderState* ssP, InFlight* ifP)
+{
+  while (1)
+  {
+    char  discard[NOTIFICATION_RESPONSE_BUFFER_SIZE];
+    char* bufP;
+    int   bufSize;
+
+    if (ifP->headersLen == 0)
+    {
+      bufP    = &ifP->headers[ifP->headersRead];
+      bufSize = sizeof(ifP->headers) - 1 - ifP->headersRead;
+
+      if (bufSize <= 0)
+      {
+        LM_E(("Internal Error (HTTP headers of the response from notification endpoint too big)"));
+        inFlightEnd(ssP, ifP, false, false);
+        return;
+      }
+    }
+    else
+    {
+      bufP    = discard;
+      bufSize = sizeof(discard);
+    }
+
+    int nb = read(ifP->fd, bufP, bufSize);
+
+    if (nb == -1)
+    {
+      if ((errno == EAGAIN) || (errno == EWOULDBLOCK))
+        return;
+
+      inFlightEnd(ssP, ifP, false, false);
+      return;
+    }
+
+    if (nb == 0)
+    {
+      // Connection closed by the endpoint - OK only if the response is complete
+      bool complete = (ifP->headersLen > 0) && ((ifP->contentLength == -1) || (ifP->bodyRead >= ifP->contentLength));
+      bool ok       = complete && (ifP->statusCode >= 200) && (ifP->statusCode < 300);
+
+      inFlightEnd(ssP, ifP, ok, false);
+      return;
+    }
+
+    if (ifP->headersLen == 0)
+    {
+      ifP->headersRead += nb;
+      ifP->headers[ifP->headersRead] = 0;
+
+      ifP->headersLen = notificationResponseHeadersParse(ifP->headers, ifP->headersRead, &ifP->statusCode, &ifP->contentLength, &ifP->keepAlive);
+
+      if (ifP->headersLen == -1)
+      {
+        LM_E(("Internal Error (invalid response from notification endpoint %s:%d)", ifP->itemP->host, ifP->itemP->port));
+        inFlightEnd(ssP, ifP, false, false);
+        return;
+      }
+
+      if (ifP->headersLen > 0)
+        ifP->bodyRead = ifP->headersRead - ifP->headersLen;
+    }
+    else
+      ifP->bodyRead += nb;
+
+    if (ifP->headersLen > 0)
+    {
+      bool ok = (ifP->statusCode >= 200) && (ifP->statusCode < 300);
+
+      if (ifP->contentLength == -1)
+      {
+        // The response ends when the connection is closed - the rest of the response is of no interest
+        inFlightEnd(ssP, ifP, ok, false);
+        return;
+      }
+
+      if (ifP->bodyRead >= ifP->contentLength)
+      {
+        inFlightEnd(ssP, ifP, ok, ifP->keepAlive && (ifP->bodyRead == ifP->contentLength));
+        return;
+      }
+    }
+  }
+}
+
+
+
+// -----------------------------------------------------------------------------
+//
+// notificationSenderThread -
+//
+static void* notificationSenderThread(void* vP)
+{
+  SenderState* ssP = (SenderState*) calloc(1, sizeof(SenderState));
+
+  if (ssP == NULL)
+    LM_X(1, ("Out of memory allocating notification sender state"));
+
+  ssP->epollFd = epoll_create1(0);
+  if (ssP->epollFd == -1)
+    LM_X(1, ("Runtime Error (epoll_create1: %s)", strerror(errno)));
+
+  for (int ix = 0; ix < NOTIFICATION_SENDER_MAX_IN_FLIGHT; ix++)
+  {
+    ssP->inFlightV[ix].fd = -1;
+    ssP->freeV[ix]        = &ssP->inFlightV[ix];
+  }
+  ssP->freeSlots = NOTIFICATION_SENDER_MAX_IN_FLIGHT;
+
+  while (1)
+  {
+    //
+    // Pick up new notifications from the queue - wait for them only if there's nothing in-flight
+    //
+    while (ssP->freeSlots > 0)
+    {
+      bool               idle  = (ssP->freeSlots == NOTIFICATION_SENDER_MAX_IN_FLIGHT);
+      NotificationItem*  itemP = notificationQueuePop(idle? 1000 : 0);
+
+      if (itemP == NULL)
+        break;
+
+      inFlightStart(ssP, itemP);
+    }
+
+    if (ssP->freeSlots == NOTIFICATION_SENDER_MAX_IN_FLIGHT)
+      continue;
+
+    struct epoll_event  events[NOTIFICATION_SENDER_MAX_IN_FLIGHT];
+    int                 fds = epoll_wait(ssP->epollFd, events, NOTIFICATION_SENDER_MAX_IN_FLIGHT, 50);
+
+    if ((fds == -1) && (errno != EINTR))
+      LM_X(1, ("Runtime Error (epoll_wait: %s)", strerror(errno)));
+
+    for (int ix = 0; ix < fds; ix++)
+    {
+      InFlight* ifP = (InFlight*) events[ix].data.ptr;
+
+      if (ifP->itemP == NULL)
+        continue;  // Ended during this very loop
+
+      if (ifP->state == IfsConnecting)
+        inFlightConnected(ssP, ifP);
+      else if (ifP->state == IfsWriting)
+        inFlightWrite(ssP, ifP);
+      else if (ifP->state == IfsReading)
+        inFlightRead(ssP, ifP);
+    }
+
+    //
+    // Timeouts, and new attempts to get a connection for the notifications still waiting for one
+    //
+    time_t now = time(NULL);
+
+    for (int ix = 0; ix < NOTIFICATION_SENDER_MAX_IN_FLIGHT; ix++)
+    {
+      InFlight* ifP = &ssP->inFlightV[ix];
+
+      if (ifP->itemP == NULL)
+        continue;
+
+      if (now > ifP->deadline)
+      {
+        LM_W(("Timeout sending notification for subscription '%s' to %s:%d", ifP->itemP->subscriptionId, ifP->itemP->host, ifP->itemP->port));
+        inFlightEnd(ssP, ifP, false, false);
+      }
+      else if ((ifP->state == IfsConnecting) && (now > ifP->connectDeadline))
+      {
+        LM_W(("Timeout connecting to notification endpoint %s:%d", ifP->itemP->host, ifP->itemP->port));
+        inFlightEnd(ssP, ifP, false, false);
+      }
+      else if (ifP->state == IfsWaiting)
+        inFlightConnect(ssP, ifP);
+    }
+  }
+
+  return NULL;
+}
+
+
+
+// -----------------------------------------------------------------------------
+//
+// notificationSenderInit - create the notification queue and start the notification sender threads
+//
+void notificationSenderInit(int senders, int queueSize, const char* queuePolicy)
+{
+  NotificationQueuePolicy policy;
+
+  if (notificationQueuePolicyParse(queuePolicy, &policy) == false)
+    LM_X(1, ("Fatal Error (invalid notification queue policy '%s' - valid: dropNew, dropOld, block)", queuePolicy));
+
+  notificationQueueInit(queueSize, policy);
+
+  for (int ix = 0; ix < senders; ix++)
+  {
+    pthread_t  tid;
+    int        rc = pthread_create(&tid, NULL, notificationSenderThread, NULL);
+
+    if (rc != 0)
+      LM_X(1, ("Runtime Error (pthread_create: %s)", strerror(rc)));
+
+    pthread_detach(tid);
+  }
+
+  LM_I(("Started %d NGSI-LD notification sender threads (queue size: %d, policy: %s)", senders, queueSize, queuePolicy));
+}
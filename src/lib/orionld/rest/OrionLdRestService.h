@@ -165,14 +165,49 @@ typedef struct OrionLdRestService
 
 
 
+// -----------------------------------------------------------------------------
+//
+// ORIONLD_SERVICE_TRIE_WILDCARD_SERVICES - max number of services with wildcards that start in the same trie node
+//
+// E.g. "/ngsi-ld/v1/entities/*/attrs/*" and "/ngsi-ld/v1/entities/*/attrs", both for PATCH
+//
+#define ORIONLD_SERVICE_TRIE_WILDCARD_SERVICES  4
+
+
+
+// -----------------------------------------------------------------------------
+//
+// OrionLdServiceTrieNode -
+//
+// Node of the radix trie of the URL paths of the services of one verb.
+// The trie contains the URL paths without the prefix "/ngsi-ld/" and only up to the first wildcard.
+// A node is reached after matching the labels of the path from the root node, and:
+// - a service without wildcards, whose URL path ends in the node, is found in 'serviceP'
+// - services with wildcards, whose first wildcard starts right after the node, are found in 'wildcardServiceV',
+//   in the same order as they appear in the service vector (first match wins)
+//
+typedef struct OrionLdServiceTrieNode
+{
+  const char*                     label;                 // Characters of the URL path leading to this node (not zero-terminated)
+  int                             labelLen;              // Length of 'label'
+  struct OrionLdServiceTrieNode*  firstChildP;           // Children have labels that all start with different characters
+  struct OrionLdServiceTrieNode*  next;                  // Next sibling
+  OrionLdRestService*             serviceP;              // Service without wildcards ending in this node
+  OrionLdRestService*             wildcardServiceV[ORIONLD_SERVICE_TRIE_WILDCARD_SERVICES];
+  int                             wildcardServices;
+} OrionLdServiceTrieNode;
+
+
+
 // -----------------------------------------------------------------------------
 //
 // OrionLdRestServiceVector -
 //
 typedef struct OrionLdRestServiceVector
 {
-  OrionLdRestService*  serviceV;
-  int                  services;
+  OrionLdRestService*      serviceV;
+  int                      services;
+  OrionLdServiceTrieNode*  trieP;        // Built by orionldServiceTrieBuild, from serviceV, used by orionldServiceLookup
 } OrionLdRestServiceVector;
 
 #endif  // SRC_LIB_ORIONLD_REST_ORIONLDRESTSERVICE_H_
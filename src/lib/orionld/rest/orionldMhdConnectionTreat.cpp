@@ -44,6 +44,7 @@ extern "C"
 #include "logMsg/traceLevels.h"                                  // Lmt*
 
 #include "common/string.h"                                       // FT
+#include "common/limits.h"                                       // SERVICE_NAME_MAX_LEN, SERVICE_NAME_MAX_LEN_STRING
 #include "rest/ConnectionInfo.h"                                 // ConnectionInfo
 #include "rest/httpHeaderAdd.h"                                  // httpHeaderAdd, httpHeaderLinkAdd
 #include "rest/restReply.h"                                      // restReply
@@ -61,10 +62,12 @@ extern "C"
 #include "orionld/common/orionldTenantCreate.h"                  // orionldTenantCreate
 #include "orionld/common/numberToDate.h"                         // numberToDate
 #include "orionld/common/performance.h"                          // REQUEST_PERFORMANCE
+#include "orionld/common/orionldLatency.h"                       // orionldLatencyPhaseStart, orionldLatencyPhaseEnd
 #include "orionld/db/dbConfiguration.h"                          // dbGeoIndexCreate
 #include "orionld/db/dbGeoIndexLookup.h"                         // dbGeoIndexLookup
 #include "orionld/kjTree/kjGeojsonEntityTransform.h"             // kjGeojsonEntityTransform
 #include "orionld/kjTree/kjGeojsonEntitiesTransform.h"           // kjGeojsonEntitiesTransform
+#include "orionld/kjTree/kjTreeRenderSize.h"                     // kjTreeRenderSize
 #include "orionld/payloadCheck/pcheckName.h"                     // pcheckName
 #include "orionld/context/orionldCoreContext.h"                  // ORIONLD_CORE_CONTEXT_URL
 #include "orionld/context/orionldContextFromUrl.h"               // orionldContextFromUrl
@@ -301,10 +304,12 @@ static bool payloadParseAndExtractSpecialFields(ConnectionInfo* ciP, bool* conte
 #ifdef REQUEST_PERFORMANCE
     kTimeGet(&timestamps.parseStart);
 #endif
+  orionldLatencyPhaseStart(LP_PARSE);
   orionldState.requestTree = kjParse(orionldState.kjsonP, ciP->payload);
 #ifdef REQUEST_PERFORMANCE
     kTimeGet(&timestamps.parseEnd);
 #endif
+  orionldLatencyPhaseEnd(LP_PARSE);
 
   //
   // Parse Error?
@@ -617,24 +622,26 @@ static void contextToPayload(void)
 //
 static void dbGeoIndexes(void)
 {
-  char  tenant[64];
-  char* tenantP;
+  OrionldTenant* tenantP = orionldState.tenantP;
 
-  if ((orionldState.tenant == NULL) || (orionldState.tenant[0] == 0))
-    tenantP = dbName;
-  else
+  if (tenantP == NULL)
   {
-    snprintf(tenant, sizeof(tenant), "%s-%s", dbName, orionldState.tenant);
-    tenantP = tenant;
+    if ((orionldState.tenant == NULL) || (orionldState.tenant[0] == 0))
+      tenantP = &tenant0;
+    else if ((tenantP = orionldTenantLookup(orionldState.tenant)) == NULL)
+      return;  // A tenant that doesn't exist has no entities to index
   }
 
-  // sem_take
+  //
+  // No lock needed - the geo-index set of a tenant is lock-free, and if two requests create
+  // the same index at the same time, the index creation in mongo is idempotent and dbGeoIndexAdd
+  // keeps only one of the two items
+  //
   for (int ix = 0; ix < orionldState.geoAttrs; ix++)
   {
     if (dbGeoIndexLookup(tenantP, orionldState.geoAttrV[ix]->name) == NULL)
       dbGeoIndexCreate(tenantP, orionldState.geoAttrV[ix]->name);
   }
-  // sem_give
 }
 
 
@@ -667,6 +674,49 @@ bool uriParamSupport(uint32_t supported, uint32_t given, char** detailP)
 
 
 
+// -----------------------------------------------------------------------------
+//
+// responseTreeRender - render the response tree into orionldState.responsePayload
+//
+// The tree is rendered once, with kjFastRender unless pretty-print has been asked for.
+// The size of the rendered tree is calculated first (kjTreeRenderSize - no rendering involved), and if it doesn't fit
+// in the thread local buffer, a buffer of the right size is allocated. That buffer is handed over to MHD by restReply,
+// so that it needs not be copied.
+//
+static __thread char responsePayload[1024 * 1024];
+
+static void responseTreeRender(void)
+{
+  long unsigned int  size = kjTreeRenderSize(orionldState.kjsonP, orionldState.responseTree);
+  char*              buf  = responsePayload;
+
+  if (size > sizeof(responsePayload))
+  {
+    buf = (char*) malloc(size);
+
+    if (buf == NULL)
+    {
+      LM_E(("Out of memory (allocating %lu bytes for the response payload)", size));
+      orionldState.httpStatusCode  = SccReceiverInternalError;
+      orionldState.responsePayload = (char*) "{ \"type\": \"https://uri.etsi.org/ngsi-ld/errors/InternalError\", \"title\": \"Out of memory\", \"detail\": \"unable to allocate the response payload\" }";
+      return;
+    }
+
+    orionldState.responsePayloadAllocated = true;
+  }
+  else
+    size = sizeof(responsePayload);
+
+  if (orionldState.uriParams.prettyPrint == false)
+    kjFastRender(orionldState.kjsonP, orionldState.responseTree, buf, size);
+  else
+    kjRender(orionldState.kjsonP, orionldState.responseTree, buf, size);
+
+  orionldState.responsePayload = buf;
+}
+
+
+
 // -----------------------------------------------------------------------------
 //
 // orionldMhdConnectionTreat -
@@ -715,7 +765,6 @@ bool uriParamSupport(uint32_t supported, uint32_t given, char** detailP)
 //
 //
 //
-static __thread char responsePayload[1024 * 1024];
 MHD_Result orionldMhdConnectionTreat(ConnectionInfo* ciP)
 {
   bool     contextToBeCashed    = false;
@@ -748,11 +797,21 @@ MHD_Result orionldMhdConnectionTreat(ConnectionInfo* ciP)
   //   * POST /ngsi-ld/v1/entityOperations/upsert
   // then if the tenant doesn't exist, an error must be returned (404)
   //
+  // Tenant names longer than SERVICE_NAME_MAX_LEN are rejected - they wouldn't fit in the tenant registry
+  //
   if ((orionldState.tenant != NULL) && (*orionldState.tenant != 0))
   {
+    if (strlen(orionldState.tenant) > SERVICE_NAME_MAX_LEN)
+    {
+      LM_W(("Bad Input (tenant name too long: '%s')", orionldState.tenant));
+      orionldErrorResponseCreate(OrionldBadRequestData, "Invalid tenant name", "tenant name too long (max " SERVICE_NAME_MAX_LEN_STRING " characters)");
+      orionldState.httpStatusCode = 400;
+      goto respond;
+    }
+
     if ((orionldState.serviceP->options & ORIONLD_SERVICE_OPTION_MAKE_SURE_TENANT_EXISTS) == ORIONLD_SERVICE_OPTION_MAKE_SURE_TENANT_EXISTS)
     {
-      if (orionldTenantLookup(orionldState.tenant) == NULL)
+      if ((orionldState.tenantP = orionldTenantLookup(orionldState.tenant)) == NULL)
       {
         LM_W(("Bad Input (non-existing tenant: '%s')", orionldState.tenant));
         orionldErrorResponseCreate(OrionldNonExistingTenant, "No such tenant", orionldState.tenant);
@@ -865,12 +924,14 @@ MHD_Result orionldMhdConnectionTreat(ConnectionInfo* ciP)
 #ifdef REQUEST_PERFORMANCE
   kTimeGet(&timestamps.serviceRoutineStart);
 #endif
+  orionldLatencyPhaseStart(LP_SERVICE_ROUTINE);
 
   serviceRoutineResult = orionldState.serviceP->serviceRoutine(ciP);
 
 #ifdef REQUEST_PERFORMANCE
   kTimeGet(&timestamps.serviceRoutineEnd);
 #endif
+  orionldLatencyPhaseEnd(LP_SERVICE_ROUTINE);
 
   //
   // If the service routine failed (returned FALSE), but no HTTP status ERROR code is set,
@@ -883,9 +944,6 @@ MHD_Result orionldMhdConnectionTreat(ConnectionInfo* ciP)
   }
   else  // Service Routine worked
   {
-    if (orionldState.geoAttrs > 0)
-      dbGeoIndexes();
-
     // New tenant?
     if ((orionldState.tenant != NULL) && (orionldState.tenant[0] != 0))
     {
@@ -914,24 +972,28 @@ MHD_Result orionldMhdConnectionTreat(ConnectionInfo* ciP)
         //    - If the tenant does not exist, create it
         //    - Post the tenantSem
         //
-        if (orionldTenantLookup(orionldState.tenant) == NULL)
+        if (orionldState.tenantP == NULL)  // Not looked up yet (if it was looked up and found, it exists)
+          orionldState.tenantP = orionldTenantLookup(orionldState.tenant);
+
+        if (orionldState.tenantP == NULL)
         {
           sem_wait(&tenantSem);
-          if (orionldTenantLookup(orionldState.tenant) == NULL)  // Second lookup - this time sem-protected
+          if ((orionldState.tenantP = orionldTenantLookup(orionldState.tenant)) == NULL)  // Second lookup - this time sem-protected
           {
-            char prefixed[64];
-
-            snprintf(prefixed, sizeof(prefixed), "%s-%s", dbName, orionldState.tenant);
-            orionldTenantCreate(prefixed);
+            orionldState.tenantP = orionldTenantCreate(orionldState.tenant);
 
             if (idIndex == true)
-              dbIdIndexCreate(prefixed);
+              dbIdIndexCreate(orionldState.tenantP->mongoDbName);
           }
 
           sem_post(&tenantSem);
         }
       }
     }
+
+    // After the tenant creation, so that the tenant is in the registry
+    if (orionldState.geoAttrs > 0)
+      dbGeoIndexes();
   }
 
  respond:
@@ -1017,11 +1079,10 @@ MHD_Result orionldMhdConnectionTreat(ConnectionInfo* ciP)
     //
     // Render the payload to get a string for restReply to send the response
     //
-    // FIXME: Smarter allocation !!!
-    //
 #ifdef REQUEST_PERFORMANCE
     kTimeGet(&timestamps.renderStart);
 #endif
+    orionldLatencyPhaseStart(LP_RENDER);
 
     if ((orionldState.acceptGeojson == true) && (serviceRoutineResult == true))
     {
@@ -1033,18 +1094,12 @@ MHD_Result orionldMhdConnectionTreat(ConnectionInfo* ciP)
         LM_W(("Bad Input (Accept: application/geo+json for non-compatible request)"));
     }
 
-    kjRender(orionldState.kjsonP, orionldState.responseTree, responsePayload, sizeof(responsePayload));
-
-    if (orionldState.uriParams.prettyPrint == false)
-      kjFastRender(orionldState.kjsonP, orionldState.responseTree, responsePayload, sizeof(responsePayload));
-    else
-      kjRender(orionldState.kjsonP, orionldState.responseTree, responsePayload, sizeof(responsePayload));
-
+    responseTreeRender();
 
 #ifdef REQUEST_PERFORMANCE
     kTimeGet(&timestamps.renderEnd);
 #endif
-    orionldState.responsePayload = responsePayload;
+    orionldLatencyPhaseEnd(LP_RENDER);
   }
 
   //
@@ -1056,15 +1111,17 @@ MHD_Result orionldMhdConnectionTreat(ConnectionInfo* ciP)
 #ifdef REQUEST_PERFORMANCE
   kTimeGet(&timestamps.restReplyStart);
 #endif
+  orionldLatencyPhaseStart(LP_REPLY);
 
   if (orionldState.responsePayload != NULL)
-    restReply(ciP, orionldState.responsePayload);    // orionldState.responsePayload freed and NULLed by restReply()
+    restReply(ciP, orionldState.responsePayload, strlen(orionldState.responsePayload));  // freed (or handed over to MHD) and NULLed by restReply()
   else
     restReply(ciP, "");
 
 #ifdef REQUEST_PERFORMANCE
   kTimeGet(&timestamps.restReplyEnd);
 #endif
+  orionldLatencyPhaseEnd(LP_REPLY);
 
   //
   // FIXME: Delay until requestCompleted. The call to orionldStateRelease as well
@@ -1088,6 +1145,7 @@ MHD_Result orionldMhdConnectionTreat(ConnectionInfo* ciP)
 #ifdef REQUEST_PERFORMANCE
         kTimeGet(&timestamps.troeStart);
 #endif
+        orionldLatencyPhaseStart(LP_TROE);
 
         //
         // If the incoming request an empty array/object, then don't call the TRoE routine
@@ -1098,6 +1156,7 @@ MHD_Result orionldMhdConnectionTreat(ConnectionInfo* ciP)
 #ifdef REQUEST_PERFORMANCE
         kTimeGet(&timestamps.troeEnd);
 #endif
+        orionldLatencyPhaseEnd(LP_TROE);
       }
     }
   }
@@ -52,6 +52,7 @@ extern "C"
 #include "orionld/rest/OrionLdRestService.h"                         // OrionLdRestService, ORION_LD_SERVICE_PREFIX_LEN
 #include "orionld/rest/temporaryErrorPayloads.h"                     // Temporary Error Payloads
 #include "orionld/rest/uriParamName.h"                               // uriParamName
+#include "orionld/rest/orionldServiceTrieBuild.h"                    // orionldServiceTrieBuild
 #include "orionld/serviceRoutines/orionldPostEntities.h"             // orionldPostEntities
 #include "orionld/serviceRoutines/orionldPostEntity.h"               // orionldPostEntity
 #include "orionld/serviceRoutines/orionldGetEntities.h"              // orionldGetEntities
@@ -72,6 +73,7 @@ extern "C"
 #include "orionld/serviceRoutines/orionldPostQuery.h"                // orionldPostQuery
 #include "orionld/serviceRoutines/orionldGetTenants.h"               // orionldGetTenants
 #include "orionld/serviceRoutines/orionldGetDbIndexes.h"             // orionldGetDbIndexes
+#include "orionld/serviceRoutines/orionldGetLatency.h"               // orionldGetLatency
 #include "orionld/serviceRoutines/orionldGetRegistrations.h"         // orionldGetRegistrations
 #include "orionld/serviceRoutines/orionldGetRegistration.h"          // orionldGetRegistration
 #include "orionld/serviceRoutines/orionldPatchRegistration.h"        // orionldPatchRegistration
@@ -79,6 +81,7 @@ extern "C"
 #include "orionld/serviceRoutines/orionldPatchSubscription.h"        // orionldPatchSubscription
 #include "orionld/serviceRoutines/orionldDeleteSubscription.h"       // orionldDeleteSubscription
 #include "orionld/serviceRoutines/orionldGetEntityTypes.h"           // orionldGetEntityTypes
+#include "orionld/serviceRoutines/orionldGetContexts.h"              // orionldGetContexts
 #include "orionld/troe/troePostEntities.h"                           // troePostEntities
 #include "orionld/troe/troePostBatchDelete.h"                        // troePostBatchDelete
 #include "orionld/troe/troeDeleteAttribute.h"                        // troeDeleteAttribute
@@ -396,6 +399,10 @@ static void restServicePrepare(OrionLdRestService* serviceP, OrionLdRestServiceS
 
     serviceP->options   |= ORIONLD_SERVICE_OPTION_NO_V2_URI_PARAMS;
   }
+  else if (serviceP->serviceRoutine == orionldGetContexts)
+  {
+    serviceP->uriParams |= ORIONLD_URIPARAM_DETAILS;
+  }
   else if (serviceP->serviceRoutine == orionldGetVersion)
   {
     serviceP->options  = 0;  // Tenant is Ignored
@@ -419,6 +426,13 @@ static void restServicePrepare(OrionLdRestService* serviceP, OrionLdRestServiceS
     serviceP->options |= ORIONLD_SERVICE_OPTION_NO_V2_URI_PARAMS;
     serviceP->options |= ORIONLD_SERVICE_OPTION_NO_CONTEXT_NEEDED;
   }
+  else if (serviceP->serviceRoutine == orionldGetLatency)
+  {
+    serviceP->options  = 0;  // Tenant is Ignored
+    serviceP->options |= ORIONLD_SERVICE_OPTION_DONT_ADD_CONTEXT_TO_RESPONSE_PAYLOAD;
+    serviceP->options |= ORIONLD_SERVICE_OPTION_NO_V2_URI_PARAMS;
+    serviceP->options |= ORIONLD_SERVICE_OPTION_NO_CONTEXT_NEEDED;
+  }
 
   if (troe)  // CLI Option to turn on Temporal Representation of Entities
   {
@@ -449,11 +463,12 @@ static void restServicePrepare(OrionLdRestService* serviceP, OrionLdRestServiceS
 
 // -----------------------------------------------------------------------------
 //
-// orionldServiceInit -
+// orionldServiceVectorsPrepare -
 //
-// This function converts the OrionLdRestServiceSimplified vectors to OrionLdRestService vectors
+// This function converts the OrionLdRestServiceSimplified vectors to OrionLdRestService vectors,
+// and builds the lookup trie of each verb
 //
-void orionldServiceInit(OrionLdRestServiceSimplifiedVector* restServiceVV, int vecItems, char* cachedContextDir)
+void orionldServiceVectorsPrepare(OrionLdRestServiceSimplifiedVector* restServiceVV, int vecItems)
 {
   int svIx;    // Service Vector Index
 
@@ -479,7 +494,20 @@ void orionldServiceInit(OrionLdRestServiceSimplifiedVector* restServiceVV, int v
       LM_T(LmtUrlParse, ("sIx: %d", sIx));
       restServicePrepare(&orionldRestServiceV[svIx].serviceV[sIx], &restServiceVV[svIx].serviceV[sIx]);
     }
+
+    orionldRestServiceV[svIx].trieP = orionldServiceTrieBuild(&orionldRestServiceV[svIx]);
   }
+}
+
+
+
+// -----------------------------------------------------------------------------
+//
+// orionldServiceInit -
+//
+void orionldServiceInit(OrionLdRestServiceSimplifiedVector* restServiceVV, int vecItems, char* cachedContextDir)
+{
+  orionldServiceVectorsPrepare(restServiceVV, vecItems);
 
 
   //
@@ -37,6 +37,16 @@ extern OrionLdRestServiceVector orionldRestServiceV[9];
 
 
 
+// -----------------------------------------------------------------------------
+//
+// orionldServiceVectorsPrepare - convert the RestServiceLd vectors to OrionLdRestService vectors, and build the lookup tries
+//
+// Only the part of orionldServiceInit that concerns the service lookup - used on its own by the unit tests.
+//
+extern void orionldServiceVectorsPrepare(OrionLdRestServiceSimplifiedVector* restServiceVV, int vecItems);
+
+
+
 // -----------------------------------------------------------------------------
 //
 // orionldServiceInit -
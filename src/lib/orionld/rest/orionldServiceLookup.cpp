@@ -22,55 +22,68 @@
 *
 * Author: Ken Zangelin
 */
+#include <string.h>                                            // strlen, strstr
+
 #include "logMsg/logMsg.h"                                     // LM_*
 #include "logMsg/traceLevels.h"                                // Lmt*
 
 #include "orionld/common/orionldState.h"                       // orionldState
-#include "orionld/rest/OrionLdRestService.h"                   // OrionLdRestService, ORION_LD_SERVICE_PREFIX_LEN
+#include "orionld/rest/OrionLdRestService.h"                   // OrionLdRestService, OrionLdServiceTrieNode, ORION_LD_SERVICE_PREFIX_LEN
 #include "orionld/rest/orionldServiceLookup.h"                 // Own interface
 
 
 
 // -----------------------------------------------------------------------------
 //
-// requestPrepare -
+// TRIE_MAX_DEPTH - max number of trie nodes with wildcard services passed in one lookup
 //
-// The cSumV values are interesting only for URL paths without wildcard of just uptil the first wildcard
-// The longest URL path without/before first wildcard is "/ngsi-ld/v1/csourceRegistrations/".
-// The initial part ("/ngsi-ld/") doesn't count, so ... 24 chars is all we need for the cSumV.
+#define TRIE_MAX_DEPTH 16
+
+
+
+// -----------------------------------------------------------------------------
 //
-// strlen("/ngsi-ld/v1/entityOperations/delete")   == 35
-// strlen("/ngsi-ld/")                           == 9   (ORION_LD_SERVICE_PREFIX_LEN)
+// wildcardServiceMatch - does the rest of the URL path (after the part matched in the trie) match the service?
 //
-//  35 - 9 == 26
+// 'rest' is where the first wildcard starts and 'restLen' its length (always > 0).
+// On match, orionldState.wildcard[] is set to point inside the incoming URL path and the URL path
+// is zero-terminated at the end of the wildcards - exactly like the linear lookup does.
 //
-#define MAX_CHARS_BEFORE_WILDCARD 26
-static void requestPrepare(char* url, int* cSumV, int* cSumsP, int* sLenP)
+static bool wildcardServiceMatch(OrionLdRestService* serviceP, char* rest, int restLen)
 {
-  // First of all, skip the first 9 characters in the URL path ("/ngsi-ld/")
-  url = &url[ORION_LD_SERVICE_PREFIX_LEN];
-  *cSumsP = 0;
+  if (serviceP->wildcards == 1)
+  {
+    if (serviceP->matchForSecondWildcardLen == 0)
+    {
+      orionldState.wildcard[0] = rest;
+      return true;
+    }
 
-  // Initialize counters with the first byte, then skip the first byte for the loop
-  cSumV[0] = url[0];
+    // Ending the same?
+    int endIx = restLen - serviceP->matchForSecondWildcardLen;
 
-  int sLen;
-  int ix   = 1;
+    if (endIx < 0)
+      return false;
 
-  while ((url[ix] != 0) && (ix < MAX_CHARS_BEFORE_WILDCARD))
-  {
-    cSumV[ix]  = cSumV[ix - 1] + url[ix];
-    ++ix;
-  }
-  *cSumsP = ix;
+    if (strncmp(&rest[endIx], serviceP->matchForSecondWildcard, serviceP->matchForSecondWildcardLen) != 0)
+      return false;
 
-  while (url[ix] != 0)
-  {
-    ++ix;
+    orionldState.wildcard[0] = rest;
+    rest[endIx] = 0;  // Destroying the incoming URL path, to extract the wildcard string
+
+    return true;
   }
 
-  sLen   = ix;
-  *sLenP = sLen;
+  char* matchP = strstr(rest, serviceP->matchForSecondWildcard);
+
+  if (matchP == NULL)
+    return false;
+
+  orionldState.wildcard[0] = rest;
+  orionldState.wildcard[1] = &matchP[serviceP->matchForSecondWildcardLen];
+  *matchP = 0;  // Destroying the incoming URL path, to extract first wildcard string
+
+  return true;
 }
 
 
@@ -82,87 +95,76 @@ static void requestPrepare(char* url, int* cSumV, int* cSumsP, int* sLenP)
 // The Verb must be a valid verb before calling this function (GET | POST | DELETE).
 // This is assured by the function orionldMhdConnectionTreat()
 //
+// The URL path (after "/ngsi-ld/") is matched against the radix trie of the verb, built at startup by
+// orionldServiceTrieBuild, i.e. in time proportional to the length of the URL path, not to the number of services.
+//
+// While walking down the trie, the nodes that have services with wildcards are remembered.
+// If the URL path doesn't end in a node with a service without wildcards, the remembered nodes are
+// tried, the deepest node (longest fixed part) first.
+//
 OrionLdRestService* orionldServiceLookup(OrionLdRestServiceVector* serviceV)
 {
-  int serviceIx = 0;
-  int cSumV[MAX_CHARS_BEFORE_WILDCARD];
-  int cSums;
-  int sLen;
-
-  requestPrepare(orionldState.urlPath, cSumV, &cSums, &sLen);
-
-  while (serviceIx < serviceV->services)
+  OrionLdServiceTrieNode*  nodeP = serviceV->trieP;
+  char*                    path  = &orionldState.urlPath[ORION_LD_SERVICE_PREFIX_LEN];
+  int                      pos   = 0;
+  OrionLdServiceTrieNode*  wildcardNodeV[TRIE_MAX_DEPTH];
+  int                      wildcardPosV[TRIE_MAX_DEPTH];
+  int                      wildcardNodes = 0;
+
+  while (nodeP != NULL)
   {
-    OrionLdRestService* serviceP = &serviceV->serviceV[serviceIx];
+    // The label of the node has been matched - now at 'pos'
 
-    if (serviceP->wildcards == 0)
+    if (path[pos] == 0)
     {
-      if (serviceP->charsBeforeFirstWildcard == sLen)
-      {
-        if (serviceP->charsBeforeFirstWildcardSum == cSumV[sLen - 1])
-        {
-          if (strcmp(&serviceP->url[ORION_LD_SERVICE_PREFIX_LEN], &orionldState.urlPath[ORION_LD_SERVICE_PREFIX_LEN]) == 0)
-          {
-            return serviceP;
-          }
-        }
-      }
+      if (nodeP->serviceP != NULL)
+        return nodeP->serviceP;
+      break;
     }
-    else if (serviceP->wildcards == 1)
+
+    if ((nodeP->wildcardServices > 0) && (wildcardNodes < TRIE_MAX_DEPTH))
     {
-      if (serviceP->charsBeforeFirstWildcard < sLen)
-      {
-        if (serviceP->charsBeforeFirstWildcardSum == cSumV[serviceP->charsBeforeFirstWildcard - 1])
-        {
-          if (strncmp(&serviceP->url[ORION_LD_SERVICE_PREFIX_LEN], &orionldState.urlPath[ORION_LD_SERVICE_PREFIX_LEN], serviceP->charsBeforeFirstWildcard) == 0)
-          {
-            // Ending the same?
-            if (serviceP->matchForSecondWildcardLen != 0)  // An ending to match
-            {
-              int indexOfIncomingUrlPath = ORION_LD_SERVICE_PREFIX_LEN + sLen - serviceP->matchForSecondWildcardLen;
-
-              if (strncmp(&orionldState.urlPath[indexOfIncomingUrlPath], serviceP->matchForSecondWildcard, serviceP->matchForSecondWildcardLen) == 0)
-              {
-                orionldState.wildcard[0] = &orionldState.urlPath[serviceP->charsBeforeFirstWildcard + ORION_LD_SERVICE_PREFIX_LEN];
-
-                // Destroying the incoming URL path, to extract the wildcard string
-                orionldState.urlPath[sLen - serviceP->matchForSecondWildcardLen + ORION_LD_SERVICE_PREFIX_LEN] = 0;
-                return serviceP;
-              }
-            }
-            else
-            {
-              orionldState.wildcard[0] = &orionldState.urlPath[serviceP->charsBeforeFirstWildcard + ORION_LD_SERVICE_PREFIX_LEN];
-              return serviceP;
-            }
-          }
-        }
-      }
+      wildcardNodeV[wildcardNodes] = nodeP;
+      wildcardPosV[wildcardNodes]  = pos;
+      ++wildcardNodes;
     }
-    else
+
+    // Find the child whose label starts with the next character - and match the rest of the label
+    OrionLdServiceTrieNode* childP = nodeP->firstChildP;
+
+    while ((childP != NULL) && (childP->label[0] != path[pos]))
+      childP = childP->next;
+
+    if (childP == NULL)
+      break;
+
+    int ix = 1;
+    while ((ix < childP->labelLen) && (childP->label[ix] == path[pos + ix]))  // path[pos + ix] == 0 stops the loop
+      ++ix;
+
+    if (ix < childP->labelLen)
+      break;
+
+    pos   += childP->labelLen;
+    nodeP  = childP;
+  }
+
+  if (wildcardNodes == 0)
+    return NULL;
+
+  int pathLen = pos + strlen(&path[pos]);
+
+  for (int nIx = wildcardNodes - 1; nIx >= 0; nIx--)
+  {
+    OrionLdServiceTrieNode*  wNodeP  = wildcardNodeV[nIx];
+    char*                    rest    = &path[wildcardPosV[nIx]];
+    int                      restLen = pathLen - wildcardPosV[nIx];
+
+    for (int sIx = 0; sIx < wNodeP->wildcardServices; sIx++)
     {
-      if (serviceP->charsBeforeFirstWildcard < sLen)
-      {
-        if (serviceP->charsBeforeFirstWildcardSum == cSumV[serviceP->charsBeforeFirstWildcard - 1])
-        {
-          char* matchP;
-          if ((matchP = strstr(&orionldState.urlPath[ORION_LD_SERVICE_PREFIX_LEN], serviceP->matchForSecondWildcard)) != NULL)
-          {
-            {
-              orionldState.wildcard[0] = &orionldState.urlPath[serviceP->charsBeforeFirstWildcard + ORION_LD_SERVICE_PREFIX_LEN];
-              orionldState.wildcard[1] = &matchP[serviceP->matchForSecondWildcardLen];
-
-              // Destroying the incoming URL path, to extract first wildcard string
-              *matchP = 0;
-
-              return serviceP;
-            }
-          }
-        }
-      }
+      if (wildcardServiceMatch(wNodeP->wildcardServiceV[sIx], rest, restLen) == true)
+        return wNodeP->wildcardServiceV[sIx];
     }
-
-    ++serviceIx;
   }
 
   return NULL;
@@ -0,0 +1,155 @@
+/*
+*
+* Copyright 2021 FIWARE Foundation e.V.
+*
+* This file is part of Orion-LD Context Broker.
+*
+* Orion-LD Context Broker is free software: you can redistribute it and/or
+* modify it under the terms of the GNU Affero General Public License as
+* published by the Free Software Foundation, either version 3 of the
+* License, or (at your option) any later version.
+*
+* Orion-LD Context Broker is distributed in the hope that it will be useful,
+* but WITHOUT ANY WARRANTY; without even the implied warranty of
+* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU Affero
+* General Public License for more details.
+*
+* You should have received a copy of the GNU Affero General Public License
+* along with Orion-LD Context Broker. If not, see http://www.gnu.org/licenses/.
+*
+* For those usages not covered by this license please contact with
+* orionld at fiware dot org
+*
+* Author: Ken Zangelin
+*/
+#include <stdlib.h>                                                    // calloc
+#include <string.h>                                                    // strlen
+
+#include "logMsg/logMsg.h"                                             // LM_*
+#include "logMsg/traceLevels.h"                                        // Lmt*
+
+#include "orionld/rest/OrionLdRestService.h"                           // OrionLdRestServiceVector, OrionLdServiceTrieNode
+#include "orionld/rest/orionldServiceTrieBuild.h"                      // Own interface
+
+
+
+// -----------------------------------------------------------------------------
+//
+// trieNodeCreate -
+//
+static OrionLdServiceTrieNode* trieNodeCreate(const char* label, int labelLen)
+{
+  OrionLdServiceTrieNode* nodeP = (OrionLdServiceTrieNode*) calloc(1, sizeof(OrionLdServiceTrieNode));
+
+  if (nodeP == NULL)
+    LM_X(1, ("Out of memory (allocating a node for the service trie)"));
+
+  nodeP->label    = label;
+  nodeP->labelLen = labelLen;
+
+  return nodeP;
+}
+
+
+
+// -----------------------------------------------------------------------------
+//
+// trieNodeInsert - find (create if necessary) the node for the first 'len' characters of 'path'
+//
+// The labels point into the URL paths of the services - no strings are copied.
+// If the path ends in the middle of the label of a node, that node is split in two.
+//
+static OrionLdServiceTrieNode* trieNodeInsert(OrionLdServiceTrieNode* rootP, const char* path, int len)
+{
+  OrionLdServiceTrieNode*  nodeP = rootP;
+  int                      pos   = 0;
+
+  while (pos < len)
+  {
+    OrionLdServiceTrieNode* childP = nodeP->firstChildP;
+
+    while ((childP != NULL) && (childP->label[0] != path[pos]))
+      childP = childP->next;
+
+    if (childP == NULL)
+    {
+      childP             = trieNodeCreate(&path[pos], len - pos);
+      childP->next       = nodeP->firstChildP;
+      nodeP->firstChildP = childP;
+
+      return childP;
+    }
+
+    int common = 1;  // The first character has already been compared
+    while ((common < childP->labelLen) && (pos + common < len) && (childP->label[common] == path[pos + common]))
+      ++common;
+
+    if (common < childP->labelLen)
+    {
+      //
+      // Split - the tail of the label, with the children and services of the node, go to a new node
+      //
+      OrionLdServiceTrieNode* tailP = trieNodeCreate(&childP->label[common], childP->labelLen - common);
+
+      *tailP          = *childP;
+      tailP->label    = &childP->label[common];
+      tailP->labelLen = childP->labelLen - common;
+      tailP->next     = NULL;
+
+      childP->labelLen         = common;
+      childP->firstChildP      = tailP;
+      childP->serviceP         = NULL;
+      childP->wildcardServices = 0;
+    }
+
+    pos   += common;
+    nodeP  = childP;
+  }
+
+  return nodeP;
+}
+
+
+
+// -----------------------------------------------------------------------------
+//
+// orionldServiceTrieBuild -
+//
+// Services without wildcards are inserted with their entire URL path, services with wildcards only
+// with the part before the first wildcard. The rest of the matching (what comes after the first wildcard)
+// is done by orionldServiceLookup, using the fields prepared by restServicePrepare (matchForSecondWildcard).
+//
+OrionLdServiceTrieNode* orionldServiceTrieBuild(OrionLdRestServiceVector* serviceV)
+{
+  OrionLdServiceTrieNode* rootP = trieNodeCreate("", 0);
+
+  for (int sIx = 0; sIx < serviceV->services; sIx++)
+  {
+    OrionLdRestService*      serviceP = &serviceV->serviceV[sIx];
+    const char*              path     = &serviceP->url[ORION_LD_SERVICE_PREFIX_LEN];
+    OrionLdServiceTrieNode*  nodeP;
+
+    if (serviceP->wildcards == 0)
+    {
+      nodeP = trieNodeInsert(rootP, path, strlen(path));
+
+      if (nodeP->serviceP != NULL)
+        LM_W(("Duplicated URL path in service vector: '%s' - only the first one is used", serviceP->url));
+      else
+        nodeP->serviceP = serviceP;
+    }
+    else
+    {
+      nodeP = trieNodeInsert(rootP, path, serviceP->charsBeforeFirstWildcard);
+
+      if (nodeP->wildcardServices >= ORIONLD_SERVICE_TRIE_WILDCARD_SERVICES)
+        LM_X(1, ("Too many services with wildcards after '%s' - increase ORIONLD_SERVICE_TRIE_WILDCARD_SERVICES", serviceP->url));
+
+      nodeP->wildcardServiceV[nodeP->wildcardServices++] = serviceP;
+    }
+
+    LM_T(LmtUrlParse, ("Service '%s' added to the service trie", serviceP->url));
+  }
+
+  return rootP;
+}
@@ -48,6 +48,7 @@ extern "C"
 #include "orionld/common/eqForDot.h"                             // eqForDot
 #include "orionld/payloadCheck/pcheckUri.h"                      // pcheckUri
 #include "orionld/db/dbConfiguration.h"                          // dbEntityAttributeLookup, dbEntityAttributesDelete
+#include "orionld/db/dbTypeCatalogAttributesDeleted.h"           // dbTypeCatalogAttributesDeleted
 #include "orionld/context/orionldContextItemExpand.h"            // orionldContextItemExpand
 #include "orionld/serviceRoutines/orionldDeleteAttribute.h"      // Own Interface
 
@@ -63,6 +64,7 @@ bool orionldDeleteAttribute(ConnectionInfo* ciP)
   char*    attrName = orionldState.wildcard[1];
   char*    attrNameP;
   char*    detail;
+  KjNode*  dbEntityP;
 
   // Make sure the Entity ID is a valid URI
   if (pcheckUri(entityId, &detail) == false)
@@ -73,7 +75,7 @@ bool orionldDeleteAttribute(ConnectionInfo* ciP)
     return false;
   }
 
-  if (dbEntityLookup(entityId) == NULL)
+  if ((dbEntityP = dbEntityLookup(entityId)) == NULL)
   {
     LM_T(LmtService, ("Entity Not Found: %s", entityId));
     orionldErrorResponseCreate(OrionldResourceNotFound, "The requested entity has not been found. Check its id", entityId);
@@ -110,6 +112,8 @@ bool orionldDeleteAttribute(ConnectionInfo* ciP)
     return false;
   }
 
+  dbTypeCatalogAttributesDeleted(dbEntityP, attrNameV, 1);
+
   orionldState.httpStatusCode = SccNoContent;
   return true;
 }
@@ -34,6 +34,7 @@
 #include "orionld/common/orionldErrorResponse.h"                 // orionldErrorResponseCreate
 #include "orionld/payloadCheck/pcheckUri.h"                      // pcheckUri
 #include "orionld/db/dbConfiguration.h"                          // dbEntityDelete, dbEntityLookup
+#include "orionld/db/dbTypeCatalogEntityDeleted.h"               // dbTypeCatalogEntityDeleted
 #include "orionld/serviceRoutines/orionldDeleteEntity.h"         // Own Interface
 
 
@@ -44,8 +45,9 @@
 //
 bool orionldDeleteEntity(ConnectionInfo* ciP)
 {
-  char* entityId = orionldState.wildcard[0];
-  char* detail;
+  char*   entityId = orionldState.wildcard[0];
+  char*   detail;
+  KjNode* dbEntityP;
 
   // Make sure the Entity ID is a valid URI
   if (pcheckUri(entityId, &detail) == false)
@@ -55,7 +57,7 @@ bool orionldDeleteEntity(ConnectionInfo* ciP)
     return false;
   }
 
-  if (dbEntityLookup(entityId) == NULL)
+  if ((dbEntityP = dbEntityLookup(entityId)) == NULL)
   {
     orionldErrorResponseCreate(OrionldResourceNotFound, "The requested entity has not been found. Check its id", entityId);
     orionldState.httpStatusCode = SccNotFound;  // 404
@@ -69,6 +71,8 @@ bool orionldDeleteEntity(ConnectionInfo* ciP)
     return false;
   }
 
+  dbTypeCatalogEntityDeleted(dbEntityP);
+
   orionldState.httpStatusCode = SccNoContent;  // 204
 
   return true;
@@ -36,6 +36,7 @@ extern "C"
 #include "orionld/common/orionldErrorResponse.h"                 // orionldErrorResponseCreate
 #include "orionld/common/orionldState.h"                         // orionldState
 #include "orionld/context/orionldContextCacheGet.h"              // orionldContextCacheGet
+#include "orionld/context/orionldContextCacheStats.h"            // orionldContextCacheStats
 #include "orionld/serviceRoutines/orionldGetContext.h"           // Own Interface
 
 
@@ -50,5 +51,18 @@ bool orionldGetContexts(ConnectionInfo* ciP)
 
   orionldState.responseTree = orionldContextCacheGet(contextTree);
 
+  //
+  // With details=true, the response is an object with the contexts and the metrics of the context cache
+  //
+  if (orionldState.uriParams.details == true)
+  {
+    KjNode* responseP = kjObject(orionldState.kjsonP, NULL);
+
+    kjChildAdd(responseP, orionldState.responseTree);
+    kjChildAdd(responseP, orionldContextCacheStats());
+
+    orionldState.responseTree = responseP;
+  }
+
   return true;
 }
@@ -34,7 +34,7 @@ extern "C"
 
 #include "rest/ConnectionInfo.h"                                 // ConnectionInfo
 
-#include "orionld/common/orionldState.h"                         // orionldState
+#include "orionld/common/orionldState.h"                         // orionldState, tenant0, tenantList
 #include "orionld/common/eqForDot.h"                             // eqForDot
 #include "orionld/context/orionldContextItemAliasLookup.h"       // orionldContextItemAliasLookup
 #include "orionld/serviceRoutines/orionldGetDbIndexes.h"         // Own interface
@@ -47,26 +47,40 @@ extern "C"
 //
 bool orionldGetDbIndexes(ConnectionInfo* ciP)
 {
-  int items = 0;
+  int            items   = 0;
+  OrionldTenant* tenantP = &tenant0;
 
   orionldState.responseTree = kjArray(orionldState.kjsonP, NULL);
 
-  for (OrionldGeoIndex* geoNodeP = geoIndexList; geoNodeP != NULL; geoNodeP = geoNodeP->next)
+  //
+  // Loop over all tenants, the default tenant (tenant0) first
+  //
+  do
   {
-    char*   attrName  =  kaStrdup(&orionldState.kalloc, geoNodeP->attrName);
+    for (int bucket = 0; bucket < ORIONLD_TENANT_GEO_INDEX_BUCKETS; bucket++)
+    {
+      OrionldGeoIndex* geoNodeP = __atomic_load_n(&tenantP->geoIndexV[bucket], __ATOMIC_ACQUIRE);
 
-    eqForDot(attrName);
+      for (; geoNodeP != NULL; geoNodeP = geoNodeP->next)
+      {
+        char*   attrName  =  kaStrdup(&orionldState.kalloc, geoNodeP->attrName);
 
-    KjNode* objP      = kjObject(orionldState.kjsonP, NULL);
-    KjNode* tenantP   = kjString(orionldState.kjsonP, "tenant",   geoNodeP->tenant);
-    KjNode* attrNameP = kjString(orionldState.kjsonP, "attribute", orionldContextItemAliasLookup(orionldState.contextP, attrName, NULL, NULL));
+        eqForDot(attrName);
 
-    kjChildAdd(objP, tenantP);
-    kjChildAdd(objP, attrNameP);
-    kjChildAdd(orionldState.responseTree, objP);
+        KjNode* objP        = kjObject(orionldState.kjsonP, NULL);
+        KjNode* tenantNodeP = kjString(orionldState.kjsonP, "tenant",    tenantP->mongoDbName);
+        KjNode* attrNameP   = kjString(orionldState.kjsonP, "attribute", orionldContextItemAliasLookup(orionldState.contextP, attrName, NULL, NULL));
 
-    ++items;
-  }
+        kjChildAdd(objP, tenantNodeP);
+        kjChildAdd(objP, attrNameP);
+        kjChildAdd(orionldState.responseTree, objP);
+
+        ++items;
+      }
+    }
+
+    tenantP = (tenantP == &tenant0)? __atomic_load_n(&tenantList, __ATOMIC_ACQUIRE) : tenantP->listNext;
+  } while (tenantP != NULL);
 
   if (items == 0)
     orionldState.noLinkHeader = true;
@@ -30,30 +30,30 @@ extern "C"
 #include "kbase/kMacros.h"                                     // K_FT
 #include "kbase/kStringSplit.h"                                // kStringSplit
 #include "kbase/kTime.h"                                       // kTimeGet
+#include "kalloc/kaAlloc.h"                                    // kaAlloc
 #include "kalloc/kaStrdup.h"                                   // kaStrdup
 #include "kjson/kjBuilder.h"                                   // kjArray, kjChildAdd, ...
 #include "kjson/kjLookup.h"                                    // kjLookup
-#include "kjson/kjRender.h"                                    // kjFastRender
+#include "kjson/kjParse.h"                                     // kjParse
 }
 
 #include "logMsg/logMsg.h"                                     // LM_*
 #include "logMsg/traceLevels.h"                                // Lmt*
 
 #include "rest/ConnectionInfo.h"                               // ConnectionInfo
-#include "ngsi10/QueryContextRequest.h"                        // QueryContextRequest
-#include "ngsi10/QueryContextResponse.h"                       // QueryContextResponse
-#include "mongoBackend/mongoQueryContext.h"                    // mongoQueryContext
 
 #include "orionld/common/SCOMPARE.h"                           // SCOMPAREx
 #include "orionld/common/qLex.h"                               // qLex
 #include "orionld/common/qParse.h"                             // qParse
-#include "orionld/common/qTreeToBsonObj.h"                     // qTreeToBsonObj
 #include "orionld/common/orionldState.h"                       // orionldState
 #include "orionld/common/orionldErrorResponse.h"               // orionldErrorResponseCreate
 #include "orionld/common/performance.h"                        // REQUEST_PERFORMANCE
+#include "orionld/common/orionldLatency.h"                     // orionldLatencyPhaseStart, orionldLatencyPhaseEnd
 #include "orionld/common/dotForEq.h"                           // dotForEq
 #include "orionld/payloadCheck/pcheckUri.h"                    // pcheckUri
-#include "orionld/kjTree/kjTreeFromQueryContextResponse.h"     // kjTreeFromQueryContextResponse
+#include "orionld/payloadCheck/pcheckGeoQ.h"                   // pcheckGeoQ
+#include "orionld/db/dbConfiguration.h"                        // dbEntitiesQuery
+#include "orionld/db/dbModelToApiEntity.h"                     // dbModelToApiEntity
 #include "orionld/context/orionldCoreContext.h"                // orionldDefaultUrl
 #include "orionld/context/orionldContextItemExpand.h"          // orionldContextItemExpand
 #include "orionld/serviceRoutines/orionldGetEntity.h"          // orionldGetEntity - if URI param 'id' is given
@@ -61,14 +61,6 @@ extern "C"
 
 
 
-// -----------------------------------------------------------------------------
-//
-// FIXME - put dmodelEntity in its own module (perhaps even its own library ...)
-//
-extern KjNode* dmodelEntity(KjNode* dbEntityP, bool sysAttrs, OrionldProblemDetails* pdP);
-
-
-
 // ----------------------------------------------------------------------------
 //
 // geoPropertyInAttrs -
@@ -86,6 +78,336 @@ static bool geoPropertyInAttrs(char** attrsV, int attrsCount, const char* geoPro
 
 
 
+// -----------------------------------------------------------------------------
+//
+// entityInfoArrayCreate - the entity selection part of the query, same format as 'entities' in POST Query
+//
+// Lists of entity ids and lists of entity types are mutually exclusive (checked by the caller).
+// An item without id, idPattern and type matches all entities.
+//
+static KjNode* entityInfoArrayCreate(char** idV, int ids, char* idPattern, char** typeV, int types)
+{
+  KjNode* arrayP = kjArray(orionldState.kjsonP, NULL);
+  int     items  = (ids > 1)? ids : types;
+
+  if (items == 0)
+    items = 1;
+
+  for (int ix = 0; ix < items; ix++)
+  {
+    KjNode* entityInfoP = kjObject(orionldState.kjsonP, NULL);
+    KjNode* nodeP;
+
+    if (ids > 0)
+    {
+      nodeP = kjString(orionldState.kjsonP, "id", idV[(ids > 1)? ix : 0]);
+      kjChildAdd(entityInfoP, nodeP);
+    }
+    else if (idPattern != NULL)
+    {
+      nodeP = kjString(orionldState.kjsonP, "idPattern", idPattern);
+      kjChildAdd(entityInfoP, nodeP);
+    }
+
+    if (types > 0)
+    {
+      nodeP = kjString(orionldState.kjsonP, "type", typeV[(types > 1)? ix : 0]);
+      kjChildAdd(entityInfoP, nodeP);
+    }
+
+    kjChildAdd(arrayP, entityInfoP);
+  }
+
+  return arrayP;
+}
+
+
+
+// -----------------------------------------------------------------------------
+//
+// geoqCreate - the geo-query part of the query, same format as 'geoQ' in POST Query
+//
+// The URI param 'coordinates' is a JSON array in NGSI-LD, but the brackets are accepted as optional,
+// the way the Scope based implementation accepted them.
+//
+static KjNode* geoqCreate(char* geometry, char* georel, char* coordinates)
+{
+  KjNode* geoqP   = kjObject(orionldState.kjsonP, NULL);
+  int     len     = strlen(coordinates);
+  char*   coordsV = kaAlloc(&orionldState.kalloc, len + 3);
+  KjNode* nodeP;
+
+  if (coordinates[0] == '[')
+    strcpy(coordsV, coordinates);
+  else
+    snprintf(coordsV, len + 3, "[%s]", coordinates);
+
+  KjNode* coordinatesP = kjParse(orionldState.kjsonP, coordsV);
+
+  if ((coordinatesP == NULL) || (coordinatesP->type != KjArray))
+  {
+    LM_W(("Bad Input (invalid value for URI parameter 'coordinates')"));
+    orionldErrorResponseCreate(OrionldBadRequestData, "Invalid value for URI parameter /coordinates/", coordinates);
+    orionldState.httpStatusCode = SccBadRequest;
+    return NULL;
+  }
+
+  nodeP = kjString(orionldState.kjsonP, "geometry", geometry);
+  kjChildAdd(geoqP, nodeP);
+
+  coordinatesP->name = (char*) "coordinates";
+  kjChildAdd(geoqP, coordinatesP);
+
+  nodeP = kjString(orionldState.kjsonP, "georel", georel);
+  kjChildAdd(geoqP, nodeP);
+
+  if (pcheckGeoQ(geoqP, false) == false)
+    return NULL;
+
+  //
+  // The geo-property defaults to "location" in the DB layer.
+  // Added after pcheckGeoQ as the name must be expanded and have its dots replaced by '='.
+  //
+  char* geoproperty = orionldState.uriParams.geoproperty;
+
+  if ((geoproperty != NULL) && (strcmp(geoproperty, "location") != 0))
+  {
+    geoproperty = orionldContextItemExpand(orionldState.contextP, geoproperty, true, NULL);
+    geoproperty = kaStrdup(&orionldState.kalloc, geoproperty);
+    dotForEq(geoproperty);
+
+    nodeP = kjString(orionldState.kjsonP, "geoproperty", geoproperty);
+    kjChildAdd(geoqP, nodeP);
+  }
+
+  return geoqP;
+}
+
+
+
+// -----------------------------------------------------------------------------
+//
+// orionldGetEntitiesNative -
+//
+// Query Entities directly on the database model (dbEntitiesQuery), with no detour via mongoBackend.
+// The entities from the database are transformed into API entities by dbModelToApiEntity,
+// the same function that is used by Retrieve Entity.
+//
+// The URI parameters have already been checked for consistency by orionldGetEntities.
+//
+static bool orionldGetEntitiesNative(ConnectionInfo* ciP, char* id, char* idPattern, char* type, char* q, char* attrs, char* geometry, char* georel, char* coordinates)
+{
+  char*   idVector[32];
+  char*   typeVector[32];
+  int     idVecItems     = 0;
+  int     typeVecItems   = 0;
+  char*   detail;
+  char*   attrsV[100];
+  char*   eqAttrsV[101];
+  int     attrsCount     = 0;
+  QNode*  qTree          = NULL;
+  KjNode* geoqP          = NULL;
+  KjNode* attrsP         = NULL;
+  bool    keyValues      = orionldState.uriParamOptions.keyValues;
+  bool    sysAttrs       = orionldState.uriParamOptions.sysAttrs;
+
+  if (id != NULL)
+    idVecItems = kStringSplit(id, ',', (char**) idVector, sizeof(idVector) / sizeof(idVector[0]));
+
+  if (type != NULL)
+    typeVecItems = kStringSplit(type, ',', (char**) typeVector, sizeof(typeVector) / sizeof(typeVector[0]));
+
+  //
+  // ID-list and Type-list at the same time is not supported
+  //
+  if ((idVecItems > 1) && (typeVecItems > 1))
+  {
+    LM_W(("Bad Input (URI params /id/ and /type/ are both lists - Not Permitted)"));
+    orionldErrorResponseCreate(OrionldBadRequestData, "URI params /id/ and /type/ are both lists", "Not Permitted");
+    orionldState.httpStatusCode = SccBadRequest;
+    return false;
+  }
+
+  for (int ix = 0; ix < idVecItems; ix++)
+  {
+    if (pcheckUri(idVector[ix], &detail) == false)
+    {
+      LM_W(("Bad Input (Invalid Entity ID - Not a URL nor a URN)"));
+      orionldErrorResponseCreate(OrionldBadRequestData, "Invalid Entity ID", "Not a URL nor a URN");  // FIXME: Include 'detail' and name (id array item)
+      orionldState.httpStatusCode = SccBadRequest;
+      return false;
+    }
+  }
+
+  for (int ix = 0; ix < typeVecItems; ix++)
+  {
+    typeVector[ix] = orionldContextItemExpand(orionldState.contextP, typeVector[ix], true, NULL);
+  }
+
+  if (attrs != NULL)
+  {
+    attrsCount = kStringSplit(attrs, ',', (char**) attrsV, sizeof(attrsV) / sizeof(attrsV[0]));
+    attrsP     = kjArray(orionldState.kjsonP, NULL);
+
+    for (int ix = 0; ix < attrsCount; ix++)
+    {
+      if ((strcmp(attrsV[ix], "location")         != 0) &&
+          (strcmp(attrsV[ix], "observationSpace") != 0) &&
+          (strcmp(attrsV[ix], "operationSpace")   != 0))
+      {
+        attrsV[ix] = orionldContextItemExpand(orionldState.contextP, attrsV[ix], true, NULL);
+      }
+
+      KjNode* attrNameP = kjString(orionldState.kjsonP, NULL, attrsV[ix]);
+      kjChildAdd(attrsP, attrNameP);
+
+      eqAttrsV[ix] = kaStrdup(&orionldState.kalloc, attrsV[ix]);
+      dotForEq(eqAttrsV[ix]);
+    }
+  }
+  eqAttrsV[attrsCount] = NULL;
+
+  if (q != NULL)
+  {
+    char*   title;
+    QNode*  lexList;
+
+    if ((lexList = qLex(q, &title, &detail)) == NULL)
+    {
+      LM_W(("Bad Input (qLex: %s: %s)", title, detail));
+      orionldErrorResponseCreate(OrionldBadRequestData, title, detail);
+      orionldState.httpStatusCode = SccBadRequest;
+      return false;
+    }
+
+    if ((qTree = qParse(lexList, &title, &detail)) == NULL)
+    {
+      LM_W(("Bad Input (qParse: %s: %s)", title, detail));
+      orionldErrorResponseCreate(OrionldBadRequestData, title, detail);
+      orionldState.httpStatusCode = SccBadRequest;
+      return false;
+    }
+  }
+
+  if (geometry != NULL)
+  {
+    if ((geoqP = geoqCreate(geometry, georel, coordinates)) == NULL)
+      return false;
+  }
+
+  KjNode* entityInfoArrayP = entityInfoArrayCreate(idVector, idVecItems, idPattern, typeVector, typeVecItems);
+  int     count            = 0;
+  int*    countP           = (orionldState.uriParams.count == true)? &count : NULL;
+
+#ifdef REQUEST_PERFORMANCE
+  kTimeGet(&timestamps.dbStart);
+#endif
+  orionldLatencyPhaseStart(LP_DB);
+  KjNode* dbEntityArray = dbEntitiesQuery(entityInfoArrayP, attrsP, qTree, geoqP, orionldState.uriParams.limit, orionldState.uriParams.offset, countP);
+#ifdef REQUEST_PERFORMANCE
+  kTimeGet(&timestamps.dbEnd);
+#endif
+  orionldLatencyPhaseEnd(LP_DB);
+
+  if (dbEntityArray == NULL)
+  {
+    //
+    // If the db layer already created an error response (e.g. an invalid 'q'), it's a Bad Request.
+    // If not, the query itself failed - that's an Internal Error, not an empty result
+    //
+    if (orionldState.responseTree != NULL)
+      orionldState.httpStatusCode = SccBadRequest;
+    else
+    {
+      LM_E(("Database Error (dbEntitiesQuery failed)"));
+      orionldErrorResponseCreate(OrionldInternalError, "Database Error", "error querying the database for entities");
+      orionldState.httpStatusCode = SccReceiverInternalError;
+    }
+
+    return false;
+  }
+
+  //
+  // For Accept: application/geo+json, the geo-property is needed even if not asked for in 'attrs'.
+  // dbModelToApiEntity gives its value back (in geoPropertyP) and it is kept in orionldState.geoPropertyNodes,
+  // for kjGeojsonEntitiesTransform to find it, under the short name of the geo-property.
+  //
+  const char* geometryProperty  = (orionldState.uriParams.geometryProperty == NULL)? "location" : orionldState.uriParams.geometryProperty;
+  char*       geoPropertyName   = NULL;
+  bool        geoPropertyNodes  = false;
+
+  if (orionldState.acceptGeojson == true)
+  {
+    geoPropertyName = (char*) geometryProperty;
+
+    if ((strcmp(geometryProperty, "location")         != 0) &&
+        (strcmp(geometryProperty, "observationSpace") != 0) &&
+        (strcmp(geometryProperty, "operationSpace")   != 0))
+    {
+      geoPropertyName = orionldContextItemExpand(orionldState.contextP, geometryProperty, true, NULL);
+    }
+
+    geoPropertyName = kaStrdup(&orionldState.kalloc, geoPropertyName);
+    dotForEq(geoPropertyName);
+
+    if ((attrsCount > 0) && (geoPropertyInAttrs(eqAttrsV, attrsCount, geoPropertyName) == false))
+    {
+      orionldState.geoPropertyNodes = kjArray(orionldState.kjsonP, NULL);
+      geoPropertyNodes              = true;
+    }
+  }
+
+  orionldState.httpStatusCode = SccOk;
+  orionldState.responseTree   = kjArray(orionldState.kjsonP, NULL);
+
+  if (dbEntityArray != NULL)
+  {
+    for (KjNode* dbEntityP = dbEntityArray->value.firstChildP; dbEntityP != NULL; dbEntityP = dbEntityP->next)
+    {
+      KjNode* geoPropertyP;
+      bool    geoPropertyMissing;
+      KjNode* entityP = dbModelToApiEntity(dbEntityP, eqAttrsV, false, sysAttrs, keyValues, geoPropertyName, &geoPropertyP, &geoPropertyMissing);
+
+      if (entityP == NULL)
+        continue;  // dbModelToApiEntity has already logged the error
+
+      kjChildAdd(orionldState.responseTree, entityP);
+
+      if ((geoPropertyNodes == true) && (geoPropertyP != NULL))
+      {
+        KjNode* entityIdP = kjLookup(entityP, "id");
+
+        if (entityIdP != NULL)
+        {
+          KjNode* nodeP = kjObject(orionldState.kjsonP, NULL);
+
+          // The geo-property is not part of the response entity, so its value node can be reused as is
+          kjChildAdd(nodeP, kjString(orionldState.kjsonP, "id", entityIdP->value.s));
+          geoPropertyP->name = (char*) geometryProperty;
+          kjChildAdd(nodeP, geoPropertyP);
+          kjChildAdd(orionldState.geoPropertyNodes, nodeP);
+        }
+      }
+    }
+  }
+
+  if (orionldState.responseTree->value.firstChildP == NULL)
+    orionldState.noLinkHeader = true;
+
+  // Add "count" if asked for
+  if (countP != NULL)
+  {
+    char cV[32];
+    snprintf(cV, sizeof(cV), "%d", *countP);
+    ciP->httpHeader.push_back("NGSILD-Results-Count");
+    ciP->httpHeaderValue.push_back(cV);
+  }
+
+  return true;
+}
+
+
+
 // ----------------------------------------------------------------------------
 //
 // orionldGetEntities -
@@ -119,29 +441,15 @@ static bool geoPropertyInAttrs(char** attrsV, int attrsCount, const char* geoPro
 //
 bool orionldGetEntities(ConnectionInfo* ciP)
 {
-  char*                 id             = orionldState.uriParams.id;
-  char*                 type           = orionldState.uriParams.type;
-  char*                 idPattern      = orionldState.uriParams.idPattern;
-  char*                 q              = orionldState.uriParams.q;
-  char*                 attrs          = orionldState.uriParams.attrs;
-
-  char*                 geometry       = orionldState.uriParams.geometry;
-  char*                 georel         = orionldState.uriParams.georel;
-  char*                 coordinates    = orionldState.uriParams.coordinates;
-
-  char*                 idString       = (id != NULL)? id      : idPattern;
-  const char*           isIdPattern    = (id != NULL)? "false" : "true";
-  bool                  isTypePattern  = (type != NULL)? false   : true;
-  EntityId*             entityIdP;
-  char*                 typeExpanded   = NULL;
-  char*                 detail;
-  char*                 idVector[32];    // Is 32 a good limit?
-  char*                 typeVector[32];  // Is 32 a good limit?
-  int                   idVecItems     = (int) sizeof(idVector) / sizeof(idVector[0]);
-  int                   typeVecItems   = (int) sizeof(typeVector) / sizeof(typeVector[0]);
-  bool                  keyValues      = orionldState.uriParamOptions.keyValues;
-  QueryContextRequest   mongoRequest;
-  QueryContextResponse  mongoResponse;
+  char*  id           = orionldState.uriParams.id;
+  char*  type         = orionldState.uriParams.type;
+  char*  idPattern    = orionldState.uriParams.idPattern;
+  char*  q            = orionldState.uriParams.q;
+  char*  attrs        = orionldState.uriParams.attrs;
+
+  char*  geometry     = orionldState.uriParams.geometry;
+  char*  georel       = orionldState.uriParams.georel;
+  char*  coordinates  = orionldState.uriParams.coordinates;
 
   //
   // FIXME: Move all this to orionldMhdConnectionInit()
@@ -271,340 +579,7 @@ bool orionldGetEntities(ConnectionInfo* ciP)
       orionldState.httpStatusCode = SccBadRequest;
       return false;
     }
-
-    Scope*       scopeP = new Scope(SCOPE_TYPE_LOCATION, "");
-    std::string  errorString;
-
-    //
-    // In APIv2, the vector is a string without [], in NGSI-LD, [] are present. Must remove ...
-    //
-    if (coordinates[0] == '[')
-    {
-      ++coordinates;
-
-      int len = strlen(coordinates);
-      if (coordinates[len - 1] == ']')
-        coordinates[len - 1] = 0;
-    }
-
-    if (scopeP->fill(ciP->apiVersion, geometry, coordinates, georel, &errorString) != 0)
-    {
-      scopeP->release();
-      delete scopeP;
-
-      LM_E(("Geo: Scope::fill failed"));
-      orionldErrorResponseCreate(OrionldInternalError, "Invalid Geometry", errorString.c_str());
-      orionldState.httpStatusCode = SccBadRequest;
-      return false;
-    }
-
-    LM_E(("Geo: Scope::fill OK"));
-    mongoRequest.restriction.scopeVector.push_back(scopeP);
   }
 
-  if (idString == NULL)
-  {
-    idString    = (char*) ".*";
-    isIdPattern = (char*) "true";
-  }
-
-  if (type == NULL)  // No type given - match all types
-  {
-    type          = (char*) ".*";
-    isTypePattern = true;
-    typeVecItems  = 0;  // Just to avoid entering the "if (typeVecItems == 1)"
-  }
-  else
-    typeVecItems = kStringSplit(type, ',', (char**) typeVector, typeVecItems);
-
-  idVecItems   = kStringSplit(id, ',', (char**) idVector, idVecItems);
-
-  //
-  // ID-list and Type-list at the same time is not supported
-  //
-  if ((idVecItems > 1) && (typeVecItems > 1))
-  {
-    LM_W(("Bad Input (URI params /id/ and /type/ are both lists - Not Permitted)"));
-    orionldErrorResponseCreate(OrionldBadRequestData, "URI params /id/ and /type/ are both lists", "Not Permitted");
-    return false;
-  }
-
-  //
-  // Make sure all IDs are valid URIs
-  //
-  for (int ix = 0; ix < idVecItems; ix++)
-  {
-    if (pcheckUri(idVector[ix], &detail) == false)
-    {
-      LM_W(("Bad Input (Invalid Entity ID - Not a URL nor a URN)"));
-      orionldErrorResponseCreate(OrionldBadRequestData, "Invalid Entity ID", "Not a URL nor a URN");  // FIXME: Include 'detail' and name (id array item)
-      return false;
-    }
-  }
-
-  if (typeVecItems == 1)  // type needs to be modified according to @context
-  {
-    // FIXME:
-    //   No expansion desired if the type is already FQN - however, this may
-    //   null out prefix expansion so, I'veremoved the call to pcheckUri() and
-    //   I always expand ...
-    //
-    type = orionldContextItemExpand(orionldState.contextP, type, true, NULL);
-
-    isTypePattern = false;  // Just in case ...
-  }
-
-  if (idVecItems > 1)  // A list of Entity IDs
-  {
-    for (int ix = 0; ix < idVecItems; ix++)
-    {
-      entityIdP = new EntityId(idVector[ix], type, "false", isTypePattern);
-      mongoRequest.entityIdVector.push_back(entityIdP);
-    }
-  }
-  else if (typeVecItems > 1)  // A list of Entity Types
-  {
-    for (int ix = 0; ix < typeVecItems; ix++)
-    {
-      if (pcheckUri(typeVector[ix], &detail) == false)
-        typeExpanded = orionldContextItemExpand(orionldState.contextP, typeVector[ix], true, NULL);
-      else
-        typeExpanded = typeVector[ix];
-
-      entityIdP = new EntityId(idString, typeExpanded, isIdPattern, false);
-      mongoRequest.entityIdVector.push_back(entityIdP);
-    }
-  }
-  else  // Definitely no lists in EntityId id/type
-  {
-    entityIdP = new EntityId(idString, type, isIdPattern, isTypePattern);
-    mongoRequest.entityIdVector.push_back(entityIdP);
-  }
-
-  char* attrsV[100];
-  int   attrsCount = 0;
-
-  if (attrs != NULL)
-  {
-    attrsCount = (int) sizeof(attrsV) / sizeof(attrsV[0]);
-
-    attrsCount = kStringSplit(attrs, ',', (char**) attrsV, attrsCount);
-
-    for (int ix = 0; ix < attrsCount; ix++)
-    {
-      if ((strcmp(attrsV[ix], "location")         != 0) &&
-          (strcmp(attrsV[ix], "observationSpace") != 0) &&
-          (strcmp(attrsV[ix], "operationSpace")   != 0))
-      {
-        attrsV[ix] = orionldContextItemExpand(orionldState.contextP, attrsV[ix], true, NULL);
-      }
-
-      mongoRequest.attributeList.push_back(attrsV[ix]);
-    }
-  }
-
-  if (q != NULL)
-  {
-    char*  title;
-    char*  detail;
-    QNode* lexList;
-    QNode* qTree;
-
-    if ((lexList = qLex(q, &title, &detail)) == NULL)
-    {
-      LM_W(("Bad Input (qLex: %s: %s)", title, detail));
-      orionldErrorResponseCreate(OrionldBadRequestData, title, detail);
-      mongoRequest.release();
-      return false;
-    }
-
-    if ((qTree = qParse(lexList, &title, &detail)) == NULL)
-    {
-      LM_W(("Bad Input (qParse: %s: %s)", title, detail));
-      orionldErrorResponseCreate(OrionldBadRequestData, title, detail);
-      mongoRequest.release();
-      return false;
-    }
-
-
-    //
-    // FIXME: this part about Q-Filter depends on the database and must be moved to
-    //        the DB layer
-    //
-    orionldState.qMongoFilterP = new mongo::BSONObj;
-
-    mongo::BSONObjBuilder objBuilder;
-    if (qTreeToBsonObj(qTree, &objBuilder, &title, &detail) == false)
-    {
-      LM_W(("Bad Input (qTreeToBsonObj: %s: %s)", title, detail));
-      orionldErrorResponseCreate(OrionldBadRequestData, title, detail);
-      mongoRequest.release();
-      return false;
-    }
-
-    *orionldState.qMongoFilterP = objBuilder.obj();
-  }
-
-
-  //
-  // Call mongoBackend
-  //
-  long long   count;
-  long long*  countP = (orionldState.uriParams.count == true)? &count : NULL;
-
-  //
-  // Special case:
-  // If count is asked for and limit == 0 - just do the count query
-  //
-  if ((countP != NULL) && (orionldState.uriParams.limit == 0))
-    orionldState.onlyCount = true;
-
-#ifdef REQUEST_PERFORMANCE
-  kTimeGet(&timestamps.dbStart);
-#endif
-  orionldState.httpStatusCode = mongoQueryContext(&mongoRequest,
-                                                  &mongoResponse,
-                                                  orionldState.tenant,
-                                                  ciP->servicePathV,
-                                                  ciP->uriParam,
-                                                  ciP->uriParamOptions,
-                                                  countP,
-                                                  ciP->apiVersion);
-#ifdef REQUEST_PERFORMANCE
-  kTimeGet(&timestamps.dbEnd);
-#endif
-
-  //
-  // Transform QueryContextResponse to KJ-Tree
-  //
-  orionldState.httpStatusCode = SccOk;  // FIXME: What about the response from mongoQueryContext???
-
-  orionldState.responseTree = kjTreeFromQueryContextResponse(false, NULL, keyValues, &mongoResponse);
-
-  //
-  // Work-around for Accept: application/geo+json
-  //
-  // If attrs is used and the Geo-Property is not part of the attrs list, then the GeoProperty will be set to NULL
-  // even though it may exist.
-  //
-  // As it will be really hard to modify mongoBackend to include that attribute that is not asked for (in URI param 'attrs'),
-  // a workaround would be to perform an extra query:
-  //
-  // if (Accept: application/geo+json) && (URI param attrs is in use)
-  //   Get the name of the geo-property (default: location)
-  //   If geo-property is NOT in 'attrs' URI param
-  //     Prepare a query for all entities in orionldState.responseTree, for:
-  //     * _id.id and
-  //     * geo-property
-  //   Now go over the tree (orionldState.responseTree) and replace
-  //     "geometry": null
-  //   with whatever was found in this second query to mongo
-  //
-  if ((orionldState.acceptGeojson) && (attrsCount > 0) && (orionldState.responseTree->type == KjArray))
-  {
-    const char* geoPropertyName        = (orionldState.uriParams.geometryProperty == NULL)? "location" : orionldState.uriParams.geometryProperty;
-    bool        geoPropertyNameInAttrs = geoPropertyInAttrs(attrsV, attrsCount, geoPropertyName);
-
-    LM_TMP(("GEO: geo+json and attr URI param ..."));
-    LM_TMP(("GEO: geo-property is: '%s'", geoPropertyName));
-
-    int ix = 0;
-    while (ix < attrsCount)
-    {
-      if (strcmp(geoPropertyName, attrsV[ix]) == 0)
-      {
-        geoPropertyNameInAttrs = true;
-        LM_TMP(("GEO: URI-param attrs[%d]: '%s' (this is the geometryProperty URL-param - we are done here)", ix, attrsV[ix]));
-      }
-      else
-        LM_TMP(("GEO: URI-param attrs[%d]: '%s'", ix, attrsV[ix]));
-
-      ++ix;
-    }
-
-    if (geoPropertyNameInAttrs == false)
-    {
-      int entities = 0;
-
-      // Count the number of entities of the response
-      for (KjNode* entityP = orionldState.responseTree->value.firstChildP; entityP != NULL; entityP = entityP->next)
-      {
-        ++entities;
-      }
-
-      // Allocate array of entity ids
-      char** entityArray = (char**) kaAlloc(&orionldState.kalloc, sizeof(KjNode*) * entities);
-      int    entityIx    = 0;
-
-      // Populate the array with all entity ids
-      LM_TMP(("GEO: %d matching entities - create an array and then query over id in 'that id-array' AND attribute '%s' exists", entities, geoPropertyName));
-      for (KjNode* entityP = orionldState.responseTree->value.firstChildP; entityP != NULL; entityP = entityP->next)
-      {
-        KjNode* idP = kjLookup(entityP, "id");
-
-        if (idP != NULL)
-        {
-          LM_TMP(("GEO: Entity '%s'", idP->value.s));
-          entityArray[entityIx++] = idP->value.s;
-        }
-      }
-
-      // DB Query, to extract the needed info from the DB
-      char* geoPropertyNameExpanded = (char*) geoPropertyName;
-      LM_TMP(("GEO: geoPropertyName == '%s' (before expansion)", geoPropertyNameExpanded));
-
-      if ((strcmp(geoPropertyName, "location")         != 0) &&
-          (strcmp(geoPropertyName, "observationSpace") != 0) &&
-          (strcmp(geoPropertyName, "operationSpace")   != 0))
-      {
-        geoPropertyNameExpanded = orionldContextItemExpand(orionldState.contextP, geoPropertyName, true, NULL);
-
-        geoPropertyNameExpanded = kaStrdup(&orionldState.kalloc, geoPropertyNameExpanded);
-        dotForEq(geoPropertyNameExpanded);
-      }
-      LM_TMP(("GEO: geoPropertyName == '%s' (after expansion)", geoPropertyNameExpanded));
-
-      KjNode* dbEntityArray = dbEntitiesAttributeLookup(entityArray, entities, geoPropertyNameExpanded);
-      if (dbEntityArray != NULL)
-      {
-        orionldState.geoPropertyNodes = kjArray(orionldState.kjsonP, NULL);
-
-        // Transform the Database model into a "valid" NGSI-LD tree
-        char buf[1024 * 4];  // DEBUG
-        for (KjNode* dbEntityP = dbEntityArray->value.firstChildP; dbEntityP != NULL; dbEntityP = dbEntityP->next)
-        {
-          OrionldProblemDetails pd;
-          kjFastRender(orionldState.kjsonP, dbEntityP, buf, sizeof(buf));
-          LM_TMP(("GEO: dbEntityP: %s", buf));
-          KjNode*               entityP = dmodelEntity(dbEntityP, false, &pd);
-          LM_TMP(("GEO: dmodelEntity returned an entity at %p", entityP));
-          kjFastRender(orionldState.kjsonP, entityP, buf, sizeof(buf));
-          LM_TMP(("GEO: ********************* entityP: %s", buf));
-          if (entityP != NULL)
-            kjChildAdd(orionldState.geoPropertyNodes, entityP);
-        }
-
-        // <DEBUG>
-        kjFastRender(orionldState.kjsonP, orionldState.geoPropertyNodes, buf, sizeof(buf));
-        LM_TMP(("GEO: orionldState.geoPropertyNodes: %s", buf));
-        // </DEBUG>
-      }
-    }
-  }
-
-  if (orionldState.responseTree->value.firstChildP == NULL)
-    orionldState.noLinkHeader = true;
-
-  // Add "count" if asked for
-  if (countP != NULL)
-  {
-    char cV[32];
-    snprintf(cV, sizeof(cV), "%llu", *countP);
-    ciP->httpHeader.push_back("NGSILD-Results-Count");
-    ciP->httpHeaderValue.push_back(cV);
-  }
-
-  mongoRequest.release();
-
-  return true;
+  return orionldGetEntitiesNative(ciP, id, idPattern, type, q, attrs, geometry, georel, coordinates);
 }
@@ -22,6 +22,8 @@
 *
 * Author: Ken Zangelin
 */
+#include <strings.h>                                             // bzero
+
 extern "C"
 {
 #include "kbase/kMacros.h"                                       // K_VEC_SIZE, K_FT
@@ -30,6 +32,7 @@ extern "C"
 #include "kbase/kStringArrayLookup.h"                            // kStringArrayLookup
 #include "kbase/kTime.h"                                         // kTimeGet
 #include "kalloc/kaStrdup.h"                                     // kaStrdup
+#include "kalloc/kaAlloc.h"                                      // kaAlloc
 #include "kjson/KjNode.h"                                        // KjNode
 #include "kjson/kjBuilder.h"                                     // kjObject, ...
 #include "kjson/kjParse.h"                                       // kjParse
@@ -44,9 +47,11 @@ extern "C"
 #include "orionld/common/SCOMPARE.h"                             // SCOMPAREx
 #include "orionld/common/orionldState.h"                         // orionldState
 #include "orionld/common/orionldErrorResponse.h"                 // orionldErrorResponseCreate
-#include "orionld/common/orionldRequestSend.h"                   // orionldRequestSend
+#include "orionld/common/orionldRequestSend.h"                   // OrionldHttpHeader
+#include "orionld/common/orionldRequestSendMulti.h"              // orionldRequestSendMulti
 #include "orionld/common/dotForEq.h"                             // dotForEq
 #include "orionld/common/performance.h"                          // REQUEST_PERFORMANCE
+#include "orionld/common/orionldLatency.h"                       // orionldLatencyPhaseStart, orionldLatencyPhaseEnd
 #include "orionld/payloadCheck/pcheckUri.h"                      // pcheckUri
 #include "orionld/context/orionldContextItemAliasLookup.h"       // orionldContextItemAliasLookup
 #include "orionld/context/orionldContextItemExpand.h"            // orionldContextItemExpand
@@ -73,7 +78,7 @@ static void attrsToAlias(OrionldContext* contextP, char* attrV[], int attrs)
 
 // -----------------------------------------------------------------------------
 //
-// orionldForwardGetEntity2 -
+// orionldForwardGetEntityPart - prepare the forwarded request for one matching registration
 //
 // An NGSI-LD Registration looks like this:
 //
@@ -154,19 +159,21 @@ static void attrsToAlias(OrionldContext* contextP, char* attrV[], int attrs)
 //   YES                                               YES                                    "attrs" URI param is a merge between the two
 //
 //
-static KjNode* orionldForwardGetEntityPart(KjNode* registrationP, char* entityId, char** uriParamAttrV, int uriParamAttrs)
+static bool orionldForwardGetEntityPart(OrionldMultiRequest* reqP, KjNode* registrationP, char* entityId, char** uriParamAttrV, int uriParamAttrs)
 {
-  char            host[128]                  = { 0 };
-  char            protocol[32]               = { 0 };
+  char*           host                       = (char*) kaAlloc(&orionldState.kalloc, 128);
+  char*           protocol                   = (char*) kaAlloc(&orionldState.kalloc, 32);
   unsigned short  port                       = 0;
   char*           uriDir                     = (char*) "";
   char*           detail;
-  KjNode*         entityP                    = NULL;
   char*           registrationAttrV[100];
   int             registrationAttrs          = 0;
 
-  if (kjTreeRegistrationInfoExtract(registrationP, protocol, sizeof(protocol), host, sizeof(host), &port, &uriDir, registrationAttrV, 100, &registrationAttrs, &detail) == false)
-    return NULL;
+  host[0]     = 0;
+  protocol[0] = 0;
+
+  if (kjTreeRegistrationInfoExtract(registrationP, protocol, 32, host, 128, &port, &uriDir, registrationAttrV, 100, &registrationAttrs, &detail) == false)
+    return false;
 
   char* newUriParamAttrsString = (char*) kaAlloc(&orionldState.kalloc, 200 * 30);  // Assuming max 30 attrs, max 200 chars per attr ...
 
@@ -231,20 +238,115 @@ static KjNode* orionldForwardGetEntityPart(KjNode* registrationP, char* entityId
       snprintf(urlPath, size, "%s/ngsi-ld/v1/entities/%s", uriDirP, entityId);
   }
 
+  reqP->protocol = protocol;
+  reqP->ip       = host;
+  reqP->port     = port;
+  reqP->verb     = "GET";
+  reqP->urlPath  = urlPath;
+
+  return true;
+}
+
+
+
+// -----------------------------------------------------------------------------
+//
+// ForwardGetEntityMerge - the state shared by the responses to the forwarded requests of one GET /entities/{entityId}
+//
+typedef struct ForwardGetEntityMerge
+{
+  KjNode*  responseP;
+  bool     needEntityType;
+} ForwardGetEntityMerge;
+
+
+
+// -----------------------------------------------------------------------------
+//
+// orionldForwardGetEntityMerge - merge the response of one forwarded request into the response entity
+//
+// Called by orionldRequestSendMulti as soon as the response of a Context Provider has arrived.
+//
+static void orionldForwardGetEntityMerge(OrionldMultiRequest* reqP)
+{
+  ForwardGetEntityMerge* mergeP = (ForwardGetEntityMerge*) reqP->userP;
+
+  if (reqP->ok == false)
+  {
+    LM_E(("Internal Error (forwarded request to %s failed: %s)", reqP->url, reqP->detail));
+    return;
+  }
+
+  KjNode* partTree = kjParse(orionldState.kjsonP, reqP->rBuf.buf);
+
+  if (partTree == NULL)
+  {
+    LM_W(("Garbage from Context Provider %s (unable to parse the response to a forwarded GET /entities/{EID})", reqP->url));
+    return;
+  }
+
+  if (partTree->type != KjObject)
+  {
+    LM_W(("Garbage from Context Provider (the response to a forwarded GET /entities/{EID} must be a JSON object - not %s)",
+          kjValueType(partTree->type)));
+    return;
+  }
+
   //
-  // Sending the Forwarded request
+  // Move all attributes from 'partTree' into the response entity
   //
-  orionldState.httpResponse.buf       = NULL;  // orionldRequestSend allocates
-  orionldState.httpResponse.size      = 0;
-  orionldState.httpResponse.used      = 0;
-  orionldState.httpResponse.allocated = false;
+  KjNode* nodeP = partTree->value.firstChildP;
+  KjNode* next;
+
+  while (nodeP != NULL)
+  {
+    next = nodeP->next;
 
-  bool tryAgain = false;
-  bool reqOk;
-  bool downloadFailed;
+    if (SCOMPARE3(nodeP->name, 'i', 'd', 0) || SCOMPARE4(nodeP->name, '@', 'i', 'd', 0))
+    {
+      // Do Nothing
+    }
+    else if (SCOMPARE5(nodeP->name, 't', 'y', 'p', 'e', 0) || SCOMPARE6(nodeP->name, '@', 't', 'y', 'p', 'e', 0))
+    {
+      if (mergeP->needEntityType)
+      {
+        //
+        // We're taking the entity::type from the Response to the forwarded request
+        // because no local entity was found.
+        // It could also be taken from the registration.
+        //
+        kjChildAdd(mergeP->responseP, nodeP);
+        mergeP->needEntityType = false;
+      }
+    }
+    else
+      kjChildAdd(mergeP->responseP, nodeP);
+
+    nodeP = next;
+  }
+}
+
+
+
+// -----------------------------------------------------------------------------
+//
+// orionldForwardGetEntity -
+//
+// All matching Context Providers are queried in parallel, under one common deadline (-forwardTimeout).
+// The responses are merged into the response entity in the order they arrive.
+//
+static KjNode* orionldForwardGetEntity(ConnectionInfo* ciP, char* entityId, KjNode* regArrayP, KjNode* responseP, bool needEntityType, char** attrsV, int attrs)
+{
+  int regs = 0;
+
+  for (KjNode* regP = regArrayP->value.firstChildP; regP != NULL; regP = regP->next)
+    ++regs;
+
+  if (regs == 0)
+    return responseP;
 
   //
-  // Prepare HTTP headers
+  // Prepare HTTP headers - the same for all forwarded requests
   //
   OrionldHttpHeader headerV[5];
   int               header = 0;
@@ -272,83 +374,46 @@ static KjNode* orionldForwardGetEntityPart(KjNode* registrationP, char* entityId
 
   headerV[header].type = HttpHeaderNone;
 
+  char  link[512];
+  char* linkP = NULL;
+
   if (orionldState.linkHttpHeaderPresent)
   {
-    char link[512];
-
     snprintf(link, sizeof(link), "<%s>; rel=\"http://www.w3.org/ns/json-ld#context\"; type=\"application/ld+json\"", orionldState.link);
-    reqOk = orionldRequestSend(&orionldState.httpResponse, protocol, host, port, "GET", urlPath, 5000, link, &detail, &tryAgain, &downloadFailed, "Accept: application/json", NULL, NULL, 0, headerV);
+    linkP = link;
   }
-  else
-    reqOk = orionldRequestSend(&orionldState.httpResponse, protocol, host, port, "GET", urlPath, 5000, NULL, &detail, &tryAgain, &downloadFailed, "Accept: application/json", NULL, NULL, 0, headerV);
-
-  if (reqOk)
-    entityP = kjParse(orionldState.kjsonP, orionldState.httpResponse.buf);
 
-  return entityP;
-}
-
-
-
-// -----------------------------------------------------------------------------
-//
-// orionldForwardGetEntity -
-//
-static KjNode* orionldForwardGetEntity(ConnectionInfo* ciP, char* entityId, KjNode* regArrayP, KjNode* responseP, bool needEntityType, char** attrsV, int attrs)
-{
   //
-  // Treat all hits from the registrations
+  // One forwarded request per matching registration
   //
+  ForwardGetEntityMerge  merge = { responseP, needEntityType };
+  OrionldMultiRequest*   reqV  = (OrionldMultiRequest*) kaAlloc(&orionldState.kalloc, regs * sizeof(OrionldMultiRequest));
+  int                    reqs  = 0;
+
   for (KjNode* regP = regArrayP->value.firstChildP; regP != NULL; regP = regP->next)
   {
-    KjNode*  partTree = orionldForwardGetEntityPart(regP, entityId, attrsV, attrs);
-    if (partTree == NULL)
-    {
-      LM_E(("Internal Error (forwarded request failed)"));
-      continue;
-    }
+    OrionldMultiRequest* reqP = &reqV[reqs];
 
-    if (partTree->type != KjObject)
+    bzero(reqP, sizeof(OrionldMultiRequest));
+
+    if (orionldForwardGetEntityPart(reqP, regP, entityId, attrsV, attrs) == false)
     {
-      LM_W(("Garbage from Context Provider (the response to a forwarded GET /entities/{EID} must be a JSON object - not %s)",
-            kjValueType(partTree->type)));
+      LM_E(("Internal Error (unable to extract the endpoint of a matching registration)"));
       continue;
     }
 
-    //
-    // Move all attributes from 'partTree' into responseP
-    //
-    KjNode* nodeP = partTree->value.firstChildP;
-    KjNode* next;
-
-    while (nodeP != NULL)
-    {
-      next = nodeP->next;
-
-      if (SCOMPARE3(nodeP->name, 'i', 'd', 0) || SCOMPARE4(nodeP->name, '@', 'i', 'd', 0))
-      {
-        // Do Nothing
-      }
-      else if (SCOMPARE5(nodeP->name, 't', 'y', 'p', 'e', 0) || SCOMPARE6(nodeP->name, '@', 't', 'y', 'p', 'e', 0))
-      {
-        if (needEntityType)
-        {
-          //
-          // We're taking the entity::type from the Response to the forwarded request
-          // because no local entity was found.
-          // It could also be taken from the registration.
-          //
-          kjChildAdd(responseP, nodeP);
-          needEntityType = false;
-        }
-      }
-      else
-        kjChildAdd(responseP, nodeP);
+    reqP->linkHeader   = linkP;
+    reqP->acceptHeader = "Accept: application/json";
+    reqP->headerV      = headerV;
+    reqP->userP        = &merge;
 
-      nodeP = next;
-    }
+    ++reqs;
   }
 
+  orionldLatencyPhaseStart(LP_FORWARD);
+  orionldRequestSendMulti(reqV, reqs, forwardTimeout, orionldForwardGetEntityMerge);
+  orionldLatencyPhaseEnd(LP_FORWARD);
+
   return responseP;
 }
 
@@ -0,0 +1,51 @@
+/*
+*
+* Copyright 2021 FIWARE Foundation e.V.
+*
+* This file is part of Orion-LD Context Broker.
+*
+* Orion-LD Context Broker is free software: you can redistribute it and/or
+* modify it under the terms of the GNU Affero General Public License as
+* published by the Free Software Foundation, either version 3 of the
+* License, or (at your option) any later version.
+*
+* Orion-LD Context Broker is distributed in the hope that it will be useful,
+* but WITHOUT ANY WARRANTY; without even the implied warranty of
+* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU Affero
+* General Public License for more details.
+*
+* You should have received a copy of the GNU Affero General Public License
+* along with Orion-LD Context Broker. If not, see http://www.gnu.org/licenses/.
+*
+* For those usages not covered by this license please contact with
+* orionld at fiware dot org
+*
+* Author: Ken Zangelin
+*/
+#include "logMsg/logMsg.h"                                       // LM_*
+#include "logMsg/traceLevels.h"                                  // Lmt*
+
+#include "rest/ConnectionInfo.h"                                 // ConnectionInfo
+
+#include "orionld/common/orionldState.h"                         // orionldState
+#include "orionld/common/orionldLatency.h"                       // orionldLatencyKjTree
+#include "orionld/serviceRoutines/orionldGetLatency.h"           // Own interface
+
+
+
+// ----------------------------------------------------------------------------
+//
+// orionldGetLatency -
+//
+// GET /ngsi-ld/ex/v1/latency
+//
+// Latency histograms of the NGSI-LD requests served since the broker started, per route, tenant and phase of the request.
+// See orionldLatencyKjTree for the format of the response.
+//
+bool orionldGetLatency(ConnectionInfo* ciP)
+{
+  orionldState.responseTree = orionldLatencyKjTree();
+  orionldState.noLinkHeader = true;
+
+  return true;
+}
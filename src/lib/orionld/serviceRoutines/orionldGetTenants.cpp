@@ -33,7 +33,7 @@ extern "C"
 
 #include "rest/ConnectionInfo.h"                                 // ConnectionInfo
 
-#include "orionld/common/orionldState.h"                         // orionldState, tenantV, tenants
+#include "orionld/common/orionldState.h"                         // orionldState, tenantList
 #include "orionld/serviceRoutines/orionldGetTenants.h"           // Own interface
 
 
@@ -44,23 +44,30 @@ extern "C"
 //
 bool orionldGetTenants(ConnectionInfo* ciP)
 {
-  KjNode* tenantP;
+  KjNode* defaultP;
 
   orionldState.responseTree = kjArray(orionldState.kjsonP, NULL);
 
   //
   // First the default tenant
   //
-  tenantP = kjString(orionldState.kjsonP, NULL, dbName);
-  kjChildAdd(orionldState.responseTree, tenantP);
+  defaultP = kjString(orionldState.kjsonP, NULL, dbName);
+  kjChildAdd(orionldState.responseTree, defaultP);
 
   //
   // Then the other tenants
+  // tenantList has the newest tenant first - each tenant is inserted right after the default tenant,
+  // so that the tenants end up in order of creation
   //
-  for (unsigned int ix = 0; ix < tenants; ix++)
+  for (OrionldTenant* tP = __atomic_load_n(&tenantList, __ATOMIC_ACQUIRE); tP != NULL; tP = tP->listNext)
   {
-    tenantP = kjString(orionldState.kjsonP, NULL, tenantV[ix]);
-    kjChildAdd(orionldState.responseTree, tenantP);
+    KjNode* tenantP = kjString(orionldState.kjsonP, NULL, tP->mongoDbName);
+
+    tenantP->next  = defaultP->next;
+    defaultP->next = tenantP;
+
+    if (tenantP->next == NULL)
+      orionldState.responseTree->lastChild = tenantP;
   }
 
   orionldState.noLinkHeader = true;
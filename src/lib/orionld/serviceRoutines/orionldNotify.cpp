@@ -23,8 +23,11 @@
 * Author: Ken Zangelin
 */
 #include <string.h>                                              // strlen
-#include <sys/uio.h>                                             // writev
-#include <sys/select.h>                                          // select
+#include <time.h>                                                // time
+#include <unistd.h>                                              // read
+#include <poll.h>                                                // poll
+#include <sys/uio.h>                                             // struct iovec
+#include <sys/socket.h>                                          // sendmsg, MSG_NOSIGNAL
 
 extern "C"
 {
@@ -36,11 +39,17 @@ extern "C"
 #include "logMsg/logMsg.h"
 #include "logMsg/traceLevels.h"
 
+#include "cache/subCache.h"                                      // subCacheItemNotificationErrorStatus
+
 #include "orionld/common/orionldState.h"                         // orionldState
 #include "orionld/common/numberToDate.h"                         // numberToDate
 #include "orionld/common/uuidGenerate.h"                         // uuidGenerate
-#include "orionld/common/orionldServerConnect.h"                 // orionldServerConnect
 #include "orionld/context/orionldCoreContext.h"                  // ORIONLD_CORE_CONTEXT_URL
+#include "orionld/notifications/NotificationItem.h"              // NOTIFICATION_RESPONSE_TIMEOUT
+#include "orionld/notifications/notificationConnectionGet.h"     // notificationConnectionGet
+#include "orionld/notifications/notificationConnectionRelease.h" // notificationConnectionRelease
+#include "orionld/notifications/notificationResponseHeadersParse.h"  // notificationResponseHeadersParse
+#include "orionld/notifications/notificationEnqueue.h"           // notificationEnqueue
 #include "orionld/serviceRoutines/orionldNotify.h"               // Own interface
 
 
@@ -49,75 +58,184 @@ extern "C"
 //
 // ipPortAndRest - extract ip, port and URL-PATH from a 'reference' string
 //
+// The host name is copied to 'ip' - the 'reference' string is not modified, as the reference
+// is used as is to find the keep-alive connection of the endpoint.
+//
 // FIXME
 //   This function is generic and should be moved to its own module in orionld/common
 //   However, I think I have a function doing exactly this already ...
 //
-static void ipPortAndRest(char* ipport, char** ipP, unsigned short* portP, char** restP)
+static void ipPortAndRest(char* ipport, char* ip, int ipSize, uint16_t* portP, char** restP)
 {
   char*            colon;
-  char*            ip;
-  unsigned short   portNo  = 80;  // What should be the default port?
+  char*            start;
   char*            rest;
+  uint16_t         portNo  = 80;  // What should be the default port?
+  int              ipLen;
 
   //
   // Starts with http:// ...
   //
-  ip = strchr(ipport, '/');
-  ip += 2;
-  rest = ip;
+  start = strchr(ipport, '/');
+  start += 2;
 
-  colon = strchr(ip, ':');
-  if (colon != NULL)
+  rest  = strchr(start, '/');
+  colon = strchr(start, ':');
+
+  if ((colon != NULL) && ((rest == NULL) || (colon < rest)))
   {
-    *colon = 0;
     portNo = atoi(&colon[1]);
-    rest = &colon[1];
+    ipLen  = colon - start;
   }
+  else
+    ipLen = (rest != NULL)? rest - start : strlen(start);
+
+  if (ipLen >= ipSize)
+    ipLen = ipSize - 1;
+
+  strncpy(ip, start, ipLen);
+  ip[ipLen] = 0;
 
-  *ipP   = ip;
   *portP = portNo;
+  *restP = (rest != NULL)? rest : (char*) "/";
+}
+
+
+
+// -----------------------------------------------------------------------------
+//
+// readWithDeadline - read from a socket, but not beyond 'deadline'
+//
+static int readWithDeadline(int fd, char* buf, int bufLen, time_t deadline)
+{
+  struct pollfd  pfd     = { fd, POLLIN, 0 };
+  int            timeout = (deadline - time(NULL)) * 1000;
+
+  if (timeout <= 0)
+    return -1;
 
-  rest = strchr(rest, '/');
-  *restP = rest;
+  if (poll(&pfd, 1, timeout) <= 0)
+    return -1;
+
+  return read(fd, buf, bufLen);
 }
 
 
 
 // -----------------------------------------------------------------------------
 //
-// responseTreat -
+// responseTreat - read the entire response of a notification
+//
+// The response must be read entirely for the connection to be reusable.
+// Only responses with a Content-Length (or without body, like 204) are considered for keep-alive.
 //
-static void responseTreat(OrionldNotificationInfo* niP, char* buf, int bufLen)
+// Returns true if the connection can be reused for another notification.
+//
+static bool responseTreat(OrionldNotificationInfo* niP, char* buf, int bufLen, time_t deadline)
 {
-  int    nb             = read(niP->fd, buf, bufLen);
-  char*  firstLine      = NULL;
-  char*  endOfFirstLine = NULL;
+  int   nb            = 0;
+  int   headersLen    = 0;
+  int   statusCode;
+  int   contentLength;
+  bool  keepAlive;
+
+  niP->allOK = false;
 
-  if (nb == -1)
+  while (headersLen == 0)
   {
-    LM_E(("Internal Error (error reading from notification endpoint: %s)", strerror(errno)));
-    return;
+    if (nb >= bufLen - 1)
+    {
+      LM_E(("Internal Error (HTTP headers of the response from notification endpoint too big)"));
+      return false;
+    }
+
+    int n = readWithDeadline(niP->fd, &buf[nb], bufLen - 1 - nb, deadline);
+
+    if (n <= 0)
+    {
+      if (n == -1)
+        LM_E(("Internal Error (error reading from notification endpoint: %s)", strerror(errno)));
+      return false;
+    }
+
+    nb      += n;
+    buf[nb]  = 0;
+
+    headersLen = notificationResponseHeadersParse(buf, nb, &statusCode, &contentLength, &keepAlive);
+    if (headersLen == -1)
+    {
+      LM_E(("Internal Error (invalid response from notification endpoint)"));
+      return false;
+    }
   }
 
+  niP->allOK = ((statusCode >= 200) && (statusCode < 300));
+
+  if (contentLength == -1)
+    return false;  // No Content-Length - chunked or until-close - not worth it, the connection is not reused
+
+  int bodyRead = nb - headersLen;
+
+  if (bodyRead > contentLength)
+    return false;  // More than we asked for - connection in unknown state
+
   //
+  // Read (and discard) the rest of the body
   //
-  //
-  firstLine      = buf;
-  endOfFirstLine = strchr(firstLine, '\n');
-
-  if (endOfFirstLine == NULL)
+  while (bodyRead < contentLength)
   {
-    LM_E(("Internal Error (unable to find end of first line from notification endpoint: %s)", strerror(errno)));
-    return;
+    int toRead = contentLength - bodyRead;
+    int n      = readWithDeadline(niP->fd, buf, (toRead < bufLen)? toRead : bufLen, deadline);
+
+    if (n <= 0)
+      return false;
+
+    bodyRead += n;
   }
 
-  *endOfFirstLine = 0;
+  return keepAlive;
+}
 
-  //
-  // FIXME: Read the rest of the message, using select
-  //
-  niP->allOK = true;
+
+
+// -----------------------------------------------------------------------------
+//
+// notificationSend - send the request to the notification endpoint
+//
+// If the connection was taken from the keep-alive pool and sending fails, the connection
+// is assumed to have been closed by the endpoint and a new connection is opened (once).
+//
+static bool notificationSend(OrionldNotificationInfo* niP, char* ip, uint16_t port, struct iovec* ioVec, int ioVecLen)
+{
+  struct msghdr  msg;
+  bool           reused;
+
+  bzero(&msg, sizeof(msg));
+  msg.msg_iov    = ioVec;
+  msg.msg_iovlen = ioVecLen;
+
+  for (int attempt = 0; attempt < 2; attempt++)
+  {
+    niP->fd = notificationConnectionGet(ip, port, &reused);
+
+    if (niP->fd == -1)
+    {
+      LM_E(("Internal Error (unable to connect to server for notification for subscription '%s': %s)", niP->subscriptionId, strerror(errno)));
+      return false;
+    }
+
+    if (sendmsg(niP->fd, &msg, MSG_NOSIGNAL) != -1)
+      return true;
+
+    notificationConnectionRelease(ip, port, niP->fd, false);
+    niP->fd = -1;
+
+    if (reused == false)
+      break;
+  }
+
+  LM_E(("Internal Error (unable to send to server for notification for subscription '%s'): %s", niP->subscriptionId, strerror(errno)));
+  return false;
 }
 
 
@@ -134,14 +252,21 @@ static void responseTreat(OrionldNotificationInfo* niP, char* buf, int bufLen)
 //
 // All attribute names and the entity type are assumed to be already aliased according to the context
 //
+// The connections to the notification endpoints are HTTP/1.1 keep-alive connections, taken from
+// (and given back to) the notification connection pool (orionld/notifications).
+//
+// If notification sender threads are used (-notifSenders), the rendered notifications are pushed onto the
+// notification queue and sent by the sender threads - this function then doesn't wait for any response.
+//
 void orionldNotify(void)
 {
   //
   // Preparing the HTTP headers which will be pretty much the same for all notifications
-  // What differs is Content-Length, Content-Type, and the Request header
+  // What differs is Content-Length, Content-Type, Link, and the Request header
   //
-  char  requestHeader[128];
+  char  requestHeader[512];
   char  contentLenHeader[32];
+  char  linkHeader[512];
   char* lenP                    = &contentLenHeader[16];
   char* contentTypeHeaderJson   = (char*) "Content-Type: application/json\r\n";
   char* contentTypeHeaderJsonLd = (char*) "Content-Type: application/ld+json\r\n";
@@ -162,9 +287,12 @@ void orionldNotify(void)
   // };
   //
   int           contentLength;
-  struct iovec  ioVec[6]        = { { requestHeader, 0 }, { contentLenHeader, 0 }, { contentTypeHeaderJson, 32 }, { userAgentHeader, 23 }, { payload, 0 } };
-  int           ioVecLen        = 5;
+  struct iovec  ioVec[6];
+  int           ioVecLen;
   char          requestTimeV[64];
+  char          ip[256];
+  char*         rest;
+  uint16_t      port;
 
   if (numberToDate(orionldState.requestTime, requestTimeV, sizeof(requestTimeV)) == false)
   {
@@ -175,32 +303,28 @@ void orionldNotify(void)
   for (int ix = 0; ix < orionldState.notificationRecords; ix++)
   {
     OrionldNotificationInfo*  niP = &orionldState.notificationInfo[ix];
-    char*                     ip;
-    unsigned short            port;
-    char*                     rest;
     KjNode*                   notificationTree;
     char                      notificationId[80];
 
+    niP->fd        = -1;
+    niP->connected = false;
+    niP->allOK     = false;
+
     notificationTree = kjObject(orionldState.kjsonP, NULL);
 
     strncpy(notificationId, "urn:ngsi-ld:Notification:", sizeof(notificationId));
     uuidGenerate(&notificationId[25], sizeof(notificationId) - 25, false);
 
-    ipPortAndRest(niP->reference, &ip, &port, &rest);
-    snprintf(requestHeader, sizeof(requestHeader), "POST %s HTTP/1.1\r\n", rest);
+    ipPortAndRest(niP->reference, ip, sizeof(ip), &port, &rest);
+    snprintf(requestHeader, sizeof(requestHeader), "POST %s HTTP/1.1\r\nHost: %s:%d\r\n%s", rest, ip, port, (notifPoolSize == 0)? "Connection: close\r\n" : "");
+
+    ioVecLen = 0;
+    ioVec[ioVecLen++] = { requestHeader,    0 };
+    ioVec[ioVecLen++] = { contentLenHeader, 0 };
 
     if (niP->mimeType == JSONLD)
     {
-      //
-      // For better tput, I could maintain not one ioVec but TWO.
-      // One for "application/json" and another one for "application/ld+json"
-      //
-
-      //
-      // Overwrite contentTypeHeaderJson in ioVec[2]
-      //
-      ioVec[2].iov_base = contentTypeHeaderJsonLd;
-      ioVec[2].iov_len  = 35;
+      ioVec[ioVecLen++] = { contentTypeHeaderJsonLd, strlen(contentTypeHeaderJsonLd) };
 
       // Add @context to payload
       if ((orionldState.contextP == NULL) || (orionldState.contextP == orionldCoreContextP))
@@ -216,24 +340,19 @@ void orionldNotify(void)
     }
     else
     {
+      ioVec[ioVecLen++] = { contentTypeHeaderJson, strlen(contentTypeHeaderJson) };
+
       //
       // Add Link HTTP header
       //
-      ioVecLen = 6;
-
-      // Move down PAYLOAD
-      ioVec[5].iov_base = ioVec[4].iov_base;
-      ioVec[5].iov_len  = ioVec[4].iov_len;
-
-      // Move down userAgentHeader - must be the last as it contains the double \r\n
-      ioVec[4].iov_base = ioVec[3].iov_base;
-      ioVec[4].iov_len  = ioVec[3].iov_len;
-
-      // Now ioVec[3] is free for the Link header
-      ioVec[3].iov_base = orionldState.contextP->url;
-      ioVec[3].iov_len  = strlen(orionldState.contextP->url);
+      snprintf(linkHeader, sizeof(linkHeader), "Link: <%s>; rel=\"http://www.w3.org/ns/json-ld#context\"; type=\"application/ld+json\"\r\n", orionldState.contextP->url);
+      ioVec[ioVecLen++] = { linkHeader, strlen(linkHeader) };
     }
 
+    // userAgentHeader must be the last HTTP header as it contains the double \r\n
+    ioVec[ioVecLen++] = { userAgentHeader, strlen(userAgentHeader) };
+    ioVec[ioVecLen++] = { payload,         0 };
+
     //
     // Fix payload
     //
@@ -266,104 +385,48 @@ void orionldNotify(void)
     contentLength = strlen(payload);
     snprintf(lenP, sizeLeftForLen, "%d\r\n", contentLength);  // Writing Content-Length inside contentLenHeader
 
-    ioVec[0].iov_len = strlen(requestHeader);
-    ioVec[1].iov_len = strlen(contentLenHeader);
-    ioVec[4].iov_len = contentLength;
+    ioVec[0].iov_len            = strlen(requestHeader);
+    ioVec[1].iov_len            = strlen(contentLenHeader);
+    ioVec[ioVecLen - 1].iov_len = contentLength;
 
     //
     // Data ready to send
     //
-    niP->fd = orionldServerConnect(ip, port);
-
-    if (niP->fd == -1)
-    {
-      niP->connected = false;
-      LM_E(("Internal Error (unable to connent to server for notification for subscription '%s': %s)", niP->subscriptionId, strerror(errno)));
-      continue;
-    }
-
-    niP->connected = true;
-
-    if (writev(niP->fd, ioVec, ioVecLen) == -1)
-    {
-      close(niP->fd);
-
-      niP->fd        = -1;
-      niP->connected = false;
-
-      LM_E(("Internal Error (unable to send to server for notification for subscription '%s'): %s", niP->subscriptionId, strerror(errno)));
-      continue;
-    }
+    // With notification sender threads (-notifSenders), the notification is queued and the request thread is done with it
+    //
+    if (notifSenders > 0)
+      notificationEnqueue(ip, port, orionldState.tenant, niP->subscriptionId, ioVec, ioVecLen);
+    else
+      niP->connected = notificationSend(niP, ip, port, ioVec, ioVecLen);
   }
 
   //
   // Receive responses
   //
-  int             fds;
-  fd_set          rFds;
-  int             fdMax      = 0;
-  int             startTime  = time(NULL);
-  struct timeval  tv         = { 1, 0 };
+  // All notifications have been sent already, so, waiting for the responses one by one doesn't add up the
+  // waiting times - one common deadline for all of them.
+  //
+  time_t deadline = time(NULL) + NOTIFICATION_RESPONSE_TIMEOUT;
 
-  while (1)
+  for (int ix = 0; ix < orionldState.notificationRecords; ix++)
   {
-    //
-    // Set File Descriptors for the select
-    //
-    FD_ZERO(&rFds);
-    for (int ix = 0; ix < orionldState.notificationRecords; ix++)
-    {
-      OrionldNotificationInfo*  niP = &orionldState.notificationInfo[ix];
-
-      if ((niP->fd != -1) && (niP->connected == true))
-      {
-        FD_SET(niP->fd, &rFds);
-        fdMax = MAX(fdMax, niP->fd);
-      }
+    OrionldNotificationInfo*  niP = &orionldState.notificationInfo[ix];
 
-      niP->allOK = false;  // Set to 'true' once the response of the notification is received
-    }
+    if (notifSenders > 0)
+      continue;  // The outcome is recorded by the sender thread
 
-    fds = select(1, &rFds, NULL, NULL, &tv);
-    if ((fds == -1) && (errno != EINTR))
-      LM_X(1, ("select error: %s\n", strerror(errno)));
-    else if (fds > 0)
+    if ((niP->fd != -1) && (niP->connected == true))
     {
-      for (int ix = 0; ix < orionldState.notificationRecords; ix++)
-      {
-        OrionldNotificationInfo*  niP = &orionldState.notificationInfo[ix];
+      ipPortAndRest(niP->reference, ip, sizeof(ip), &port, &rest);
 
-        if (FD_ISSET(niP->fd, &rFds))
-          responseTreat(niP, payload, payloadLen);  // We reuse the allocated buffer 'payload'
-      }
+      bool reusable = responseTreat(niP, payload, payloadLen, deadline);  // We reuse the allocated buffer 'payload'
+
+      notificationConnectionRelease(ip, port, niP->fd, reusable);
+      niP->fd = -1;
     }
 
-    //
-    // Timeout after 10 seconds
-    //
-    // FIXME: calling time() might be avoided by inspecting 'tv'
-    //
-    if (time(NULL) > startTime + 10)
-      break;
+    subCacheItemNotificationErrorStatus(orionldState.tenant, niP->subscriptionId, (niP->allOK == true)? 0 : 1);
   }
 
   free(payload);
-
-  //
-  // Close file descriptors and set lastFailure/lastSuccess
-  //
-  for (int ix = 0; ix < orionldState.notificationRecords; ix++)
-  {
-    OrionldNotificationInfo*  niP = &orionldState.notificationInfo[ix];
-
-    if (niP->fd != -1)
-      close(niP->fd);
-
-#if 0
-    if (niP->allOK == true)
-      dbSubscriptionLastSuccessSet(niP->subscriptionId);
-    else
-      dbSubscriptionLastFailureSet(niP->subscriptionId);
-#endif
-  }
 }
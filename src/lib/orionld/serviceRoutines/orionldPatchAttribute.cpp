@@ -22,6 +22,9 @@
 *
 * Author: Ken Zangelin
 */
+#include <stdint.h>                                              // uint64_t
+#include <time.h>                                                // clock_gettime
+
 extern "C"
 {
 #include "kalloc/kaStrdup.h"                                     // kaStrdup
@@ -46,6 +49,8 @@ extern "C"
 #include "orionld/common/CHECK.h"                                // *CHECK*
 #include "orionld/common/orionldRequestSend.h"                   // orionldRequestSend
 #include "orionld/common/dotForEq.h"                             // dotForEq
+#include "orionld/common/orionldLatency.h"                       // orionldLatencyPhaseStart, orionldLatencyPhaseEnd
+#include "orionld/common/orionldForwardLatency.h"                // orionldForwardLatencyRecord
 #include "orionld/types/OrionldProblemDetails.h"                 // OrionldProblemDetails
 #include "orionld/payloadCheck/pcheckUri.h"                      // pcheckUri
 #include "orionld/context/orionldCoreContext.h"                  // orionldCoreContextP
@@ -153,15 +158,25 @@ static bool orionldForwardPatchAttribute
   }
   headerV[header].type = HttpHeaderNone;
 
+  struct timespec forwardStart;
+  struct timespec forwardEnd;
+
+  orionldLatencyPhaseStart(LP_FORWARD);
+  clock_gettime(CLOCK_MONOTONIC, &forwardStart);
   if (orionldState.linkHttpHeaderPresent)
   {
     char link[512];
 
     snprintf(link, sizeof(link), "<%s>; rel=\"http://www.w3.org/ns/json-ld#context\"; type=\"application/ld+json\"", orionldState.link);
-    reqOk = orionldRequestSend(&orionldState.httpResponse, protocol, host, port, "PATCH", uriPath, 5000, link, &detail, &tryAgain, &downloadFailed, NULL, contentType, orionldState.requestPayload, payloadLen, headerV);
+    reqOk = orionldRequestSend(&orionldState.httpResponse, protocol, host, port, "PATCH", uriPath, forwardTimeout, link, &detail, &tryAgain, &downloadFailed, NULL, contentType, orionldState.requestPayload, payloadLen, headerV);
   }
   else
-    reqOk = orionldRequestSend(&orionldState.httpResponse, protocol, host, port, "PATCH", uriPath, 5000, NULL, &detail, &tryAgain, &downloadFailed, NULL, contentType, orionldState.requestPayload, payloadLen, headerV);
+    reqOk = orionldRequestSend(&orionldState.httpResponse, protocol, host, port, "PATCH", uriPath, forwardTimeout, NULL, &detail, &tryAgain, &downloadFailed, NULL, contentType, orionldState.requestPayload, payloadLen, headerV);
+  clock_gettime(CLOCK_MONOTONIC, &forwardEnd);
+  orionldLatencyPhaseEnd(LP_FORWARD);
+
+  uint64_t forwardTime = (forwardEnd.tv_sec - forwardStart.tv_sec) * 1000000ULL + (forwardEnd.tv_nsec - forwardStart.tv_nsec) / 1000;
+  orionldForwardLatencyRecord(protocol, host, port, forwardTime, reqOk);
 
   if (reqOk == false)
   {
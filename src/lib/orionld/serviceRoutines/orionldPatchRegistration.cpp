@@ -70,13 +70,10 @@ do
 //
 static void longToFloat(KjNode* nodeP)
 {
-  if (nodeP->type == KjObject)
+  if (nodeP->type == KjInt)
   {
-    char*     longString  = nodeP->value.firstChildP->value.s;
-    double    floatValue  = strtold(longString, NULL);
-
     nodeP->type    = KjFloat;
-    nodeP->value.f = floatValue;
+    nodeP->value.f = nodeP->value.i;
   }
 }
 
@@ -86,8 +83,8 @@ static void longToFloat(KjNode* nodeP)
 //
 // fixDbRegistration -
 //
-// As long long members are represented as "xxx": { "$numberLong": "1234565678901234" }
-// and this gives an error when trying to Update this, we simply change the object to an int.
+// As long long members come from the database as integers (KjInt) and this gives an error when trying to Update this,
+// we simply change the integer to a double.
 //
 // In a Registration, this must be done for "expiration", and "throttling".
 //
@@ -623,7 +620,7 @@ bool orionldPatchRegistration(ConnectionInfo* ciP)
   }
 
   //
-  // Remove Occurrences of $numberLong, i.e. "expiration"
+  // Change NumberLong fields to double, i.e. "expiration"
   //
   // FIXME: This is BAD ... shouldn't change the type of these fields
   //
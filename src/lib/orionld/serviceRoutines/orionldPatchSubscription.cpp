@@ -397,8 +397,8 @@ static bool ngsildSubscriptionToAPIv1Datamodel(KjNode* patchTree)
 //
 // fixDbSubscription -
 //
-// As long long members are respresented as "xxx": { "$numberLong": "1234565678901234" }
-// and this gives an error when trying to Update this, we simply change the object to an int.
+// As long long members come from the database as integers (KjInt) and this gives an error when trying to Update this,
+// we simply change the integer to a double.
 //
 // In a Subscription, this must be done for "expiration", and "throttling".
 //
@@ -407,32 +407,26 @@ static void fixDbSubscription(KjNode* dbSubscriptionP)
   KjNode* nodeP;
 
   //
-  // If 'expiration' is an Object, it means it's a NumberLong and it is then changed to a double
+  // If 'expiration' is an integer, it means it's a NumberLong and it is then changed to a double
   //
   if ((nodeP = kjLookup(dbSubscriptionP, "expiration")) != NULL)
   {
-    if (nodeP->type == KjObject)
+    if (nodeP->type == KjInt)
     {
-      char*      expirationString = nodeP->value.firstChildP->value.s;
-      double     expiration       = strtold(expirationString, NULL);
-
       nodeP->type    = KjFloat;
-      nodeP->value.f = expiration;
+      nodeP->value.f = nodeP->value.i;
     }
   }
 
   //
-  // If 'throttling' is an Object, it means it's a NumberLong and it is then changed to a double
+  // If 'throttling' is an integer, it means it's a NumberLong and it is then changed to a double
   //
   if ((nodeP = kjLookup(dbSubscriptionP, "throttling")) != NULL)
   {
-    if (nodeP->type == KjObject)
+    if (nodeP->type == KjInt)
     {
-      char*      throttlingString = nodeP->value.firstChildP->value.s;
-      long long  throttling       = strtold(throttlingString, NULL);
-
       nodeP->type    = KjFloat;
-      nodeP->value.f = throttling;
+      nodeP->value.f = nodeP->value.i;
     }
   }
 }
@@ -538,7 +532,7 @@ bool orionldPatchSubscription(ConnectionInfo* ciP)
 
 
   //
-  // Remove Occurrences of $numberLong, i.e. "expiration"
+  // Change NumberLong fields to double, i.e. "expiration"
   //
   // FIXME: This is BAD ... shouldn't change the type of these fields
   //
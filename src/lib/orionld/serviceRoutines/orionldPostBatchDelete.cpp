@@ -42,6 +42,7 @@ extern "C"
 #include "orionld/common/entitySuccessPush.h"                  // entitySuccessPush
 #include "orionld/common/entityErrorPush.h"                    // entityErrorPush
 #include "orionld/db/dbConfiguration.h"                        // dbEntitiesDelete, dbEntityListLookupWithIdTypeCreDate
+#include "orionld/db/dbTypeCatalogEntityDeleted.h"             // dbTypeCatalogEntityDeleted
 #include "orionld/payloadCheck/pcheckUri.h"                    // pcheckUri
 #include "orionld/serviceRoutines/orionldPostBatchDelete.h"    // Own interface
 
@@ -97,8 +98,9 @@ bool orionldPostBatchDelete(ConnectionInfo* ciP)
 
   //
   // First get the entities from database to check which exist
+  // The attribute names are needed as well, for the type catalog
   //
-  KjNode* dbEntities = dbEntityListLookupWithIdTypeCreDate(orionldState.requestTree, false);
+  KjNode* dbEntities = dbEntityListLookupWithIdTypeCreDate(orionldState.requestTree, true);
 
   //
   // Now loop in the array of entities from database and compare each id with the id from requestTree
@@ -178,6 +180,12 @@ bool orionldPostBatchDelete(ConnectionInfo* ciP)
     return false;
   }
 
+  if (dbEntities != NULL)
+  {
+    for (KjNode* dbEntityP = dbEntities->value.firstChildP; dbEntityP != NULL; dbEntityP = dbEntityP->next)
+      dbTypeCatalogEntityDeleted(dbEntityP);
+  }
+
   if (errors->value.firstChildP == NULL)
   {
     orionldState.responseTree   = NULL;
@@ -71,6 +71,7 @@ extern "C"
 #include "orionld/kjTree/kjTreeToUpdateContextRequest.h"       // kjTreeToUpdateContextRequest
 #include "orionld/kjTree/kjEntityIdArrayExtract.h"             // kjEntityIdArrayExtract
 #include "orionld/kjTree/kjEntityArrayErrorPurge.h"            // kjEntityArrayErrorPurge
+#include "orionld/db/dbTypeCatalogEntityDeleted.h"             // dbTypeCatalogEntityDeleted
 #include "orionld/serviceRoutines/orionldPostBatchUpsert.h"    // Own Interface
 
 
@@ -180,8 +181,9 @@ bool orionldPostBatchUpsert(ConnectionInfo* ciP)
   // 02. Query database extracting three fields: { id, type and creDate } for each of the entities
   //     whose Entity::Id is part of the array "idArray".
   //     The result is "idTypeAndCredateFromDb" - an array of "tiny" entities with { id, type and creDate }
+  //     The attribute names are needed as well, for the type catalog (the entities are replaced)
   //
-  KjNode* idTypeAndCreDateFromDb = dbEntityListLookupWithIdTypeCreDate(idArray, false);
+  KjNode* idTypeAndCreDateFromDb = dbEntityListLookupWithIdTypeCreDate(idArray, true);
 
   orionldState.batchEntities = idTypeAndCreDateFromDb;  // So that TRoE knows what entities existed prior to the upsert call
   LM_TMP(("orionldState.batchEntities at %p", orionldState.batchEntities));
@@ -300,8 +302,16 @@ bool orionldPostBatchUpsert(ConnectionInfo* ciP)
   //
   if (orionldState.uriParamOptions.update == false)
   {
-    if ((removeArray != NULL) && (removeArray->value.firstChildP != NULL))
-      dbEntitiesDelete(removeArray);
+    if ((removeArray != NULL) && (removeArray->value.firstChildP != NULL) && (dbEntitiesDelete(removeArray) == true))
+    {
+      for (KjNode* idNodeP = removeArray->value.firstChildP; idNodeP != NULL; idNodeP = idNodeP->next)
+      {
+        KjNode* dbEntityP = (idTypeAndCreDateFromDb != NULL)? entityLookupById(idTypeAndCreDateFromDb, idNodeP->value.s) : NULL;
+
+        if (dbEntityP != NULL)
+          dbTypeCatalogEntityDeleted(dbEntityP);
+      }
+    }
   }
 
 
@@ -56,11 +56,14 @@ extern "C"
 #include "orionld/common/dotForEq.h"                             // dotForEq
 #include "orionld/common/eqForDot.h"                             // eqForDot
 #include "orionld/common/performance.h"                          // REQUEST_PERFORMANCE
+#include "orionld/common/orionldLatency.h"                       // orionldLatencyPhaseStart, orionldLatencyPhaseEnd
 #include "orionld/payloadCheck/pcheckEntity.h"                   // pcheckEntity
 #include "orionld/payloadCheck/pcheckUri.h"                      // pcheckUri
 #include "orionld/context/orionldContextItemExpand.h"            // orionldContextItemExpand
 #include "orionld/kjTree/kjTreeToContextAttribute.h"             // kjTreeToContextAttribute
+#include "orionld/common/orionldTenantLookup.h"                  // orionldTenantLookup
 #include "orionld/mongoBackend/mongoEntityExists.h"              // mongoEntityExists
+#include "orionld/mongoBackend/mongoLdEntityIdIndexUnique.h"     // mongoLdEntityIdIndexUnique
 #include "orionld/serviceRoutines/orionldPostEntities.h"         // Own interface
 
 
@@ -238,7 +241,19 @@ bool orionldPostEntities(ConnectionInfo* ciP)
   //
   // If the entity already exists, an error should be returned
   //
-  if (mongoEntityExists(entityId, orionldState.tenant) == true)
+  // With -entityIdUnique, and the unique index on _id.id in place, the entity is not looked up - the insert fails with a
+  // duplicate key error if the entity already exists (see mongoLdEntityIdIndexUnique). That saves two round trips to the
+  // database (and two collection scans if -idIndex isn't used) - this lookup and the one in processContextElement.
+  // Without the index (the default), the entity is looked up first, as always.
+  //
+  OrionldTenant* tenantP = orionldState.tenantP;
+
+  if (tenantP == NULL)
+    tenantP = (orionldState.tenant[0] == 0)? &tenant0 : orionldTenantLookup(orionldState.tenant);
+
+  if ((tenantP != NULL) && (mongoLdEntityIdIndexUnique(tenantP) == true))
+    orionldState.entityInsertFirst = true;
+  else if (mongoEntityExists(entityId, orionldState.tenant) == true)
   {
     orionldErrorResponseCreate(OrionldAlreadyExists, "Entity already exists", entityId);
     orionldState.httpStatusCode = SccConflict;
@@ -397,6 +412,7 @@ bool orionldPostEntities(ConnectionInfo* ciP)
 #ifdef REQUEST_PERFORMANCE
   kTimeGet(&timestamps.dbStart);
 #endif
+  orionldLatencyPhaseStart(LP_DB);
 
   orionldState.httpStatusCode = mongoUpdateContext(&mongoRequest,
                                                    &mongoResponse,
@@ -412,9 +428,17 @@ bool orionldPostEntities(ConnectionInfo* ciP)
 #ifdef REQUEST_PERFORMANCE
   kTimeGet(&timestamps.dbEnd);
 #endif
+  orionldLatencyPhaseEnd(LP_DB);
   mongoRequest.release();
   mongoResponse.release();
 
+  if (mongoResponse.oe.code == SccConflict)  // Duplicate key - the entity already exists
+  {
+    orionldErrorResponseCreate(OrionldAlreadyExists, "Entity already exists", entityId);
+    orionldState.httpStatusCode = SccConflict;
+    return false;
+  }
+
   if (orionldState.httpStatusCode != SccOk)
   {
     LM_E(("mongoUpdateContext: HTTP Status Code: %d", orionldState.httpStatusCode));
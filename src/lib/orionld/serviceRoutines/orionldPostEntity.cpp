@@ -57,6 +57,7 @@ extern "C"
 #include "orionld/common/attributeNotUpdated.h"                  // attributeNotUpdated
 #include "orionld/db/dbEntityLookup.h"                           // dbEntityLookup
 #include "orionld/db/dbEntityUpdate.h"                           // dbEntityUpdate
+#include "orionld/db/dbTypeCatalogAttributesDeleted.h"           // dbTypeCatalogAttributesDeleted
 #include "orionld/payloadCheck/pcheckUri.h"                      // pcheckUri
 #include "orionld/context/orionldContextItemExpand.h"            // orionldContextItemExpand
 #include "orionld/context/orionldContextItemAliasLookup.h"       // orionldContextItemAliasLookup
@@ -457,7 +458,10 @@ bool orionldPostEntity(ConnectionInfo* ciP)
     ucr.updateActionType = ActionTypeAppend;
 
     if (attrNameIx > 0)
+    {
       dbEntityAttributesDelete(entityId, attrNameV, attrsInPayload);
+      dbTypeCatalogAttributesDeleted(dbEntityP, attrNameV, attrsInPayload);  // mongoUpdateContext adds them back
+    }
 
     status = mongoUpdateContext(&ucr,
                                 &ucResponse,
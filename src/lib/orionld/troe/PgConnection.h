@@ -0,0 +1,74 @@
+#ifndef SRC_LIB_ORIONLD_TROE_PGCONNECTION_H_
+#define SRC_LIB_ORIONLD_TROE_PGCONNECTION_H_
+
+/*
+*
+* Copyright 2021 FIWARE Foundation e.V.
+*
+* This file is part of Orion-LD Context Broker.
+*
+* Orion-LD Context Broker is free software: you can redistribute it and/or
+* modify it under the terms of the GNU Affero General Public License as
+* published by the Free Software Foundation, either version 3 of the
+* License, or (at your option) any later version.
+*
+* Orion-LD Context Broker is distributed in the hope that it will be useful,
+* but WITHOUT ANY WARRANTY; without even the implied warranty of
+* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU Affero
+* General Public License for more details.
+*
+* You should have received a copy of the GNU Affero General Public License
+* along with Orion-LD Context Broker. If not, see http://www.gnu.org/licenses/.
+*
+* For those usages not covered by this license please contact with
+* orionld at fiware dot org
+*
+* Author: Ken Zangelin
+*/
+#include <time.h>                                              // time_t
+#include <semaphore.h>                                         // sem_t
+#include <postgresql/libpq-fe.h>                               // PGconn
+
+
+
+// -----------------------------------------------------------------------------
+//
+// PgConnection - one slot of a postgres connection pool
+//
+// The slot is kept as instance data of its PGconn (see pgConnectionEventProc), so that pgConnectionRelease
+// finds the slot and its pool without any lookup.
+//
+typedef struct PgConnection
+{
+  PGconn*                   connectionP;   // NULL until first used, and after a broken connection has been closed
+  int                       taken;         // 0: free, 1: checked out - claimed with __sync_bool_compare_and_swap
+  time_t                    lastUsed;      // time of the last check-in - for the health check of idle connections
+  struct PgConnectionPool*  poolP;         // The pool of the slot
+} PgConnection;
+
+
+
+// -----------------------------------------------------------------------------
+//
+// PgConnectionPool - the connections to one postgres database (one per tenant)
+//
+typedef struct PgConnectionPool
+{
+  char*                     db;           // Empty string for connections without dbname
+  int                       size;
+  PgConnection*             connectionV;
+  sem_t                     freeSem;      // Number of free slots in connectionV
+  unsigned int              hash;         // fnvHash of db - picks the bucket in pgConnectionPoolTable
+  struct PgConnectionPool*  next;         // All pools - for statistics and release
+  struct PgConnectionPool*  bucketNext;   // Pools of the same bucket in pgConnectionPoolTable
+
+  // Counters - updated with __sync_* builtins
+  unsigned long long        checkouts;
+  unsigned long long        waits;        // check-outs that had to wait for a free slot
+  unsigned long long        waitTime;     // microseconds, accumulated
+  unsigned long long        waitTimeMax;  // microseconds
+  unsigned long long        connects;
+  unsigned long long        reconnects;
+} PgConnectionPool;
+
+#endif  // SRC_LIB_ORIONLD_TROE_PGCONNECTION_H_
@@ -0,0 +1,69 @@
+#ifndef SRC_LIB_ORIONLD_TROE_PGCOPYBUFFER_H_
+#define SRC_LIB_ORIONLD_TROE_PGCOPYBUFFER_H_
+
+/*
+*
+* Copyright 2021 FIWARE Foundation e.V.
+*
+* This file is part of Orion-LD Context Broker.
+*
+* Orion-LD Context Broker is free software: you can redistribute it and/or
+* modify it under the terms of the GNU Affero General Public License as
+* published by the Free Software Foundation, either version 3 of the
+* License, or (at your option) any later version.
+*
+* Orion-LD Context Broker is distributed in the hope that it will be useful,
+* but WITHOUT ANY WARRANTY; without even the implied warranty of
+* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU Affero
+* General Public License for more details.
+*
+* You should have received a copy of the GNU Affero General Public License
+* along with Orion-LD Context Broker. If not, see http://www.gnu.org/licenses/.
+*
+* For those usages not covered by this license please contact with
+* orionld at fiware dot org
+*
+* Author: Ken Zangelin
+*/
+
+
+
+// -----------------------------------------------------------------------------
+//
+// Column lists of the three TRoE tables, in the order the rows are rendered in the COPY buffers.
+// The order must match pgEntityPush/pgEntityDelete, pgAttributeAppend and pgSubAttributeAppend.
+//
+#define PG_ENTITIES_COLUMNS       "instanceId, ts, opMode, id, type"
+#define PG_ATTRIBUTES_COLUMNS     "instanceId, id, opMode, entityId, observedAt, subProperties, unitCode, datasetId, valueType, " \
+                                  "text, boolean, number, compound, geoPoint, geoPolygon, geoMultiPolygon, geoLineString, geoMultiLineString, ts"
+#define PG_SUBATTRIBUTES_COLUMNS  "instanceId, id, entityId, attrInstanceId, observedAt, unitCode, valueType, " \
+                                  "text, boolean, number, compound, geoPoint, geoPolygon, geoMultiPolygon, geoLineString, geoMultiLineString, ts"
+
+
+
+// -----------------------------------------------------------------------------
+//
+// PgCopyBuffer - rows of one table, in COPY text format, waiting to be sent to postgres
+//
+typedef struct PgCopyBuffer
+{
+  char*  buf;     // malloc'ed, grows on demand and is kept between transactions
+  int    size;    // allocated size of 'buf'
+  int    used;    // bytes used in 'buf'
+  int    rows;    // number of rows in 'buf'
+} PgCopyBuffer;
+
+
+
+// -----------------------------------------------------------------------------
+//
+// PgCopyBatch - all rows of one TRoE transaction
+//
+typedef struct PgCopyBatch
+{
+  PgCopyBuffer  entities;
+  PgCopyBuffer  attributes;
+  PgCopyBuffer  subAttributes;
+} PgCopyBatch;
+
+#endif  // SRC_LIB_ORIONLD_TROE_PGCOPYBUFFER_H_
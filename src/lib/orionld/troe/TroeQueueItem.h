@@ -0,0 +1,88 @@
+#ifndef SRC_LIB_ORIONLD_TROE_TROEQUEUEITEM_H_
+#define SRC_LIB_ORIONLD_TROE_TROEQUEUEITEM_H_
+
+/*
+*
+* Copyright 2021 FIWARE Foundation e.V.
+*
+* This file is part of Orion-LD Context Broker.
+*
+* Orion-LD Context Broker is free software: you can redistribute it and/or
+* modify it under the terms of the GNU Affero General Public License as
+* published by the Free Software Foundation, either version 3 of the
+* License, or (at your option) any later version.
+*
+* Orion-LD Context Broker is distributed in the hope that it will be useful,
+* but WITHOUT ANY WARRANTY; without even the implied warranty of
+* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU Affero
+* General Public License for more details.
+*
+* You should have received a copy of the GNU Affero General Public License
+* along with Orion-LD Context Broker. If not, see http://www.gnu.org/licenses/.
+*
+* For those usages not covered by this license please contact with
+* orionld at fiware dot org
+*
+* Author: Ken Zangelin
+*/
+
+
+
+// -----------------------------------------------------------------------------
+//
+// TROE_QUEUE_RECORD_MAGIC - start of every record in the spill file
+//
+#define TROE_QUEUE_RECORD_MAGIC  0x54526F45
+
+
+
+// -----------------------------------------------------------------------------
+//
+// TroeQueueRecord - the persistent part of a queued TRoE transaction (as stored in the spill file)
+//
+// The data (dataLen bytes) follows the record: the rows for 'entities', then those for 'attributes',
+// then those for 'subAttributes' - all of it in COPY text format, exactly as rendered by the pg*Push functions.
+//
+typedef struct TroeQueueRecord
+{
+  unsigned int  magic;
+  unsigned int  dataLen;
+  char          db[128];
+  int           entitiesLen;
+  int           entitiesRows;
+  int           attributesLen;
+  int           attributesRows;
+  int           subAttributesLen;
+  int           subAttributesRows;
+} TroeQueueRecord;
+
+
+
+// -----------------------------------------------------------------------------
+//
+// TroeQueueItemState -
+//
+typedef enum TroeQueueItemState
+{
+  TroeQueueItemQueued,
+  TroeQueueItemInFlight,
+  TroeQueueItemDone
+} TroeQueueItemState;
+
+
+
+// -----------------------------------------------------------------------------
+//
+// TroeQueueItem - one TRoE transaction waiting to be written to postgres
+//
+// Item and data are allocated in one single chunk.
+//
+typedef struct TroeQueueItem
+{
+  TroeQueueRecord     record;
+  TroeQueueItemState  state;
+  long long           spillEnd;   // Offset in the spill file right after this record (-1: not in the spill file)
+  char*               data;
+} TroeQueueItem;
+
+#endif  // SRC_LIB_ORIONLD_TROE_TROEQUEUEITEM_H_
@@ -27,6 +27,7 @@
 #include "logMsg/logMsg.h"                                     // LM_*
 #include "logMsg/traceLevels.h"                                // Lmt*
 
+#include "orionld/troe/pgAttributeAppend.h"                    // pgAttributeAppend
 #include "orionld/troe/pgAttributeDelete.h"                    // Own interface
 
 
@@ -37,17 +38,5 @@
 //
 bool pgAttributeDelete(PGconn* connectionP, char* entityId, char* instanceId, char* attributeName, char* deletedAt)
 {
-  char       sql[512];
-  PGresult*  res;
-
-  snprintf(sql, sizeof(sql), "INSERT INTO attributes(opMode, instanceId, id, entityId, ts) VALUES ('Delete', '%s', '%s', '%s', '%s')",
-           instanceId, attributeName, entityId, deletedAt);
-
-  LM_TMP(("SQL[%p]: %s", connectionP, sql));
-  res = PQexec(connectionP, sql);
-  if (res == NULL)
-    LM_RE(false, ("Database Error (%s)", PQresStatus(PQresultStatus(res))));
-  PQclear(res);
-
-  return true;
+  return pgAttributeAppend("Delete", instanceId, attributeName, entityId, NULL, NULL, NULL, NULL, NULL, PgValueNone, NULL, deletedAt);
 }
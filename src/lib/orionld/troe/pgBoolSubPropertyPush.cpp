@@ -22,13 +22,13 @@
 *
 * Author: Ken Zangelin
 */
-#include <stdio.h>                                             // snprintf
 #include <postgresql/libpq-fe.h>                               // PGconn
 
 #include "logMsg/logMsg.h"                                     // LM_*
 #include "logMsg/traceLevels.h"                                // Lmt*
 
 #include "orionld/common/orionldState.h"                       // orionldState
+#include "orionld/troe/pgSubAttributeAppend.h"                 // pgSubAttributeAppend
 #include "orionld/troe/pgBoolSubPropertyPush.h"                // Own interface
 
 
@@ -48,36 +48,5 @@ bool pgBoolSubPropertyPush
   const char*  observedAt
 )
 {
-  char sql[1024];
-
-  //
-  // Two combinations for NULL/non-NULL 'observedAt' (sub-attributes have no datasetId)
-  //
-  if (observedAt != NULL)
-  {
-    snprintf(sql, sizeof(sql), "INSERT INTO subAttributes("
-             "instanceId, id, entityId, attrInstanceId, ts, observedAt, valueType, boolean) "
-             "VALUES ('%s', '%s', '%s', '%s', '%s', '%s', 'Boolean', %s)",
-             instanceId, subAttributeName, entityId, attrInstanceId, orionldState.requestTimeString, observedAt, (boolValue == true)? "true" : "false");
-  }
-  else
-  {
-    snprintf(sql, sizeof(sql), "INSERT INTO subAttributes("
-             "instanceId, id, entityId, attrInstanceId, ts, valueType, boolean) "
-             "VALUES ('%s', '%s', '%s', '%s', '%s', 'Boolean', %s)",
-             instanceId, subAttributeName, entityId, attrInstanceId, orionldState.requestTimeString, (boolValue == true)? "true" : "false");
-  }
-  LM_TMP(("SQL[%p]: %s;", connectionP, sql));
-
-
-  PGresult* res;
-  res = PQexec(connectionP, sql);
-  if (res == NULL)
-    LM_RE(false, ("Database Error (%s)", PQresStatus(PQresultStatus(res))));
-  PQclear(res);
-
-  if (PQstatus(connectionP) != CONNECTION_OK)
-    LM_E(("SQL[%p]: bad connection: %d", connectionP, PQstatus(connectionP)));  // FIXME: string! (last error?)
-
-  return true;
+  return pgSubAttributeAppend(instanceId, subAttributeName, entityId, attrInstanceId, observedAt, NULL, "Boolean", PgValueBoolean, (boolValue == true)? "true" : "false", orionldState.requestTimeString);
 }
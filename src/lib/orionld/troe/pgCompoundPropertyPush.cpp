@@ -26,6 +26,7 @@
 
 extern "C"
 {
+#include "kalloc/kaAlloc.h"                                    // kaAlloc
 #include "kjson/KjNode.h"                                      // KjNode
 #include "kjson/kjRender.h"                                    // kjFastRender
 }
@@ -34,6 +35,7 @@ extern "C"
 #include "logMsg/traceLevels.h"                                // Lmt*
 
 #include "orionld/common/orionldState.h"                       // orionldState
+#include "orionld/troe/pgAttributeAppend.h"                    // pgAttributeAppend
 #include "orionld/troe/pgCompoundPropertyPush.h"               // Own interface
 
 
@@ -57,59 +59,16 @@ bool pgCompoundPropertyPush
   bool         subProperties
 )
 {
-  int          renderedValueSize   = 4 * 1024;
-  char*        renderedValue       = kaAlloc(&orionldState.kalloc, renderedValueSize);
-  int          sqlSize             = 5 * 1024;
-  char*        sql                 = kaAlloc(&orionldState.kalloc, sqlSize);  // FIXME - one single call to kaAlloc, por favor !!!
-  const char*  subPropertiesString = (subProperties == false)? "false" : "true";
-  PGresult*    res;
+  int    renderedValueSize = 4 * 1024;
+  char*  renderedValue     = kaAlloc(&orionldState.kalloc, renderedValueSize);
 
-  if ((renderedValue == NULL) || (sql == NULL))
-    LM_RE(false, ("Internal Error (unable to allocate room for compound value"));
+  if (renderedValue == NULL)
+    LM_RE(false, ("Internal Error (unable to allocate room for compound value of attribute"));
 
   kjFastRender(orionldState.kjsonP, compoundValueNodeP, renderedValue, renderedValueSize);
 
-  //
-  // Four combinations for NULL/non-NULL 'datasetId' and 'observedAt'
-  //
-  if ((datasetId != NULL) && (observedAt != NULL))
-  {
-    snprintf(sql, sqlSize, "INSERT INTO attributes("
-             "opMode, instanceId, id, entityId, ts, observedAt, valueType, subProperties, datasetId, compound) "
-             "VALUES ('%s', '%s', '%s', '%s', '%s', '%s', 'Compound', %s, '%s', '%s')",
-             opMode, attributeInstance, attributeName, entityId, orionldState.requestTimeString, observedAt, subPropertiesString, datasetId, renderedValue);
-  }
-  else if ((datasetId == NULL) && (observedAt == NULL))
-  {
-    snprintf(sql, sqlSize, "INSERT INTO attributes("
-             "opMode, instanceId, id, entityId, ts, valueType, subProperties, compound) "
-             "VALUES ('%s', '%s', '%s', '%s', '%s', 'Compound', %s, '%s')",
-             opMode, attributeInstance, attributeName, entityId, orionldState.requestTimeString, subPropertiesString, renderedValue);
-  }
-  else if (datasetId != NULL)  // observedAt == NULL
-  {
-    snprintf(sql, sqlSize, "INSERT INTO attributes("
-             "opMode, instanceId, id, entityId, ts, valueType, subProperties, datasetId, compound) "
-             "VALUES ('%s', '%s', '%s', '%s', '%s', 'Compound', %s, '%s', '%s')",
-             opMode, attributeInstance, attributeName, entityId, orionldState.requestTimeString, subPropertiesString, datasetId, renderedValue);
-  }
-  else  // observedAt != NULL, datasetId == NULL
-  {
-    snprintf(sql, sqlSize, "INSERT INTO attributes("
-             "opMode, instanceId, id, entityId, ts, observedAt, valueType, subProperties, compound) "
-             "VALUES ('%s', '%s', '%s', '%s', '%s', '%s', 'Compound', %s, '%s')",
-             opMode, attributeInstance, attributeName, entityId, orionldState.requestTimeString, observedAt, subPropertiesString, renderedValue);
-  }
+  const char* subPropertiesString = (subProperties == false)? "false" : "true";
 
-  LM_TMP(("SQL[%p]: %s;", connectionP, sql));
-
-  res = PQexec(connectionP, sql);
-  if (res == NULL)
-    LM_RE(false, ("Database Error (%s)", PQresStatus(PQresultStatus(res))));
-  PQclear(res);
-
-  if (PQstatus(connectionP) != CONNECTION_OK)
-    LM_E(("SQL[%p]: bad connection: %d", connectionP, PQstatus(connectionP)));  // FIXME: string! (last error?)
-
-  return true;
+  return pgAttributeAppend(opMode, attributeInstance, attributeName, entityId, observedAt, subPropertiesString, NULL, datasetId,
+                           "Compound", PgValueCompound, renderedValue, orionldState.requestTimeString);
 }
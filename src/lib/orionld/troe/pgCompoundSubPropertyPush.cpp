@@ -26,6 +26,7 @@
 
 extern "C"
 {
+#include "kalloc/kaAlloc.h"                                    // kaAlloc
 #include "kjson/KjNode.h"                                      // KjNode
 #include "kjson/kjRender.h"                                    // kjFastRender
 }
@@ -34,6 +35,7 @@ extern "C"
 #include "logMsg/traceLevels.h"                                // Lmt*
 
 #include "orionld/common/orionldState.h"                       // orionldState
+#include "orionld/troe/pgSubAttributeAppend.h"                 // pgSubAttributeAppend
 #include "orionld/troe/pgCompoundSubPropertyPush.h"            // Own interface
 
 
@@ -53,44 +55,13 @@ bool pgCompoundSubPropertyPush
   const char*  observedAt
 )
 {
-  int          renderedValueSize   = 4 * 1024;
-  char*        renderedValue       = kaAlloc(&orionldState.kalloc, renderedValueSize);
-  int          sqlSize             = 5 * 1024;
-  char*        sql                 = kaAlloc(&orionldState.kalloc, sqlSize);  // FIXME - one single call to kaAlloc, por favor !!!
-  PGresult*    res;
+  int    renderedValueSize = 4 * 1024;
+  char*  renderedValue     = kaAlloc(&orionldState.kalloc, renderedValueSize);
 
-  if ((renderedValue == NULL) || (sql == NULL))
+  if (renderedValue == NULL)
     LM_RE(false, ("Internal Error (unable to allocate room for compound value of sub-attribute"));
 
   kjFastRender(orionldState.kjsonP, compoundValueNodeP, renderedValue, renderedValueSize);
 
-  //
-  // Two combinations for NULL/non-NULL 'observedAt'
-  //
-  if (observedAt != NULL)
-  {
-    snprintf(sql, sqlSize, "INSERT INTO subAttributes("
-             "instanceId, id, entityId, attrInstanceId, ts, observedAt, valueType, compound) "
-             "VALUES ('%s', '%s', '%s', '%s', '%s', '%s', 'Compound', '%s')",
-             instanceId, subAttributeName, entityId, attrInstanceId, orionldState.requestTimeString, observedAt, renderedValue);
-  }
-  else
-  {
-    snprintf(sql, sqlSize, "INSERT INTO subAttributes("
-             "instanceId, id, entityId, attrInstanceId, ts, valueType, compound) "
-             "VALUES ('%s', '%s', '%s', '%s', '%s', 'Compound', '%s')",
-             instanceId, subAttributeName, entityId, attrInstanceId, orionldState.requestTimeString, renderedValue);
-  }
-
-  LM_TMP(("SQL[%p]: %s;", connectionP, sql));
-
-  res = PQexec(connectionP, sql);
-  if (res == NULL)
-    LM_RE(false, ("Database Error (%s)", PQresStatus(PQresultStatus(res))));
-  PQclear(res);
-
-  if (PQstatus(connectionP) != CONNECTION_OK)
-    LM_E(("SQL[%p]: bad connection: %d", connectionP, PQstatus(connectionP)));  // FIXME: string! (last error?)
-
-  return true;
+  return pgSubAttributeAppend(instanceId, subAttributeName, entityId, attrInstanceId, observedAt, NULL, "Compound", PgValueCompound, renderedValue, orionldState.requestTimeString);
 }
@@ -0,0 +1,42 @@
+/*
+*
+* Copyright 2021 FIWARE Foundation e.V.
+*
+* This file is part of Orion-LD Context Broker.
+*
+* Orion-LD Context Broker is free software: you can redistribute it and/or
+* modify it under the terms of the GNU Affero General Public License as
+* published by the Free Software Foundation, either version 3 of the
+* License, or (at your option) any later version.
+*
+* Orion-LD Context Broker is distributed in the hope that it will be useful,
+* but WITHOUT ANY WARRANTY; without even the implied warranty of
+* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU Affero
+* General Public License for more details.
+*
+* You should have received a copy of the GNU Affero General Public License
+* along with Orion-LD Context Broker. If not, see http://www.gnu.org/licenses/.
+*
+* For those usages not covered by this license please contact with
+* orionld at fiware dot org
+*
+* Author: Ken Zangelin
+*/
+#include <postgresql/libpq-events.h>                           // PGEventId
+
+#include "orionld/troe/pgConnectionEventProc.h"                // Own interface
+
+
+
+// -----------------------------------------------------------------------------
+//
+// pgConnectionEventProc - libpq event procedure of the pooled connections
+//
+// Nothing to do for any event - the procedure is only needed for the instance data of the connection,
+// i.e. the pool slot it belongs to, that libpq keeps in the connection for us.
+// The slot is not owned by the connection, so there's nothing to free on PGEVT_CONNDESTROY.
+//
+int pgConnectionEventProc(PGEventId eventId, void* eventInfo, void* passThrough)
+{
+  return 1;  // OK
+}
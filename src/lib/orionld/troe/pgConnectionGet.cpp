@@ -22,55 +22,135 @@
 *
 * Author: Ken Zangelin
 */
+#include <time.h>                                              // time, clock_gettime
+#include <string.h>                                            // strerror
+#include <errno.h>                                             // errno, EINTR
+#include <semaphore.h>                                         // sem_wait, sem_trywait, sem_post
 #include <postgresql/libpq-fe.h>                               // Postgres
+#include <postgresql/libpq-events.h>                           // PQregisterEventProc, PQsetInstanceData
 
 #include "logMsg/logMsg.h"                                     // LM_*
 #include "logMsg/traceLevels.h"                                // Lmt*
 
-#include "orionld/common/orionldState.h"                       // troeHost, troePort, troeUser, troePwd
+#include "orionld/common/orionldState.h"                       // dbName
+#include "orionld/troe/PgConnection.h"                         // PgConnectionPool, PgConnection
+#include "orionld/troe/pgConnectionPool.h"                     // pgConnectionPoolInitialized, PG_CONNECTION_IDLE_CHECK
+#include "orionld/troe/pgConnectionPoolLookup.h"               // pgConnectionPoolLookup
+#include "orionld/troe/pgConnectionOpen.h"                     // pgConnectionOpen
+#include "orionld/troe/pgConnectionEventProc.h"                // pgConnectionEventProc
 #include "orionld/troe/pgConnectionGet.h"                      // Own interface
 
 
-#ifdef PG_CONNECTION_COUNT
-static int connectionCount = 0;
 
-void connectionCountIncr(const char* who, void* connectionP)
+// -----------------------------------------------------------------------------
+//
+// pgConnectionPoolWait - wait for a free slot in a pool, and measure the time waited
+//
+static void pgConnectionPoolWait(PgConnectionPool* poolP)
 {
-  // Just debugging - no semaphore necessary
-  ++connectionCount;
-  LM_TMP(("PG Connection Count == %d (%s:%p)", connectionCount, who, connectionP));
-}
+  if (sem_trywait(&poolP->freeSem) == 0)
+    return;
 
-void connectionCountDecr(const char* who, void* connectionP)
-{
-  // Just debugging - no semaphore necessary
-  --connectionCount;
-  LM_TMP(("PG Connection Count == %d (%s:%p)", connectionCount, who, connectionP));
+  struct timespec  start;
+  struct timespec  end;
+
+  clock_gettime(CLOCK_MONOTONIC, &start);
+
+  while (sem_wait(&poolP->freeSem) == -1)
+  {
+    if (errno != EINTR)
+      LM_E(("Runtime Error (sem_wait on the connection pool of postgres db '%s': %s)", poolP->db, strerror(errno)));
+  }
+
+  clock_gettime(CLOCK_MONOTONIC, &end);
+
+  unsigned long long waited = (end.tv_sec - start.tv_sec) * 1000000ULL + (end.tv_nsec - start.tv_nsec) / 1000;
+  unsigned long long max    = poolP->waitTimeMax;
+
+  __sync_fetch_and_add(&poolP->waits, 1);
+  __sync_fetch_and_add(&poolP->waitTime, waited);
+
+  while ((waited > max) && (__sync_bool_compare_and_swap(&poolP->waitTimeMax, max, waited) == false))
+    max = poolP->waitTimeMax;
 }
-#endif
 
 
+
+// -----------------------------------------------------------------------------
 //
-// FIXME:
-//   typedef struct PgConnection
-//   {
-//     sem_t    sem;
-//     bool     taken;
-//     PGconn*  connectionP;
-//     char*    dbName;
-//   } PgConnection;
+// pgConnectionCheck - make sure the connection of a slot is usable, reconnecting if needed
 //
-// The connection pool will be simply a linked list of PgConnection.
-// If none is free (for the dbName in question), another connection is opened.
+// A connection that has been idle for a while may have been closed by the server (or a firewall)
+// without libpq noticing, so before such a connection is used, a trivial query is run on it.
 //
+static bool pgConnectionCheck(PgConnectionPool* poolP, PgConnection* cP)
+{
+  if (cP->connectionP != NULL)
+  {
+    bool ok = (PQstatus(cP->connectionP) == CONNECTION_OK);
+
+    if ((ok == true) && (time(NULL) - cP->lastUsed > PG_CONNECTION_IDLE_CHECK))
+    {
+      PGresult* res = PQexec(cP->connectionP, "SELECT 1");
+
+      ok = ((res != NULL) && (PQresultStatus(res) == PGRES_TUPLES_OK));
+      PQclear(res);
+    }
+
+    if (ok == false)
+    {
+      LM_W(("TROE: broken connection to postgres db '%s' - reconnecting", poolP->db));
+      __sync_fetch_and_add(&poolP->reconnects, 1);
+
+      PQreset(cP->connectionP);
+      if (PQstatus(cP->connectionP) == CONNECTION_OK)
+        return true;
+
+      PQfinish(cP->connectionP);
+      cP->connectionP = NULL;
+    }
+    else
+      return true;
+  }
+
+  cP->connectionP = pgConnectionOpen((poolP->db[0] == 0)? NULL : poolP->db);
+  if (cP->connectionP == NULL)
+    return false;
+
+  if (PQstatus(cP->connectionP) != CONNECTION_OK)
+  {
+    LM_E(("Database Error (unable to connect to postgres db '%s': %s)", poolP->db, PQerrorMessage(cP->connectionP)));
+    PQfinish(cP->connectionP);
+    cP->connectionP = NULL;
+    return false;
+  }
+
+  //
+  // The slot is kept in the connection itself, for pgConnectionRelease
+  //
+  if ((PQregisterEventProc(cP->connectionP, pgConnectionEventProc, "orionld-pool", NULL) == 0) ||
+      (PQsetInstanceData(cP->connectionP, pgConnectionEventProc, cP) == 0))
+  {
+    LM_E(("Internal Error (unable to attach the pool slot to a connection to postgres db '%s')", poolP->db));
+    PQfinish(cP->connectionP);
+    cP->connectionP = NULL;
+    return false;
+  }
+
+  __sync_fetch_and_add(&poolP->connects, 1);
+  return true;
+}
+
+
 
 // -----------------------------------------------------------------------------
 //
 // pgConnectionGet - get a connection to a postgres database
 //
-// FIXME: use a connection pool
-//
-// For now we open and close the connection every time - this is not very good for performance, of course ...
+// The connection is taken from the pool of the database (if the pool is on - see -troePoolSize).
+// If all connections of the pool are in use, the caller waits until one is released.
+// The connections are opened lazily and the lowest free slot is always picked, so an unloaded
+// broker keeps only a few connections open.
 //
 PGconn* pgConnectionGet(const char* db)
 {
@@ -78,56 +158,39 @@ PGconn* pgConnectionGet(const char* db)
   if ((db != NULL) && (*db == 0))
     db = dbName;
 
+  if (pgConnectionPoolInitialized == false)
+    return pgConnectionOpen(db);
+
+  PgConnectionPool* poolP = pgConnectionPoolLookup(db);
+
+  if (poolP == NULL)
+    return pgConnectionOpen(db);
+
+  __sync_fetch_and_add(&poolP->checkouts, 1);
+  pgConnectionPoolWait(poolP);
+
   //
-  // FIXME: connection pool: lookup a free connection to 'db' ...
+  // Now, one slot is guaranteed to be free - claim it
   //
-  // 1. PgDb* pgDbP = pgDatabaseLookup(db)
-  // 2. if (pgDbP == NULL)
-  //    {
-  // 3.   pgDbSemTake();
-  // 4.   pgDbP = pgDatabaseLookup(db);
-  // 5.   if (pgDbP == NULL)
-  // 6.     pgDbP = pgDatabaseAdd(db);
-  //    }
-  // 7.
-
-  char     port[16];
-  PGconn*  connectionP;
-  snprintf(port, sizeof(port), "%d", troePort);
-
-  int attemptNo   = 0;
-  int maxAttempts = 100;
-
-  while (attemptNo < maxAttempts)
+  PgConnection* cP = NULL;
+  while (cP == NULL)
   {
-    if (db != NULL)
+    for (int ix = 0; ix < poolP->size; ix++)
     {
-      const char*  keywords[]   = { "host",   "port",   "user",   "password",  "dbname", NULL };
-      const char*  values[]     = { troeHost, port,     troeUser, troePwd,     db,       NULL };
-
-      connectionP  = PQconnectdbParams(keywords, values, 0);  // 0: no expansion of dbname - see https://www.postgresql.org/docs/12/libpq-connect.html
+      if (__sync_bool_compare_and_swap(&poolP->connectionV[ix].taken, 0, 1) == true)
+      {
+        cP = &poolP->connectionV[ix];
+        break;
+      }
     }
-    else
-    {
-      const char*  keywords[]   = { "host",   "port",   "user",   "password",  NULL };
-      const char*  values[]     = { troeHost, port,     troeUser, troePwd,     NULL };
-
-      connectionP  = PQconnectdbParams(keywords, values, 0);  // 0: no expansion of dbname - see https://www.postgresql.org/docs/12/libpq-connect.html
-    }
-
-    ++attemptNo;
-    if (connectionP != NULL)
-      break;
-
-    usleep(100000);  // Sleep 0.1 seconds before we try again
   }
 
-  if (connectionP == NULL)
-    LM_RE(NULL, ("Database Error (unable  to connect to postgres('%s', %d, '%s', '%s', '%s')", troeHost, troePort, troeUser, troePwd, db));
+  if (pgConnectionCheck(poolP, cP) == false)
+  {
+    __sync_lock_release(&cP->taken);
+    sem_post(&poolP->freeSem);
+    return NULL;
+  }
 
-  LM_TMP(("TROE: connected to db '%s', at 0x%x (on connection attempt %d)", db, connectionP, attemptNo));
-#ifdef PG_CONNECTION_COUNT
-  connectionCountIncr("pgConnectionGet", connectionP);
-#endif
-  return connectionP;
+  return cP->connectionP;
 }
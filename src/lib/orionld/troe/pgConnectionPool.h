@@ -0,0 +1,63 @@
+#ifndef SRC_LIB_ORIONLD_TROE_PGCONNECTIONPOOL_H_
+#define SRC_LIB_ORIONLD_TROE_PGCONNECTIONPOOL_H_
+
+/*
+*
+* Copyright 2021 FIWARE Foundation e.V.
+*
+* This file is part of Orion-LD Context Broker.
+*
+* Orion-LD Context Broker is free software: you can redistribute it and/or
+* modify it under the terms of the GNU Affero General Public License as
+* published by the Free Software Foundation, either version 3 of the
+* License, or (at your option) any later version.
+*
+* Orion-LD Context Broker is distributed in the hope that it will be useful,
+* but WITHOUT ANY WARRANTY; without even the implied warranty of
+* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU Affero
+* General Public License for more details.
+*
+* You should have received a copy of the GNU Affero General Public License
+* along with Orion-LD Context Broker. If not, see http://www.gnu.org/licenses/.
+*
+* For those usages not covered by this license please contact with
+* orionld at fiware dot org
+*
+* Author: Ken Zangelin
+*/
+#include <semaphore.h>                                         // sem_t
+
+#include "orionld/troe/PgConnection.h"                         // PgConnectionPool
+
+
+
+// -----------------------------------------------------------------------------
+//
+// PG_CONNECTION_IDLE_CHECK - seconds of idle time after which a pooled connection is checked before it's used
+//
+#define PG_CONNECTION_IDLE_CHECK  30
+
+
+
+// -----------------------------------------------------------------------------
+//
+// PG_CONNECTION_POOL_BUCKETS - size of the hash table of connection pools, keyed by db name (must be a power of two)
+//
+#define PG_CONNECTION_POOL_BUCKETS  256
+
+
+
+// -----------------------------------------------------------------------------
+//
+// Postgres Connection Pool Variables
+//
+// The list and the buckets of the table are only ever prepended to (under pgConnectionPoolSem) and are
+// freed at exit, so readers traverse them without taking the semaphore.
+//
+extern PgConnectionPool*  pgConnectionPoolList;
+extern PgConnectionPool*  pgConnectionPoolTable[PG_CONNECTION_POOL_BUCKETS];
+extern sem_t              pgConnectionPoolSem;
+extern bool               pgConnectionPoolInitialized;
+extern int                pgConnectionPoolSize;
+
+#endif  // SRC_LIB_ORIONLD_TROE_PGCONNECTIONPOOL_H_
@@ -0,0 +1,126 @@
+/*
+*
+* Copyright 2021 FIWARE Foundation e.V.
+*
+* This file is part of Orion-LD Context Broker.
+*
+* Orion-LD Context Broker is free software: you can redistribute it and/or
+* modify it under the terms of the GNU Affero General Public License as
+* published by the Free Software Foundation, either version 3 of the
+* License, or (at your option) any later version.
+*
+* Orion-LD Context Broker is distributed in the hope that it will be useful,
+* but WITHOUT ANY WARRANTY; without even the implied warranty of
+* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU Affero
+* General Public License for more details.
+*
+* You should have received a copy of the GNU Affero General Public License
+* along with Orion-LD Context Broker. If not, see http://www.gnu.org/licenses/.
+*
+* For those usages not covered by this license please contact with
+* orionld at fiware dot org
+*
+* Author: Ken Zangelin
+*/
+#include <string.h>                                            // strcmp, strdup
+#include <stdlib.h>                                            // calloc, free
+#include <semaphore.h>                                         // sem_wait, sem_post, sem_init
+
+#include "logMsg/logMsg.h"                                     // LM_*
+#include "logMsg/traceLevels.h"                                // Lmt*
+
+#include "orionld/common/fnvHash.h"                            // fnvHash, FNV_HASH_INIT
+#include "orionld/troe/PgConnection.h"                         // PgConnectionPool
+#include "orionld/troe/pgConnectionPool.h"                     // pgConnectionPoolTable, pgConnectionPoolSem, ...
+#include "orionld/troe/pgConnectionPoolLookup.h"               // Own interface
+
+
+
+// -----------------------------------------------------------------------------
+//
+// pgConnectionPoolFind - look up the pool of 'db' in its bucket of pgConnectionPoolTable
+//
+static PgConnectionPool* pgConnectionPoolFind(const char* db, unsigned int hash)
+{
+  PgConnectionPool* poolP = __atomic_load_n(&pgConnectionPoolTable[hash & (PG_CONNECTION_POOL_BUCKETS - 1)], __ATOMIC_ACQUIRE);
+
+  while (poolP != NULL)
+  {
+    if ((poolP->hash == hash) && (strcmp(poolP->db, db) == 0))
+      return poolP;
+
+    poolP = poolP->bucketNext;
+  }
+
+  return NULL;
+}
+
+
+
+// -----------------------------------------------------------------------------
+//
+// pgConnectionPoolLookup -
+//
+// The lookup itself needs no lock - the pools are never removed (until exit) and a new pool is
+// published at the head of its bucket (and of the list) only once it is fully initialized.
+// Only the creation of a pool is serialized, and that happens once per tenant database.
+//
+PgConnectionPool* pgConnectionPoolLookup(const char* db)
+{
+  PgConnectionPool* poolP;
+
+  if (db == NULL)
+    db = "";
+
+  unsigned int       hash    = fnvHash(FNV_HASH_INIT, db, -1);
+  PgConnectionPool** bucketP = &pgConnectionPoolTable[hash & (PG_CONNECTION_POOL_BUCKETS - 1)];
+
+  if ((poolP = pgConnectionPoolFind(db, hash)) != NULL)
+    return poolP;
+
+  sem_wait(&pgConnectionPoolSem);
+
+  // Some other thread may have created it while we were waiting for the semaphore
+  if ((poolP = pgConnectionPoolFind(db, hash)) != NULL)
+  {
+    sem_post(&pgConnectionPoolSem);
+    return poolP;
+  }
+
+  poolP = (PgConnectionPool*) calloc(1, sizeof(PgConnectionPool));
+  if (poolP != NULL)
+  {
+    poolP->connectionV = (PgConnection*) calloc(pgConnectionPoolSize, sizeof(PgConnection));
+    poolP->db          = strdup(db);
+  }
+
+  if ((poolP == NULL) || (poolP->connectionV == NULL) || (poolP->db == NULL))
+  {
+    if (poolP != NULL)
+    {
+      free(poolP->connectionV);
+      free(poolP->db);
+    }
+
+    free(poolP);
+    sem_post(&pgConnectionPoolSem);
+    LM_RE(NULL, ("Internal Error (unable to allocate room for the connection pool of postgres db '%s')", db));
+  }
+
+  poolP->hash = hash;
+  poolP->size = pgConnectionPoolSize;
+  for (int ix = 0; ix < poolP->size; ix++)
+    poolP->connectionV[ix].poolP = poolP;
+
+  sem_init(&poolP->freeSem, 0, pgConnectionPoolSize);
+
+  poolP->next       = pgConnectionPoolList;
+  poolP->bucketNext = *bucketP;
+  __atomic_store_n(&pgConnectionPoolList, poolP, __ATOMIC_RELEASE);
+  __atomic_store_n(bucketP, poolP, __ATOMIC_RELEASE);
+
+  sem_post(&pgConnectionPoolSem);
+
+  LM_TMP(("TROE: created a pool of %d connections for postgres db '%s'", poolP->size, db));
+  return poolP;
+}
@@ -0,0 +1,68 @@
+/*
+*
+* Copyright 2021 FIWARE Foundation e.V.
+*
+* This file is part of Orion-LD Context Broker.
+*
+* Orion-LD Context Broker is free software: you can redistribute it and/or
+* modify it under the terms of the GNU Affero General Public License as
+* published by the Free Software Foundation, either version 3 of the
+* License, or (at your option) any later version.
+*
+* Orion-LD Context Broker is distributed in the hope that it will be useful,
+* but WITHOUT ANY WARRANTY; without even the implied warranty of
+* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU Affero
+* General Public License for more details.
+*
+* You should have received a copy of the GNU Affero General Public License
+* along with Orion-LD Context Broker. If not, see http://www.gnu.org/licenses/.
+*
+* For those usages not covered by this license please contact with
+* orionld at fiware dot org
+*
+* Author: Ken Zangelin
+*/
+#include <stdlib.h>                                            // free
+#include <string.h>                                            // memset
+#include <semaphore.h>                                         // sem_destroy
+#include <postgresql/libpq-fe.h>                               // PQfinish
+
+#include "orionld/troe/PgConnection.h"                         // PgConnectionPool
+#include "orionld/troe/pgConnectionPool.h"                     // pgConnectionPoolList, pgConnectionPoolTable, ...
+#include "orionld/troe/pgConnectionPoolRelease.h"              // Own interface
+
+
+
+// -----------------------------------------------------------------------------
+//
+// pgConnectionPoolRelease -
+//
+void pgConnectionPoolRelease(void)
+{
+  if (pgConnectionPoolInitialized == false)
+    return;
+
+  pgConnectionPoolInitialized = false;
+
+  PgConnectionPool* poolP = pgConnectionPoolList;
+  while (poolP != NULL)
+  {
+    PgConnectionPool* next = poolP->next;
+
+    for (int ix = 0; ix < poolP->size; ix++)
+    {
+      if (poolP->connectionV[ix].connectionP != NULL)
+        PQfinish(poolP->connectionV[ix].connectionP);
+    }
+
+    sem_destroy(&poolP->freeSem);
+    free(poolP->connectionV);
+    free(poolP->db);
+    free(poolP);
+
+    poolP = next;
+  }
+
+  pgConnectionPoolList = NULL;
+  memset(pgConnectionPoolTable, 0, sizeof(pgConnectionPoolTable));
+}
@@ -0,0 +1,108 @@
+/*
+*
+* Copyright 2021 FIWARE Foundation e.V.
+*
+* This file is part of Orion-LD Context Broker.
+*
+* Orion-LD Context Broker is free software: you can redistribute it and/or
+* modify it under the terms of the GNU Affero General Public License as
+* published by the Free Software Foundation, either version 3 of the
+* License, or (at your option) any later version.
+*
+* Orion-LD Context Broker is distributed in the hope that it will be useful,
+* but WITHOUT ANY WARRANTY; without even the implied warranty of
+* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU Affero
+* General Public License for more details.
+*
+* You should have received a copy of the GNU Affero General Public License
+* along with Orion-LD Context Broker. If not, see http://www.gnu.org/licenses/.
+*
+* For those usages not covered by this license please contact with
+* orionld at fiware dot org
+*
+* Author: Ken Zangelin
+*/
+#include <string>                                              // std::string
+#include <postgresql/libpq-fe.h>                               // PGconn
+
+#include "common/JsonHelper.h"                                 // JsonHelper
+
+#include "orionld/troe/PgConnection.h"                         // PgConnectionPool
+#include "orionld/troe/pgConnectionPool.h"                     // pgConnectionPoolList, pgConnectionPoolInitialized
+#include "orionld/troe/pgConnectionPoolStats.h"                // Own interface
+
+
+
+// -----------------------------------------------------------------------------
+//
+// pgConnectionPoolStats -
+//
+// One object per database:
+//   "size":         number of slots in the pool (-troePoolSize)
+//   "open":         connections currently open
+//   "inUse":        connections currently checked out
+//   "checkouts":    calls to pgConnectionGet
+//   "waits":        check-outs that had to wait for a connection to be released
+//   "waitTime":     accumulated time waiting, in seconds
+//   "waitTimeMax":  longest wait, in seconds
+//   "connects":     connections opened
+//   "reconnects":   broken connections detected (and reconnected)
+//
+std::string pgConnectionPoolStats(void)
+{
+  JsonHelper jh;
+
+  if (pgConnectionPoolInitialized == false)
+    return jh.str();
+
+  for (PgConnectionPool* poolP = __atomic_load_n(&pgConnectionPoolList, __ATOMIC_ACQUIRE); poolP != NULL; poolP = poolP->next)
+  {
+    JsonHelper  poolJh;
+    long long   open  = 0;
+    long long   inUse = 0;
+
+    for (int ix = 0; ix < poolP->size; ix++)
+    {
+      if (poolP->connectionV[ix].connectionP != NULL)
+        ++open;
+      if (poolP->connectionV[ix].taken != 0)
+        ++inUse;
+    }
+
+    poolJh.addNumber("size",        (long long) poolP->size);
+    poolJh.addNumber("open",        open);
+    poolJh.addNumber("inUse",       inUse);
+    poolJh.addNumber("checkouts",   (long long) __sync_fetch_and_add(&poolP->checkouts,   0));
+    poolJh.addNumber("waits",       (long long) __sync_fetch_and_add(&poolP->waits,       0));
+    poolJh.addNumber("waitTime",    __sync_fetch_and_add(&poolP->waitTime,    0) / 1000000.0);
+    poolJh.addNumber("waitTimeMax", __sync_fetch_and_add(&poolP->waitTimeMax, 0) / 1000000.0);
+    poolJh.addNumber("connects",    (long long) __sync_fetch_and_add(&poolP->connects,    0));
+    poolJh.addNumber("reconnects",  (long long) __sync_fetch_and_add(&poolP->reconnects,  0));
+
+    jh.addRaw((poolP->db[0] == 0)? "-" : poolP->db, poolJh.str());
+  }
+
+  return jh.str();
+}
+
+
+
+// -----------------------------------------------------------------------------
+//
+// pgConnectionPoolStatsReset -
+//
+void pgConnectionPoolStatsReset(void)
+{
+  if (pgConnectionPoolInitialized == false)
+    return;
+
+  for (PgConnectionPool* poolP = __atomic_load_n(&pgConnectionPoolList, __ATOMIC_ACQUIRE); poolP != NULL; poolP = poolP->next)
+  {
+    __sync_lock_test_and_set(&poolP->checkouts,   0);
+    __sync_lock_test_and_set(&poolP->waits,       0);
+    __sync_lock_test_and_set(&poolP->waitTime,    0);
+    __sync_lock_test_and_set(&poolP->waitTimeMax, 0);
+    __sync_lock_test_and_set(&poolP->connects,    0);
+    __sync_lock_test_and_set(&poolP->reconnects,  0);
+  }
+}
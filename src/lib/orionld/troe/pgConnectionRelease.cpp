@@ -22,24 +22,64 @@
 *
 * Author: Ken Zangelin
 */
+#include <time.h>                                              // time
+#include <semaphore.h>                                         // sem_post
 #include <postgresql/libpq-fe.h>                               // PGconn, PQfinish
+#include <postgresql/libpq-events.h>                           // PQinstanceData
 
 #include "logMsg/logMsg.h"                                     // LM_*
 #include "logMsg/traceLevels.h"                                // Lmt*
 
+#include "orionld/troe/PgConnection.h"                         // PgConnectionPool, PgConnection
+#include "orionld/troe/pgConnectionPool.h"                     // pgConnectionPoolInitialized
+#include "orionld/troe/pgConnectionEventProc.h"                // pgConnectionEventProc
+#include "orionld/troe/pgConnectionRelease.h"                  // Own interface
+
 
 
-#ifdef PG_CONNECTION_COUNT
-extern void connectionCountDecr(const char* who, void* connectionP);
-#endif
 // -----------------------------------------------------------------------------
 //
 // pgConnectionRelease - release a connection to a postgres database
 //
+// A pooled connection is given back to its pool, unless it is broken, in which case it's closed
+// (and the slot reconnects on its next use).
+// A connection that is still inside a transaction (a caller that neither committed nor rolled back)
+// is rolled back before it is given back.
+// The pool slot of the connection is found in the connection itself (see pgConnectionCheck in pgConnectionGet.cpp),
+// a connection without slot is not pooled.
+//
 void pgConnectionRelease(PGconn* connectionP)
 {
-  PQfinish(connectionP);
-#ifdef PG_CONNECTION_COUNT
-  connectionCountDecr("pgConnectionRelease", connectionP);
-#endif
+  PgConnectionPool*  poolP = NULL;
+  PgConnection*      cP    = NULL;
+
+  if (connectionP == NULL)
+    return;
+
+  if (pgConnectionPoolInitialized == true)
+    cP = (PgConnection*) PQinstanceData(connectionP, pgConnectionEventProc);
+
+  if (cP == NULL)
+  {
+    PQfinish(connectionP);
+    return;
+  }
+
+  poolP = cP->poolP;
+
+  if ((PQstatus(connectionP) == CONNECTION_OK) && (PQtransactionStatus(connectionP) != PQTRANS_IDLE))
+  {
+    LM_W(("TROE: connection to postgres db '%s' released inside a transaction - rolling back", poolP->db));
+    PQclear(PQexec(connectionP, "ROLLBACK"));
+  }
+
+  if ((PQstatus(connectionP) != CONNECTION_OK) || (PQtransactionStatus(connectionP) != PQTRANS_IDLE))
+  {
+    PQfinish(connectionP);
+    cP->connectionP = NULL;
+  }
+
+  cP->lastUsed = time(NULL);
+  __sync_lock_release(&cP->taken);
+  sem_post(&poolP->freeSem);
 }
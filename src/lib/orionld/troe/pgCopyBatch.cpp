@@ -1,9 +1,6 @@
-#ifndef SRC_LIB_ORIONLD_TYPES_ORIONLDPREFIXCACHE_H_
-#define SRC_LIB_ORIONLD_TYPES_ORIONLDPREFIXCACHE_H_
-
 /*
 *
-* Copyright 2019 FIWARE Foundation e.V.
+* Copyright 2021 FIWARE Foundation e.V.
 *
 * This file is part of Orion-LD Context Broker.
 *
@@ -25,51 +22,57 @@
 *
 * Author: Ken Zangelin
 */
+#include <stdlib.h>                                            // free
+
+#include "orionld/troe/PgCopyBuffer.h"                         // PgCopyBuffer, PgCopyBatch
+#include "orionld/troe/pgCopyBatch.h"                          // Own interface
 
 
 
 // -----------------------------------------------------------------------------
 //
-// Prefix Cache
+// PG_COPY_BUFFER_KEEP_MAX - buffers bigger than this are freed when the batch is reset
 //
-//   When prefixes are used, normally the very same, or very few prefixes are used.
-//   So, it makes sense to implement a cache for the prefix lookups.
-//   A simple vector of 10 key-values are used for this, as normal use-cases don't use
-//   more than just a few prefixes.
-//   And, the smaller the cache, the quicker the lookups (especially the no-hits).
+// A single huge batch shouldn't leave megabytes allocated in every thread that ever ran one.
 //
+#define PG_COPY_BUFFER_KEEP_MAX  (1024 * 1024)
 
 
 
 // -----------------------------------------------------------------------------
 //
-// ORIONLD_PREFIX_CACHE_SIZE - number of slots in the prefix cache
+// pgCopyBatch -
 //
-#define ORIONLD_PREFIX_CACHE_SIZE 10
+__thread PgCopyBatch pgCopyBatch = { { NULL, 0, 0, 0 }, { NULL, 0, 0, 0 }, { NULL, 0, 0, 0 } };
 
 
 
 // -----------------------------------------------------------------------------
 //
-// OrionldPrefixCacheItem -
+// pgCopyBufferReset -
 //
-typedef struct OrionldPrefixCacheItem
+static void pgCopyBufferReset(PgCopyBuffer* cbP)
 {
-  char* prefix;
-  char* expanded;
-} OrionldPrefixCacheItem;
+  if (cbP->size > PG_COPY_BUFFER_KEEP_MAX)
+  {
+    free(cbP->buf);
+    cbP->buf  = NULL;
+    cbP->size = 0;
+  }
+
+  cbP->used = 0;
+  cbP->rows = 0;
+}
 
 
 
 // -----------------------------------------------------------------------------
 //
-// OrionldPrefixCache -
+// pgCopyBatchReset -
 //
-typedef struct OrionldPrefixCache
+void pgCopyBatchReset(void)
 {
-  int                     index;
-  int                     items;
-  OrionldPrefixCacheItem  cache[ORIONLD_PREFIX_CACHE_SIZE];
-} OrionldPrefixCache;
-
-#endif  // SRC_LIB_ORIONLD_TYPES_ORIONLDPREFIXCACHE_H_
+  pgCopyBufferReset(&pgCopyBatch.entities);
+  pgCopyBufferReset(&pgCopyBatch.attributes);
+  pgCopyBufferReset(&pgCopyBatch.subAttributes);
+}
@@ -0,0 +1,54 @@
+/*
+*
+* Copyright 2021 FIWARE Foundation e.V.
+*
+* This file is part of Orion-LD Context Broker.
+*
+* Orion-LD Context Broker is free software: you can redistribute it and/or
+* modify it under the terms of the GNU Affero General Public License as
+* published by the Free Software Foundation, either version 3 of the
+* License, or (at your option) any later version.
+*
+* Orion-LD Context Broker is distributed in the hope that it will be useful,
+* but WITHOUT ANY WARRANTY; without even the implied warranty of
+* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU Affero
+* General Public License for more details.
+*
+* You should have received a copy of the GNU Affero General Public License
+* along with Orion-LD Context Broker. If not, see http://www.gnu.org/licenses/.
+*
+* For those usages not covered by this license please contact with
+* orionld at fiware dot org
+*
+* Author: Ken Zangelin
+*/
+#include <string.h>                                            // memcpy
+
+#include "logMsg/logMsg.h"                                     // LM_*
+#include "logMsg/traceLevels.h"                                // Lmt*
+
+#include "orionld/troe/PgCopyBuffer.h"                         // PgCopyBuffer
+#include "orionld/troe/pgCopyBufferEnsure.h"                   // pgCopyBufferEnsure
+#include "orionld/troe/pgCopyDataAppend.h"                     // Own interface
+
+
+
+// -----------------------------------------------------------------------------
+//
+// pgCopyDataAppend -
+//
+bool pgCopyDataAppend(PgCopyBuffer* cbP, const char* data, int len, int rows)
+{
+  if (len == 0)
+    return true;
+
+  if (pgCopyBufferEnsure(cbP, len) == false)
+    LM_RE(false, ("Internal Error (out of memory allocating TRoE COPY buffer of %d bytes)", cbP->used + len));
+
+  memcpy(&cbP->buf[cbP->used], data, len);
+
+  cbP->used += len;
+  cbP->rows += rows;
+
+  return true;
+}
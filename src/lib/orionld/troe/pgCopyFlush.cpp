@@ -0,0 +1,197 @@
+/*
+*
+* Copyright 2021 FIWARE Foundation e.V.
+*
+* This file is part of Orion-LD Context Broker.
+*
+* Orion-LD Context Broker is free software: you can redistribute it and/or
+* modify it under the terms of the GNU Affero General Public License as
+* published by the Free Software Foundation, either version 3 of the
+* License, or (at your option) any later version.
+*
+* Orion-LD Context Broker is distributed in the hope that it will be useful,
+* but WITHOUT ANY WARRANTY; without even the implied warranty of
+* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU Affero
+* General Public License for more details.
+*
+* You should have received a copy of the GNU Affero General Public License
+* along with Orion-LD Context Broker. If not, see http://www.gnu.org/licenses/.
+*
+* For those usages not covered by this license please contact with
+* orionld at fiware dot org
+*
+* Author: Ken Zangelin
+*/
+#include <stdio.h>                                             // snprintf
+#include <string.h>                                            // strcmp
+#include <postgresql/libpq-fe.h>                               // PGconn
+
+#include "logMsg/logMsg.h"                                     // LM_*
+#include "logMsg/traceLevels.h"                                // Lmt*
+
+#include "orionld/troe/PgCopyBuffer.h"                         // PgCopyBuffer, PG_*_COLUMNS
+#include "orionld/troe/pgCopyBatch.h"                          // pgCopyBatch
+#include "orionld/troe/pgCopyFlush.h"                          // Own interface
+
+
+
+// -----------------------------------------------------------------------------
+//
+// PG_UNIQUE_VIOLATION - SQLSTATE of a duplicate key
+//
+#define PG_UNIQUE_VIOLATION  "23505"
+
+
+
+// -----------------------------------------------------------------------------
+//
+// pgResultCheck - check the result of a statement, flagging unique violations
+//
+static bool pgResultCheck(PGresult* res, const char* what, const char* table, bool* uniqueViolationP)
+{
+  if (PQresultStatus(res) == PGRES_COMMAND_OK)
+    return true;
+
+  const char* sqlState = PQresultErrorField(res, PG_DIAG_SQLSTATE);
+
+  if ((sqlState != NULL) && (strcmp(sqlState, PG_UNIQUE_VIOLATION) == 0) && (uniqueViolationP != NULL))
+    *uniqueViolationP = true;
+
+  LM_E(("Database Error (%s %s: %s: %s)", what, table, PQresStatus(PQresultStatus(res)), PQresultErrorMessage(res)));
+  return false;
+}
+
+
+
+// -----------------------------------------------------------------------------
+//
+// pgStageTableCreate - create the staging table for idempotent writes to 'table', if it doesn't exist already
+//
+// The staging table is a temporary table, so it lives as long as the (pooled) connection, and its rows
+// are deleted on commit. The NOTICE of an existing table is silenced for the transaction.
+//
+static bool pgStageTableCreate(PGconn* connectionP, const char* table)
+{
+  char       sql[256];
+  PGresult*  res;
+  bool       ok;
+
+  snprintf(sql, sizeof(sql), "SET LOCAL client_min_messages TO warning; "
+           "CREATE TEMP TABLE IF NOT EXISTS %sStage (LIKE %s) ON COMMIT DELETE ROWS", table, table);
+
+  res = PQexec(connectionP, sql);
+  if (res == NULL)
+    LM_RE(false, ("Database Error (PQexec(CREATE TEMP TABLE %sStage): out of memory)", table));
+
+  ok = pgResultCheck(res, "CREATE TEMP TABLE", table, NULL);
+  PQclear(res);
+
+  return ok;
+}
+
+
+
+// -----------------------------------------------------------------------------
+//
+// pgCopyTable - send all rows of one table in a single COPY FROM STDIN
+//
+// If 'idempotent' is set, the rows are copied to the staging table of 'table' instead, and from there inserted
+// into 'table', ignoring the rows that are already there (ON CONFLICT DO NOTHING) - so that a transaction can be
+// written more than once, e.g. when it is replayed from the TRoE spill file after a crash.
+//
+static bool pgCopyTable(PGconn* connectionP, const char* table, const char* columns, PgCopyBuffer* cbP, bool idempotent, bool* uniqueViolationP)
+{
+  if (cbP->rows == 0)
+    return true;
+
+  char       sql[512];
+  char       copyTable[64];
+  PGresult*  res;
+
+  if (idempotent == true)
+  {
+    if (pgStageTableCreate(connectionP, table) == false)
+      return false;
+
+    snprintf(copyTable, sizeof(copyTable), "%sStage", table);
+  }
+  else
+    snprintf(copyTable, sizeof(copyTable), "%s", table);
+
+  snprintf(sql, sizeof(sql), "COPY %s(%s) FROM STDIN", copyTable, columns);
+  LM_TMP(("SQL[%p]: %s (%d rows, %d bytes)", connectionP, sql, cbP->rows, cbP->used));
+
+  res = PQexec(connectionP, sql);
+  if (res == NULL)
+    LM_RE(false, ("Database Error (PQexec(COPY %s): out of memory)", table));
+
+  if (PQresultStatus(res) != PGRES_COPY_IN)
+  {
+    LM_E(("Database Error (PQexec(COPY %s): %s: %s)", table, PQresStatus(PQresultStatus(res)), PQerrorMessage(connectionP)));
+    PQclear(res);
+    return false;
+  }
+  PQclear(res);
+
+  bool ok = true;
+
+  if (PQputCopyData(connectionP, cbP->buf, cbP->used) != 1)
+  {
+    LM_E(("Database Error (PQputCopyData(%s): %s)", table, PQerrorMessage(connectionP)));
+    ok = false;
+  }
+
+  //
+  // Ending the COPY with an error message makes the server abort it - nothing of the table is written
+  //
+  if (PQputCopyEnd(connectionP, (ok == true)? NULL : "TRoE batch aborted") != 1)
+  {
+    LM_E(("Database Error (PQputCopyEnd(%s): %s)", table, PQerrorMessage(connectionP)));
+    ok = false;
+  }
+
+  while ((res = PQgetResult(connectionP)) != NULL)
+  {
+    if (pgResultCheck(res, "COPY", copyTable, uniqueViolationP) == false)
+      ok = false;
+    PQclear(res);
+  }
+
+  if ((ok == false) || (idempotent == false))
+    return ok;
+
+  snprintf(sql, sizeof(sql), "INSERT INTO %s(%s) SELECT %s FROM %s ON CONFLICT DO NOTHING", table, columns, columns, copyTable);
+  LM_TMP(("SQL[%p]: INSERT INTO %s ... FROM %s", connectionP, table, copyTable));
+
+  res = PQexec(connectionP, sql);
+  if (res == NULL)
+    LM_RE(false, ("Database Error (PQexec(INSERT INTO %s): out of memory)", table));
+
+  ok = pgResultCheck(res, "INSERT INTO", table, uniqueViolationP);
+  PQclear(res);
+
+  return ok;
+}
+
+
+
+// -----------------------------------------------------------------------------
+//
+// pgCopyFlush -
+//
+// The three tables have no foreign keys, but entities go first anyway, then attributes, then sub-attributes,
+// so that a reader of a table never sees a sub-attribute whose attribute isn't there yet.
+//
+// *uniqueViolationP (if not NULL) is set to true if the rows failed due to a duplicate key.
+//
+bool pgCopyFlush(PGconn* connectionP, bool idempotent, bool* uniqueViolationP)
+{
+  if (uniqueViolationP != NULL)
+    *uniqueViolationP = false;
+
+  if (pgCopyTable(connectionP, "entities",      PG_ENTITIES_COLUMNS,      &pgCopyBatch.entities,      idempotent, uniqueViolationP) == false)  return false;
+  if (pgCopyTable(connectionP, "attributes",    PG_ATTRIBUTES_COLUMNS,    &pgCopyBatch.attributes,    idempotent, uniqueViolationP) == false)  return false;
+  if (pgCopyTable(connectionP, "subAttributes", PG_SUBATTRIBUTES_COLUMNS, &pgCopyBatch.subAttributes, idempotent, uniqueViolationP) == false)  return false;
+
+  return true;
+}
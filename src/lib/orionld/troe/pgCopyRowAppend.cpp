@@ -0,0 +1,102 @@
+/*
+*
+* Copyright 2021 FIWARE Foundation e.V.
+*
+* This file is part of Orion-LD Context Broker.
+*
+* Orion-LD Context Broker is free software: you can redistribute it and/or
+* modify it under the terms of the GNU Affero General Public License as
+* published by the Free Software Foundation, either version 3 of the
+* License, or (at your option) any later version.
+*
+* Orion-LD Context Broker is distributed in the hope that it will be useful,
+* but WITHOUT ANY WARRANTY; without even the implied warranty of
+* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU Affero
+* General Public License for more details.
+*
+* You should have received a copy of the GNU Affero General Public License
+* along with Orion-LD Context Broker. If not, see http://www.gnu.org/licenses/.
+*
+* For those usages not covered by this license please contact with
+* orionld at fiware dot org
+*
+* Author: Ken Zangelin
+*/
+#include <string.h>                                            // strlen
+
+#include "logMsg/logMsg.h"                                     // LM_*
+#include "logMsg/traceLevels.h"                                // Lmt*
+
+#include "orionld/troe/PgCopyBuffer.h"                         // PgCopyBuffer
+#include "orionld/troe/pgCopyBufferEnsure.h"                   // pgCopyBufferEnsure
+#include "orionld/troe/pgCopyRowAppend.h"                      // Own interface
+
+
+
+// -----------------------------------------------------------------------------
+//
+// PG_COPY_MAX_COLUMNS -
+//
+#define PG_COPY_MAX_COLUMNS  32
+
+
+
+// -----------------------------------------------------------------------------
+//
+// pgCopyRowAppend -
+//
+// COPY text format: columns separated by TAB, rows ended by NEWLINE, NULL as \N.
+// Backslash, TAB, NEWLINE and CR inside a value must be escaped with a backslash.
+// As the values are never part of an SQL string, single quotes need no escaping.
+//
+bool pgCopyRowAppend(PgCopyBuffer* cbP, const char** colV, int cols)
+{
+  int lenV[PG_COPY_MAX_COLUMNS];
+  int needed = 0;
+
+  if (cols > PG_COPY_MAX_COLUMNS)
+    LM_RE(false, ("Internal Error (too many columns for a COPY row: %d)", cols));
+
+  for (int ix = 0; ix < cols; ix++)
+  {
+    lenV[ix] = (colV[ix] == NULL)? 2 : strlen(colV[ix]);
+    needed  += 2 * lenV[ix] + 1;  // worst case: every char escaped, plus separator
+  }
+
+  if (pgCopyBufferEnsure(cbP, needed) == false)
+    LM_RE(false, ("Internal Error (out of memory allocating TRoE COPY buffer of %d bytes)", cbP->used + needed));
+
+  char* out = &cbP->buf[cbP->used];
+
+  for (int ix = 0; ix < cols; ix++)
+  {
+    if (ix != 0)
+      *out++ = '\t';
+
+    if (colV[ix] == NULL)
+    {
+      *out++ = '\\';
+      *out++ = 'N';
+      continue;
+    }
+
+    const char* in = colV[ix];
+    for (int cIx = 0; cIx < lenV[ix]; cIx++)
+    {
+      char c = in[cIx];
+
+      if      (c == '\\') { *out++ = '\\'; *out++ = '\\'; }
+      else if (c == '\t') { *out++ = '\\'; *out++ = 't';  }
+      else if (c == '\n') { *out++ = '\\'; *out++ = 'n';  }
+      else if (c == '\r') { *out++ = '\\'; *out++ = 'r';  }
+      else                  *out++ = c;
+    }
+  }
+
+  *out++ = '\n';
+
+  cbP->used  = out - cbP->buf;
+  cbP->rows += 1;
+
+  return true;
+}
@@ -28,6 +28,9 @@
 #include "logMsg/traceLevels.h"                                // Lmt*
 
 #include "orionld/common/orionldState.h"                       // orionldState
+#include "orionld/troe/PgCopyBuffer.h"                         // PG_ENTITIES_COLUMNS
+#include "orionld/troe/pgCopyBatch.h"                          // pgCopyBatch
+#include "orionld/troe/pgCopyRowAppend.h"                      // pgCopyRowAppend
 #include "orionld/troe/pgEntityDelete.h"                       // Own interface
 
 
@@ -38,15 +41,8 @@
 //
 bool pgEntityDelete(PGconn* connectionP, char* instanceId, char* id)
 {
-  char       sql[512];
-  PGresult*  res;
+  // Same order as PG_ENTITIES_COLUMNS
+  const char* colV[5] = { instanceId, orionldState.requestTimeString, "Delete", id, "NULL" };
 
-  snprintf(sql, sizeof(sql), "INSERT INTO entities VALUES ('%s', '%s', 'Delete', '%s', 'NULL')", instanceId, orionldState.requestTimeString, id);
-  LM_TMP(("SQL[%p]: %s", connectionP, sql));
-  res = PQexec(connectionP, sql);
-  if (res == NULL)
-    LM_RE(false, ("Database Error (%s)", PQresStatus(PQresultStatus(res))));
-  PQclear(res);
-
-  return true;
+  return pgCopyRowAppend(&pgCopyBatch.entities, colV, 5);
 }
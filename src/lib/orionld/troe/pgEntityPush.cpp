@@ -28,6 +28,9 @@
 #include "logMsg/traceLevels.h"                                // Lmt*
 
 #include "orionld/common/orionldState.h"                       // orionldState
+#include "orionld/troe/PgCopyBuffer.h"                         // PG_ENTITIES_COLUMNS
+#include "orionld/troe/pgCopyBatch.h"                          // pgCopyBatch
+#include "orionld/troe/pgCopyRowAppend.h"                      // pgCopyRowAppend
 #include "orionld/troe/pgEntityPush.h"                         // Own interface
 
 
@@ -38,15 +41,8 @@
 //
 bool pgEntityPush(PGconn* connectionP, char* instanceId, char* id, char* type, const char* opMode)
 {
-  char       sql[512];
-  PGresult*  res;
+  // Same order as PG_ENTITIES_COLUMNS
+  const char* colV[5] = { instanceId, orionldState.requestTimeString, opMode, id, type };
 
-  snprintf(sql, sizeof(sql), "INSERT INTO entities VALUES ('%s', '%s', '%s', '%s', '%s')", instanceId, orionldState.requestTimeString, opMode, id, type);
-  LM_TMP(("SQL[%p]: %s;", connectionP, sql));
-  res = PQexec(connectionP, sql);
-  if (res == NULL)
-    LM_RE(false, ("Database Error (%s)", PQresStatus(PQresultStatus(res))));
-  PQclear(res);
-
-  return true;
+  return pgCopyRowAppend(&pgCopyBatch.entities, colV, 5);
 }
@@ -22,7 +22,7 @@
 *
 * Author: Ken Zangelin
 */
-#include <stdio.h>                                             // snprintf
+#include <string.h>                                            // strcpy, strlen, strcat
 #include <postgresql/libpq-fe.h>                               // PGconn
 
 extern "C"
@@ -37,6 +37,7 @@ extern "C"
 
 #include "orionld/common/orionldState.h"                       // orionldState
 #include "orionld/troe/kjGeoLineStringExtract.h"               // kjGeoLineStringExtract
+#include "orionld/troe/pgAttributeAppend.h"                    // pgAttributeAppend
 #include "orionld/troe/pgGeoLineStringPush.h"                  // Own interface
 
 
@@ -58,61 +59,25 @@ bool pgGeoLineStringPush
   bool         subProperties
 )
 {
-  char*  lineStringCoordsString = kaAlloc(&orionldState.kalloc, 10240);
+  //
+  // The geography is rendered as EWKT: "SRID=4326;LINESTRING(<coordinates>)"
+  //
+  int    geoStringSize = 10240 + 32;
+  char*  geoString     = kaAlloc(&orionldState.kalloc, geoStringSize);
 
-  if (lineStringCoordsString == NULL)
+  if (geoString == NULL)
     LM_RE(false, ("Internal Error (out of memory)"));
 
-  if (kjGeoLineStringExtract(coordinatesP, lineStringCoordsString, 10240) == false)
-    LM_RE(false, ("unable to extract geo-coordinates from Kj-Tree"));
+  strcpy(geoString, "SRID=4326;LINESTRING(");
 
-  char*        sql = kaAlloc(&orionldState.kalloc, 12008);
-  PGresult*    res;
-  const char*  subPropertiesString = (subProperties == false)? "false" : "true";
-
-  if (sql == NULL)
-    LM_RE(false, ("Internal Error (out of memory)"));
-
-  //
-  // Four combinations for NULL/non-NULL 'datasetId' and 'observedAt'
-  //
-  if ((datasetId != NULL) && (observedAt != NULL))
-  {
-    snprintf(sql, 12007, "INSERT INTO attributes("
-             "opMode, ts, instanceId, id, entityId, observedAt, valueType, subProperties, datasetId, geoLineString) "
-             "VALUES ('%s', '%s', '%s', '%s', '%s', '%s', 'GeoLineString', %s, '%s', ST_GeomFromText('LINESTRING(%s)', 4326))",
-             opMode, orionldState.requestTimeString, attributeInstance, attributeName, entityId, observedAt, subPropertiesString, datasetId, lineStringCoordsString);
-  }
-  else if ((datasetId == NULL) && (observedAt == NULL))
-  {
-    snprintf(sql, 12007, "INSERT INTO attributes("
-             "opMode, ts, instanceId, id, entityId, valueType, subProperties, geoLineString) "
-             "VALUES ('%s', '%s', '%s', '%s', '%s', 'GeoLineString', %s, ST_GeomFromText('LINESTRING(%s)', 4326))",
-             opMode, orionldState.requestTimeString, attributeInstance, attributeName, entityId, subPropertiesString, lineStringCoordsString);
-  }
-  else if (datasetId != NULL)  // observedAt == NULL
-  {
-    snprintf(sql, 12007, "INSERT INTO attributes("
-             "opMode, ts, instanceId, id, entityId, valueType, subProperties, datasetId, geoLineString) "
-             "VALUES ('%s', '%s', '%s', '%s', '%s', 'GeoLineString', %s, '%s', ST_GeomFromText('LINESTRING(%s)', 4326))",
-             opMode, orionldState.requestTimeString, attributeInstance, attributeName, entityId, subPropertiesString, datasetId, lineStringCoordsString);
-  }
-  else  // observedAt != NULL, datasetId == NULL
-  {
-    snprintf(sql, 12007, "INSERT INTO attributes("
-             "opMode, ts, instanceId, id, entityId, observedAt, valueType, subProperties, geoLineString) "
-             "VALUES ('%s', '%s', '%s', '%s', '%s', '%s', 'GeoLineString', %s, ST_GeomFromText('LINESTRING(%s)', 4326))",
-             opMode, orionldState.requestTimeString, attributeInstance, attributeName, entityId, observedAt, subPropertiesString, lineStringCoordsString);
-  }
+  int prefixLen = strlen(geoString);
+  if (kjGeoLineStringExtract(coordinatesP, &geoString[prefixLen], 10240) == false)
+    LM_RE(false, ("unable to extract geo-coordinates from Kj-Tree"));
 
-  LM_TMP(("SQL[%p]: %s;", connectionP, sql));
-  res = PQexec(connectionP, sql);
-  if (res == NULL)
-    LM_RE(false, ("Database Error (%s)", PQresStatus(PQresultStatus(res))));
-  PQclear(res);
+  strcat(geoString, ")");
 
-  if (PQstatus(connectionP) != CONNECTION_OK)
-    LM_E(("SQL[%p]: bad connection: %d", connectionP, PQstatus(connectionP)));  // FIXME: string! (last error?)
+  const char* subPropertiesString = (subProperties == false)? "false" : "true";
 
-  return true;
+  return pgAttributeAppend(opMode, attributeInstance, attributeName, entityId, observedAt, subPropertiesString, NULL, datasetId,
+                           "GeoLineString", PgValueGeoLineString, geoString, orionldState.requestTimeString);
 }
@@ -22,6 +22,7 @@
 *
 * Author: Ken Zangelin
 */
+#include <string.h>                                            // strcpy, strlen, strcat
 #include <postgresql/libpq-fe.h>                               // PGconn
 
 extern "C"
@@ -35,6 +36,7 @@ extern "C"
 
 #include "orionld/common/orionldState.h"                       // orionldState
 #include "orionld/troe/kjGeoMultiPolygonExtract.h"             // kjGeoMultiPolygonExtract
+#include "orionld/troe/pgAttributeAppend.h"                    // pgAttributeAppend
 #include "orionld/troe/pgGeoMultiPolygonPush.h"                // Own interface
 
 
@@ -56,62 +58,25 @@ bool pgGeoMultiPolygonPush
   bool         subProperties
 )
 {
-  char* coordsString = kaAlloc(&orionldState.kalloc, 8 * 1024);
+  //
+  // The geography is rendered as EWKT: "SRID=4326;MULTIPOLYGON(<coordinates>)"
+  //
+  int    geoStringSize = 10240 + 32;
+  char*  geoString     = kaAlloc(&orionldState.kalloc, geoStringSize);
 
-  if (coordsString == NULL)
+  if (geoString == NULL)
     LM_RE(false, ("Internal Error (out of memory)"));
 
-  if (kjGeoMultiPolygonExtract(coordinatesP, coordsString, 8 * 1024) == false)
-    LM_RE(false, ("unable to extract geo-coordinates from Kj-Tree"));
+  strcpy(geoString, "SRID=4326;MULTIPOLYGON(");
 
-  int          sqlSize = 10 * 1024;
-  char*        sql     = kaAlloc(&orionldState.kalloc, sqlSize + 1);
-  PGresult*    res;
-  const char*  subPropertiesString = (subProperties == false)? "false" : "true";
-
-  if (sql == NULL)
-    LM_RE(false, ("Internal Error (out of memory)"));
-
-  //
-  // Four combinations for NULL/non-NULL 'datasetId' and 'observedAt'
-  //
-  if ((datasetId != NULL) && (observedAt != NULL))
-  {
-    snprintf(sql, sqlSize, "INSERT INTO attributes("
-             "opMode, ts, instanceId, id, entityId, observedAt, valueType, subProperties, datasetId, geoMultiPolygon) "
-             "VALUES ('%s', '%s', '%s', '%s', '%s', '%s', 'GeoMultiPolygon', %s, '%s', ST_GeomFromText('MULTIPOLYGON(%s)', 4326))",
-             opMode, orionldState.requestTimeString, attributeInstance, attributeName, entityId, observedAt, subPropertiesString, datasetId, coordsString);
-  }
-  else if ((datasetId == NULL) && (observedAt == NULL))
-  {
-    snprintf(sql, sqlSize, "INSERT INTO attributes("
-             "opMode, ts, instanceId, id, entityId, valueType, subProperties, geoMultiPolygon) "
-             "VALUES ('%s', '%s', '%s', '%s', '%s', 'GeoMultiPolygon', %s, ST_GeomFromText('MULTIPOLYGON(%s)', 4326))",
-             opMode, orionldState.requestTimeString, attributeInstance, attributeName, entityId, subPropertiesString, coordsString);
-  }
-  else if (datasetId != NULL)  // observedAt == NULL
-  {
-    snprintf(sql, sqlSize, "INSERT INTO attributes("
-             "opMode, ts, instanceId, id, entityId, valueType, subProperties, datasetId, geoMultiPolygon) "
-             "VALUES ('%s', '%s', '%s', '%s', '%s', 'GeoMultiPolygon', %s, '%s', ST_GeomFromText('MULTIPOLYGON(%s)', 4326))",
-             opMode, orionldState.requestTimeString, attributeInstance, attributeName, entityId, subPropertiesString, datasetId, coordsString);
-  }
-  else  // observedAt != NULL, datasetId == NULL
-  {
-    snprintf(sql, sqlSize, "INSERT INTO attributes("
-             "opMode, ts, instanceId, id, entityId, observedAt, valueType, subProperties, geoMultiPolygon) "
-             "VALUES ('%s', '%s', '%s', '%s', '%s', '%s', 'GeoMultiPolygon', %s, ST_GeomFromText('MULTIPOLYGON(%s)', 4326))",
-             opMode, orionldState.requestTimeString, attributeInstance, attributeName, entityId, observedAt, subPropertiesString, coordsString);
-  }
+  int prefixLen = strlen(geoString);
+  if (kjGeoMultiPolygonExtract(coordinatesP, &geoString[prefixLen], 10240) == false)
+    LM_RE(false, ("unable to extract geo-coordinates from Kj-Tree"));
 
-  LM_TMP(("SQL[%p]: %s;", connectionP, sql));
-  res = PQexec(connectionP, sql);
-  if (res == NULL)
-    LM_RE(false, ("Database Error (%s)", PQresStatus(PQresultStatus(res))));
-  PQclear(res);
+  strcat(geoString, ")");
 
-  if (PQstatus(connectionP) != CONNECTION_OK)
-    LM_E(("SQL[%p]: bad connection: %d", connectionP, PQstatus(connectionP)));  // FIXME: string! (last error?)
+  const char* subPropertiesString = (subProperties == false)? "false" : "true";
 
-  return true;
+  return pgAttributeAppend(opMode, attributeInstance, attributeName, entityId, observedAt, subPropertiesString, NULL, datasetId,
+                           "GeoMultiPolygon", PgValueGeoMultiPolygon, geoString, orionldState.requestTimeString);
 }
@@ -22,7 +22,7 @@
 *
 * Author: Ken Zangelin
 */
-#include <stdio.h>                                             // snprintf
+#include <string.h>                                            // strcpy, strlen, strcat
 #include <postgresql/libpq-fe.h>                               // PGconn
 
 extern "C"
@@ -36,6 +36,7 @@ extern "C"
 
 #include "orionld/common/orionldState.h"                       // orionldState
 #include "orionld/troe/kjGeoPolygonExtract.h"                  // kjGeoPolygonExtract
+#include "orionld/troe/pgAttributeAppend.h"                    // pgAttributeAppend
 #include "orionld/troe/pgGeoPolygonPush.h"                     // Own interface
 
 
@@ -57,61 +58,25 @@ bool pgGeoPolygonPush
   bool         subProperties
 )
 {
-  char*  polygonCoordsString = kaAlloc(&orionldState.kalloc, 10240);
+  //
+  // The geography is rendered as EWKT: "SRID=4326;POLYGON(<coordinates>)"
+  //
+  int    geoStringSize = 10240 + 32;
+  char*  geoString     = kaAlloc(&orionldState.kalloc, geoStringSize);
 
-  if (polygonCoordsString == NULL)
+  if (geoString == NULL)
     LM_RE(false, ("Internal Error (out of memory)"));
 
-  if (kjGeoPolygonExtract(coordinatesP, polygonCoordsString, 10240) == false)
-    LM_RE(false, ("unable to extract geo-coordinates from Kj-Tree"));
+  strcpy(geoString, "SRID=4326;POLYGON(");
 
-  char*        sql = kaAlloc(&orionldState.kalloc, 12008);
-  PGresult*    res;
-  const char*  subPropertiesString = (subProperties == false)? "false" : "true";
-
-  if (sql == NULL)
-    LM_RE(false, ("Internal Error (out of memory)"));
-
-  //
-  // Four combinations for NULL/non-NULL 'datasetId' and 'observedAt'
-  //
-  if ((datasetId != NULL) && (observedAt != NULL))
-  {
-    snprintf(sql, 12007, "INSERT INTO attributes("
-             "opMode, ts, instanceId, id, entityId, observedAt, valueType, subProperties, datasetId, geoPolygon) "
-             "VALUES ('%s', '%s', '%s', '%s', '%s', '%s', 'GeoPolygon', %s, '%s', ST_GeomFromText('POLYGON(%s)', 4326))",
-             opMode, orionldState.requestTimeString, attributeInstance, attributeName, entityId, observedAt, subPropertiesString, datasetId, polygonCoordsString);
-  }
-  else if ((datasetId == NULL) && (observedAt == NULL))
-  {
-    snprintf(sql, 12007, "INSERT INTO attributes("
-             "opMode, ts, instanceId, id, entityId, valueType, subProperties, geoPolygon) "
-             "VALUES ('%s', '%s', '%s', '%s', '%s', 'GeoPolygon', %s, ST_GeomFromText('POLYGON(%s)', 4326))",
-             opMode, orionldState.requestTimeString, attributeInstance, attributeName, entityId, subPropertiesString, polygonCoordsString);
-  }
-  else if (datasetId != NULL)  // observedAt == NULL
-  {
-    snprintf(sql, 12007, "INSERT INTO attributes("
-             "opMode, ts, instanceId, id, entityId, valueType, subProperties, datasetId, geoPolygon) "
-             "VALUES ('%s', '%s', '%s', '%s', '%s', 'GeoPolygon', %s, '%s', ST_GeomFromText('POLYGON(%s)', 4326))",
-             opMode, orionldState.requestTimeString, attributeInstance, attributeName, entityId, subPropertiesString, datasetId, polygonCoordsString);
-  }
-  else  // observedAt != NULL, datasetId == NULL
-  {
-    snprintf(sql, 12007, "INSERT INTO attributes("
-             "opMode, ts, instanceId, id, entityId, observedAt, valueType, subProperties, geoPolygon) "
-             "VALUES ('%s', '%s', '%s', '%s', '%s', '%s', 'GeoPolygon', %s, ST_GeomFromText('POLYGON(%s)', 4326))",
-             opMode, orionldState.requestTimeString, attributeInstance, attributeName, entityId, observedAt, subPropertiesString, polygonCoordsString);
-  }
+  int prefixLen = strlen(geoString);
+  if (kjGeoPolygonExtract(coordinatesP, &geoString[prefixLen], 10240) == false)
+    LM_RE(false, ("unable to extract geo-coordinates from Kj-Tree"));
 
-  LM_TMP(("SQL[%p]: %s;", connectionP, sql));
-  res = PQexec(connectionP, sql);
-  if (res == NULL)
-    LM_RE(false, ("Database Error (%s)", PQresStatus(PQresultStatus(res))));
-  PQclear(res);
+  strcat(geoString, ")");
 
-  if (PQstatus(connectionP) != CONNECTION_OK)
-    LM_E(("SQL[%p]: bad connection: %d", connectionP, PQstatus(connectionP)));  // FIXME: string! (last error?)
+  const char* subPropertiesString = (subProperties == false)? "false" : "true";
 
-  return true;
+  return pgAttributeAppend(opMode, attributeInstance, attributeName, entityId, observedAt, subPropertiesString, NULL, datasetId,
+                           "GeoPolygon", PgValueGeoPolygon, geoString, orionldState.requestTimeString);
 }
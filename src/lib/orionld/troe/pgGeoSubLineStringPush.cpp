@@ -22,11 +22,12 @@
 *
 * Author: Ken Zangelin
 */
-#include <stdio.h>                                             // snprintf
+#include <string.h>                                            // strcpy, strlen, strcat
 #include <postgresql/libpq-fe.h>                               // PGconn
 
 extern "C"
 {
+#include "kalloc/kaAlloc.h"                                    // kaAlloc
 #include "kjson/KjNode.h"                                      // KjNode
 }
 
@@ -35,6 +36,7 @@ extern "C"
 
 #include "orionld/common/orionldState.h"                       // orionldState
 #include "orionld/troe/kjGeoLineStringExtract.h"               // kjGeoLineStringExtract
+#include "orionld/troe/pgSubAttributeAppend.h"                 // pgSubAttributeAppend
 #include "orionld/troe/pgGeoSubLineStringPush.h"               // Own interface
 
 
@@ -54,47 +56,22 @@ bool pgGeoSubLineStringPush
   const char*  observedAt
 )
 {
-  char*  lineStringCoordsString = kaAlloc(&orionldState.kalloc, 10240);
-
-  if (lineStringCoordsString == NULL)
-    LM_RE(false, ("Internal Error (out of memory)"));
-
-  if (kjGeoLineStringExtract(coordinatesP, lineStringCoordsString, 10240) == false)
-    LM_RE(false, ("unable to extract geo-coordinates from Kj-Tree"));
-
-  int          sqlSize = 12007;
-  char*        sql     = kaAlloc(&orionldState.kalloc, sqlSize + 1);
-  PGresult*    res;
+  //
+  // The geography is rendered as EWKT: "SRID=4326;LINESTRING(<coordinates>)"
+  //
+  int    geoStringSize = 10240 + 32;
+  char*  geoString     = kaAlloc(&orionldState.kalloc, geoStringSize);
 
-  if (sql == NULL)
+  if (geoString == NULL)
     LM_RE(false, ("Internal Error (out of memory)"));
 
-  //
-  // Two combinations for NULL/non-NULL 'observedAt'
-  //
-  if (observedAt != NULL)
-  {
-    snprintf(sql, sqlSize, "INSERT INTO subAttributes("
-             "instanceId, ts, id, entityId, attrInstanceId, observedAt, valueType, geoLineString) "
-             "VALUES ('%s', '%s', '%s', '%s', '%s', '%s', 'GeoLineString', ST_GeomFromText('LINESTRING(%s)', 4326))",
-             instanceId, orionldState.requestTimeString, subAttributeName, entityId, attrInstanceId, observedAt, lineStringCoordsString);
-  }
-  else
-  {
-    snprintf(sql, sqlSize, "INSERT INTO subAttributes("
-             "instanceId, ts, id, entityId, attrInstanceId, valueType, geoLineString) "
-             "VALUES ('%s', '%s', '%s', '%s', '%s', 'GeoLineString', ST_GeomFromText('LINESTRING(%s)', 4326))",
-             instanceId, orionldState.requestTimeString, subAttributeName, entityId, attrInstanceId, lineStringCoordsString);
-  }
+  strcpy(geoString, "SRID=4326;LINESTRING(");
 
-  LM_TMP(("SQL[%p]: %s;", connectionP, sql));
-  res = PQexec(connectionP, sql);
-  if (res == NULL)
-    LM_RE(false, ("Database Error (%s)", PQresStatus(PQresultStatus(res))));
-  PQclear(res);
+  int prefixLen = strlen(geoString);
+  if (kjGeoLineStringExtract(coordinatesP, &geoString[prefixLen], 10240) == false)
+    LM_RE(false, ("unable to extract geo-coordinates from Kj-Tree"));
 
-  if (PQstatus(connectionP) != CONNECTION_OK)
-    LM_E(("SQL[%p]: bad connection: %d", connectionP, PQstatus(connectionP)));  // FIXME: string! (last error?)
+  strcat(geoString, ")");
 
-  return true;
+  return pgSubAttributeAppend(instanceId, subAttributeName, entityId, attrInstanceId, observedAt, NULL, "GeoLineString", PgValueGeoLineString, geoString, orionldState.requestTimeString);
 }
@@ -22,7 +22,7 @@
 *
 * Author: Ken Zangelin
 */
-#include <stdio.h>                                             // snprintf
+#include <string.h>                                            // strcpy, strlen, strcat
 #include <postgresql/libpq-fe.h>                               // PGconn
 
 extern "C"
@@ -36,7 +36,8 @@ extern "C"
 
 #include "orionld/common/orionldState.h"                       // orionldState
 #include "orionld/troe/kjGeoMultiLineStringExtract.h"             // kjGeoMultiLineStringExtract
-#include "orionld/troe/pgGeoSubMultiLineStringPush.h"             // Own interface
+#include "orionld/troe/pgSubAttributeAppend.h"                 // pgSubAttributeAppend
+#include "orionld/troe/pgGeoSubMultiLineStringPush.h"          // Own interface
 
 
 // -----------------------------------------------------------------------------
@@ -54,47 +55,22 @@ bool pgGeoSubMultiLineStringPush
   const char*  observedAt
 )
 {
-  char*  coordsString = kaAlloc(&orionldState.kalloc, 10240);
-
-  if (coordsString == NULL)
-    LM_RE(false, ("Internal Error (out of memory)"));
-
-  if (kjGeoMultiLineStringExtract(coordinatesP, coordsString, 10240) == false)
-    LM_RE(false, ("unable to extract geo-coordinates from Kj-Tree"));
-
-  int          sqlSize = 12008;
-  char*        sql     = kaAlloc(&orionldState.kalloc, sqlSize + 1);
-  PGresult*    res;
+  //
+  // The geography is rendered as EWKT: "SRID=4326;MULTILINESTRING(<coordinates>)"
+  //
+  int    geoStringSize = 10240 + 32;
+  char*  geoString     = kaAlloc(&orionldState.kalloc, geoStringSize);
 
-  if (sql == NULL)
+  if (geoString == NULL)
     LM_RE(false, ("Internal Error (out of memory)"));
 
-  //
-  // Two combinations for NULL/non-NULL 'observedAt'
-  //
-  if (observedAt != NULL)
-  {
-    snprintf(sql, sqlSize, "INSERT INTO subAttributes("
-             "instanceId, ts, id, entityId, attrInstanceId, observedAt, valueType, geoMultiLineString) "
-             "VALUES ('%s', '%s', '%s', '%s', '%s', '%s', 'GeoMultiLineString', ST_GeomFromText('MULTILINESTRING(%s)', 4326))",
-             instanceId, orionldState.requestTimeString, subAttributeName, entityId, attrInstanceId, observedAt, coordsString);
-  }
-  else
-  {
-    snprintf(sql, sqlSize, "INSERT INTO subAttributes("
-             "instanceId, ts, id, entityId, attrInstanceId, valueType, geoMultiLineString) "
-             "VALUES ('%s', '%s', '%s', '%s', '%s', 'GeoMultiLineString', ST_GeomFromText('MULTILINESTRING(%s)', 4326))",
-             instanceId, orionldState.requestTimeString, subAttributeName, entityId, attrInstanceId, coordsString);
-  }
+  strcpy(geoString, "SRID=4326;MULTILINESTRING(");
 
-  LM_TMP(("SQL[%p]: %s;", connectionP, sql));
-  res = PQexec(connectionP, sql);
-  if (res == NULL)
-    LM_RE(false, ("Database Error (%s)", PQresStatus(PQresultStatus(res))));
-  PQclear(res);
+  int prefixLen = strlen(geoString);
+  if (kjGeoMultiLineStringExtract(coordinatesP, &geoString[prefixLen], 10240) == false)
+    LM_RE(false, ("unable to extract geo-coordinates from Kj-Tree"));
 
-  if (PQstatus(connectionP) != CONNECTION_OK)
-    LM_E(("SQL[%p]: bad connection: %d", connectionP, PQstatus(connectionP)));  // FIXME: string! (last error?)
+  strcat(geoString, ")");
 
-  return true;
+  return pgSubAttributeAppend(instanceId, subAttributeName, entityId, attrInstanceId, observedAt, NULL, "GeoMultiLineString", PgValueGeoMultiLineString, geoString, orionldState.requestTimeString);
 }
@@ -35,6 +35,7 @@ extern "C"
 
 #include "orionld/common/orionldState.h"                       // orionldState
 #include "orionld/troe/kjGeoPointExtract.h"                    // kjGeoPointExtract
+#include "orionld/troe/pgSubAttributeAppend.h"                 // pgSubAttributeAppend
 #include "orionld/troe/pgGeoSubPointPush.h"                    // Own interface
 
 
@@ -60,35 +61,9 @@ bool pgGeoSubPointPush
   if (kjGeoPointExtract(coordinatesP, &longitude, &latitude, &altitude) == false)
     LM_RE(false, ("unable to extract geo-coordinates from Kj-Tree"));
 
-  char         sql[1024];
-  PGresult*    res;
+  char pointString[1024];
 
-  //
-  // Two combinations for NULL/non-NULL 'observedAt'
-  //
-  if (observedAt != NULL)
-  {
-    snprintf(sql, sizeof(sql), "INSERT INTO subAttributes("
-             "instanceId, ts, id, entityId, attrInstanceId, observedAt, valueType, geoPoint) "
-             "VALUES ('%s', '%s', '%s', '%s', '%s', '%s', 'GeoPoint', ST_GeomFromText('POINT Z(%f %f %f)'))",
-             instanceId, orionldState.requestTimeString, subAttributeName, entityId, attrInstanceId, observedAt, longitude, latitude, altitude);
-  }
-  else
-  {
-    snprintf(sql, sizeof(sql), "INSERT INTO subAttributes("
-             "instanceId, ts, id, entityId, attrInstanceId, valueType, geoPoint) "
-             "VALUES ('%s', '%s', '%s', '%s', '%s', 'GeoPoint', ST_GeomFromText('POINT Z(%f %f %f)'))",
-             instanceId, orionldState.requestTimeString, subAttributeName, entityId, attrInstanceId, longitude, latitude, altitude);
-  }
+  snprintf(pointString, sizeof(pointString), "POINT Z(%f %f %f)", longitude, latitude, altitude);
 
-  LM_TMP(("SQL[%p]: %s;", connectionP, sql));
-  res = PQexec(connectionP, sql);
-  if (res == NULL)
-    LM_RE(false, ("Database Error (%s)", PQresStatus(PQresultStatus(res))));
-  PQclear(res);
-
-  if (PQstatus(connectionP) != CONNECTION_OK)
-    LM_E(("SQL[%p]: bad connection: %d", connectionP, PQstatus(connectionP)));  // FIXME: string! (last error?)
-
-  return true;
+  return pgSubAttributeAppend(instanceId, subAttributeName, entityId, attrInstanceId, observedAt, NULL, "GeoPoint", PgValueGeoPoint, pointString, orionldState.requestTimeString);
 }
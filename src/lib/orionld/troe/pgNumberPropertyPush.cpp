@@ -29,6 +29,7 @@
 #include "logMsg/traceLevels.h"                                // Lmt*
 
 #include "orionld/common/orionldState.h"                       // orionldState
+#include "orionld/troe/pgAttributeAppend.h"                    // pgAttributeAppend
 #include "orionld/troe/pgNumberPropertyPush.h"                 // Own interface
 
 
@@ -51,61 +52,12 @@ bool pgNumberPropertyPush
   const char*  unitCode
 )
 {
-  char         sql[1024];
-  PGresult*    res;
-  const char*  subPropertiesString = (subProperties == false)? "false" : "true";
-  char         unitCodeStringV[128];
-  char*        unitCodeString;
+  char numberString[512];
 
-  if (unitCode == NULL)
-    unitCodeString = (char*) "NULL";
-  else
-  {
-    snprintf(unitCodeStringV, sizeof(unitCodeStringV), "'%s'", unitCode);
-    unitCodeString = unitCodeStringV;
-  }
+  snprintf(numberString, sizeof(numberString), "%f", numberValue);
 
-  //
-  // Four combinations for NULL/non-NULL 'datasetId' and 'observedAt'
-  //
-  if ((datasetId != NULL) && (observedAt != NULL))
-  {
-    snprintf(sql, sizeof(sql), "INSERT INTO attributes("
-             "opMode, instanceId, id, entityId, ts, observedAt, valueType, subProperties, datasetId, number, unitCode) "
-             "VALUES ('%s', '%s', '%s', '%s', '%s', '%s', 'Number', %s, '%s', %f, %s)",
-             opMode, attributeInstance, attributeName, entityId, orionldState.requestTimeString, observedAt, subPropertiesString, datasetId, numberValue, unitCodeString);
-  }
-  else if ((datasetId == NULL) && (observedAt == NULL))
-  {
-    snprintf(sql, sizeof(sql), "INSERT INTO attributes("
-             "opMode, instanceId, id, entityId, ts, valueType, subProperties, number, unitCode) "
-             "VALUES ('%s', '%s', '%s', '%s', '%s', 'Number', %s, %f, %s)",
-             opMode, attributeInstance, attributeName, entityId, orionldState.requestTimeString, subPropertiesString, numberValue, unitCodeString);
-  }
-  else if (datasetId != NULL)  // observedAt == NULL
-  {
-    snprintf(sql, sizeof(sql), "INSERT INTO attributes("
-             "opMode, instanceId, id, entityId, ts, valueType, subProperties, datasetId, number, unitCode) "
-             "VALUES ('%s', '%s', '%s', '%s', '%s', 'Number', %s, '%s', %f, %s)",
-             opMode, attributeInstance, attributeName, entityId, orionldState.requestTimeString, subPropertiesString, datasetId, numberValue, unitCodeString);
-  }
-  else  // observedAt != NULL, datasetId == NULL
-  {
-    snprintf(sql, sizeof(sql), "INSERT INTO attributes("
-             "opMode, instanceId, id, entityId, ts, observedAt, valueType, subProperties, number, unitCode) "
-             "VALUES ('%s', '%s', '%s', '%s', '%s', '%s', 'Number', %s, %f, %s)",
-             opMode, attributeInstance, attributeName, entityId, orionldState.requestTimeString, observedAt, subPropertiesString, numberValue, unitCodeString);
-  }
+  const char* subPropertiesString = (subProperties == false)? "false" : "true";
 
-
-  LM_TMP(("SQL[%p]: %s;", connectionP, sql));
-  res = PQexec(connectionP, sql);
-  if (res == NULL)
-    LM_RE(false, ("Database Error (%s)", PQresStatus(PQresultStatus(res))));
-  PQclear(res);
-
-  if (PQstatus(connectionP) != CONNECTION_OK)
-    LM_E(("SQL[%p]: bad connection: %d", connectionP, PQstatus(connectionP)));  // FIXME: string! (last error?)
-
-  return true;
+  return pgAttributeAppend(opMode, attributeInstance, attributeName, entityId, observedAt, subPropertiesString, unitCode, datasetId,
+                           "Number", PgValueNumber, numberString, orionldState.requestTimeString);
 }
@@ -29,6 +29,7 @@
 #include "logMsg/traceLevels.h"                                // Lmt*
 
 #include "orionld/common/orionldState.h"                       // orionldState
+#include "orionld/troe/pgSubAttributeAppend.h"                 // pgSubAttributeAppend
 #include "orionld/troe/pgNumberSubPropertyPush.h"              // Own interface
 
 
@@ -49,46 +50,9 @@ bool pgNumberSubPropertyPush
   const char*  unitCode
 )
 {
-  char   sql[1024];
-  char   unitCodeStringV[128];
-  char*  unitCodeString;
+  char numberString[512];
 
-  if (unitCode == NULL)
-    unitCodeString = (char*) "NULL";
-  else
-  {
-    snprintf(unitCodeStringV, sizeof(unitCodeStringV), "'%s'", unitCode);
-    unitCodeString = unitCodeStringV;
-  }
+  snprintf(numberString, sizeof(numberString), "%f", numberValue);
 
-  //
-  // Two combinations for NULL/non-NULL 'observedAt' (sub-attributes have no datasetId)
-  //
-  if (observedAt != NULL)
-  {
-    snprintf(sql, sizeof(sql), "INSERT INTO subAttributes("
-             "instanceId, id, entityId, attrInstanceId, ts, observedAt, valueType, number, unitCode) "
-             "VALUES ('%s', '%s', '%s', '%s', '%s', '%s', 'Number', %f, %s)",
-             instanceId, subAttributeName, entityId, attrInstanceId, orionldState.requestTimeString, observedAt, numberValue, unitCodeString);
-  }
-  else
-  {
-    snprintf(sql, sizeof(sql), "INSERT INTO subAttributes("
-             "instanceId, id, entityId, attrInstanceId, ts, valueType, number, unitCode) "
-             "VALUES ('%s', '%s', '%s', '%s', '%s', 'Number', %f, %s)",
-             instanceId, subAttributeName, entityId, attrInstanceId, orionldState.requestTimeString, numberValue, unitCodeString);
-  }
-  LM_TMP(("SQL[%p]: %s;", connectionP, sql));
-
-
-  PGresult* res;
-  res = PQexec(connectionP, sql);
-  if (res == NULL)
-    LM_RE(false, ("Database Error (%s)", PQresStatus(PQresultStatus(res))));
-  PQclear(res);
-
-  if (PQstatus(connectionP) != CONNECTION_OK)
-    LM_E(("SQL[%p]: bad connection: %d", connectionP, PQstatus(connectionP)));  // FIXME: string! (last error?)
-
-  return true;
+  return pgSubAttributeAppend(instanceId, subAttributeName, entityId, attrInstanceId, observedAt, unitCode, "Number", PgValueNumber, numberString, orionldState.requestTimeString);
 }
@@ -22,13 +22,13 @@
 *
 * Author: Ken Zangelin
 */
-#include <stdio.h>                                             // snprintf
 #include <postgresql/libpq-fe.h>                               // PGconn
 
 #include "logMsg/logMsg.h"                                     // LM_*
 #include "logMsg/traceLevels.h"                                // Lmt*
 
 #include "orionld/common/orionldState.h"                       // orionldState
+#include "orionld/troe/pgAttributeAppend.h"                    // pgAttributeAppend
 #include "orionld/troe/pgRelationshipPush.h"                   // Own interface
 
 
@@ -50,51 +50,8 @@ bool pgRelationshipPush
   bool         subProperties
 )
 {
-  char         sql[1024];
-  PGresult*    res;
-  const char*  subPropertiesString = (subProperties == false)? "false" : "true";
+  const char* subPropertiesString = (subProperties == false)? "false" : "true";
 
-  //
-  // Four combinations for NULL/non-NULL 'datasetId' and 'observedAt'
-  //
-  if ((datasetId != NULL) && (observedAt != NULL))
-  {
-    snprintf(sql, sizeof(sql), "INSERT INTO attributes("
-             "opMode, instanceId, id, entityId, ts, observedAt, valueType, subProperties, datasetId, text) "
-             "VALUES ('%s', '%s', '%s', '%s', '%s', '%s', 'Relationship', %s, '%s', '%s')",
-             opMode, attributeInstance, attributeName, entityId, orionldState.requestTimeString, observedAt, subPropertiesString, datasetId, object);
-  }
-  else if ((datasetId == NULL) && (observedAt == NULL))
-  {
-    snprintf(sql, sizeof(sql), "INSERT INTO attributes("
-             "opMode, instanceId, id, entityId, ts, valueType, subProperties, text) "
-             "VALUES ('%s', '%s', '%s', '%s', '%s', 'Relationship', %s, '%s');",
-             opMode, attributeInstance, attributeName, entityId, orionldState.requestTimeString, subPropertiesString, object);
-  }
-  else if (datasetId != NULL)  // observedAt == NULL
-  {
-    snprintf(sql, sizeof(sql), "INSERT INTO attributes("
-             "opMode, instanceId, id, entityId, ts, valueType, subProperties, datasetId, text) "
-             "VALUES ('%s', '%s', '%s', '%s', '%s', 'Relationship', %s, '%s', '%s');",
-             opMode, attributeInstance, attributeName, entityId, orionldState.requestTimeString, subPropertiesString, datasetId, object);
-  }
-  else  // observedAt != NULL, datasetId == NULL
-  {
-    snprintf(sql, sizeof(sql), "INSERT INTO attributes("
-             "opMode, instanceId, id, entityId, ts, observedAt, valueType, subProperties, text) "
-             "VALUES ('%s', '%s', '%s', '%s', '%s', '%s', 'Relationship', %s, '%s');",
-             opMode, attributeInstance, attributeName, entityId, orionldState.requestTimeString, observedAt, subPropertiesString, object);
-  }
-
-
-  LM_TMP(("SQL[%p]: %s;", connectionP, sql));
-  res = PQexec(connectionP, sql);
-  if (res == NULL)
-    LM_RE(false, ("Database Error (%s)", PQresStatus(PQresultStatus(res))));
-  PQclear(res);
-
-  if (PQstatus(connectionP) != CONNECTION_OK)
-    LM_E(("SQL[%p]: bad connection: %d", connectionP, PQstatus(connectionP)));  // FIXME: string! (last error?)
-
-  return true;
+  return pgAttributeAppend(opMode, attributeInstance, attributeName, entityId, observedAt, subPropertiesString, NULL, datasetId,
+                           "Relationship", PgValueText, object, orionldState.requestTimeString);
 }
@@ -0,0 +1,71 @@
+/*
+*
+* Copyright 2021 FIWARE Foundation e.V.
+*
+* This file is part of Orion-LD Context Broker.
+*
+* Orion-LD Context Broker is free software: you can redistribute it and/or
+* modify it under the terms of the GNU Affero General Public License as
+* published by the Free Software Foundation, either version 3 of the
+* License, or (at your option) any later version.
+*
+* Orion-LD Context Broker is distributed in the hope that it will be useful,
+* but WITHOUT ANY WARRANTY; without even the implied warranty of
+* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU Affero
+* General Public License for more details.
+*
+* You should have received a copy of the GNU Affero General Public License
+* along with Orion-LD Context Broker. If not, see http://www.gnu.org/licenses/.
+*
+* For those usages not covered by this license please contact with
+* orionld at fiware dot org
+*
+* Author: Ken Zangelin
+*/
+#include <unistd.h>                                            // NULL
+
+#include "orionld/troe/PgValueColumn.h"                        // PgValueColumn
+#include "orionld/troe/pgCopyBatch.h"                          // pgCopyBatch
+#include "orionld/troe/pgCopyRowAppend.h"                      // pgCopyRowAppend
+#include "orionld/troe/pgSubAttributeAppend.h"                 // Own interface
+
+
+
+// -----------------------------------------------------------------------------
+//
+// pgSubAttributeAppend -
+//
+// The columns are those of PG_SUBATTRIBUTES_COLUMNS, in the same order.
+//
+bool pgSubAttributeAppend
+(
+  const char*    instanceId,
+  const char*    id,
+  const char*    entityId,
+  const char*    attrInstanceId,
+  const char*    observedAt,
+  const char*    unitCode,
+  const char*    valueType,
+  PgValueColumn  valueColumn,
+  const char*    value,
+  const char*    ts
+)
+{
+  const char* colV[17] =
+  {
+    instanceId,
+    id,
+    entityId,
+    attrInstanceId,
+    observedAt,
+    unitCode,
+    valueType,
+    NULL, NULL, NULL, NULL, NULL, NULL, NULL, NULL, NULL,  // text ... geoMultiLineString
+    ts
+  };
+
+  if (valueColumn != PgValueNone)
+    colV[7 + valueColumn] = value;
+
+  return pgCopyRowAppend(&pgCopyBatch.subAttributes, colV, 17);
+}
@@ -27,7 +27,9 @@
 #include "logMsg/logMsg.h"                                     // LM_*
 #include "logMsg/traceLevels.h"                                // Lmt*
 
-#include "orionld/troe/pgEntityPush.h"                         // Own interface
+#include "orionld/troe/pgCopyBatch.h"                          // pgCopyBatchReset
+#include "orionld/troe/troeQueue.h"                            // TROE_QUEUE_CONNECTION
+#include "orionld/troe/pgTransactionBegin.h"                   // Own interface
 
 
 
@@ -35,12 +37,18 @@
 //
 // pgTransactionBegin - start a transaction
 //
-// FIXME: Use PQexecPrepared - prepared statements
+// The rows of the transaction are collected in the thread's COPY batch by the pg*Push functions
+// and sent to postgres by pgTransactionCommit.
 //
 bool pgTransactionBegin(PGconn* connectionP)
 {
   PGresult* res;
 
+  pgCopyBatchReset();
+
+  if (connectionP == TROE_QUEUE_CONNECTION)  // Write-behind - nothing to tell postgres (yet)
+    return true;
+
   LM_TMP(("SQL[%p]: BEGIN", connectionP));
   res = PQexec(connectionP, "BEGIN");
   if (res == NULL)
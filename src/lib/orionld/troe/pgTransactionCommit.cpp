@@ -27,6 +27,11 @@
 #include "logMsg/logMsg.h"                                     // LM_*
 #include "logMsg/traceLevels.h"                                // Lmt*
 
+#include "orionld/troe/pgCopyBatch.h"                          // pgCopyBatchReset
+#include "orionld/troe/pgCopyFlush.h"                          // pgCopyFlush
+#include "orionld/troe/pgTransactionRollback.h"                // pgTransactionRollback
+#include "orionld/troe/troeQueue.h"                            // TROE_QUEUE_CONNECTION
+#include "orionld/troe/troeQueueCommit.h"                      // troeQueueCommit
 #include "orionld/troe/pgTransactionCommit.h"                  // Own interface
 
 
@@ -35,10 +40,26 @@
 //
 // pgTransactionCommit - commit a transaction
 //
+// All rows of the transaction are sent first, one COPY per table.
+// If that fails, the transaction is rolled back and false is returned.
+//
+// With the write-behind queue on, the rows are queued instead, to be written to postgres by the TRoE workers.
+//
 bool pgTransactionCommit(PGconn* connectionP)
 {
   PGresult* res;
 
+  if (connectionP == TROE_QUEUE_CONNECTION)
+    return troeQueueCommit();
+
+  if (pgCopyFlush(connectionP, false, NULL) == false)
+  {
+    LM_E(("SQL[%p]: unable to send the rows of the transaction - rolling back", connectionP));
+    pgTransactionRollback(connectionP);
+    return false;
+  }
+  pgCopyBatchReset();
+
   LM_TMP(("SQL[%p]: COMMIT", connectionP));
   res = PQexec(connectionP, "COMMIT");
   if (res == NULL)
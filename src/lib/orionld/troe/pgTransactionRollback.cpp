@@ -27,6 +27,8 @@
 #include "logMsg/logMsg.h"                                     // LM_*
 #include "logMsg/traceLevels.h"                                // Lmt*
 
+#include "orionld/troe/pgCopyBatch.h"                          // pgCopyBatchReset
+#include "orionld/troe/troeQueue.h"                            // TROE_QUEUE_CONNECTION
 #include "orionld/troe/pgTransactionRollback.h"                // Own interface
 
 
@@ -39,6 +41,11 @@ bool pgTransactionRollback(PGconn* connectionP)
 {
   PGresult* res;
 
+  pgCopyBatchReset();  // The rows that were never sent are simply dropped
+
+  if (connectionP == TROE_QUEUE_CONNECTION)
+    return true;
+
   LM_TMP(("SQL[%p]: ROLLBACK", connectionP));
 
   res = PQexec(connectionP, "ROLLBACK");
@@ -30,8 +30,8 @@
 #include "orionld/common/orionldErrorResponse.h"               // orionldErrorResponseCreate
 #include "orionld/common/uuidGenerate.h"                       // uuidGenerate
 #include "orionld/context/orionldContextItemExpand.h"          // orionldContextItemExpand
-#include "orionld/troe/pgConnectionGet.h"                      // pgConnectionGet
-#include "orionld/troe/pgConnectionRelease.h"                  // pgConnectionRelease
+#include "orionld/troe/troeConnectionGet.h"                    // troeConnectionGet
+#include "orionld/troe/troeConnectionRelease.h"                // troeConnectionRelease
 #include "orionld/troe/pgTransactionBegin.h"                   // pgTransactionBegin
 #include "orionld/troe/pgTransactionRollback.h"                // pgTransactionRollback
 #include "orionld/troe/pgTransactionCommit.h"                  // pgTransactionCommit
@@ -46,13 +46,13 @@
 //
 bool troeDeleteAttribute(ConnectionInfo* ciP)
 {
-  PGconn* connectionP = pgConnectionGet(orionldState.troeDbName);
+  PGconn* connectionP = troeConnectionGet(orionldState.troeDbName);
   if (connectionP == NULL)
     LM_RE(false, ("no connection to postgres at %s", orionldState.tenant));
 
   if (pgTransactionBegin(connectionP) != true)
   {
-    pgConnectionRelease(connectionP);
+    troeConnectionRelease(connectionP);
     LM_RE(false, ("pgTransactionBegin failed"));
   }
 
@@ -70,17 +70,17 @@ bool troeDeleteAttribute(ConnectionInfo* ciP)
     if (pgTransactionRollback(connectionP) == false)
       LM_E(("pgTransactionRollback failed"));
 
-    pgConnectionRelease(connectionP);
+    troeConnectionRelease(connectionP);
     return false;
   }
 
   if (pgTransactionCommit(connectionP) != true)
   {
-    pgConnectionRelease(connectionP);
+    troeConnectionRelease(connectionP);
     LM_RE(false, ("pgTransactionCommit failed"));
   }
 
-  pgConnectionRelease(connectionP);
+  troeConnectionRelease(connectionP);
 
   return true;
 }
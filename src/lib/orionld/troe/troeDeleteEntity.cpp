@@ -31,8 +31,8 @@
 #include "orionld/common/orionldState.h"                       // orionldState
 #include "orionld/common/orionldErrorResponse.h"               // orionldErrorResponseCreate
 #include "orionld/common/uuidGenerate.h"                       // uuidGenerate
-#include "orionld/troe/pgConnectionGet.h"                      // pgConnectionGet
-#include "orionld/troe/pgConnectionRelease.h"                  // pgConnectionRelease
+#include "orionld/troe/troeConnectionGet.h"                    // troeConnectionGet
+#include "orionld/troe/troeConnectionRelease.h"                // troeConnectionRelease
 #include "orionld/troe/pgTransactionBegin.h"                   // pgTransactionBegin
 #include "orionld/troe/pgTransactionRollback.h"                // pgTransactionRollback
 #include "orionld/troe/pgTransactionCommit.h"                  // pgTransactionCommit
@@ -47,13 +47,13 @@
 //
 bool troeDeleteEntity(ConnectionInfo* ciP)
 {
-  PGconn* connectionP = pgConnectionGet(orionldState.troeDbName);
+  PGconn* connectionP = troeConnectionGet(orionldState.troeDbName);
   if (connectionP == NULL)
     LM_RE(false, ("no connection to postgres"));
 
   if (pgTransactionBegin(connectionP) != true)
   {
-    pgConnectionRelease(connectionP);
+    troeConnectionRelease(connectionP);
     LM_RE(false, ("pgTransactionBegin failed"));
   }
 
@@ -68,17 +68,17 @@ bool troeDeleteEntity(ConnectionInfo* ciP)
     if (pgTransactionRollback(connectionP) == false)
       LM_E(("pgTransactionRollback failed"));
 
-    pgConnectionRelease(connectionP);
+    troeConnectionRelease(connectionP);
     return false;
   }
 
   if (pgTransactionCommit(connectionP) != true)
   {
-    pgConnectionRelease(connectionP);
+    troeConnectionRelease(connectionP);
     LM_RE(false, ("pgTransactionCommit failed"));
   }
 
-  pgConnectionRelease(connectionP);
+  troeConnectionRelease(connectionP);
 
   return true;
 }
@@ -25,8 +25,10 @@
 #include "logMsg/logMsg.h"                                     // LM_*
 #include "logMsg/traceLevels.h"                                // Lmt*
 
-#include "orionld/common/orionldState.h"                       // dbName
+#include "orionld/common/orionldState.h"                       // dbName, troePoolSize, troeQueueSize, troeWorkers, troeSpillFile
+#include "orionld/troe/pgConnectionPoolInit.h"                 // pgConnectionPoolInit
 #include "orionld/troe/pgInit.h"                               // pgInit
+#include "orionld/troe/troeQueueInit.h"                        // troeQueueInit
 #include "orionld/troe/troeInit.h"                             // Own interface
 
 
@@ -37,8 +39,13 @@
 //
 bool troeInit(void)
 {
+  pgConnectionPoolInit(troePoolSize);
+
   if (pgInit(dbName) == false)
     LM_RE(false, ("Basic Postgres Problem - Temporal Representation of Entities is not possible"));
 
+  if ((troeQueueSize > 0) && (troeQueueInit(troeQueueSize, troeWorkers, troeSpillFile) == false))
+    LM_RE(false, ("Unable to start the TRoE write-behind queue"));
+
   return true;
 }
@@ -35,8 +35,8 @@ extern "C"
 #include "rest/ConnectionInfo.h"                               // ConnectionInfo
 #include "orionld/common/orionldState.h"                       // orionldState
 #include "orionld/common/orionldErrorResponse.h"               // orionldErrorResponseCreate
-#include "orionld/troe/pgConnectionGet.h"                      // pgConnectionGet
-#include "orionld/troe/pgConnectionRelease.h"                  // pgConnectionRelease
+#include "orionld/troe/troeConnectionGet.h"                    // troeConnectionGet
+#include "orionld/troe/troeConnectionRelease.h"                // troeConnectionRelease
 #include "orionld/troe/pgTransactionBegin.h"                   // pgTransactionBegin
 #include "orionld/troe/pgTransactionRollback.h"                // pgTransactionRollback
 #include "orionld/troe/pgTransactionCommit.h"                  // pgTransactionCommit
@@ -62,13 +62,13 @@ bool troePostBatchCreate(ConnectionInfo* ciP)
   // Expanding entity types and attribute names - FIXME: Remove once orionldPostBatchCreate.cpp has been fixed to do that
   troeEntityArrayExpand(orionldState.requestTree);
 
-  connectionP = pgConnectionGet(orionldState.troeDbName);
+  connectionP = troeConnectionGet(orionldState.troeDbName);
   if (connectionP == NULL)
     LM_RE(false, ("no connection to postgres"));
 
   if (pgTransactionBegin(connectionP) != true)
   {
-    pgConnectionRelease(connectionP);
+    troeConnectionRelease(connectionP);
     LM_RE(false, ("pgTransactionBegin failed"));
   }
 
@@ -89,17 +89,17 @@ bool troePostBatchCreate(ConnectionInfo* ciP)
     if (pgTransactionRollback(connectionP) == false)
       LM_E(("pgTransactionRollback failed"));
 
-    pgConnectionRelease(connectionP);
+    troeConnectionRelease(connectionP);
     return false;
   }
 
   if (pgTransactionCommit(connectionP) != true)
   {
-    pgConnectionRelease(connectionP);
+    troeConnectionRelease(connectionP);
     LM_RE(false, ("pgTransactionCommit failed"));
   }
 
-  pgConnectionRelease(connectionP);
+  troeConnectionRelease(connectionP);
 
   return true;
 }
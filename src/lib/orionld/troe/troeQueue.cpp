@@ -0,0 +1,272 @@
+/*
+*
+* Copyright 2021 FIWARE Foundation e.V.
+*
+* This file is part of Orion-LD Context Broker.
+*
+* Orion-LD Context Broker is free software: you can redistribute it and/or
+* modify it under the terms of the GNU Affero General Public License as
+* published by the Free Software Foundation, either version 3 of the
+* License, or (at your option) any later version.
+*
+* Orion-LD Context Broker is distributed in the hope that it will be useful,
+* but WITHOUT ANY WARRANTY; without even the implied warranty of
+* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU Affero
+* General Public License for more details.
+*
+* You should have received a copy of the GNU Affero General Public License
+* along with Orion-LD Context Broker. If not, see http://www.gnu.org/licenses/.
+*
+* For those usages not covered by this license please contact with
+* orionld at fiware dot org
+*
+* Author: Ken Zangelin
+*/
+#include <stdlib.h>                                            // malloc, free
+#include <string.h>                                            // memcpy, strncpy, strcmp, bzero
+#include <pthread.h>                                           // pthread_mutex_*, pthread_cond_*
+
+#include "logMsg/logMsg.h"                                     // LM_*
+#include "logMsg/traceLevels.h"                                // Lmt*
+
+#include "orionld/troe/PgCopyBuffer.h"                         // PgCopyBatch
+#include "orionld/troe/TroeQueueItem.h"                        // TroeQueueItem
+#include "orionld/troe/troeQueueSpill.h"                       // troeQueueSpillFd, troeQueueSpillMutex, troeQueueSpillAppend, ...
+#include "orionld/troe/troeQueue.h"                            // Own interface
+
+
+
+// -----------------------------------------------------------------------------
+//
+// TRoE Write-Behind Queue Variables
+//
+TroeQueueItem**     troeQueueV           = NULL;
+int                 troeQueueSlots       = 0;
+int                 troeQueueTail        = 0;
+int                 troeQueuePopIx       = 0;
+int                 troeQueueItems       = 0;
+int                 troeQueueQueued      = 0;
+pthread_mutex_t     troeQueueMutex;
+pthread_cond_t      troeQueueNotEmpty;
+bool                troeQueueInitialized = false;
+
+
+
+// -----------------------------------------------------------------------------
+//
+// troeQueueConnection - its address is the sentinel connection TROE_QUEUE_CONNECTION
+//
+char                troeQueueConnection  = 0;
+__thread char       troeQueueDb[128];
+
+
+
+// -----------------------------------------------------------------------------
+//
+// TRoE Write-Behind Queue Counters
+//
+unsigned long long  troeQueuePushed      = 0;
+unsigned long long  troeQueueWritten     = 0;
+unsigned long long  troeQueueFailed      = 0;
+unsigned long long  troeQueueSyncWrites  = 0;
+unsigned long long  troeQueueReplayed    = 0;
+int                 troeQueueInFlight    = 0;
+
+
+
+// -----------------------------------------------------------------------------
+//
+// troeQueueItemCreate -
+//
+TroeQueueItem* troeQueueItemCreate(const char* db, PgCopyBatch* batchP)
+{
+  int             dataLen = batchP->entities.used + batchP->attributes.used + batchP->subAttributes.used;
+  TroeQueueItem*  itemP   = (TroeQueueItem*) malloc(sizeof(TroeQueueItem) + dataLen);
+
+  if (itemP == NULL)
+    LM_RE(NULL, ("Internal Error (out of memory allocating a TRoE queue item of %d bytes)", dataLen));
+
+  bzero(&itemP->record, sizeof(itemP->record));
+
+  itemP->record.magic             = TROE_QUEUE_RECORD_MAGIC;
+  itemP->record.dataLen           = dataLen;
+  itemP->record.entitiesLen       = batchP->entities.used;
+  itemP->record.entitiesRows      = batchP->entities.rows;
+  itemP->record.attributesLen     = batchP->attributes.used;
+  itemP->record.attributesRows    = batchP->attributes.rows;
+  itemP->record.subAttributesLen  = batchP->subAttributes.used;
+  itemP->record.subAttributesRows = batchP->subAttributes.rows;
+  strncpy(itemP->record.db, db, sizeof(itemP->record.db) - 1);
+
+  itemP->state    = TroeQueueItemQueued;
+  itemP->spillEnd = -1;
+  itemP->data     = (char*) &itemP[1];
+
+  char* dataP = itemP->data;
+
+  if (batchP->entities.used > 0)
+    memcpy(dataP, batchP->entities.buf, batchP->entities.used);
+  dataP += batchP->entities.used;
+
+  if (batchP->attributes.used > 0)
+    memcpy(dataP, batchP->attributes.buf, batchP->attributes.used);
+  dataP += batchP->attributes.used;
+
+  if (batchP->subAttributes.used > 0)
+    memcpy(dataP, batchP->subAttributes.buf, batchP->subAttributes.used);
+
+  return itemP;
+}
+
+
+
+// -----------------------------------------------------------------------------
+//
+// troeQueuePush -
+//
+// The item is appended to the spill file before it's queued, so once this function has returned true,
+// the transaction survives a crash of the broker.
+//
+// The spill file is written without holding troeQueueMutex - the workers keep on popping while a request thread writes.
+// troeQueueSpillMutex is held from the check for room in the queue until the item is queued:
+//   - the items are queued in the same order as they are in the spill file (the checkpoint relies on that)
+//   - no other push can take the room found free (the workers only free slots)
+//
+bool troeQueuePush(TroeQueueItem* itemP)
+{
+  bool spill = (troeQueueSpillFd != -1);
+
+  if (spill == true)
+    pthread_mutex_lock(&troeQueueSpillMutex);
+
+  pthread_mutex_lock(&troeQueueMutex);
+
+  if (troeQueueItems >= troeQueueSlots)
+  {
+    pthread_mutex_unlock(&troeQueueMutex);
+    if (spill == true)
+      pthread_mutex_unlock(&troeQueueSpillMutex);
+    return false;
+  }
+
+  if (spill == true)
+  {
+    pthread_mutex_unlock(&troeQueueMutex);
+
+    if (troeQueueSpillAppend(itemP) == false)
+    {
+      pthread_mutex_unlock(&troeQueueSpillMutex);
+      return false;
+    }
+
+    pthread_mutex_lock(&troeQueueMutex);
+  }
+
+  troeQueueV[(troeQueueTail + troeQueueItems) % troeQueueSlots] = itemP;
+
+  ++troeQueueItems;
+  ++troeQueueQueued;
+  ++troeQueuePushed;
+
+  pthread_cond_signal(&troeQueueNotEmpty);
+  pthread_mutex_unlock(&troeQueueMutex);
+
+  if (spill == true)
+    pthread_mutex_unlock(&troeQueueSpillMutex);
+
+  return true;
+}
+
+
+
+// -----------------------------------------------------------------------------
+//
+// troeQueuePop -
+//
+// Only consecutive items for the same database are taken, as they're all written in one single transaction.
+//
+int troeQueuePop(TroeQueueItem** itemV, int maxItems)
+{
+  int          items = 0;
+  int          bytes = 0;
+  const char*  db    = NULL;
+
+  pthread_mutex_lock(&troeQueueMutex);
+
+  while (troeQueueQueued == 0)
+    pthread_cond_wait(&troeQueueNotEmpty, &troeQueueMutex);
+
+  while ((items < maxItems) && (troeQueueQueued > 0))
+  {
+    TroeQueueItem* itemP = troeQueueV[troeQueuePopIx];
+
+    if (db == NULL)
+      db = itemP->record.db;
+    else if ((strcmp(itemP->record.db, db) != 0) || (bytes + (int) itemP->record.dataLen > TROE_QUEUE_BATCH_MAX_BYTES))
+      break;
+
+    itemP->state   = TroeQueueItemInFlight;
+    itemV[items++] = itemP;
+    bytes         += itemP->record.dataLen;
+
+    troeQueuePopIx = (troeQueuePopIx + 1) % troeQueueSlots;
+    --troeQueueQueued;
+    ++troeQueueInFlight;
+  }
+
+  // More items left? Then wake up another worker
+  if (troeQueueQueued > 0)
+    pthread_cond_signal(&troeQueueNotEmpty);
+
+  pthread_mutex_unlock(&troeQueueMutex);
+
+  return items;
+}
+
+
+
+// -----------------------------------------------------------------------------
+//
+// troeQueueDone -
+//
+void troeQueueDone(TroeQueueItem** itemV, int items, bool written)
+{
+  long long checkpoint = -1;
+
+  pthread_mutex_lock(&troeQueueMutex);
+
+  for (int ix = 0; ix < items; ix++)
+    itemV[ix]->state = TroeQueueItemDone;
+
+  troeQueueInFlight -= items;
+
+  if (written == true)
+    troeQueueWritten += items;
+  else
+    troeQueueFailed  += items;
+
+  //
+  // Free the slots from the tail, as long as their items are done
+  //
+  while ((troeQueueItems > 0) && (troeQueueV[troeQueueTail]->state == TroeQueueItemDone))
+  {
+    TroeQueueItem* itemP = troeQueueV[troeQueueTail];
+
+    if (itemP->spillEnd != -1)
+      checkpoint = itemP->spillEnd;
+
+    free(itemP);
+    troeQueueV[troeQueueTail] = NULL;
+    troeQueueTail = (troeQueueTail + 1) % troeQueueSlots;
+    --troeQueueItems;
+  }
+
+  pthread_mutex_unlock(&troeQueueMutex);
+
+  //
+  // The spill file is updated outside the queue lock - troeQueueSpillCheckpoint ignores checkpoints that
+  // arrive after a later one, from another worker
+  //
+  if ((troeQueueSpillFd != -1) && (checkpoint != -1))
+    troeQueueSpillCheckpoint(checkpoint);
+}
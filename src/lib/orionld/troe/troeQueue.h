@@ -0,0 +1,135 @@
+#ifndef SRC_LIB_ORIONLD_TROE_TROEQUEUE_H_
+#define SRC_LIB_ORIONLD_TROE_TROEQUEUE_H_
+
+/*
+*
+* Copyright 2021 FIWARE Foundation e.V.
+*
+* This file is part of Orion-LD Context Broker.
+*
+* Orion-LD Context Broker is free software: you can redistribute it and/or
+* modify it under the terms of the GNU Affero General Public License as
+* published by the Free Software Foundation, either version 3 of the
+* License, or (at your option) any later version.
+*
+* Orion-LD Context Broker is distributed in the hope that it will be useful,
+* but WITHOUT ANY WARRANTY; without even the implied warranty of
+* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU Affero
+* General Public License for more details.
+*
+* You should have received a copy of the GNU Affero General Public License
+* along with Orion-LD Context Broker. If not, see http://www.gnu.org/licenses/.
+*
+* For those usages not covered by this license please contact with
+* orionld at fiware dot org
+*
+* Author: Ken Zangelin
+*/
+#include <pthread.h>                                           // pthread_mutex_t, pthread_cond_t
+#include <postgresql/libpq-fe.h>                               // PGconn
+
+#include "orionld/troe/PgCopyBuffer.h"                         // PgCopyBatch
+#include "orionld/troe/TroeQueueItem.h"                        // TroeQueueItem
+
+
+
+// -----------------------------------------------------------------------------
+//
+// TROE_QUEUE_BATCH_MAX_ITEMS - max number of queued transactions written to postgres in one go
+// TROE_QUEUE_BATCH_MAX_BYTES - max number of bytes of rows written to postgres in one go
+//
+#define TROE_QUEUE_BATCH_MAX_ITEMS  256
+#define TROE_QUEUE_BATCH_MAX_BYTES  (4 * 1024 * 1024)
+
+
+
+// -----------------------------------------------------------------------------
+//
+// TROE_QUEUE_MAX_ATTEMPTS - number of times a worker tries to write a transaction before giving up on it
+//
+// Only failed writes count - while postgres can't be reached at all, the workers keep on trying.
+//
+#define TROE_QUEUE_MAX_ATTEMPTS  5
+
+
+
+// -----------------------------------------------------------------------------
+//
+// TRoE Write-Behind Queue Variables
+//
+// troeQueueV is a ring of troeQueueSize slots. Items are taken by the workers in FIFO order
+// (from troeQueuePopIx), but a slot is only freed once its item has been written to postgres,
+// in order, from troeQueueTail - so, the spill file checkpoint never passes an unwritten item.
+//
+extern TroeQueueItem**     troeQueueV;
+extern int                 troeQueueSlots;
+extern int                 troeQueueTail;
+extern int                 troeQueuePopIx;
+extern int                 troeQueueItems;       // Slots in use (queued + in flight + done but not yet freed)
+extern int                 troeQueueQueued;      // Items not yet taken by any worker
+extern pthread_mutex_t     troeQueueMutex;
+extern pthread_cond_t      troeQueueNotEmpty;
+extern bool                troeQueueInitialized;
+
+
+
+// -----------------------------------------------------------------------------
+//
+// TRoE Write-Behind Queue Counters - protected by troeQueueMutex
+//
+extern unsigned long long  troeQueuePushed;      // Transactions queued
+extern unsigned long long  troeQueueWritten;     // Transactions written to postgres by the workers
+extern unsigned long long  troeQueueFailed;      // Transactions given up on after TROE_QUEUE_MAX_ATTEMPTS failed writes
+extern unsigned long long  troeQueueSyncWrites;  // Transactions written by the request thread as the queue was full
+extern unsigned long long  troeQueueReplayed;    // Transactions recovered from the spill file at startup
+extern int                 troeQueueInFlight;
+
+
+
+// -----------------------------------------------------------------------------
+//
+// TROE_QUEUE_CONNECTION - the "connection" handed to the TRoE routines when the write-behind queue is on
+//
+// pgTransactionBegin/Commit/Rollback recognize it and, instead of talking to postgres, the COPY batch
+// of the transaction is queued on commit, for the database in troeQueueDb.
+//
+extern char              troeQueueConnection;
+extern __thread char     troeQueueDb[128];
+
+#define TROE_QUEUE_CONNECTION  ((PGconn*) &troeQueueConnection)
+
+
+
+// -----------------------------------------------------------------------------
+//
+// troeQueueItemCreate - create a queue item from a TRoE batch
+//
+extern TroeQueueItem* troeQueueItemCreate(const char* db, PgCopyBatch* batchP);
+
+
+
+// -----------------------------------------------------------------------------
+//
+// troeQueuePush - add an item to the queue (and to the spill file)
+//
+// Returns false if the queue is full - the item is then NOT queued.
+//
+extern bool troeQueuePush(TroeQueueItem* itemP);
+
+
+
+// -----------------------------------------------------------------------------
+//
+// troeQueuePop - wait for queued items and take the oldest ones, all for the same database
+//
+extern int troeQueuePop(TroeQueueItem** itemV, int maxItems);
+
+
+
+// -----------------------------------------------------------------------------
+//
+// troeQueueDone - mark items as written (or given up on) and free the slots that can be freed
+//
+extern void troeQueueDone(TroeQueueItem** itemV, int items, bool written);
+
+#endif  // SRC_LIB_ORIONLD_TROE_TROEQUEUE_H_
@@ -0,0 +1,69 @@
+/*
+*
+* Copyright 2021 FIWARE Foundation e.V.
+*
+* This file is part of Orion-LD Context Broker.
+*
+* Orion-LD Context Broker is free software: you can redistribute it and/or
+* modify it under the terms of the GNU Affero General Public License as
+* published by the Free Software Foundation, either version 3 of the
+* License, or (at your option) any later version.
+*
+* Orion-LD Context Broker is distributed in the hope that it will be useful,
+* but WITHOUT ANY WARRANTY; without even the implied warranty of
+* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU Affero
+* General Public License for more details.
+*
+* You should have received a copy of the GNU Affero General Public License
+* along with Orion-LD Context Broker. If not, see http://www.gnu.org/licenses/.
+*
+* For those usages not covered by this license please contact with
+* orionld at fiware dot org
+*
+* Author: Ken Zangelin
+*/
+#include <stdlib.h>                                            // free
+
+#include "logMsg/logMsg.h"                                     // LM_*
+#include "logMsg/traceLevels.h"                                // Lmt*
+
+#include "orionld/troe/TroeQueueItem.h"                        // TroeQueueItem
+#include "orionld/troe/pgCopyBatch.h"                          // pgCopyBatch, pgCopyBatchReset
+#include "orionld/troe/troeQueue.h"                            // troeQueueItemCreate, troeQueuePush, troeQueueDb
+#include "orionld/troe/troeQueueWrite.h"                       // troeQueueWrite
+#include "orionld/troe/troeQueueCommit.h"                      // Own interface
+
+
+
+// -----------------------------------------------------------------------------
+//
+// troeQueueCommit -
+//
+bool troeQueueCommit(void)
+{
+  if ((pgCopyBatch.entities.rows == 0) && (pgCopyBatch.attributes.rows == 0) && (pgCopyBatch.subAttributes.rows == 0))
+    return true;
+
+  TroeQueueItem* itemP = troeQueueItemCreate(troeQueueDb, &pgCopyBatch);
+
+  pgCopyBatchReset();
+
+  if (itemP == NULL)
+    return false;
+
+  if (troeQueuePush(itemP) == true)
+    return true;
+
+  //
+  // Queue full (or the spill file can't be written) - write it synchronously
+  //
+  TroeQueueWriteError  error;
+  bool                 ok;
+
+  __sync_fetch_and_add(&troeQueueSyncWrites, 1);
+
+  ok = troeQueueWrite(&itemP, 1, &error);
+  free(itemP);
+
+  return ok;
+}
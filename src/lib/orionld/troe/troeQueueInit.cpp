@@ -0,0 +1,89 @@
+/*
+*
+* Copyright 2021 FIWARE Foundation e.V.
+*
+* This file is part of Orion-LD Context Broker.
+*
+* Orion-LD Context Broker is free software: you can redistribute it and/or
+* modify it under the terms of the GNU Affero General Public License as
+* published by the Free Software Foundation, either version 3 of the
+* License, or (at your option) any later version.
+*
+* Orion-LD Context Broker is distributed in the hope that it will be useful,
+* but WITHOUT ANY WARRANTY; without even the implied warranty of
+* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU Affero
+* General Public License for more details.
+*
+* You should have received a copy of the GNU Affero General Public License
+* along with Orion-LD Context Broker. If not, see http://www.gnu.org/licenses/.
+*
+* For those usages not covered by this license please contact with
+* orionld at fiware dot org
+*
+* Author: Ken Zangelin
+*/
+#include <stdlib.h>                                            // calloc, free
+#include <string.h>                                            // strerror
+#include <pthread.h>                                           // pthread_create, pthread_mutex_init, pthread_cond_init
+
+#include "logMsg/logMsg.h"                                     // LM_*
+#include "logMsg/traceLevels.h"                                // Lmt*
+
+#include "orionld/troe/TroeQueueItem.h"                        // TroeQueueItem
+#include "orionld/troe/troeQueue.h"                            // troeQueue*
+#include "orionld/troe/troeQueueSpill.h"                       // troeQueueSpillOpen
+#include "orionld/troe/troeQueueWorker.h"                      // troeQueueWorker
+#include "orionld/troe/troeQueueInit.h"                        // Own interface
+
+
+
+// -----------------------------------------------------------------------------
+//
+// troeQueueInit -
+//
+bool troeQueueInit(int queueSize, int workers, const char* spillFile)
+{
+  TroeQueueItem**  spillV     = NULL;
+  int              spillItems = 0;
+
+  if ((spillFile != NULL) && (*spillFile != 0))
+  {
+    if (troeQueueSpillOpen(spillFile, &spillV, &spillItems) == false)
+      LM_RE(false, ("Unable to open the TRoE spill file '%s'", spillFile));
+  }
+
+  // Room for all the transactions that were left in the spill file, even if the queue is smaller
+  troeQueueSlots = (spillItems > queueSize)? spillItems : queueSize;
+  troeQueueV     = (TroeQueueItem**) calloc(troeQueueSlots, sizeof(TroeQueueItem*));
+
+  if (troeQueueV == NULL)
+    LM_X(1, ("Internal Error (out of memory allocating a TRoE queue of %d slots)", troeQueueSlots));
+
+  pthread_mutex_init(&troeQueueMutex, NULL);
+  pthread_cond_init(&troeQueueNotEmpty, NULL);
+
+  for (int ix = 0; ix < spillItems; ix++)
+    troeQueueV[ix] = spillV[ix];
+
+  troeQueueItems    = spillItems;
+  troeQueueQueued   = spillItems;
+  troeQueueReplayed = spillItems;
+  free(spillV);
+
+  troeQueueInitialized = true;
+
+  for (int ix = 0; ix < workers; ix++)
+  {
+    pthread_t  tid;
+    int        rc = pthread_create(&tid, NULL, troeQueueWorker, NULL);
+
+    if (rc != 0)
+      LM_X(1, ("Runtime Error (pthread_create: %s)", strerror(rc)));
+
+    pthread_detach(tid);
+  }
+
+  LM_I(("Started %d TRoE writer threads (queue size: %d, spill file: '%s', replayed: %d)", workers, troeQueueSlots, (spillFile != NULL)? spillFile : "", spillItems));
+
+  return true;
+}
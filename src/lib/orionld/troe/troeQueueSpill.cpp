@@ -0,0 +1,307 @@
+/*
+*
+* Copyright 2021 FIWARE Foundation e.V.
+*
+* This file is part of Orion-LD Context Broker.
+*
+* Orion-LD Context Broker is free software: you can redistribute it and/or
+* modify it under the terms of the GNU Affero General Public License as
+* published by the Free Software Foundation, either version 3 of the
+* License, or (at your option) any later version.
+*
+* Orion-LD Context Broker is distributed in the hope that it will be useful,
+* but WITHOUT ANY WARRANTY; without even the implied warranty of
+* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU Affero
+* General Public License for more details.
+*
+* You should have received a copy of the GNU Affero General Public License
+* along with Orion-LD Context Broker. If not, see http://www.gnu.org/licenses/.
+*
+* For those usages not covered by this license please contact with
+* orionld at fiware dot org
+*
+* Author: Ken Zangelin
+*/
+#include <stdlib.h>                                            // malloc, realloc, free
+#include <string.h>                                            // memcmp, memcpy, strerror
+#include <errno.h>                                             // errno
+#include <unistd.h>                                            // pread, pwrite, ftruncate, close
+#include <fcntl.h>                                             // open, O_*
+#include <sys/stat.h>                                          // fstat
+#include <pthread.h>                                           // pthread_mutex_*
+
+#include "logMsg/logMsg.h"                                     // LM_*
+#include "logMsg/traceLevels.h"                                // Lmt*
+
+#include "orionld/troe/TroeQueueItem.h"                        // TroeQueueItem, TroeQueueRecord
+#include "orionld/troe/troeQueueSpill.h"                       // Own interface
+
+
+
+// -----------------------------------------------------------------------------
+//
+// TRoE spill file variables
+//
+int              troeQueueSpillFd           = -1;
+long long        troeQueueSpillOffset       = TROE_SPILL_HEADER_SIZE;
+long long        troeQueueSpillBase         = 0;
+pthread_mutex_t  troeQueueSpillMutex        = PTHREAD_MUTEX_INITIALIZER;
+
+
+
+// -----------------------------------------------------------------------------
+//
+// troeQueueSpillCheckpointed - the last checkpoint (logical offset) - checkpoints from the workers may arrive out of order
+//
+static long long troeQueueSpillCheckpointed = TROE_SPILL_HEADER_SIZE;
+
+
+
+// -----------------------------------------------------------------------------
+//
+// troeQueueSpillHeaderWrite -
+//
+static bool troeQueueSpillHeaderWrite(long long checkpoint)
+{
+  char header[TROE_SPILL_HEADER_SIZE];
+
+  memcpy(header, TROE_SPILL_MAGIC, 8);
+  memcpy(&header[8], &checkpoint, sizeof(checkpoint));
+
+  if (pwrite(troeQueueSpillFd, header, sizeof(header), 0) != sizeof(header))
+    LM_RE(false, ("System Error (writing the header of the TRoE spill file: %s)", strerror(errno)));
+
+  return true;
+}
+
+
+
+// -----------------------------------------------------------------------------
+//
+// troeQueueSpillRead - read the records between the checkpoint and the end of the file
+//
+static bool troeQueueSpillRead(long long checkpoint, long long fileSize, TroeQueueItem*** itemVP, int* itemsP)
+{
+  TroeQueueItem**  itemV  = NULL;
+  int              items  = 0;
+  long long        offset = checkpoint;
+
+  while (offset + (long long) sizeof(TroeQueueRecord) <= fileSize)
+  {
+    TroeQueueRecord record;
+
+    if (pread(troeQueueSpillFd, &record, sizeof(record), offset) != sizeof(record))
+      break;
+
+    if ((record.magic != TROE_QUEUE_RECORD_MAGIC) || (offset + (long long) sizeof(record) + record.dataLen > fileSize))
+    {
+      LM_W(("TRoE spill file: incomplete record at offset %lld - ignoring the rest of the file", offset));
+      break;
+    }
+
+    TroeQueueItem* itemP = (TroeQueueItem*) malloc(sizeof(TroeQueueItem) + record.dataLen);
+    if (itemP == NULL)
+      LM_X(1, ("Internal Error (out of memory reading the TRoE spill file)"));
+
+    itemP->record   = record;
+    itemP->state    = TroeQueueItemQueued;
+    itemP->data     = (char*) &itemP[1];
+    itemP->spillEnd = offset + sizeof(record) + record.dataLen;
+
+    if (pread(troeQueueSpillFd, itemP->data, record.dataLen, offset + sizeof(record)) != (ssize_t) record.dataLen)
+    {
+      free(itemP);
+      break;
+    }
+
+    if ((items % 1024) == 0)
+    {
+      itemV = (TroeQueueItem**) realloc(itemV, (items + 1024) * sizeof(TroeQueueItem*));
+      if (itemV == NULL)
+        LM_X(1, ("Internal Error (out of memory reading the TRoE spill file)"));
+    }
+
+    itemV[items++] = itemP;
+    offset         = itemP->spillEnd;
+  }
+
+  //
+  // Anything after the last complete record is garbage from a crash in the middle of a write
+  //
+  if (offset < fileSize)
+  {
+    if (ftruncate(troeQueueSpillFd, offset) != 0)
+      LM_E(("System Error (truncating the TRoE spill file: %s)", strerror(errno)));
+  }
+
+  troeQueueSpillOffset = offset;
+  *itemVP              = itemV;
+  *itemsP              = items;
+
+  return true;
+}
+
+
+
+// -----------------------------------------------------------------------------
+//
+// troeQueueSpillOpen -
+//
+bool troeQueueSpillOpen(const char* path, TroeQueueItem*** itemVP, int* itemsP)
+{
+  struct stat  statBuf;
+  char         header[TROE_SPILL_HEADER_SIZE];
+  long long    checkpoint;
+
+  *itemVP = NULL;
+  *itemsP = 0;
+
+  troeQueueSpillFd = open(path, O_RDWR | O_CREAT, 0600);
+  if (troeQueueSpillFd == -1)
+    LM_RE(false, ("System Error (opening the TRoE spill file '%s': %s)", path, strerror(errno)));
+
+  if (fstat(troeQueueSpillFd, &statBuf) != 0)
+    LM_RE(false, ("System Error (fstat on the TRoE spill file '%s': %s)", path, strerror(errno)));
+
+  //
+  // New (or broken) file - start from scratch
+  //
+  if ((statBuf.st_size < TROE_SPILL_HEADER_SIZE)                                                 ||
+      (pread(troeQueueSpillFd, header, sizeof(header), 0) != sizeof(header))                     ||
+      (memcmp(header, TROE_SPILL_MAGIC, 8) != 0))
+  {
+    if (statBuf.st_size != 0)
+      LM_W(("TRoE spill file '%s' is not a spill file - it is reset", path));
+
+    if (ftruncate(troeQueueSpillFd, 0) != 0)
+      LM_RE(false, ("System Error (truncating the TRoE spill file '%s': %s)", path, strerror(errno)));
+
+    troeQueueSpillOffset = TROE_SPILL_HEADER_SIZE;
+    return troeQueueSpillHeaderWrite(TROE_SPILL_HEADER_SIZE);
+  }
+
+  //
+  // A checkpoint beyond the end of the file is the result of a crash in the middle of a compaction,
+  // after the records had been moved to the start of the file
+  //
+  memcpy(&checkpoint, &header[8], sizeof(checkpoint));
+  if ((checkpoint < TROE_SPILL_HEADER_SIZE) || (checkpoint > statBuf.st_size))
+    checkpoint = TROE_SPILL_HEADER_SIZE;
+
+  troeQueueSpillCheckpointed = checkpoint;
+
+  if (troeQueueSpillRead(checkpoint, statBuf.st_size, itemVP, itemsP) == false)
+    return false;
+
+  if (*itemsP > 0)
+    LM_W(("TRoE spill file '%s': %d transactions were never written to postgres - they are queued again", path, *itemsP));
+
+  return true;
+}
+
+
+
+// -----------------------------------------------------------------------------
+//
+// troeQueueSpillAppend -
+//
+// The record is written with write(2) but not synced - it survives a crash of the broker, not one of the machine.
+//
+bool troeQueueSpillAppend(TroeQueueItem* itemP)
+{
+  long long  offset  = troeQueueSpillOffset;
+  ssize_t    nb;
+
+  nb = pwrite(troeQueueSpillFd, &itemP->record, sizeof(itemP->record), offset);
+  if (nb == sizeof(itemP->record))
+    nb = pwrite(troeQueueSpillFd, itemP->data, itemP->record.dataLen, offset + sizeof(itemP->record));
+  else
+    nb = -1;
+
+  if (nb != (ssize_t) itemP->record.dataLen)
+  {
+    LM_E(("System Error (writing to the TRoE spill file: %s)", strerror(errno)));
+    if (ftruncate(troeQueueSpillFd, offset) != 0)
+      LM_E(("System Error (truncating the TRoE spill file: %s)", strerror(errno)));
+    return false;
+  }
+
+  troeQueueSpillOffset = offset + sizeof(itemP->record) + itemP->record.dataLen;
+  itemP->spillEnd      = troeQueueSpillBase + troeQueueSpillOffset;
+
+  return true;
+}
+
+
+
+// -----------------------------------------------------------------------------
+//
+// troeQueueSpillCompact - move the 'live' bytes of records at 'offset' to the start of the file, and truncate it
+//
+// The records are copied to where they don't overlap their source, then the file is truncated and only after that
+// the header is updated. If the broker dies before the truncation, the old checkpoint is still valid. If it dies after the
+// truncation, the old checkpoint is beyond the end of the file, and troeQueueSpillOpen starts from the header.
+//
+static void troeQueueSpillCompact(long long offset, long long live)
+{
+  char       buf[64 * 1024];
+  long long  copied = 0;
+
+  while (copied < live)
+  {
+    ssize_t len = (live - copied > (long long) sizeof(buf))? (ssize_t) sizeof(buf) : (ssize_t) (live - copied);
+
+    if ((pread(troeQueueSpillFd, buf, len, offset + copied) != len) || (pwrite(troeQueueSpillFd, buf, len, TROE_SPILL_HEADER_SIZE + copied) != len))
+    {
+      LM_E(("System Error (compacting the TRoE spill file: %s)", strerror(errno)));
+      troeQueueSpillHeaderWrite(offset);
+      return;
+    }
+
+    copied += len;
+  }
+
+  if (ftruncate(troeQueueSpillFd, TROE_SPILL_HEADER_SIZE + live) != 0)
+  {
+    LM_E(("System Error (truncating the TRoE spill file: %s)", strerror(errno)));
+    troeQueueSpillHeaderWrite(offset);
+    return;
+  }
+
+  troeQueueSpillHeaderWrite(TROE_SPILL_HEADER_SIZE);
+
+  troeQueueSpillBase  += offset - TROE_SPILL_HEADER_SIZE;
+  troeQueueSpillOffset = TROE_SPILL_HEADER_SIZE + live;
+
+  if (live > 0)
+    LM_TMP(("TRoE spill file compacted: %lld bytes of records moved to the start of the file", live));
+}
+
+
+
+// -----------------------------------------------------------------------------
+//
+// troeQueueSpillCheckpoint -
+//
+void troeQueueSpillCheckpoint(long long checkpoint)
+{
+  pthread_mutex_lock(&troeQueueSpillMutex);
+
+  if (checkpoint <= troeQueueSpillCheckpointed)
+  {
+    pthread_mutex_unlock(&troeQueueSpillMutex);
+    return;
+  }
+
+  troeQueueSpillCheckpointed = checkpoint;
+
+  long long offset = checkpoint - troeQueueSpillBase;
+  long long live   = troeQueueSpillOffset - offset;
+
+  if ((live <= 0) || ((offset > TROE_SPILL_COMPACT_SIZE) && (live <= offset - TROE_SPILL_HEADER_SIZE)))
+    troeQueueSpillCompact(offset, (live > 0)? live : 0);
+  else
+    troeQueueSpillHeaderWrite(offset);
+
+  pthread_mutex_unlock(&troeQueueSpillMutex);
+}
@@ -0,0 +1,95 @@
+#ifndef SRC_LIB_ORIONLD_TROE_TROEQUEUESPILL_H_
+#define SRC_LIB_ORIONLD_TROE_TROEQUEUESPILL_H_
+
+/*
+*
+* Copyright 2021 FIWARE Foundation e.V.
+*
+* This file is part of Orion-LD Context Broker.
+*
+* Orion-LD Context Broker is free software: you can redistribute it and/or
+* modify it under the terms of the GNU Affero General Public License as
+* published by the Free Software Foundation, either version 3 of the
+* License, or (at your option) any later version.
+*
+* Orion-LD Context Broker is distributed in the hope that it will be useful,
+* but WITHOUT ANY WARRANTY; without even the implied warranty of
+* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU Affero
+* General Public License for more details.
+*
+* You should have received a copy of the GNU Affero General Public License
+* along with Orion-LD Context Broker. If not, see http://www.gnu.org/licenses/.
+*
+* For those usages not covered by this license please contact with
+* orionld at fiware dot org
+*
+* Author: Ken Zangelin
+*/
+#include <pthread.h>                                           // pthread_mutex_t
+
+#include "orionld/troe/TroeQueueItem.h"                        // TroeQueueItem
+
+
+
+// -----------------------------------------------------------------------------
+//
+// TRoE spill file
+//
+// The spill file starts with a header (TROE_SPILL_HEADER_SIZE bytes: magic + checkpoint) followed by
+// the queued records, in queue order. The checkpoint is the offset of the first record that has not yet
+// been written to postgres.
+//
+// When all records have been written, the file is truncated back to its header.
+// When the checkpoint is more than TROE_SPILL_COMPACT_SIZE bytes into the file and the records after it
+// fit in the space before it, these records are moved to the start of the file, and the file is truncated.
+// So, the file never grows much beyond TROE_SPILL_COMPACT_SIZE + the size of the records not yet written.
+//
+// As records move, the offsets kept in the queue items (spillEnd) are logical - the file offset
+// is the logical offset minus troeQueueSpillBase.
+//
+#define TROE_SPILL_MAGIC         "TROEQ001"
+#define TROE_SPILL_HEADER_SIZE   16
+#define TROE_SPILL_COMPACT_SIZE  (16 * 1024 * 1024)
+
+
+
+// -----------------------------------------------------------------------------
+//
+// TRoE spill file variables - protected by troeQueueSpillMutex
+//
+// troeQueueSpillMutex is never taken while holding troeQueueMutex - the file I/O is done without holding the queue.
+//
+extern int              troeQueueSpillFd;       // -1: no spill file
+extern long long        troeQueueSpillOffset;   // File offset for the next record
+extern long long        troeQueueSpillBase;     // Logical offset of the start of the file
+extern pthread_mutex_t  troeQueueSpillMutex;
+
+
+
+// -----------------------------------------------------------------------------
+//
+// troeQueueSpillOpen - open (or create) the spill file and load the records that were never written to postgres
+//
+// The items are returned in a malloc'ed vector (*itemVP), to be freed by the caller.
+//
+extern bool troeQueueSpillOpen(const char* path, TroeQueueItem*** itemVP, int* itemsP);
+
+
+
+// -----------------------------------------------------------------------------
+//
+// troeQueueSpillAppend - append an item to the spill file
+//
+// The caller must hold troeQueueSpillMutex
+//
+extern bool troeQueueSpillAppend(TroeQueueItem* itemP);
+
+
+
+// -----------------------------------------------------------------------------
+//
+// troeQueueSpillCheckpoint - all records before the logical offset 'checkpoint' have been written to postgres
+//
+extern void troeQueueSpillCheckpoint(long long checkpoint);
+
+#endif  // SRC_LIB_ORIONLD_TROE_TROEQUEUESPILL_H_
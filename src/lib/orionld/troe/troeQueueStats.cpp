@@ -0,0 +1,96 @@
+/*
+*
+* Copyright 2021 FIWARE Foundation e.V.
+*
+* This file is part of Orion-LD Context Broker.
+*
+* Orion-LD Context Broker is free software: you can redistribute it and/or
+* modify it under the terms of the GNU Affero General Public License as
+* published by the Free Software Foundation, either version 3 of the
+* License, or (at your option) any later version.
+*
+* Orion-LD Context Broker is distributed in the hope that it will be useful,
+* but WITHOUT ANY WARRANTY; without even the implied warranty of
+* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU Affero
+* General Public License for more details.
+*
+* You should have received a copy of the GNU Affero General Public License
+* along with Orion-LD Context Broker. If not, see http://www.gnu.org/licenses/.
+*
+* For those usages not covered by this license please contact with
+* orionld at fiware dot org
+*
+* Author: Ken Zangelin
+*/
+#include <string>                                              // std::string
+#include <pthread.h>                                           // pthread_mutex_lock, pthread_mutex_unlock
+
+#include "common/JsonHelper.h"                                 // JsonHelper
+
+#include "orionld/troe/troeQueue.h"                            // troeQueue*
+#include "orionld/troe/troeQueueSpill.h"                       // troeQueueSpillFd, troeQueueSpillOffset, TROE_SPILL_HEADER_SIZE
+#include "orionld/troe/troeQueueStats.h"                       // Own interface
+
+
+
+// -----------------------------------------------------------------------------
+//
+// troeQueueStats -
+//
+//   "size":        number of slots in the queue (-troeQueueSize)
+//   "items":       slots in use
+//   "queued":      transactions waiting for a writer thread
+//   "inFlight":    transactions being written
+//   "pushed":      transactions queued
+//   "written":     transactions written to postgres by the writer threads
+//   "failed":      transactions given up on
+//   "syncWrites":  transactions written by the request thread as the queue was full
+//   "replayed":    transactions recovered from the spill file at startup
+//   "spillBytes":  size of the spill file
+//
+std::string troeQueueStats(void)
+{
+  JsonHelper jh;
+
+  if (troeQueueInitialized == false)
+    return jh.str();
+
+  pthread_mutex_lock(&troeQueueMutex);
+
+  jh.addNumber("size",       (long long) troeQueueSlots);
+  jh.addNumber("items",      (long long) troeQueueItems);
+  jh.addNumber("queued",     (long long) troeQueueQueued);
+  jh.addNumber("inFlight",   (long long) troeQueueInFlight);
+  jh.addNumber("pushed",     (long long) troeQueuePushed);
+  jh.addNumber("written",    (long long) troeQueueWritten);
+  jh.addNumber("failed",     (long long) troeQueueFailed);
+  jh.addNumber("syncWrites", (long long) __sync_fetch_and_add(&troeQueueSyncWrites, 0));
+  jh.addNumber("replayed",   (long long) troeQueueReplayed);
+  jh.addNumber("spillBytes", (troeQueueSpillFd == -1)? 0LL : __atomic_load_n(&troeQueueSpillOffset, __ATOMIC_RELAXED) - TROE_SPILL_HEADER_SIZE);
+
+  pthread_mutex_unlock(&troeQueueMutex);
+
+  return jh.str();
+}
+
+
+
+// -----------------------------------------------------------------------------
+//
+// troeQueueStatsReset -
+//
+void troeQueueStatsReset(void)
+{
+  if (troeQueueInitialized == false)
+    return;
+
+  pthread_mutex_lock(&troeQueueMutex);
+
+  troeQueuePushed   = 0;
+  troeQueueWritten  = 0;
+  troeQueueFailed   = 0;
+  troeQueueReplayed = 0;
+  __sync_lock_test_and_set(&troeQueueSyncWrites, 0);
+
+  pthread_mutex_unlock(&troeQueueMutex);
+}
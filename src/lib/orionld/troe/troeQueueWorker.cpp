@@ -0,0 +1,115 @@
+/*
+*
+* Copyright 2021 FIWARE Foundation e.V.
+*
+* This file is part of Orion-LD Context Broker.
+*
+* Orion-LD Context Broker is free software: you can redistribute it and/or
+* modify it under the terms of the GNU Affero General Public License as
+* published by the Free Software Foundation, either version 3 of the
+* License, or (at your option) any later version.
+*
+* Orion-LD Context Broker is distributed in the hope that it will be useful,
+* but WITHOUT ANY WARRANTY; without even the implied warranty of
+* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU Affero
+* General Public License for more details.
+*
+* You should have received a copy of the GNU Affero General Public License
+* along with Orion-LD Context Broker. If not, see http://www.gnu.org/licenses/.
+*
+* For those usages not covered by this license please contact with
+* orionld at fiware dot org
+*
+* Author: Ken Zangelin
+*/
+#include <unistd.h>                                            // sleep
+
+#include "logMsg/logMsg.h"                                     // LM_*
+#include "logMsg/traceLevels.h"                                // Lmt*
+
+#include "orionld/troe/TroeQueueItem.h"                        // TroeQueueItem
+#include "orionld/troe/troeQueue.h"                            // troeQueuePop, troeQueueDone, TROE_QUEUE_*
+#include "orionld/troe/troeQueueWrite.h"                       // troeQueueWrite
+#include "orionld/troe/troeQueueWorker.h"                      // Own interface
+
+
+
+// -----------------------------------------------------------------------------
+//
+// troeQueueItemWrite - write a single queued transaction, retrying a few times
+//
+// A duplicate key is not retried - it won't go away.
+//
+static bool troeQueueItemWrite(TroeQueueItem* itemP)
+{
+  TroeQueueWriteError error;
+
+  for (int attempt = 1; attempt <= TROE_QUEUE_MAX_ATTEMPTS; attempt++)
+  {
+    if (troeQueueWrite(&itemP, 1, &error) == true)
+      return true;
+
+    if (error == TroeQueueWriteUniqueViolation)
+    {
+      LM_E(("Database Error (duplicate key in a TRoE transaction for postgres db '%s' - not retried)", itemP->record.db));
+      return false;
+    }
+
+    if (error == TroeQueueWriteConnectionError)
+    {
+      --attempt;  // Only real write failures count
+      sleep(1);
+    }
+    else
+      sleep(attempt);
+  }
+
+  LM_E(("Database Error (giving up on a TRoE transaction for postgres db '%s' after %d attempts)", itemP->record.db, TROE_QUEUE_MAX_ATTEMPTS));
+  return false;
+}
+
+
+
+// -----------------------------------------------------------------------------
+//
+// troeQueueWorker -
+//
+// The queued transactions are written in batches - one postgres transaction per batch.
+// If postgres can't be reached, the batch is retried until it can.
+// If the batch fails for any other reason, its transactions are written one by one, so that one
+// bad transaction doesn't take the others with it.
+//
+void* troeQueueWorker(void* vP)
+{
+  TroeQueueItem* itemV[TROE_QUEUE_BATCH_MAX_ITEMS];
+
+  while (1)
+  {
+    int                  items = troeQueuePop(itemV, TROE_QUEUE_BATCH_MAX_ITEMS);
+    TroeQueueWriteError  error;
+    bool                 ok;
+
+    while (1)
+    {
+      ok = troeQueueWrite(itemV, items, &error);
+      if ((ok == true) || (error != TroeQueueWriteConnectionError))
+        break;
+
+      sleep(1);
+    }
+
+    if (ok == true)
+    {
+      troeQueueDone(itemV, items, true);
+      continue;
+    }
+
+    for (int ix = 0; ix < items; ix++)
+    {
+      ok = troeQueueItemWrite(itemV[ix]);
+      troeQueueDone(&itemV[ix], 1, ok);
+    }
+  }
+
+  return NULL;
+}
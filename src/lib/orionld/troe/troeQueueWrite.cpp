@@ -0,0 +1,127 @@
+/*
+*
+* Copyright 2021 FIWARE Foundation e.V.
+*
+* This file is part of Orion-LD Context Broker.
+*
+* Orion-LD Context Broker is free software: you can redistribute it and/or
+* modify it under the terms of the GNU Affero General Public License as
+* published by the Free Software Foundation, either version 3 of the
+* License, or (at your option) any later version.
+*
+* Orion-LD Context Broker is distributed in the hope that it will be useful,
+* but WITHOUT ANY WARRANTY; without even the implied warranty of
+* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU Affero
+* General Public License for more details.
+*
+* You should have received a copy of the GNU Affero General Public License
+* along with Orion-LD Context Broker. If not, see http://www.gnu.org/licenses/.
+*
+* For those usages not covered by this license please contact with
+* orionld at fiware dot org
+*
+* Author: Ken Zangelin
+*/
+#include <postgresql/libpq-fe.h>                               // PGconn
+
+#include "logMsg/logMsg.h"                                     // LM_*
+#include "logMsg/traceLevels.h"                                // Lmt*
+
+#include "orionld/troe/PgCopyBuffer.h"                         // PgCopyBatch
+#include "orionld/troe/TroeQueueItem.h"                        // TroeQueueItem
+#include "orionld/troe/pgCopyBatch.h"                          // pgCopyBatch, pgCopyBatchReset
+#include "orionld/troe/pgCopyDataAppend.h"                     // pgCopyDataAppend
+#include "orionld/troe/pgCopyFlush.h"                          // pgCopyFlush
+#include "orionld/troe/pgConnectionGet.h"                      // pgConnectionGet
+#include "orionld/troe/pgConnectionRelease.h"                  // pgConnectionRelease
+#include "orionld/troe/pgTransactionBegin.h"                   // pgTransactionBegin
+#include "orionld/troe/pgTransactionRollback.h"                // pgTransactionRollback
+#include "orionld/troe/pgTransactionCommit.h"                  // pgTransactionCommit
+#include "orionld/troe/troeQueueWrite.h"                       // Own interface
+
+
+
+// -----------------------------------------------------------------------------
+//
+// troeQueueItemAppend - append the rows of a queued transaction to the COPY batch of the thread
+//
+static bool troeQueueItemAppend(TroeQueueItem* itemP)
+{
+  TroeQueueRecord*  rP    = &itemP->record;
+  char*             dataP = itemP->data;
+
+  if (pgCopyDataAppend(&pgCopyBatch.entities, dataP, rP->entitiesLen, rP->entitiesRows) == false)
+    return false;
+  dataP += rP->entitiesLen;
+
+  if (pgCopyDataAppend(&pgCopyBatch.attributes, dataP, rP->attributesLen, rP->attributesRows) == false)
+    return false;
+  dataP += rP->attributesLen;
+
+  return pgCopyDataAppend(&pgCopyBatch.subAttributes, dataP, rP->subAttributesLen, rP->subAttributesRows);
+}
+
+
+
+// -----------------------------------------------------------------------------
+//
+// troeQueueWrite -
+//
+bool troeQueueWrite(TroeQueueItem** itemV, int items, TroeQueueWriteError* errorP)
+{
+  *errorP = TroeQueueWriteOk;
+
+  PGconn* connectionP = pgConnectionGet(itemV[0]->record.db);
+  if (connectionP == NULL)
+  {
+    *errorP = TroeQueueWriteConnectionError;
+    LM_RE(false, ("no connection to postgres db '%s'", itemV[0]->record.db));
+  }
+
+  if (pgTransactionBegin(connectionP) != true)
+  {
+    *errorP = (PQstatus(connectionP) != CONNECTION_OK)? TroeQueueWriteConnectionError : TroeQueueWriteFailed;
+    pgConnectionRelease(connectionP);
+    LM_RE(false, ("pgTransactionBegin failed"));
+  }
+
+  for (int ix = 0; ix < items; ix++)
+  {
+    if (troeQueueItemAppend(itemV[ix]) == false)
+    {
+      *errorP = TroeQueueWriteFailed;
+      pgTransactionRollback(connectionP);
+      pgConnectionRelease(connectionP);
+      LM_RE(false, ("unable to append the rows of a queued TRoE transaction"));
+    }
+  }
+
+  //
+  // The rows are sent here, idempotently, and not by pgTransactionCommit (that finds nothing left to send)
+  //
+  bool uniqueViolation;
+
+  if (pgCopyFlush(connectionP, true, &uniqueViolation) == false)
+  {
+    if (PQstatus(connectionP) != CONNECTION_OK)
+      *errorP = TroeQueueWriteConnectionError;
+    else
+      *errorP = (uniqueViolation == true)? TroeQueueWriteUniqueViolation : TroeQueueWriteFailed;
+
+    pgTransactionRollback(connectionP);
+    pgConnectionRelease(connectionP);
+    LM_RE(false, ("unable to send the rows of queued TRoE transactions"));
+  }
+  pgCopyBatchReset();
+
+  if (pgTransactionCommit(connectionP) != true)
+  {
+    *errorP = (PQstatus(connectionP) != CONNECTION_OK)? TroeQueueWriteConnectionError : TroeQueueWriteFailed;
+    pgConnectionRelease(connectionP);
+    LM_RE(false, ("pgTransactionCommit failed"));
+  }
+
+  pgConnectionRelease(connectionP);
+
+  return true;
+}
@@ -0,0 +1,56 @@
+#ifndef SRC_LIB_ORIONLD_TROE_TROEQUEUEWRITE_H_
+#define SRC_LIB_ORIONLD_TROE_TROEQUEUEWRITE_H_
+
+/*
+*
+* Copyright 2021 FIWARE Foundation e.V.
+*
+* This file is part of Orion-LD Context Broker.
+*
+* Orion-LD Context Broker is free software: you can redistribute it and/or
+* modify it under the terms of the GNU Affero General Public License as
+* published by the Free Software Foundation, either version 3 of the
+* License, or (at your option) any later version.
+*
+* Orion-LD Context Broker is distributed in the hope that it will be useful,
+* but WITHOUT ANY WARRANTY; without even the implied warranty of
+* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU Affero
+* General Public License for more details.
+*
+* You should have received a copy of the GNU Affero General Public License
+* along with Orion-LD Context Broker. If not, see http://www.gnu.org/licenses/.
+*
+* For those usages not covered by this license please contact with
+* orionld at fiware dot org
+*
+* Author: Ken Zangelin
+*/
+#include "orionld/troe/TroeQueueItem.h"                        // TroeQueueItem
+
+
+
+// -----------------------------------------------------------------------------
+//
+// TroeQueueWriteError - why troeQueueWrite failed
+//
+typedef enum TroeQueueWriteError
+{
+  TroeQueueWriteOk,
+  TroeQueueWriteConnectionError,     // postgres couldn't be reached at all - worth retrying until it can
+  TroeQueueWriteUniqueViolation,     // duplicate key - retrying won't help
+  TroeQueueWriteFailed               // any other error
+} TroeQueueWriteError;
+
+
+
+// -----------------------------------------------------------------------------
+//
+// troeQueueWrite - write queued TRoE transactions to postgres, all in one single transaction
+//
+// All items must be for the same database.
+// The rows are written idempotently - rows that are already in postgres are skipped. A transaction that was
+// committed but not yet checkpointed in the spill file when the broker died is simply written again on restart.
+//
+extern bool troeQueueWrite(TroeQueueItem** itemV, int items, TroeQueueWriteError* errorP);
+
+#endif  // SRC_LIB_ORIONLD_TROE_TROEQUEUEWRITE_H_
@@ -30,11 +30,12 @@
 
 // -----------------------------------------------------------------------------
 //
-// OrionldGeoIndex -
+// OrionldGeoIndex - item in the hash set of geo-indexed attributes of a tenant (OrionldTenant::geoIndexV)
+//
+// The attribute name is stored as in the database, i.e. with '=' instead of '.'
 //
 typedef struct OrionldGeoIndex
 {
-  char*                    tenant;
   char*                    attrName;
   struct OrionldGeoIndex*  next;
 } OrionldGeoIndex;
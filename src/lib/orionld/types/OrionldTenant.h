@@ -0,0 +1,77 @@
+#ifndef SRC_LIB_ORIONLD_TYPES_ORIONLDTENANT_H_
+#define SRC_LIB_ORIONLD_TYPES_ORIONLDTENANT_H_
+
+/*
+*
+* Copyright 2021 FIWARE Foundation e.V.
+*
+* This file is part of Orion-LD Context Broker.
+*
+* Orion-LD Context Broker is free software: you can redistribute it and/or
+* modify it under the terms of the GNU Affero General Public License as
+* published by the Free Software Foundation, either version 3 of the
+* License, or (at your option) any later version.
+*
+* Orion-LD Context Broker is distributed in the hope that it will be useful,
+* but WITHOUT ANY WARRANTY; without even the implied warranty of
+* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU Affero
+* General Public License for more details.
+*
+* You should have received a copy of the GNU Affero General Public License
+* along with Orion-LD Context Broker. If not, see http://www.gnu.org/licenses/.
+*
+* For those usages not covered by this license please contact with
+* orionld at fiware dot org
+*
+* Author: Ken Zangelin
+*/
+
+
+
+#include "common/limits.h"                                       // SERVICE_NAME_MAX_LEN
+#include "orionld/types/OrionldGeoIndex.h"                       // OrionldGeoIndex
+#include "orionld/types/OrionldTypeCatalog.h"                    // OrionldTypeCatalog
+
+
+
+// -----------------------------------------------------------------------------
+//
+// ORIONLD_TENANT_TABLE_BUCKETS - number of buckets in the tenant hash table
+//
+#define ORIONLD_TENANT_TABLE_BUCKETS  1024
+
+
+
+// -----------------------------------------------------------------------------
+//
+// ORIONLD_TENANT_GEO_INDEX_BUCKETS - number of buckets in the hash set of geo-indexed attributes of a tenant
+//
+#define ORIONLD_TENANT_GEO_INDEX_BUCKETS  64
+
+
+
+// -----------------------------------------------------------------------------
+//
+// OrionldTenant - an item in the tenant registry
+//
+// Tenants are never removed, and an item is never modified once it has been published in the registry
+// (see orionldTenantCreate), so the registry can be read without any lock.
+// The only exceptions are geoIndexV, the hash set of geo-indexed attributes, that only grows, lock-free (see dbGeoIndexAdd),
+// typeCatalog, the entity-type catalog, that has a semaphore of its own (see dbTypeCatalogUpdate),
+// and entityIdIndex, set once (atomically) by mongoLdEntityIdIndexUnique.
+//
+// The default tenant isn't in the registry - it's 'tenant0'.
+//
+typedef struct OrionldTenant
+{
+  char                   tenant[SERVICE_NAME_MAX_LEN + 1];  // As given in the HTTP header NGSILD-Tenant (longer names are rejected)
+  char                   mongoDbName[128];                  // dbName-tenant
+  char                   troeDbName[128];                   // dbName_tenant
+  OrionldGeoIndex*       geoIndexV[ORIONLD_TENANT_GEO_INDEX_BUCKETS];
+  OrionldTypeCatalog     typeCatalog;                       // Entity types of the tenant, for GET /types
+  int                    entityIdIndex;                     // Unique index on _id.id - 0: not tried yet, 1: in place, -1: not possible
+  struct OrionldTenant*  next;                              // Next tenant in the same bucket of the hash table
+  struct OrionldTenant*  listNext;                          // Next tenant in the list of all tenants (tenantList)
+} OrionldTenant;
+
+#endif  // SRC_LIB_ORIONLD_TYPES_ORIONLDTENANT_H_
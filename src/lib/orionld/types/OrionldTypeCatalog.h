@@ -0,0 +1,89 @@
+#ifndef SRC_LIB_ORIONLD_TYPES_ORIONLDTYPECATALOG_H_
+#define SRC_LIB_ORIONLD_TYPES_ORIONLDTYPECATALOG_H_
+
+/*
+*
+* Copyright 2021 FIWARE Foundation e.V.
+*
+* This file is part of Orion-LD Context Broker.
+*
+* Orion-LD Context Broker is free software: you can redistribute it and/or
+* modify it under the terms of the GNU Affero General Public License as
+* published by the Free Software Foundation, either version 3 of the
+* License, or (at your option) any later version.
+*
+* Orion-LD Context Broker is distributed in the hope that it will be useful,
+* but WITHOUT ANY WARRANTY; without even the implied warranty of
+* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU Affero
+* General Public License for more details.
+*
+* You should have received a copy of the GNU Affero General Public License
+* along with Orion-LD Context Broker. If not, see http://www.gnu.org/licenses/.
+*
+* For those usages not covered by this license please contact with
+* orionld at fiware dot org
+*
+* Author: Ken Zangelin
+*/
+#include <semaphore.h>                                           // sem_t
+
+
+
+// -----------------------------------------------------------------------------
+//
+// ORIONLD_TYPE_CATALOG_BUCKETS - number of buckets in the hash table of entity types of a tenant
+//
+#define ORIONLD_TYPE_CATALOG_BUCKETS  256
+
+
+
+// -----------------------------------------------------------------------------
+//
+// OrionldTypeCatalogAttribute - an attribute of an entity type, and the number of entities of the type that have it
+//
+typedef struct OrionldTypeCatalogAttribute
+{
+  char*                                name;      // Expanded attribute name
+  int                                  entities;
+  struct OrionldTypeCatalogAttribute*  next;
+} OrionldTypeCatalogAttribute;
+
+
+
+// -----------------------------------------------------------------------------
+//
+// OrionldTypeCatalogItem - an entity type in the type catalog of a tenant
+//
+// Items whose entity count has dropped to zero are kept (with 'entities' == 0) and skipped by the readers.
+// 'dirty' marks items that have been modified since they were last saved in the database.
+//
+typedef struct OrionldTypeCatalogItem
+{
+  char*                           type;       // Expanded entity type
+  int                             entities;
+  bool                            dirty;
+  OrionldTypeCatalogAttribute*    attrList;
+  struct OrionldTypeCatalogItem*  next;       // Next item in the same bucket
+} OrionldTypeCatalogItem;
+
+
+
+// -----------------------------------------------------------------------------
+//
+// OrionldTypeCatalog - the entity types of a tenant, with entity count and attribute names per type
+//
+// The catalog is loaded on first use (dbTypeCatalogLoad), kept up to date by the entity create/update/delete
+// operations (dbTypeCatalogUpdate) and saved in the "entityTypes" collection of the tenant by the
+// catalog flush thread (dbTypeCatalogFlush).
+//
+// All fields are protected by 'sem'.
+//
+typedef struct OrionldTypeCatalog
+{
+  sem_t                    sem;
+  bool                     loaded;
+  bool                     dirty;     // At least one item is dirty
+  OrionldTypeCatalogItem*  itemV[ORIONLD_TYPE_CATALOG_BUCKETS];
+} OrionldTypeCatalog;
+
+#endif  // SRC_LIB_ORIONLD_TYPES_ORIONLDTYPECATALOG_H_
@@ -59,6 +59,7 @@ extern "C"
 
 #ifdef ORIONLD
 #include "orionld/common/performance.h"                          // REQUEST_PERFORMANCE
+#include "orionld/common/orionldLatency.h"                       // orionldLatencyRequestStart, orionldLatencyRequestEnd, ...
 #include "orionld/common/orionldState.h"                         // orionldState
 #include "orionld/common/orionldErrorResponse.h"                 // orionldErrorResponseCreate
 #include "orionld/rest/orionldMhdConnectionInit.h"               // orionldMhdConnectionInit
@@ -737,12 +738,14 @@ static void requestCompleted
 #ifdef REQUEST_PERFORMANCE
     kTimeGet(&timestamps.notifStart);
 #endif
+    orionldLatencyPhaseStart(LP_NOTIFY);
 
     orionldNotify();
 
 #ifdef REQUEST_PERFORMANCE
     kTimeGet(&timestamps.notifEnd);
 #endif
+    orionldLatencyPhaseEnd(LP_NOTIFY);
   }
 
   if ((ciP->payload != NULL) && (ciP->payload != static_buffer))
@@ -824,6 +827,13 @@ static void requestCompleted
   }
 
 
+#ifdef ORIONLD
+  //
+  // Latency histograms (NGSI-LD requests only)
+  //
+  orionldLatencyRequestEnd();
+#endif
+
   //
   // delayed release of ContextElementResponseVector must be effectuated now.
   // See github issue #2994
@@ -1727,6 +1737,7 @@ static MHD_Result connectionTreat
         bzero(&timestamps, sizeof(timestamps));
         kTimeGet(&timestamps.reqStart);
 #endif
+        orionldLatencyRequestStart();
         return orionldMhdConnectionInit(connection, url, method, version, con_cls);
       }
       else if (*upload_data_size != 0)
@@ -75,16 +75,34 @@ static int replyIx = 0;
 */
 void restReply(ConnectionInfo* ciP, const std::string& answer)
 {
-  MHD_Response*  response;
+  restReply(ciP, answer.c_str(), answer.length());
+}
+
+
+
+/* ****************************************************************************
+*
+* restReply -
+*
+* If the answer is the allocated response payload of orionldState, the buffer is handed over to MHD
+* (MHD_RESPMEM_MUST_FREE) instead of being copied. For big responses that saves a copy of the entire payload.
+*/
+void restReply(ConnectionInfo* ciP, const char* answer, uint64_t answerLen)
+{
+  MHD_Response*                response;
+  std::string                  spath   = (ciP->servicePathV.size() > 0)? ciP->servicePathV[0] : "";
+  enum MHD_ResponseMemoryMode  memMode = MHD_RESPMEM_MUST_COPY;
 
-  uint64_t       answerLen = answer.length();
-  std::string    spath     = (ciP->servicePathV.size() > 0)? ciP->servicePathV[0] : "";
+#ifdef ORIONLD
+  if ((orionldState.responsePayloadAllocated == true) && (answer == orionldState.responsePayload))
+    memMode = MHD_RESPMEM_MUST_FREE;
+#endif
 
   ++replyIx;
   LM_T(LmtServiceOutPayload, ("Response %d: responding with %d bytes, Status Code %d", replyIx, answerLen, ciP->httpStatusCode));
-  LM_T(LmtServiceOutPayload, ("Response payload: '%s'", answer.c_str()));
+  LM_T(LmtServiceOutPayload, ("Response payload: '%s'", answer));
 
-  response = MHD_create_response_from_buffer(answerLen, (void*) answer.c_str(), MHD_RESPMEM_MUST_COPY);
+  response = MHD_create_response_from_buffer(answerLen, (void*) answer, memMode);
   if (!response)
   {
     if (ciP->apiVersion != NGSI_LD_V1)
@@ -106,6 +124,11 @@ void restReply(ConnectionInfo* ciP, const std::string& answer)
     return;
   }
 
+#ifdef ORIONLD
+  if (memMode == MHD_RESPMEM_MUST_FREE)
+    orionldState.responsePayload = NULL;  // Owned by MHD from now on
+#endif
+
   if (answerLen > 0)
   {
     if (ciP->apiVersion != NGSI_LD_V1)
@@ -120,7 +143,7 @@ void restReply(ConnectionInfo* ciP, const std::string& answer)
     MHD_add_response_header(response, ciP->httpHeader[hIx].c_str(), ciP->httpHeaderValue[hIx].c_str());
   }
 
-  if (answer != "")
+  if (answerLen > 0)
   {
     //
     // For error-responses, never respond with application/ld+json
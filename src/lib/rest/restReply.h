@@ -25,6 +25,7 @@
 *
 * Author: Ken Zangelin
 */
+#include <stdint.h>
 #include <string>
 
 #include "rest/ConnectionInfo.h"
@@ -40,6 +41,14 @@ extern void restReply(ConnectionInfo* ciP, const std::string& answer);
 
 
 
+/* ****************************************************************************
+*
+* restReply - 
+*/
+extern void restReply(ConnectionInfo* ciP, const char* answer, uint64_t answerLen);
+
+
+
 /* ****************************************************************************
 *
 * restErrorReplyGet - 
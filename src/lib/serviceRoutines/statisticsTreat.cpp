@@ -43,6 +43,13 @@
 #include "cache/subCache.h"
 #include "ngsiNotify/QueueStatistics.h"
 #include "common/JsonHelper.h"
+#include "orionld/notifications/notificationConnectionPoolStats.h"  // notificationConnectionPoolStats
+#include "orionld/notifications/notificationQueue.h"                // notificationQueueInitialized
+#include "orionld/notifications/notificationQueueStats.h"           // notificationQueueStats
+#include "orionld/troe/pgConnectionPoolStats.h"                     // pgConnectionPoolStats
+#include "orionld/troe/troeQueue.h"                                 // troeQueueInitialized
+#include "orionld/troe/troeQueueStats.h"                            // troeQueueStats
+#include "orionld/common/orionldForwardLatency.h"                   // orionldForwardLatencyStats
 
 
 
@@ -135,6 +142,11 @@ static void resetStatistics(void)
   noOfRegistrationsRequest                        = -1;
 
   QueueStatistics::reset();
+  notificationConnectionPoolStatsReset();
+  notificationQueueStatsReset();
+  pgConnectionPoolStatsReset();
+  troeQueueStatsReset();
+  orionldForwardLatencyStatsReset();
 
   semTimeReqReset();
   semTimeTransReset();
@@ -326,6 +338,26 @@ std::string statisticsTreat
   {
     js.addRaw("notifQueue", renderNotifQueueStats());
   }
+  if ((notifQueueStatistics) && (notificationQueueInitialized == true))
+  {
+    js.addRaw("ldNotifQueue", notificationQueueStats());
+  }
+  if (countersStatistics)
+  {
+    js.addRaw("notifConnectionPool", notificationConnectionPoolStats());
+  }
+  if ((countersStatistics) && (troe == true))
+  {
+    js.addRaw("troeConnectionPool", pgConnectionPoolStats());
+  }
+  if ((countersStatistics) && (troeQueueInitialized == true))
+  {
+    js.addRaw("troeQueue", troeQueueStats());
+  }
+  if (countersStatistics)
+  {
+    js.addRaw("forwarding", orionldForwardLatencyStats());
+  }
 
   // Unconditional stats
   int now = orionldState.requestTime;
@@ -87,6 +87,8 @@ char            gtest_filter[1024];
 char            gtest_output[1024];
 int             contextDownloadAttempts = 5;
 int             contextDownloadTimeout  = 10000;
+char            contextDir[256];
+bool            contextRevalidate       = false;
 bool            troe                    = false;
 bool            multitenancy            = false;
 bool            lmtmp                   = false;
@@ -94,8 +96,19 @@ char            troeHost[64];
 unsigned short  troePort;
 char            troeUser[64];
 char            troePwd[64];
+int             troePoolSize            = 10;
+int             troeQueueSize           = 0;
+int             troeWorkers             = 2;
+char            troeSpillFile[256];
 bool            forwarding              = true;
+int             forwardTimeout          = 5000;
+int             mqttMaxInFlight         = 20;
 bool            idIndex                 = false;
+bool            entityIdUnique          = false;
+int             notifPoolSize           = 0;
+int             notifIdleTimeout        = 30;
+int             notifMaxConns           = 100;
+int             notifSenders            = 0;
 
 
 
@@ -0,0 +1,359 @@
+/*
+*
+* Copyright 2021 FIWARE Foundation e.V.
+*
+* This file is part of Orion-LD Context Broker.
+*
+* Orion-LD Context Broker is free software: you can redistribute it and/or
+* modify it under the terms of the GNU Affero General Public License as
+* published by the Free Software Foundation, either version 3 of the
+* License, or (at your option) any later version.
+*
+* Orion-LD Context Broker is distributed in the hope that it will be useful,
+* but WITHOUT ANY WARRANTY; without even the implied warranty of
+* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU Affero
+* General Public License for more details.
+*
+* You should have received a copy of the GNU Affero General Public License
+* along with Orion-LD Context Broker. If not, see http://www.gnu.org/licenses/.
+*
+* For those usages not covered by this license please contact with
+* orionld at fiware dot org
+*
+* Author: Ken Zangelin
+*/
+#include <stdio.h>                                                     // printf
+#include <string.h>                                                    // strcpy, strcmp, strncmp, strstr
+#include <time.h>                                                      // clock_gettime
+
+#include "gtest/gtest.h"
+
+#include "rest/Verb.h"                                                 // Verb, verbName
+#include "orionld/common/orionldState.h"                               // orionldState
+#include "orionld/rest/OrionLdRestService.h"                           // OrionLdRestServiceVector, ORION_LD_SERVICE_PREFIX_LEN
+#include "orionld/rest/orionldServiceInit.h"                           // orionldRestServiceV, orionldServiceVectorsPrepare
+#include "orionld/rest/orionldServiceLookup.h"                         // orionldServiceLookup
+#include "orionld/orionldRestServices.h"                               // restServiceVV
+
+#include "unittests/unittest.h"
+
+
+
+// -----------------------------------------------------------------------------
+//
+// requestPrepare -
+//
+// The cSumV values are interesting only for URL paths without wildcard of just uptil the first wildcard
+// The longest URL path without/before first wildcard is "/ngsi-ld/v1/csourceRegistrations/".
+// The initial part ("/ngsi-ld/") doesn't count, so ... 24 chars is all we need for the cSumV.
+//
+// strlen("/ngsi-ld/v1/entityOperations/delete")   == 35
+// strlen("/ngsi-ld/")                           == 9   (ORION_LD_SERVICE_PREFIX_LEN)
+//
+//  35 - 9 == 26
+//
+#define MAX_CHARS_BEFORE_WILDCARD 26
+static void requestPrepare(char* url, int* cSumV, int* cSumsP, int* sLenP)
+{
+  // First of all, skip the first 9 characters in the URL path ("/ngsi-ld/")
+  url = &url[ORION_LD_SERVICE_PREFIX_LEN];
+  *cSumsP = 0;
+
+  // Initialize counters with the first byte, then skip the first byte for the loop
+  cSumV[0] = url[0];
+
+  int sLen;
+  int ix   = 1;
+
+  while ((url[ix] != 0) && (ix < MAX_CHARS_BEFORE_WILDCARD))
+  {
+    cSumV[ix]  = cSumV[ix - 1] + url[ix];
+    ++ix;
+  }
+  *cSumsP = ix;
+
+  while (url[ix] != 0)
+  {
+    ++ix;
+  }
+
+  sLen   = ix;
+  *sLenP = sLen;
+}
+
+
+
+// -----------------------------------------------------------------------------
+//
+// orionldServiceLinearLookup -
+//
+// The original service lookup, walking the entire service vector of the verb.
+// No longer used to dispatch requests (see orionldServiceLookup), only kept here as the reference
+// that the trie based lookup is checked and timed against.
+//
+static OrionLdRestService* orionldServiceLinearLookup(OrionLdRestServiceVector* serviceV)
+{
+  int serviceIx = 0;
+  int cSumV[MAX_CHARS_BEFORE_WILDCARD];
+  int cSums;
+  int sLen;
+
+  requestPrepare(orionldState.urlPath, cSumV, &cSums, &sLen);
+
+  while (serviceIx < serviceV->services)
+  {
+    OrionLdRestService* serviceP = &serviceV->serviceV[serviceIx];
+
+    if (serviceP->wildcards == 0)
+    {
+      if (serviceP->charsBeforeFirstWildcard == sLen)
+      {
+        if (serviceP->charsBeforeFirstWildcardSum == cSumV[sLen - 1])
+        {
+          if (strcmp(&serviceP->url[ORION_LD_SERVICE_PREFIX_LEN], &orionldState.urlPath[ORION_LD_SERVICE_PREFIX_LEN]) == 0)
+          {
+            return serviceP;
+          }
+        }
+      }
+    }
+    else if (serviceP->wildcards == 1)
+    {
+      if (serviceP->charsBeforeFirstWildcard < sLen)
+      {
+        if (serviceP->charsBeforeFirstWildcardSum == cSumV[serviceP->charsBeforeFirstWildcard - 1])
+        {
+          if (strncmp(&serviceP->url[ORION_LD_SERVICE_PREFIX_LEN], &orionldState.urlPath[ORION_LD_SERVICE_PREFIX_LEN], serviceP->charsBeforeFirstWildcard) == 0)
+          {
+            // Ending the same?
+            if (serviceP->matchForSecondWildcardLen != 0)  // An ending to match
+            {
+              int indexOfIncomingUrlPath = ORION_LD_SERVICE_PREFIX_LEN + sLen - serviceP->matchForSecondWildcardLen;
+
+              if (strncmp(&orionldState.urlPath[indexOfIncomingUrlPath], serviceP->matchForSecondWildcard, serviceP->matchForSecondWildcardLen) == 0)
+              {
+                orionldState.wildcard[0] = &orionldState.urlPath[serviceP->charsBeforeFirstWildcard + ORION_LD_SERVICE_PREFIX_LEN];
+
+                // Destroying the incoming URL path, to extract the wildcard string
+                orionldState.urlPath[sLen - serviceP->matchForSecondWildcardLen + ORION_LD_SERVICE_PREFIX_LEN] = 0;
+                return serviceP;
+              }
+            }
+            else
+            {
+              orionldState.wildcard[0] = &orionldState.urlPath[serviceP->charsBeforeFirstWildcard + ORION_LD_SERVICE_PREFIX_LEN];
+              return serviceP;
+            }
+          }
+        }
+      }
+    }
+    else
+    {
+      if (serviceP->charsBeforeFirstWildcard < sLen)
+      {
+        if (serviceP->charsBeforeFirstWildcardSum == cSumV[serviceP->charsBeforeFirstWildcard - 1])
+        {
+          char* matchP;
+          if ((matchP = strstr(&orionldState.urlPath[ORION_LD_SERVICE_PREFIX_LEN], serviceP->matchForSecondWildcard)) != NULL)
+          {
+            {
+              orionldState.wildcard[0] = &orionldState.urlPath[serviceP->charsBeforeFirstWildcard + ORION_LD_SERVICE_PREFIX_LEN];
+              orionldState.wildcard[1] = &matchP[serviceP->matchForSecondWildcardLen];
+
+              // Destroying the incoming URL path, to extract first wildcard string
+              *matchP = 0;
+
+              return serviceP;
+            }
+          }
+        }
+      }
+    }
+
+    ++serviceIx;
+  }
+
+  return NULL;
+}
+
+
+
+// -----------------------------------------------------------------------------
+//
+// BENCH_URL_PATHS - max number of URL paths per verb
+//
+#define BENCH_URL_PATHS 64
+
+
+
+// -----------------------------------------------------------------------------
+//
+// BENCH_ITERATIONS - number of times each URL path is looked up, by each lookup function
+//
+#define BENCH_ITERATIONS 10000
+
+
+
+// -----------------------------------------------------------------------------
+//
+// LookupFunction -
+//
+typedef OrionLdRestService* (*LookupFunction)(OrionLdRestServiceVector* serviceV);
+
+
+
+// -----------------------------------------------------------------------------
+//
+// urlPathCreate - URL path that matches the service, with its wildcards replaced by an entity id and an attribute name
+//
+static void urlPathCreate(const char* serviceUrl, char* buf, int bufSize)
+{
+  const char*  wildcardValue[2] = { "urn:ngsi-ld:Vehicle:V0001", "speed" };
+  int          wildcards        = 0;
+  int          ix               = 0;
+
+  while ((*serviceUrl != 0) && (ix < bufSize - 32))
+  {
+    if (*serviceUrl == '*')
+    {
+      ix += snprintf(&buf[ix], bufSize - ix, "%s", wildcardValue[(wildcards < 2)? wildcards : 1]);
+      ++wildcards;
+    }
+    else
+      buf[ix++] = *serviceUrl;
+
+    ++serviceUrl;
+  }
+
+  buf[ix] = 0;
+}
+
+
+
+// -----------------------------------------------------------------------------
+//
+// lookup - copy the URL path (the lookup destroys it) and look it up
+//
+static OrionLdRestService* lookup(LookupFunction lookupFunction, OrionLdRestServiceVector* serviceV, const char* urlPath, char* buf)
+{
+  strcpy(buf, urlPath);
+
+  orionldState.urlPath     = buf;
+  orionldState.wildcard[0] = NULL;
+  orionldState.wildcard[1] = NULL;
+
+  return lookupFunction(serviceV);
+}
+
+
+
+// -----------------------------------------------------------------------------
+//
+// lookupTime - nanoseconds per lookup (the copy of the URL path included)
+//
+static double lookupTime(LookupFunction lookupFunction, OrionLdRestServiceVector* serviceV, char urlPathV[][256], int urlPaths, int iterations)
+{
+  char             buf[256];
+  struct timespec  start;
+  struct timespec  end;
+
+  clock_gettime(CLOCK_MONOTONIC, &start);
+
+  for (int iter = 0; iter < iterations; iter++)
+  {
+    for (int ix = 0; ix < urlPaths; ix++)
+    {
+      lookup(lookupFunction, serviceV, urlPathV[ix], buf);
+    }
+  }
+
+  clock_gettime(CLOCK_MONOTONIC, &end);
+
+  double ns = (end.tv_sec - start.tv_sec) * 1000000000.0 + (end.tv_nsec - start.tv_nsec);
+
+  return ns / ((double) iterations * urlPaths);
+}
+
+
+
+// -----------------------------------------------------------------------------
+//
+// wildcardsEqual -
+//
+static bool wildcardsEqual(char* w1, char* w2)
+{
+  if ((w1 == NULL) || (w2 == NULL))
+    return (w1 == w2);
+
+  return (strcmp(w1, w2) == 0);
+}
+
+
+
+// -----------------------------------------------------------------------------
+//
+// sameAsLinearLookup -
+//
+// For each verb, a URL path is created for each service of the verb, plus a few URL paths that match no service.
+// First, both lookup functions are checked to give the same result for all URL paths, then both are timed.
+// The times are only printed, not checked.
+//
+TEST(orionldServiceLookup, sameAsLinearLookup)
+{
+  orionldServiceVectorsPrepare(restServiceVV, 9);
+
+  const char* noMatchV[] = { "/ngsi-ld/v1/nothingHere", "/ngsi-ld/v1/entities/urn:E1/attrz/speed/x", "/ngsi-ld/v2/entities" };
+  int         noMatches  = sizeof(noMatchV) / sizeof(noMatchV[0]);
+
+  for (int svIx = 0; svIx < 9; svIx++)
+  {
+    OrionLdRestServiceVector* serviceV = &orionldRestServiceV[svIx];
+    char                      urlPathV[BENCH_URL_PATHS][256];
+    int                       urlPaths = 0;
+
+    if (serviceV->services == 0)
+      continue;
+
+    for (int sIx = 0; (sIx < serviceV->services) && (urlPaths < BENCH_URL_PATHS); sIx++)
+    {
+      urlPathCreate(serviceV->serviceV[sIx].url, urlPathV[urlPaths++], sizeof(urlPathV[0]));
+    }
+
+    for (int ix = 0; (ix < noMatches) && (urlPaths < BENCH_URL_PATHS); ix++)
+    {
+      strcpy(urlPathV[urlPaths++], noMatchV[ix]);
+    }
+
+    //
+    // Sanity check - same service and same wildcards from both lookup functions
+    //
+    for (int ix = 0; ix < urlPaths; ix++)
+    {
+      char                 buf1[256];
+      char                 buf2[256];
+      OrionLdRestService*  s1  = lookup(orionldServiceLinearLookup, serviceV, urlPathV[ix], buf1);
+      char*                w10 = orionldState.wildcard[0];
+      char*                w11 = orionldState.wildcard[1];
+      OrionLdRestService*  s2  = lookup(orionldServiceLookup, serviceV, urlPathV[ix], buf2);
+      char*                w20 = orionldState.wildcard[0];
+      char*                w21 = orionldState.wildcard[1];
+
+      EXPECT_TRUE(s1 == s2) << verbName((Verb) svIx) << " " << urlPathV[ix] << ": linear lookup: '"
+                            << ((s1 != NULL)? s1->url : "no service") << "', trie lookup: '"
+                            << ((s2 != NULL)? s2->url : "no service") << "'";
+      EXPECT_TRUE(wildcardsEqual(w10, w20)) << verbName((Verb) svIx) << " " << urlPathV[ix] << ": first wildcard";
+      EXPECT_TRUE(wildcardsEqual(w11, w21)) << verbName((Verb) svIx) << " " << urlPathV[ix] << ": second wildcard";
+    }
+
+    double linearNs = lookupTime(orionldServiceLinearLookup, serviceV, urlPathV, urlPaths, BENCH_ITERATIONS);
+    double trieNs   = lookupTime(orionldServiceLookup,       serviceV, urlPathV, urlPaths, BENCH_ITERATIONS);
+
+    printf("%-7s %2d services, %2d URL paths: linear lookup: %7.1f ns, trie lookup: %7.1f ns\n",
+           verbName((Verb) svIx),
+           serviceV->services,
+           urlPaths,
+           linearNs,
+           trieNs);
+  }
+}